@@ -747,6 +747,47 @@ TEST_P(CacheTest, DefaultShardBits)
 	ASSERT_EQ(6, sc->GetNumShardBits());
 }
 
+TEST_P(CacheTest, NumaAwareLRUCache)
+{
+	// Works on any machine: with a single node this is a plain LRU cache
+	for (bool remote_lookup : { false, true }) {
+		deleted_keys_.clear();
+		deleted_values_.clear();
+		std::shared_ptr<Cache> cache =
+			NewLRUCache(kCacheSize, 2, false, 0.0,
+				    true /* numa_aware */, nullptr,
+				    remote_lookup);
+		ShardedCache *sc = dynamic_cast<ShardedCache *>(cache.get());
+		ASSERT_EQ(port::NumaNodeCount() << 2, sc->GetNumShards());
+		ASSERT_NE(std::string::npos,
+			  cache->GetPrintableOptions().find(
+				  remote_lookup ? "numa_remote_lookup : 1" :
+						  "numa_remote_lookup : 0"));
+
+		Insert(cache, 100, 101);
+		Insert(cache, 200, 201);
+		ASSERT_EQ(101, Lookup(cache, 100));
+		ASSERT_EQ(201, Lookup(cache, 200));
+
+		// Inserting a key again from the same node replaces it
+		Insert(cache, 100, 102);
+		ASSERT_EQ(102, Lookup(cache, 100));
+		ASSERT_EQ(1U, deleted_keys_.size());
+		ASSERT_EQ(101, deleted_values_[0]);
+
+		Cache::Handle *h = cache->Lookup(EncodeKey(200));
+		ASSERT_TRUE(h != nullptr);
+		ASSERT_TRUE(cache->Ref(h));
+		Erase(cache, 200);
+		ASSERT_EQ(-1, Lookup(cache, 200));
+		cache->Release(h);
+		ASSERT_EQ(1U, deleted_keys_.size());
+		cache->Release(h);
+		ASSERT_EQ(2U, deleted_keys_.size());
+		ASSERT_EQ(201, deleted_values_[1]);
+	}
+}
+
 #ifdef SUPPORT_CLOCK_CACHE
 shared_ptr<Cache> (*new_clock_cache_func)(size_t, int, bool) = NewClockCache;
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
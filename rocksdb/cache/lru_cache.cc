@@ -108,7 +108,7 @@ void LRUHandleTable::Resize()
 }
 
 LRUCacheShard::LRUCacheShard()
-	: usage_(0), lru_usage_(0), high_pri_pool_usage_(0)
+	: usage_(0), lru_usage_(0), high_pri_pool_usage_(0), numa_node_(0)
 {
 	// Make empty circular linked list
 	lru_.next = &lru_;
@@ -243,20 +243,41 @@ void LRUCacheShard::EvictFromLRU(size_t charge,
 	}
 }
 
+void LRUCacheShard::FreeEvicted(
+	const autovector<LRUHandle *> &evicted,
+	const std::shared_ptr<Cache::EvictionCallback> &callback)
+{
+	for (auto entry : evicted) {
+		if (callback) {
+			(*callback)(entry->key(), entry->value, entry->deleter);
+		}
+		entry->Free();
+	}
+}
+
 void LRUCacheShard::SetCapacity(size_t capacity)
 {
-	autovector<LRUHandle *> last_reference_list;
+	autovector<LRUHandle *> evicted;
+	std::shared_ptr<Cache::EvictionCallback> callback;
 	{
 		MutexLock l(&mutex_);
 		capacity_ = capacity;
 		high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
-		EvictFromLRU(0, &last_reference_list);
+		EvictFromLRU(0, &evicted);
+		if (!evicted.empty()) {
+			callback = eviction_callback_;
+		}
 	}
 	// we free the entries here outside of mutex for
 	// performance reasons
-	for (auto entry : last_reference_list) {
-		entry->Free();
-	}
+	FreeEvicted(evicted, callback);
+}
+
+void LRUCacheShard::SetEvictionCallback(
+	const std::shared_ptr<Cache::EvictionCallback> &callback)
+{
+	MutexLock l(&mutex_);
+	eviction_callback_ = callback;
 }
 
 void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit)
@@ -350,12 +371,15 @@ Status LRUCacheShard::Insert(const Slice &key, uint32_t hash, void *value,
 		new char[sizeof(LRUHandle) - 1 + key.size()]);
 	Status s;
 	autovector<LRUHandle *> last_reference_list;
+	autovector<LRUHandle *> evicted;
+	std::shared_ptr<Cache::EvictionCallback> callback;
 
 	e->value = value;
 	e->deleter = deleter;
 	e->charge = charge;
 	e->key_length = key.size();
 	e->hash = hash;
+	e->numa_node = numa_node_;
 	e->refs = (handle == nullptr ?
 				 1 :
 				 2); // One from LRUCache, one for the returned handle
@@ -369,14 +393,14 @@ Status LRUCacheShard::Insert(const Slice &key, uint32_t hash, void *value,
 
 		// Free the space following strict LRU policy until enough space
 		// is freed or the lru list is empty
-		EvictFromLRU(charge, &last_reference_list);
+		EvictFromLRU(charge, &evicted);
 
 		if (usage_ - lru_usage_ + charge > capacity_ &&
 		    (strict_capacity_limit_ || handle == nullptr)) {
 			if (handle == nullptr) {
 				// Don't insert the entry but still return ok, as if the entry inserted
 				// into cache and get evicted immediately.
-				last_reference_list.push_back(e);
+				evicted.push_back(e);
 			} else {
 				delete[] reinterpret_cast<char *>(e);
 				*handle = nullptr;
@@ -406,10 +430,14 @@ Status LRUCacheShard::Insert(const Slice &key, uint32_t hash, void *value,
 			}
 			s = Status::OK();
 		}
+		if (!evicted.empty()) {
+			callback = eviction_callback_;
+		}
 	}
 
 	// we free the entries here outside of mutex for
 	// performance reasons
+	FreeEvicted(evicted, callback);
 	for (auto entry : last_reference_list) {
 		entry->Free();
 	}
@@ -470,15 +498,22 @@ std::string LRUCacheShard::GetPrintableOptions() const
 }
 
 LRUCache::LRUCache(size_t capacity, int num_shard_bits,
-		   bool strict_capacity_limit, double high_pri_pool_ratio)
-	: ShardedCache(capacity, num_shard_bits, strict_capacity_limit)
-{
-	int num_shards = 1 << num_shard_bits;
+		   bool strict_capacity_limit, double high_pri_pool_ratio,
+		   bool numa_aware,
+		   std::shared_ptr<MemoryAllocator> memory_allocator,
+		   bool numa_remote_lookup)
+	: ShardedCache(capacity, num_shard_bits, strict_capacity_limit,
+		       numa_aware, std::move(memory_allocator),
+		       numa_remote_lookup)
+{
+	int num_shards = GetNumShards();
 	shards_ = new LRUCacheShard[num_shards];
 	SetCapacity(capacity);
 	SetStrictCapacityLimit(strict_capacity_limit);
 	for (int i = 0; i < num_shards; i++) {
 		shards_[i].SetHighPriorityPoolRatio(high_pri_pool_ratio);
+		shards_[i].SetNumaNode(
+			static_cast<uint8_t>(i >> num_shard_bits));
 	}
 }
 
@@ -512,6 +547,11 @@ uint32_t LRUCache::GetHash(Handle *handle) const
 	return reinterpret_cast<const LRUHandle *>(handle)->hash;
 }
 
+int LRUCache::GetNumaNode(Handle *handle) const
+{
+	return reinterpret_cast<const LRUHandle *>(handle)->numa_node;
+}
+
 void LRUCache::DisownData()
 {
 	shards_ = nullptr;
@@ -519,7 +559,10 @@ void LRUCache::DisownData()
 
 std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
 				   bool strict_capacity_limit,
-				   double high_pri_pool_ratio)
+				   double high_pri_pool_ratio, bool numa_aware,
+				   std::shared_ptr<MemoryAllocator>
+					   memory_allocator,
+				   bool numa_remote_lookup)
 {
 	if (num_shard_bits >= 20) {
 		return nullptr; // the cache cannot be sharded into too many fine pieces
@@ -533,7 +576,9 @@ std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
 	}
 	return std::make_shared<LRUCache>(capacity, num_shard_bits,
 					  strict_capacity_limit,
-					  high_pri_pool_ratio);
+					  high_pri_pool_ratio, numa_aware,
+					  std::move(memory_allocator),
+					  numa_remote_lookup);
 }
 
 } // namespace rocksdb
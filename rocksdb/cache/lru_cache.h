@@ -60,6 +60,10 @@ struct LRUHandle {
 	//   in_high_pro_pool: whether this entry is in high-pri pool.
 	char flags;
 
+	// NUMA node of the shard holding this entry, always 0 unless the
+	// cache is NUMA aware
+	uint8_t numa_node;
+
 	uint32_t hash; // Hash of key(); used for fast sharding and comparisons
 
 	char key_data[1]; // Beginning of key
@@ -185,6 +189,12 @@ class LRUCacheShard : public CacheShard {
 	// Set percentage of capacity reserved for high-pri cache entries.
 	void SetHighPriorityPoolRatio(double high_pri_pool_ratio);
 
+	// Set the NUMA node this shard belongs to, see ShardedCache.
+	void SetNumaNode(uint8_t numa_node)
+	{
+		numa_node_ = numa_node;
+	}
+
 	// Like Cache methods, but with an extra "hash" parameter.
 	virtual Status Insert(const Slice &key, uint32_t hash, void *value,
 			      size_t charge,
@@ -209,6 +219,10 @@ class LRUCacheShard : public CacheShard {
 
 	virtual void EraseUnRefEntries() override;
 
+	virtual void SetEvictionCallback(
+		const std::shared_ptr<Cache::EvictionCallback> &callback)
+		override;
+
 	virtual std::string GetPrintableOptions() const override;
 
 	void TEST_GetLRUList(LRUHandle **lru, LRUHandle **lru_low_pri);
@@ -231,6 +245,12 @@ class LRUCacheShard : public CacheShard {
 	// holding the mutex_
 	void EvictFromLRU(size_t charge, autovector<LRUHandle *> *deleted);
 
+	// Frees the entries evicted by EvictFromLRU(), reporting them to
+	// callback first if it is set. Called without holding mutex_.
+	static void
+	FreeEvicted(const autovector<LRUHandle *> &evicted,
+		    const std::shared_ptr<Cache::EvictionCallback> &callback);
+
 	// Initialized before use.
 	size_t capacity_;
 
@@ -243,6 +263,9 @@ class LRUCacheShard : public CacheShard {
 	// Memory size for entries in high-pri pool.
 	size_t high_pri_pool_usage_;
 
+	// Stamped on every entry inserted in this shard
+	uint8_t numa_node_;
+
 	// Whether to reject insertion if cache reaches its full capacity.
 	bool strict_capacity_limit_;
 
@@ -267,12 +290,19 @@ class LRUCacheShard : public CacheShard {
 	LRUHandle *lru_low_pri_;
 
 	LRUHandleTable table_;
+
+	// Reported the entries evicted from this shard, copied out under
+	// mutex_ so it can be replaced while an eviction is reported.
+	std::shared_ptr<Cache::EvictionCallback> eviction_callback_;
 };
 
 class LRUCache : public ShardedCache {
     public:
 	LRUCache(size_t capacity, int num_shard_bits,
-		 bool strict_capacity_limit, double high_pri_pool_ratio);
+		 bool strict_capacity_limit, double high_pri_pool_ratio,
+		 bool numa_aware = false,
+		 std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
+		 bool numa_remote_lookup = false);
 	virtual ~LRUCache();
 	virtual const char *Name() const override
 	{
@@ -283,6 +313,7 @@ class LRUCache : public ShardedCache {
 	virtual void *Value(Handle *handle) override;
 	virtual size_t GetCharge(Handle *handle) const override;
 	virtual uint32_t GetHash(Handle *handle) const override;
+	virtual int GetNumaNode(Handle *handle) const override;
 	virtual void DisownData() override;
 
     private:
@@ -61,6 +61,27 @@ class LRUCacheTest : public testing::Test {
 		cache_->Erase(key, 0 /*hash*/);
 	}
 
+	void SetCapacity(size_t capacity)
+	{
+		cache_->SetCapacity(capacity);
+	}
+
+	// Record the keys of the entries evicted from now on in *evicted, or
+	// stop recording if it is nullptr
+	void RecordEvictions(std::vector<std::string> *evicted)
+	{
+		std::shared_ptr<Cache::EvictionCallback> callback;
+		if (evicted != nullptr) {
+			callback = std::make_shared<Cache::EvictionCallback>(
+				[evicted](const Slice &key, void * /*value*/,
+					  void (*/*deleter*/)(const Slice &,
+							      void *)) {
+					evicted->push_back(key.ToString());
+				});
+		}
+		cache_->SetEvictionCallback(callback);
+	}
+
 	void ValidateLRUList(std::vector<std::string> keys,
 			     size_t num_high_pri_pool_keys = 0)
 	{
@@ -173,6 +194,35 @@ TEST_F(LRUCacheTest, MidPointInsertion)
 	ValidateLRUList({ "e", "f", "g", "d", "Z" }, 1);
 }
 
+TEST_F(LRUCacheTest, EvictionCallback)
+{
+	NewCache(3);
+	std::vector<std::string> evicted;
+	RecordEvictions(&evicted);
+
+	Insert("a");
+	Insert("b");
+	Insert("c");
+	// Erased and replaced entries are not evicted
+	Erase("b");
+	Insert("c");
+	Insert("d");
+	ASSERT_TRUE(evicted.empty());
+
+	Insert("e");
+	ValidateLRUList({ "c", "d", "e" });
+	ASSERT_EQ(std::vector<std::string>({ "a" }), evicted);
+
+	SetCapacity(1);
+	ValidateLRUList({ "e" });
+	ASSERT_EQ(std::vector<std::string>({ "a", "c", "d" }), evicted);
+
+	RecordEvictions(nullptr);
+	Insert("f");
+	ValidateLRUList({ "f" });
+	ASSERT_EQ(3U, evicted.size());
+}
+
 } // namespace rocksdb
 
 int main(int argc, char **argv)
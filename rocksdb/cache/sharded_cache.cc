@@ -13,6 +13,7 @@
 
 #include "cache/sharded_cache.h"
 
+#include <algorithm>
 #include <string>
 
 #include "util/mutexlock.h"
@@ -20,15 +21,28 @@
 namespace rocksdb
 {
 ShardedCache::ShardedCache(size_t capacity, int num_shard_bits,
-			   bool strict_capacity_limit)
-	: num_shard_bits_(num_shard_bits), capacity_(capacity),
-	  strict_capacity_limit_(strict_capacity_limit), last_id_(1)
+			   bool strict_capacity_limit, bool numa_aware,
+			   std::shared_ptr<MemoryAllocator> memory_allocator,
+			   bool numa_remote_lookup)
+	: num_shard_bits_(num_shard_bits),
+	  num_numa_nodes_(numa_aware ? std::min(port::NumaNodeCount(), 256) :
+					     1),
+	  numa_remote_lookup_(numa_remote_lookup),
+	  num_shards_(num_numa_nodes_ << num_shard_bits), capacity_(capacity),
+	  strict_capacity_limit_(strict_capacity_limit), last_id_(1),
+	  memory_allocator_(std::move(memory_allocator))
 {
 }
 
+int ShardedCache::LocalNumaNode() const
+{
+	int node = port::CurrentNumaNode();
+	return node < num_numa_nodes_ ? node : node % num_numa_nodes_;
+}
+
 void ShardedCache::SetCapacity(size_t capacity)
 {
-	int num_shards = 1 << num_shard_bits_;
+	int num_shards = num_shards_;
 	const size_t per_shard = (capacity + (num_shards - 1)) / num_shards;
 	MutexLock l(&capacity_mutex_);
 	for (int s = 0; s < num_shards; s++) {
@@ -39,7 +53,7 @@ void ShardedCache::SetCapacity(size_t capacity)
 
 void ShardedCache::SetStrictCapacityLimit(bool strict_capacity_limit)
 {
-	int num_shards = 1 << num_shard_bits_;
+	int num_shards = num_shards_;
 	MutexLock l(&capacity_mutex_);
 	for (int s = 0; s < num_shards; s++) {
 		GetShard(s)->SetStrictCapacityLimit(strict_capacity_limit);
@@ -52,32 +66,72 @@ Status ShardedCache::Insert(const Slice &key, void *value, size_t charge,
 			    Handle **handle, Priority priority)
 {
 	uint32_t hash = HashSlice(key);
-	return GetShard(Shard(hash))
+	if (num_numa_nodes_ == 1) {
+		return GetShard(Shard(hash))->Insert(key, hash, value, charge,
+						     deleter, handle, priority);
+	}
+	int node = LocalNumaNode();
+	if (!numa_remote_lookup_) {
+		return GetShard(Shard(hash, node))->Insert(
+			key, hash, value, charge, deleter, handle, priority);
+	}
+	// Other nodes must not keep serving an older value for key, nor get
+	// it inserted by another thread in between
+	MutexLock l(NumaKeyMutex(hash));
+	for (int n = 0; n < num_numa_nodes_; n++) {
+		if (n != node) {
+			GetShard(Shard(hash, n))->Erase(key, hash);
+		}
+	}
+	return GetShard(Shard(hash, node))
 		->Insert(key, hash, value, charge, deleter, handle, priority);
 }
 
 Cache::Handle *ShardedCache::Lookup(const Slice &key, Statistics *stats)
 {
 	uint32_t hash = HashSlice(key);
-	return GetShard(Shard(hash))->Lookup(key, hash);
+	if (num_numa_nodes_ == 1) {
+		return GetShard(Shard(hash))->Lookup(key, hash);
+	}
+	int node = LocalNumaNode();
+	Handle *handle = GetShard(Shard(hash, node))->Lookup(key, hash);
+	if (!numa_remote_lookup_) {
+		return handle;
+	}
+	for (int n = 0; handle == nullptr && n < num_numa_nodes_; n++) {
+		if (n != node) {
+			handle = GetShard(Shard(hash, n))->Lookup(key, hash);
+		}
+	}
+	return handle;
 }
 
 bool ShardedCache::Ref(Handle *handle)
 {
 	uint32_t hash = GetHash(handle);
-	return GetShard(Shard(hash))->Ref(handle);
+	return GetShard(Shard(hash, GetNumaNode(handle)))->Ref(handle);
 }
 
 bool ShardedCache::Release(Handle *handle, bool force_erase)
 {
 	uint32_t hash = GetHash(handle);
-	return GetShard(Shard(hash))->Release(handle, force_erase);
+	return GetShard(Shard(hash, GetNumaNode(handle)))
+		->Release(handle, force_erase);
 }
 
 void ShardedCache::Erase(const Slice &key)
 {
 	uint32_t hash = HashSlice(key);
-	GetShard(Shard(hash))->Erase(key, hash);
+	if (!numa_remote_lookup_) {
+		for (int n = 0; n < num_numa_nodes_; n++) {
+			GetShard(Shard(hash, n))->Erase(key, hash);
+		}
+		return;
+	}
+	MutexLock l(NumaKeyMutex(hash));
+	for (int n = 0; n < num_numa_nodes_; n++) {
+		GetShard(Shard(hash, n))->Erase(key, hash);
+	}
 }
 
 uint64_t ShardedCache::NewId()
@@ -100,7 +154,7 @@ bool ShardedCache::HasStrictCapacityLimit() const
 size_t ShardedCache::GetUsage() const
 {
 	// We will not lock the cache when getting the usage from shards.
-	int num_shards = 1 << num_shard_bits_;
+	int num_shards = num_shards_;
 	size_t usage = 0;
 	for (int s = 0; s < num_shards; s++) {
 		usage += GetShard(s)->GetUsage();
@@ -116,7 +170,7 @@ size_t ShardedCache::GetUsage(Handle *handle) const
 size_t ShardedCache::GetPinnedUsage() const
 {
 	// We will not lock the cache when getting the usage from shards.
-	int num_shards = 1 << num_shard_bits_;
+	int num_shards = num_shards_;
 	size_t usage = 0;
 	for (int s = 0; s < num_shards; s++) {
 		usage += GetShard(s)->GetPinnedUsage();
@@ -127,7 +181,7 @@ size_t ShardedCache::GetPinnedUsage() const
 void ShardedCache::ApplyToAllCacheEntries(void (*callback)(void *, size_t),
 					  bool thread_safe)
 {
-	int num_shards = 1 << num_shard_bits_;
+	int num_shards = num_shards_;
 	for (int s = 0; s < num_shards; s++) {
 		GetShard(s)->ApplyToAllCacheEntries(callback, thread_safe);
 	}
@@ -135,12 +189,24 @@ void ShardedCache::ApplyToAllCacheEntries(void (*callback)(void *, size_t),
 
 void ShardedCache::EraseUnRefEntries()
 {
-	int num_shards = 1 << num_shard_bits_;
+	int num_shards = num_shards_;
 	for (int s = 0; s < num_shards; s++) {
 		GetShard(s)->EraseUnRefEntries();
 	}
 }
 
+void ShardedCache::SetEvictionCallback(const EvictionCallback &callback)
+{
+	std::shared_ptr<EvictionCallback> shared;
+	if (callback) {
+		shared = std::make_shared<EvictionCallback>(callback);
+	}
+	int num_shards = num_shards_;
+	for (int s = 0; s < num_shards; s++) {
+		GetShard(s)->SetEvictionCallback(shared);
+	}
+}
+
 std::string ShardedCache::GetPrintableOptions() const
 {
 	std::string ret;
@@ -155,10 +221,20 @@ std::string ShardedCache::GetPrintableOptions() const
 		snprintf(buffer, kBufferSize, "    num_shard_bits : %d\n",
 			 num_shard_bits_);
 		ret.append(buffer);
+		snprintf(buffer, kBufferSize, "    num_numa_nodes : %d\n",
+			 num_numa_nodes_);
+		ret.append(buffer);
+		snprintf(buffer, kBufferSize, "    numa_remote_lookup : %d\n",
+			 numa_remote_lookup_);
+		ret.append(buffer);
 		snprintf(buffer, kBufferSize,
 			 "    strict_capacity_limit : %d\n",
 			 strict_capacity_limit_);
 		ret.append(buffer);
+		snprintf(buffer, kBufferSize, "    memory_allocator : %s\n",
+			 memory_allocator_ ? memory_allocator_->Name() :
+					     "None");
+		ret.append(buffer);
 	}
 	ret.append(GetShard(0)->GetPrintableOptions());
 	return ret;
@@ -41,6 +41,11 @@ class CacheShard {
 	virtual void ApplyToAllCacheEntries(void (*callback)(void *, size_t),
 					    bool thread_safe) = 0;
 	virtual void EraseUnRefEntries() = 0;
+	virtual void SetEvictionCallback(
+		const std::shared_ptr<Cache::EvictionCallback> &callback)
+	{
+		(void)callback;
+	}
 	virtual std::string GetPrintableOptions() const
 	{
 		return "";
@@ -50,10 +55,21 @@ class CacheShard {
 // Generic cache interface which shards cache by hash of keys. 2^num_shard_bits
 // shards will be created, with capacity split evenly to each of the shards.
 // Keys are sharded by the highest num_shard_bits bits of hash value.
+//
+// If numa_aware, there are 2^num_shard_bits shards per NUMA node, shard
+// (node << num_shard_bits) + i being the i-th shard of node. Inserts and
+// lookups go to the caller's node. With numa_remote_lookup, lookups then try
+// the other nodes, and inserts drop the key from the other nodes while
+// holding a lock of the key, so that a key is in one node only. Erase()
+// takes that lock too. Implementations must tell the node of a handle
+// through GetNumaNode().
 class ShardedCache : public Cache {
     public:
 	ShardedCache(size_t capacity, int num_shard_bits,
-		     bool strict_capacity_limit);
+		     bool strict_capacity_limit, bool numa_aware = false,
+		     std::shared_ptr<MemoryAllocator> memory_allocator =
+			     nullptr,
+		     bool numa_remote_lookup = false);
 	virtual ~ShardedCache() = default;
 	virtual const char *Name() const override = 0;
 	virtual CacheShard *GetShard(int shard) = 0;
@@ -61,6 +77,10 @@ class ShardedCache : public Cache {
 	virtual void *Value(Handle *handle) override = 0;
 	virtual size_t GetCharge(Handle *handle) const = 0;
 	virtual uint32_t GetHash(Handle *handle) const = 0;
+	virtual int GetNumaNode(Handle *handle) const
+	{
+		return 0;
+	}
 	virtual void DisownData() override = 0;
 
 	virtual void SetCapacity(size_t capacity) override;
@@ -83,13 +103,24 @@ class ShardedCache : public Cache {
 	virtual void ApplyToAllCacheEntries(void (*callback)(void *, size_t),
 					    bool thread_safe) override;
 	virtual void EraseUnRefEntries() override;
+	virtual void
+	SetEvictionCallback(const EvictionCallback &callback) override;
 	virtual std::string GetPrintableOptions() const override;
+	virtual MemoryAllocator *memory_allocator() const override
+	{
+		return memory_allocator_.get();
+	}
 
 	int GetNumShardBits() const
 	{
 		return num_shard_bits_;
 	}
 
+	int GetNumShards() const
+	{
+		return num_shards_;
+	}
+
     private:
 	static inline uint32_t HashSlice(const Slice &s)
 	{
@@ -104,11 +135,35 @@ class ShardedCache : public Cache {
 				     0;
 	}
 
+	uint32_t Shard(uint32_t hash, int numa_node)
+	{
+		return (static_cast<uint32_t>(numa_node) << num_shard_bits_) |
+		       Shard(hash);
+	}
+
+	int LocalNumaNode() const;
+
+	// Serializes the inserts and erases of the keys of a hash when a key
+	// is in one node only
+	port::Mutex *NumaKeyMutex(uint32_t hash)
+	{
+		return &numa_key_mutexes_[hash % kNumNumaKeyMutexes];
+	}
+
+	static const int kNumNumaKeyMutexes = 64;
+
 	int num_shard_bits_;
+	// Number of NUMA nodes the shards are spread over, 1 if not NUMA aware
+	int num_numa_nodes_;
+	// Look up the other nodes too, keeping a key in one node only
+	const bool numa_remote_lookup_;
+	port::Mutex numa_key_mutexes_[kNumNumaKeyMutexes];
+	int num_shards_;
 	mutable port::Mutex capacity_mutex_;
 	size_t capacity_;
 	bool strict_capacity_limit_;
 	std::atomic<uint64_t> last_id_;
+	std::shared_ptr<MemoryAllocator> memory_allocator_;
 };
 
 extern int GetDefaultCacheShardBits(size_t capacity);
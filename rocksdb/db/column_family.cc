@@ -396,6 +396,8 @@ ColumnFamilyData::ColumnFamilyData(uint32_t id, const std::string &name,
 	  next_(nullptr), prev_(nullptr), log_number_(0),
 	  column_family_set_(column_family_set), pending_flush_(false),
 	  pending_compaction_(false), prev_compaction_needed_bytes_(0),
+	  write_stall_condition_(WriteStallCondition::kNormal),
+	  write_stall_cause_(WriteStallCause::kNone),
 	  allow_2pc_(db_options.allow_2pc)
 {
 	Ref();
@@ -408,8 +410,9 @@ ColumnFamilyData::ColumnFamilyData(uint32_t id, const std::string &name,
 	if (_dummy_versions != nullptr) {
 		internal_stats_.reset(new InternalStats(ioptions_.num_levels,
 							db_options.env, this));
-		table_cache_.reset(
-			new TableCache(ioptions_, env_options, _table_cache));
+		table_cache_.reset(new TableCache(
+			ioptions_, env_options, _table_cache,
+			column_family_set->get_block_cache_tracer()));
 		if (ioptions_.compaction_style == kCompactionStyleLevel) {
 			compaction_picker_.reset(new LevelCompactionPicker(
 				ioptions_, &internal_comparator_));
@@ -561,7 +564,7 @@ namespace
 std::unique_ptr<WriteControllerToken>
 SetupDelay(WriteController *write_controller, uint64_t compaction_needed_bytes,
 	   uint64_t prev_compaction_need_bytes, bool penalize_stop,
-	   bool auto_comapctions_disabled)
+	   bool auto_comapctions_disabled, WriteStallCause cause)
 {
 	const uint64_t kMinWriteRate = 16 * 1024u; // Minimum write rate 16KB/s.
 
@@ -625,7 +628,7 @@ SetupDelay(WriteController *write_controller, uint64_t compaction_needed_bytes,
 			}
 		}
 	}
-	return write_controller->GetDelayToken(write_rate);
+	return write_controller->GetDelayToken(write_rate, cause);
 }
 
 int GetL0ThresholdSpeedupCompaction(int level0_file_num_compaction_trigger,
@@ -679,8 +682,11 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
 
 		if (imm()->NumNotFlushed() >=
 		    mutable_cf_options.max_write_buffer_number) {
+			write_stall_condition_ = WriteStallCondition::kStopped;
+			write_stall_cause_ = WriteStallCause::kMemtableLimit;
 			write_controller_token_ =
-				write_controller->GetStopToken();
+				write_controller->GetStopToken(
+					write_stall_cause_);
 			internal_stats_->AddCFStats(
 				InternalStats::MEMTABLE_COMPACTION, 1);
 			ROCKS_LOG_WARN(
@@ -693,8 +699,11 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
 			   vstorage->l0_delay_trigger_count() >=
 				   mutable_cf_options
 					   .level0_stop_writes_trigger) {
+			write_stall_condition_ = WriteStallCondition::kStopped;
+			write_stall_cause_ = WriteStallCause::kL0FileCountLimit;
 			write_controller_token_ =
-				write_controller->GetStopToken();
+				write_controller->GetStopToken(
+					write_stall_cause_);
 			internal_stats_->AddCFStats(
 				InternalStats::LEVEL0_NUM_FILES_TOTAL, 1);
 			if (compaction_picker_->IsLevel0CompactionInProgress()) {
@@ -715,8 +724,12 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
 			   compaction_needed_bytes >=
 				   mutable_cf_options
 					   .hard_pending_compaction_bytes_limit) {
+			write_stall_condition_ = WriteStallCondition::kStopped;
+			write_stall_cause_ =
+				WriteStallCause::kPendingCompactionBytes;
 			write_controller_token_ =
-				write_controller->GetStopToken();
+				write_controller->GetStopToken(
+					write_stall_cause_);
 			internal_stats_->AddCFStats(
 				InternalStats::HARD_PENDING_COMPACTION_BYTES_LIMIT,
 				1);
@@ -729,10 +742,13 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
 			   imm()->NumNotFlushed() >=
 				   mutable_cf_options.max_write_buffer_number -
 					   1) {
+			write_stall_condition_ = WriteStallCondition::kDelayed;
+			write_stall_cause_ = WriteStallCause::kMemtableLimit;
 			write_controller_token_ = SetupDelay(
 				write_controller, compaction_needed_bytes,
 				prev_compaction_needed_bytes_, was_stopped,
-				mutable_cf_options.disable_auto_compactions);
+				mutable_cf_options.disable_auto_compactions,
+				write_stall_cause_);
 			internal_stats_->AddCFStats(
 				InternalStats::MEMTABLE_SLOWDOWN, 1);
 			ROCKS_LOG_WARN(
@@ -754,11 +770,14 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
 				vstorage->l0_delay_trigger_count() >=
 				mutable_cf_options.level0_stop_writes_trigger -
 					2;
+			write_stall_condition_ = WriteStallCondition::kDelayed;
+			write_stall_cause_ = WriteStallCause::kL0FileCountLimit;
 			write_controller_token_ = SetupDelay(
 				write_controller, compaction_needed_bytes,
 				prev_compaction_needed_bytes_,
 				was_stopped || near_stop,
-				mutable_cf_options.disable_auto_compactions);
+				mutable_cf_options.disable_auto_compactions,
+				write_stall_cause_);
 			internal_stats_->AddCFStats(
 				InternalStats::LEVEL0_SLOWDOWN_TOTAL, 1);
 			if (compaction_picker_->IsLevel0CompactionInProgress()) {
@@ -798,11 +817,15 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
 							 .soft_pending_compaction_bytes_limit) /
 						4;
 
+			write_stall_condition_ = WriteStallCondition::kDelayed;
+			write_stall_cause_ =
+				WriteStallCause::kPendingCompactionBytes;
 			write_controller_token_ = SetupDelay(
 				write_controller, compaction_needed_bytes,
 				prev_compaction_needed_bytes_,
 				was_stopped || near_stop,
-				mutable_cf_options.disable_auto_compactions);
+				mutable_cf_options.disable_auto_compactions,
+				write_stall_cause_);
 			internal_stats_->AddCFStats(
 				InternalStats::SOFT_PENDING_COMPACTION_BYTES_LIMIT,
 				1);
@@ -814,6 +837,8 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
 				vstorage->estimated_compaction_needed_bytes(),
 				write_controller->delayed_write_rate());
 		} else {
+			write_stall_condition_ = WriteStallCondition::kNormal;
+			write_stall_cause_ = WriteStallCause::kNone;
 			if (vstorage->l0_delay_trigger_count() >=
 			    GetL0ThresholdSpeedupCompaction(
 				    mutable_cf_options
@@ -873,9 +898,16 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
 			}
 		}
 		prev_compaction_needed_bytes_ = compaction_needed_bytes;
+		internal_stats_->SetWriteStallCondition(write_stall_condition_,
+							write_stall_cause_);
 	}
 }
 
+WriteController *ColumnFamilyData::write_controller() const
+{
+	return column_family_set_->write_controller_;
+}
+
 const EnvOptions *ColumnFamilyData::soptions() const
 {
 	return &(column_family_set_->env_options_);
@@ -1106,7 +1138,8 @@ ColumnFamilySet::ColumnFamilySet(const std::string &dbname,
 				 const EnvOptions &env_options,
 				 Cache *table_cache,
 				 WriteBufferManager *write_buffer_manager,
-				 WriteController *write_controller)
+				 WriteController *write_controller,
+				 BlockCacheTracer *block_cache_tracer)
 	: max_column_family_(0),
 	  dummy_cfd_(new ColumnFamilyData(0, "", nullptr, nullptr, nullptr,
 					  ColumnFamilyOptions(), *db_options,
@@ -1115,7 +1148,8 @@ ColumnFamilySet::ColumnFamilySet(const std::string &dbname,
 	  db_options_(db_options), env_options_(env_options),
 	  table_cache_(table_cache),
 	  write_buffer_manager_(write_buffer_manager),
-	  write_controller_(write_controller)
+	  write_controller_(write_controller),
+	  block_cache_tracer_(block_cache_tracer)
 {
 	// initialize linked list
 	dummy_cfd_->prev_ = dummy_cfd_;
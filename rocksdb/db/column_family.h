@@ -38,6 +38,7 @@ class InternalKey;
 class InternalStats;
 class ColumnFamilyData;
 class DBImpl;
+class BlockCacheTracer;
 class LogBuffer;
 class InstrumentedMutex;
 class InstrumentedMutexLock;
@@ -419,6 +420,20 @@ class ColumnFamilyData {
 	void RecalculateWriteStallConditions(
 		const MutableCFOptions &mutable_cf_options);
 
+	// The condition and cause found by the last
+	// RecalculateWriteStallConditions()
+	WriteStallCondition write_stall_condition() const
+	{
+		return write_stall_condition_;
+	}
+
+	WriteStallCause write_stall_cause() const
+	{
+		return write_stall_cause_;
+	}
+
+	WriteController *write_controller() const;
+
 	void set_initialized()
 	{
 		initialized_.store(true);
@@ -505,6 +520,9 @@ class ColumnFamilyData {
 
 	uint64_t prev_compaction_needed_bytes_;
 
+	WriteStallCondition write_stall_condition_;
+	WriteStallCause write_stall_cause_;
+
 	// if the database was opened with 2pc enabled
 	bool allow_2pc_;
 };
@@ -564,7 +582,8 @@ class ColumnFamilySet {
 			const ImmutableDBOptions *db_options,
 			const EnvOptions &env_options, Cache *table_cache,
 			WriteBufferManager *write_buffer_manager,
-			WriteController *write_controller);
+			WriteController *write_controller,
+			BlockCacheTracer *block_cache_tracer = nullptr);
 	~ColumnFamilySet();
 
 	ColumnFamilyData *GetDefault() const;
@@ -603,6 +622,11 @@ class ColumnFamilySet {
 		return table_cache_;
 	}
 
+	BlockCacheTracer *get_block_cache_tracer()
+	{
+		return block_cache_tracer_;
+	}
+
     private:
 	friend class ColumnFamilyData;
 	// helper function that gets called from cfd destructor
@@ -633,6 +657,7 @@ class ColumnFamilySet {
 	Cache *table_cache_;
 	WriteBufferManager *write_buffer_manager_;
 	WriteController *write_controller_;
+	BlockCacheTracer *block_cache_tracer_;
 };
 
 // We use ColumnFamilyMemTablesImpl to provide WriteBatch a way to access
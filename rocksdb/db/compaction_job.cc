@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
 #include <random>
 #include <set>
@@ -49,6 +50,7 @@
 #include "table/block_based_table_factory.h"
 #include "table/merging_iterator.h"
 #include "table/table_builder.h"
+#include "util/block_cache_tracer.h"
 #include "util/coding.h"
 #include "util/file_reader_writer.h"
 #include "util/filename.h"
@@ -117,6 +119,15 @@ struct CompactionJob::SubcompactionState {
 	// A flag determine whether the key has been seen in ShouldStopBefore()
 	bool seen_key = false;
 	std::string compression_dict;
+	// Bytes of the keys and values written per key range, if
+	// compaction_stats_key_prefix_length is set, for up to
+	// InternalStats::kMaxKeyRanges ranges and in key_range_overflow_bytes
+	// for the others. The current range caches the entry of the last key,
+	// since consecutive keys mostly share it.
+	std::map<std::string, uint64_t> key_range_bytes;
+	uint64_t key_range_overflow_bytes = 0;
+	Slice current_key_range;
+	uint64_t *current_key_range_bytes = nullptr;
 
 	SubcompactionState(Compaction *c, Slice *_start, Slice *_end,
 			   uint64_t size = 0)
@@ -154,6 +165,10 @@ struct CompactionJob::SubcompactionState {
 		overlapped_bytes = std::move(o.overlapped_bytes);
 		seen_key = std::move(o.seen_key);
 		compression_dict = std::move(o.compression_dict);
+		key_range_bytes = std::move(o.key_range_bytes);
+		key_range_overflow_bytes = o.key_range_overflow_bytes;
+		current_key_range = std::move(o.current_key_range);
+		current_key_range_bytes = std::move(o.current_key_range_bytes);
 		return *this;
 	}
 
@@ -162,6 +177,33 @@ struct CompactionJob::SubcompactionState {
 
 	SubcompactionState &operator=(const SubcompactionState &) = delete;
 
+	void RecordKeyRangeBytes(const Slice &user_key, size_t prefix_length,
+				 uint64_t bytes)
+	{
+		Slice range(user_key.data(),
+			    std::min(user_key.size(), prefix_length));
+		if (current_key_range_bytes != nullptr &&
+		    range == current_key_range) {
+			*current_key_range_bytes += bytes;
+			return;
+		}
+		std::string range_key = range.ToString();
+		auto it = key_range_bytes.find(range_key);
+		if (it == key_range_bytes.end()) {
+			if (key_range_bytes.size() >=
+			    InternalStats::kMaxKeyRanges) {
+				current_key_range_bytes = nullptr;
+				key_range_overflow_bytes += bytes;
+				return;
+			}
+			it = key_range_bytes.emplace(std::move(range_key), 0)
+				     .first;
+		}
+		current_key_range = it->first;
+		current_key_range_bytes = &it->second;
+		*current_key_range_bytes += bytes;
+	}
+
 	// Returns true iff we should stop building the current output
 	// before processing "internal_key".
 	bool ShouldStopBefore(const Slice &internal_key,
@@ -214,10 +256,12 @@ struct CompactionJob::CompactionState {
 	uint64_t total_bytes;
 	uint64_t num_input_records;
 	uint64_t num_output_records;
+	std::map<std::string, uint64_t> key_range_bytes;
+	uint64_t key_range_overflow_bytes;
 
 	explicit CompactionState(Compaction *c)
 		: compaction(c), total_bytes(0), num_input_records(0),
-		  num_output_records(0)
+		  num_output_records(0), key_range_overflow_bytes(0)
 	{
 	}
 
@@ -265,6 +309,20 @@ void CompactionJob::AggregateStatistics()
 		compact_->total_bytes += sc.total_bytes;
 		compact_->num_input_records += sc.num_input_records;
 		compact_->num_output_records += sc.num_output_records;
+		compact_->key_range_overflow_bytes +=
+			sc.key_range_overflow_bytes;
+		for (const auto &range : sc.key_range_bytes) {
+			auto it = compact_->key_range_bytes.find(range.first);
+			if (it != compact_->key_range_bytes.end()) {
+				it->second += range.second;
+			} else if (compact_->key_range_bytes.size() <
+				   InternalStats::kMaxKeyRanges) {
+				compact_->key_range_bytes.emplace(range);
+			} else {
+				compact_->key_range_overflow_bytes +=
+					range.second;
+			}
+		}
 	}
 	if (compaction_job_stats_) {
 		for (SubcompactionState &sc : compact_->sub_compact_states) {
@@ -611,6 +669,12 @@ Status CompactionJob::Install(const MutableCFOptions &mutable_cf_options)
 	ColumnFamilyData *cfd = compact_->compaction->column_family_data();
 	cfd->internal_stats()->AddCompactionStats(
 		compact_->compaction->output_level(), compaction_stats_);
+	if (!compact_->key_range_bytes.empty() ||
+	    compact_->key_range_overflow_bytes > 0) {
+		cfd->internal_stats()->AddCompactionKeyRangeStats(
+			compact_->key_range_bytes,
+			compact_->key_range_overflow_bytes);
+	}
 
 	if (status.ok()) {
 		status = InstallCompactionResults(mutable_cf_options);
@@ -695,12 +759,15 @@ Status CompactionJob::Install(const MutableCFOptions &mutable_cf_options)
 void CompactionJob::ProcessKeyValueCompaction(SubcompactionState *sub_compact)
 {
 	assert(sub_compact != nullptr);
+	BlockCacheTraceCallerGuard trace_caller(kTraceCompaction);
 	ColumnFamilyData *cfd = sub_compact->compaction->column_family_data();
 	std::unique_ptr<RangeDelAggregator> range_del_agg(
 		new RangeDelAggregator(cfd->internal_comparator(),
 				       existing_snapshots_));
 	std::unique_ptr<InternalIterator> input(versions_->MakeInputIterator(
 		sub_compact->compaction, range_del_agg.get()));
+	const size_t key_prefix_length =
+		cfd->ioptions()->compaction_stats_key_prefix_length;
 
 	AutoThreadOperationStageUpdater stage_updater(
 		ThreadStatus::STAGE_COMPACTION_PROCESS_KV);
@@ -847,6 +914,11 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState *sub_compact)
 		sub_compact->builder->Add(key, value);
 		sub_compact->current_output_file_size =
 			sub_compact->builder->FileSize();
+		if (key_prefix_length > 0) {
+			sub_compact->RecordKeyRangeBytes(
+				ExtractUserKey(key), key_prefix_length,
+				key.size() + value.size());
+		}
 		sub_compact->current_output()->meta.UpdateBoundaries(
 			key, c_iter->ikey().sequence);
 		sub_compact->num_output_records++;
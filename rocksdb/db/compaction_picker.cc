@@ -1166,8 +1166,16 @@ void LevelCompactionBuilder::PickFilesMarkedForCompaction()
 		// files as being_compacted, but didn't call ComputeCompactionScore()
 		assert(!level_file.second->being_compacted);
 		start_level_ = level_file.first;
-		output_level_ = (start_level_ == 0) ? vstorage_->base_level() :
-							    start_level_ + 1;
+		if (start_level_ > 0 &&
+		    start_level_ == vstorage_->num_non_empty_levels() - 1) {
+			// Nothing lies below, so the file is rewritten within
+			// the last level with data, e.g. to drop expired values
+			output_level_ = start_level_;
+		} else {
+			output_level_ = (start_level_ == 0) ?
+						      vstorage_->base_level() :
+						      start_level_ + 1;
+		}
 
 		if (start_level_ == 0 &&
 		    !compaction_picker_->level0_compactions_in_progress()
@@ -1313,8 +1321,9 @@ bool LevelCompactionBuilder::SetupOtherInputsIfNeeded()
 {
 	// Setup input files from output level. For output to L0, we only compact
 	// spans of files that do not interact with any pending compactions, so don't
-	// need to consider other levels.
-	if (output_level_ != 0) {
+	// need to consider other levels. A compaction within the last level
+	// with data has no other inputs either.
+	if (output_level_ != 0 && output_level_ != start_level_) {
 		output_level_inputs_.level = output_level_;
 		if (!compaction_picker_->SetupOtherInputs(
 			    cf_name_, mutable_cf_options_, vstorage_,
@@ -1346,6 +1355,11 @@ bool LevelCompactionBuilder::SetupOtherInputsIfNeeded()
 						    &grandparents_);
 	} else {
 		compaction_inputs_.push_back(start_level_inputs_);
+		if (output_level_ != 0 &&
+		    compaction_picker_->FilesRangeOverlapWithCompaction(
+			    compaction_inputs_, output_level_)) {
+			return false;
+		}
 	}
 	return true;
 }
@@ -464,6 +464,32 @@ TEST_F(DBBasicTest, ManifestRollOver)
 	} while (ChangeCompactOptions());
 }
 
+TEST_F(DBBasicTest, ManifestRollOverOnSpaceAmp)
+{
+	Options options = CurrentOptions();
+	options.disable_auto_compactions = true;
+	options.max_manifest_space_amp_pct = 100;
+	// Roll over a MANIFEST of any size
+	options.min_manifest_file_size_for_space_amp = 0;
+	Reopen(options);
+
+	uint64_t first_manifest = dbfull()->TEST_Current_Manifest_FileNo();
+	// Every flush appends an edit; once the edits outgrow the snapshot
+	// at the head of the manifest, it has to be rolled over.
+	for (int i = 0; i < 20; i++) {
+		ASSERT_OK(Put("key" + ToString(i), std::string(100, 'v')));
+		ASSERT_OK(Flush());
+	}
+	uint64_t last_manifest = dbfull()->TEST_Current_Manifest_FileNo();
+	ASSERT_GT(last_manifest, first_manifest);
+
+	Reopen(options);
+	for (int i = 0; i < 20; i++) {
+		ASSERT_EQ(std::string(100, 'v'), Get("key" + ToString(i)));
+	}
+	ASSERT_EQ("20", FilesPerLevel());
+}
+
 TEST_F(DBBasicTest, IdentityAcrossRestarts)
 {
 	do {
@@ -10,6 +10,8 @@
 #include "cache/lru_cache.h"
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/block_cache_tracer.h"
 
 namespace rocksdb
 {
@@ -181,6 +183,120 @@ TEST_F(DBBlockCacheTest, TestWithoutCompressedBlockCache)
 	}
 }
 
+namespace
+{
+// Heap backed allocator counting its live blocks and reporting a fixed
+// overhead for each of them.
+class CountingMemoryAllocator : public MemoryAllocator {
+    public:
+	static const size_t kOverhead = 1000;
+
+	virtual const char *Name() const override
+	{
+		return "CountingMemoryAllocator";
+	}
+	virtual void *Allocate(size_t size) override
+	{
+		live_blocks_++;
+		return new char[size];
+	}
+	virtual void Deallocate(void *p) override
+	{
+		live_blocks_--;
+		delete[] reinterpret_cast<char *>(p);
+	}
+	virtual size_t UsableSize(void * /*p*/,
+				  size_t allocation_size) const override
+	{
+		return allocation_size + kOverhead;
+	}
+	int live_blocks() const
+	{
+		return live_blocks_.load();
+	}
+
+    private:
+	std::atomic<int> live_blocks_{ 0 };
+};
+} // anonymous namespace
+
+TEST_F(DBBlockCacheTest, MemoryAllocator)
+{
+	ReadOptions read_options;
+	auto table_options = GetTableOptions();
+	auto options = GetOptions(table_options);
+	InitTable(options);
+
+	auto allocator = std::make_shared<CountingMemoryAllocator>();
+	std::shared_ptr<Cache> cache =
+		NewLRUCache(1 << 20, 0, false, 0.0, false, allocator);
+	table_options.block_cache = cache;
+	options.table_factory.reset(new BlockBasedTableFactory(table_options));
+	Reopen(options);
+	// The index block of the table flushed during recovery
+	int table_blocks = allocator->live_blocks();
+	ASSERT_LT(0, table_blocks);
+	ASSERT_EQ(0, cache->GetUsage());
+
+	std::vector<std::unique_ptr<Iterator> > iterators(kNumBlocks);
+	for (size_t i = 0; i < kNumBlocks; i++) {
+		iterators[i].reset(db_->NewIterator(read_options));
+		iterators[i]->Seek(ToString(i));
+		ASSERT_OK(iterators[i]->status());
+	}
+	// Every data block came from the allocator and is charged for its
+	// overhead.
+	ASSERT_EQ(table_blocks + static_cast<int>(kNumBlocks),
+		  allocator->live_blocks());
+	ASSERT_LE(kNumBlocks * CountingMemoryAllocator::kOverhead,
+		  cache->GetUsage());
+
+	iterators.clear();
+	Close();
+	cache->EraseUnRefEntries();
+	ASSERT_EQ(0, allocator->live_blocks());
+}
+
+TEST_F(DBBlockCacheTest, MemoryAllocatorWithCompressedCache)
+{
+	ReadOptions read_options;
+	auto table_options = GetTableOptions();
+	auto options = GetOptions(table_options);
+	options.compression = kNoCompression;
+	InitTable(options);
+
+	auto allocator = std::make_shared<CountingMemoryAllocator>();
+	auto compressed_allocator = std::make_shared<CountingMemoryAllocator>();
+	std::shared_ptr<Cache> cache =
+		NewLRUCache(1 << 20, 0, false, 0.0, false, allocator);
+	std::shared_ptr<Cache> compressed_cache = NewLRUCache(
+		1 << 20, 0, false, 0.0, false, compressed_allocator);
+	table_options.block_cache = cache;
+	table_options.block_cache_compressed = compressed_cache;
+	options.table_factory.reset(new BlockBasedTableFactory(table_options));
+	Reopen(options);
+	int table_blocks = allocator->live_blocks();
+
+	std::vector<std::unique_ptr<Iterator> > iterators(kNumBlocks);
+	for (size_t i = 0; i < kNumBlocks; i++) {
+		iterators[i].reset(db_->NewIterator(read_options));
+		iterators[i]->Seek(ToString(i));
+		ASSERT_OK(iterators[i]->status());
+	}
+	// Uncompressed blocks cached in block_cache are owned by its
+	// allocator, not by the one they were read with.
+	ASSERT_EQ(table_blocks + static_cast<int>(kNumBlocks),
+		  allocator->live_blocks());
+	ASSERT_EQ(0, compressed_allocator->live_blocks());
+
+	iterators.clear();
+	Close();
+	cache->EraseUnRefEntries();
+	compressed_cache->EraseUnRefEntries();
+	ASSERT_EQ(0, allocator->live_blocks());
+	ASSERT_EQ(0, compressed_allocator->live_blocks());
+}
+
 #ifdef SNAPPY
 TEST_F(DBBlockCacheTest, TestWithCompressedBlockCache)
 {
@@ -629,6 +745,75 @@ TEST_F(DBBlockCacheTest, CompressedCache)
 	}
 }
 
+TEST_F(DBBlockCacheTest, TraceBlockCacheAccess)
+{
+	auto table_options = GetTableOptions();
+	table_options.block_cache = NewLRUCache(1 << 20);
+	auto options = GetOptions(table_options);
+	DestroyAndReopen(options);
+	InitTable(options);
+	ASSERT_OK(Flush());
+
+	const std::string trace_file = dbname_ + "/block_cache_trace";
+	std::unique_ptr<TraceWriter> trace_writer;
+	ASSERT_OK(NewFileTraceWriter(env_, EnvOptions(), trace_file,
+				     &trace_writer));
+	ASSERT_OK(db_->StartBlockCacheTrace(TraceOptions(),
+					    std::move(trace_writer)));
+	ASSERT_OK(NewFileTraceWriter(env_, EnvOptions(), trace_file + ".2",
+				     &trace_writer));
+	ASSERT_TRUE(db_->StartBlockCacheTrace(TraceOptions(),
+					      std::move(trace_writer))
+			    .IsBusy());
+	// Each key has a block of its own: a miss, then a hit
+	for (int round = 0; round < 2; round++) {
+		for (size_t i = 0; i < kNumBlocks; i++) {
+			ASSERT_EQ(std::string(kValueSize, 'a'),
+				  Get(ToString(i)));
+		}
+	}
+	{
+		std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+		iter->Seek(ToString(0));
+		ASSERT_TRUE(iter->Valid());
+	}
+	ASSERT_OK(db_->EndBlockCacheTrace());
+	ASSERT_TRUE(db_->EndBlockCacheTrace().IsIOError());
+
+	std::unique_ptr<TraceReader> trace_reader;
+	ASSERT_OK(NewFileTraceReader(env_, EnvOptions(), trace_file,
+				     &trace_reader));
+	BlockCacheTraceReader reader(std::move(trace_reader));
+	ASSERT_OK(reader.ReadHeader());
+	size_t gets = 0;
+	size_t get_hits = 0;
+	size_t iterator_hits = 0;
+	BlockCacheTraceRecord record;
+	Status s;
+	while ((s = reader.ReadAccess(&record)).ok()) {
+		ASSERT_EQ(kTraceDataBlock, record.block_type);
+		ASSERT_EQ(0U, record.cf_id);
+		ASSERT_EQ(0, record.level);
+		ASSERT_LT(0U, record.block_size);
+		ASSERT_FALSE(record.block_key.empty());
+		ASSERT_FALSE(record.no_insert);
+		if (record.caller == kTraceUserGet) {
+			gets++;
+			get_hits += record.is_cache_hit ? 1 : 0;
+		} else {
+			ASSERT_EQ(kTraceUserIterator, record.caller);
+			ASSERT_TRUE(record.is_cache_hit);
+			iterator_hits++;
+		}
+	}
+	ASSERT_TRUE(s.IsIncomplete());
+	ASSERT_EQ(2 * kNumBlocks, gets);
+	ASSERT_EQ(kNumBlocks, get_hits);
+	ASSERT_LE(1U, iterator_hits);
+	ASSERT_OK(env_->DeleteFile(trace_file));
+	ASSERT_OK(env_->DeleteFile(trace_file + ".2"));
+}
+
 #endif // ROCKSDB_LITE
 
 } // namespace rocksdb
@@ -148,7 +148,8 @@ DBImpl::DBImpl(const DBOptions &options, const std::string &dbname)
 	  stats_(immutable_db_options_.statistics.get()), db_lock_(nullptr),
 	  mutex_(stats_, env_, DB_MUTEX_WAIT_MICROS,
 		 immutable_db_options_.use_adaptive_mutex),
-	  shutting_down_(false), bg_cv_(&mutex_), logfile_number_(0),
+	  shutting_down_(false), tracing_(false), bg_cv_(&mutex_),
+	  logfile_number_(0),
 	  log_dir_synced_(false), log_empty_(true), default_cf_handle_(nullptr),
 	  log_sync_cv_(&mutex_), total_log_size_(0),
 	  max_total_in_memory_state_(0), is_snapshot_supported_(true),
@@ -166,6 +167,7 @@ DBImpl::DBImpl(const DBOptions &options, const std::string &dbname)
 	  unscheduled_compactions_(0), bg_compaction_scheduled_(0),
 	  num_running_compactions_(0), bg_flush_scheduled_(0),
 	  num_running_flushes_(0), bg_purge_scheduled_(0),
+	  bg_wal_pool_scheduled_(0), table_meta_manifest_number_(0),
 	  disable_delete_obsolete_files_(0),
 	  delete_obsolete_files_last_run_(env_->NowMicros()),
 	  last_stats_dump_time_microsec_(0), next_job_id_(1),
@@ -194,7 +196,8 @@ DBImpl::DBImpl(const DBOptions &options, const std::string &dbname)
 
 	versions_.reset(new VersionSet(
 		dbname_, &immutable_db_options_, env_options_,
-		table_cache_.get(), write_buffer_manager_, &write_controller_));
+		table_cache_.get(), write_buffer_manager_, &write_controller_,
+		&block_cache_tracer_));
 	column_family_memtables_.reset(
 		new ColumnFamilyMemTablesImpl(versions_->GetColumnFamilySet()));
 
@@ -242,6 +245,9 @@ void DBImpl::CancelAllBackgroundWork(bool wait)
 
 DBImpl::~DBImpl()
 {
+	if (stats_history_) {
+		stats_history_->Stop();
+	}
 	// CancelAllBackgroundWork called with false means we just set the shutdown
 	// marker. After this we do a variant of the waiting and unschedule work
 	// (to consider: moving all the waiting into CancelAllBackgroundWork(true))
@@ -255,7 +261,7 @@ DBImpl::~DBImpl()
 
 	// Wait for background work to finish
 	while (bg_compaction_scheduled_ || bg_flush_scheduled_ ||
-	       bg_purge_scheduled_) {
+	       bg_purge_scheduled_ || bg_wal_pool_scheduled_) {
 		TEST_SYNC_POINT("DBImpl::~DBImpl:WaitJob");
 		bg_cv_.Wait();
 	}
@@ -303,6 +309,10 @@ DBImpl::~DBImpl()
 		}
 		job_context.Clean();
 		mutex_.Lock();
+
+		if (immutable_db_options_.persist_table_meta_snapshot) {
+			WriteTableMetaSnapshot();
+		}
 	}
 
 	for (auto l : logs_to_free_) {
@@ -505,6 +515,7 @@ Status DBImpl::SetOptions(
 			auto *old_sv = InstallSuperVersionAndScheduleWork(
 				cfd, nullptr, new_options);
 			delete old_sv;
+			NotifyOnStallConditionsChanged();
 
 			persist_options_status = WriteOptionsFile(
 				false /*need_mutex_lock*/,
@@ -770,8 +781,8 @@ void DBImpl::SchedulePurge()
 
 	// Purge operations are put into High priority queue
 	bg_purge_scheduled_++;
-	env_->Schedule(&DBImpl::BGWorkPurge, this, Env::Priority::HIGH,
-		       nullptr);
+	env_->ScheduleJob(&DBImpl::BGWorkPurge, this, Env::Priority::HIGH,
+			  Env::JOB_DELETION, nullptr);
 }
 
 void DBImpl::BackgroundCallPurge()
@@ -933,6 +944,12 @@ Status DBImpl::Get(const ReadOptions &read_options,
 		   ColumnFamilyHandle *column_family, const Slice &key,
 		   PinnableSlice *value)
 {
+	if (tracing_.load(std::memory_order_relaxed)) {
+		std::shared_ptr<Tracer> tracer = std::atomic_load(&tracer_);
+		if (tracer) {
+			tracer->Get(column_family->GetID(), key);
+		}
+	}
 	return GetImpl(read_options, column_family, key, value);
 }
 
@@ -946,6 +963,9 @@ Status DBImpl::GetImpl(const ReadOptions &read_options,
 
 	auto cfh = reinterpret_cast<ColumnFamilyHandleImpl *>(column_family);
 	auto cfd = cfh->cfd();
+	AutoThreadOperationUpdater op_updater(
+		env_, cfd, immutable_db_options_.enable_thread_tracking,
+		ThreadStatus::OP_GET);
 
 	// Acquire SuperVersion
 	SuperVersion *sv = GetAndRefSuperVersion(cfd);
@@ -1451,8 +1471,96 @@ bool DBImpl::KeyMayExist(const ReadOptions &read_options,
 	return s.ok() || s.IsIncomplete();
 }
 
+namespace
+{
+// Reports the seeks of an iterator created while the DB was traced.
+class TracedIterator : public Iterator {
+    public:
+	TracedIterator(DBImpl *db, uint32_t cf_id, Iterator *iter)
+		: db_(db), cf_id_(cf_id), iter_(iter)
+	{
+	}
+
+	virtual bool Valid() const override
+	{
+		return iter_->Valid();
+	}
+	virtual void SeekToFirst() override
+	{
+		iter_->SeekToFirst();
+	}
+	virtual void SeekToLast() override
+	{
+		iter_->SeekToLast();
+	}
+	virtual void Seek(const Slice &target) override
+	{
+		db_->TraceIteratorSeek(cf_id_, target, false);
+		iter_->Seek(target);
+	}
+	virtual void SeekForPrev(const Slice &target) override
+	{
+		db_->TraceIteratorSeek(cf_id_, target, true);
+		iter_->SeekForPrev(target);
+	}
+	virtual void Next() override
+	{
+		iter_->Next();
+	}
+	virtual void Prev() override
+	{
+		iter_->Prev();
+	}
+	virtual Slice key() const override
+	{
+		return iter_->key();
+	}
+	virtual Slice value() const override
+	{
+		return iter_->value();
+	}
+	virtual Status status() const override
+	{
+		return iter_->status();
+	}
+	virtual Status GetProperty(std::string prop_name,
+				   std::string *prop) override
+	{
+		return iter_->GetProperty(prop_name, prop);
+	}
+
+    private:
+	DBImpl *db_;
+	uint32_t cf_id_;
+	std::unique_ptr<Iterator> iter_;
+};
+} // namespace
+
+void DBImpl::TraceIteratorSeek(uint32_t cf_id, const Slice &key,
+			       bool for_prev)
+{
+	std::shared_ptr<Tracer> tracer = std::atomic_load(&tracer_);
+	if (tracer) {
+		if (for_prev) {
+			tracer->IteratorSeekForPrev(cf_id, key);
+		} else {
+			tracer->IteratorSeek(cf_id, key);
+		}
+	}
+}
+
 Iterator *DBImpl::NewIterator(const ReadOptions &read_options,
 			      ColumnFamilyHandle *column_family)
+{
+	Iterator *iter = NewIteratorImpl(read_options, column_family);
+	if (iter != nullptr && tracing_.load(std::memory_order_relaxed)) {
+		iter = new TracedIterator(this, column_family->GetID(), iter);
+	}
+	return iter;
+}
+
+Iterator *DBImpl::NewIteratorImpl(const ReadOptions &read_options,
+				  ColumnFamilyHandle *column_family)
 {
 	if (read_options.read_tier == kPersistedTier) {
 		return NewErrorIterator(Status::NotSupported(
@@ -1739,6 +1847,46 @@ Status DBImpl::GetPropertiesOfTablesInRange(ColumnFamilyHandle *column_family,
 	return s;
 }
 
+Status DBImpl::StartTrace(const TraceOptions &trace_options,
+			  std::unique_ptr<TraceWriter> &&trace_writer)
+{
+	InstrumentedMutexLock lock(&trace_mutex_);
+	if (tracer_) {
+		return Status::Busy("A trace is already running");
+	}
+	std::atomic_store(&tracer_,
+			  std::make_shared<Tracer>(env_, trace_options,
+						   std::move(trace_writer)));
+	tracing_.store(true, std::memory_order_relaxed);
+	return Status::OK();
+}
+
+Status DBImpl::EndTrace()
+{
+	InstrumentedMutexLock lock(&trace_mutex_);
+	if (!tracer_) {
+		return Status::IOError("No trace running");
+	}
+	tracing_.store(false, std::memory_order_relaxed);
+	std::shared_ptr<Tracer> tracer =
+		std::atomic_exchange(&tracer_, std::shared_ptr<Tracer>());
+	// Operations that loaded the tracer before may still add records;
+	// the ones racing with Close() are dropped.
+	return tracer->Close();
+}
+
+Status DBImpl::StartBlockCacheTrace(const TraceOptions &trace_options,
+				    std::unique_ptr<TraceWriter> &&trace_writer)
+{
+	return block_cache_tracer_.StartTrace(env_, trace_options,
+					      std::move(trace_writer));
+}
+
+Status DBImpl::EndBlockCacheTrace()
+{
+	return block_cache_tracer_.EndTrace();
+}
+
 #endif // ROCKSDB_LITE
 
 const std::string &DBImpl::GetName() const
@@ -1902,6 +2050,97 @@ bool DBImpl::GetAggregatedIntProperty(const Slice &property,
 	return true;
 }
 
+Status DBImpl::StartStatsHistory()
+{
+	if (immutable_db_options_.stats_persist_period_sec == 0) {
+		return Status::OK();
+	}
+	std::unique_ptr<StatsHistoryFileWriter> file_writer;
+	if (!immutable_db_options_.stats_history_file.empty()) {
+		Status s = NewStatsHistoryFileWriter(
+			env_, env_options_,
+			immutable_db_options_.stats_history_file,
+			immutable_db_options_.max_stats_history_file_size,
+			&file_writer);
+		if (!s.ok()) {
+			return s;
+		}
+	}
+	stats_history_.reset(new StatsHistory(
+		env_,
+		uint64_t{ immutable_db_options_.stats_persist_period_sec } *
+			1000000,
+		immutable_db_options_.stats_history_buffer_size,
+		std::move(file_writer),
+		[this](StatsMap *counters, StatsMap *gauges) {
+			CollectStats(counters, gauges);
+		},
+		immutable_db_options_.info_log.get()));
+	stats_history_->Start();
+	return Status::OK();
+}
+
+void DBImpl::CollectStats(StatsMap *counters, StatsMap *gauges)
+{
+	Statistics *statistics = immutable_db_options_.statistics.get();
+	if (statistics != nullptr) {
+		for (const auto &ticker : TickersNameMap) {
+			(*counters)[ticker.second] =
+				statistics->getTickerCount(ticker.first);
+		}
+		for (const auto &histogram : HistogramsNameMap) {
+			HistogramData data;
+			statistics->histogramData(histogram.first, &data);
+			(*counters)[histogram.second + ".count"] = data.count;
+			(*counters)[histogram.second + ".sum"] = data.sum;
+		}
+	}
+
+	// Summed over the column families
+	static const std::string kAggregatedProperties[] = {
+		DB::Properties::kNumImmutableMemTable,
+		DB::Properties::kCurSizeAllMemTables,
+		DB::Properties::kEstimateNumKeys,
+		DB::Properties::kTotalSstFilesSize,
+		DB::Properties::kEstimatePendingCompactionBytes,
+		DB::Properties::kNumLiveVersions,
+	};
+	// Of the whole DB
+	static const std::string kDBProperties[] = {
+		DB::Properties::kNumRunningFlushes,
+		DB::Properties::kNumRunningCompactions,
+		DB::Properties::kActualDelayedWriteRate,
+		DB::Properties::kIsWriteStopped,
+		DB::Properties::kNumSnapshots,
+	};
+	uint64_t value;
+	for (const std::string &property : kAggregatedProperties) {
+		if (GetAggregatedIntProperty(property, &value)) {
+			(*gauges)[property] = value;
+		}
+	}
+	for (const std::string &property : kDBProperties) {
+		if (GetIntProperty(DefaultColumnFamily(), property, &value)) {
+			(*gauges)[property] = value;
+		}
+	}
+}
+
+Status
+DBImpl::GetStatsHistory(uint64_t start_time, uint64_t end_time,
+			std::unique_ptr<StatsHistoryIterator> *stats_iterator)
+{
+	if (!stats_history_) {
+		return Status::NotSupported(
+			"stats_persist_period_sec is not set");
+	}
+	std::vector<StatsSnapshot> snapshots;
+	stats_history_->GetSnapshots(start_time, end_time, &snapshots);
+	stats_iterator->reset(
+		NewInMemoryStatsHistoryIterator(std::move(snapshots)));
+	return Status::OK();
+}
+
 SuperVersion *DBImpl::GetAndRefSuperVersion(ColumnFamilyData *cfd)
 {
 	// TODO(ljin): consider using GetReferencedSuperVersion() directly
@@ -1981,6 +2220,19 @@ DBImpl::GetColumnFamilyHandleUnlocked(uint32_t column_family_id)
 	return cf_memtables->GetColumnFamilyHandle();
 }
 
+std::unique_ptr<ColumnFamilyHandle>
+DBImpl::NewColumnFamilyHandleUnlocked(uint32_t column_family_id)
+{
+	InstrumentedMutexLock l(&mutex_);
+	auto *cfd = versions_->GetColumnFamilySet()->GetColumnFamily(
+		column_family_id);
+	if (cfd == nullptr || cfd->IsDropped()) {
+		return nullptr;
+	}
+	return std::unique_ptr<ColumnFamilyHandle>(
+		new ColumnFamilyHandleImpl(cfd, this, &mutex_));
+}
+
 void DBImpl::GetApproximateMemTableStats(ColumnFamilyHandle *column_family,
 					 const Range &range,
 					 uint64_t *const count,
@@ -2278,6 +2530,63 @@ Status DBImpl::DeleteFilesInRange(ColumnFamilyHandle *column_family,
 	return status;
 }
 
+Status DBImpl::DeleteTableFiles(ColumnFamilyHandle *column_family,
+				const std::set<uint64_t> &file_numbers)
+{
+	Status status;
+	auto cfh = reinterpret_cast<ColumnFamilyHandleImpl *>(column_family);
+	ColumnFamilyData *cfd = cfh->cfd();
+	VersionEdit edit;
+	std::vector<FileMetaData *> deleted_files;
+	JobContext job_context(next_job_id_.fetch_add(1), true);
+	{
+		InstrumentedMutexLock l(&mutex_);
+		Version *input_version = cfd->current();
+
+		auto *vstorage = input_version->storage_info();
+		for (int i = 0; i < cfd->NumberLevels(); i++) {
+			for (auto *level_file : vstorage->LevelFiles(i)) {
+				if (level_file->being_compacted ||
+				    file_numbers.count(
+					    level_file->fd.GetNumber()) == 0) {
+					continue;
+				}
+				edit.SetColumnFamily(cfd->GetID());
+				edit.DeleteFile(i, level_file->fd.GetNumber());
+				deleted_files.push_back(level_file);
+				level_file->being_compacted = true;
+			}
+		}
+		if (edit.GetDeletedFiles().empty()) {
+			job_context.Clean();
+			return Status::OK();
+		}
+		input_version->Ref();
+		status = versions_->LogAndApply(
+			cfd, *cfd->GetLatestMutableCFOptions(), &edit, &mutex_,
+			directories_.GetDbDir());
+		if (status.ok()) {
+			InstallSuperVersionAndScheduleWorkWrapper(
+				cfd, &job_context,
+				*cfd->GetLatestMutableCFOptions());
+		}
+		for (auto *deleted_file : deleted_files) {
+			deleted_file->being_compacted = false;
+		}
+		input_version->Unref();
+		FindObsoleteFiles(&job_context, false);
+	} // lock released here
+
+	LogFlush(immutable_db_options_.info_log);
+	// remove files outside the db-lock
+	if (job_context.HaveSomethingToDelete()) {
+		// Call PurgeObsoleteFiles() without holding mutex.
+		PurgeObsoleteFiles(job_context);
+	}
+	job_context.Clean();
+	return status;
+}
+
 void DBImpl::GetLiveFilesMetaData(std::vector<LiveFileMetaData> *metadata)
 {
 	InstrumentedMutexLock l(&mutex_);
@@ -2492,10 +2801,10 @@ Status DestroyDB(const std::string &dbname, const Options &options)
 			archivedir = ArchivalDirectory(soptions.wal_dir);
 		}
 
-		// Delete log files in the WAL dir
+		// Delete log files and WAL pool files in the WAL dir
 		for (const auto &file : walDirFiles) {
 			if (ParseFileName(file, &number, &type) &&
-			    type == kLogFile) {
+			    (type == kLogFile || type == kWalPoolFile)) {
 				Status del = env->DeleteFile(soptions.wal_dir +
 							     "/" + file);
 				if (result.ok() && !del.ok()) {
@@ -2599,15 +2908,15 @@ namespace
 {
 void DeleteOptionsFilesHelper(const std::map<uint64_t, std::string> &filenames,
 			      const size_t num_files_to_keep,
-			      const std::shared_ptr<Logger> &info_log, Env *env)
+			      const ImmutableDBOptions &db_options)
 {
 	if (filenames.size() <= num_files_to_keep) {
 		return;
 	}
 	for (auto iter = std::next(filenames.begin(), num_files_to_keep);
 	     iter != filenames.end(); ++iter) {
-		if (!env->DeleteFile(iter->second).ok()) {
-			ROCKS_LOG_WARN(info_log,
+		if (!DeleteDBFile(&db_options, iter->second, true).ok()) {
+			ROCKS_LOG_WARN(db_options.info_log,
 				       "Unable to delete options file %s",
 				       iter->second.c_str());
 		}
@@ -2643,7 +2952,7 @@ Status DBImpl::DeleteObsoleteOptionsFiles()
 	// Keeps the latest 2 Options file
 	const size_t kNumOptionsFilesKept = 2;
 	DeleteOptionsFilesHelper(options_filenames, kNumOptionsFilesKept,
-				 immutable_db_options_.info_log, GetEnv());
+				 immutable_db_options_);
 	return Status::OK();
 #else
 	return Status::OK();
@@ -35,20 +35,24 @@
 #include "db/write_thread.h"
 #include "memtable_list.h"
 #include "monitoring/instrumented_mutex.h"
+#include "monitoring/stats_history.h"
 #include "options/db_options.h"
 #include "port/port.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
+#include "rocksdb/listener.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/status.h"
 #include "rocksdb/transaction_log.h"
 #include "rocksdb/write_buffer_manager.h"
 #include "table/scoped_arena_iterator.h"
 #include "util/autovector.h"
+#include "util/block_cache_tracer.h"
 #include "util/event_logger.h"
 #include "util/hash.h"
 #include "util/stop_watch.h"
 #include "util/thread_local.h"
+#include "util/trace_replay.h"
 
 namespace rocksdb
 {
@@ -151,6 +155,9 @@ class DBImpl : public DB {
 	virtual bool
 	GetAggregatedIntProperty(const Slice &property,
 				 uint64_t *aggregated_value) override;
+	virtual Status GetStatsHistory(
+		uint64_t start_time, uint64_t end_time,
+		std::unique_ptr<StatsHistoryIterator> *stats_iterator) override;
 	using DB::GetApproximateSizes;
 	virtual void
 	GetApproximateSizes(ColumnFamilyHandle *column_family,
@@ -235,6 +242,11 @@ class DBImpl : public DB {
 	virtual Status DeleteFile(std::string name) override;
 	Status DeleteFilesInRange(ColumnFamilyHandle *column_family,
 				  const Slice *begin, const Slice *end);
+	// Deletes the table files of the column family with the given numbers,
+	// from any level, without compacting them. Files being compacted, and
+	// numbers of no live file, are skipped.
+	Status DeleteTableFiles(ColumnFamilyHandle *column_family,
+				const std::set<uint64_t> &file_numbers);
 
 	virtual void
 	GetLiveFilesMetaData(std::vector<LiveFileMetaData> *metadata) override;
@@ -251,6 +263,14 @@ class DBImpl : public DB {
 	Status SuggestCompactRange(ColumnFamilyHandle *column_family,
 				   const Slice *begin, const Slice *end);
 
+	// Marks the table files of the column family with the given numbers for
+	// compaction, which the compaction picker favours. With level style
+	// compaction, the marked files of the last level with data are
+	// compacted within that level.
+	Status
+	MarkTableFilesForCompaction(ColumnFamilyHandle *column_family,
+				    const std::set<uint64_t> &file_numbers);
+
 	Status PromoteL0(ColumnFamilyHandle *column_family, int target_level);
 
 	// Similar to Write() but will call the callback once on the single write
@@ -259,6 +279,10 @@ class DBImpl : public DB {
 					 WriteBatch *my_batch,
 					 WriteCallback *callback);
 
+	// Record a seek of an iterator created while tracing.
+	void TraceIteratorSeek(uint32_t cf_id, const Slice &key,
+			       bool for_prev);
+
 	// Returns the sequence number that is guaranteed to be smaller than or equal
 	// to the sequence number of any key that could be inserted into the current
 	// memtables. It can then be assumed that any write with a larger(or equal)
@@ -344,6 +368,9 @@ class DBImpl : public DB {
 
 	void TEST_HandleWALFull();
 
+	// Take a stats history snapshot now
+	void TEST_TakeStatsSnapshot();
+
 	bool TEST_UnableToFlushOldestLog()
 	{
 		return unable_to_flush_oldest_log_;
@@ -468,6 +495,34 @@ class DBImpl : public DB {
 
 	void SchedulePurge();
 
+	// Persist the stats of all live table files to the TABLEMETA file so
+	// that the next DB::Open does not need to read them from the tables.
+	// REQUIRES: mutex held. Releases it while writing the file.
+	void WriteTableMetaSnapshot();
+
+	// Call WriteTableMetaSnapshot() if the MANIFEST was rolled over since
+	// the last snapshot, so that a DB that crashes does not lose the
+	// speedup for all the files it had before that roll-over.
+	// REQUIRES: mutex held. Releases it while writing the file.
+	void MaybeWriteTableMetaSnapshot();
+
+	// Adopt the WAL pool files left by a previous instance and start
+	// filling the pool up to wal_pool_size. Called once from DB::Open.
+	// REQUIRES: mutex held.
+	void InitWalPool();
+
+	// Schedule a background job creating pool files if the pool is
+	// short. REQUIRES: mutex held.
+	void MaybeScheduleWalPoolRefill();
+
+	// Start snapshotting the statistics if stats_persist_period_sec is
+	// set. Called once from DB::Open. REQUIRES: mutex not held.
+	Status StartStatsHistory();
+
+	// The statistics a stats history snapshot keeps: tickers and
+	// histogram counts and sums as counters, DB properties as gauges.
+	void CollectStats(StatsMap *counters, StatsMap *gauges);
+
 	ColumnFamilyHandle *DefaultColumnFamily() const override;
 
 	const SnapshotList &snapshots() const
@@ -514,6 +569,12 @@ class DBImpl : public DB {
 	ColumnFamilyHandle *
 	GetColumnFamilyHandleUnlocked(uint32_t column_family_id);
 
+	// Returns a new handle to the column family, owned by the caller, or
+	// nullptr if it doesn't exist or was dropped. Unlike the above, the
+	// handle stays valid. Should be called without mutex held.
+	std::unique_ptr<ColumnFamilyHandle>
+	NewColumnFamilyHandleUnlocked(uint32_t column_family_id);
+
 	// Returns the number of currently running flushes.
 	// REQUIREMENT: mutex_ must be held when calling this function.
 	int num_running_flushes()
@@ -616,6 +677,9 @@ class DBImpl : public DB {
     protected:
 	Env *const env_;
 	const std::string dbname_;
+	// Shared by the table readers of all column families; declared before
+	// versions_ so that it outlives them.
+	BlockCacheTracer block_cache_tracer_;
 	unique_ptr<VersionSet> versions_;
 	const DBOptions initial_db_options_;
 	const ImmutableDBOptions immutable_db_options_;
@@ -657,6 +721,9 @@ class DBImpl : public DB {
 					 int job_id);
 	void NotifyOnMemTableSealed(ColumnFamilyData *cfd,
 				    const MemTableInfo &mem_table_info);
+	// Delivers the queued write_stall_notifications_. Releases the DB
+	// mutex while calling the listeners, if there is any to deliver.
+	void NotifyOnStallConditionsChanged();
 
 #ifndef ROCKSDB_LITE
 	void NotifyOnExternalFileIngested(
@@ -848,6 +915,14 @@ class DBImpl : public DB {
 	ColumnFamilyData *GetColumnFamilyDataByName(const std::string &cf_name);
 
 	void MaybeScheduleFlushOrCompaction();
+	// Thread pool job class of a compaction: L0 compactions unblock
+	// flushes and writers, so they overtake deeper ones
+	static Env::JobPriority CompactionJobPriority(const Compaction &c);
+	// Job class of the compaction the picker would pick for cfd now
+	Env::JobPriority CompactionJobPriority(ColumnFamilyData *cfd) const;
+	// Moves the first column family of compaction_queue_ whose compaction
+	// is of class job_pri to the front, if there is one
+	void MoveToFrontOfCompactionQueue(Env::JobPriority job_pri);
 	void SchedulePendingFlush(ColumnFamilyData *cfd);
 	void SchedulePendingCompaction(ColumnFamilyData *cfd);
 	void SchedulePendingPurge(std::string fname, FileType type,
@@ -856,12 +931,16 @@ class DBImpl : public DB {
 	static void BGWorkCompaction(void *arg);
 	static void BGWorkFlush(void *db);
 	static void BGWorkPurge(void *arg);
+	static void BGWorkWalPool(void *db);
 	static void UnscheduleCallback(void *arg);
-	void BackgroundCallCompaction(void *arg);
+	void BackgroundCallCompaction(void *arg, Env::JobPriority job_pri);
 	void BackgroundCallFlush();
 	void BackgroundCallPurge();
+	void BackgroundCallWalPool();
 	Status BackgroundCompaction(bool *madeProgress, JobContext *job_context,
-				    LogBuffer *log_buffer, void *m = 0);
+				    LogBuffer *log_buffer, void *m = 0,
+				    Env::JobPriority job_pri =
+					    Env::JOB_COMPACTION);
 	Status BackgroundFlush(bool *madeProgress, JobContext *job_context,
 			       LogBuffer *log_buffer);
 
@@ -911,6 +990,16 @@ class DBImpl : public DB {
 	mutable InstrumentedMutex mutex_;
 
 	std::atomic<bool> shutting_down_;
+
+	// Set while tracer_ is. The read and write paths check it before
+	// loading tracer_, so tracing costs nothing when it is off.
+	std::atomic<bool> tracing_;
+	// Serializes StartTrace() and EndTrace(). The traced operations load
+	// tracer_ with std::atomic_load() instead, and keep the Tracer alive
+	// through the shared_ptr while they record to it.
+	InstrumentedMutex trace_mutex_;
+	std::shared_ptr<Tracer> tracer_;
+
 	// This condition variable is signaled on these conditions:
 	// * whenever bg_compaction_scheduled_ goes down to 0
 	// * if AnyManualCompaction, whenever a compaction finishes, even if it hasn't
@@ -1095,6 +1184,10 @@ class DBImpl : public DB {
 	// ColumnFamilyData::pending_compaction_ == true)
 	std::deque<ColumnFamilyData *> compaction_queue_;
 
+	// Changes of the write stall conditions of the column families not yet
+	// delivered to the listeners
+	std::deque<WriteStallInfo> write_stall_notifications_;
+
 	// A queue to store filenames of the files to be purged
 	std::deque<PurgeFileInfo> purge_queue_;
 
@@ -1118,6 +1211,20 @@ class DBImpl : public DB {
 	// number of background obsolete file purge jobs, submitted to the HIGH pool
 	int bg_purge_scheduled_;
 
+	// Pre-sized files ready to become the next WAL, oldest first. Only
+	// used when wal_pool_size > 0.
+	std::deque<std::string> wal_pool_;
+
+	// number of background WAL pool refill jobs, submitted to the HIGH pool
+	int bg_wal_pool_scheduled_;
+
+	// Number of the MANIFEST the last table meta snapshot was taken under,
+	// 0 if none was taken yet
+	uint64_t table_meta_manifest_number_;
+
+	// Periodic statistics snapshots, if stats_persist_period_sec > 0
+	std::unique_ptr<StatsHistory> stats_history_;
+
 	// Information for a manual compaction
 	struct ManualCompaction {
 		ColumnFamilyData *cfd;
@@ -1144,6 +1251,8 @@ class DBImpl : public DB {
 	struct CompactionArg {
 		DBImpl *db;
 		ManualCompaction *m;
+		// Class the job was scheduled with
+		Env::JobPriority job_pri;
 	};
 
 	// Have we encountered a background error in paranoid mode?
@@ -1255,6 +1364,11 @@ class DBImpl : public DB {
 		ColumnFamilyData *cfd, SuperVersion *new_sv,
 		const MutableCFOptions &mutable_cf_options);
 
+	// Tell options.rate_limiter how close the column families are to write
+	// stall triggers, so that an auto-tuned rate limiter can react.
+	// REQUIRES: mutex locked
+	void ReportCompactionPressure();
+
 #ifndef ROCKSDB_LITE
 	using DB::GetPropertiesOfAllTables;
 	virtual Status
@@ -1265,8 +1379,22 @@ class DBImpl : public DB {
 				     const Range *range, std::size_t n,
 				     TablePropertiesCollection *props) override;
 
+	virtual Status StartTrace(const TraceOptions &options,
+				  std::unique_ptr<TraceWriter> &&trace_writer)
+		override;
+	virtual Status EndTrace() override;
+
+	virtual Status
+	StartBlockCacheTrace(const TraceOptions &options,
+			     std::unique_ptr<TraceWriter> &&trace_writer)
+		override;
+	virtual Status EndBlockCacheTrace() override;
 #endif // ROCKSDB_LITE
 
+	// NewIterator() without the tracing wrapper
+	Iterator *NewIteratorImpl(const ReadOptions &options,
+				  ColumnFamilyHandle *column_family);
+
 	// Function that Get and KeyMayExist call with no_io true or false
 	// Note: 'value_found' from KeyMayExist propagates here
 	Status GetImpl(const ReadOptions &options,
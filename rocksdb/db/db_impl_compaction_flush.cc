@@ -18,6 +18,7 @@
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/thread_status_updater.h"
 #include "monitoring/thread_status_util.h"
+#include "rocksdb/rate_limiter.h"
 #include "util/sst_file_manager_impl.h"
 #include "util/sync_point.h"
 
@@ -262,6 +263,29 @@ void DBImpl::NotifyOnFlushCompleted(ColumnFamilyData *cfd,
 #endif // ROCKSDB_LITE
 }
 
+void DBImpl::NotifyOnStallConditionsChanged()
+{
+#ifndef ROCKSDB_LITE
+	mutex_.AssertHeld();
+	if (write_stall_notifications_.empty()) {
+		return;
+	}
+	std::deque<WriteStallInfo> notifications;
+	notifications.swap(write_stall_notifications_);
+	if (shutting_down_.load(std::memory_order_acquire)) {
+		return;
+	}
+	// release lock while notifying events
+	mutex_.Unlock();
+	for (const auto &info : notifications) {
+		for (auto listener : immutable_db_options_.listeners) {
+			listener->OnStallConditionsChanged(info);
+		}
+	}
+	mutex_.Lock();
+#endif // ROCKSDB_LITE
+}
+
 Status DBImpl::CompactRange(const CompactRangeOptions &options,
 			    ColumnFamilyHandle *column_family,
 			    const Slice *begin, const Slice *end)
@@ -947,11 +971,12 @@ Status DBImpl::RunManualCompaction(ColumnFamilyData *cfd, int input_level,
 			ca = new CompactionArg;
 			ca->db = this;
 			ca->m = &manual;
+			ca->job_pri = CompactionJobPriority(*manual.compaction);
 			manual.incomplete = false;
 			bg_compaction_scheduled_++;
-			env_->Schedule(&DBImpl::BGWorkCompaction, ca,
-				       Env::Priority::LOW, this,
-				       &DBImpl::UnscheduleCallback);
+			env_->ScheduleJob(&DBImpl::BGWorkCompaction, ca,
+					  Env::Priority::LOW, ca->job_pri, this,
+					  &DBImpl::UnscheduleCallback);
 			scheduled = true;
 		}
 	}
@@ -1064,8 +1089,8 @@ void DBImpl::MaybeScheduleFlushOrCompaction()
 	       bg_flush_scheduled_ < bg_job_limits.max_flushes) {
 		unscheduled_flushes_--;
 		bg_flush_scheduled_++;
-		env_->Schedule(&DBImpl::BGWorkFlush, this, Env::Priority::HIGH,
-			       this);
+		env_->ScheduleJob(&DBImpl::BGWorkFlush, this,
+				  Env::Priority::HIGH, Env::JOB_FLUSH, this);
 	}
 
 	// special case -- if high-pri (flush) thread pool is empty, then schedule
@@ -1076,8 +1101,9 @@ void DBImpl::MaybeScheduleFlushOrCompaction()
 			       bg_job_limits.max_flushes) {
 			unscheduled_flushes_--;
 			bg_flush_scheduled_++;
-			env_->Schedule(&DBImpl::BGWorkFlush, this,
-				       Env::Priority::LOW, this);
+			env_->ScheduleJob(&DBImpl::BGWorkFlush, this,
+					  Env::Priority::LOW, Env::JOB_FLUSH,
+					  this);
 		}
 	}
 
@@ -1092,16 +1118,63 @@ void DBImpl::MaybeScheduleFlushOrCompaction()
 		return;
 	}
 
+	// Automatic compactions are picked once a thread runs them. Each job
+	// takes the class of one queued column family's next compaction, and
+	// BackgroundCompaction() picks from a column family of that class, so
+	// that the job compacts what it was ordered by.
+	// The column families without a job yet are at the back
+	const size_t unscheduled =
+		static_cast<size_t>(std::max(unscheduled_compactions_, 0));
+	size_t queue_pos = unscheduled < compaction_queue_.size() ?
+				   compaction_queue_.size() - unscheduled :
+				   0;
 	while (bg_compaction_scheduled_ < bg_job_limits.max_compactions &&
 	       unscheduled_compactions_ > 0) {
 		CompactionArg *ca = new CompactionArg;
 		ca->db = this;
 		ca->m = nullptr;
+		ca->job_pri = queue_pos < compaction_queue_.size() ?
+				      CompactionJobPriority(
+					      compaction_queue_[queue_pos]) :
+				      Env::JOB_COMPACTION;
+		queue_pos++;
 		bg_compaction_scheduled_++;
 		unscheduled_compactions_--;
-		env_->Schedule(&DBImpl::BGWorkCompaction, ca,
-			       Env::Priority::LOW, this,
-			       &DBImpl::UnscheduleCallback);
+		env_->ScheduleJob(&DBImpl::BGWorkCompaction, ca,
+				  Env::Priority::LOW, ca->job_pri, this,
+				  &DBImpl::UnscheduleCallback);
+	}
+}
+
+Env::JobPriority DBImpl::CompactionJobPriority(const Compaction &c)
+{
+	return c.start_level() == 0 ? Env::JOB_L0_COMPACTION :
+				      Env::JOB_COMPACTION;
+}
+
+Env::JobPriority DBImpl::CompactionJobPriority(ColumnFamilyData *cfd) const
+{
+	mutex_.AssertHeld();
+	// The picker starts from the level of the highest score
+	auto *vstorage = cfd->current()->storage_info();
+	return vstorage->CompactionScoreLevel(0) == 0 ?
+		       Env::JOB_L0_COMPACTION :
+		       Env::JOB_COMPACTION;
+}
+
+void DBImpl::MoveToFrontOfCompactionQueue(Env::JobPriority job_pri)
+{
+	mutex_.AssertHeld();
+	for (auto it = compaction_queue_.begin();
+	     it != compaction_queue_.end(); ++it) {
+		if (CompactionJobPriority(*it) == job_pri) {
+			if (it != compaction_queue_.begin()) {
+				ColumnFamilyData *cfd = *it;
+				compaction_queue_.erase(it);
+				compaction_queue_.push_front(cfd);
+			}
+			return;
+		}
 	}
 }
 
@@ -1213,7 +1286,8 @@ void DBImpl::BGWorkCompaction(void *arg)
 	delete reinterpret_cast<CompactionArg *>(arg);
 	IOSTATS_SET_THREAD_POOL_ID(Env::Priority::LOW);
 	TEST_SYNC_POINT("DBImpl::BGWorkCompaction");
-	reinterpret_cast<DBImpl *>(ca.db)->BackgroundCallCompaction(ca.m);
+	reinterpret_cast<DBImpl *>(ca.db)->BackgroundCallCompaction(ca.m,
+								    ca.job_pri);
 }
 
 void DBImpl::BGWorkPurge(void *db)
@@ -1224,6 +1298,14 @@ void DBImpl::BGWorkPurge(void *db)
 	TEST_SYNC_POINT("DBImpl::BGWorkPurge:end");
 }
 
+void DBImpl::BGWorkWalPool(void *db)
+{
+	IOSTATS_SET_THREAD_POOL_ID(Env::Priority::HIGH);
+	TEST_SYNC_POINT("DBImpl::BGWorkWalPool:start");
+	reinterpret_cast<DBImpl *>(db)->BackgroundCallWalPool();
+	TEST_SYNC_POINT("DBImpl::BGWorkWalPool:end");
+}
+
 void DBImpl::UnscheduleCallback(void *arg)
 {
 	CompactionArg ca = *(reinterpret_cast<CompactionArg *>(arg));
@@ -1331,6 +1413,7 @@ void DBImpl::BackgroundCallFlush()
 
 		ReleaseFileNumberFromPendingOutputs(
 			pending_outputs_inserted_elem);
+		NotifyOnStallConditionsChanged();
 
 		// If flush failed, we want to delete all temporary files that we might have
 		// created. Thus, we force full scan in FindObsoleteFiles()
@@ -1353,6 +1436,8 @@ void DBImpl::BackgroundCallFlush()
 			mutex_.Lock();
 		}
 
+		MaybeWriteTableMetaSnapshot();
+
 		assert(num_running_flushes_ > 0);
 		num_running_flushes_--;
 		bg_flush_scheduled_--;
@@ -1366,7 +1451,7 @@ void DBImpl::BackgroundCallFlush()
 	}
 }
 
-void DBImpl::BackgroundCallCompaction(void *arg)
+void DBImpl::BackgroundCallCompaction(void *arg, Env::JobPriority job_pri)
 {
 	bool made_progress = false;
 	ManualCompaction *m = reinterpret_cast<ManualCompaction *>(arg);
@@ -1389,7 +1474,7 @@ void DBImpl::BackgroundCallCompaction(void *arg)
 
 		assert(bg_compaction_scheduled_);
 		Status s = BackgroundCompaction(&made_progress, &job_context,
-						&log_buffer, m);
+						&log_buffer, m, job_pri);
 		TEST_SYNC_POINT("BackgroundCallCompaction:1");
 		if (!s.ok() && !s.IsShutdownInProgress()) {
 			// Wait a little bit before retrying background compaction in
@@ -1414,6 +1499,7 @@ void DBImpl::BackgroundCallCompaction(void *arg)
 
 		ReleaseFileNumberFromPendingOutputs(
 			pending_outputs_inserted_elem);
+		NotifyOnStallConditionsChanged();
 
 		// If compaction failed, we want to delete all temporary files that we might
 		// have created (they might not be all recorded in job_context in case of a
@@ -1438,6 +1524,8 @@ void DBImpl::BackgroundCallCompaction(void *arg)
 			mutex_.Lock();
 		}
 
+		MaybeWriteTableMetaSnapshot();
+
 		assert(num_running_compactions_ > 0);
 		num_running_compactions_--;
 		bg_compaction_scheduled_--;
@@ -1465,7 +1553,8 @@ void DBImpl::BackgroundCallCompaction(void *arg)
 
 Status DBImpl::BackgroundCompaction(bool *made_progress,
 				    JobContext *job_context,
-				    LogBuffer *log_buffer, void *arg)
+				    LogBuffer *log_buffer, void *arg,
+				    Env::JobPriority job_pri)
 {
 	ManualCompaction *manual_compaction =
 		reinterpret_cast<ManualCompaction *>(arg);
@@ -1536,6 +1625,7 @@ Status DBImpl::BackgroundCompaction(bool *made_progress,
 					       m->manual_end->DebugString().c_str()));
 		}
 	} else if (!compaction_queue_.empty()) {
+		MoveToFrontOfCompactionQueue(job_pri);
 		if (HaveManualCompaction(compaction_queue_.front())) {
 			// Can't compact right now, but try again later
 			TEST_SYNC_POINT(
@@ -1953,9 +2043,25 @@ SuperVersion *DBImpl::InstallSuperVersionAndScheduleWork(
 			old_sv->mutable_cf_options.max_write_buffer_number;
 	}
 
+	WriteStallCondition old_condition = cfd->write_stall_condition();
+	WriteStallCause old_cause = cfd->write_stall_cause();
 	auto *old =
 		cfd->InstallSuperVersion(new_sv ? new_sv : new SuperVersion(),
 					 &mutex_, mutable_cf_options);
+	ReportCompactionPressure();
+#ifndef ROCKSDB_LITE
+	if (!immutable_db_options_.listeners.empty() &&
+	    (cfd->write_stall_condition() != old_condition ||
+	     cfd->write_stall_cause() != old_cause)) {
+		WriteStallInfo info;
+		info.cf_name = cfd->GetName();
+		info.condition.cur = cfd->write_stall_condition();
+		info.condition.prev = old_condition;
+		info.cause.cur = cfd->write_stall_cause();
+		info.cause.prev = old_cause;
+		write_stall_notifications_.push_back(std::move(info));
+	}
+#endif // ROCKSDB_LITE
 
 	// Whenever we install new SuperVersion, we might need to issue new flushes or
 	// compactions.
@@ -1970,4 +2076,39 @@ SuperVersion *DBImpl::InstallSuperVersionAndScheduleWork(
 			mutable_cf_options.max_write_buffer_number;
 	return old;
 }
+
+void DBImpl::ReportCompactionPressure()
+{
+	mutex_.AssertHeld();
+	RateLimiter *limiter = immutable_db_options_.rate_limiter.get();
+	if (limiter == nullptr) {
+		return;
+	}
+	// 1.0 means some column family has reached a slowdown trigger
+	bool delayed =
+		write_controller_.IsStopped() || write_controller_.NeedsDelay();
+	double pressure = delayed ? 1.0 : 0.0;
+	for (auto cfd : *versions_->GetColumnFamilySet()) {
+		if (cfd->IsDropped() || cfd->current() == nullptr) {
+			continue;
+		}
+		const auto *vstorage = cfd->current()->storage_info();
+		const auto *mopts = cfd->GetLatestMutableCFOptions();
+		if (mopts->disable_auto_compactions) {
+			continue;
+		}
+		double l0_files = vstorage->l0_delay_trigger_count();
+		double l0_limit = mopts->level0_slowdown_writes_trigger;
+		double pending = vstorage->estimated_compaction_needed_bytes();
+		double pending_limit =
+			mopts->soft_pending_compaction_bytes_limit;
+		if (l0_limit > 0) {
+			pressure = std::max(pressure, l0_files / l0_limit);
+		}
+		if (pending_limit > 0) {
+			pressure = std::max(pressure, pending / pending_limit);
+		}
+	}
+	limiter->SetCompactionPressure(pressure);
+}
 } // namespace rocksdb
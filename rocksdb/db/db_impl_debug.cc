@@ -30,6 +30,13 @@ void DBImpl::TEST_HandleWALFull()
 	HandleWALFull(&write_context);
 }
 
+void DBImpl::TEST_TakeStatsSnapshot()
+{
+	if (stats_history_) {
+		stats_history_->TakeSnapshot();
+	}
+}
+
 int64_t
 DBImpl::TEST_MaxNextLevelOverlappingBytes(ColumnFamilyHandle *column_family)
 {
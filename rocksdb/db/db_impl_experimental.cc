@@ -59,6 +59,34 @@ Status DBImpl::SuggestCompactRange(ColumnFamilyHandle *column_family,
 	return Status::OK();
 }
 
+Status
+DBImpl::MarkTableFilesForCompaction(ColumnFamilyHandle *column_family,
+				    const std::set<uint64_t> &file_numbers)
+{
+	auto cfh = reinterpret_cast<ColumnFamilyHandleImpl *>(column_family);
+	auto cfd = cfh->cfd();
+	InstrumentedMutexLock l(&mutex_);
+	auto vstorage = cfd->current()->storage_info();
+	bool marked = false;
+	for (int level = 0; level < vstorage->num_levels(); ++level) {
+		for (auto f : vstorage->LevelFiles(level)) {
+			if (!f->compact_in_last_level &&
+			    file_numbers.count(f->fd.GetNumber()) > 0) {
+				f->marked_for_compaction = true;
+				f->compact_in_last_level = true;
+				marked = true;
+			}
+		}
+	}
+	if (marked) {
+		vstorage->ComputeCompactionScore(
+			*cfd->ioptions(), *cfd->GetLatestMutableCFOptions());
+		SchedulePendingCompaction(cfd);
+		MaybeScheduleFlushOrCompaction();
+	}
+	return Status::OK();
+}
+
 Status DBImpl::PromoteL0(ColumnFamilyHandle *column_family, int target_level)
 {
 	assert(column_family);
@@ -13,6 +13,8 @@
 #endif
 #include <inttypes.h>
 #include "db/event_helpers.h"
+#include "db/table_meta_snapshot.h"
+#include "options/options_helper.h"
 #include "util/file_util.h"
 #include "util/sst_file_manager_impl.h"
 
@@ -323,6 +325,15 @@ void DBImpl::DeleteObsoleteFileImpl(Status file_deletion_status, int job_id,
 	if (type == kTableFile) {
 		file_deletion_status =
 			DeleteSSTFile(&immutable_db_options_, fname, path_id);
+	} else if (type == kLogFile || type == kOptionsFile) {
+		// Let the SstFileManager throttle WAL and options files too, as
+		// long as they live in the DB path next to its trash
+		bool in_db_path = IsFirstDBPath(
+			&immutable_db_options_,
+			type == kOptionsFile ? dbname_ :
+					       immutable_db_options_.wal_dir);
+		file_deletion_status = DeleteDBFile(&immutable_db_options_,
+						    fname, in_db_path);
 	} else {
 		file_deletion_status = env_->DeleteFile(fname);
 	}
@@ -483,6 +494,9 @@ void DBImpl::PurgeObsoleteFiles(const JobContext &state, bool schedule_only)
 		case kMetaDatabase:
 		case kOptionsFile:
 		case kBlobFile:
+		case kTableMetaFile:
+		// The WAL pool keeps track of its own files
+		case kWalPoolFile:
 			keep = true;
 			break;
 		}
@@ -583,4 +597,143 @@ void DBImpl::DeleteObsoleteFiles()
 	job_context.Clean();
 	mutex_.Lock();
 }
+
+void DBImpl::WriteTableMetaSnapshot()
+{
+	mutex_.AssertHeld();
+	TableMetaSnapshot table_meta;
+	for (auto cfd : *versions_->GetColumnFamilySet()) {
+		if (cfd->IsDropped()) {
+			continue;
+		}
+		auto *vstorage = cfd->current()->storage_info();
+		for (int level = 0; level < vstorage->num_levels(); level++) {
+			for (auto *f : vstorage->LevelFiles(level)) {
+				table_meta.Add(cfd->GetID(), *f);
+			}
+		}
+	}
+	uint64_t tmp_number = versions_->NewFileNumber();
+
+	mutex_.Unlock();
+	Status s = table_meta.Write(env_, dbname_, tmp_number);
+	if (!s.ok()) {
+		ROCKS_LOG_WARN(immutable_db_options_.info_log,
+			       "Failed to write table meta snapshot: %s",
+			       s.ToString().c_str());
+	}
+	mutex_.Lock();
+}
+
+void DBImpl::MaybeWriteTableMetaSnapshot()
+{
+	mutex_.AssertHeld();
+	if (!immutable_db_options_.persist_table_meta_snapshot ||
+	    shutting_down_.load(std::memory_order_acquire) ||
+	    table_meta_manifest_number_ == versions_->manifest_file_number()) {
+		return;
+	}
+	table_meta_manifest_number_ = versions_->manifest_file_number();
+	WriteTableMetaSnapshot();
+}
+
+void DBImpl::InitWalPool()
+{
+	mutex_.AssertHeld();
+	const std::string &wal_dir = immutable_db_options_.wal_dir;
+	std::vector<std::string> filenames;
+	env_->GetChildren(wal_dir, &filenames);
+	for (const auto &fname : filenames) {
+		uint64_t number;
+		FileType type;
+		if (!ParseFileName(fname, &number, &type) ||
+		    type != kWalPoolFile) {
+			continue;
+		}
+		std::string path = WalPoolFileName(wal_dir, number);
+		if (wal_pool_.size() < immutable_db_options_.wal_pool_size) {
+			// Pool file numbers are not recorded in the MANIFEST;
+			// keep the refill from handing out the same name.
+			versions_->MarkFileNumberUsedDuringRecovery(number);
+			wal_pool_.push_back(path);
+		} else {
+			// The pool was shrunk or disabled since the last run
+			env_->DeleteFile(path);
+		}
+	}
+	MaybeScheduleWalPoolRefill();
+}
+
+void DBImpl::MaybeScheduleWalPoolRefill()
+{
+	mutex_.AssertHeld();
+	if (bg_wal_pool_scheduled_ > 0 ||
+	    wal_pool_.size() >= immutable_db_options_.wal_pool_size ||
+	    shutting_down_.load(std::memory_order_acquire)) {
+		return;
+	}
+	// A new WAL is waited for by the writers, so the refill runs with
+	// the flushes rather than behind the compactions.
+	bg_wal_pool_scheduled_++;
+	env_->ScheduleJob(&DBImpl::BGWorkWalPool, this, Env::Priority::HIGH,
+			  Env::JOB_FLUSH, nullptr);
+}
+
+void DBImpl::BackgroundCallWalPool()
+{
+	mutex_.Lock();
+	while (wal_pool_.size() < immutable_db_options_.wal_pool_size &&
+	       !shutting_down_.load(std::memory_order_acquire)) {
+		uint64_t number = versions_->NewFileNumber();
+		auto *cfd = versions_->GetColumnFamilySet()->GetDefault();
+		const uint64_t size = GetWalPreallocateBlockSize(
+			cfd->GetLatestMutableCFOptions()->write_buffer_size);
+		EnvOptions opt_env_opt = env_->OptimizeForLogWrite(
+			env_options_, BuildDBOptions(immutable_db_options_,
+						     mutable_db_options_));
+		std::string fname = WalPoolFileName(
+			immutable_db_options_.wal_dir, number);
+		mutex_.Unlock();
+
+		// Reserve the blocks and set the final size up front, so
+		// appending to the file later neither allocates nor changes
+		// the size recorded in the inode. No data is written: the
+		// blocks read back as zeros, which the log reader skips.
+		unique_ptr<WritableFile> file;
+		Status s = NewWritableFile(env_, fname, &file, opt_env_opt);
+		if (s.ok()) {
+			// Not every file system supports fallocate(); the
+			// file is still usable, only sparse.
+			file->Allocate(0, size);
+			s = file->Truncate(size);
+			if (s.ok()) {
+				s = file->Fsync();
+			}
+			Status close_s = file->Close();
+			if (s.ok()) {
+				s = close_s;
+			}
+			file.reset();
+			if (!s.ok()) {
+				env_->DeleteFile(fname);
+			}
+		}
+
+		mutex_.Lock();
+		if (!s.ok()) {
+			ROCKS_LOG_WARN(immutable_db_options_.info_log,
+				       "Failed to create WAL pool file %s: %s",
+				       fname.c_str(), s.ToString().c_str());
+			break;
+		}
+		wal_pool_.push_back(fname);
+	}
+	bg_wal_pool_scheduled_--;
+
+	bg_cv_.SignalAll();
+	// IMPORTANT: there should be no code after calling SignalAll. This
+	// call may signal the DB destructor that it's OK to proceed with
+	// destruction.
+	mutex_.Unlock();
+}
 } // namespace rocksdb
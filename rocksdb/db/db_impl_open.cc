@@ -1183,6 +1183,7 @@ Status DB::Open(const DBOptions &db_options, const std::string &dbname,
 		*dbptr = impl;
 		impl->opened_successfully_ = true;
 		impl->MaybeScheduleFlushOrCompaction();
+		impl->InitWalPool();
 	}
 	impl->mutex_.Unlock();
 
@@ -1219,6 +1220,9 @@ Status DB::Open(const DBOptions &db_options, const std::string &dbname,
 				persist_options_status.ToString());
 		}
 	}
+	if (s.ok()) {
+		s = impl->StartStatsHistory();
+	}
 	if (!s.ok()) {
 		for (auto *h : *handles) {
 			delete h;
@@ -13,6 +13,7 @@
 #endif
 #include <inttypes.h>
 #include "monitoring/perf_context_imp.h"
+#include "monitoring/thread_status_util.h"
 #include "options/options_helper.h"
 #include "util/sync_point.h"
 
@@ -52,6 +53,12 @@ Status DBImpl::SingleDelete(const WriteOptions &write_options,
 
 Status DBImpl::Write(const WriteOptions &write_options, WriteBatch *my_batch)
 {
+	if (tracing_.load(std::memory_order_relaxed) && my_batch != nullptr) {
+		std::shared_ptr<Tracer> tracer = std::atomic_load(&tracer_);
+		if (tracer) {
+			tracer->Write(my_batch);
+		}
+	}
 	return WriteImpl(write_options, my_batch, nullptr, nullptr);
 }
 
@@ -59,6 +66,12 @@ Status DBImpl::Write(const WriteOptions &write_options, WriteBatch *my_batch)
 Status DBImpl::WriteWithCallback(const WriteOptions &write_options,
 				 WriteBatch *my_batch, WriteCallback *callback)
 {
+	if (tracing_.load(std::memory_order_relaxed) && my_batch != nullptr) {
+		std::shared_ptr<Tracer> tracer = std::atomic_load(&tracer_);
+		if (tracer) {
+			tracer->Write(my_batch);
+		}
+	}
 	return WriteImpl(write_options, my_batch, callback, nullptr);
 }
 #endif // ROCKSDB_LITE
@@ -71,6 +84,11 @@ Status DBImpl::WriteImpl(const WriteOptions &write_options,
 	if (my_batch == nullptr) {
 		return Status::Corruption("Batch is nullptr!");
 	}
+	// A batch may span column families; report the default one
+	AutoThreadOperationUpdater op_updater(
+		env_, default_cf_handle_->cfd(),
+		immutable_db_options_.enable_thread_tracking,
+		ThreadStatus::OP_WRITE);
 
 	Status status;
 	if (write_options.low_pri) {
@@ -533,6 +551,10 @@ Status DBImpl::PreprocessWrite(const WriteOptions &write_options,
 		status = ScheduleFlushes(write_context);
 	}
 
+	if (UNLIKELY(!write_stall_notifications_.empty())) {
+		NotifyOnStallConditionsChanged();
+	}
+
 	if (UNLIKELY(status.ok() && (write_controller_.IsStopped() ||
 				     write_controller_.NeedsDelay()))) {
 		PERF_TIMER_GUARD(write_delay_time);
@@ -614,6 +636,8 @@ Status DBImpl::WriteToWAL(const WriteThread::WriteGroup &write_group,
 
 	if (status.ok() && need_log_sync) {
 		StopWatch sw(env_, stats_, WAL_FILE_SYNC_MICROS);
+		AutoThreadStateUpdater state_updater(
+			ThreadStatus::STATE_WAL_SYNC, env_);
 		// It's safe to access logs_ with unlocked mutex_ here because:
 		//  - we've set getting_synced=true for all logs,
 		//    so other threads won't pop from logs_ while we're here,
@@ -779,6 +803,8 @@ Status DBImpl::DelayWrite(uint64_t num_bytes, const WriteOptions &write_options)
 	bool delayed = false;
 	{
 		StopWatch sw(env_, stats_, WRITE_STALL, &time_delayed);
+		AutoThreadStateUpdater state_updater(
+			ThreadStatus::STATE_WRITE_STALL, env_);
 		uint64_t delay = write_controller_.GetDelay(env_, num_bytes);
 		if (delay > 0) {
 			if (write_options.no_slowdown) {
@@ -786,6 +812,8 @@ Status DBImpl::DelayWrite(uint64_t num_bytes, const WriteOptions &write_options)
 			}
 			TEST_SYNC_POINT("DBImpl::DelayWrite:Sleep");
 
+			// Waits are charged to the cause at their start
+			WriteStallCause cause = write_controller_.StallCause();
 			mutex_.Unlock();
 			// We will delay the write until we have slept for delay ms or
 			// we don't need a delay anymore
@@ -801,6 +829,11 @@ Status DBImpl::DelayWrite(uint64_t num_bytes, const WriteOptions &write_options)
 				// Sleep for 0.001 seconds
 				env_->SleepForMicroseconds(kDelayInterval);
 			}
+			if (delayed) {
+				write_controller_.AddStallMicros(
+					WriteStallCondition::kDelayed, cause,
+					env_->NowMicros() - sw.start_time());
+			}
 			mutex_.Lock();
 		}
 
@@ -809,8 +842,13 @@ Status DBImpl::DelayWrite(uint64_t num_bytes, const WriteOptions &write_options)
 				return Status::Incomplete();
 			}
 			delayed = true;
+			WriteStallCause cause = write_controller_.StallCause();
+			uint64_t wait_start = env_->NowMicros();
 			TEST_SYNC_POINT("DBImpl::DelayWrite:Wait");
 			bg_cv_.Wait();
+			write_controller_.AddStallMicros(
+				WriteStallCondition::kStopped, cause,
+				env_->NowMicros() - wait_start);
 		}
 	}
 	assert(!delayed || !write_options.no_slowdown);
@@ -910,6 +948,11 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData *cfd, WriteContext *context)
 		recycle_log_number = log_recycle_files.front();
 		log_recycle_files.pop_front();
 	}
+	std::string wal_pool_fname;
+	if (creating_new_log && recycle_log_number == 0 && !wal_pool_.empty()) {
+		wal_pool_fname = wal_pool_.front();
+		wal_pool_.pop_front();
+	}
 	uint64_t new_log_number =
 		creating_new_log ? versions_->NewFileNumber() : logfile_number_;
 	SuperVersion *new_superversion = nullptr;
@@ -951,6 +994,34 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData *cfd, WriteContext *context)
 						immutable_db_options_.wal_dir,
 						recycle_log_number),
 					&lfile, opt_env_opt);
+			} else if (!wal_pool_fname.empty()) {
+				ROCKS_LOG_INFO(immutable_db_options_.info_log,
+					       "taking log %" PRIu64
+					       " from WAL pool file %s\n",
+					       new_log_number,
+					       wal_pool_fname.c_str());
+				s = env_->ReuseWritableFile(
+					LogFileName(
+						immutable_db_options_.wal_dir,
+						new_log_number),
+					wal_pool_fname, &lfile, opt_env_opt);
+				if (!s.ok()) {
+					// Nothing depends on the pool file;
+					// fall back to a fresh log.
+					ROCKS_LOG_WARN(
+						immutable_db_options_.info_log,
+						"WAL pool file %s unusable: %s",
+						wal_pool_fname.c_str(),
+						s.ToString().c_str());
+					env_->DeleteFile(wal_pool_fname);
+					s = NewWritableFile(
+						env_,
+						LogFileName(
+							immutable_db_options_
+								.wal_dir,
+							new_log_number),
+						&lfile, opt_env_opt);
+				}
 			} else {
 				s = NewWritableFile(
 					env_,
@@ -998,6 +1069,9 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData *cfd, WriteContext *context)
 		       cfd->GetName().c_str(), new_log_number,
 		       num_imm_unflushed);
 	mutex_.Lock();
+	if (!wal_pool_fname.empty()) {
+		MaybeScheduleWalPoolRefill();
+	}
 	if (!s.ok()) {
 		// how do we fail if we're not creating new log?
 		assert(creating_new_log);
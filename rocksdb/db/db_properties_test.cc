@@ -19,6 +19,7 @@
 #include "rocksdb/perf_level.h"
 #include "rocksdb/table.h"
 #include "util/random.h"
+#include "util/rate_limiter.h"
 #include "util/string_util.h"
 
 namespace rocksdb
@@ -1059,6 +1060,62 @@ TEST_F(DBPropertiesTest, EstimatePendingCompBytes)
 	ASSERT_EQ(int_num, 0U);
 }
 
+TEST_F(DBPropertiesTest, RateLimiterBytesPerSec)
+{
+	// Remembers the latest compaction pressure reported by the DB
+	class PressureRecordingRateLimiter : public GenericRateLimiter {
+	    public:
+		PressureRecordingRateLimiter()
+			: GenericRateLimiter(1 << 20, 100 * 1000, 10),
+			  pressure(-1)
+		{
+		}
+		void SetCompactionPressure(double p) override
+		{
+			pressure = p;
+		}
+		std::atomic<double> pressure;
+	};
+
+	Options options = CurrentOptions();
+	Reopen(options);
+	uint64_t int_num;
+	ASSERT_TRUE(dbfull()->GetIntProperty(
+		"rocksdb.rate-limiter-bytes-per-sec", &int_num));
+	ASSERT_EQ(0U, int_num);
+
+	env_->SetBackgroundThreads(1, Env::LOW);
+	test::SleepingBackgroundTask sleeping_task_low;
+	env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask,
+		       &sleeping_task_low, Env::Priority::LOW);
+
+	auto *limiter = new PressureRecordingRateLimiter();
+	options.rate_limiter.reset(limiter);
+	options.level0_file_num_compaction_trigger = 2;
+	options.level0_slowdown_writes_trigger = 4;
+	options.level0_stop_writes_trigger = 8;
+	Reopen(options);
+	ASSERT_TRUE(dbfull()->GetIntProperty(
+		"rocksdb.rate-limiter-bytes-per-sec", &int_num));
+	ASSERT_EQ(1U << 20, int_num);
+
+	// Pressure follows the L0 file count while compactions are blocked
+	for (int i = 0; i < 4; i++) {
+		ASSERT_OK(Put("k" + ToString(i), "v"));
+		ASSERT_OK(Flush());
+		ASSERT_DOUBLE_EQ((i + 1) / 4.0, limiter->pressure.load());
+	}
+
+	sleeping_task_low.WakeUp();
+	sleeping_task_low.WaitUntilDone();
+	dbfull()->TEST_WaitForCompact();
+	// Compactions stop below the L0 compaction trigger
+	ASSERT_LT(NumTableFilesAtLevel(0),
+		  options.level0_file_num_compaction_trigger);
+	ASSERT_DOUBLE_EQ(NumTableFilesAtLevel(0) / 4.0,
+			 limiter->pressure.load());
+}
+
 TEST_F(DBPropertiesTest, EstimateCompressionRatio)
 {
 	if (!Snappy_Supported()) {
@@ -1478,6 +1535,147 @@ TEST_F(DBPropertiesTest, EstimateNumKeysUnderflow)
 	ASSERT_EQ(0, num_keys);
 }
 
+TEST_F(DBPropertiesTest, SstReadStats)
+{
+	Options options = CurrentOptions();
+	BlockBasedTableOptions table_options;
+	// Every lookup reads the file
+	table_options.no_block_cache = true;
+	options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+	Reopen(options);
+	ASSERT_OK(Put("a", "value"));
+	ASSERT_OK(Flush());
+
+	// One in 1024 reads is sampled, so expect about 20 samples
+	const int kReads = 20 * 1024;
+	for (int i = 0; i < kReads; i++) {
+		ASSERT_EQ("value", Get("a"));
+		std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+	}
+	std::vector<LiveFileMetaData> metadata;
+	db_->GetLiveFilesMetaData(&metadata);
+	ASSERT_EQ(1, metadata.size());
+	ASSERT_GE(metadata[0].num_reads_sampled, kReads / 4);
+	ASSERT_LE(metadata[0].num_reads_sampled, kReads * 3);
+	ASSERT_GE(metadata[0].num_seeks_sampled, kReads / 4);
+	ASSERT_LE(metadata[0].num_seeks_sampled, kReads * 3);
+	ASSERT_GT(metadata[0].bytes_read_sampled, 0);
+
+	std::string stats;
+	ASSERT_TRUE(db_->GetProperty(DB::Properties::kSstReadStats, &stats));
+	ASSERT_NE(std::string::npos,
+		  stats.find(ToString(metadata[0].num_reads_sampled)));
+
+	// Compaction reads are not counted, and a rewritten file starts over
+	ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+	metadata.clear();
+	db_->GetLiveFilesMetaData(&metadata);
+	ASSERT_EQ(1, metadata.size());
+	ASSERT_EQ(0, metadata[0].num_reads_sampled);
+	ASSERT_EQ(0, metadata[0].num_seeks_sampled);
+}
+
+TEST_F(DBPropertiesTest, CompactionKeyRangeStats)
+{
+	Options options = CurrentOptions();
+	options.disable_auto_compactions = true;
+	options.compaction_stats_key_prefix_length = 1;
+	Reopen(options);
+	std::map<std::string, double> key_ranges;
+	ASSERT_TRUE(db_->GetMapProperty(
+		DB::Properties::kCompactionKeyRangeStats, &key_ranges));
+	ASSERT_TRUE(key_ranges.empty());
+
+	// Two overlapping files, so that the compaction rewrites them
+	for (int i = 0; i < 2; i++) {
+		const std::string value(100, 'v');
+		for (int k = 0; k < 100; k++) {
+			ASSERT_OK(Put("a" + ToString(k), value));
+		}
+		for (int k = 0; k < 10; k++) {
+			ASSERT_OK(Put("b" + ToString(k), value));
+		}
+		ASSERT_OK(Flush());
+	}
+	ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+	ASSERT_TRUE(db_->GetMapProperty(
+		DB::Properties::kCompactionKeyRangeStats, &key_ranges));
+	ASSERT_EQ(2, key_ranges.size());
+	// Keys of 2 to 3 bytes plus 8 bytes of internal key footer
+	ASSERT_GE(key_ranges["a"], 100 * 110);
+	ASSERT_LE(key_ranges["a"], 100 * 111);
+	ASSERT_GE(key_ranges["b"], 10 * 110);
+	ASSERT_LE(key_ranges["b"], 10 * 111);
+
+	std::string stats;
+	ASSERT_TRUE(db_->GetProperty(DB::Properties::kCompactionKeyRangeStats,
+				     &stats));
+	// "a" was rewritten the most, so it comes first
+	ASSERT_LT(stats.find("\na "), stats.find("\nb "));
+}
+
+TEST_F(DBPropertiesTest, WriteStallStats)
+{
+	Options options = CurrentOptions();
+	// Writes are delayed with 3 memtables waiting for flush
+	options.max_write_buffer_number = 4;
+	options.max_background_flushes = 1;
+	Reopen(options);
+
+	std::map<std::string, double> stats;
+	ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kWriteStallStats,
+					&stats));
+	ASSERT_EQ(0, stats["cf.condition"]);
+	ASSERT_EQ(0, stats["db.memtable-limit.delayed-micros"]);
+
+	env_->SetBackgroundThreads(1, Env::HIGH);
+	test::SleepingBackgroundTask sleeping_task_high;
+	env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask,
+		       &sleeping_task_high, Env::Priority::HIGH);
+	for (int i = 0; i < 3; i++) {
+		ASSERT_OK(Put(Key(i), "value"));
+		ASSERT_OK(dbfull()->TEST_FlushMemTable(false));
+	}
+	// Waits for the delay
+	ASSERT_OK(Put(Key(3), "value"));
+	stats.clear();
+	ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kWriteStallStats,
+					&stats));
+	ASSERT_EQ(static_cast<double>(WriteStallCondition::kDelayed),
+		  stats["cf.condition"]);
+	ASSERT_EQ(static_cast<double>(WriteStallCause::kMemtableLimit),
+		  stats["cf.cause"]);
+	ASSERT_EQ(1, stats["db.memtable-limit.delay-tokens"]);
+	ASSERT_EQ(0, stats["db.l0-file-count-limit.delay-tokens"]);
+	ASSERT_GT(stats["db.memtable-limit.delayed-micros"], 0);
+	ASSERT_EQ(0, stats["db.memtable-limit.stopped-micros"]);
+	ASSERT_GT(stats["db.delayed-write-rate"], 0);
+	std::string str;
+	ASSERT_TRUE(db_->GetProperty(DB::Properties::kWriteStallStats, &str));
+	ASSERT_NE(std::string::npos,
+		  str.find("Condition: delayed, cause: memtable-limit"));
+
+	sleeping_task_high.WakeUp();
+	sleeping_task_high.WaitUntilDone();
+	dbfull()->TEST_WaitForCompact();
+	stats.clear();
+	ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kWriteStallStats,
+					&stats));
+	ASSERT_EQ(0, stats["cf.condition"]);
+	ASSERT_EQ(0, stats["db.memtable-limit.delay-tokens"]);
+	ASSERT_GT(stats["cf.memtable-limit.delayed-micros"], 0);
+	double delayed_micros = stats["cf.memtable-limit.delayed-micros"];
+	stats.clear();
+	ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kWriteStallStats,
+					&stats));
+	// Not counting up anymore
+	ASSERT_EQ(delayed_micros, stats["cf.memtable-limit.delayed-micros"]);
+	ASSERT_TRUE(db_->GetProperty(DB::Properties::kDBStats, &str));
+	ASSERT_NE(std::string::npos,
+		  str.find("Cumulative stall by cause: memtable-limit"));
+}
+
 #endif // ROCKSDB_LITE
 } // namespace rocksdb
 
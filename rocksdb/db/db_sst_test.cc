@@ -11,7 +11,9 @@
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/sst_file_manager.h"
+#include "util/filename.h"
 #include "util/sst_file_manager_impl.h"
+#include "utilities/blob_db/blob_db_impl.h"
 
 namespace rocksdb
 {
@@ -343,6 +345,9 @@ TEST_F(DBSSTTest, RateLimitedDelete)
 	Options options = CurrentOptions();
 	options.disable_auto_compactions = true;
 	options.env = env_;
+	// WAL files are throttled by the SstFileManager too when they live in
+	// the DB directory, keep them out of the way of the table file counts
+	options.wal_dir = alternative_wal_dir_;
 
 	std::string trash_dir = test::TmpDir(env_) + "/trash";
 	int64_t rate_bytes_per_sec = 1024 * 10; // 10 Kbs / Sec
@@ -413,6 +418,8 @@ TEST_F(DBSSTTest, DeleteSchedulerMultipleDBPaths)
 	options.db_paths.emplace_back(dbname_, 1024 * 100);
 	options.db_paths.emplace_back(dbname_ + "_2", 1024 * 100);
 	options.env = env_;
+	// Only count table files, see RateLimitedDelete
+	options.wal_dir = alternative_wal_dir_;
 
 	std::string trash_dir = test::TmpDir(env_) + "/trash";
 	int64_t rate_bytes_per_sec = 1024 * 1024; // 1 Mb / Sec
@@ -507,6 +514,105 @@ TEST_F(DBSSTTest, DestroyDBWithRateLimitedDelete)
 	ASSERT_EQ(bg_delete_file, 4);
 }
 
+// Obsolete WAL files in the DB directory and obsolete blob files go through
+// the trash of the SstFileManager, and count in its delete backlog until the
+// trash is emptied.
+TEST_F(DBSSTTest, DeleteWALAndBlobFilesThroughTrash)
+{
+	Destroy(last_options_);
+	rocksdb::SyncPoint::GetInstance()->LoadDependency({
+		{ "DBSSTTest::DeleteWALAndBlobFilesThroughTrash:1",
+		  "DeleteScheduler::BackgroundEmptyTrash" },
+	});
+	rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+	std::string trash_dir = test::TmpDir(env_) + "/trash";
+	std::vector<std::string> files;
+	env_->GetChildren(trash_dir, &files);
+	for (auto &f : files) {
+		env_->DeleteFile(trash_dir + "/" + f);
+	}
+	// Bytes of the files of type in trash
+	auto trash_bytes = [&](FileType want) {
+		std::vector<std::string> children;
+		env_->GetChildren(trash_dir, &children);
+		uint64_t bytes = 0;
+		for (auto &f : children) {
+			uint64_t number;
+			FileType type;
+			uint64_t size;
+			if (!ParseFileName(f, &number, &type) || type != want) {
+				continue;
+			}
+			if (env_->GetFileSize(trash_dir + "/" + f, &size).ok()) {
+				bytes += size;
+			}
+		}
+		return bytes;
+	};
+
+	Options options = CurrentOptions();
+	options.disable_auto_compactions = true;
+	options.env = env_;
+	options.wal_dir = dbname_;
+	int64_t rate_bytes_per_sec = 1024 * 1024; // 1 Mb / Sec
+	Status s;
+	options.sst_file_manager.reset(NewSstFileManager(
+		env_, nullptr, trash_dir, rate_bytes_per_sec, false, &s));
+	ASSERT_OK(s);
+	auto sfm = static_cast<SstFileManagerImpl *>(
+		options.sst_file_manager.get());
+	ASSERT_OK(TryReopen(options));
+
+	// The flush makes the WAL obsolete
+	ASSERT_OK(Put("Key1", DummyString(1024, 'A')));
+	ASSERT_OK(Flush());
+	ASSERT_OK(dbfull()->TEST_WaitForCompact());
+	uint64_t wal_bytes = trash_bytes(kLogFile);
+	ASSERT_GT(wal_bytes, 0U);
+	ASSERT_EQ(wal_bytes, sfm->GetDeleteBacklogBytes());
+
+	// Blob files of a blob DB sharing the SstFileManager
+	std::string blob_dbname = dbname_ + "_blob";
+	Options blob_options = options;
+	blob_options.wal_dir = "";
+	blob_options.create_if_missing = true;
+	blob_db::BlobDBOptions bdb_options;
+	blob_db::BlobDB *blob_db = nullptr;
+	ASSERT_OK(blob_db::BlobDB::Open(blob_options, bdb_options, blob_dbname,
+					&blob_db));
+	for (int i = 0; i < 10; i++) {
+		ASSERT_OK(blob_db->Put(WriteOptions(), "Key" + ToString(i),
+				       DummyString(1024, 'B')));
+	}
+	auto blob_db_impl = reinterpret_cast<blob_db::BlobDBImpl *>(blob_db);
+	auto blob_files = blob_db_impl->TEST_GetBlobFiles();
+	ASSERT_FALSE(blob_files.empty());
+	uint64_t blob_bytes = 0;
+	for (auto &bfile : blob_files) {
+		blob_db_impl->TEST_ObsoleteFile(bfile);
+		uint64_t size = 0;
+		ASSERT_OK(env_->GetFileSize(bfile->PathName(), &size));
+		blob_bytes += size;
+	}
+	blob_db_impl->TEST_DeleteObsoleteFiles();
+	ASSERT_GT(blob_bytes, 0U);
+	ASSERT_EQ(blob_bytes, trash_bytes(kBlobFile));
+	ASSERT_EQ(wal_bytes + blob_bytes, sfm->GetDeleteBacklogBytes());
+	delete blob_db;
+	ASSERT_OK(blob_db::DestroyBlobDB(blob_dbname, blob_options,
+					 bdb_options));
+
+	// Let the trash be emptied
+	TEST_SYNC_POINT("DBSSTTest::DeleteWALAndBlobFilesThroughTrash:1");
+	sfm->WaitForEmptyTrash();
+	ASSERT_EQ(0U, sfm->GetDeleteBacklogBytes());
+	ASSERT_EQ(0U, trash_bytes(kLogFile));
+	ASSERT_EQ(0U, trash_bytes(kBlobFile));
+
+	rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+}
+
 TEST_F(DBSSTTest, DBWithMaxSpaceAllowed)
 {
 	std::shared_ptr<SstFileManager> sst_file_manager(
@@ -3647,6 +3647,89 @@ TEST_F(DBTest, ThreadStatusFlush)
 	rocksdb::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(DBTest, ThreadStatusWaitEvents)
+{
+	Options options;
+	options.env = env_;
+	options.enable_thread_tracking = true;
+	options = CurrentOptions(options);
+	Reopen(options);
+
+	const uint64_t my_id = env_->GetThreadID();
+	auto find_me = [&](std::vector<ThreadStatus> *thread_list) {
+		EXPECT_OK(env_->GetThreadList(thread_list));
+		for (auto &thread : *thread_list) {
+			if (thread.thread_id == my_id) {
+				return &thread;
+			}
+		}
+		return static_cast<ThreadStatus *>(nullptr);
+	};
+
+	// A user thread shows up with its operation while in a Get()
+	int gets_seen = 0;
+	rocksdb::SyncPoint::GetInstance()->SetCallBack(
+		"DBImpl::GetImpl:1", [&](void *arg) {
+			std::vector<ThreadStatus> thread_list;
+			ThreadStatus *me = find_me(&thread_list);
+			ASSERT_TRUE(me != nullptr);
+			ASSERT_EQ(ThreadStatus::USER, me->thread_type);
+			ASSERT_EQ(ThreadStatus::OP_GET, me->operation_type);
+			ASSERT_EQ("default", me->cf_name);
+			gets_seen++;
+		});
+	rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+	ASSERT_EQ("NOT_FOUND", Get("foo"));
+	rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+	rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+	ASSERT_EQ(1, gets_seen);
+
+	std::vector<ThreadStatus> thread_list;
+	ThreadStatus *me = find_me(&thread_list);
+	ASSERT_TRUE(me != nullptr);
+	ASSERT_EQ(ThreadStatus::OP_UNKNOWN, me->operation_type);
+	const uint64_t syncs_before =
+		me->state_wait_counts[ThreadStatus::STATE_WAL_SYNC];
+	const uint64_t mutex_micros_before =
+		me->state_wait_micros[ThreadStatus::STATE_MUTEX_WAIT];
+
+	// A sync write syncs the WAL and locks the DB mutex, which another
+	// thread holds for a while. Only a lock that waits is a wait event.
+	std::atomic<bool> mutex_locked(false);
+	port::Thread mutex_holder([&]() {
+		dbfull()->TEST_LockMutex();
+		mutex_locked = true;
+		env_->SleepForMicroseconds(20000);
+		dbfull()->TEST_UnlockMutex();
+	});
+	while (!mutex_locked) {
+		env_->SleepForMicroseconds(100);
+	}
+	WriteOptions write_options;
+	write_options.sync = true;
+	ASSERT_OK(db_->Put(write_options, "foo", "v1"));
+	mutex_holder.join();
+
+	me = find_me(&thread_list);
+	ASSERT_TRUE(me != nullptr);
+	ASSERT_EQ(ThreadStatus::STATE_UNKNOWN, me->state_type);
+	ASSERT_EQ(syncs_before + 1,
+		  me->state_wait_counts[ThreadStatus::STATE_WAL_SYNC]);
+	ASSERT_GE(me->state_wait_micros[ThreadStatus::STATE_MUTEX_WAIT],
+		  mutex_micros_before + 10000);
+
+	// Not tracked when the DB does not track threads
+	options.enable_thread_tracking = false;
+	Reopen(options);
+	me = find_me(&thread_list);
+	ASSERT_TRUE(me != nullptr);
+	const uint64_t syncs =
+		me->state_wait_counts[ThreadStatus::STATE_WAL_SYNC];
+	ASSERT_OK(db_->Put(write_options, "foo", "v2"));
+	me = find_me(&thread_list);
+	ASSERT_EQ(syncs, me->state_wait_counts[ThreadStatus::STATE_WAL_SYNC]);
+}
+
 TEST_P(DBTestWithParam, ThreadStatusSingleCompaction)
 {
 	const int kTestKeySize = 16;
@@ -14,7 +14,9 @@
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/persistent_cache.h"
+#include "rocksdb/trace_reader_writer.h"
 #include "rocksdb/wal_filter.h"
+#include "util/trace_replay.h"
 
 namespace rocksdb
 {
@@ -2347,6 +2349,40 @@ TEST_F(DBTest2, DirectIO)
 	Reopen(options);
 }
 
+TEST_F(DBTest2, DirectIOForWAL)
+{
+	if (!IsDirectIOSupported()) {
+		return;
+	}
+	Options options = CurrentOptions();
+	options.use_direct_io_for_wal = true;
+	options.use_direct_io_for_flush_and_compaction = true;
+	options.writable_file_direct_io_buffers = 2;
+	options.writable_file_max_buffer_size = 64 << 10;
+	options.allow_mmap_reads = options.allow_mmap_writes = false;
+	DestroyAndReopen(options);
+
+	// Odd-sized records keep the WAL tail in the middle of a sector, and
+	// large values fill whole buffers
+	Random rnd(301);
+	std::vector<std::string> values;
+	for (int i = 0; i < 100; i++) {
+		values.push_back(RandomString(&rnd, i % 10 == 0 ? 100000 : 33));
+		ASSERT_OK(Put(Key(i), values.back()));
+	}
+	ASSERT_OK(Flush());
+	for (int i = 100; i < 150; i++) {
+		values.push_back(RandomString(&rnd, 33));
+		ASSERT_OK(Put(Key(i), values.back()));
+	}
+
+	// The last 50 keys are only in the WAL
+	Reopen(options);
+	for (int i = 0; i < 150; i++) {
+		ASSERT_EQ(values[i], Get(Key(i)));
+	}
+}
+
 TEST_F(DBTest2, MemtableOnlyIterator)
 {
 	Options options = CurrentOptions();
@@ -2463,6 +2499,251 @@ TEST_F(DBTest2, LowPriWrite)
 	Put("", "", wo);
 	ASSERT_EQ(1, rate_limit_count.load());
 }
+
+TEST_F(DBTest2, TableMetaSnapshot)
+{
+	Options options = CurrentOptions();
+	options.max_open_files = -1;
+	options.disable_auto_compactions = true;
+	options.persist_table_meta_snapshot = true;
+	options.statistics = rocksdb::CreateDBStatistics();
+	DestroyAndReopen(options);
+
+	const int kNumFiles = 3;
+	for (int i = 0; i < kNumFiles; i++) {
+		ASSERT_OK(Put(Key(i), "val"));
+		ASSERT_OK(Flush());
+	}
+	Close();
+	ASSERT_OK(env_->FileExists(dbname_ + "/TABLEMETA"));
+
+	// Every table is in the snapshot: nothing is opened on DB::Open, yet
+	// the per-file stats are known.
+	uint64_t opens = TestGetTickerCount(options, NO_FILE_OPENS);
+	Reopen(options);
+	ASSERT_EQ(opens, TestGetTickerCount(options, NO_FILE_OPENS));
+	uint64_t num_keys = 0;
+	ASSERT_TRUE(dbfull()->GetIntProperty("rocksdb.estimate-num-keys",
+					     &num_keys));
+	ASSERT_EQ(kNumFiles, num_keys);
+
+	// Tables are opened on first access instead. With L0 only, a Get
+	// tries the files newest first, so this one is found in the first.
+	ASSERT_EQ("val", Get(Key(kNumFiles - 1)));
+	ASSERT_EQ(opens + 1, TestGetTickerCount(options, NO_FILE_OPENS));
+
+	// Without the snapshot all tables are pre-loaded
+	options.persist_table_meta_snapshot = false;
+	opens = TestGetTickerCount(options, NO_FILE_OPENS);
+	Reopen(options);
+	ASSERT_EQ(opens + kNumFiles,
+		  TestGetTickerCount(options, NO_FILE_OPENS));
+}
+
+TEST_F(DBTest2, TableMetaSnapshotAfterCrash)
+{
+	Options options = CurrentOptions();
+	options.max_open_files = -1;
+	options.disable_auto_compactions = true;
+	options.persist_table_meta_snapshot = true;
+	// Roll the MANIFEST over on every flush
+	options.max_manifest_file_size = 1;
+	options.statistics = rocksdb::CreateDBStatistics();
+	DestroyAndReopen(options);
+
+	// Reopen without the snapshot written on clean shutdown, as after a
+	// crash
+	const std::string fname = dbname_ + "/TABLEMETA";
+	auto crash_and_reopen = [&]() {
+		ASSERT_OK(dbfull()->TEST_WaitForCompact());
+		std::string snapshot;
+		ASSERT_OK(ReadFileToString(env_, fname, &snapshot));
+		Close();
+		ASSERT_OK(WriteStringToFile(env_, snapshot, fname));
+		Reopen(options);
+	};
+
+	int num_files = 3;
+	for (int i = 0; i < num_files; i++) {
+		ASSERT_OK(Put(Key(i), "val"));
+		ASSERT_OK(Flush());
+	}
+	// The last roll-over saw every table
+	uint64_t opens = TestGetTickerCount(options, NO_FILE_OPENS);
+	crash_and_reopen();
+	ASSERT_EQ(opens, TestGetTickerCount(options, NO_FILE_OPENS));
+	uint64_t num_keys = 0;
+	ASSERT_TRUE(dbfull()->GetIntProperty("rocksdb.estimate-num-keys",
+					     &num_keys));
+	ASSERT_EQ(static_cast<uint64_t>(num_files), num_keys);
+
+	// Without roll-overs, only the first flush after DB::Open writes a
+	// snapshot; the tables flushed later are missing from it after a crash
+	// and all tables are pre-loaded again.
+	options.max_manifest_file_size = port::kMaxUint64;
+	Reopen(options);
+	for (int i = 0; i < 2; i++) {
+		ASSERT_OK(Put(Key(num_files++), "val"));
+		ASSERT_OK(Flush());
+	}
+	opens = TestGetTickerCount(options, NO_FILE_OPENS);
+	crash_and_reopen();
+	ASSERT_EQ(opens + num_files,
+		  TestGetTickerCount(options, NO_FILE_OPENS));
+	ASSERT_TRUE(dbfull()->GetIntProperty("rocksdb.estimate-num-keys",
+					     &num_keys));
+	ASSERT_EQ(static_cast<uint64_t>(num_files), num_keys);
+	ASSERT_EQ("val", Get(Key(num_files - 1)));
+}
+
+#ifndef ROCKSDB_LITE
+TEST_F(DBTest2, TraceAndReplay)
+{
+	Options options = CurrentOptions();
+	options.create_if_missing = true;
+	CreateAndReopenWithCF({ "pikachu" }, options);
+	ASSERT_OK(Put(0, "a", "old"));
+
+	const std::string trace_filename =
+		test::TmpDir(env_) + "/db_test2_trace";
+	std::unique_ptr<TraceWriter> trace_writer;
+	ASSERT_OK(NewFileTraceWriter(env_, EnvOptions(), trace_filename,
+				     &trace_writer));
+	ASSERT_TRUE(db_->EndTrace().IsIOError());
+	ASSERT_OK(db_->StartTrace(TraceOptions(), std::move(trace_writer)));
+	std::unique_ptr<TraceWriter> second_writer;
+	ASSERT_OK(NewFileTraceWriter(env_, EnvOptions(),
+				     trace_filename + ".2", &second_writer));
+	ASSERT_TRUE(db_->StartTrace(TraceOptions(), std::move(second_writer))
+			    .IsBusy());
+
+	ASSERT_OK(Put(0, "a", "1"));
+	ASSERT_OK(Put(1, "b", "2"));
+	ASSERT_OK(Delete(0, "a"));
+	WriteBatch batch;
+	ASSERT_OK(batch.Put(handles_[0], "c", "3"));
+	ASSERT_OK(batch.Put(handles_[1], "d", "4"));
+	ASSERT_OK(batch.SingleDelete(handles_[1], "b"));
+	ASSERT_OK(db_->Write(WriteOptions(), &batch));
+	ASSERT_EQ("NOT_FOUND", Get(0, "a"));
+	ASSERT_EQ("4", Get(1, "d"));
+	{
+		std::unique_ptr<Iterator> iter(
+			db_->NewIterator(ReadOptions(), handles_[1]));
+		iter->Seek("d");
+		ASSERT_TRUE(iter->Valid());
+		iter->SeekForPrev("c");
+		ASSERT_FALSE(iter->Valid());
+	}
+	ASSERT_OK(db_->EndTrace());
+	// Not part of the trace
+	ASSERT_OK(Put(0, "e", "5"));
+
+	// Replay against a fresh DB with the same column families
+	const std::string replay_dbname = dbname_ + "_replay";
+	ASSERT_OK(DestroyDB(replay_dbname, options));
+	DB *replay_db = nullptr;
+	std::vector<ColumnFamilyHandle *> replay_handles;
+	std::vector<ColumnFamilyDescriptor> column_families = {
+		{ kDefaultColumnFamilyName, options },
+		{ "pikachu", options }
+	};
+	DBOptions db_options(options);
+	db_options.create_missing_column_families = true;
+	ASSERT_OK(DB::Open(db_options, replay_dbname, column_families,
+			   &replay_handles, &replay_db));
+
+	std::unique_ptr<TraceReader> trace_reader;
+	ASSERT_OK(NewFileTraceReader(env_, EnvOptions(), trace_filename,
+				     &trace_reader));
+	Replayer replayer(replay_db, replay_handles, std::move(trace_reader));
+	ReplayOptions replay_options;
+	replay_options.fast_forward = true;
+	ASSERT_OK(replayer.Replay(replay_options));
+	// 4 writes, 2 gets and 2 seeks
+	ASSERT_EQ(8U, replayer.GetOpsReplayed());
+
+	std::string value;
+	ASSERT_TRUE(replay_db->Get(ReadOptions(), replay_handles[0], "a",
+				   &value)
+			    .IsNotFound());
+	ASSERT_TRUE(replay_db->Get(ReadOptions(), replay_handles[1], "b",
+				   &value)
+			    .IsNotFound());
+	ASSERT_OK(replay_db->Get(ReadOptions(), replay_handles[0], "c",
+				 &value));
+	ASSERT_EQ("3", value);
+	ASSERT_OK(replay_db->Get(ReadOptions(), replay_handles[1], "d",
+				 &value));
+	ASSERT_EQ("4", value);
+	ASSERT_TRUE(replay_db->Get(ReadOptions(), replay_handles[0], "e",
+				   &value)
+			    .IsNotFound());
+
+	for (auto handle : replay_handles) {
+		delete handle;
+	}
+	delete replay_db;
+	ASSERT_OK(DestroyDB(replay_dbname, options));
+	env_->DeleteFile(trace_filename);
+	env_->DeleteFile(trace_filename + ".2");
+}
+
+TEST_F(DBTest2, TraceConcurrentOps)
+{
+	Options options = CurrentOptions();
+	options.create_if_missing = true;
+	DestroyAndReopen(options);
+
+	const std::string trace_filename =
+		test::TmpDir(env_) + "/db_test2_concurrent_trace";
+	std::unique_ptr<TraceWriter> trace_writer;
+	ASSERT_OK(NewFileTraceWriter(env_, EnvOptions(), trace_filename,
+				     &trace_writer));
+	ASSERT_OK(db_->StartTrace(TraceOptions(), std::move(trace_writer)));
+
+	// The threads record to the trace's queue concurrently; every
+	// operation still ends up in the trace once EndTrace() drains it.
+	const int kNumThreads = 4;
+	const int kOpsPerThread = 200;
+	std::vector<port::Thread> threads;
+	for (int t = 0; t < kNumThreads; t++) {
+		threads.emplace_back([this, t]() {
+			for (int i = 0; i < kOpsPerThread; i++) {
+				std::string key = Key(t * kOpsPerThread + i);
+				ASSERT_OK(Put(key, "v"));
+				ASSERT_EQ("v", Get(key));
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	ASSERT_OK(db_->EndTrace());
+
+	const std::string replay_dbname = dbname_ + "_concurrent_replay";
+	ASSERT_OK(DestroyDB(replay_dbname, options));
+	DB *replay_db = nullptr;
+	ASSERT_OK(DB::Open(options, replay_dbname, &replay_db));
+	std::unique_ptr<TraceReader> trace_reader;
+	ASSERT_OK(NewFileTraceReader(env_, EnvOptions(), trace_filename,
+				     &trace_reader));
+	Replayer replayer(replay_db, { replay_db->DefaultColumnFamily() },
+			  std::move(trace_reader));
+	ReplayOptions replay_options;
+	replay_options.fast_forward = true;
+	ASSERT_OK(replayer.Replay(replay_options));
+	ASSERT_EQ(static_cast<uint64_t>(2 * kNumThreads * kOpsPerThread),
+		  replayer.GetOpsReplayed());
+	std::string value;
+	ASSERT_OK(replay_db->Get(ReadOptions(), Key(kOpsPerThread), &value));
+	ASSERT_EQ("v", value);
+
+	delete replay_db;
+	ASSERT_OK(DestroyDB(replay_dbname, options));
+	env_->DeleteFile(trace_filename);
+}
+#endif // ROCKSDB_LITE
 } // namespace rocksdb
 
 int main(int argc, char **argv)
@@ -464,6 +464,73 @@ TEST_F(DBWALTest, FullPurgePreservesRecycledLog)
 	}
 }
 
+TEST_F(DBWALTest, WalPool)
+{
+	Options options = CurrentOptions();
+	options.create_if_missing = true;
+	options.wal_pool_size = 2;
+	options.wal_dir = alternative_wal_dir_;
+
+	auto count_pool_files = [&]() {
+		std::vector<std::string> files;
+		env_->GetChildren(alternative_wal_dir_, &files);
+		int count = 0;
+		for (const auto &f : files) {
+			uint64_t number;
+			FileType type;
+			if (ParseFileName(f, &number, &type) &&
+			    type == kWalPoolFile) {
+				count++;
+			}
+		}
+		return count;
+	};
+	// The refill job fills the whole pool before it ends. The dependency
+	// has to be loaded before the refill is scheduled.
+	auto expect_refill = []() {
+		rocksdb::SyncPoint::GetInstance()->LoadDependency({
+			{ "DBImpl::BGWorkWalPool:end",
+			  "DBWALTest::WalPool:Refilled" },
+		});
+	};
+	rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+	expect_refill();
+	DestroyAndReopen(options);
+	TEST_SYNC_POINT("DBWALTest::WalPool:Refilled");
+	ASSERT_EQ(2, count_pool_files());
+
+	// The log created by the flush comes from the pool and already has
+	// its final size before anything is written to it.
+	expect_refill();
+	ASSERT_OK(Put("foo", "v1"));
+	ASSERT_OK(Flush());
+	uint64_t log_size = 0;
+	ASSERT_OK(env_->GetFileSize(
+		LogFileName(alternative_wal_dir_,
+			    dbfull()->TEST_LogfileNumber()),
+		&log_size));
+	ASSERT_GT(log_size, 0U);
+	ASSERT_OK(Put("foo", "v2"));
+	TEST_SYNC_POINT("DBWALTest::WalPool:Refilled");
+	ASSERT_EQ(2, count_pool_files());
+
+	// Pool files are adopted on reopen, not leaked or duplicated. The
+	// pool is full again, so no refill is scheduled.
+	Reopen(options);
+	ASSERT_EQ("v2", Get("foo"));
+	ASSERT_EQ(2, count_pool_files());
+
+	options.wal_pool_size = 1;
+	Reopen(options);
+	ASSERT_EQ(1, count_pool_files());
+
+	rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+	Close();
+	ASSERT_OK(DestroyDB(dbname_, options));
+	ASSERT_EQ(0, count_pool_files());
+}
+
 TEST_F(DBWALTest, GetSortedWalFiles)
 {
 	do {
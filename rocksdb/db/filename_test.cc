@@ -43,6 +43,8 @@ TEST_F(FileNameTest, Parse)
 		{ "0.sst", 0, kTableFile, kAllMode },
 		{ "CURRENT", 0, kCurrentFile, kAllMode },
 		{ "LOCK", 0, kDBLockFile, kAllMode },
+		{ "TABLEMETA", 0, kTableMetaFile, kAllMode },
+		{ "12.logpool", 12, kWalPoolFile, kAllMode },
 		{ "MANIFEST-2", 2, kDescriptorFile, kAllMode },
 		{ "MANIFEST-7", 7, kDescriptorFile, kAllMode },
 		{ "METADB-2", 2, kMetaDatabase, kAllMode },
@@ -185,6 +187,12 @@ TEST_F(FileNameTest, Construction)
 	ASSERT_TRUE(ParseFileName(fname.c_str() + 4, &number, &type));
 	ASSERT_EQ(100U, number);
 	ASSERT_EQ(kMetaDatabase, type);
+
+	fname = WalPoolFileName("wal", 123);
+	ASSERT_EQ("wal/", std::string(fname.data(), 4));
+	ASSERT_TRUE(ParseFileName(fname.c_str() + 4, &number, &type));
+	ASSERT_EQ(123U, number);
+	ASSERT_EQ(kWalPoolFile, type);
 }
 
 } // namespace rocksdb
@@ -20,6 +20,7 @@
 #include "db/column_family.h"
 
 #include "db/db_impl.h"
+#include "rocksdb/rate_limiter.h"
 #include "util/string_util.h"
 
 namespace rocksdb
@@ -193,6 +194,32 @@ std::pair<Slice, Slice> GetPropertyNameAndArg(const Slice &property)
 	arg.remove_prefix(property.size() - sfx_len);
 	return { name, arg };
 }
+
+const char *WriteStallCauseName(WriteStallCause cause)
+{
+	switch (cause) {
+	case WriteStallCause::kMemtableLimit:
+		return "memtable-limit";
+	case WriteStallCause::kL0FileCountLimit:
+		return "l0-file-count-limit";
+	case WriteStallCause::kPendingCompactionBytes:
+		return "pending-compaction-bytes";
+	default:
+		return "none";
+	}
+}
+
+const char *WriteStallConditionName(WriteStallCondition condition)
+{
+	switch (condition) {
+	case WriteStallCondition::kDelayed:
+		return "delayed";
+	case WriteStallCondition::kStopped:
+		return "stopped";
+	default:
+		return "normal";
+	}
+}
 } // anonymous namespace
 
 static const std::string rocksdb_prefix = "rocksdb.";
@@ -208,6 +235,10 @@ static const std::string cfstats_no_file_histogram =
 static const std::string cf_file_histogram = "cf-file-histogram";
 static const std::string dbstats = "dbstats";
 static const std::string levelstats = "levelstats";
+static const std::string sst_read_stats = "sst-read-stats";
+static const std::string compaction_key_range_stats =
+	"compaction-key-range-stats";
+static const std::string write_stall_stats = "write-stall-stats";
 static const std::string num_immutable_mem_table = "num-immutable-mem-table";
 static const std::string num_immutable_mem_table_flushed =
 	"num-immutable-mem-table-flushed";
@@ -251,6 +282,8 @@ static const std::string num_running_flushes = "num-running-flushes";
 static const std::string actual_delayed_write_rate =
 	"actual-delayed-write-rate";
 static const std::string is_write_stopped = "is-write-stopped";
+static const std::string rate_limiter_bytes_per_sec =
+	"rate-limiter-bytes-per-sec";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
 	rocksdb_prefix + num_files_at_level_prefix;
@@ -265,6 +298,12 @@ const std::string DB::Properties::kCFFileHistogram =
 	rocksdb_prefix + cf_file_histogram;
 const std::string DB::Properties::kDBStats = rocksdb_prefix + dbstats;
 const std::string DB::Properties::kLevelStats = rocksdb_prefix + levelstats;
+const std::string DB::Properties::kSstReadStats =
+	rocksdb_prefix + sst_read_stats;
+const std::string DB::Properties::kCompactionKeyRangeStats =
+	rocksdb_prefix + compaction_key_range_stats;
+const std::string DB::Properties::kWriteStallStats =
+	rocksdb_prefix + write_stall_stats;
 const std::string DB::Properties::kNumImmutableMemTable =
 	rocksdb_prefix + num_immutable_mem_table;
 const std::string DB::Properties::kNumImmutableMemTableFlushed =
@@ -324,6 +363,8 @@ const std::string DB::Properties::kActualDelayedWriteRate =
 	rocksdb_prefix + actual_delayed_write_rate;
 const std::string DB::Properties::kIsWriteStopped =
 	rocksdb_prefix + is_write_stopped;
+const std::string DB::Properties::kRateLimiterBytesPerSec =
+	rocksdb_prefix + rate_limiter_bytes_per_sec;
 
 const std::unordered_map<std::string, DBPropertyInfo>
 	InternalStats::ppt_name_to_info = {
@@ -351,6 +392,16 @@ const std::unordered_map<std::string, DBPropertyInfo>
 		  { false, &InternalStats::HandleDBStats, nullptr, nullptr } },
 		{ DB::Properties::kSSTables,
 		  { false, &InternalStats::HandleSsTables, nullptr, nullptr } },
+		{ DB::Properties::kSstReadStats,
+		  { false, &InternalStats::HandleSstReadStats, nullptr,
+		    nullptr } },
+		{ DB::Properties::kCompactionKeyRangeStats,
+		  { false, &InternalStats::HandleCompactionKeyRangeStats,
+		    nullptr,
+		    &InternalStats::HandleCompactionKeyRangeMapStats } },
+		{ DB::Properties::kWriteStallStats,
+		  { false, &InternalStats::HandleWriteStallStats, nullptr,
+		    &InternalStats::HandleWriteStallMapStats } },
 		{ DB::Properties::kAggregatedTableProperties,
 		  { false, &InternalStats::HandleAggregatedTableProperties,
 		    nullptr, nullptr } },
@@ -445,6 +496,9 @@ const std::unordered_map<std::string, DBPropertyInfo>
 		{ DB::Properties::kIsWriteStopped,
 		  { false, nullptr, &InternalStats::HandleIsWriteStopped,
 		    nullptr } },
+		{ DB::Properties::kRateLimiterBytesPerSec,
+		  { false, nullptr,
+		    &InternalStats::HandleRateLimiterBytesPerSec, nullptr } },
 	};
 
 const DBPropertyInfo *GetPropertyInfo(const Slice &property)
@@ -593,6 +647,249 @@ bool InternalStats::HandleSsTables(std::string *value, Slice suffix)
 	return true;
 }
 
+bool InternalStats::HandleSstReadStats(std::string *value, Slice suffix)
+{
+	char buf[200];
+	const auto *vstorage = cfd_->current()->storage_info();
+	snprintf(buf, sizeof(buf),
+		 "Sampled reads since the file was created or the DB opened\n"
+		 "Level       File Size(MB)       Gets      Seeks Read(MB)\n"
+		 "-------------------------------------------------------\n");
+	value->append(buf);
+	for (int level = 0; level < number_levels_; level++) {
+		for (const FileMetaData *file : vstorage->LevelFiles(level)) {
+			const FileSampledStats &stats = file->stats;
+			snprintf(buf, sizeof(buf),
+				 "%5d %10" PRIu64 " %8.1f %10" PRIu64
+				 " %10" PRIu64 " %8.1f\n",
+				 level, file->fd.GetNumber(),
+				 file->fd.GetFileSize() / kMB,
+				 stats.num_reads_sampled.load(
+					 std::memory_order_relaxed),
+				 stats.num_seeks_sampled.load(
+					 std::memory_order_relaxed),
+				 stats.bytes_read_sampled.load(
+					 std::memory_order_relaxed) /
+					 kMB);
+			value->append(buf);
+		}
+	}
+	return true;
+}
+
+bool InternalStats::HandleCompactionKeyRangeStats(std::string *value,
+						  Slice suffix)
+{
+	// The ranges that were rewritten the most
+	const size_t kMaxRangesShown = 100;
+	std::vector<std::pair<uint64_t, const std::string *> > ranges;
+	uint64_t total_bytes = key_range_overflow_.bytes_rewritten;
+	for (const auto &range : key_range_stats_) {
+		ranges.emplace_back(range.second.bytes_rewritten, &range.first);
+		total_bytes += range.second.bytes_rewritten;
+	}
+	std::sort(ranges.begin(), ranges.end(),
+		  [](const std::pair<uint64_t, const std::string *> &a,
+		     const std::pair<uint64_t, const std::string *> &b) {
+			  return a.first > b.first;
+		  });
+
+	char buf[200];
+	snprintf(buf, sizeof(buf),
+		 "Key range                         Compactions Rewritten(MB) "
+		 "Share\n"
+		 "----------------------------------------------------------"
+		 "------\n");
+	value->append(buf);
+	for (size_t i = 0; i < ranges.size() && i < kMaxRangesShown; i++) {
+		const std::string &range = *ranges[i].second;
+		std::string name = range;
+		for (char c : range) {
+			if (!isprint(static_cast<unsigned char>(c))) {
+				name = "0x" + Slice(range).ToString(true);
+				break;
+			}
+		}
+		snprintf(buf, sizeof(buf),
+			 "%-33s %11" PRIu64 " %13.1f %4.1f%%\n", name.c_str(),
+			 key_range_stats_[range].num_compactions,
+			 ranges[i].first / kMB,
+			 total_bytes > 0 ? ranges[i].first * 100.0 /
+						   total_bytes :
+					   0.0);
+		value->append(buf);
+	}
+	if (ranges.size() > kMaxRangesShown) {
+		snprintf(buf, sizeof(buf), "... %" ROCKSDB_PRIszt " more\n",
+			 ranges.size() - kMaxRangesShown);
+		value->append(buf);
+	}
+	if (key_range_overflow_.bytes_rewritten > 0) {
+		snprintf(buf, sizeof(buf), "%-33s %11" PRIu64 " %13.1f\n",
+			 "(beyond the first ranges)",
+			 key_range_overflow_.num_compactions,
+			 key_range_overflow_.bytes_rewritten / kMB);
+		value->append(buf);
+	}
+	return true;
+}
+
+bool InternalStats::HandleCompactionKeyRangeMapStats(
+	std::map<std::string, double> *key_range_stats)
+{
+	for (const auto &range : key_range_stats_) {
+		(*key_range_stats)[range.first] = static_cast<double>(
+			range.second.bytes_rewritten);
+	}
+	return true;
+}
+
+void InternalStats::AddCompactionKeyRangeStats(
+	const std::map<std::string, uint64_t> &key_range_bytes,
+	uint64_t overflow_bytes)
+{
+	bool overflowed = overflow_bytes > 0;
+	key_range_overflow_.bytes_rewritten += overflow_bytes;
+	for (const auto &range : key_range_bytes) {
+		auto it = key_range_stats_.find(range.first);
+		if (it == key_range_stats_.end()) {
+			if (key_range_stats_.size() >= kMaxKeyRanges) {
+				key_range_overflow_.bytes_rewritten +=
+					range.second;
+				overflowed = true;
+				continue;
+			}
+			it = key_range_stats_.emplace(range.first,
+						      KeyRangeStats())
+				     .first;
+		}
+		it->second.bytes_rewritten += range.second;
+		it->second.num_compactions++;
+	}
+	if (overflowed) {
+		key_range_overflow_.num_compactions++;
+	}
+}
+
+void InternalStats::SetWriteStallCondition(WriteStallCondition condition,
+					   WriteStallCause cause)
+{
+	if (write_stall_condition_ == WriteStallCondition::kNormal &&
+	    condition == WriteStallCondition::kNormal) {
+		return;
+	}
+	uint64_t now = env_->NowMicros();
+	if (write_stall_condition_ != WriteStallCondition::kNormal &&
+	    now > write_stall_since_) {
+		write_stall_micros_[static_cast<int>(write_stall_cause_)]
+				   [write_stall_condition_ ==
+				    WriteStallCondition::kStopped] +=
+			now - write_stall_since_;
+	}
+	write_stall_condition_ = condition;
+	write_stall_cause_ = cause;
+	write_stall_since_ = now;
+}
+
+uint64_t InternalStats::GetWriteStallMicros(WriteStallCondition condition,
+					    WriteStallCause cause)
+{
+	uint64_t micros =
+		write_stall_micros_[static_cast<int>(cause)]
+				   [condition == WriteStallCondition::kStopped];
+	// The current stall counts up to now
+	if (condition == write_stall_condition_ &&
+	    cause == write_stall_cause_) {
+		uint64_t now = env_->NowMicros();
+		if (now > write_stall_since_) {
+			micros += now - write_stall_since_;
+		}
+	}
+	return micros;
+}
+
+bool InternalStats::HandleWriteStallStats(std::string *value, Slice suffix)
+{
+	const WriteController *wc = cfd_->write_controller();
+	char buf[200];
+	value->append("\n** Write Stall Stats [");
+	value->append(cfd_->GetName());
+	value->append("] **\n");
+	snprintf(buf, sizeof(buf), "Condition: %s, cause: %s\n",
+		 WriteStallConditionName(write_stall_condition_),
+		 WriteStallCauseName(write_stall_cause_));
+	value->append(buf);
+	value->append(
+		"Time the column family delayed and stopped the writes, time "
+		"the writes waited for, and write controller tokens:\n"
+		"Cause                    CFDelay(s) CFStop(s) Delayed(s) "
+		"Stopped(s) Delay Stop\n");
+	for (int i = 0; i < static_cast<int>(WriteStallCause::kNumCauses);
+	     i++) {
+		WriteStallCause cause = static_cast<WriteStallCause>(i);
+		snprintf(buf, sizeof(buf),
+			 "%-24s %10.3f %9.3f %10.3f %10.3f %5d %4d\n",
+			 WriteStallCauseName(cause),
+			 GetWriteStallMicros(WriteStallCondition::kDelayed,
+					     cause) /
+				 kMicrosInSec,
+			 GetWriteStallMicros(WriteStallCondition::kStopped,
+					     cause) /
+				 kMicrosInSec,
+			 wc->GetStallMicros(WriteStallCondition::kDelayed,
+					    cause) /
+				 kMicrosInSec,
+			 wc->GetStallMicros(WriteStallCondition::kStopped,
+					    cause) /
+				 kMicrosInSec,
+			 wc->NumDelayTokens(cause), wc->NumStopTokens(cause));
+		value->append(buf);
+	}
+	snprintf(buf, sizeof(buf),
+		 "Compaction pressure tokens: %d, delayed write rate: %.1f "
+		 "MB/s\n",
+		 wc->NumCompactionPressureTokens(),
+		 wc->NeedsDelay() ? wc->delayed_write_rate() / kMB : 0.0);
+	value->append(buf);
+	return true;
+}
+
+bool InternalStats::HandleWriteStallMapStats(
+	std::map<std::string, double> *stall_stats)
+{
+	const WriteController *wc = cfd_->write_controller();
+	auto &stats = *stall_stats;
+	stats["cf.condition"] = static_cast<double>(write_stall_condition_);
+	stats["cf.cause"] = static_cast<double>(write_stall_cause_);
+	for (int i = 0; i < static_cast<int>(WriteStallCause::kNumCauses);
+	     i++) {
+		WriteStallCause cause = static_cast<WriteStallCause>(i);
+		const std::string name = WriteStallCauseName(cause);
+		stats["cf." + name + ".delayed-micros"] =
+			static_cast<double>(GetWriteStallMicros(
+				WriteStallCondition::kDelayed, cause));
+		stats["cf." + name + ".stopped-micros"] =
+			static_cast<double>(GetWriteStallMicros(
+				WriteStallCondition::kStopped, cause));
+		stats["db." + name + ".delayed-micros"] =
+			static_cast<double>(wc->GetStallMicros(
+				WriteStallCondition::kDelayed, cause));
+		stats["db." + name + ".stopped-micros"] =
+			static_cast<double>(wc->GetStallMicros(
+				WriteStallCondition::kStopped, cause));
+		stats["db." + name + ".delay-tokens"] =
+			wc->NumDelayTokens(cause);
+		stats["db." + name + ".stop-tokens"] = wc->NumStopTokens(cause);
+	}
+	stats["db.compaction-pressure-tokens"] =
+		wc->NumCompactionPressureTokens();
+	stats["db.delayed-write-rate"] =
+		wc->NeedsDelay() ?
+			static_cast<double>(wc->delayed_write_rate()) :
+			0.0;
+	return true;
+}
+
 bool InternalStats::HandleAggregatedTableProperties(std::string *value,
 						    Slice suffix)
 {
@@ -854,6 +1151,14 @@ bool InternalStats::HandleIsWriteStopped(uint64_t *value, DBImpl *db,
 	return true;
 }
 
+bool InternalStats::HandleRateLimiterBytesPerSec(uint64_t *value, DBImpl *db,
+						 Version *version)
+{
+	RateLimiter *limiter = db->immutable_db_options().rate_limiter.get();
+	*value = limiter != nullptr ? limiter->GetBytesPerSecond() : 0;
+	return true;
+}
+
 void InternalStats::DumpDBStats(std::string *value)
 {
 	char buf[1000];
@@ -918,6 +1223,25 @@ void InternalStats::DumpDBStats(std::string *value)
 		// 10000 = divide by 1M to get secs, then multiply by 100 for pct
 		write_stall_micros / 10000.0 / std::max(seconds_up, 0.001));
 	value->append(buf);
+	const WriteController *wc = cfd_->write_controller();
+	value->append("Cumulative stall by cause:");
+	const char *separator = "";
+	for (int i = static_cast<int>(WriteStallCause::kNone) + 1;
+	     i < static_cast<int>(WriteStallCause::kNumCauses); i++) {
+		WriteStallCause cause = static_cast<WriteStallCause>(i);
+		snprintf(buf, sizeof(buf),
+			 "%s %s %.3f delayed, %.3f stopped secs", separator,
+			 WriteStallCauseName(cause),
+			 wc->GetStallMicros(WriteStallCondition::kDelayed,
+					    cause) /
+				 kMicrosInSec,
+			 wc->GetStallMicros(WriteStallCondition::kStopped,
+					    cause) /
+				 kMicrosInSec);
+		value->append(buf);
+		separator = ",";
+	}
+	value->append("\n");
 
 	// Interval
 	uint64_t interval_write_other =
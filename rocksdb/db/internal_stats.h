@@ -117,8 +117,12 @@ class InternalStats {
 	InternalStats(int num_levels, Env *env, ColumnFamilyData *cfd)
 		: db_stats_{}, cf_stats_value_{}, cf_stats_count_{},
 		  comp_stats_(num_levels), file_read_latency_(num_levels),
-		  bg_error_count_(0), number_levels_(num_levels), env_(env),
-		  cfd_(cfd), started_at_(env->NowMicros())
+		  write_stall_micros_{},
+		  write_stall_condition_(WriteStallCondition::kNormal),
+		  write_stall_cause_(WriteStallCause::kNone),
+		  write_stall_since_(0), bg_error_count_(0),
+		  number_levels_(num_levels), env_(env), cfd_(cfd),
+		  started_at_(env->NowMicros())
 	{
 	}
 
@@ -256,6 +260,12 @@ class InternalStats {
 		for (auto &h : file_read_latency_) {
 			h.Clear();
 		}
+		key_range_stats_.clear();
+		key_range_overflow_ = KeyRangeStats();
+		for (auto &by_condition : write_stall_micros_) {
+			by_condition[0] = by_condition[1] = 0;
+		}
+		write_stall_since_ = env_->NowMicros();
 		cf_stats_snapshot_.Clear();
 		db_stats_snapshot_.Clear();
 		bg_error_count_ = 0;
@@ -267,6 +277,21 @@ class InternalStats {
 		comp_stats_[level].Add(stats);
 	}
 
+	// Most key ranges kept apart, by a compaction or in total
+	static const size_t kMaxKeyRanges = 10000;
+
+	// Adds the bytes a compaction wrote per key range, and overflow_bytes
+	// of further ranges it didn't keep apart. Requires the DB mutex.
+	void AddCompactionKeyRangeStats(
+		const std::map<std::string, uint64_t> &key_range_bytes,
+		uint64_t overflow_bytes);
+
+	// Charges the time since the last call to the write stall condition
+	// and cause of then, and remembers the new ones. Requires the DB
+	// mutex.
+	void SetWriteStallCondition(WriteStallCondition condition,
+				    WriteStallCause cause);
+
 	void IncBytesMoved(int level, uint64_t amount)
 	{
 		comp_stats_[level].bytes_moved += amount;
@@ -333,6 +358,16 @@ class InternalStats {
 	void DumpCFStatsNoFileHistogram(std::string *value);
 	void DumpCFFileHistogram(std::string *value);
 
+	// Compaction writes of the key ranges of
+	// compaction_stats_key_prefix_length, up to kMaxKeyRanges ranges; the
+	// writes of further ranges are added to key_range_overflow_.
+	struct KeyRangeStats {
+		uint64_t bytes_rewritten = 0;
+		uint64_t num_compactions = 0;
+	};
+	std::map<std::string, KeyRangeStats> key_range_stats_;
+	KeyRangeStats key_range_overflow_;
+
 	// Per-DB stats
 	std::atomic<uint64_t> db_stats_[INTERNAL_DB_STATS_ENUM_MAX];
 	// Per-ColumnFamily stats
@@ -342,6 +377,14 @@ class InternalStats {
 	std::vector<CompactionStats> comp_stats_;
 	std::vector<HistogramImpl> file_read_latency_;
 
+	// Time the column family delayed or stopped the writes, indexed by
+	// cause, then by delayed (0) or stopped (1)
+	uint64_t write_stall_micros_[static_cast<int>(
+		WriteStallCause::kNumCauses)][2];
+	WriteStallCondition write_stall_condition_;
+	WriteStallCause write_stall_cause_;
+	uint64_t write_stall_since_;
+
 	// Used to compute per-interval statistics
 	struct CFStatsSnapshot {
 		// ColumnFamily-level stats
@@ -439,6 +482,15 @@ class InternalStats {
 	bool HandleCFFileHistogram(std::string *value, Slice suffix);
 	bool HandleDBStats(std::string *value, Slice suffix);
 	bool HandleSsTables(std::string *value, Slice suffix);
+	bool HandleSstReadStats(std::string *value, Slice suffix);
+	bool HandleCompactionKeyRangeStats(std::string *value, Slice suffix);
+	uint64_t GetWriteStallMicros(WriteStallCondition condition,
+				     WriteStallCause cause);
+	bool HandleWriteStallStats(std::string *value, Slice suffix);
+	bool HandleWriteStallMapStats(
+		std::map<std::string, double> *stall_stats);
+	bool HandleCompactionKeyRangeMapStats(
+		std::map<std::string, double> *key_range_stats);
 	bool HandleAggregatedTableProperties(std::string *value, Slice suffix);
 	bool HandleAggregatedTablePropertiesAtLevel(std::string *value,
 						    Slice suffix);
@@ -496,6 +548,8 @@ class InternalStats {
 					  Version *version);
 	bool HandleIsWriteStopped(uint64_t *value, DBImpl *db,
 				  Version *version);
+	bool HandleRateLimiterBytesPerSec(uint64_t *value, DBImpl *db,
+					  Version *version);
 
 	// Total number of background errors encountered. Every time a flush task
 	// or compaction task fails, this counter is incremented. The failure can
@@ -582,6 +636,19 @@ class InternalStats {
 	{
 	}
 
+	static const size_t kMaxKeyRanges = 10000;
+
+	void AddCompactionKeyRangeStats(
+		const std::map<std::string, uint64_t> &key_range_bytes,
+		uint64_t overflow_bytes)
+	{
+	}
+
+	void SetWriteStallCondition(WriteStallCondition condition,
+				    WriteStallCause cause)
+	{
+	}
+
 	void IncBytesMoved(int level, uint64_t amount)
 	{
 	}
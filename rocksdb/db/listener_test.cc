@@ -862,6 +862,67 @@ TEST_F(EventListenerTest, ColumnFamilyHandleDeletionStartedListenerTest)
 	ASSERT_EQ(listener->getCounter(), 3);
 }
 
+class WriteStallListener : public EventListener {
+    public:
+	void OnStallConditionsChanged(const WriteStallInfo &info) override
+	{
+		MutexLock l(&mutex_);
+		infos_.push_back(info);
+	}
+
+	std::vector<WriteStallInfo> infos()
+	{
+		MutexLock l(&mutex_);
+		return infos_;
+	}
+
+    private:
+	port::Mutex mutex_;
+	std::vector<WriteStallInfo> infos_;
+};
+
+TEST_F(EventListenerTest, OnStallConditionsChanged)
+{
+	auto listener = std::make_shared<WriteStallListener>();
+	Options options = CurrentOptions();
+	options.create_if_missing = true;
+	options.listeners.push_back(listener);
+	// Writes are delayed with 3 memtables waiting for flush
+	options.max_write_buffer_number = 4;
+	options.max_background_flushes = 1;
+	DestroyAndReopen(options);
+
+	env_->SetBackgroundThreads(1, Env::HIGH);
+	test::SleepingBackgroundTask sleeping_task_high;
+	env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask,
+		       &sleeping_task_high, Env::Priority::HIGH);
+	for (int i = 0; i < 3; i++) {
+		ASSERT_OK(Put("key" + ToString(i), "value"));
+		ASSERT_OK(dbfull()->TEST_FlushMemTable(false));
+	}
+	// The next write delivers the change
+	ASSERT_OK(Put("key", "value"));
+	std::vector<WriteStallInfo> infos = listener->infos();
+	ASSERT_EQ(1, infos.size());
+	ASSERT_EQ(kDefaultColumnFamilyName, infos[0].cf_name);
+	ASSERT_EQ(WriteStallCondition::kNormal, infos[0].condition.prev);
+	ASSERT_EQ(WriteStallCondition::kDelayed, infos[0].condition.cur);
+	ASSERT_EQ(WriteStallCause::kNone, infos[0].cause.prev);
+	ASSERT_EQ(WriteStallCause::kMemtableLimit, infos[0].cause.cur);
+
+	sleeping_task_high.WakeUp();
+	sleeping_task_high.WaitUntilDone();
+	dbfull()->TEST_WaitForCompact();
+	infos = listener->infos();
+	ASSERT_GT(infos.size(), 1);
+	ASSERT_EQ(WriteStallCondition::kNormal, infos.back().condition.cur);
+	ASSERT_EQ(WriteStallCause::kNone, infos.back().cause.cur);
+	for (size_t i = 1; i < infos.size(); i++) {
+		ASSERT_EQ(infos[i - 1].condition.cur, infos[i].condition.prev);
+		ASSERT_EQ(infos[i - 1].cause.cur, infos[i].cause.prev);
+	}
+}
+
 } // namespace rocksdb
 
 #endif // ROCKSDB_LITE
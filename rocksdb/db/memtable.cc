@@ -70,7 +70,8 @@ MemTable::MemTable(const InternalKeyComparator &cmp,
 		  write_buffer_manager->enabled()) ?
 			       &mem_tracker_ :
 			       nullptr,
-		 mutable_cf_options.memtable_huge_page_size),
+		 mutable_cf_options.memtable_huge_page_size,
+		 ioptions.numa_aware),
 	  table_(ioptions.memtable_factory->CreateMemTableRep(
 		  comparator_, &arena_, ioptions.prefix_extractor,
 		  ioptions.info_log, column_family_id)),
@@ -13,9 +13,11 @@
 #include "monitoring/thread_status_util.h"
 #include "port/port.h"
 #include "rocksdb/db.h"
+#include "rocksdb/filter_policy.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/perf_context.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/table.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 #include "util/testharness.h"
@@ -732,6 +734,104 @@ TEST_F(PerfContextTest, MergeOperatorTime)
 
 	delete db;
 }
+
+TEST_F(PerfContextTest, PerLevelPerfContext)
+{
+	DestroyDB(kDbName, Options());
+	DB *db;
+	Options options;
+	options.create_if_missing = true;
+	BlockBasedTableOptions table_options;
+	table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+	options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+	ASSERT_OK(DB::Open(options, kDbName, &db));
+
+	// "a" keys on a level below 0, "b" keys on level 0
+	for (int i = 0; i < 100; i++) {
+		ASSERT_OK(db->Put(WriteOptions(), "a" + ToString(i), "val"));
+	}
+	ASSERT_OK(db->Flush(FlushOptions()));
+	ASSERT_OK(db->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+	int bottom = 0;
+	std::string num_files;
+	while (num_files != "1") {
+		bottom++;
+		ASSERT_LT(bottom, options.num_levels);
+		ASSERT_TRUE(db->GetProperty(
+			"rocksdb.num-files-at-level" + ToString(bottom),
+			&num_files));
+	}
+	for (int i = 0; i < 100; i++) {
+		ASSERT_OK(db->Put(WriteOptions(), "b" + ToString(i), "val"));
+	}
+	ASSERT_OK(db->Flush(FlushOptions()));
+	// The "a" table was moved down trivially and would keep counting into
+	// level 0 until the table cache reopens it
+	delete db;
+	ASSERT_OK(DB::Open(options, kDbName, &db));
+
+	SetPerfLevel(kEnableTime);
+	get_perf_context()->Reset();
+	get_perf_context()->EnablePerLevelPerfContext();
+	std::string val;
+	ASSERT_OK(db->Get(ReadOptions(), "a5", &val));
+	// Within the key range of the level 0 table only, so that its filter
+	// is checked
+	ASSERT_TRUE(db->Get(ReadOptions(), "b5x", &val).IsNotFound());
+
+	const PerfContextByLevel &level0 =
+		get_perf_context()->level_perf_context[0];
+	const PerfContextByLevel &bottom_level =
+		get_perf_context()->level_perf_context[bottom];
+	// "b5x" is not in the level 0 table, barring false positives
+	ASSERT_GE(level0.bloom_filter_useful, 1U);
+	ASSERT_GE(bottom_level.bloom_filter_full_positive, 1U);
+	ASSERT_EQ(1U, bottom_level.bloom_filter_full_true_positive);
+	ASSERT_GE(bottom_level.block_cache_miss_count, 1U);
+	ASSERT_GE(bottom_level.block_read_count, 1U);
+	ASSERT_GT(bottom_level.block_read_byte, 0U);
+	ASSERT_GT(bottom_level.block_read_time, 0U);
+	ASSERT_EQ(get_perf_context()->block_read_count,
+		  level0.block_read_count + bottom_level.block_read_count);
+	ASSERT_NE(std::string::npos,
+		  get_perf_context()->ToString(true).find(
+			  "bloom_filter_full_true_positive = 1@level" +
+			  ToString(bottom)));
+
+	// The block is cached now
+	ASSERT_OK(db->Get(ReadOptions(), "a5", &val));
+	ASSERT_GE(bottom_level.block_cache_hit_count, 1U);
+
+	get_perf_context()->DisablePerLevelPerfContext();
+	get_perf_context()->ClearPerLevelPerfContext();
+	ASSERT_OK(db->Get(ReadOptions(), "a6", &val));
+	ASSERT_EQ(0U, bottom_level.bloom_filter_full_positive);
+	ASSERT_EQ(0U, bottom_level.block_cache_hit_count);
+	ASSERT_EQ(std::string::npos,
+		  get_perf_context()->ToString().find("@level"));
+
+	// Index blocks read through the block cache count too. Recovery only
+	// prefetches those of level 0 tables.
+	delete db;
+	table_options.cache_index_and_filter_blocks = true;
+	options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+	ASSERT_OK(DB::Open(options, kDbName, &db));
+	get_perf_context()->Reset();
+	get_perf_context()->EnablePerLevelPerfContext();
+	// The index and the data block miss and are read
+	ASSERT_OK(db->Get(ReadOptions(), "a5", &val));
+	ASSERT_EQ(2U, bottom_level.block_cache_miss_count);
+	ASSERT_EQ(2U, bottom_level.block_read_count);
+	ASSERT_EQ(0U, bottom_level.block_cache_hit_count);
+	// Then both hit
+	ASSERT_OK(db->Get(ReadOptions(), "a5", &val));
+	ASSERT_EQ(2U, bottom_level.block_cache_hit_count);
+	ASSERT_EQ(2U, bottom_level.block_read_count);
+
+	get_perf_context()->DisablePerLevelPerfContext();
+	SetPerfLevel(kDisable);
+	delete db;
+}
 } // namespace rocksdb
 
 int main(int argc, char **argv)
@@ -28,6 +28,7 @@ namespace rocksdb
 {
 class Env;
 class Arena;
+class BlockCacheTracer;
 struct FileDescriptor;
 class GetContext;
 class HistogramImpl;
@@ -35,8 +36,11 @@ class InternalIterator;
 
 class TableCache {
     public:
+	// @param block_cache_tracer Handed to the table readers, which record
+	//    their block cache lookups to it while the DB traces them
 	TableCache(const ImmutableCFOptions &ioptions,
-		   const EnvOptions &storage_options, Cache *cache);
+		   const EnvOptions &storage_options, Cache *cache,
+		   BlockCacheTracer *block_cache_tracer = nullptr);
 	~TableCache();
 
 	// Return an iterator for the specified file number (the corresponding
@@ -145,6 +149,7 @@ class TableCache {
 	const EnvOptions &env_options_;
 	Cache *const cache_;
 	std::string row_cache_id_;
+	BlockCacheTracer *const block_cache_tracer_;
 };
 
 } // namespace rocksdb
@@ -0,0 +1,151 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/table_meta_snapshot.h"
+
+#include "db/version_edit.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/filename.h"
+
+namespace rocksdb
+{
+namespace
+{
+// Format:
+//    version      varint32
+//    num_entries  varint64
+//    entries      num_entries * {
+//        file_number, cf_id, path_id, file_size, has_stats
+//        [num_entries, num_deletions, raw_key_size, raw_value_size]
+//    }
+//    crc          fixed32, masked crc32c of everything above
+const uint32_t kTableMetaSnapshotVersion = 1;
+} // namespace
+
+void TableMetaSnapshot::Add(uint32_t cf_id, const FileMetaData &f)
+{
+	Entry &e = entries_[f.fd.GetNumber()];
+	e.cf_id = cf_id;
+	e.path_id = f.fd.GetPathId();
+	e.file_size = f.fd.GetFileSize();
+	e.has_stats = f.init_stats_from_file;
+	e.num_entries = f.num_entries;
+	e.num_deletions = f.num_deletions;
+	e.raw_key_size = f.raw_key_size;
+	e.raw_value_size = f.raw_value_size;
+}
+
+Status TableMetaSnapshot::Write(Env *env, const std::string &dbname,
+				uint64_t tmp_number) const
+{
+	std::string rep;
+	PutVarint32(&rep, kTableMetaSnapshotVersion);
+	PutVarint64(&rep, entries_.size());
+	for (const auto &it : entries_) {
+		const Entry &e = it.second;
+		PutVarint64(&rep, it.first);
+		PutVarint32Varint32(&rep, e.cf_id, e.path_id);
+		PutVarint64(&rep, e.file_size);
+		rep.push_back(e.has_stats ? 1 : 0);
+		if (e.has_stats) {
+			PutVarint64Varint64(&rep, e.num_entries,
+					    e.num_deletions);
+			PutVarint64Varint64(&rep, e.raw_key_size,
+					    e.raw_value_size);
+		}
+	}
+	PutFixed32(&rep, crc32c::Mask(crc32c::Value(rep.data(), rep.size())));
+
+	std::string tmp = TempFileName(dbname, tmp_number);
+	Status s = WriteStringToFile(env, rep, tmp, true);
+	if (s.ok()) {
+		s = env->RenameFile(tmp, TableMetaFileName(dbname));
+	}
+	if (!s.ok()) {
+		env->DeleteFile(tmp);
+	}
+	return s;
+}
+
+Status TableMetaSnapshot::Read(Env *env, const std::string &dbname)
+{
+	entries_.clear();
+	std::string fname = TableMetaFileName(dbname);
+	Status s = env->FileExists(fname);
+	if (!s.ok()) {
+		return s;
+	}
+	std::string rep;
+	s = ReadFileToString(env, fname, &rep);
+	if (!s.ok()) {
+		return s;
+	}
+	if (rep.size() < sizeof(uint32_t)) {
+		return Status::Corruption(fname, "file too short");
+	}
+	size_t body_size = rep.size() - sizeof(uint32_t);
+	uint32_t expected = crc32c::Unmask(DecodeFixed32(&rep[body_size]));
+	if (crc32c::Value(rep.data(), body_size) != expected) {
+		return Status::Corruption(fname, "checksum mismatch");
+	}
+
+	Slice input(rep.data(), body_size);
+	uint32_t version = 0;
+	uint64_t count = 0;
+	if (!GetVarint32(&input, &version) ||
+	    version != kTableMetaSnapshotVersion ||
+	    !GetVarint64(&input, &count)) {
+		return Status::Corruption(fname, "bad header");
+	}
+	for (uint64_t i = 0; i < count; i++) {
+		uint64_t number = 0;
+		Entry e = {};
+		bool ok = GetVarint64(&input, &number) &&
+			  GetVarint32(&input, &e.cf_id) &&
+			  GetVarint32(&input, &e.path_id) &&
+			  GetVarint64(&input, &e.file_size) &&
+			  !input.empty();
+		if (ok) {
+			e.has_stats = input[0] != 0;
+			input.remove_prefix(1);
+		}
+		if (ok && e.has_stats) {
+			ok = GetVarint64(&input, &e.num_entries) &&
+			     GetVarint64(&input, &e.num_deletions) &&
+			     GetVarint64(&input, &e.raw_key_size) &&
+			     GetVarint64(&input, &e.raw_value_size);
+		}
+		if (!ok) {
+			entries_.clear();
+			return Status::Corruption(fname, "truncated entry");
+		}
+		entries_[number] = e;
+	}
+	return Status::OK();
+}
+
+bool TableMetaSnapshot::Apply(uint32_t cf_id, FileMetaData *f) const
+{
+	auto it = entries_.find(f->fd.GetNumber());
+	if (it == entries_.end()) {
+		return false;
+	}
+	const Entry &e = it->second;
+	if (e.cf_id != cf_id || e.path_id != f->fd.GetPathId() ||
+	    e.file_size != f->fd.GetFileSize()) {
+		return false;
+	}
+	if (e.has_stats && !f->init_stats_from_file) {
+		f->num_entries = e.num_entries;
+		f->num_deletions = e.num_deletions;
+		f->raw_key_size = e.raw_key_size;
+		f->raw_value_size = e.raw_value_size;
+		f->init_stats_from_file = true;
+	}
+	return true;
+}
+
+} // namespace rocksdb
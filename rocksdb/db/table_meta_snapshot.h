@@ -0,0 +1,69 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+#include "rocksdb/env.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb
+{
+struct FileMetaData;
+
+// TableMetaSnapshot is the content of the TABLEMETA file that a DB writes
+// on clean shutdown and on MANIFEST roll-over when
+// DBOptions::persist_table_meta_snapshot is set.
+// It remembers, per live table file, the size and the table-property
+// derived stats that Version needs for compaction decisions, so that the
+// next DB::Open neither has to read table properties nor open every
+// table up front. Entries are only trusted for files whose number, path
+// and size still match what the MANIFEST recovered.
+//
+// Not thread-safe.
+class TableMetaSnapshot {
+    public:
+	// Remember f as a live file of column family cf_id.
+	void Add(uint32_t cf_id, const FileMetaData &f);
+
+	// Atomically replace dbname/TABLEMETA with the current content, going
+	// through the temp file dbname/<tmp_number>.dbtmp.
+	Status Write(Env *env, const std::string &dbname,
+		     uint64_t tmp_number) const;
+
+	// Load dbname/TABLEMETA. Returns NotFound if there is none and
+	// Corruption if it cannot be decoded.
+	Status Read(Env *env, const std::string &dbname);
+
+	// If the snapshot has an entry matching f, copy its stats into f and
+	// return true. f->init_stats_from_file is set only if the stats had
+	// been loaded when the snapshot was written.
+	bool Apply(uint32_t cf_id, FileMetaData *f) const;
+
+	size_t size() const
+	{
+		return entries_.size();
+	}
+
+    private:
+	struct Entry {
+		uint32_t cf_id;
+		uint32_t path_id;
+		uint64_t file_size;
+		bool has_stats;
+		uint64_t num_entries;
+		uint64_t num_deletions;
+		uint64_t raw_key_size;
+		uint64_t raw_value_size;
+	};
+
+	// File numbers are unique across column families
+	std::unordered_map<uint64_t, Entry> entries_;
+};
+
+} // namespace rocksdb
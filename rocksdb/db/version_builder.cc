@@ -286,14 +286,22 @@ class VersionBuilder::Rep {
 		for (const auto &del_file : del) {
 			const auto level = del_file.first;
 			const auto number = del_file.second;
-			levels_[level].deleted_files.insert(number);
 			CheckConsistencyForDeletes(edit, number, level);
 
 			auto exising = levels_[level].added_files.find(number);
 			if (exising != levels_[level].added_files.end()) {
 				UnrefFile(exising->second);
 				levels_[level].added_files.erase(number);
+				// A file that was both added and deleted through
+				// this builder cannot be in an empty base level.
+				// Not remembering it keeps deleted_files from
+				// growing with the number of edits replayed on
+				// recovery.
+				if (base_vstorage_->LevelFiles(level).empty()) {
+					continue;
+				}
 			}
+			levels_[level].deleted_files.insert(number);
 		}
 
 		// Add new files
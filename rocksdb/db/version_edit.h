@@ -9,6 +9,7 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <set>
 #include <utility>
 #include <vector>
@@ -72,6 +73,34 @@ struct FileDescriptor {
 	}
 };
 
+// Reads of a file by user requests, estimated from a sample of them. See
+// monitoring/file_read_sample.h.
+struct FileSampledStats {
+	FileSampledStats()
+		: num_reads_sampled(0), num_seeks_sampled(0),
+		  bytes_read_sampled(0)
+	{
+	}
+	FileSampledStats(const FileSampledStats &other)
+	{
+		*this = other;
+	}
+	FileSampledStats &operator=(const FileSampledStats &other)
+	{
+		num_reads_sampled = other.num_reads_sampled.load();
+		num_seeks_sampled = other.num_seeks_sampled.load();
+		bytes_read_sampled = other.bytes_read_sampled.load();
+		return *this;
+	}
+
+	// Point lookups that read the file
+	mutable std::atomic<uint64_t> num_reads_sampled;
+	// Times an iterator was positioned into the file
+	mutable std::atomic<uint64_t> num_seeks_sampled;
+	// Bytes read from the file by the point lookups
+	mutable std::atomic<uint64_t> bytes_read_sampled;
+};
+
 struct FileMetaData {
 	int refs;
 	FileDescriptor fd;
@@ -101,6 +130,12 @@ struct FileMetaData {
 
 	bool marked_for_compaction; // True if client asked us nicely to compact this
 		// file.
+	bool compact_in_last_level; // Marked through
+		// DBImpl::MarkTableFilesForCompaction(); in the last level with
+		// data, the file is compacted within that level. Not persisted.
+
+	// Sampled reads of this file while it is live; not persisted
+	FileSampledStats stats;
 
 	FileMetaData()
 		: refs(0), being_compacted(false),
@@ -108,7 +143,7 @@ struct FileMetaData {
 		  table_reader_handle(nullptr), compensated_file_size(0),
 		  num_entries(0), num_deletions(0), raw_key_size(0),
 		  raw_value_size(0), init_stats_from_file(false),
-		  marked_for_compaction(false)
+		  marked_for_compaction(false), compact_in_last_level(false)
 	{
 	}
 
@@ -129,17 +164,19 @@ struct FileMetaData {
 // smallest and largest key's slice
 struct FdWithKeyRange {
 	FileDescriptor fd;
+	FileMetaData *file_metadata; // Point to all metadata
 	Slice smallest_key; // slice that contain smallest key
 	Slice largest_key; // slice that contain largest key
 
-	FdWithKeyRange() : fd(), smallest_key(), largest_key()
+	FdWithKeyRange()
+		: fd(), file_metadata(nullptr), smallest_key(), largest_key()
 	{
 	}
 
 	FdWithKeyRange(FileDescriptor _fd, Slice _smallest_key,
-		       Slice _largest_key)
-		: fd(_fd), smallest_key(_smallest_key),
-		  largest_key(_largest_key)
+		       Slice _largest_key, FileMetaData *_file_metadata)
+		: fd(_fd), file_metadata(_file_metadata),
+		  smallest_key(_smallest_key), largest_key(_largest_key)
 	{
 	}
 };
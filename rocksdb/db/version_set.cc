@@ -31,7 +31,10 @@
 #include "db/merge_helper.h"
 #include "db/pinned_iterators_manager.h"
 #include "db/table_cache.h"
+#include "db/table_meta_snapshot.h"
 #include "db/version_builder.h"
+#include "monitoring/file_read_sample.h"
+#include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
 #include "rocksdb/env.h"
 #include "rocksdb/merge_operator.h"
@@ -423,6 +426,7 @@ void DoGenerateLevelFilesBrief(LevelFilesBrief *file_level,
 
 		FdWithKeyRange &f = file_level->files[i];
 		f.fd = files[i]->fd;
+		f.file_metadata = files[i];
 		f.smallest_key = Slice(mem, smallest_size);
 		f.largest_key = Slice(mem + smallest_size, largest_size);
 	}
@@ -486,16 +490,14 @@ namespace
 {
 // An internal iterator.  For a given version/level pair, yields
 // information about the files in the level.  For a given entry, key()
-// is the largest key that occurs in the file, and value() is an
-// 16-byte value containing the file number and file size, both
-// encoded using EncodeFixed64.
+// is the largest key that occurs in the file, and value() is the
+// FdWithKeyRange of the file.
 class LevelFileNumIterator : public InternalIterator {
     public:
 	LevelFileNumIterator(const InternalKeyComparator &icmp,
 			     const LevelFilesBrief *flevel)
 		: icmp_(icmp), flevel_(flevel),
-		  index_(static_cast<uint32_t>(flevel->num_files)),
-		  current_value_(0, 0, 0)
+		  index_(static_cast<uint32_t>(flevel->num_files))
 	{ // Marks as invalid
 	}
 	virtual bool Valid() const override
@@ -545,10 +547,9 @@ class LevelFileNumIterator : public InternalIterator {
 	{
 		assert(Valid());
 
-		auto file_meta = flevel_->files[index_];
-		current_value_ = file_meta.fd;
+		current_value_ = flevel_->files[index_];
 		return Slice(reinterpret_cast<const char *>(&current_value_),
-			     sizeof(FileDescriptor));
+			     sizeof(FdWithKeyRange));
 	}
 	virtual Status status() const override
 	{
@@ -559,7 +560,7 @@ class LevelFileNumIterator : public InternalIterator {
 	const InternalKeyComparator icmp_;
 	const LevelFilesBrief *flevel_;
 	uint32_t index_;
-	mutable FileDescriptor current_value_;
+	mutable FdWithKeyRange current_value_;
 };
 
 class LevelFileIteratorState : public TwoLevelIteratorState {
@@ -585,15 +586,19 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
 	InternalIterator *
 	NewSecondaryIterator(const Slice &meta_handle) override
 	{
-		if (meta_handle.size() != sizeof(FileDescriptor)) {
+		if (meta_handle.size() != sizeof(FdWithKeyRange)) {
 			return NewErrorInternalIterator(Status::Corruption(
 				"FileReader invoked with unexpected value"));
 		}
-		const FileDescriptor *fd =
-			reinterpret_cast<const FileDescriptor *>(
+		const FdWithKeyRange *file =
+			reinterpret_cast<const FdWithKeyRange *>(
 				meta_handle.data());
+		if (!for_compaction_ && file->file_metadata != nullptr &&
+		    should_sample_file_read()) {
+			sample_file_seek_inc(file->file_metadata);
+		}
 		return table_cache_->NewIterator(
-			read_options_, env_options_, icomparator_, *fd,
+			read_options_, env_options_, icomparator_, file->fd,
 			range_del_agg_,
 			nullptr /* don't need reference to table */,
 			file_read_hist_, for_compaction_, nullptr /* arena */,
@@ -858,6 +863,16 @@ void Version::GetColumnFamilyMetaData(ColumnFamilyMetaData *cf_meta)
 				file->smallest.user_key().ToString(),
 				file->largest.user_key().ToString(),
 				file->being_compacted);
+			SstFileMetaData &meta = files.back();
+			meta.num_reads_sampled =
+				file->stats.num_reads_sampled.load(
+					std::memory_order_relaxed);
+			meta.num_seeks_sampled =
+				file->stats.num_seeks_sampled.load(
+					std::memory_order_relaxed);
+			meta.bytes_read_sampled =
+				file->stats.bytes_read_sampled.load(
+					std::memory_order_relaxed);
 			level_size += file->fd.GetFileSize();
 		}
 		cf_meta->levels.emplace_back(level, level_size,
@@ -949,6 +964,9 @@ void Version::AddIteratorsForLevel(const ReadOptions &read_options,
 		     i < storage_info_.LevelFilesBrief(0).num_files; i++) {
 			const auto &file =
 				storage_info_.LevelFilesBrief(0).files[i];
+			if (should_sample_file_read()) {
+				sample_file_seek_inc(file.file_metadata);
+			}
 			merge_iter_builder->AddIterator(
 				cfd_->table_cache()->NewIterator(
 					read_options, soptions,
@@ -1102,6 +1120,9 @@ void Version::Get(const ReadOptions &read_options, const LookupKey &k,
 		      internal_comparator());
 	FdWithKeyRange *f = fp.GetNextFile();
 	while (f != nullptr) {
+		const bool sample_file_read = should_sample_file_read();
+		const uint64_t bytes_read_before =
+			sample_file_read ? IOSTATS(bytes_read) : 0;
 		*status = table_cache_->Get(
 			read_options, *internal_comparator(), f->fd, ikey,
 			&get_context,
@@ -1110,6 +1131,11 @@ void Version::Get(const ReadOptions &read_options, const LookupKey &k,
 			IsFilterSkipped(static_cast<int>(fp.GetHitFileLevel()),
 					fp.IsHitFileLastInLevel()),
 			fp.GetCurrentLevel());
+		if (sample_file_read) {
+			sample_file_read_inc(f->file_metadata,
+					     IOSTATS(bytes_read) -
+						     bytes_read_before);
+		}
 		// TODO: examine the behavior for corrupted key
 		if (!status->ok()) {
 			return;
@@ -1565,7 +1591,8 @@ void VersionStorageInfo::ComputeFilesMarkedForCompaction()
 
 	// Do not include files from the last level with data
 	// If table properties collector suggests a file on the last level,
-	// we should not move it to a new level.
+	// we should not move it to a new level. Files marked with
+	// compact_in_last_level are compacted within that level instead.
 	for (int level = num_levels() - 1; level >= 1; level--) {
 		if (!files_[level].empty()) {
 			last_qualify_level = level - 1;
@@ -1573,9 +1600,11 @@ void VersionStorageInfo::ComputeFilesMarkedForCompaction()
 		}
 	}
 
-	for (int level = 0; level <= last_qualify_level; level++) {
+	for (int level = 0; level < num_levels(); level++) {
 		for (auto *f : files_[level]) {
-			if (!f->being_compacted && f->marked_for_compaction) {
+			if (!f->being_compacted && f->marked_for_compaction &&
+			    (level <= last_qualify_level ||
+			     f->compact_in_last_level)) {
 				files_marked_for_compaction_.emplace_back(level,
 									  f);
 			}
@@ -2499,15 +2528,17 @@ VersionSet::VersionSet(const std::string &dbname,
 		       const ImmutableDBOptions *db_options,
 		       const EnvOptions &storage_options, Cache *table_cache,
 		       WriteBufferManager *write_buffer_manager,
-		       WriteController *write_controller)
+		       WriteController *write_controller,
+		       BlockCacheTracer *block_cache_tracer)
 	: column_family_set_(new ColumnFamilySet(
 		  dbname, db_options, storage_options, table_cache,
-		  write_buffer_manager, write_controller)),
+		  write_buffer_manager, write_controller, block_cache_tracer)),
 	  env_(db_options->env), dbname_(dbname), db_options_(db_options),
 	  next_file_number_(2), manifest_file_number_(0), // Filled by Recover()
 	  pending_manifest_file_number_(0), last_sequence_(0),
 	  prev_log_number_(0), current_version_number_(0),
-	  manifest_file_size_(0), env_options_(storage_options),
+	  manifest_file_size_(0), manifest_snapshot_size_(0),
+	  env_options_(storage_options),
 	  env_options_compactions_(env_->OptimizeForCompactionTableRead(
 		  env_options_, *db_options_))
 {
@@ -2650,11 +2681,13 @@ Status VersionSet::LogAndApply(ColumnFamilyData *column_family_data,
 	// Initialize new descriptor log file if necessary by creating
 	// a temporary file that contains a snapshot of the current version.
 	uint64_t new_manifest_file_size = 0;
+	uint64_t new_manifest_snapshot_size = manifest_snapshot_size_;
 	Status s;
 
 	assert(pending_manifest_file_number_ == 0);
 	if (!descriptor_log_ ||
-	    manifest_file_size_ > db_options_->max_manifest_file_size) {
+	    manifest_file_size_ > db_options_->max_manifest_file_size ||
+	    ManifestSpaceAmpExceeded()) {
 		pending_manifest_file_number_ = NewFileNumber();
 		batch_edits.back()->SetNextFile(next_file_number_.load());
 		new_descriptor_log = true;
@@ -2717,6 +2750,8 @@ Status VersionSet::LogAndApply(ColumnFamilyData *column_family_data,
 				descriptor_log_.reset(new log::Writer(
 					std::move(file_writer), 0, false));
 				s = WriteSnapshot(descriptor_log_.get());
+				new_manifest_snapshot_size =
+					descriptor_log_->file()->GetFileSize();
 			}
 		}
 
@@ -2823,6 +2858,7 @@ Status VersionSet::LogAndApply(ColumnFamilyData *column_family_data,
 
 		manifest_file_number_ = pending_manifest_file_number_;
 		manifest_file_size_ = new_manifest_file_size;
+		manifest_snapshot_size_ = new_manifest_snapshot_size;
 		prev_log_number_ = w.edit_list.front()->prev_log_number_;
 	} else {
 		std::string version_edits;
@@ -2904,6 +2940,26 @@ void VersionSet::LogAndApplyHelper(ColumnFamilyData *cfd,
 	builder->Apply(edit);
 }
 
+bool VersionSet::ApplyTableMetaSnapshot(const TableMetaSnapshot &table_meta,
+					ColumnFamilyData *cfd,
+					VersionStorageInfo *vstorage)
+{
+	bool all_found = true;
+	for (int level = 0; level < vstorage->num_levels(); level++) {
+		for (auto *f : vstorage->LevelFiles(level)) {
+			bool had_stats = f->init_stats_from_file;
+			if (!table_meta.Apply(cfd->GetID(), f)) {
+				all_found = false;
+				continue;
+			}
+			if (!had_stats && f->init_stats_from_file) {
+				vstorage->UpdateAccumulatedStats(f);
+			}
+		}
+	}
+	return all_found;
+}
+
 Status
 VersionSet::Recover(const std::vector<ColumnFamilyDescriptor> &column_families,
 		    bool read_only)
@@ -2996,8 +3052,11 @@ VersionSet::Recover(const std::vector<ColumnFamilyDescriptor> &column_families,
 				   0 /*initial_offset*/, 0);
 		Slice record;
 		std::string scratch;
+		// Reused across records so that replaying a long manifest does
+		// not reallocate the edit's containers for every record;
+		// DecodeFrom() clears it.
+		VersionEdit edit;
 		while (reader.ReadRecord(&record, &scratch) && s.ok()) {
-			VersionEdit edit;
 			s = edit.DecodeFrom(record);
 			if (!s.ok()) {
 				break;
@@ -3178,6 +3237,17 @@ VersionSet::Recover(const std::vector<ColumnFamilyDescriptor> &column_families,
 	}
 
 	if (s.ok()) {
+		TableMetaSnapshot table_meta;
+		if (db_options_->persist_table_meta_snapshot) {
+			Status snapshot_status = table_meta.Read(env_, dbname_);
+			if (!snapshot_status.ok() &&
+			    !snapshot_status.IsNotFound()) {
+				ROCKS_LOG_WARN(db_options_->info_log,
+					       "Ignoring table meta snapshot: %s",
+					       snapshot_status.ToString().c_str());
+			}
+		}
+
 		for (auto cfd : *column_family_set_) {
 			if (cfd->IsDropped()) {
 				continue;
@@ -3188,10 +3258,19 @@ VersionSet::Recover(const std::vector<ColumnFamilyDescriptor> &column_families,
 			auto *builder =
 				builders_iter->second->version_builder();
 
-			if (GetColumnFamilySet()
-				    ->get_table_cache()
-				    ->GetCapacity() ==
-			    TableCache::kInfiniteCapacity) {
+			Version *v = new Version(cfd, this,
+						 current_version_number_++);
+			builder->SaveTo(v->storage_info());
+
+			bool all_files_in_snapshot =
+				table_meta.size() > 0 &&
+				ApplyTableMetaSnapshot(table_meta, cfd,
+						       v->storage_info());
+			if (!all_files_in_snapshot &&
+			    GetColumnFamilySet()
+					    ->get_table_cache()
+					    ->GetCapacity() ==
+				    TableCache::kInfiniteCapacity) {
 				// unlimited table cache. Pre-load table handle now.
 				// Need to do it out of the mutex.
 				builder->LoadTableHandlers(
@@ -3200,10 +3279,6 @@ VersionSet::Recover(const std::vector<ColumnFamilyDescriptor> &column_families,
 					false /* prefetch_index_and_filter_in_cache */);
 			}
 
-			Version *v = new Version(cfd, this,
-						 current_version_number_++);
-			builder->SaveTo(v->storage_info());
-
 			// Install recovered version
 			v->PrepareApply(
 				*cfd->GetLatestMutableCFOptions(),
@@ -3643,6 +3718,20 @@ void VersionSet::MarkFileNumberUsedDuringRecovery(uint64_t number)
 	}
 }
 
+bool VersionSet::ManifestSpaceAmpExceeded() const
+{
+	uint64_t amp_pct = db_options_->max_manifest_space_amp_pct;
+	if (amp_pct == 0 || manifest_snapshot_size_ == 0 ||
+	    manifest_file_size_ <
+		    db_options_->min_manifest_file_size_for_space_amp) {
+		return false;
+	}
+	// manifest_file_size_ / manifest_snapshot_size_ > (100 + amp_pct) / 100
+	return manifest_file_size_ - manifest_snapshot_size_ >
+	       manifest_snapshot_size_ / 100 * amp_pct +
+		       manifest_snapshot_size_ % 100 * amp_pct / 100;
+}
+
 Status VersionSet::WriteSnapshot(log::Writer *log)
 {
 	// TODO: Break up into multiple records to reduce memory usage on recovery?
@@ -4069,6 +4158,15 @@ void VersionSet::GetLiveFilesMetaData(std::vector<LiveFileMetaData> *metadata)
 					file->smallest_seqno;
 				filemetadata.largest_seqno =
 					file->largest_seqno;
+				filemetadata.num_reads_sampled =
+					file->stats.num_reads_sampled.load(
+						std::memory_order_relaxed);
+				filemetadata.num_seeks_sampled =
+					file->stats.num_seeks_sampled.load(
+						std::memory_order_relaxed);
+				filemetadata.bytes_read_sampled =
+					file->stats.bytes_read_sampled.load(
+						std::memory_order_relaxed);
 				metadata->push_back(filemetadata);
 			}
 		}
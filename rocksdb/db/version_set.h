@@ -62,6 +62,8 @@ class WriteBufferManager;
 class MergeContext;
 class ColumnFamilySet;
 class TableCache;
+class BlockCacheTracer;
+class TableMetaSnapshot;
 class MergeIteratorBuilder;
 
 // Return the smallest index i such that file_level.files[i]->largest >= key.
@@ -694,7 +696,8 @@ class VersionSet {
 		   const ImmutableDBOptions *db_options,
 		   const EnvOptions &env_options, Cache *table_cache,
 		   WriteBufferManager *write_buffer_manager,
-		   WriteController *write_controller);
+		   WriteController *write_controller,
+		   BlockCacheTracer *block_cache_tracer = nullptr);
 	~VersionSet();
 
 	// Apply *edit to the current version to form a new descriptor that
@@ -894,6 +897,12 @@ class VersionSet {
 		}
 	};
 
+	// Seed the stats of the recovered files of cfd from table_meta. Returns
+	// true if every file of vstorage has an up-to-date snapshot entry.
+	bool ApplyTableMetaSnapshot(const TableMetaSnapshot &table_meta,
+				    ColumnFamilyData *cfd,
+				    VersionStorageInfo *vstorage);
+
 	// ApproximateSize helper
 	uint64_t ApproximateSizeLevel0(Version *v,
 				       const LevelFilesBrief &files_brief,
@@ -905,6 +914,11 @@ class VersionSet {
 	// Save current contents to *log
 	Status WriteSnapshot(log::Writer *log);
 
+	// Return true if the current manifest has outgrown its initial snapshot
+	// by more than max_manifest_space_amp_pct, is past
+	// min_manifest_file_size_for_space_amp, and should be rolled over.
+	bool ManifestSpaceAmpExceeded() const;
+
 	void AppendVersion(ColumnFamilyData *column_family_data, Version *v);
 
 	ColumnFamilyData *
@@ -934,6 +948,8 @@ class VersionSet {
 
 	// Current size of manifest file
 	uint64_t manifest_file_size_;
+	// Size of the full-state snapshot at the start of the manifest file
+	uint64_t manifest_snapshot_size_;
 
 	std::vector<FileMetaData *> obsolete_files_;
 	std::vector<std::string> obsolete_manifests_;
@@ -28,6 +28,7 @@
 #include "rocksdb/write_batch.h"
 #include "util/coding.h"
 #include "util/file_reader_writer.h"
+#include "util/file_util.h"
 #include "util/filename.h"
 #include "util/logging.h"
 #include "util/mutexlock.h"
@@ -191,7 +192,7 @@ void WalManager::PurgeObsoleteWALFiles()
 				}
 				if (now_seconds - file_m_time >
 				    db_options_.wal_ttl_seconds) {
-					s = env_->DeleteFile(file_path);
+					s = DeleteArchivedLogFile(file_path);
 					if (!s.ok()) {
 						ROCKS_LOG_WARN(
 							db_options_.info_log,
@@ -226,7 +227,8 @@ void WalManager::PurgeObsoleteWALFiles()
 								 file_size);
 						++log_files_num;
 					} else {
-						s = env_->DeleteFile(file_path);
+						s = DeleteArchivedLogFile(
+							file_path);
 						if (!s.ok()) {
 							ROCKS_LOG_WARN(
 								db_options_
@@ -271,7 +273,8 @@ void WalManager::PurgeObsoleteWALFiles()
 
 	for (size_t i = 0; i < files_del_num; ++i) {
 		std::string const file_path = archived_logs[i]->PathName();
-		s = env_->DeleteFile(db_options_.wal_dir + "/" + file_path);
+		s = DeleteArchivedLogFile(db_options_.wal_dir + "/" +
+					  file_path);
 		if (!s.ok()) {
 			ROCKS_LOG_WARN(db_options_.info_log,
 				       "Unable to delete file: %s: %s",
@@ -312,6 +315,12 @@ struct CompareLogByPointer {
 };
 } // namespace
 
+Status WalManager::DeleteArchivedLogFile(const std::string &fname)
+{
+	return DeleteDBFile(&db_options_, fname,
+			    IsFirstDBPath(&db_options_, db_options_.wal_dir));
+}
+
 Status WalManager::GetSortedWalsOfType(const std::string &path,
 				       VectorLogPtr &log_files,
 				       WalFileType log_type)
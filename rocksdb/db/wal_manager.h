@@ -64,6 +64,10 @@ class WalManager {
 	}
 
     private:
+	// Delete an archived WAL file, going through the SstFileManager if
+	// there is one and wal_dir is the DB directory
+	Status DeleteArchivedLogFile(const std::string &fname);
+
 	Status GetSortedWalsOfType(const std::string &path,
 				   VectorLogPtr &log_files, WalFileType type);
 	// Requires: all_logs should be sorted with earliest log file first
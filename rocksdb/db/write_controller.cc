@@ -12,21 +12,26 @@
 
 namespace rocksdb
 {
-std::unique_ptr<WriteControllerToken> WriteController::GetStopToken()
+std::unique_ptr<WriteControllerToken>
+WriteController::GetStopToken(WriteStallCause cause)
 {
 	++total_stopped_;
-	return std::unique_ptr<WriteControllerToken>(new StopWriteToken(this));
+	++stopped_by_cause_[static_cast<int>(cause)];
+	return std::unique_ptr<WriteControllerToken>(
+		new StopWriteToken(this, cause));
 }
 
 std::unique_ptr<WriteControllerToken>
-WriteController::GetDelayToken(uint64_t write_rate)
+WriteController::GetDelayToken(uint64_t write_rate, WriteStallCause cause)
 {
 	total_delayed_++;
+	delayed_by_cause_[static_cast<int>(cause)]++;
 	// Reset counters.
 	last_refill_time_ = 0;
 	bytes_left_ = 0;
 	set_delayed_write_rate(write_rate);
-	return std::unique_ptr<WriteControllerToken>(new DelayWriteToken(this));
+	return std::unique_ptr<WriteControllerToken>(
+		new DelayWriteToken(this, cause));
 }
 
 std::unique_ptr<WriteControllerToken>
@@ -41,6 +46,43 @@ bool WriteController::IsStopped() const
 {
 	return total_stopped_.load(std::memory_order_relaxed) > 0;
 }
+
+WriteStallCause WriteController::StallCause() const
+{
+	const std::atomic<int> *by_cause = nullptr;
+	if (IsStopped()) {
+		by_cause = stopped_by_cause_;
+	} else if (NeedsDelay()) {
+		by_cause = delayed_by_cause_;
+	} else {
+		return WriteStallCause::kNone;
+	}
+	for (int i = static_cast<int>(WriteStallCause::kNone) + 1;
+	     i < static_cast<int>(WriteStallCause::kNumCauses); i++) {
+		if (by_cause[i].load(std::memory_order_relaxed) > 0) {
+			return static_cast<WriteStallCause>(i);
+		}
+	}
+	return WriteStallCause::kNone;
+}
+void WriteController::AddStallMicros(WriteStallCondition condition,
+				     WriteStallCause cause, uint64_t micros)
+{
+	assert(condition != WriteStallCondition::kNormal);
+	auto &v = stall_micros_[static_cast<int>(cause)]
+			       [condition == WriteStallCondition::kStopped];
+	v.fetch_add(micros, std::memory_order_relaxed);
+}
+
+uint64_t WriteController::GetStallMicros(WriteStallCondition condition,
+					 WriteStallCause cause) const
+{
+	assert(condition != WriteStallCondition::kNormal);
+	return stall_micros_[static_cast<int>(cause)]
+			    [condition == WriteStallCondition::kStopped]
+				    .load(std::memory_order_relaxed);
+}
+
 // This is inside DB mutex, so we can't sleep and need to minimize
 // frequency to get time.
 // If it turns out to be a performance issue, we can redesign the thread
@@ -121,11 +163,13 @@ StopWriteToken::~StopWriteToken()
 {
 	assert(controller_->total_stopped_ >= 1);
 	--controller_->total_stopped_;
+	--controller_->stopped_by_cause_[static_cast<int>(cause_)];
 }
 
 DelayWriteToken::~DelayWriteToken()
 {
 	controller_->total_delayed_--;
+	controller_->delayed_by_cause_[static_cast<int>(cause_)]--;
 	assert(controller_->total_delayed_.load() >= 0);
 }
 
@@ -10,6 +10,7 @@
 #include <atomic>
 #include <memory>
 #include "rocksdb/rate_limiter.h"
+#include "rocksdb/types.h"
 
 namespace rocksdb
 {
@@ -27,7 +28,8 @@ class WriteController {
 				 int64_t low_pri_rate_bytes_per_sec = 1024 *
 								      1024)
 		: total_stopped_(0), total_delayed_(0),
-		  total_compaction_pressure_(0), bytes_left_(0),
+		  total_compaction_pressure_(0), stopped_by_cause_{},
+		  delayed_by_cause_{}, stall_micros_{}, bytes_left_(0),
 		  last_refill_time_(0),
 		  low_pri_rate_limiter_(
 			  NewGenericRateLimiter(low_pri_rate_bytes_per_sec))
@@ -38,13 +40,15 @@ class WriteController {
 
 	// When an actor (column family) requests a stop token, all writes will be
 	// stopped until the stop token is released (deleted)
-	std::unique_ptr<WriteControllerToken> GetStopToken();
+	std::unique_ptr<WriteControllerToken>
+	GetStopToken(WriteStallCause cause = WriteStallCause::kNone);
 	// When an actor (column family) requests a delay token, total delay for all
 	// writes to the DB will be controlled under the delayed write rate. Every
 	// write needs to call GetDelay() with number of bytes writing to the DB,
 	// which returns number of microseconds to sleep.
 	std::unique_ptr<WriteControllerToken>
-	GetDelayToken(uint64_t delayed_write_rate);
+	GetDelayToken(uint64_t delayed_write_rate,
+		      WriteStallCause cause = WriteStallCause::kNone);
 	// When an actor (column family) requests a moderate token, compaction
 	// threads will be increased
 	std::unique_ptr<WriteControllerToken> GetCompactionPressureToken();
@@ -60,6 +64,30 @@ class WriteController {
 		return IsStopped() || NeedsDelay() ||
 		       total_compaction_pressure_ > 0;
 	}
+	// What the writes are stopped for if they are, or else delayed for.
+	// With several causes, the first one in WriteStallCause is returned.
+	WriteStallCause StallCause() const;
+	int NumStopTokens(WriteStallCause cause) const
+	{
+		return stopped_by_cause_[static_cast<int>(cause)].load(
+			std::memory_order_relaxed);
+	}
+	int NumDelayTokens(WriteStallCause cause) const
+	{
+		return delayed_by_cause_[static_cast<int>(cause)].load(
+			std::memory_order_relaxed);
+	}
+	int NumCompactionPressureTokens() const
+	{
+		return total_compaction_pressure_.load(
+			std::memory_order_relaxed);
+	}
+	// Adds the time writes waited while they were delayed or stopped
+	// for a cause. Can be called without holding DB mutex.
+	void AddStallMicros(WriteStallCondition condition,
+			    WriteStallCause cause, uint64_t micros);
+	uint64_t GetStallMicros(WriteStallCondition condition,
+				WriteStallCause cause) const;
 	// return how many microseconds the caller needs to sleep after the call
 	// num_bytes: how many number of bytes to put into the DB.
 	// Prerequisite: DB mutex held.
@@ -112,6 +140,13 @@ class WriteController {
 	std::atomic<int> total_stopped_;
 	std::atomic<int> total_delayed_;
 	std::atomic<int> total_compaction_pressure_;
+	std::atomic<int> stopped_by_cause_[static_cast<int>(
+		WriteStallCause::kNumCauses)];
+	std::atomic<int> delayed_by_cause_[static_cast<int>(
+		WriteStallCause::kNumCauses)];
+	// Indexed by cause, then by delayed (0) or stopped (1)
+	std::atomic<uint64_t> stall_micros_[static_cast<int>(
+		WriteStallCause::kNumCauses)][2];
 	uint64_t bytes_left_;
 	uint64_t last_refill_time_;
 	// write rate set when initialization or by `DBImpl::SetDBOptions`
@@ -143,20 +178,26 @@ class WriteControllerToken {
 
 class StopWriteToken : public WriteControllerToken {
     public:
-	explicit StopWriteToken(WriteController *controller)
-		: WriteControllerToken(controller)
+	StopWriteToken(WriteController *controller, WriteStallCause cause)
+		: WriteControllerToken(controller), cause_(cause)
 	{
 	}
 	virtual ~StopWriteToken();
+
+    private:
+	WriteStallCause cause_;
 };
 
 class DelayWriteToken : public WriteControllerToken {
     public:
-	explicit DelayWriteToken(WriteController *controller)
-		: WriteControllerToken(controller)
+	DelayWriteToken(WriteController *controller, WriteStallCause cause)
+		: WriteControllerToken(controller), cause_(cause)
 	{
 	}
 	virtual ~DelayWriteToken();
+
+    private:
+	WriteStallCause cause_;
 };
 
 class CompactionPressureToken : public WriteControllerToken {
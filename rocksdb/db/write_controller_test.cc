@@ -52,6 +52,51 @@ TEST_F(WriteControllerTest, ChangeDelayRateTest)
 		  controller.GetDelay(&env, 20000000u));
 }
 
+TEST_F(WriteControllerTest, StallCause)
+{
+	WriteController controller(10000000u);
+	ASSERT_EQ(WriteStallCause::kNone, controller.StallCause());
+	auto delay_token = controller.GetDelayToken(
+		10000000u, WriteStallCause::kPendingCompactionBytes);
+	ASSERT_EQ(WriteStallCause::kPendingCompactionBytes,
+		  controller.StallCause());
+	ASSERT_EQ(1, controller.NumDelayTokens(
+			     WriteStallCause::kPendingCompactionBytes));
+	// Stops take precedence over delays
+	auto stop_token_1 =
+		controller.GetStopToken(WriteStallCause::kL0FileCountLimit);
+	auto stop_token_2 =
+		controller.GetStopToken(WriteStallCause::kMemtableLimit);
+	ASSERT_EQ(WriteStallCause::kMemtableLimit, controller.StallCause());
+	stop_token_2.reset();
+	ASSERT_EQ(WriteStallCause::kL0FileCountLimit,
+		  controller.StallCause());
+	ASSERT_EQ(0, controller.NumStopTokens(WriteStallCause::kMemtableLimit));
+	stop_token_1.reset();
+	ASSERT_EQ(WriteStallCause::kPendingCompactionBytes,
+		  controller.StallCause());
+	delay_token.reset();
+	ASSERT_EQ(WriteStallCause::kNone, controller.StallCause());
+	ASSERT_EQ(0, controller.NumDelayTokens(
+			     WriteStallCause::kPendingCompactionBytes));
+
+	controller.AddStallMicros(WriteStallCondition::kDelayed,
+				  WriteStallCause::kMemtableLimit, 100);
+	controller.AddStallMicros(WriteStallCondition::kStopped,
+				  WriteStallCause::kMemtableLimit, 20);
+	controller.AddStallMicros(WriteStallCondition::kDelayed,
+				  WriteStallCause::kMemtableLimit, 5);
+	ASSERT_EQ(105, controller.GetStallMicros(
+			       WriteStallCondition::kDelayed,
+			       WriteStallCause::kMemtableLimit));
+	ASSERT_EQ(20, controller.GetStallMicros(
+			      WriteStallCondition::kStopped,
+			      WriteStallCause::kMemtableLimit));
+	ASSERT_EQ(0, controller.GetStallMicros(
+			     WriteStallCondition::kDelayed,
+			     WriteStallCause::kL0FileCountLimit));
+}
+
 TEST_F(WriteControllerTest, SanityTest)
 {
 	WriteController controller(10000000u);
@@ -7,6 +7,7 @@
 #include <chrono>
 #include <thread>
 #include "db/column_family.h"
+#include "monitoring/thread_status_util.h"
 #include "port/port.h"
 #include "util/random.h"
 #include "util/sync_point.h"
@@ -73,6 +74,10 @@ uint8_t WriteThread::AwaitState(Writer *w, uint8_t goal_mask,
 		port::AsmVolatilePause();
 	}
 
+	// Waits past the spin are long enough to report
+	AutoThreadStateUpdater state_updater(
+		ThreadStatus::STATE_WRITE_GROUP_WAIT);
+
 	// If we're only going to end up waiting a short period of time,
 	// it can be a lot more efficient to call std::this_thread::yield()
 	// in a loop than to block in StateMutex().  For reference, on my 4.0
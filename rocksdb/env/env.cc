@@ -364,6 +364,8 @@ void AssignEnvOptions(EnvOptions *env_options, const DBOptions &options)
 	env_options->rate_limiter = options.rate_limiter.get();
 	env_options->writable_file_max_buffer_size =
 		options.writable_file_max_buffer_size;
+	env_options->writable_file_direct_io_buffers =
+		options.writable_file_direct_io_buffers;
 	env_options->allow_fallocate = options.allow_fallocate;
 }
 
@@ -374,6 +376,8 @@ EnvOptions Env::OptimizeForLogWrite(const EnvOptions &env_options,
 {
 	EnvOptions optimized_env_options(env_options);
 	optimized_env_options.bytes_per_sync = db_options.wal_bytes_per_sync;
+	optimized_env_options.use_direct_writes =
+		db_options.use_direct_io_for_wal;
 	return optimized_env_options;
 }
 
@@ -711,6 +711,11 @@ class PosixEnv : public Env {
 			      Priority pri = LOW, void *tag = nullptr,
 			      void (*unschedFunction)(void *arg) = 0) override;
 
+	virtual void ScheduleJob(void (*function)(void *arg1), void *arg,
+				 Priority pri, JobPriority job_pri,
+				 void *tag = nullptr,
+				 void (*unschedFunction)(void *arg) = 0) override;
+
 	virtual int UnSchedule(void *arg, Priority pri) override;
 
 	virtual void StartThread(void (*function)(void *arg),
@@ -721,6 +726,11 @@ class PosixEnv : public Env {
 	virtual unsigned int
 	GetThreadPoolQueueLen(Priority pri = LOW) const override;
 
+	virtual bool
+	GetThreadPoolQueueWaitStats(Priority pri, JobPriority job_pri,
+				    uint64_t *num_jobs,
+				    uint64_t *wait_micros) const override;
+
 	virtual Status GetTestDirectory(std::string *result) override
 	{
 		const char *env = getenv("TEST_TMPDIR");
@@ -894,6 +904,17 @@ class PosixEnv : public Env {
 #endif
 	}
 
+	virtual void BindThreadPoolToNumaNodes(Priority pool = LOW) override
+	{
+		assert(pool >= Priority::LOW && pool <= Priority::HIGH);
+		thread_pools_[pool].BindToNumaNodes();
+	}
+
+	virtual void SetThreadPoolBorrowing(bool allow) override
+	{
+		thread_pools_[Priority::LOW].SetAllowBorrowing(allow);
+	}
+
 	virtual std::string TimeToString(uint64_t secondsSince1970) override
 	{
 		const time_t seconds = (time_t)secondsSince1970;
@@ -916,7 +937,7 @@ class PosixEnv : public Env {
 	{
 		EnvOptions optimized = env_options;
 		optimized.use_mmap_writes = false;
-		optimized.use_direct_writes = false;
+		optimized.use_direct_writes = db_options.use_direct_io_for_wal;
 		optimized.bytes_per_sync = db_options.wal_bytes_per_sync;
 		// TODO(icanadi) it's faster if fallocate_with_keep_size is false, but it
 		// breaks TransactionLogIteratorStallAtLastRecord unit test. Fix the unit
@@ -990,6 +1011,10 @@ PosixEnv::PosixEnv()
 		// This allows later initializing the thread-local-env of each thread.
 		thread_pools_[pool_id].SetHostEnv(this);
 	}
+	// Idle compaction threads may pick up flushes once borrowing is
+	// turned on through SetThreadPoolBorrowing().
+	thread_pools_[Priority::LOW].SetBorrowSource(
+		&thread_pools_[Priority::HIGH]);
 	thread_status_updater_ = CreateThreadStatusUpdater();
 }
 
@@ -1000,6 +1025,15 @@ void PosixEnv::Schedule(void (*function)(void *arg1), void *arg, Priority pri,
 	thread_pools_[pri].Schedule(function, arg, tag, unschedFunction);
 }
 
+void PosixEnv::ScheduleJob(void (*function)(void *arg1), void *arg,
+			   Priority pri, JobPriority job_pri, void *tag,
+			   void (*unschedFunction)(void *arg))
+{
+	assert(pri >= Priority::LOW && pri <= Priority::HIGH);
+	thread_pools_[pri].Schedule(function, arg, tag, unschedFunction,
+				    job_pri);
+}
+
 int PosixEnv::UnSchedule(void *arg, Priority pri)
 {
 	return thread_pools_[pri].UnSchedule(arg);
@@ -1011,6 +1045,15 @@ unsigned int PosixEnv::GetThreadPoolQueueLen(Priority pri) const
 	return thread_pools_[pri].GetQueueLen();
 }
 
+bool PosixEnv::GetThreadPoolQueueWaitStats(Priority pri, JobPriority job_pri,
+					   uint64_t *num_jobs,
+					   uint64_t *wait_micros) const
+{
+	assert(pri >= Priority::LOW && pri <= Priority::HIGH);
+	thread_pools_[pri].GetQueueWaitStats(job_pri, num_jobs, wait_micros);
+	return true;
+}
+
 struct StartThreadState {
 	void (*user_function)(void *);
 	void *arg;
@@ -593,6 +593,117 @@ TEST_P(EnvPosixTestWithParam, DecreaseNumBgThreads)
 	WaitThreadPoolsEmpty();
 }
 
+TEST_P(EnvPosixTestWithParam, JobPriorityOrder)
+{
+	struct CB {
+		port::Mutex *mu;
+		std::vector<Env::JobPriority> *order;
+		Env::JobPriority job_pri;
+
+		static void Run(void *v)
+		{
+			CB *cb = reinterpret_cast<CB *>(v);
+			MutexLock l(cb->mu);
+			cb->order->push_back(cb->job_pri);
+		}
+	};
+
+	port::Mutex mu;
+	std::vector<Env::JobPriority> order;
+	std::vector<CB> cbs;
+	for (int i = Env::JOB_TOTAL - 1; i >= 0; i--) {
+		cbs.push_back(CB{ &mu, &order,
+				  static_cast<Env::JobPriority>(i) });
+	}
+
+	uint64_t flushes_before = 0;
+	uint64_t wait_before = 0;
+	ASSERT_TRUE(env_->GetThreadPoolQueueWaitStats(Env::Priority::LOW,
+						      Env::JOB_FLUSH,
+						      &flushes_before,
+						      &wait_before));
+
+	/* Block the low priority queue */
+	env_->SetBackgroundThreads(1, Env::LOW);
+	test::SleepingBackgroundTask sleeping_task;
+	env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask,
+		       &sleeping_task, Env::Priority::LOW);
+	sleeping_task.WaitUntilSleeping();
+
+	// Least urgent first so that FIFO order would be the reverse one
+	for (auto &cb : cbs) {
+		env_->ScheduleJob(&CB::Run, &cb, Env::Priority::LOW,
+				  cb.job_pri);
+	}
+	ASSERT_EQ(static_cast<unsigned int>(Env::JOB_TOTAL),
+		  env_->GetThreadPoolQueueLen(Env::Priority::LOW));
+
+	sleeping_task.WakeUp();
+	sleeping_task.WaitUntilDone();
+	WaitThreadPoolsEmpty();
+	while (true) {
+		MutexLock l(&mu);
+		if (order.size() == cbs.size()) {
+			break;
+		}
+		Env::Default()->SleepForMicroseconds(1000);
+	}
+
+	for (int i = 0; i < Env::JOB_TOTAL; i++) {
+		ASSERT_EQ(static_cast<Env::JobPriority>(i), order[i]);
+	}
+
+	uint64_t flushes_after = 0;
+	uint64_t wait_after = 0;
+	ASSERT_TRUE(env_->GetThreadPoolQueueWaitStats(Env::Priority::LOW,
+						      Env::JOB_FLUSH,
+						      &flushes_after,
+						      &wait_after));
+	ASSERT_EQ(flushes_before + 1, flushes_after);
+	ASSERT_GE(wait_after, wait_before);
+}
+
+TEST_P(EnvPosixTestWithParam, BorrowFlushJobs)
+{
+	std::atomic<bool> flushed(false);
+	std::atomic<bool> deleted(false);
+	env_->SetBackgroundThreads(1, Env::Priority::LOW);
+	env_->SetBackgroundThreads(1, Env::Priority::HIGH);
+
+	/* Block the high priority queue */
+	test::SleepingBackgroundTask sleeping_task;
+	env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask,
+		       &sleeping_task, Env::Priority::HIGH);
+	sleeping_task.WaitUntilSleeping();
+
+	// Without borrowing the flush waits for the busy HIGH thread
+	env_->ScheduleJob(&SetBool, &flushed, Env::Priority::HIGH,
+			  Env::JOB_FLUSH);
+	Env::Default()->SleepForMicroseconds(kDelayMicros);
+	ASSERT_FALSE(flushed.load());
+
+	// The idle LOW thread takes over the flush, but not other job classes
+	env_->SetThreadPoolBorrowing(true);
+	env_->ScheduleJob(&SetBool, &deleted, Env::Priority::HIGH,
+			  Env::JOB_DELETION);
+	for (int i = 0; i < kDelayMicros && !flushed.load(); i++) {
+		Env::Default()->SleepForMicroseconds(1);
+	}
+	ASSERT_TRUE(flushed.load());
+	Env::Default()->SleepForMicroseconds(kDelayMicros);
+	ASSERT_FALSE(deleted.load());
+	ASSERT_EQ(1U, env_->GetThreadPoolQueueLen(Env::Priority::HIGH));
+
+	env_->SetThreadPoolBorrowing(false);
+	sleeping_task.WakeUp();
+	sleeping_task.WaitUntilDone();
+	WaitThreadPoolsEmpty();
+	for (int i = 0; i < kDelayMicros && !deleted.load(); i++) {
+		Env::Default()->SleepForMicroseconds(1);
+	}
+	ASSERT_TRUE(deleted.load());
+}
+
 #if (defined OS_LINUX || defined OS_WIN)
 // Travis doesn't support fallocate or getting unique ID from files for whatever
 // reason.
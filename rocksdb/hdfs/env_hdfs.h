@@ -120,6 +120,15 @@ class HdfsEnv : public Env {
 		posixEnv->Schedule(function, arg, pri, tag, unschedFunction);
 	}
 
+	virtual void ScheduleJob(void (*function)(void *arg), void *arg,
+				 Priority pri, JobPriority job_pri,
+				 void *tag = nullptr,
+				 void (*unschedFunction)(void *arg) = 0)
+	{
+		posixEnv->ScheduleJob(function, arg, pri, job_pri, tag,
+				      unschedFunction);
+	}
+
 	virtual int UnSchedule(void *tag, Priority pri)
 	{
 		return posixEnv->UnSchedule(tag, pri);
@@ -141,6 +150,16 @@ class HdfsEnv : public Env {
 		return posixEnv->GetThreadPoolQueueLen(pri);
 	}
 
+	virtual bool
+	GetThreadPoolQueueWaitStats(Priority pri, JobPriority job_pri,
+				    uint64_t *num_jobs,
+				    uint64_t *wait_micros) const override
+	{
+		return posixEnv->GetThreadPoolQueueWaitStats(pri, job_pri,
+							     num_jobs,
+							     wait_micros);
+	}
+
 	virtual Status GetTestDirectory(std::string *path)
 	{
 		return posixEnv->GetTestDirectory(path);
@@ -188,6 +207,11 @@ class HdfsEnv : public Env {
 		posixEnv->IncBackgroundThreadsIfNeeded(number, pri);
 	}
 
+	virtual void SetThreadPoolBorrowing(bool allow) override
+	{
+		posixEnv->SetThreadPoolBorrowing(allow);
+	}
+
 	virtual std::string TimeToString(uint64_t number)
 	{
 		return posixEnv->TimeToString(number);
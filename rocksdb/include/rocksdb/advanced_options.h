@@ -542,6 +542,14 @@ struct AdvancedColumnFamilyOptions {
 	// Default: false
 	bool report_bg_io_stats = false;
 
+	// If > 0, compactions attribute the bytes they rewrite to key ranges:
+	// the user keys that share their first
+	// compaction_stats_key_prefix_length bytes form a range. See the DB
+	// property "rocksdb.compaction-key-range-stats". Choose a length that
+	// splits the key space into at most a few thousand ranges.
+	// Default: 0 (disabled)
+	size_t compaction_stats_key_prefix_length = 0;
+
 	// Create ColumnFamilyOptions with default values for all fields
 	AdvancedColumnFamilyOptions();
 	// Create ColumnFamilyOptions from Options
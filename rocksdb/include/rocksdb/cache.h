@@ -23,8 +23,10 @@
 #pragma once
 
 #include <stdint.h>
+#include <functional>
 #include <memory>
 #include <string>
+#include "rocksdb/memory_allocator.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
@@ -41,10 +43,26 @@ class Cache;
 // high_pri_pool_pct.
 // num_shard_bits = -1 means it is automatically determined: every shard
 // will be at least 512KB and number of shard bits will not exceed 6.
-extern std::shared_ptr<Cache> NewLRUCache(size_t capacity,
-					  int num_shard_bits = -1,
-					  bool strict_capacity_limit = false,
-					  double high_pri_pool_ratio = 0.0);
+// If numa_aware is set and the machine has more than one NUMA node, every
+// node gets its own 2^num_shard_bits shards (and an equal part of the
+// capacity). Entries are inserted in the shards of the caller's node and
+// looked up there only, so every node caches the entries its threads use
+// in local memory, each node with its own copy. Erase() drops all copies,
+// but a key inserted again with another value while another node caches
+// it leaves that copy, so every key must stand for a single value, as it
+// does in the caches of RocksDB. With numa_remote_lookup, a key is cached
+// by one node at a time: lookups missing the caller's node try the others,
+// and inserting a key drops it from the other nodes at the same time. On a
+// single node machine this is a no-op.
+// If memory_allocator is set, the blocks that table readers insert into the
+// cache are allocated from it and charged for its per-block overhead, see
+// include/rocksdb/memory_allocator.h.
+extern std::shared_ptr<Cache>
+NewLRUCache(size_t capacity, int num_shard_bits = -1,
+	    bool strict_capacity_limit = false,
+	    double high_pri_pool_ratio = 0.0, bool numa_aware = false,
+	    std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
+	    bool numa_remote_lookup = false);
 
 // Similar to NewLRUCache, but create a cache based on CLOCK algorithm with
 // better concurrent performance in some cases. See util/clock_cache.cc for
@@ -77,6 +95,13 @@ class Cache {
 	struct Handle {
 	};
 
+	// Called with the key, value and deleter of an entry the cache evicts
+	// to make room for others, right before the deleter runs.
+	typedef std::function<void(const Slice &key, void *value,
+				   void (*deleter)(const Slice &key,
+						   void *value))>
+		EvictionCallback;
+
 	// The type of the Cache
 	virtual const char *Name() const = 0;
 
@@ -196,6 +221,24 @@ class Cache {
 		return "";
 	}
 
+	// Report evicted entries to callback, replacing any earlier one; an
+	// empty callback stops reporting. Only entries pushed out to make room
+	// are reported, not the ones removed by Erase(), replaced by Insert()
+	// or dropped with the cache. The callback runs outside of the cache's
+	// locks, on the thread whose Insert() or SetCapacity() evicted them.
+	// The default implementation never reports evictions.
+	virtual void SetEvictionCallback(const EvictionCallback &callback)
+	{
+		(void)callback;
+	}
+
+	// Allocator for the memory of entries inserted by table readers, or
+	// nullptr to use the default heap.
+	virtual MemoryAllocator *memory_allocator() const
+	{
+		return nullptr;
+	}
+
 	// Mark the last inserted object as being a raw data block. This will be used
 	// in tests. The default implementation does nothing.
 	virtual void TEST_mark_as_data_block(const Slice &key, size_t charge)
@@ -22,6 +22,7 @@
 #include "rocksdb/options.h"
 #include "rocksdb/snapshot.h"
 #include "rocksdb/sst_file_writer.h"
+#include "rocksdb/stats_history.h"
 #include "rocksdb/thread_status.h"
 #include "rocksdb/transaction_log.h"
 #include "rocksdb/types.h"
@@ -53,6 +54,8 @@ struct ExternalSstFileInfo;
 class WriteBatch;
 class Env;
 class EventListener;
+class TraceWriter;
+struct TraceOptions;
 
 using std::unique_ptr;
 
@@ -486,6 +489,28 @@ class DB {
 		//      of files per level and total size of each level (MB).
 		static const std::string kLevelStats;
 
+		//  "rocksdb.sst-read-stats" - returns a multi-line string with, for
+		//      each live SST file, the point lookups that read it, the times
+		//      an iterator was positioned into it, and the bytes the point
+		//      lookups read from it. These are estimated from a sample of the
+		//      reads since the file was created or the DB opened.
+		static const std::string kSstReadStats;
+
+		//  "rocksdb.compaction-key-range-stats" - returns a multi-line string
+		//      with the key ranges compactions rewrote the most, as set by
+		//      ColumnFamilyOptions::compaction_stats_key_prefix_length, with
+		//      the number of compactions and the bytes of keys and values
+		//      rewritten for each. As a map, returns the bytes rewritten of
+		//      every key range.
+		static const std::string kCompactionKeyRangeStats;
+
+		//  "rocksdb.write-stall-stats" - returns a multi-line string with
+		//      whether the column family delays or stops the writes and
+		//      why, for how long it did so for each cause, for how long the
+		//      writes to the DB waited for each cause, and the write
+		//      controller tokens held. Also available as a map.
+		static const std::string kWriteStallStats;
+
 		//  "rocksdb.num-immutable-mem-table" - returns number of immutable
 		//      memtables that have not yet been flushed.
 		static const std::string kNumImmutableMemTable;
@@ -613,6 +638,11 @@ class DB {
 
 		//  "rocksdb.is-write-stopped" - Return 1 if write has been stopped.
 		static const std::string kIsWriteStopped;
+
+		//  "rocksdb.rate-limiter-bytes-per-sec" - returns the current rate of
+		//      options.rate_limiter, which changes over time if it is
+		//      auto-tuned. 0 means there is no rate limiter.
+		static const std::string kRateLimiterBytesPerSec;
 	};
 #endif /* ROCKSDB_LITE */
 
@@ -665,6 +695,7 @@ class DB {
 	//  "rocksdb.num-running-flushes"
 	//  "rocksdb.actual-delayed-write-rate"
 	//  "rocksdb.is-write-stopped"
+	//  "rocksdb.rate-limiter-bytes-per-sec"
 	virtual bool GetIntProperty(ColumnFamilyHandle *column_family,
 				    const Slice &property, uint64_t *value) = 0;
 	virtual bool GetIntProperty(const Slice &property, uint64_t *value)
@@ -1181,8 +1212,56 @@ class DB {
 	GetPropertiesOfTablesInRange(ColumnFamilyHandle *column_family,
 				     const Range *range, std::size_t n,
 				     TablePropertiesCollection *props) = 0;
+
+	// Record the Gets, iterator seeks and writes issued to this DB, with
+	// their timestamps and WriteBatch contents, to trace_writer until
+	// EndTrace(). The trace can be replayed against another DB with the
+	// Replayer of util/trace_replay.h or `db_bench -benchmarks=replay`.
+	// Returns Busy if a trace is already running.
+	virtual Status StartTrace(const TraceOptions & /*options*/,
+				  std::unique_ptr<TraceWriter> && /*writer*/)
+	{
+		return Status::NotSupported("StartTrace() is not implemented.");
+	}
+
+	// Stop the trace started by StartTrace() and close its writer.
+	virtual Status EndTrace()
+	{
+		return Status::NotSupported("EndTrace() is not implemented.");
+	}
+
+	// Record every block cache lookup of the table readers of this DB to
+	// the writer until EndBlockCacheTrace(): the block, whether it hit,
+	// and what looked it up. tools/block_cache_trace_analyzer replays the
+	// trace against simulated caches of many sizes. Sampling, when
+	// configured, keeps or drops whole blocks.
+	// Returns Busy if a block cache trace is already running.
+	virtual Status
+	StartBlockCacheTrace(const TraceOptions & /*options*/,
+			     std::unique_ptr<TraceWriter> && /*writer*/)
+	{
+		return Status::NotSupported(
+			"StartBlockCacheTrace() is not implemented.");
+	}
+
+	virtual Status EndBlockCacheTrace()
+	{
+		return Status::NotSupported(
+			"EndBlockCacheTrace() is not implemented.");
+	}
 #endif // ROCKSDB_LITE
 
+	// The statistics snapshots in memory taken in [start_time, end_time),
+	// in microseconds since the epoch. Returns NotSupported unless
+	// DBOptions::stats_persist_period_sec is set.
+	virtual Status GetStatsHistory(
+		uint64_t /*start_time*/, uint64_t /*end_time*/,
+		std::unique_ptr<StatsHistoryIterator> * /*stats_iterator*/)
+	{
+		return Status::NotSupported(
+			"GetStatsHistory() is not implemented.");
+	}
+
 	// Needed for StackableDB
 	virtual DB *GetRootDB()
 	{
@@ -103,6 +103,9 @@ struct EnvOptions {
 	// See DBOptions doc
 	size_t writable_file_max_buffer_size = 1024 * 1024;
 
+	// See DBOptions doc
+	size_t writable_file_direct_io_buffers = 1;
+
 	// If not nullptr, write rate limiting is enabled for flush and compaction
 	RateLimiter *rate_limiter = nullptr;
 };
@@ -292,6 +295,17 @@ class Env {
 	// Priority for scheduling job in thread pool
 	enum Priority { LOW, HIGH, TOTAL };
 
+	// Class of a job within a thread pool. Queued jobs of a lower class are
+	// picked up before jobs of a higher class; jobs of the same class run
+	// in FIFO order. Jobs scheduled without a class are JOB_COMPACTION.
+	enum JobPriority {
+		JOB_FLUSH = 0,
+		JOB_L0_COMPACTION,
+		JOB_COMPACTION,
+		JOB_DELETION,
+		JOB_TOTAL
+	};
+
 	// Priority for requesting bytes in rate limiter scheduler
 	enum IOPriority { IO_LOW = 0, IO_HIGH = 1, IO_TOTAL = 2 };
 
@@ -309,6 +323,17 @@ class Env {
 			      Priority pri = LOW, void *tag = nullptr,
 			      void (*unschedFunction)(void *arg) = 0) = 0;
 
+	// Same as Schedule(), but additionally tags the job with its class so
+	// that more urgent jobs overtake less urgent ones queued in the same
+	// pool. Envs that do not order their queues fall back to Schedule().
+	virtual void ScheduleJob(void (*function)(void *arg), void *arg,
+				 Priority pri, JobPriority job_pri,
+				 void *tag = nullptr,
+				 void (*unschedFunction)(void *arg) = 0)
+	{
+		Schedule(function, arg, pri, tag, unschedFunction);
+	}
+
 	// Arrange to remove jobs for given arg from the queue_ if they are not
 	// already scheduled. Caller is expected to have exclusive lock on arg.
 	virtual int UnSchedule(void *arg, Priority pri)
@@ -331,6 +356,17 @@ class Env {
 		return 0;
 	}
 
+	// Get the number of jobs of class job_pri that were picked up from the
+	// queue of thread pool pri, and the total time in microseconds they
+	// waited there. Returns false if the Env does not track queue waits.
+	virtual bool GetThreadPoolQueueWaitStats(Priority pri,
+						 JobPriority job_pri,
+						 uint64_t *num_jobs,
+						 uint64_t *wait_micros) const
+	{
+		return false;
+	}
+
 	// *path is set to a temporary directory that can be used for testing. It may
 	// or many not have just been created. The directory may or may not differ
 	// between runs of the same process, but subsequent calls will return the
@@ -385,6 +421,21 @@ class Env {
 	{
 	}
 
+	// Spread the threads of the specified pool over the NUMA nodes of the
+	// machine, binding each one to the cores of a single node. No-op on
+	// single node machines and when built without NUMA support.
+	virtual void BindThreadPoolToNumaNodes(Priority pool = LOW)
+	{
+	}
+
+	// When enabled, idle threads of the LOW priority pool run JOB_FLUSH
+	// jobs that are queued in the HIGH priority pool because all of its
+	// threads are busy, at the default I/O priority even if the LOW pool
+	// has a lowered one. Disabled by default.
+	virtual void SetThreadPoolBorrowing(bool allow)
+	{
+	}
+
 	// Converts seconds-since-Jan-01-1970 to a printable string
 	virtual std::string TimeToString(uint64_t time) = 0;
 
@@ -1118,6 +1169,13 @@ class EnvWrapper : public Env {
 		return target_->Schedule(f, a, pri, tag, u);
 	}
 
+	void ScheduleJob(void (*f)(void *arg), void *a, Priority pri,
+			 JobPriority job_pri, void *tag = nullptr,
+			 void (*u)(void *arg) = 0) override
+	{
+		return target_->ScheduleJob(f, a, pri, job_pri, tag, u);
+	}
+
 	int UnSchedule(void *tag, Priority pri) override
 	{
 		return target_->UnSchedule(tag, pri);
@@ -1135,6 +1193,14 @@ class EnvWrapper : public Env {
 	{
 		return target_->GetThreadPoolQueueLen(pri);
 	}
+	bool GetThreadPoolQueueWaitStats(Priority pri, JobPriority job_pri,
+					 uint64_t *num_jobs,
+					 uint64_t *wait_micros) const override
+	{
+		return target_->GetThreadPoolQueueWaitStats(pri, job_pri,
+							    num_jobs,
+							    wait_micros);
+	}
 	Status GetTestDirectory(std::string *path) override
 	{
 		return target_->GetTestDirectory(path);
@@ -1185,6 +1251,16 @@ class EnvWrapper : public Env {
 		target_->LowerThreadPoolIOPriority(pool);
 	}
 
+	void BindThreadPoolToNumaNodes(Priority pool = LOW) override
+	{
+		target_->BindThreadPoolToNumaNodes(pool);
+	}
+
+	void SetThreadPoolBorrowing(bool allow) override
+	{
+		return target_->SetThreadPoolBorrowing(allow);
+	}
+
 	std::string TimeToString(uint64_t time) override
 	{
 		return target_->TimeToString(time);
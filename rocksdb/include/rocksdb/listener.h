@@ -11,6 +11,7 @@
 #include "rocksdb/compaction_job_stats.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table_properties.h"
+#include "rocksdb/types.h"
 
 namespace rocksdb
 {
@@ -175,6 +176,21 @@ struct MemTableInfo {
 	uint64_t num_deletes;
 };
 
+struct WriteStallInfo {
+	// the name of the column family
+	std::string cf_name;
+	// state of the write controller of the column family
+	struct {
+		WriteStallCondition cur;
+		WriteStallCondition prev;
+	} condition;
+	// what the column family stalls the writes for
+	struct {
+		WriteStallCause cur;
+		WriteStallCause prev;
+	} cause;
+};
+
 struct ExternalFileIngestionInfo {
 	// the name of the column family
 	std::string cf_name;
@@ -344,6 +360,17 @@ class EventListener {
 	{
 	}
 
+	// A call-back function for RocksDB which will be called whenever
+	// a column family starts or stops delaying or stopping the writes,
+	// or stalls them for another cause.
+	//
+	// Note that the this function will be called from a background or
+	// a writer thread without holding the DB mutex, and the writes may be
+	// blocked until it returns.
+	virtual void OnStallConditionsChanged(const WriteStallInfo & /*info*/)
+	{
+	}
+
 	// A call-back function for RocksDB which will be called before
 	// a column family handle is deleted.
 	//
@@ -0,0 +1,101 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+#include <memory>
+
+namespace rocksdb
+{
+// MemoryAllocator is the interface a cache uses to allocate the memory of
+// the entries charged against it: uncompressed data blocks and the index
+// and filter blocks read by table readers. Implementations must be
+// thread-safe.
+class MemoryAllocator {
+    public:
+	virtual ~MemoryAllocator()
+	{
+	}
+
+	// Name of the allocator, used in log messages.
+	virtual const char *Name() const = 0;
+
+	// Allocate a block of at least `size` bytes. Never returns nullptr
+	// for a non-zero size; allocation failure is fatal as with operator
+	// new.
+	virtual void *Allocate(size_t size) = 0;
+
+	// Release a block previously returned by Allocate().
+	virtual void Deallocate(void *p) = 0;
+
+	// Number of bytes the block at `p`, allocated with `allocation_size`,
+	// really occupies, including any rounding and per-block header. This
+	// is what a cache entry backed by the block is charged.
+	virtual size_t UsableSize(void *p, size_t allocation_size) const
+	{
+		(void)p;
+		return allocation_size;
+	}
+};
+
+// Frees a buffer with the allocator it came from, or with delete[] when it
+// was allocated without one.
+struct CustomDeleter {
+	CustomDeleter(MemoryAllocator *a = nullptr) : allocator(a)
+	{
+	}
+
+	void operator()(char *ptr) const
+	{
+		if (allocator) {
+			allocator->Deallocate(reinterpret_cast<void *>(ptr));
+		} else {
+			delete[] ptr;
+		}
+	}
+
+	MemoryAllocator *allocator;
+};
+
+using CacheAllocationPtr = std::unique_ptr<char[], CustomDeleter>;
+
+// Allocates size bytes with allocator, or with new[] if it is nullptr
+inline CacheAllocationPtr AllocateBlock(size_t size,
+					MemoryAllocator *allocator)
+{
+	if (allocator) {
+		auto block =
+			reinterpret_cast<char *>(allocator->Allocate(size));
+		return CacheAllocationPtr(block, allocator);
+	}
+	return CacheAllocationPtr(new char[size]);
+}
+
+// Create an allocator that carves blocks out of slabs backed by explicit
+// huge pages (mmap with MAP_HUGETLB). When no huge pages are reserved,
+// slabs fall back to regular anonymous mappings advised with
+// MADV_HUGEPAGE so transparent huge pages can back them instead. Either
+// way the blocks of a cache share a small number of TLB entries.
+//
+// Blocks are rounded up to size classes, four per power of two; each slab
+// holds blocks of one class and recycles them through a free list of its
+// own. UsableSize() reports the rounded size so the cache is charged for
+// it. Blocks larger than half a slab get a mapping of their own which is
+// unmapped on Deallocate(). A slab is returned to the OS once none of its
+// blocks is in use, but for the last one of its class, and the rest when
+// the allocator is destroyed, so it must outlive every cache and table
+// reader using it.
+//
+// @huge_page_size: size of a huge page (2MB on most x86-64 systems).
+// @slab_size: bytes mapped at a time, rounded up to a multiple of
+//    huge_page_size. 0 means huge_page_size.
+//
+// Returns nullptr on platforms without mmap.
+extern std::shared_ptr<MemoryAllocator>
+NewHugePageMemoryAllocator(size_t huge_page_size = 2 * 1024 * 1024,
+			   size_t slab_size = 0);
+
+} // namespace rocksdb
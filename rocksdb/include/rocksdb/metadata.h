@@ -61,6 +61,8 @@ struct LevelMetaData {
 // The metadata that describes a SST file.
 struct SstFileMetaData {
 	SstFileMetaData()
+		: num_reads_sampled(0), num_seeks_sampled(0),
+		  bytes_read_sampled(0)
 	{
 	}
 	SstFileMetaData(const std::string &_file_name, const std::string &_path,
@@ -71,7 +73,9 @@ struct SstFileMetaData {
 		: size(_size), name(_file_name), db_path(_path),
 		  smallest_seqno(_smallest_seqno),
 		  largest_seqno(_largest_seqno), smallestkey(_smallestkey),
-		  largestkey(_largestkey), being_compacted(_being_compacted)
+		  largestkey(_largestkey), being_compacted(_being_compacted),
+		  num_reads_sampled(0), num_seeks_sampled(0),
+		  bytes_read_sampled(0)
 	{
 	}
 
@@ -87,6 +91,13 @@ struct SstFileMetaData {
 	std::string smallestkey; // Smallest user defined key in the file.
 	std::string largestkey; // Largest user defined key in the file.
 	bool being_compacted; // true if the file is currently being compacted.
+
+	// Estimated from a sample of the reads of the file since it was created
+	// or the DB was opened: point lookups that read the file, times an
+	// iterator was positioned into it, and bytes read by the point lookups.
+	uint64_t num_reads_sampled;
+	uint64_t num_seeks_sampled;
+	uint64_t bytes_read_sampled;
 };
 
 // The full set of metadata associated with each SST file.
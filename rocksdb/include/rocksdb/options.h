@@ -550,6 +550,27 @@ struct DBOptions {
 	// The default value is MAX_INT so that roll-over does not take place.
 	uint64_t max_manifest_file_size = std::numeric_limits<uint64_t>::max();
 
+	// If non-zero, the manifest file is also rolled over once it grows
+	// beyond (100 + max_manifest_space_amp_pct) percent of the full-state
+	// snapshot written at its start, and past
+	// min_manifest_file_size_for_space_amp. This bounds the number
+	// of edits that DB::Open has to replay by the size of the live state
+	// rather than by how long the DB has been running. The new snapshot is
+	// written by the LogAndApply() call that rolls the file over, like on
+	// reaching max_manifest_file_size: outside of the DB mutex, but ahead
+	// of the MANIFEST writes queued behind it.
+	//
+	// Default: 0 (disabled)
+	uint64_t max_manifest_space_amp_pct = 0;
+
+	// A manifest file smaller than this is cheap to replay whatever its
+	// space amplification, and is not rolled over for
+	// max_manifest_space_amp_pct. Keeps a small DB from writing a new
+	// snapshot every few edits.
+	//
+	// Default: 4MB
+	uint64_t min_manifest_file_size_for_space_amp = 4 << 20;
+
 	// Number of shards used for table cache.
 	int table_cache_numshardbits = 6;
 
@@ -604,6 +625,16 @@ struct DBOptions {
 	// Not supported in ROCKSDB_LITE mode!
 	bool use_direct_io_for_flush_and_compaction = false;
 
+	// Use O_DIRECT for writing the write-ahead log. Every WAL flush
+	// rewrites the partially filled last sector, padded with zeros, so
+	// recovery after a crash may see zeros after the last record; they are
+	// skipped the same way as an unfinished block. Keeps WAL writes out of
+	// the page cache and away from kernel writeback. Only the POSIX Env
+	// honours it.
+	// Default: false
+	// Not supported in ROCKSDB_LITE mode!
+	bool use_direct_io_for_wal = false;
+
 	// If false, fallocate() calls are bypassed
 	bool allow_fallocate = true;
 
@@ -704,6 +735,17 @@ struct DBOptions {
 	// Default: 1024 * 1024 (1 MB)
 	size_t writable_file_max_buffer_size = 1024 * 1024;
 
+	// Number of aligned buffers WritableFileWriter uses for files opened
+	// for direct I/O. With more than one, a full buffer is written by a
+	// thread of a small process-wide pool while the writer keeps filling
+	// the next one, so up to
+	// writable_file_direct_io_buffers - 1 writes of
+	// writable_file_max_buffer_size bytes can be in flight per file.
+	// 1 writes synchronously.
+	//
+	// Default: 1
+	size_t writable_file_direct_io_buffers = 1;
+
 	// Use adaptive mutex, which spins in the user space before resorting
 	// to kernel. This could reduce context switch when the mutex is not
 	// heavily contended. However, if the mutex is hot, we could end up
@@ -886,6 +928,69 @@ struct DBOptions {
 	// DEFAULT: false
 	// Immutable.
 	bool allow_ingest_behind = false;
+
+	// If true, DB close writes a TABLEMETA file with the size and the
+	// table-property stats of every live table file, and DB::Open uses it
+	// instead of reading table properties. When every live file is found
+	// in the snapshot, Open also skips pre-loading table readers with
+	// max_open_files = -1; tables are then opened on first access.
+	// Entries whose file number, path or size disagree with the MANIFEST
+	// are ignored, so a stale snapshot only costs the skipped speedup.
+	// So that a crash does not lose it all, the file is also rewritten by
+	// the first flush or compaction logged to every new MANIFEST, i.e.
+	// once after DB::Open and after every MANIFEST roll-over.
+	//
+	// Default: false
+	bool persist_table_meta_snapshot = false;
+
+	// If true and the machine has more than one NUMA node, the core-local
+	// shards of memtable arenas allocate memory on the node of the core
+	// they serve. Has no effect on single node machines or when RocksDB is
+	// built without NUMA support.
+	//
+	// Default: false
+	bool numa_aware = false;
+
+	// Number of pre-allocated log files the DB keeps ready for new WALs.
+	// A background job creates them in wal_dir, reserving their blocks
+	// with fallocate and setting their size up front, so that appends to a
+	// WAL taken from the pool neither allocate blocks nor grow the file.
+	// Unused pool files survive a restart and are reused by the next
+	// DB::Open(). Combine with recycle_log_file_num to also reuse the
+	// files of obsolete logs.
+	//
+	// Default: 0 (disabled)
+	size_t wal_pool_size = 0;
+
+	// If not zero, a background thread of the DB snapshots every ticker
+	// and histogram of `statistics` and a few DB properties every
+	// stats_persist_period_sec seconds. DB::GetStatsHistory() returns the
+	// snapshots still in memory, see stats_history_buffer_size, and
+	// stats_history_file keeps them all.
+	//
+	// Default: 0 (disabled)
+	unsigned int stats_persist_period_sec = 0;
+
+	// Memory the snapshots of stats_persist_period_sec may take. The
+	// oldest ones are dropped to stay below it.
+	//
+	// Default: 1MB
+	size_t stats_history_buffer_size = 1024 * 1024;
+
+	// If not empty, the snapshots of stats_persist_period_sec are also
+	// appended to this file, in a compact binary format that
+	// `stats_history_to_csv` converts to CSV.
+	//
+	// Default: empty
+	std::string stats_history_file = "";
+
+	// If not zero, stats_history_file rolls over once it grows past this
+	// many bytes, like the info LOG does at max_log_file_size: it is
+	// renamed to stats_history_file + ".old", replacing the file rolled
+	// over before, and a new one is started.
+	//
+	// Default: 64MB
+	size_t max_stats_history_file_size = 64 << 20;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
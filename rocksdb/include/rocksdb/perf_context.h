@@ -13,6 +13,27 @@
 
 namespace rocksdb
 {
+// Number of LSM levels PerfContext breaks counters down by. Tables of
+// deeper levels are counted in the last one.
+const int kPerfContextMaxLevels = 8;
+
+// The counters of the block based tables of one LSM level.
+struct PerfContextByLevel {
+	void Reset();
+
+	// number of times a filter showed a key not to be in the table
+	uint64_t bloom_filter_useful;
+	// number of times a full filter did not rule a key out
+	uint64_t bloom_filter_full_positive;
+	// number of those times the key was found in the table
+	uint64_t bloom_filter_full_true_positive;
+	uint64_t block_cache_hit_count; // data and index block cache hits
+	uint64_t block_cache_miss_count; // data and index block cache misses
+	uint64_t block_read_count; // number of data and index block reads
+	uint64_t block_read_byte; // bytes of data and index block reads
+	uint64_t block_read_time; // nanos spent on data and index block reads
+};
+
 // A thread local context for gathering performance counter efficiently
 // and transparently.
 // Use SetPerfLevel(PerfLevel::kEnableTime) to enable time stats.
@@ -22,6 +43,20 @@ struct PerfContext {
 
 	std::string ToString(bool exclude_zero_counters = false) const;
 
+	// Start or stop breaking down the counters of level_perf_context by
+	// the LSM level of the table they come from. Off by default, which
+	// costs a check of a flag per counter.
+	void EnablePerLevelPerfContext()
+	{
+		per_level_perf_context_enabled = true;
+	}
+	void DisablePerLevelPerfContext()
+	{
+		per_level_perf_context_enabled = false;
+	}
+	// reset the counters of level_perf_context to zero
+	void ClearPerLevelPerfContext();
+
 	uint64_t user_key_comparison_count; // total number of user key comparisons
 	uint64_t block_cache_hit_count; // total number of block cache hits
 	uint64_t block_read_count; // total number of block reads (with IO)
@@ -147,6 +182,14 @@ struct PerfContext {
 	uint64_t env_lock_file_nanos;
 	uint64_t env_unlock_file_nanos;
 	uint64_t env_new_logger_nanos;
+
+	bool per_level_perf_context_enabled;
+	// Indexed by LSM level; counted for the tables opened on a level by
+	// the DB, not for those of ingested or standalone tables. A table
+	// keeps the level it was opened for, so one a trivial move pushed
+	// down keeps counting into its old level while the table cache holds
+	// it open.
+	PerfContextByLevel level_perf_context[kPerfContextMaxLevels];
 };
 
 // Get Thread-local PerfContext object pointer
@@ -61,9 +61,13 @@ class PersistentCache {
 };
 
 // Factor method to create a new persistent cache
+//
+// With warm_restart, the blocks cached in `path` by a previous instance are
+// kept and served again, instead of starting with an empty cache
 Status NewPersistentCache(Env *const env, const std::string &path,
 			  const uint64_t size,
 			  const std::shared_ptr<Logger> &log,
 			  const bool optimized_for_nvm,
-			  std::shared_ptr<PersistentCache> *cache);
+			  std::shared_ptr<PersistentCache> *cache,
+			  const bool warm_restart = false);
 } // namespace rocksdb
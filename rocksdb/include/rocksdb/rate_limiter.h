@@ -57,6 +57,16 @@ class RateLimiter {
 	GetTotalRequests(const Env::IOPriority pri = Env::IO_TOTAL) const = 0;
 
 	virtual int64_t GetBytesPerSecond() const = 0;
+
+	// Tell the rate limiter how far behind background work is. 0 means no
+	// backlog, 1 means writes are about to be (or are being) slowed down
+	// because flushes and compactions cannot keep up. DBs using this rate
+	// limiter call it whenever their LSM shape changes; an auto-tuned rate
+	// limiter uses it to decide whether to grant compaction more bandwidth.
+	// When the rate limiter is shared, the latest report wins.
+	virtual void SetCompactionPressure(double /* pressure */)
+	{
+	}
 };
 
 // Create a RateLimiter object, which can be shared among RocksDB instances to
@@ -77,8 +87,18 @@ class RateLimiter {
 // continuously. This fairness parameter grants low-pri requests permission by
 // 1/fairness chance even though high-pri requests exist to avoid starvation.
 // You should be good by leaving it at default 10.
+// @auto_tuned: Enables dynamic adjustment of the rate limit within the range
+// [min_rate_bytes_per_sec, rate_bytes_per_sec]. Every few refill periods the
+// rate is raised when background work is falling behind (see
+// SetCompactionPressure()) or keeps exhausting its budget, and lowered when
+// the budget goes unused or there is no backlog, leaving more of the device
+// to foreground operations.
+// @min_rate_bytes_per_sec: lower bound used by auto-tuning. 0 means
+// rate_bytes_per_sec / 20.
 extern RateLimiter *NewGenericRateLimiter(int64_t rate_bytes_per_sec,
 					  int64_t refill_period_us = 100 * 1000,
-					  int32_t fairness = 10);
+					  int32_t fairness = 10,
+					  bool auto_tuned = false,
+					  int64_t min_rate_bytes_per_sec = 0);
 
 } // namespace rocksdb
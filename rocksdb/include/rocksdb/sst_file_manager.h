@@ -57,6 +57,12 @@ class SstFileManager {
 	// zero means disable delete rate limiting and delete files immediately
 	// thread-safe
 	virtual void SetDeleteRateBytesPerSecond(int64_t delete_rate) = 0;
+
+	// Return the number of bytes of deleted files (SST, WAL, blob and
+	// options files alike) that are still waiting in trash to be given back
+	// to the filesystem.
+	// thread-safe
+	virtual uint64_t GetDeleteBacklogBytes() = 0;
 };
 
 // Create a new SstFileManager that can be shared among multiple RocksDB
@@ -79,9 +85,15 @@ class SstFileManager {
 //    SstFileManager will delete files that already exist in trash_dir.
 // @param status: If not nullptr, status will contain any errors that happened
 //    during creating the missing trash_dir or deleting existing files in trash.
+// @param bytes_max_delete_chunk: if > 0, files in trash bigger than this are
+//    truncated by this many bytes at a time instead of being unlinked in one
+//    go, and smaller files are unlinked in batches of up to this many bytes.
+//    This keeps a single unlink from stalling the filesystem journal. Only
+//    used when deletion rate limiting is enabled.
 extern SstFileManager *
 NewSstFileManager(Env *env, std::shared_ptr<Logger> info_log = nullptr,
 		  std::string trash_dir = "", int64_t rate_bytes_per_sec = 0,
-		  bool delete_existing_trash = true, Status *status = nullptr);
+		  bool delete_existing_trash = true, Status *status = nullptr,
+		  uint64_t bytes_max_delete_chunk = 0);
 
 } // namespace rocksdb
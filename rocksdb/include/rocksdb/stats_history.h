@@ -0,0 +1,44 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+#include "rocksdb/status.h"
+
+namespace rocksdb
+{
+// Iterates the statistics snapshots of a DB, oldest first, see
+// DBOptions::stats_persist_period_sec and DB::GetStatsHistory().
+class StatsHistoryIterator {
+    public:
+	virtual ~StatsHistoryIterator()
+	{
+	}
+
+	virtual bool Valid() const = 0;
+
+	// REQUIRES: Valid()
+	virtual void Next() = 0;
+
+	// When the snapshot was taken, in microseconds since the epoch.
+	// REQUIRES: Valid()
+	virtual uint64_t GetStatsTime() const = 0;
+
+	// The statistics by name. The tickers, e.g. "rocksdb.block.cache.miss",
+	// and the count and sum of the histograms, e.g.
+	// "rocksdb.db.get.micros.count", are the change since the previous
+	// snapshot. The DB properties, e.g. "rocksdb.num-running-compactions",
+	// are the value at the time of the snapshot.
+	// REQUIRES: Valid()
+	virtual const std::map<std::string, uint64_t> &GetStatsMap() const = 0;
+
+	virtual Status status() const = 0;
+};
+
+} // namespace rocksdb
@@ -116,6 +116,12 @@ struct BlockBasedTableOptions {
 
 	// If non-NULL use the specified cache for pages read from device
 	// IF NULL, no page cache is used
+	//
+	// An uncompressed persistent cache behind a block cache acts as its
+	// secondary tier: it is filled with the blocks evicted from block_cache
+	// instead of the blocks read, and its hits go back to block_cache.
+	// Table factories sharing a block cache each get the blocks of their
+	// own tables.
 	std::shared_ptr<PersistentCache> persistent_cache = nullptr;
 
 	// If non-NULL use the specified cache for compressed blocks.
@@ -48,11 +48,15 @@ struct ThreadStatus {
 
 	// The type used to refer to a thread operation.
 	// A thread operation describes high-level action of a thread.
-	// Examples include compaction and flush.
+	// Examples include compaction and flush, and the reads, writes and
+	// transaction lock requests of user threads.
 	enum OperationType : int {
 		OP_UNKNOWN = 0,
 		OP_COMPACTION,
 		OP_FLUSH,
+		OP_GET,
+		OP_WRITE,
+		OP_LOCK,
 		NUM_OP_TYPES
 	};
 
@@ -99,7 +103,18 @@ struct ThreadStatus {
 	// such as reading / writing a file or waiting for a mutex.
 	enum StateType : int {
 		STATE_UNKNOWN = 0,
+		// Waiting for an InstrumentedMutex or on its condition variable
 		STATE_MUTEX_WAIT = 1,
+		// Waiting for the leader of a write group to write the batch
+		STATE_WRITE_GROUP_WAIT,
+		// Syncing the WAL for a sync write
+		STATE_WAL_SYNC,
+		// Delayed or stopped by the WriteController
+		STATE_WRITE_STALL,
+		// Waiting for a transaction lock on a key
+		STATE_LOCK_WAIT,
+		// Reading a block of a table file
+		STATE_BLOCK_READ,
 		NUM_STATE_TYPES
 	};
 
@@ -108,15 +123,25 @@ struct ThreadStatus {
 		     const OperationType _operation_type,
 		     const uint64_t _op_elapsed_micros,
 		     const OperationStage _operation_stage,
-		     const uint64_t _op_props[], const StateType _state_type)
+		     const uint64_t _op_props[], const StateType _state_type,
+		     const uint64_t _state_elapsed_micros = 0,
+		     const uint64_t _state_wait_micros[] = nullptr,
+		     const uint64_t _state_wait_counts[] = nullptr)
 		: thread_id(_id), thread_type(_thread_type), db_name(_db_name),
 		  cf_name(_cf_name), operation_type(_operation_type),
 		  op_elapsed_micros(_op_elapsed_micros),
-		  operation_stage(_operation_stage), state_type(_state_type)
+		  operation_stage(_operation_stage), state_type(_state_type),
+		  state_elapsed_micros(_state_elapsed_micros)
 	{
 		for (int i = 0; i < kNumOperationProperties; ++i) {
 			op_properties[i] = _op_props[i];
 		}
+		for (int i = 0; i < NUM_STATE_TYPES; ++i) {
+			state_wait_micros[i] =
+				_state_wait_micros ? _state_wait_micros[i] : 0;
+			state_wait_counts[i] =
+				_state_wait_counts ? _state_wait_counts[i] : 0;
+		}
 	}
 
 	// An unique ID for the thread.
@@ -154,6 +179,16 @@ struct ThreadStatus {
 	// The state (lower-level action) that the current thread is involved.
 	const StateType state_type;
 
+	// The elapsed time of the current state in microseconds.
+	const uint64_t state_elapsed_micros;
+
+	// The total time in microseconds the thread has spent in each state,
+	// and the number of times it entered it, while tracked. A state
+	// entered within another one, e.g. a mutex wait during a write stall,
+	// takes its time from the outer one.
+	uint64_t state_wait_micros[NUM_STATE_TYPES];
+	uint64_t state_wait_counts[NUM_STATE_TYPES];
+
 	// The followings are a set of utility functions for interpreting
 	// the information of ThreadStatus
 
@@ -0,0 +1,70 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#include "rocksdb/env.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb
+{
+// Options for DB::StartTrace().
+struct TraceOptions {
+	// Stop recording once the trace has grown to this many bytes. The
+	// trace stays valid; the operations after the limit are just not in
+	// it.
+	uint64_t max_trace_file_size = uint64_t{ 64 } * 1024 * 1024 * 1024;
+
+	// Record one of every sampling_frequency queries. Gets and iterator
+	// seeks are sampled; writes are always recorded so that a replay
+	// builds the same data. 1 records everything.
+	uint64_t sampling_frequency = 1;
+};
+
+// TraceWriter receives the encoded trace records of a DB, one Write() call
+// per record, in the order the operations were recorded. DB::StartTrace()
+// serializes the calls, so implementations need not be thread-safe.
+class TraceWriter {
+    public:
+	virtual ~TraceWriter()
+	{
+	}
+
+	virtual Status Write(const Slice &data) = 0;
+	virtual Status Close() = 0;
+	// Bytes written so far, checked against
+	// TraceOptions::max_trace_file_size.
+	virtual uint64_t GetFileSize() = 0;
+};
+
+// TraceReader hands back the records given to a TraceWriter, one per
+// Read() call. Read() returns Status::Incomplete() at the end of the
+// trace.
+class TraceReader {
+    public:
+	virtual ~TraceReader()
+	{
+	}
+
+	virtual Status Read(std::string *data) = 0;
+	virtual Status Close() = 0;
+};
+
+// Write a trace to the file at trace_filename, replacing any existing file.
+Status NewFileTraceWriter(Env *env, const EnvOptions &env_options,
+			  const std::string &trace_filename,
+			  std::unique_ptr<TraceWriter> *trace_writer);
+
+// Read a trace written by a writer from NewFileTraceWriter().
+Status NewFileTraceReader(Env *env, const EnvOptions &env_options,
+			  const std::string &trace_filename,
+			  std::unique_ptr<TraceReader> *trace_reader);
+
+} // namespace rocksdb
@@ -15,6 +15,25 @@ namespace rocksdb
 // Represents a sequence number in a WAL file.
 typedef uint64_t SequenceNumber;
 
+// The condition of the writes to a column family
+enum class WriteStallCondition {
+	kNormal,
+	kDelayed,
+	kStopped,
+};
+
+// What a column family delays or stops the writes for
+enum class WriteStallCause {
+	kNone,
+	// Too many memtables are waiting for flush
+	kMemtableLimit,
+	// Too many level-0 files
+	kL0FileCountLimit,
+	// Too many bytes are pending compaction
+	kPendingCompactionBytes,
+	kNumCauses,
+};
+
 } //  namespace rocksdb
 
 #endif //  STORAGE_ROCKSDB_INCLUDE_TYPES_H_
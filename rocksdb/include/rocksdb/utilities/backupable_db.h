@@ -103,6 +103,13 @@ struct BackupableDBOptions {
 	// Default: 1
 	int max_background_operations;
 
+	// Table files at least twice this size are split into chunks of this
+	// size when backed up, which the background threads copy and
+	// checksum in parallel. Needs backup_env to support NewRandomRWFile(),
+	// files are copied whole otherwise. If 0, files are copied whole.
+	// Default: 0
+	uint64_t copy_chunk_size;
+
 	// During backup user can get callback every time next
 	// callback_trigger_interval_size bytes being copied.
 	// Default: 4194304
@@ -132,6 +139,7 @@ struct BackupableDBOptions {
 		  restore_rate_limit(_restore_rate_limit),
 		  share_files_with_checksum(false),
 		  max_background_operations(_max_background_operations),
+		  copy_chunk_size(0),
 		  callback_trigger_interval_size(
 			  _callback_trigger_interval_size),
 		  max_valid_backups_to_open(_max_valid_backups_to_open)
@@ -36,6 +36,18 @@ class Checkpoint {
 	virtual Status CreateCheckpoint(const std::string &checkpoint_dir,
 					uint64_t log_size_for_flush = 0);
 
+	// Brings the checkpoint in checkpoint_dir, made by CreateCheckpoint()
+	// or by this before, up to date, or creates it like CreateCheckpoint()
+	// if the directory doesn't exist. Only the SST files that are new
+	// since are hard-linked or copied, and only what was appended to the
+	// WAL files since is copied. Files the checkpoint no longer needs are
+	// deleted. The checkpoint stays openable should this fail midway, but
+	// it must not be open, other than read-only, while this runs.
+	// log_size_for_flush is as for CreateCheckpoint().
+	virtual Status
+	CreateIncrementalCheckpoint(const std::string &checkpoint_dir,
+				    uint64_t log_size_for_flush = 0);
+
 	virtual ~Checkpoint()
 	{
 	}
@@ -34,6 +34,10 @@ namespace rocksdb
 // expired (CF_Timestamp <= CUR_Timestamp - TTL), we directly drop the whole
 // column family.
 //
+// DateTieredDB also keeps the range of the keys written to each column family,
+// so point lookups of keys out of it, and iterators with an
+// iterate_upper_bound below it, skip the column family.
+//
 // TODO(jhli): This is only a simplified version of DTCS. In a complete DTCS,
 // time windows can be merged over time, so that older time windows will have
 // larger time range. Also, compaction are executed only for adjacent SST files
@@ -104,8 +108,15 @@ class DateTieredDB {
 	// iterator can possibly access obsolete key value pairs.
 	virtual Iterator *NewIterator(const ReadOptions &opts) = 0;
 
+	// Like NewIterator(), but only merges the column families whose time
+	// ranges overlap [start_time, end_time). All keys with timestamps in
+	// the range are iterated, and some out of it may be.
+	virtual Iterator *NewIterator(const ReadOptions &opts,
+				      int64_t start_time, int64_t end_time) = 0;
+
 	// Explicitly drop column families in which all keys are obsolete. This
-	// process is also inplicitly done in Put() operation.
+	// process is also done in a background thread, woken up by Put() and
+	// Delete() operations once a column family has expired.
 	virtual Status DropObsoleteColumnFamilies() = 0;
 
 	static const uint64_t kTSLength = sizeof(int64_t); // size of timestamp
@@ -26,7 +26,8 @@ namespace rocksdb
 // BEHAVIOUR:
 // TTL is accepted in seconds
 // (int32_t)Timestamp(creation) is suffixed to values in Put internally
-// Expired TTL values deleted in compaction only:(Timestamp+ttl<time_now)
+// Expired TTL values deleted in compaction:(Timestamp+ttl<time_now), or
+//  with their whole table file once all its values have expired
 // Get/Iterator may return expired entries(compaction not run on them yet)
 // Different TTL may be used during different Opens
 // Example: Open1 at t=0 with ttl=4 and insert k1,k2, close at t=2
@@ -51,6 +52,14 @@ class DBWithTTL : public StackableDB {
 				  const std::string &column_family_name,
 				  ColumnFamilyHandle **handle, int ttl) = 0;
 
+	// Drops, without compacting them, the table files of the column family
+	// all of whose values have expired, and marks those with about half of
+	// their values expired for compaction, which then favours them, within
+	// the last level for the files there. This is also done at open and
+	// after flushes, so is only needed when the db isn't written to. Not
+	// supported in read-only mode.
+	virtual Status DropExpiredFiles(ColumnFamilyHandle *column_family) = 0;
+
 	static Status Open(const Options &options, const std::string &dbname,
 			   DBWithTTL **dbptr, int32_t ttl = 0,
 			   bool read_only = false);
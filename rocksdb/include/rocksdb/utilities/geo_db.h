@@ -101,6 +101,13 @@ class GeoDB : public StackableDB {
 	// object being inserted here.
 	virtual Status Insert(const GeoObject &object) = 0;
 
+	// Insert all objects at once. Instead of going through the memtable
+	// and the WAL, they're sorted and written to a new table file which is
+	// then ingested into the db. This is much faster than Insert() for
+	// loading a large data set.
+	// REQUIRES: the ids are distinct and not in the db yet
+	virtual Status BulkInsert(const std::vector<GeoObject> &objects) = 0;
+
 	// Retrieve the value of the object located at the specified GPS
 	// location and is identified by the 'id'.
 	virtual Status GetByPosition(const GeoPosition &pos, const Slice &id,
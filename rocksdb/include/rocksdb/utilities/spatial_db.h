@@ -243,6 +243,15 @@ struct SpatialDBOptions {
 	bool bulk_load = true;
 };
 
+// An element loaded with SpatialDB::BulkInsert(). The fields are the same as
+// the arguments of SpatialDB::Insert()
+struct SpatialElement {
+	BoundingBox<double> bbox;
+	std::string blob;
+	FeatureSet feature_set;
+	std::vector<std::string> spatial_indexes;
+};
+
 // Cursor is used to return data from the query to the client. To get all the
 // data from the query, just call Next() while Valid() is true
 class Cursor {
@@ -322,6 +331,18 @@ class SpatialDB : public StackableDB {
 	       const FeatureSet &feature_set,
 	       const std::vector<std::string> &spatial_indexes) = 0;
 
+	// Insert all elements at once, the way Insert() would insert each of
+	// them. Instead of going through the memtable and the WAL, the index
+	// entries are computed and sorted on num_threads threads and written
+	// to one new table file per column family, which is then ingested
+	// into the DB. This is much faster for loading a large data set.
+	// Elements get consecutive ids, so they're laid out in the order given.
+	// If an error is returned, some column families may hold the elements
+	// and others not.
+	// REQUIRES: elements[i].spatial_indexes.size() > 0
+	virtual Status BulkInsert(const std::vector<SpatialElement> &elements,
+				  int num_threads = 1) = 0;
+
 	// Calling Compact() after inserting a bunch of elements should speed up
 	// reading. This is especially useful if you use SpatialDBOptions::bulk_load
 	// Num threads determines how many threads we'll use for compactions. Setting
@@ -212,6 +212,14 @@ class StackableDB : public DB {
 		return db_->GetAggregatedIntProperty(property, value);
 	}
 
+	virtual Status GetStatsHistory(
+		uint64_t start_time, uint64_t end_time,
+		std::unique_ptr<StatsHistoryIterator> *stats_iterator) override
+	{
+		return db_->GetStatsHistory(start_time, end_time,
+					    stats_iterator);
+	}
+
 	using DB::GetApproximateSizes;
 	virtual void
 	GetApproximateSizes(ColumnFamilyHandle *column_family, const Range *r,
@@ -419,6 +427,30 @@ class StackableDB : public DB {
 							 n, props);
 	}
 
+	virtual Status
+	StartTrace(const TraceOptions &options,
+		   std::unique_ptr<TraceWriter> &&writer) override
+	{
+		return db_->StartTrace(options, std::move(writer));
+	}
+
+	virtual Status EndTrace() override
+	{
+		return db_->EndTrace();
+	}
+
+	virtual Status
+	StartBlockCacheTrace(const TraceOptions &options,
+			     std::unique_ptr<TraceWriter> &&writer) override
+	{
+		return db_->StartBlockCacheTrace(options, std::move(writer));
+	}
+
+	virtual Status EndBlockCacheTrace() override
+	{
+		return db_->EndBlockCacheTrace();
+	}
+
 	virtual Status GetUpdatesSince(SequenceNumber seq_number,
 				       unique_ptr<TransactionLogIterator> *iter,
 				       const TransactionLogIterator::ReadOptions
@@ -42,7 +42,11 @@ public enum HistogramType {
   BYTES_DECOMPRESSED(27),
   COMPRESSION_TIMES_NANOS(28),
   DECOMPRESSION_TIMES_NANOS(29),
-  READ_NUM_MERGE_OPERANDS(30);
+  READ_NUM_MERGE_OPERANDS(30),
+
+  // The rate an auto-tuned rate limiter picks, in bytes per second, each
+  // time it re-tunes itself.
+  RATE_LIMITER_BYTES_PER_SEC(31);
 
   private final int value_;
 
@@ -0,0 +1,266 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include "monitoring/histogram_hdr.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <cassert>
+
+#include "port/port.h"
+
+namespace rocksdb
+{
+namespace
+{
+const int kMinSignificantDigits = 1;
+const int kMaxSignificantDigits = 3;
+
+// Number of leading zero bits; value must not be 0
+inline int CountLeadingZeros(uint64_t value)
+{
+	assert(value != 0);
+#if defined(__GNUC__)
+	return __builtin_clzll(value);
+#else
+	int n = 0;
+	while ((value & (uint64_t{ 1 } << 63)) == 0) {
+		value <<= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+} // namespace
+
+HdrHistogramStat::HdrHistogramStat(int significant_digits,
+				   uint64_t highest_trackable_value)
+	: significant_digits_(std::min(std::max(significant_digits,
+						kMinSignificantDigits),
+				       kMaxSignificantDigits)),
+	  highest_trackable_value_(highest_trackable_value)
+{
+	uint64_t largest_exact = 2;
+	for (int i = 0; i < significant_digits_; i++) {
+		largest_exact *= 10;
+	}
+	uint32_t sub_bucket_count_magnitude = 0;
+	while ((uint64_t{ 1 } << sub_bucket_count_magnitude) < largest_exact) {
+		sub_bucket_count_magnitude++;
+	}
+	sub_bucket_half_count_magnitude_ = sub_bucket_count_magnitude - 1;
+	sub_bucket_mask_ = (uint64_t{ 1 } << sub_bucket_count_magnitude) - 1;
+	// Bucket 0 covers [0, 2^m), bucket b > 0 the upper half of
+	// [0, 2^(m+b)); the last one reaches past the highest trackable
+	// value, at most to 2^64.
+	size_t bucket_count = 1;
+	for (uint32_t magnitude = sub_bucket_count_magnitude;
+	     magnitude < 64 &&
+	     (uint64_t{ 1 } << magnitude) <= highest_trackable_value_;
+	     magnitude++) {
+		bucket_count++;
+	}
+	counts_len_ = (bucket_count + 1)
+		      << sub_bucket_half_count_magnitude_;
+	counts_.reset(new std::atomic<uint64_t>[counts_len_]);
+	Clear();
+}
+
+void HdrHistogramStat::Clear()
+{
+	min_.store(port::kMaxUint64, std::memory_order_relaxed);
+	max_.store(0, std::memory_order_relaxed);
+	num_.store(0, std::memory_order_relaxed);
+	sum_.store(0, std::memory_order_relaxed);
+	sum_squares_.store(0, std::memory_order_relaxed);
+	for (size_t i = 0; i < counts_len_; i++) {
+		counts_[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+bool HdrHistogramStat::Empty() const
+{
+	return num() == 0;
+}
+
+size_t HdrHistogramStat::CountsIndex(uint64_t value) const
+{
+	if (value > highest_trackable_value_) {
+		return counts_len_ - 1;
+	}
+	const int bucket_index =
+		64 - CountLeadingZeros(value | sub_bucket_mask_) -
+		static_cast<int>(sub_bucket_half_count_magnitude_ + 1);
+	const uint64_t sub_bucket_index = value >> bucket_index;
+	return (static_cast<size_t>(bucket_index + 1)
+		<< sub_bucket_half_count_magnitude_) +
+	       static_cast<size_t>(sub_bucket_index) -
+	       (size_t{ 1 } << sub_bucket_half_count_magnitude_);
+}
+
+uint64_t HdrHistogramStat::LowestEquivalentValue(size_t index) const
+{
+	const size_t half_count = size_t{ 1 }
+				  << sub_bucket_half_count_magnitude_;
+	int bucket_index =
+		static_cast<int>(index >> sub_bucket_half_count_magnitude_) -
+		1;
+	uint64_t sub_bucket_index = (index & (half_count - 1)) + half_count;
+	if (bucket_index < 0) {
+		sub_bucket_index -= half_count;
+		bucket_index = 0;
+	}
+	return sub_bucket_index << bucket_index;
+}
+
+uint64_t HdrHistogramStat::HighestEquivalentValue(size_t index) const
+{
+	int bucket_index =
+		static_cast<int>(index >> sub_bucket_half_count_magnitude_) -
+		1;
+	if (bucket_index < 0) {
+		bucket_index = 0;
+	}
+	// Wraps to UINT64_MAX for the last bucket
+	return LowestEquivalentValue(index) + (uint64_t{ 1 } << bucket_index) -
+	       1;
+}
+
+void HdrHistogramStat::Add(uint64_t value)
+{
+	// Stores rather than atomic increments: see the class comment.
+	Bump(&counts_[CountsIndex(value)], 1);
+	if (value < min()) {
+		min_.store(value, std::memory_order_relaxed);
+	}
+	if (value > max()) {
+		max_.store(value, std::memory_order_relaxed);
+	}
+	Bump(&num_, 1);
+	Bump(&sum_, value);
+	const double v = static_cast<double>(value);
+	sum_squares_.store(sum_squares_.load(std::memory_order_relaxed) + v * v,
+			   std::memory_order_relaxed);
+}
+
+void HdrHistogramStat::Merge(const HdrHistogramStat &other)
+{
+	assert(significant_digits_ == other.significant_digits_);
+	assert(counts_len_ == other.counts_len_);
+	if (other.min() < min()) {
+		min_.store(other.min(), std::memory_order_relaxed);
+	}
+	if (other.max() > max()) {
+		max_.store(other.max(), std::memory_order_relaxed);
+	}
+	Bump(&num_, other.num());
+	Bump(&sum_, other.sum());
+	sum_squares_.store(sum_squares_.load(std::memory_order_relaxed) +
+				   other.sum_squares_.load(
+					   std::memory_order_relaxed),
+			   std::memory_order_relaxed);
+	for (size_t i = 0; i < counts_len_; i++) {
+		uint64_t count =
+			other.counts_[i].load(std::memory_order_relaxed);
+		if (count != 0) {
+			Bump(&counts_[i], count);
+		}
+	}
+}
+
+double HdrHistogramStat::Median() const
+{
+	return Percentile(50.0);
+}
+
+double HdrHistogramStat::Percentile(double p) const
+{
+	const uint64_t cur_num = num();
+	if (cur_num == 0) {
+		return 0;
+	}
+	// The smallest value at least p percent of the values are at or below
+	uint64_t threshold = static_cast<uint64_t>(
+		ceil(cur_num * (std::min(p, 100.0) / 100.0)));
+	threshold = std::max<uint64_t>(threshold, 1);
+	uint64_t cumulative = 0;
+	for (size_t i = 0; i < counts_len_; i++) {
+		cumulative += counts_[i].load(std::memory_order_relaxed);
+		if (cumulative >= threshold) {
+			uint64_t r = std::min(HighestEquivalentValue(i), max());
+			return static_cast<double>(std::max(r, min()));
+		}
+	}
+	// Counts raced ahead of num_
+	return static_cast<double>(max());
+}
+
+double HdrHistogramStat::Average() const
+{
+	uint64_t cur_num = num();
+	if (cur_num == 0) {
+		return 0;
+	}
+	return static_cast<double>(sum()) / static_cast<double>(cur_num);
+}
+
+double HdrHistogramStat::StandardDeviation() const
+{
+	uint64_t cur_num = num();
+	if (cur_num == 0) {
+		return 0;
+	}
+	double average = Average();
+	double variance = sum_squares_.load(std::memory_order_relaxed) /
+				  static_cast<double>(cur_num) -
+			  average * average;
+	return variance > 0 ? sqrt(variance) : 0;
+}
+
+void HdrHistogramStat::Data(HistogramData *const data) const
+{
+	assert(data);
+	data->median = Median();
+	data->percentile95 = Percentile(95);
+	data->percentile99 = Percentile(99);
+	data->percentile999 = Percentile(99.9);
+	data->percentile9999 = Percentile(99.99);
+	data->max = static_cast<double>(max());
+	data->average = Average();
+	data->standard_deviation = StandardDeviation();
+	data->count = num();
+	data->sum = sum();
+}
+
+std::string HdrHistogramStat::ToString() const
+{
+	uint64_t cur_num = num();
+	std::string r;
+	char buf[256];
+	snprintf(buf, sizeof(buf),
+		 "Count: %" PRIu64 " Average: %.4f  StdDev: %.2f\n", cur_num,
+		 Average(), StandardDeviation());
+	r.append(buf);
+	snprintf(buf, sizeof(buf),
+		 "Min: %" PRIu64 "  Median: %.4f  Max: %" PRIu64 "\n",
+		 (cur_num == 0 ? 0 : min()), Median(),
+		 (cur_num == 0 ? 0 : max()));
+	r.append(buf);
+	snprintf(buf, sizeof(buf),
+		 "Percentiles: "
+		 "P50: %.2f P75: %.2f P99: %.2f P99.9: %.2f P99.99: %.2f\n",
+		 Percentile(50), Percentile(75), Percentile(99),
+		 Percentile(99.9), Percentile(99.99));
+	r.append(buf);
+	return r;
+}
+
+} // namespace rocksdb
@@ -0,0 +1,116 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "port/port.h"
+#include "rocksdb/statistics.h"
+
+namespace rocksdb
+{
+// A high dynamic range histogram up to a highest trackable value: values
+// below 2 * 10^significant_digits get a bucket each, and every power of two
+// above that is cut into as many buckets again, so any recorded value is
+// known to within one part in 10^significant_digits. That keeps p99.9 and
+// p99.99 meaningful where HistogramStat's buckets are 50% wide. Larger
+// values are counted in the last bucket; min() and max() stay exact.
+//
+// Add() uses a relaxed load and a store on each counter rather than an
+// atomic read-modify-write, so it is meant to be fed by one thread at a
+// time, e.g. the one running on a core in a CoreLocalArray. Two threads
+// racing on the same histogram may lose a count, never corrupt it. Reads
+// and Merge() may run concurrently with Add().
+class HdrHistogramStat {
+    public:
+	// significant_digits is clamped to [1, 3]. The counters take
+	// 8 * (2 + log2(highest_trackable_value) - m) * 2^(m-1) bytes,
+	// m = ceil(log2(2 * 10^digits)). Over the whole uint64_t range that
+	// is 8KB for 1 digit, 58KB for 2 and 440KB for 3; up to an hour in
+	// microseconds 4KB, 26KB and 188KB.
+	explicit HdrHistogramStat(
+		int significant_digits,
+		uint64_t highest_trackable_value = port::kMaxUint64);
+
+	HdrHistogramStat(const HdrHistogramStat &) = delete;
+	HdrHistogramStat &operator=(const HdrHistogramStat &) = delete;
+
+	void Clear();
+	bool Empty() const;
+	void Add(uint64_t value);
+	// other must have the same number of significant digits and the
+	// same highest trackable value
+	void Merge(const HdrHistogramStat &other);
+
+	int significant_digits() const
+	{
+		return significant_digits_;
+	}
+	uint64_t highest_trackable_value() const
+	{
+		return highest_trackable_value_;
+	}
+	uint64_t min() const
+	{
+		return min_.load(std::memory_order_relaxed);
+	}
+	uint64_t max() const
+	{
+		return max_.load(std::memory_order_relaxed);
+	}
+	uint64_t num() const
+	{
+		return num_.load(std::memory_order_relaxed);
+	}
+	uint64_t sum() const
+	{
+		return sum_.load(std::memory_order_relaxed);
+	}
+
+	double Median() const;
+	// The highest value equivalent to the one at the percentile, so that
+	// the result is an upper bound within the precision.
+	double Percentile(double p) const;
+	double Average() const;
+	double StandardDeviation() const;
+	void Data(HistogramData *const data) const;
+	std::string ToString() const;
+
+	// Bucket layout, exposed for tests
+	size_t CountsIndex(uint64_t value) const;
+	uint64_t LowestEquivalentValue(size_t index) const;
+	uint64_t HighestEquivalentValue(size_t index) const;
+	size_t counts_len() const
+	{
+		return counts_len_;
+	}
+
+    private:
+	inline void Bump(std::atomic<uint64_t> *counter, uint64_t delta)
+	{
+		counter->store(counter->load(std::memory_order_relaxed) + delta,
+			       std::memory_order_relaxed);
+	}
+
+	const int significant_digits_;
+	const uint64_t highest_trackable_value_;
+	// 2^sub_bucket_half_count_magnitude_ buckets per power of two
+	uint32_t sub_bucket_half_count_magnitude_;
+	uint64_t sub_bucket_mask_;
+	size_t counts_len_;
+	std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+
+	std::atomic<uint64_t> min_;
+	std::atomic<uint64_t> max_;
+	std::atomic<uint64_t> num_;
+	std::atomic<uint64_t> sum_;
+	// As a double: squares of large values overflow 64 bits
+	std::atomic<double> sum_squares_;
+};
+
+} // namespace rocksdb
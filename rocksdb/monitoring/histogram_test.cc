@@ -6,7 +6,9 @@
 #include <cmath>
 
 #include "monitoring/histogram.h"
+#include "monitoring/histogram_hdr.h"
 #include "monitoring/histogram_windowing.h"
+#include "port/port.h"
 #include "util/testharness.h"
 
 namespace rocksdb
@@ -126,6 +128,102 @@ TEST_F(HistogramTest, ClearHistogram)
 	ClearHistogram(histogramWindowing);
 }
 
+TEST_F(HistogramTest, HdrBucketLayout)
+{
+	for (int digits = 1; digits <= 3; digits++) {
+		HdrHistogramStat hist(digits);
+		double precision = pow(10.0, -digits);
+		size_t prev_index = 0;
+		for (uint64_t value = 0; value < 100000;
+		     value += 1 + value / 7) {
+			size_t index = hist.CountsIndex(value);
+			ASSERT_LT(index, hist.counts_len());
+			ASSERT_GE(index, prev_index);
+			prev_index = index;
+			ASSERT_LE(hist.LowestEquivalentValue(index), value);
+			ASSERT_GE(hist.HighestEquivalentValue(index), value);
+			ASSERT_LE(hist.HighestEquivalentValue(index) -
+					  hist.LowestEquivalentValue(index),
+				  value * precision);
+		}
+		size_t last = hist.CountsIndex(port::kMaxUint64);
+		ASSERT_EQ(hist.counts_len() - 1, last);
+		ASSERT_EQ(port::kMaxUint64, hist.HighestEquivalentValue(last));
+	}
+	// Clamped
+	ASSERT_EQ(3, HdrHistogramStat(10).significant_digits());
+	ASSERT_EQ(1, HdrHistogramStat(0).significant_digits());
+}
+
+TEST_F(HistogramTest, HdrHighestTrackableValue)
+{
+	const uint64_t kHour = 3600ull * 1000 * 1000;
+	HdrHistogramStat full(3);
+	HdrHistogramStat hist(3, kHour);
+	ASSERT_EQ(kHour, hist.highest_trackable_value());
+	ASSERT_LT(hist.counts_len() * 2, full.counts_len());
+	for (uint64_t value = 0; value <= kHour; value += 1 + value / 3) {
+		ASSERT_EQ(full.CountsIndex(value), hist.CountsIndex(value));
+	}
+	ASSERT_GE(hist.HighestEquivalentValue(hist.counts_len() - 1), kHour);
+
+	// Larger values land in the last bucket, the extremes stay exact
+	ASSERT_EQ(hist.counts_len() - 1, hist.CountsIndex(port::kMaxUint64));
+	hist.Add(10);
+	hist.Add(100 * kHour);
+	ASSERT_EQ(10U, hist.min());
+	ASSERT_EQ(100 * kHour, hist.max());
+	ASSERT_EQ(10, hist.Percentile(50));
+	ASSERT_GE(hist.Percentile(100), kHour);
+	ASSERT_LE(hist.Percentile(100), 100 * kHour);
+}
+
+TEST_F(HistogramTest, HdrTailPercentiles)
+{
+	// 1..1000000: a tail the default buckets can only place within 50%
+	HdrHistogramStat hist(3);
+	ASSERT_TRUE(hist.Empty());
+	ASSERT_EQ(0, hist.Percentile(99.9));
+	for (uint64_t i = 1; i <= 1000000; i++) {
+		hist.Add(i);
+	}
+	ASSERT_FALSE(hist.Empty());
+	ASSERT_EQ(1U, hist.min());
+	ASSERT_EQ(1000000U, hist.max());
+	ASSERT_NEAR(500000.5, hist.Average(), kIota);
+	ASSERT_NEAR(288675, hist.StandardDeviation(), 1);
+
+	HistogramData data;
+	hist.Data(&data);
+	ASSERT_NEAR(500000, data.median, 500000 * 1e-3);
+	ASSERT_NEAR(990000, data.percentile99, 990000 * 1e-3);
+	ASSERT_NEAR(999000, data.percentile999, 999000 * 1e-3);
+	ASSERT_NEAR(999900, data.percentile9999, 999900 * 1e-3);
+	ASSERT_GE(data.percentile9999, 999900);
+	ASSERT_EQ(1000000, data.max);
+
+	hist.Clear();
+	ASSERT_TRUE(hist.Empty());
+	ASSERT_EQ(0, hist.Percentile(50));
+}
+
+TEST_F(HistogramTest, HdrMerge)
+{
+	HdrHistogramStat hist(2);
+	HdrHistogramStat other(2);
+	for (uint64_t i = 1; i <= 100; i++) {
+		hist.Add(i);
+		other.Add(i * 1000);
+	}
+	hist.Merge(other);
+	ASSERT_EQ(200U, hist.num());
+	ASSERT_EQ(1U, hist.min());
+	ASSERT_EQ(100000U, hist.max());
+	ASSERT_EQ(100U, hist.Percentile(50));
+	ASSERT_NEAR(50000, hist.Percentile(75), 50000 * 1e-2);
+	ASSERT_EQ(100000, hist.Percentile(100));
+}
+
 TEST_F(HistogramTest, HistogramWindowingExpire)
 {
 	uint64_t num_windows = 3;
@@ -40,6 +40,12 @@ void InstrumentedMutex::LockInternal()
 #ifndef NDEBUG
 	ThreadStatusUtil::TEST_StateDelay(ThreadStatus::STATE_MUTEX_WAIT);
 #endif
+	// Only a lock that has to wait is a wait event
+	if (mutex_.TryLock()) {
+		return;
+	}
+	AutoThreadStateUpdater state_updater(ThreadStatus::STATE_MUTEX_WAIT,
+					     env_);
 	mutex_.Lock();
 }
 
@@ -61,6 +67,8 @@ void InstrumentedCondVar::Wait()
 
 void InstrumentedCondVar::WaitInternal()
 {
+	AutoThreadStateUpdater state_updater(ThreadStatus::STATE_MUTEX_WAIT,
+					     env_);
 #ifndef NDEBUG
 	ThreadStatusUtil::TEST_StateDelay(ThreadStatus::STATE_MUTEX_WAIT);
 #endif
@@ -87,6 +95,8 @@ bool InstrumentedCondVar::TimedWait(uint64_t abs_time_us)
 
 bool InstrumentedCondVar::TimedWaitInternal(uint64_t abs_time_us)
 {
+	AutoThreadStateUpdater state_updater(ThreadStatus::STATE_MUTEX_WAIT,
+					     env_);
 #ifndef NDEBUG
 	ThreadStatusUtil::TEST_StateDelay(ThreadStatus::STATE_MUTEX_WAIT);
 #endif
@@ -99,14 +99,52 @@ void PerfContext::Reset()
 	env_lock_file_nanos = 0;
 	env_unlock_file_nanos = 0;
 	env_new_logger_nanos = 0;
+	ClearPerLevelPerfContext();
 #endif
 }
 
+void PerfContextByLevel::Reset()
+{
+#ifndef NPERF_CONTEXT
+	bloom_filter_useful = 0;
+	bloom_filter_full_positive = 0;
+	bloom_filter_full_true_positive = 0;
+	block_cache_hit_count = 0;
+	block_cache_miss_count = 0;
+	block_read_count = 0;
+	block_read_byte = 0;
+	block_read_time = 0;
+#endif
+}
+
+void PerfContext::ClearPerLevelPerfContext()
+{
+	for (int level = 0; level < kPerfContextMaxLevels; level++) {
+		level_perf_context[level].Reset();
+	}
+}
+
 #define PERF_CONTEXT_OUTPUT(counter)                                           \
 	if (!exclude_zero_counters || (counter > 0)) {                         \
 		ss << #counter << " = " << counter << ", ";                    \
 	}
 
+// "counter = 1@level0, 5@level2, "
+#define PERF_CONTEXT_BY_LEVEL_OUTPUT(counter)                                  \
+	{                                                                      \
+		std::ostringstream level_ss;                                   \
+		for (int level = 0; level < kPerfContextMaxLevels; level++) {  \
+			uint64_t value = level_perf_context[level].counter;    \
+			if (!exclude_zero_counters || value > 0) {             \
+				level_ss << value << "@level" << level         \
+					 << ", ";                              \
+			}                                                      \
+		}                                                              \
+		if (!level_ss.str().empty()) {                                 \
+			ss << #counter << " = " << level_ss.str();             \
+		}                                                              \
+	}
+
 std::string PerfContext::ToString(bool exclude_zero_counters) const
 {
 #ifdef NPERF_CONTEXT
@@ -175,6 +213,16 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const
 	PERF_CONTEXT_OUTPUT(env_lock_file_nanos);
 	PERF_CONTEXT_OUTPUT(env_unlock_file_nanos);
 	PERF_CONTEXT_OUTPUT(env_new_logger_nanos);
+	if (per_level_perf_context_enabled) {
+		PERF_CONTEXT_BY_LEVEL_OUTPUT(bloom_filter_useful);
+		PERF_CONTEXT_BY_LEVEL_OUTPUT(bloom_filter_full_positive);
+		PERF_CONTEXT_BY_LEVEL_OUTPUT(bloom_filter_full_true_positive);
+		PERF_CONTEXT_BY_LEVEL_OUTPUT(block_cache_hit_count);
+		PERF_CONTEXT_BY_LEVEL_OUTPUT(block_cache_miss_count);
+		PERF_CONTEXT_BY_LEVEL_OUTPUT(block_read_count);
+		PERF_CONTEXT_BY_LEVEL_OUTPUT(block_read_byte);
+		PERF_CONTEXT_BY_LEVEL_OUTPUT(block_read_time);
+	}
 	return ss.str();
 #endif
 }
@@ -18,6 +18,8 @@ namespace rocksdb
 #define PERF_TIMER_STOP(metric)
 #define PERF_TIMER_START(metric)
 #define PERF_COUNTER_ADD(metric, value)
+#define PERF_TIMER_BY_LEVEL_GUARD(metric, level)
+#define PERF_COUNTER_BY_LEVEL_ADD(metric, value, level)
 
 #else
 
@@ -48,6 +50,39 @@ namespace rocksdb
 		get_perf_context()->metric += value;                           \
 	}
 
+// The counters of the LSM level, or nullptr when they are not collected or
+// the level is unknown (-1)
+inline PerfContextByLevel *GetPerfContextByLevel(int level)
+{
+	PerfContext *ctx = get_perf_context();
+	if (!ctx->per_level_perf_context_enabled || level < 0) {
+		return nullptr;
+	}
+	return &ctx->level_perf_context[level < kPerfContextMaxLevels ?
+						level :
+						kPerfContextMaxLevels - 1];
+}
+
+// Like PERF_TIMER_GUARD, into the counters of an LSM level
+#define PERF_TIMER_BY_LEVEL_GUARD(metric, level)                               \
+	PerfContextByLevel *perf_by_level_##metric =                           \
+		GetPerfContextByLevel(level);                                  \
+	PerfStepTimer perf_step_timer_by_level_##metric(                       \
+		perf_by_level_##metric ? &perf_by_level_##metric->metric :     \
+					 nullptr);                             \
+	if (perf_by_level_##metric != nullptr) {                               \
+		perf_step_timer_by_level_##metric.Start();                     \
+	}
+
+#define PERF_COUNTER_BY_LEVEL_ADD(metric, value, level)                        \
+	if (perf_level >= PerfLevel::kEnableCount) {                           \
+		PerfContextByLevel *perf_by_level =                            \
+			GetPerfContextByLevel(level);                          \
+		if (perf_by_level != nullptr) {                                \
+			perf_by_level->metric += value;                        \
+		}                                                              \
+	}
+
 #endif
 
 } // namespace rocksdb
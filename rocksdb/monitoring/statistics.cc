@@ -22,15 +22,45 @@ std::shared_ptr<Statistics> CreateDBStatistics()
 	return std::make_shared<StatisticsImpl>(nullptr, false);
 }
 
+std::shared_ptr<Statistics>
+CreateDBStatistics(int histogram_significant_digits,
+		   uint64_t histogram_highest_trackable_value)
+{
+	return std::make_shared<StatisticsImpl>(
+		nullptr, false, std::max(histogram_significant_digits, 1),
+		histogram_highest_trackable_value);
+}
+
 StatisticsImpl::StatisticsImpl(std::shared_ptr<Statistics> stats,
-			       bool enable_internal_stats)
+			       bool enable_internal_stats,
+			       int histogram_significant_digits,
+			       uint64_t histogram_highest_trackable_value)
 	: stats_(std::move(stats)),
-	  enable_internal_stats_(enable_internal_stats)
+	  enable_internal_stats_(enable_internal_stats),
+	  histogram_significant_digits_(histogram_significant_digits),
+	  histogram_highest_trackable_value_(
+		  histogram_highest_trackable_value)
 {
+	if (histogram_significant_digits_ > 0) {
+		per_core_hdr_.reset(new CoreLocalArray<HdrHistogramData>());
+		hdr_aggregate_.reset(new HdrHistogramStat(
+			histogram_significant_digits_,
+			histogram_highest_trackable_value_));
+	}
 }
 
 StatisticsImpl::~StatisticsImpl()
 {
+	if (per_core_hdr_) {
+		for (size_t core_idx = 0; core_idx < per_core_hdr_->Size();
+		     ++core_idx) {
+			HdrHistogramData *data =
+				per_core_hdr_->AccessAtCore(core_idx);
+			for (auto &hist : data->histograms_) {
+				delete hist.load(std::memory_order_relaxed);
+			}
+		}
+	}
 }
 
 uint64_t StatisticsImpl::getTickerCount(uint32_t tickerType) const
@@ -56,7 +86,17 @@ void StatisticsImpl::histogramData(uint32_t histogramType,
 				   HistogramData *const data) const
 {
 	MutexLock lock(&aggregate_lock_);
-	getHistogramImplLocked(histogramType)->Data(data);
+	histogramDataLocked(histogramType, data);
+}
+
+void StatisticsImpl::histogramDataLocked(uint32_t histogramType,
+					 HistogramData *const data) const
+{
+	if (per_core_hdr_) {
+		getHdrHistogramLocked(histogramType)->Data(data);
+	} else {
+		getHistogramImplLocked(histogramType)->Data(data);
+	}
 }
 
 std::unique_ptr<HistogramImpl>
@@ -74,9 +114,33 @@ StatisticsImpl::getHistogramImplLocked(uint32_t histogramType) const
 	return res_hist;
 }
 
+const HdrHistogramStat *
+StatisticsImpl::getHdrHistogramLocked(uint32_t histogramType) const
+{
+	assert(enable_internal_stats_ ?
+			     histogramType < INTERNAL_HISTOGRAM_ENUM_MAX :
+			     histogramType < HISTOGRAM_ENUM_MAX);
+	HdrHistogramStat *res_hist = hdr_aggregate_.get();
+	res_hist->Clear();
+	for (size_t core_idx = 0; core_idx < per_core_hdr_->Size();
+	     ++core_idx) {
+		const HdrHistogramStat *hist =
+			per_core_hdr_->AccessAtCore(core_idx)
+				->histograms_[histogramType]
+				.load(std::memory_order_acquire);
+		if (hist != nullptr) {
+			res_hist->Merge(*hist);
+		}
+	}
+	return res_hist;
+}
+
 std::string StatisticsImpl::getHistogramString(uint32_t histogramType) const
 {
 	MutexLock lock(&aggregate_lock_);
+	if (per_core_hdr_) {
+		return getHdrHistogramLocked(histogramType)->ToString();
+	}
 	return getHistogramImplLocked(histogramType)->ToString();
 }
 
@@ -144,7 +208,26 @@ void StatisticsImpl::measureTime(uint32_t histogramType, uint64_t value)
 	assert(enable_internal_stats_ ?
 			     histogramType < INTERNAL_HISTOGRAM_ENUM_MAX :
 			     histogramType < HISTOGRAM_ENUM_MAX);
-	per_core_stats_.Access()->histograms_[histogramType].Add(value);
+	if (per_core_hdr_) {
+		std::atomic<HdrHistogramStat *> &slot =
+			per_core_hdr_->Access()->histograms_[histogramType];
+		HdrHistogramStat *hist = slot.load(std::memory_order_acquire);
+		if (UNLIKELY(hist == nullptr)) {
+			HdrHistogramStat *expected = nullptr;
+			hist = new HdrHistogramStat(
+				histogram_significant_digits_,
+				histogram_highest_trackable_value_);
+			if (!slot.compare_exchange_strong(expected, hist)) {
+				// Another thread on this core got there first
+				delete hist;
+				hist = expected;
+			}
+		}
+		hist->Add(value);
+	} else {
+		per_core_stats_.Access()->histograms_[histogramType].Add(
+			value);
+	}
 	if (stats_ && histogramType < HISTOGRAM_ENUM_MAX) {
 		stats_->measureTime(histogramType, value);
 	}
@@ -163,6 +246,19 @@ Status StatisticsImpl::Reset()
 				->histograms_[i]
 				.Clear();
 		}
+		if (per_core_hdr_) {
+			for (size_t core_idx = 0;
+			     core_idx < per_core_hdr_->Size(); ++core_idx) {
+				HdrHistogramData *data =
+					per_core_hdr_->AccessAtCore(core_idx);
+				HdrHistogramStat *hist =
+					data->histograms_[i].load(
+						std::memory_order_acquire);
+				if (hist != nullptr) {
+					hist->Clear();
+				}
+			}
+		}
 	}
 	return Status::OK();
 }
@@ -192,7 +288,7 @@ std::string StatisticsImpl::ToString() const
 		if (h.first < HISTOGRAM_ENUM_MAX || enable_internal_stats_) {
 			char buffer[kTmpStrBufferSize];
 			HistogramData hData;
-			getHistogramImplLocked(h.first)->Data(&hData);
+			histogramDataLocked(h.first, &hData);
 			snprintf(
 				buffer, kTmpStrBufferSize,
 				"%s statistics Percentiles :=> 50 : %f 95 : %f 99 : %f 100 : %f\n",
@@ -11,6 +11,7 @@
 #include <string>
 
 #include "monitoring/histogram.h"
+#include "monitoring/histogram_hdr.h"
 #include "port/likely.h"
 #include "port/port.h"
 #include "util/core_local.h"
@@ -36,8 +37,13 @@ enum HistogramsInternal : uint32_t {
 
 class StatisticsImpl : public Statistics {
     public:
+	// With histogram_significant_digits > 0 the histograms are
+	// HdrHistogramStats of that precision and highest trackable value.
 	StatisticsImpl(std::shared_ptr<Statistics> stats,
-		       bool enable_internal_stats);
+		       bool enable_internal_stats,
+		       int histogram_significant_digits = 0,
+		       uint64_t histogram_highest_trackable_value =
+			       kDefaultHistogramHighestTrackableValue);
 	virtual ~StatisticsImpl();
 
 	virtual uint64_t getTickerCount(uint32_t ticker_type) const override;
@@ -89,9 +95,37 @@ class StatisticsImpl : public Statistics {
 
 	CoreLocalArray<StatisticsData> per_core_stats_;
 
+	// Used instead of StatisticsData::histograms_ when
+	// histogram_significant_digits_ > 0. A core allocates the histogram
+	// of a type the first time it records one, so that the types never
+	// recorded, and the cores never recording, cost nothing.
+	struct HdrHistogramData {
+		std::atomic<HdrHistogramStat *>
+			histograms_[INTERNAL_HISTOGRAM_ENUM_MAX] = {
+				{ nullptr }
+			};
+		char padding[(CACHE_LINE_SIZE -
+			      (INTERNAL_HISTOGRAM_ENUM_MAX *
+			       sizeof(std::atomic<HdrHistogramStat *>)) %
+				      CACHE_LINE_SIZE) %
+			     CACHE_LINE_SIZE] ROCKSDB_FIELD_UNUSED;
+	};
+
+	const int histogram_significant_digits_;
+	const uint64_t histogram_highest_trackable_value_;
+	std::unique_ptr<CoreLocalArray<HdrHistogramData> > per_core_hdr_;
+	// The per-core histograms of a type are merged into this one for a
+	// read, under aggregate_lock_, instead of into a new one each time.
+	std::unique_ptr<HdrHistogramStat> hdr_aggregate_;
+
 	uint64_t getTickerCountLocked(uint32_t ticker_type) const;
 	std::unique_ptr<HistogramImpl>
 	getHistogramImplLocked(uint32_t histogram_type) const;
+	// Valid until the next call; aggregate_lock_ must be held.
+	const HdrHistogramStat *
+	getHdrHistogramLocked(uint32_t histogram_type) const;
+	void histogramDataLocked(uint32_t histogram_type,
+				 HistogramData *const data) const;
 	void setTickerCountLocked(uint32_t ticker_type, uint64_t count);
 };
 
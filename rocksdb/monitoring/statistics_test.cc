@@ -28,6 +28,56 @@ TEST_F(StatisticsTest, Sanity)
 	}
 }
 
+TEST_F(StatisticsTest, HdrHistograms)
+{
+	std::shared_ptr<Statistics> stats = CreateDBStatistics(3);
+	for (uint64_t i = 1; i <= 100000; i++) {
+		stats->measureTime(DB_GET, i);
+	}
+	stats->measureTime(DB_WRITE, 7);
+
+	HistogramData data;
+	stats->histogramData(DB_GET, &data);
+	ASSERT_NEAR(50000, data.median, 50);
+	ASSERT_NEAR(99900, data.percentile999, 100);
+	ASSERT_NEAR(99990, data.percentile9999, 100);
+	ASSERT_EQ(100000, data.max);
+	stats->histogramData(DB_WRITE, &data);
+	ASSERT_EQ(7, data.median);
+	ASSERT_EQ(7, data.percentile9999);
+	ASSERT_NE(std::string::npos,
+		  stats->getHistogramString(DB_GET).find("P99.99"));
+
+	ASSERT_OK(stats->Reset());
+	stats->histogramData(DB_GET, &data);
+	ASSERT_EQ(0, data.percentile9999);
+	ASSERT_EQ(0, data.max);
+
+	// Reads reuse one aggregate; each sees only its own type
+	for (int i = 0; i < 3; i++) {
+		stats->histogramData(DB_WRITE, &data);
+		ASSERT_EQ(0U, data.count);
+		stats->measureTime(DB_GET, 5);
+		stats->histogramData(DB_GET, &data);
+		ASSERT_EQ(static_cast<uint64_t>(i + 1), data.count);
+	}
+}
+
+TEST_F(StatisticsTest, HdrHistogramsHighestTrackableValue)
+{
+	std::shared_ptr<Statistics> stats = CreateDBStatistics(2, 1000);
+	for (uint64_t i = 1; i <= 100; i++) {
+		stats->measureTime(DB_GET, i);
+	}
+	stats->measureTime(DB_GET, 1000000);
+	HistogramData data;
+	stats->histogramData(DB_GET, &data);
+	ASSERT_NEAR(50, data.median, 1);
+	ASSERT_EQ(1000000, data.max);
+	ASSERT_GE(data.percentile9999, 1000);
+	ASSERT_LE(data.percentile9999, 1000000);
+}
+
 } // namespace rocksdb
 
 int main(int argc, char **argv)
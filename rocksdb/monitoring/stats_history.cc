@@ -0,0 +1,441 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/stats_history.h"
+
+#include <algorithm>
+
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/file_reader_writer.h"
+#include "util/logging.h"
+
+namespace rocksdb
+{
+namespace
+{
+const size_t kStatsHistoryRecordHeaderSize = 8;
+
+class InMemoryStatsHistoryIterator : public StatsHistoryIterator {
+    public:
+	explicit InMemoryStatsHistoryIterator(
+		std::vector<StatsSnapshot> &&snapshots)
+		: snapshots_(std::move(snapshots)), pos_(0)
+	{
+	}
+
+	virtual bool Valid() const override
+	{
+		return pos_ < snapshots_.size();
+	}
+
+	virtual void Next() override
+	{
+		assert(Valid());
+		pos_++;
+	}
+
+	virtual uint64_t GetStatsTime() const override
+	{
+		assert(Valid());
+		return snapshots_[pos_].time_micros;
+	}
+
+	virtual const std::map<std::string, uint64_t> &
+	GetStatsMap() const override
+	{
+		assert(Valid());
+		return snapshots_[pos_].stats;
+	}
+
+	virtual Status status() const override
+	{
+		return Status::OK();
+	}
+
+    private:
+	std::vector<StatsSnapshot> snapshots_;
+	size_t pos_;
+};
+} // namespace
+
+StatsHistoryFileWriter::StatsHistoryFileWriter(
+	Env *env, const EnvOptions &env_options, const std::string &path,
+	size_t max_file_size, std::unique_ptr<WritableFileWriter> &&file_writer,
+	uint64_t file_size)
+	: env_(env), env_options_(env_options), path_(path),
+	  max_file_size_(max_file_size), file_writer_(std::move(file_writer)),
+	  file_size_(file_size)
+{
+}
+
+StatsHistoryFileWriter::~StatsHistoryFileWriter()
+{
+	if (file_writer_ != nullptr) {
+		file_writer_->Close();
+	}
+}
+
+Status StatsHistoryFileWriter::RollFile()
+{
+	Status s = file_writer_->Close();
+	file_writer_.reset();
+	if (s.ok()) {
+		s = env_->RenameFile(path_, OldStatsHistoryFileName(path_));
+	}
+	if (!s.ok()) {
+		return s;
+	}
+	unique_ptr<WritableFile> file;
+	s = env_->NewWritableFile(path_, &file, env_options_);
+	if (!s.ok()) {
+		return s;
+	}
+	file_writer_.reset(
+		new WritableFileWriter(std::move(file), env_options_));
+	file_size_ = 0;
+	// Each file starts with the names of its snapshots
+	names_.clear();
+	return s;
+}
+
+Status StatsHistoryFileWriter::AddRecord(const std::string &payload)
+{
+	char header[kStatsHistoryRecordHeaderSize];
+	EncodeFixed32(header, static_cast<uint32_t>(payload.size()));
+	EncodeFixed32(header + 4, crc32c::Mask(crc32c::Value(payload.data(),
+							      payload.size())));
+	Status s = file_writer_->Append(Slice(header, sizeof(header)));
+	if (s.ok()) {
+		s = file_writer_->Append(payload);
+	}
+	if (s.ok()) {
+		file_size_ += sizeof(header) + payload.size();
+	}
+	return s;
+}
+
+Status StatsHistoryFileWriter::Append(const StatsSnapshot &snapshot)
+{
+	if (file_writer_ == nullptr) {
+		return Status::IOError("Stats history file failed to roll over",
+				       path_);
+	}
+	if (max_file_size_ > 0 && file_size_ >= max_file_size_) {
+		Status s = RollFile();
+		if (!s.ok()) {
+			return s;
+		}
+	}
+	bool same_names = names_.size() == snapshot.stats.size();
+	if (same_names) {
+		size_t i = 0;
+		for (const auto &entry : snapshot.stats) {
+			if (entry.first != names_[i++]) {
+				same_names = false;
+				break;
+			}
+		}
+	}
+	Status s;
+	if (!same_names) {
+		names_.clear();
+		std::string payload;
+		payload.push_back(kStatsHistoryNames);
+		PutVarint32(&payload,
+			    static_cast<uint32_t>(snapshot.stats.size()));
+		for (const auto &entry : snapshot.stats) {
+			PutLengthPrefixedSlice(&payload, entry.first);
+			names_.push_back(entry.first);
+		}
+		s = AddRecord(payload);
+	}
+	if (s.ok()) {
+		std::string payload;
+		payload.push_back(kStatsHistorySnapshot);
+		PutFixed64(&payload, snapshot.time_micros);
+		for (const auto &entry : snapshot.stats) {
+			PutVarint64(&payload, entry.second);
+		}
+		s = AddRecord(payload);
+	}
+	if (s.ok()) {
+		s = file_writer_->Flush();
+	}
+	return s;
+}
+
+std::string OldStatsHistoryFileName(const std::string &path)
+{
+	return path + ".old";
+}
+
+Status
+NewStatsHistoryFileWriter(Env *env, const EnvOptions &env_options,
+			const std::string &path, size_t max_file_size,
+			std::unique_ptr<StatsHistoryFileWriter> *writer)
+{
+	uint64_t file_size = 0;
+	if (!env->GetFileSize(path, &file_size).ok()) {
+		// Not there yet
+		file_size = 0;
+	}
+	unique_ptr<WritableFile> file;
+	Status s = env->ReopenWritableFile(path, &file, env_options);
+	if (!s.ok()) {
+		return s;
+	}
+	std::unique_ptr<WritableFileWriter> file_writer(
+		new WritableFileWriter(std::move(file), env_options));
+	writer->reset(new StatsHistoryFileWriter(env, env_options, path,
+						 max_file_size,
+						 std::move(file_writer),
+						 file_size));
+	return s;
+}
+
+StatsHistoryFileReader::StatsHistoryFileReader(
+	std::unique_ptr<SequentialFileReader> &&file_reader)
+	: file_reader_(std::move(file_reader))
+{
+}
+
+StatsHistoryFileReader::~StatsHistoryFileReader()
+{
+}
+
+Status StatsHistoryFileReader::ReadRecord(std::string *payload)
+{
+	char header[kStatsHistoryRecordHeaderSize];
+	Slice result;
+	Status s = file_reader_->Read(sizeof(header), &result, header);
+	if (!s.ok()) {
+		return s;
+	}
+	if (result.size() < sizeof(header)) {
+		// End of the file, or a record cut short by a crash
+		return Status::Incomplete("End of stats history file");
+	}
+	const uint32_t size = DecodeFixed32(result.data());
+	const uint32_t crc = crc32c::Unmask(DecodeFixed32(result.data() + 4));
+	payload->resize(size);
+	if (size > 0) {
+		s = file_reader_->Read(size, &result, &(*payload)[0]);
+		if (!s.ok()) {
+			return s;
+		}
+		if (result.size() < size) {
+			return Status::Incomplete("End of stats history file");
+		}
+		payload->assign(result.data(), result.size());
+	}
+	if (size == 0 || crc32c::Value(payload->data(), size) != crc) {
+		return Status::Corruption("Bad stats history record");
+	}
+	return s;
+}
+
+Status StatsHistoryFileReader::Next(StatsSnapshot *snapshot)
+{
+	std::string payload;
+	while (true) {
+		Status s = ReadRecord(&payload);
+		if (!s.ok()) {
+			return s;
+		}
+		Slice input(payload);
+		const char type = input[0];
+		input.remove_prefix(1);
+		if (type == kStatsHistoryNames) {
+			uint32_t count = 0;
+			if (!GetVarint32(&input, &count)) {
+				return Status::Corruption(
+					"Bad stats history names");
+			}
+			names_.clear();
+			for (uint32_t i = 0; i < count; i++) {
+				Slice name;
+				if (!GetLengthPrefixedSlice(&input, &name)) {
+					return Status::Corruption(
+						"Bad stats history names");
+				}
+				names_.push_back(name.ToString());
+			}
+		} else if (type == kStatsHistorySnapshot) {
+			snapshot->stats.clear();
+			if (!GetFixed64(&input, &snapshot->time_micros)) {
+				return Status::Corruption(
+					"Bad stats history snapshot");
+			}
+			for (const std::string &name : names_) {
+				uint64_t value;
+				if (!GetVarint64(&input, &value)) {
+					return Status::Corruption(
+						"Bad stats history snapshot");
+				}
+				snapshot->stats.emplace(name, value);
+			}
+			return Status::OK();
+		}
+		// Skip records of unknown types
+	}
+}
+
+Status
+NewStatsHistoryFileReader(Env *env, const EnvOptions &env_options,
+			const std::string &path,
+			std::unique_ptr<StatsHistoryFileReader> *reader)
+{
+	unique_ptr<SequentialFile> file;
+	Status s = env->NewSequentialFile(path, &file, env_options);
+	if (!s.ok()) {
+		return s;
+	}
+	std::unique_ptr<SequentialFileReader> file_reader(
+		new SequentialFileReader(std::move(file)));
+	reader->reset(new StatsHistoryFileReader(std::move(file_reader)));
+	return s;
+}
+
+StatsHistory::StatsHistory(
+	Env *env, uint64_t period_micros, size_t buffer_size,
+	std::unique_ptr<StatsHistoryFileWriter> &&file_writer,
+	Collector collector, Logger *info_log)
+	: env_(env), period_micros_(period_micros), buffer_size_(buffer_size),
+	  collector_(std::move(collector)), info_log_(info_log),
+	  file_writer_(std::move(file_writer)), cv_(&mu_), closing_(false),
+	  snapshots_charge_(0)
+{
+}
+
+StatsHistory::~StatsHistory()
+{
+	Stop();
+}
+
+void StatsHistory::Start()
+{
+	{
+		// The first snapshot has the change since now
+		std::lock_guard<std::mutex> lock(snapshot_mu_);
+		StatsMap gauges;
+		collector_(&last_counters_, &gauges);
+	}
+	bg_thread_.reset(
+		new port::Thread(&StatsHistory::BackgroundThread, this));
+}
+
+void StatsHistory::Stop()
+{
+	{
+		InstrumentedMutexLock l(&mu_);
+		closing_ = true;
+		cv_.SignalAll();
+	}
+	if (bg_thread_) {
+		bg_thread_->join();
+		bg_thread_.reset();
+	}
+}
+
+void StatsHistory::BackgroundThread()
+{
+	InstrumentedMutexLock l(&mu_);
+	uint64_t next_time = env_->NowMicros() + period_micros_;
+	while (!closing_) {
+		cv_.TimedWait(next_time);
+		if (closing_) {
+			break;
+		}
+		uint64_t now = env_->NowMicros();
+		if (now < next_time) {
+			continue;
+		}
+		mu_.Unlock();
+		TakeSnapshot();
+		mu_.Lock();
+		// Skip the periods missed, if any, rather than catch up
+		next_time = std::max(next_time + period_micros_, now + 1);
+	}
+}
+
+size_t StatsHistory::SnapshotCharge(const StatsSnapshot &snapshot)
+{
+	// Estimated size of a std::map node besides the key data
+	const size_t kMapNodeOverhead = 64;
+	size_t charge = sizeof(StatsSnapshot);
+	for (const auto &entry : snapshot.stats) {
+		charge += kMapNodeOverhead + entry.first.size();
+	}
+	return charge;
+}
+
+void StatsHistory::TakeSnapshot()
+{
+	std::lock_guard<std::mutex> lock(snapshot_mu_);
+	StatsMap counters;
+	StatsMap gauges;
+	collector_(&counters, &gauges);
+
+	StatsSnapshot snapshot;
+	snapshot.time_micros = env_->NowMicros();
+	for (const auto &entry : counters) {
+		auto last = last_counters_.find(entry.first);
+		uint64_t last_value =
+			last == last_counters_.end() ? 0 : last->second;
+		// A counter below its last value has been reset
+		snapshot.stats.emplace(entry.first,
+				       entry.second >= last_value ?
+					       entry.second - last_value :
+					       entry.second);
+	}
+	snapshot.stats.insert(gauges.begin(), gauges.end());
+	last_counters_ = std::move(counters);
+
+	if (file_writer_) {
+		Status s = file_writer_->Append(snapshot);
+		if (!s.ok()) {
+			ROCKS_LOG_WARN(info_log_,
+				       "Stop writing the stats history: %s",
+				       s.ToString().c_str());
+			file_writer_.reset();
+		}
+	}
+
+	const size_t charge = SnapshotCharge(snapshot);
+	InstrumentedMutexLock l(&mu_);
+	snapshots_.push_back(std::move(snapshot));
+	snapshots_charge_ += charge;
+	while (snapshots_charge_ > buffer_size_ && !snapshots_.empty()) {
+		snapshots_charge_ -= SnapshotCharge(snapshots_.front());
+		snapshots_.pop_front();
+	}
+}
+
+void StatsHistory::GetSnapshots(uint64_t start_micros, uint64_t end_micros,
+				std::vector<StatsSnapshot> *snapshots) const
+{
+	InstrumentedMutexLock l(&mu_);
+	for (const auto &snapshot : snapshots_) {
+		if (snapshot.time_micros >= start_micros &&
+		    snapshot.time_micros < end_micros) {
+			snapshots->push_back(snapshot);
+		}
+	}
+}
+
+size_t StatsHistory::GetMemoryUsage() const
+{
+	InstrumentedMutexLock l(&mu_);
+	return snapshots_charge_;
+}
+
+StatsHistoryIterator *
+NewInMemoryStatsHistoryIterator(std::vector<StatsSnapshot> &&snapshots)
+{
+	return new InMemoryStatsHistoryIterator(std::move(snapshots));
+}
+
+} // namespace rocksdb
@@ -0,0 +1,169 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "monitoring/instrumented_mutex.h"
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/stats_history.h"
+
+namespace rocksdb
+{
+class Logger;
+class SequentialFileReader;
+class WritableFileWriter;
+
+typedef std::map<std::string, uint64_t> StatsMap;
+
+struct StatsSnapshot {
+	uint64_t time_micros = 0;
+	StatsMap stats;
+};
+
+// A stats history file is a sequence of records
+//
+//   payload size (fixed32) | masked crc32c of payload (fixed32) | payload
+//
+// whose payload starts with a StatsHistoryRecordType. A names record lists
+// the names of the statistics, as varint32 count | length-prefixed names;
+// each snapshot record that follows is the time (fixed64) and the value of
+// each of those names as a varint64, in order. A new names record is
+// written whenever the set of names changes, each time a DB appends to the
+// file and at the start of each file rolled over to. A record cut short by
+// a crash ends the file.
+enum StatsHistoryRecordType : char {
+	kStatsHistoryNames = 1,
+	kStatsHistorySnapshot = 2,
+};
+
+class StatsHistoryFileWriter {
+    public:
+	// file_writer appends to path, which holds file_size bytes already
+	StatsHistoryFileWriter(
+		Env *env, const EnvOptions &env_options,
+		const std::string &path, size_t max_file_size,
+		std::unique_ptr<WritableFileWriter> &&file_writer,
+		uint64_t file_size);
+	~StatsHistoryFileWriter();
+
+	Status Append(const StatsSnapshot &snapshot);
+
+    private:
+	Status AddRecord(const std::string &payload);
+	// Renames the file to OldStatsHistoryFileName() and starts a new one
+	Status RollFile();
+
+	Env *env_;
+	const EnvOptions env_options_;
+	const std::string path_;
+	const size_t max_file_size_;
+	std::unique_ptr<WritableFileWriter> file_writer_;
+	uint64_t file_size_;
+	// Names of the last names record
+	std::vector<std::string> names_;
+};
+
+// The name a stats history file at path is rolled over to
+std::string OldStatsHistoryFileName(const std::string &path);
+
+// Appends to the file at path, creating it if needed. If max_file_size is
+// not zero, the file rolls over to OldStatsHistoryFileName(path) once it
+// grows past max_file_size bytes.
+Status
+NewStatsHistoryFileWriter(Env *env, const EnvOptions &env_options,
+			const std::string &path, size_t max_file_size,
+			std::unique_ptr<StatsHistoryFileWriter> *writer);
+
+class StatsHistoryFileReader {
+    public:
+	explicit StatsHistoryFileReader(
+		std::unique_ptr<SequentialFileReader> &&file_reader);
+	~StatsHistoryFileReader();
+
+	// Returns Status::Incomplete() at the end of the file.
+	Status Next(StatsSnapshot *snapshot);
+
+    private:
+	Status ReadRecord(std::string *payload);
+
+	std::unique_ptr<SequentialFileReader> file_reader_;
+	std::vector<std::string> names_;
+};
+
+Status
+NewStatsHistoryFileReader(Env *env, const EnvOptions &env_options,
+			const std::string &path,
+			std::unique_ptr<StatsHistoryFileReader> *reader);
+
+// StatsHistory takes a snapshot of the statistics of a DB every period
+// on a thread of its own, keeps the latest ones within a memory budget and
+// appends each to a StatsHistoryFileWriter if it has one.
+class StatsHistory {
+    public:
+	// Fills counters with cumulative values, whose snapshots keep the
+	// change since the previous snapshot, and gauges with values kept as
+	// they are.
+	typedef std::function<void(StatsMap *counters, StatsMap *gauges)>
+		Collector;
+
+	StatsHistory(Env *env, uint64_t period_micros, size_t buffer_size,
+		     std::unique_ptr<StatsHistoryFileWriter> &&file_writer,
+		     Collector collector, Logger *info_log);
+	// Stops the thread
+	~StatsHistory();
+
+	void Start();
+	// Waits for a snapshot being taken; no snapshot is taken after.
+	void Stop();
+
+	// Take a snapshot now. Thread-safe.
+	void TakeSnapshot();
+
+	// The snapshots in memory taken in [start_micros, end_micros)
+	void GetSnapshots(uint64_t start_micros, uint64_t end_micros,
+			  std::vector<StatsSnapshot> *snapshots) const;
+
+	// Memory charged for the snapshots in memory
+	size_t GetMemoryUsage() const;
+
+    private:
+	void BackgroundThread();
+	static size_t SnapshotCharge(const StatsSnapshot &snapshot);
+
+	Env *env_;
+	const uint64_t period_micros_;
+	const size_t buffer_size_;
+	Collector collector_;
+	Logger *info_log_;
+
+	// Serializes TakeSnapshot(); protects last_counters_ and
+	// file_writer_
+	std::mutex snapshot_mu_;
+	StatsMap last_counters_;
+	std::unique_ptr<StatsHistoryFileWriter> file_writer_;
+
+	// Protects the members below
+	mutable InstrumentedMutex mu_;
+	InstrumentedCondVar cv_;
+	bool closing_;
+	std::deque<StatsSnapshot> snapshots_;
+	size_t snapshots_charge_;
+	std::unique_ptr<port::Thread> bg_thread_;
+};
+
+// Iterates a copy of snapshots
+StatsHistoryIterator *
+NewInMemoryStatsHistoryIterator(std::vector<StatsSnapshot> &&snapshots);
+
+} // namespace rocksdb
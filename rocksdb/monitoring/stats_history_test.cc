@@ -0,0 +1,202 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/stats_history.h"
+
+#include <string>
+
+#include "db/db_test_util.h"
+#include "port/stack_trace.h"
+#include "rocksdb/statistics.h"
+
+namespace rocksdb
+{
+class StatsHistoryTest : public DBTestBase {
+    public:
+	StatsHistoryTest() : DBTestBase("/stats_history_test")
+	{
+	}
+
+	Options StatsHistoryOptions()
+	{
+		Options options = CurrentOptions();
+		options.statistics = CreateDBStatistics();
+		// Snapshots are taken by hand below
+		options.stats_persist_period_sec = 3600;
+		return options;
+	}
+
+	// Also writes the history to a file, starting from scratch: DestroyDB()
+	// leaves the files of earlier runs behind.
+	Options StatsHistoryFileOptions()
+	{
+		Options options = StatsHistoryOptions();
+		options.stats_history_file = dbname_ + "/stats_history";
+		env_->DeleteFile(options.stats_history_file);
+		env_->DeleteFile(
+			OldStatsHistoryFileName(options.stats_history_file));
+		return options;
+	}
+
+	std::vector<StatsSnapshot> GetHistory()
+	{
+		std::vector<StatsSnapshot> history;
+		std::unique_ptr<StatsHistoryIterator> iter;
+		EXPECT_OK(
+			dbfull()->GetStatsHistory(0, port::kMaxUint64, &iter));
+		for (; iter->Valid(); iter->Next()) {
+			StatsSnapshot snapshot;
+			snapshot.time_micros = iter->GetStatsTime();
+			snapshot.stats = iter->GetStatsMap();
+			history.push_back(std::move(snapshot));
+		}
+		return history;
+	}
+};
+
+TEST_F(StatsHistoryTest, NotEnabled)
+{
+	Options options = CurrentOptions();
+	Reopen(options);
+	std::unique_ptr<StatsHistoryIterator> iter;
+	ASSERT_TRUE(dbfull()->GetStatsHistory(0, port::kMaxUint64, &iter)
+			    .IsNotSupported());
+}
+
+TEST_F(StatsHistoryTest, CountersAreDeltas)
+{
+	Options options = StatsHistoryOptions();
+	Reopen(options);
+
+	for (int i = 0; i < 10; i++) {
+		ASSERT_OK(Put(Key(i), "value"));
+	}
+	dbfull()->TEST_TakeStatsSnapshot();
+	for (int i = 0; i < 5; i++) {
+		ASSERT_OK(Put(Key(i), "value"));
+	}
+	dbfull()->TEST_TakeStatsSnapshot();
+	dbfull()->TEST_TakeStatsSnapshot();
+
+	std::vector<StatsSnapshot> history = GetHistory();
+	ASSERT_EQ(3, history.size());
+	const std::string kKeysWritten = "rocksdb.number.keys.written";
+	ASSERT_EQ(10, history[0].stats[kKeysWritten]);
+	ASSERT_EQ(5, history[1].stats[kKeysWritten]);
+	ASSERT_EQ(0, history[2].stats[kKeysWritten]);
+	ASSERT_EQ(5, history[1].stats["rocksdb.db.write.micros.count"]);
+	// Gauges are kept as they are
+	ASSERT_GT(history[2].stats[DB::Properties::kCurSizeAllMemTables], 0);
+	ASSERT_EQ(0, history[2].stats[DB::Properties::kNumRunningFlushes]);
+	ASSERT_LE(history[0].time_micros, history[1].time_micros);
+	ASSERT_LE(history[1].time_micros, history[2].time_micros);
+
+	// [start_time, end_time)
+	std::unique_ptr<StatsHistoryIterator> iter;
+	ASSERT_OK(dbfull()->GetStatsHistory(history[1].time_micros,
+					    history[2].time_micros + 1,
+					    &iter));
+	int count = 0;
+	for (; iter->Valid(); iter->Next()) {
+		ASSERT_GE(iter->GetStatsTime(), history[1].time_micros);
+		count++;
+	}
+	ASSERT_GE(count, 2);
+	ASSERT_OK(dbfull()->GetStatsHistory(0, history[0].time_micros, &iter));
+	ASSERT_FALSE(iter->Valid());
+}
+
+TEST_F(StatsHistoryTest, BufferEvictsOldest)
+{
+	Options options = StatsHistoryOptions();
+	// Too small for a single snapshot
+	options.stats_history_buffer_size = 1;
+	Reopen(options);
+	dbfull()->TEST_TakeStatsSnapshot();
+	std::vector<StatsSnapshot> history = GetHistory();
+	ASSERT_EQ(0, history.size());
+
+	options.stats_history_buffer_size = 64 << 10;
+	Reopen(options);
+	for (int i = 0; i < 100; i++) {
+		ASSERT_OK(Put(Key(i), "value"));
+		dbfull()->TEST_TakeStatsSnapshot();
+	}
+	history = GetHistory();
+	ASSERT_GT(history.size(), 0);
+	ASSERT_LT(history.size(), 100);
+	// The latest are kept
+	ASSERT_EQ(1, history.back().stats["rocksdb.number.keys.written"]);
+}
+
+TEST_F(StatsHistoryTest, File)
+{
+	Options options = StatsHistoryFileOptions();
+	Reopen(options);
+	ASSERT_OK(Put("a", "1"));
+	dbfull()->TEST_TakeStatsSnapshot();
+	ASSERT_OK(Put("b", "2"));
+	ASSERT_OK(Put("c", "3"));
+	dbfull()->TEST_TakeStatsSnapshot();
+	std::vector<StatsSnapshot> history = GetHistory();
+	ASSERT_EQ(2, history.size());
+	// Appends to the file of the previous open
+	Reopen(options);
+	dbfull()->TEST_TakeStatsSnapshot();
+	history.push_back(GetHistory().back());
+	Close();
+
+	std::unique_ptr<StatsHistoryFileReader> reader;
+	ASSERT_OK(NewStatsHistoryFileReader(env_, EnvOptions(),
+					    options.stats_history_file,
+					    &reader));
+	StatsSnapshot snapshot;
+	for (const StatsSnapshot &expected : history) {
+		ASSERT_OK(reader->Next(&snapshot));
+		ASSERT_EQ(expected.time_micros, snapshot.time_micros);
+		ASSERT_EQ(expected.stats, snapshot.stats);
+	}
+	ASSERT_TRUE(reader->Next(&snapshot).IsIncomplete());
+}
+
+TEST_F(StatsHistoryTest, FileRollsOver)
+{
+	Options options = StatsHistoryFileOptions();
+	// Roll over before each snapshot but the first
+	options.max_stats_history_file_size = 1;
+	Reopen(options);
+	for (int i = 0; i < 3; i++) {
+		ASSERT_OK(Put("a", ToString(i)));
+		dbfull()->TEST_TakeStatsSnapshot();
+	}
+	std::vector<StatsSnapshot> history = GetHistory();
+	ASSERT_EQ(3, history.size());
+	Close();
+
+	// The file holds the last snapshot, the old file the one before
+	const std::string files[] = {
+		options.stats_history_file,
+		OldStatsHistoryFileName(options.stats_history_file)
+	};
+	for (int i = 0; i < 2; i++) {
+		std::unique_ptr<StatsHistoryFileReader> reader;
+		ASSERT_OK(NewStatsHistoryFileReader(env_, EnvOptions(),
+						    files[i], &reader));
+		StatsSnapshot snapshot;
+		ASSERT_OK(reader->Next(&snapshot));
+		ASSERT_EQ(history[2 - i].time_micros, snapshot.time_micros);
+		ASSERT_EQ(history[2 - i].stats, snapshot.stats);
+		ASSERT_TRUE(reader->Next(&snapshot).IsIncomplete());
+	}
+}
+
+} // namespace rocksdb
+
+int main(int argc, char **argv)
+{
+	rocksdb::port::InstallStackTraceHandler();
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
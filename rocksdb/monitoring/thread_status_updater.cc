@@ -15,6 +15,31 @@ namespace rocksdb
 
 __thread ThreadStatusData *ThreadStatusUpdater::thread_status_data_ = nullptr;
 
+namespace
+{
+// What the exit handler of a USER thread needs to unregister it
+struct UserThreadExit {
+	ThreadStatusData *data;
+	std::mutex *thread_list_mutex;
+	std::unordered_set<ThreadStatusData *> *thread_data_set;
+};
+
+void OnUserThreadExit(void *ptr)
+{
+	auto *exit_info = static_cast<UserThreadExit *>(ptr);
+	{
+		std::lock_guard<std::mutex> lck(*exit_info->thread_list_mutex);
+		exit_info->thread_data_set->erase(exit_info->data);
+	}
+	delete exit_info->data;
+	delete exit_info;
+}
+} // namespace
+
+ThreadStatusUpdater::ThreadStatusUpdater() : user_thread_exit_(OnUserThreadExit)
+{
+}
+
 void ThreadStatusUpdater::RegisterThread(ThreadStatus::ThreadType ttype,
 					 uint64_t thread_id)
 {
@@ -22,8 +47,16 @@ void ThreadStatusUpdater::RegisterThread(ThreadStatus::ThreadType ttype,
 		thread_status_data_ = new ThreadStatusData();
 		thread_status_data_->thread_type = ttype;
 		thread_status_data_->thread_id = thread_id;
-		std::lock_guard<std::mutex> lck(thread_list_mutex_);
-		thread_data_set_.insert(thread_status_data_);
+		{
+			std::lock_guard<std::mutex> lck(thread_list_mutex_);
+			thread_data_set_.insert(thread_status_data_);
+		}
+		if (ttype == ThreadStatus::USER) {
+			// Nobody calls UnregisterThread() for user threads
+			user_thread_exit_.Reset(new UserThreadExit{
+				thread_status_data_, &thread_list_mutex_,
+				&thread_data_set_ });
+		}
 	}
 
 	ClearThreadOperationProperties();
@@ -32,6 +65,9 @@ void ThreadStatusUpdater::RegisterThread(ThreadStatus::ThreadType ttype,
 void ThreadStatusUpdater::UnregisterThread()
 {
 	if (thread_status_data_ != nullptr) {
+		auto *exit_info = static_cast<UserThreadExit *>(
+			user_thread_exit_.Swap(nullptr));
+		delete exit_info;
 		std::lock_guard<std::mutex> lck(thread_list_mutex_);
 		thread_data_set_.erase(thread_status_data_);
 		delete thread_status_data_;
@@ -169,6 +205,53 @@ void ThreadStatusUpdater::ClearThreadState()
 			       std::memory_order_relaxed);
 }
 
+namespace
+{
+// Nested states may be timed by the clocks of different Envs
+uint64_t StateElapsedMicros(const ThreadStatusData *data, uint64_t now)
+{
+	uint64_t start = data->state_start_time.load(std::memory_order_relaxed);
+	return now > start ? now - start : 0;
+}
+} // namespace
+
+bool ThreadStatusUpdater::EnterThreadState(const ThreadStatus::StateType type,
+					   uint64_t now_micros,
+					   ThreadStatus::StateType *prev_state)
+{
+	auto *data = GetLocalThreadStatus();
+	if (data == nullptr) {
+		return false;
+	}
+	*prev_state = data->state_type.load(std::memory_order_relaxed);
+	if (*prev_state != ThreadStatus::STATE_UNKNOWN) {
+		data->state_wait_micros[*prev_state].fetch_add(
+			StateElapsedMicros(data, now_micros),
+			std::memory_order_relaxed);
+	}
+	data->state_wait_counts[type].fetch_add(1, std::memory_order_relaxed);
+	data->state_start_time.store(now_micros, std::memory_order_relaxed);
+	data->state_type.store(type, std::memory_order_relaxed);
+	return true;
+}
+
+void ThreadStatusUpdater::LeaveThreadState(
+	const ThreadStatus::StateType prev_state, uint64_t now_micros)
+{
+	auto *data = GetLocalThreadStatus();
+	if (data == nullptr) {
+		return;
+	}
+	auto type = data->state_type.load(std::memory_order_relaxed);
+	if (type != ThreadStatus::STATE_UNKNOWN) {
+		data->state_wait_micros[type].fetch_add(
+			StateElapsedMicros(data, now_micros),
+			std::memory_order_relaxed);
+	}
+	data->state_start_time.store(now_micros, std::memory_order_relaxed);
+	data->state_type.store(prev_state, std::memory_order_relaxed);
+}
+
 Status
 ThreadStatusUpdater::GetThreadList(std::vector<ThreadStatus> *thread_list)
 {
@@ -201,6 +284,17 @@ ThreadStatusUpdater::GetThreadList(std::vector<ThreadStatus> *thread_list)
 			ThreadStatus::STATE_UNKNOWN;
 		uint64_t op_elapsed_micros = 0;
 		uint64_t op_props[ThreadStatus::kNumOperationProperties] = { 0 };
+		uint64_t state_elapsed_micros = 0;
+		uint64_t state_wait_micros[ThreadStatus::NUM_STATE_TYPES];
+		uint64_t state_wait_counts[ThreadStatus::NUM_STATE_TYPES];
+		for (int i = 0; i < ThreadStatus::NUM_STATE_TYPES; ++i) {
+			state_wait_micros[i] =
+				thread_data->state_wait_micros[i].load(
+					std::memory_order_relaxed);
+			state_wait_counts[i] =
+				thread_data->state_wait_counts[i].load(
+					std::memory_order_relaxed);
+		}
 		if (cf_info != nullptr) {
 			db_name = &cf_info->db_name;
 			cf_name = &cf_info->cf_name;
@@ -216,6 +310,14 @@ ThreadStatusUpdater::GetThreadList(std::vector<ThreadStatus> *thread_list)
 					std::memory_order_relaxed);
 				state_type = thread_data->state_type.load(
 					std::memory_order_relaxed);
+				uint64_t start =
+					thread_data->state_start_time.load(
+						std::memory_order_relaxed);
+				if (state_type != ThreadStatus::STATE_UNKNOWN &&
+				    now_micros > start) {
+					state_elapsed_micros =
+						now_micros - start;
+				}
 				for (int i = 0;
 				     i < ThreadStatus::kNumOperationProperties;
 				     ++i) {
@@ -229,7 +331,8 @@ ThreadStatusUpdater::GetThreadList(std::vector<ThreadStatus> *thread_list)
 					  db_name ? *db_name : "",
 					  cf_name ? *cf_name : "", op_type,
 					  op_elapsed_micros, op_stage, op_props,
-					  state_type);
+					  state_type, state_elapsed_micros,
+					  state_wait_micros, state_wait_counts);
 	}
 
 	return Status::OK();
@@ -315,6 +418,10 @@ void ThreadStatusUpdater::EraseDatabaseInfo(const void *db_key)
 
 #else
 
+ThreadStatusUpdater::ThreadStatusUpdater()
+{
+}
+
 void ThreadStatusUpdater::RegisterThread(ThreadStatus::ThreadType ttype,
 					 uint64_t thread_id)
 {
@@ -349,6 +456,18 @@ void ThreadStatusUpdater::ClearThreadState()
 {
 }
 
+bool ThreadStatusUpdater::EnterThreadState(const ThreadStatus::StateType type,
+					   uint64_t now_micros,
+					   ThreadStatus::StateType *prev_state)
+{
+	return false;
+}
+
+void ThreadStatusUpdater::LeaveThreadState(
+	const ThreadStatus::StateType prev_state, uint64_t now_micros)
+{
+}
+
 Status
 ThreadStatusUpdater::GetThreadList(std::vector<ThreadStatus> *thread_list)
 {
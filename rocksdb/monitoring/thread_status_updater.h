@@ -39,6 +39,7 @@
 #include "rocksdb/status.h"
 #include "rocksdb/thread_status.h"
 #include "port/port.h"
+#include "util/thread_local.h"
 #include "util/thread_operation.h"
 
 namespace rocksdb
@@ -73,6 +74,11 @@ struct ThreadStatusData {
 		operation_type.store(ThreadStatus::OP_UNKNOWN);
 		op_start_time.store(0);
 		state_type.store(ThreadStatus::STATE_UNKNOWN);
+		state_start_time.store(0);
+		for (int i = 0; i < ThreadStatus::NUM_STATE_TYPES; ++i) {
+			state_wait_micros[i].store(0);
+			state_wait_counts[i].store(0);
+		}
 	}
 
 	// A flag to indicate whether the thread tracking is enabled
@@ -93,6 +99,10 @@ struct ThreadStatusData {
 	std::atomic<uint64_t>
 		op_properties[ThreadStatus::kNumOperationProperties];
 	std::atomic<ThreadStatus::StateType> state_type;
+	std::atomic<uint64_t> state_start_time;
+	// Only updated by the thread itself
+	std::atomic<uint64_t> state_wait_micros[ThreadStatus::NUM_STATE_TYPES];
+	std::atomic<uint64_t> state_wait_counts[ThreadStatus::NUM_STATE_TYPES];
 #endif // ROCKSDB_USING_THREAD_STATUS
 };
 
@@ -106,9 +116,7 @@ struct ThreadStatusData {
 // @see ThreadStatusUtil
 class ThreadStatusUpdater {
     public:
-	ThreadStatusUpdater()
-	{
-	}
+	ThreadStatusUpdater();
 
 	// Releases all ThreadStatusData of all active threads.
 	virtual ~ThreadStatusUpdater()
@@ -125,7 +133,8 @@ class ThreadStatusUpdater {
 	// Set the id of the current thread.
 	void SetThreadID(uint64_t thread_id);
 
-	// Register the current thread for tracking.
+	// Register the current thread for tracking. A USER thread is
+	// unregistered when it exits.
 	void RegisterThread(ThreadStatus::ThreadType ttype, uint64_t thread_id);
 
 	// Update the column-family info of the current thread by setting
@@ -171,6 +180,19 @@ class ThreadStatusUpdater {
 	// Clear the thread state of the current thread.
 	void ClearThreadState();
 
+	// Switch the current thread to the specified state at now_micros,
+	// adding the time spent so far in the current state to its wait
+	// time.  Sets *prev_state to the current state and returns true, or
+	// returns false if the current thread is not tracked.
+	bool EnterThreadState(const ThreadStatus::StateType type,
+			      uint64_t now_micros,
+			      ThreadStatus::StateType *prev_state);
+
+	// Add the time spent in the state entered by EnterThreadState() to
+	// its wait time and switch back to prev_state at now_micros.
+	void LeaveThreadState(const ThreadStatus::StateType prev_state,
+			      uint64_t now_micros);
+
 	// Obtain the status of all active registered threads.
 	Status GetThreadList(std::vector<ThreadStatus> *thread_list);
 
@@ -232,6 +254,10 @@ class ThreadStatusUpdater {
 	std::unordered_map<const void *, std::unordered_set<const void *> >
 		db_key_map_;
 
+	// Unregisters USER threads when they exit.  Declared last so that it
+	// is destroyed before the members its handler uses.
+	ThreadLocalPtr user_thread_exit_;
+
 #else
 	static ThreadStatusData *thread_status_data_;
 #endif // ROCKSDB_USING_THREAD_STATUS
@@ -180,6 +180,53 @@ AutoThreadOperationStageUpdater::~AutoThreadOperationStageUpdater()
 	ThreadStatusUtil::SetThreadOperationStage(prev_stage_);
 }
 
+AutoThreadOperationUpdater::AutoThreadOperationUpdater(
+	const Env *env, const ColumnFamilyData *cfd,
+	bool enable_thread_tracking, ThreadStatus::OperationType type)
+	: active_(false)
+{
+	if (!enable_thread_tracking || cfd == nullptr ||
+	    !ThreadStatusUtil::MaybeInitThreadLocalUpdater(env)) {
+		return;
+	}
+	ThreadStatusUpdater *updater =
+		ThreadStatusUtil::thread_updater_local_cache_;
+	if (updater->GetColumnFamilyInfoKey() != nullptr) {
+		return;
+	}
+	updater->RegisterThread(ThreadStatus::USER, env->GetThreadID());
+	updater->SetColumnFamilyInfoKey(cfd);
+	ThreadStatusUtil::SetThreadOperation(type);
+	active_ = true;
+}
+
+AutoThreadOperationUpdater::~AutoThreadOperationUpdater()
+{
+	if (active_) {
+		ThreadStatusUtil::ResetThreadStatus();
+	}
+}
+
+AutoThreadStateUpdater::AutoThreadStateUpdater(ThreadStatus::StateType state,
+					       Env *env)
+	: active_(false), env_(env != nullptr ? env : Env::Default())
+{
+	ThreadStatusUpdater *updater =
+		ThreadStatusUtil::thread_updater_local_cache_;
+	if (updater != nullptr) {
+		active_ = updater->EnterThreadState(state, env_->NowMicros(),
+						    &prev_state_);
+	}
+}
+
+AutoThreadStateUpdater::~AutoThreadStateUpdater()
+{
+	if (active_) {
+		ThreadStatusUtil::thread_updater_local_cache_->LeaveThreadState(
+			prev_state_, env_->NowMicros());
+	}
+}
+
 #else
 
 ThreadStatusUpdater *ThreadStatusUtil::thread_updater_local_cache_ = nullptr;
@@ -240,6 +287,25 @@ AutoThreadOperationStageUpdater::~AutoThreadOperationStageUpdater()
 {
 }
 
+AutoThreadOperationUpdater::AutoThreadOperationUpdater(
+	const Env *env, const ColumnFamilyData *cfd,
+	bool enable_thread_tracking, ThreadStatus::OperationType type)
+{
+}
+
+AutoThreadOperationUpdater::~AutoThreadOperationUpdater()
+{
+}
+
+AutoThreadStateUpdater::AutoThreadStateUpdater(ThreadStatus::StateType state,
+					       Env *env)
+{
+}
+
+AutoThreadStateUpdater::~AutoThreadStateUpdater()
+{
+}
+
 #endif // ROCKSDB_USING_THREAD_STATUS
 
 } // namespace rocksdb
@@ -79,6 +79,9 @@ class ThreadStatusUtil {
 #endif
 
     protected:
+	friend class AutoThreadOperationUpdater;
+	friend class AutoThreadStateUpdater;
+
 	// Initialize the thread-local ThreadStatusUpdater when it finds
 	// the cached value is nullptr.  Returns true if it has cached
 	// a non-null pointer.
@@ -131,4 +134,43 @@ class AutoThreadOperationStageUpdater {
 #endif
 };
 
+// A helper class for the operations of user threads, such as a Get() or
+// a Write().  If enable_thread_tracking is set, it registers the current
+// thread as a USER thread and sets its column family and operation in its
+// constructor, so that GetThreadList() shows the thread and the states it
+// waits in, and resets them in its destructor.  It does nothing if the
+// thread is already running an operation, e.g. a Write() from a
+// background job.
+class AutoThreadOperationUpdater {
+    public:
+	AutoThreadOperationUpdater(const Env *env, const ColumnFamilyData *cfd,
+				   bool enable_thread_tracking,
+				   ThreadStatus::OperationType type);
+	~AutoThreadOperationUpdater();
+
+#ifdef ROCKSDB_USING_THREAD_STATUS
+    private:
+	bool active_;
+#endif
+};
+
+// A helper class for wait events.  It switches the thread state to the
+// input state in its constructor and back in its destructor, adding the
+// time spent in between, by the clock of env or of Env::Default() if env
+// is nullptr, to the total wait time of the state reported by
+// GetThreadList().  It does nothing unless the thread is tracked.
+class AutoThreadStateUpdater {
+    public:
+	explicit AutoThreadStateUpdater(ThreadStatus::StateType state,
+					Env *env = nullptr);
+	~AutoThreadStateUpdater();
+
+#ifdef ROCKSDB_USING_THREAD_STATUS
+    private:
+	bool active_;
+	Env *env_;
+	ThreadStatus::StateType prev_state_;
+#endif
+};
+
 } // namespace rocksdb
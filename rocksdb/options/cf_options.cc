@@ -70,11 +70,14 @@ ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions &db_options,
 	  num_levels(cf_options.num_levels),
 	  optimize_filters_for_hits(cf_options.optimize_filters_for_hits),
 	  force_consistency_checks(cf_options.force_consistency_checks),
+	  compaction_stats_key_prefix_length(
+		  cf_options.compaction_stats_key_prefix_length),
 	  allow_ingest_behind(db_options.allow_ingest_behind),
 	  listeners(db_options.listeners), row_cache(db_options.row_cache),
 	  max_subcompactions(db_options.max_subcompactions),
 	  memtable_insert_with_hint_prefix_extractor(
-		  cf_options.memtable_insert_with_hint_prefix_extractor.get())
+		  cf_options.memtable_insert_with_hint_prefix_extractor.get()),
+	  numa_aware(db_options.numa_aware)
 {
 }
 
@@ -108,6 +108,8 @@ struct ImmutableCFOptions {
 
 	bool force_consistency_checks;
 
+	size_t compaction_stats_key_prefix_length;
+
 	bool allow_ingest_behind;
 
 	// A vector of EventListeners which call-back functions will be called
@@ -119,6 +121,8 @@ struct ImmutableCFOptions {
 	uint32_t max_subcompactions;
 
 	const SliceTransform *memtable_insert_with_hint_prefix_extractor;
+
+	bool numa_aware;
 };
 
 struct MutableCFOptions {
@@ -86,7 +86,20 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions &options)
 	  fail_if_options_file_error(options.fail_if_options_file_error),
 	  dump_malloc_stats(options.dump_malloc_stats),
 	  avoid_flush_during_recovery(options.avoid_flush_during_recovery),
-	  allow_ingest_behind(options.allow_ingest_behind)
+	  allow_ingest_behind(options.allow_ingest_behind),
+	  persist_table_meta_snapshot(options.persist_table_meta_snapshot),
+	  max_manifest_space_amp_pct(options.max_manifest_space_amp_pct),
+	  min_manifest_file_size_for_space_amp(
+		  options.min_manifest_file_size_for_space_amp),
+	  use_direct_io_for_wal(options.use_direct_io_for_wal),
+	  writable_file_direct_io_buffers(
+		  options.writable_file_direct_io_buffers),
+	  numa_aware(options.numa_aware),
+	  wal_pool_size(options.wal_pool_size),
+	  stats_persist_period_sec(options.stats_persist_period_sec),
+	  stats_history_buffer_size(options.stats_history_buffer_size),
+	  stats_history_file(options.stats_history_file),
+	  max_stats_history_file_size(options.max_stats_history_file_size)
 {
 }
 
@@ -270,6 +283,42 @@ void ImmutableDBOptions::Dump(Logger *log) const
 			 avoid_flush_during_recovery);
 	ROCKS_LOG_HEADER(log, "            Options.allow_ingest_behind: %d",
 			 allow_ingest_behind);
+	ROCKS_LOG_HEADER(log, "         Options.persist_table_meta_snapshot: %d",
+			 persist_table_meta_snapshot);
+	ROCKS_LOG_HEADER(log,
+			 "          Options.max_manifest_space_amp_pct: %" PRIu64,
+			 max_manifest_space_amp_pct);
+	ROCKS_LOG_HEADER(
+		log, "Options.min_manifest_file_size_for_space_amp: %" PRIu64,
+		min_manifest_file_size_for_space_amp);
+	ROCKS_LOG_HEADER(log,
+			 "               Options.use_direct_io_for_wal: %d",
+			 use_direct_io_for_wal);
+	ROCKS_LOG_HEADER(log,
+			 "     Options.writable_file_direct_io_buffers: %"
+			 ROCKSDB_PRIszt,
+			 writable_file_direct_io_buffers);
+	ROCKS_LOG_HEADER(log,
+			 "                          Options.numa_aware: %d",
+			 numa_aware);
+	ROCKS_LOG_HEADER(log,
+			 "                       Options.wal_pool_size: %"
+			 ROCKSDB_PRIszt,
+			 wal_pool_size);
+	ROCKS_LOG_HEADER(log,
+			 "            Options.stats_persist_period_sec: %u",
+			 stats_persist_period_sec);
+	ROCKS_LOG_HEADER(log,
+			 "           Options.stats_history_buffer_size: %"
+			 ROCKSDB_PRIszt,
+			 stats_history_buffer_size);
+	ROCKS_LOG_HEADER(log,
+			 "                  Options.stats_history_file: %s",
+			 stats_history_file.c_str());
+	ROCKS_LOG_HEADER(log,
+			 "         Options.max_stats_history_file_size: %"
+			 ROCKSDB_PRIszt,
+			 max_stats_history_file_size);
 }
 
 MutableDBOptions::MutableDBOptions()
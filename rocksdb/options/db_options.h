@@ -79,6 +79,17 @@ struct ImmutableDBOptions {
 	bool dump_malloc_stats;
 	bool avoid_flush_during_recovery;
 	bool allow_ingest_behind;
+	bool persist_table_meta_snapshot;
+	uint64_t max_manifest_space_amp_pct;
+	uint64_t min_manifest_file_size_for_space_amp;
+	bool use_direct_io_for_wal;
+	size_t writable_file_direct_io_buffers;
+	bool numa_aware;
+	size_t wal_pool_size;
+	unsigned int stats_persist_period_sec;
+	size_t stats_history_buffer_size;
+	std::string stats_history_file;
+	size_t max_stats_history_file_size;
 };
 
 struct MutableDBOptions {
@@ -88,7 +88,9 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options &options)
 	  optimize_filters_for_hits(options.optimize_filters_for_hits),
 	  paranoid_file_checks(options.paranoid_file_checks),
 	  force_consistency_checks(options.force_consistency_checks),
-	  report_bg_io_stats(options.report_bg_io_stats)
+	  report_bg_io_stats(options.report_bg_io_stats),
+	  compaction_stats_key_prefix_length(
+		  options.compaction_stats_key_prefix_length)
 {
 	assert(memtable_factory.get() != nullptr);
 	if (max_bytes_for_level_multiplier_additional.size() <
@@ -153,6 +155,9 @@ DBOptions::DBOptions(const Options &options)
 	  keep_log_file_num(options.keep_log_file_num),
 	  recycle_log_file_num(options.recycle_log_file_num),
 	  max_manifest_file_size(options.max_manifest_file_size),
+	  max_manifest_space_amp_pct(options.max_manifest_space_amp_pct),
+	  min_manifest_file_size_for_space_amp(
+		  options.min_manifest_file_size_for_space_amp),
 	  table_cache_numshardbits(options.table_cache_numshardbits),
 	  WAL_ttl_seconds(options.WAL_ttl_seconds),
 	  WAL_size_limit_MB(options.WAL_size_limit_MB),
@@ -162,6 +167,7 @@ DBOptions::DBOptions(const Options &options)
 	  use_direct_reads(options.use_direct_reads),
 	  use_direct_io_for_flush_and_compaction(
 		  options.use_direct_io_for_flush_and_compaction),
+	  use_direct_io_for_wal(options.use_direct_io_for_wal),
 	  allow_fallocate(options.allow_fallocate),
 	  is_fd_close_on_exec(options.is_fd_close_on_exec),
 	  skip_log_error_on_recovery(options.skip_log_error_on_recovery),
@@ -176,6 +182,8 @@ DBOptions::DBOptions(const Options &options)
 	  compaction_readahead_size(options.compaction_readahead_size),
 	  random_access_max_buffer_size(options.random_access_max_buffer_size),
 	  writable_file_max_buffer_size(options.writable_file_max_buffer_size),
+	  writable_file_direct_io_buffers(
+		  options.writable_file_direct_io_buffers),
 	  use_adaptive_mutex(options.use_adaptive_mutex),
 	  bytes_per_sync(options.bytes_per_sync),
 	  wal_bytes_per_sync(options.wal_bytes_per_sync),
@@ -199,7 +207,14 @@ DBOptions::DBOptions(const Options &options)
 	  dump_malloc_stats(options.dump_malloc_stats),
 	  avoid_flush_during_recovery(options.avoid_flush_during_recovery),
 	  avoid_flush_during_shutdown(options.avoid_flush_during_shutdown),
-	  allow_ingest_behind(options.allow_ingest_behind)
+	  allow_ingest_behind(options.allow_ingest_behind),
+	  persist_table_meta_snapshot(options.persist_table_meta_snapshot),
+	  numa_aware(options.numa_aware),
+	  wal_pool_size(options.wal_pool_size),
+	  stats_persist_period_sec(options.stats_persist_period_sec),
+	  stats_history_buffer_size(options.stats_history_buffer_size),
+	  stats_history_file(options.stats_history_file),
+	  max_stats_history_file_size(options.max_stats_history_file_size)
 {
 }
 
@@ -451,6 +466,10 @@ void ColumnFamilyOptions::Dump(Logger *log) const
 			 force_consistency_checks);
 	ROCKS_LOG_HEADER(log, "               Options.report_bg_io_stats: %d",
 			 report_bg_io_stats);
+	ROCKS_LOG_HEADER(
+		log,
+		"      Options.compaction_stats_key_prefix_length: %" ROCKSDB_PRIszt,
+		compaction_stats_key_prefix_length);
 } // ColumnFamilyOptions::Dump
 
 void Options::Dump(Logger *log) const
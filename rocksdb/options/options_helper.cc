@@ -129,6 +129,25 @@ DBOptions BuildDBOptions(const ImmutableDBOptions &immutable_db_options,
 	options.avoid_flush_during_shutdown =
 		mutable_db_options.avoid_flush_during_shutdown;
 	options.allow_ingest_behind = immutable_db_options.allow_ingest_behind;
+	options.persist_table_meta_snapshot =
+		immutable_db_options.persist_table_meta_snapshot;
+	options.max_manifest_space_amp_pct =
+		immutable_db_options.max_manifest_space_amp_pct;
+	options.min_manifest_file_size_for_space_amp =
+		immutable_db_options.min_manifest_file_size_for_space_amp;
+	options.use_direct_io_for_wal =
+		immutable_db_options.use_direct_io_for_wal;
+	options.writable_file_direct_io_buffers =
+		immutable_db_options.writable_file_direct_io_buffers;
+	options.numa_aware = immutable_db_options.numa_aware;
+	options.wal_pool_size = immutable_db_options.wal_pool_size;
+	options.stats_persist_period_sec =
+		immutable_db_options.stats_persist_period_sec;
+	options.stats_history_buffer_size =
+		immutable_db_options.stats_history_buffer_size;
+	options.stats_history_file = immutable_db_options.stats_history_file;
+	options.max_stats_history_file_size =
+		immutable_db_options.max_stats_history_file_size;
 
 	return options;
 }
@@ -362,7 +362,56 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
 	{ "allow_ingest_behind",
 	  { offsetof(struct DBOptions, allow_ingest_behind),
 	    OptionType::kBoolean, OptionVerificationType::kNormal, false,
-	    offsetof(struct ImmutableDBOptions, allow_ingest_behind) } }
+	    offsetof(struct ImmutableDBOptions, allow_ingest_behind) } },
+	{ "persist_table_meta_snapshot",
+	  { offsetof(struct DBOptions, persist_table_meta_snapshot),
+	    OptionType::kBoolean, OptionVerificationType::kNormal, false,
+	    offsetof(struct ImmutableDBOptions,
+		     persist_table_meta_snapshot) } },
+	{ "max_manifest_space_amp_pct",
+	  { offsetof(struct DBOptions, max_manifest_space_amp_pct),
+	    OptionType::kUInt64T, OptionVerificationType::kNormal, false,
+	    offsetof(struct ImmutableDBOptions, max_manifest_space_amp_pct) } },
+	{ "min_manifest_file_size_for_space_amp",
+	  { offsetof(struct DBOptions, min_manifest_file_size_for_space_amp),
+	    OptionType::kUInt64T, OptionVerificationType::kNormal, false,
+	    offsetof(struct ImmutableDBOptions,
+		     min_manifest_file_size_for_space_amp) } },
+	{ "use_direct_io_for_wal",
+	  { offsetof(struct DBOptions, use_direct_io_for_wal),
+	    OptionType::kBoolean, OptionVerificationType::kNormal, false,
+	    offsetof(struct ImmutableDBOptions, use_direct_io_for_wal) } },
+	{ "writable_file_direct_io_buffers",
+	  { offsetof(struct DBOptions, writable_file_direct_io_buffers),
+	    OptionType::kSizeT, OptionVerificationType::kNormal, false,
+	    offsetof(struct ImmutableDBOptions,
+		     writable_file_direct_io_buffers) } },
+	{ "numa_aware",
+	  { offsetof(struct DBOptions, numa_aware),
+	    OptionType::kBoolean, OptionVerificationType::kNormal, false,
+	    offsetof(struct ImmutableDBOptions, numa_aware) } },
+	{ "wal_pool_size",
+	  { offsetof(struct DBOptions, wal_pool_size),
+	    OptionType::kSizeT, OptionVerificationType::kNormal, false,
+	    offsetof(struct ImmutableDBOptions, wal_pool_size) } },
+	{ "stats_persist_period_sec",
+	  { offsetof(struct DBOptions, stats_persist_period_sec),
+	    OptionType::kUInt, OptionVerificationType::kNormal, false,
+	    offsetof(struct ImmutableDBOptions, stats_persist_period_sec) } },
+	{ "stats_history_buffer_size",
+	  { offsetof(struct DBOptions, stats_history_buffer_size),
+	    OptionType::kSizeT, OptionVerificationType::kNormal, false,
+	    offsetof(struct ImmutableDBOptions,
+		     stats_history_buffer_size) } },
+	{ "stats_history_file",
+	  { offsetof(struct DBOptions, stats_history_file),
+	    OptionType::kString, OptionVerificationType::kNormal, false,
+	    offsetof(struct ImmutableDBOptions, stats_history_file) } },
+	{ "max_stats_history_file_size",
+	  { offsetof(struct DBOptions, max_stats_history_file_size),
+	    OptionType::kSizeT, OptionVerificationType::kNormal, false,
+	    offsetof(struct ImmutableDBOptions,
+		     max_stats_history_file_size) } }
 };
 
 // offset_of is used to get the offset of a class data member
@@ -397,6 +446,9 @@ static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
 	  { offset_of(&ColumnFamilyOptions::report_bg_io_stats),
 	    OptionType::kBoolean, OptionVerificationType::kNormal, true,
 	    offsetof(struct MutableCFOptions, report_bg_io_stats) } },
+	{ "compaction_stats_key_prefix_length",
+	  { offset_of(&ColumnFamilyOptions::compaction_stats_key_prefix_length),
+	    OptionType::kSizeT, OptionVerificationType::kNormal, false, 0 } },
 	{ "compaction_measure_io_stats",
 	  { 0, OptionType::kBoolean, OptionVerificationType::kDeprecated, false,
 	    0 } },
@@ -223,6 +223,8 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable)
 		  sizeof(std::shared_ptr<Cache>) },
 		{ offsetof(struct DBOptions, wal_filter),
 		  sizeof(const WalFilter *) },
+		{ offsetof(struct DBOptions, stats_history_file),
+		  sizeof(std::string) },
 	};
 
 	char *options_ptr = new char[sizeof(DBOptions)];
@@ -312,6 +314,17 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable)
 		"allow_2pc=false;"
 		"avoid_flush_during_recovery=false;"
 		"avoid_flush_during_shutdown=false;"
+		"persist_table_meta_snapshot=false;"
+		"max_manifest_space_amp_pct=500;"
+		"min_manifest_file_size_for_space_amp=1048576;"
+		"use_direct_io_for_wal=false;"
+		"writable_file_direct_io_buffers=3;"
+		"numa_aware=true;"
+		"wal_pool_size=2;"
+		"stats_persist_period_sec=7;"
+		"stats_history_buffer_size=65536;"
+		"stats_history_file=stats.history;"
+		"max_stats_history_file_size=1048576;"
 		"allow_ingest_behind=false;",
 		new_options));
 
@@ -461,7 +474,8 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable)
 		"purge_redundant_kvs_while_flush=true;"
 		"hard_pending_compaction_bytes_limit=0;"
 		"disable_auto_compactions=false;"
-		"report_bg_io_stats=true;",
+		"report_bg_io_stats=true;"
+		"compaction_stats_key_prefix_length=4;",
 		new_options));
 
 	ASSERT_EQ(unset_bytes_base,
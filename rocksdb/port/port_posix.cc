@@ -21,7 +21,12 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstdlib>
+#include <vector>
+#ifdef NUMA
+#include <numa.h>
+#endif
 #include "util/logging.h"
 
 namespace rocksdb
@@ -72,6 +77,19 @@ void Mutex::Lock()
 #endif
 }
 
+bool Mutex::TryLock()
+{
+	int result = pthread_mutex_trylock(&mu_);
+	if (result == EBUSY) {
+		return false;
+	}
+	PthreadCall("trylock", result);
+#ifndef NDEBUG
+	locked_ = true;
+#endif
+	return true;
+}
+
 void Mutex::Unlock()
 {
 #ifndef NDEBUG
@@ -194,6 +212,93 @@ int PhysicalCoreID()
 #endif
 }
 
+#ifdef NUMA
+namespace
+{
+struct NumaTopology {
+	int num_nodes = 1;
+	// cpu => node
+	std::vector<int> cpu_to_node;
+
+	NumaTopology()
+	{
+		if (numa_available() < 0 || numa_num_configured_nodes() <= 1) {
+			return;
+		}
+		num_nodes = numa_max_node() + 1;
+		int num_cpus = numa_num_configured_cpus();
+		cpu_to_node.resize(std::max(num_cpus, 0), 0);
+		for (int cpu = 0; cpu < num_cpus; cpu++) {
+			int node = numa_node_of_cpu(cpu);
+			cpu_to_node[cpu] = node >= 0 ? node : 0;
+		}
+	}
+};
+
+const NumaTopology &GetNumaTopology()
+{
+	static NumaTopology topology;
+	return topology;
+}
+} // namespace
+#endif // NUMA
+
+int NumaNodeCount()
+{
+#ifdef NUMA
+	return GetNumaTopology().num_nodes;
+#else
+	return 1;
+#endif
+}
+
+int CurrentNumaNode()
+{
+#ifdef NUMA
+	const NumaTopology &topology = GetNumaTopology();
+	int cpu = PhysicalCoreID();
+	if (cpu >= 0 &&
+	    static_cast<size_t>(cpu) < topology.cpu_to_node.size()) {
+		return topology.cpu_to_node[cpu];
+	}
+#endif
+	return 0;
+}
+
+void *NumaAllocOnNode(size_t size, int node)
+{
+#ifdef NUMA
+	if (NumaNodeCount() > 1) {
+		return numa_alloc_onnode(size, node);
+	}
+#endif
+	(void)node;
+	return malloc(size);
+}
+
+void NumaFree(void *ptr, size_t size)
+{
+#ifdef NUMA
+	if (NumaNodeCount() > 1) {
+		numa_free(ptr, size);
+		return;
+	}
+#endif
+	(void)size;
+	free(ptr);
+}
+
+bool BindThreadToNumaNode(int node)
+{
+#ifdef NUMA
+	if (NumaNodeCount() > 1) {
+		return numa_run_on_node(node) == 0;
+	}
+#endif
+	(void)node;
+	return false;
+}
+
 void InitOnce(OnceType *once, void (*initializer)())
 {
 	PthreadCall("once", pthread_once(once, initializer));
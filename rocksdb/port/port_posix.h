@@ -115,6 +115,8 @@ class Mutex {
 	~Mutex();
 
 	void Lock();
+	// Locks the mutex if it isn't locked, without waiting
+	bool TryLock();
 	void Unlock();
 	// this will assert if the mutex is not locked
 	// it does NOT verify that mutex is held by a calling thread
@@ -185,6 +187,20 @@ static inline void AsmVolatilePause()
 // Returns -1 if not available on this platform
 extern int PhysicalCoreID();
 
+// NUMA topology helpers. Without NUMA support (not built with -DNUMA,
+// or libnuma reports a single node) there is exactly one node, 0:
+// allocations fall back to malloc() and binding threads is a no-op.
+extern int NumaNodeCount();
+// Node of the core the calling thread runs on, 0 if unknown
+extern int CurrentNumaNode();
+// Allocate size bytes of memory placed on the given node. Must be released
+// with NumaFree() with the same size.
+extern void *NumaAllocOnNode(size_t size, int node);
+extern void NumaFree(void *ptr, size_t size);
+// Restrict the calling thread to the cores of node. Returns false if that
+// is not supported.
+extern bool BindThreadToNumaNode(int node);
+
 typedef pthread_once_t OnceType;
 #define LEVELDB_ONCE_INIT PTHREAD_ONCE_INIT
 extern void InitOnce(OnceType *once, void (*initializer)());
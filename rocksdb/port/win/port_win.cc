@@ -118,6 +118,31 @@ int PhysicalCoreID()
 	return GetCurrentProcessorNumber();
 }
 
+int NumaNodeCount()
+{
+	return 1;
+}
+
+int CurrentNumaNode()
+{
+	return 0;
+}
+
+void *NumaAllocOnNode(size_t size, int node)
+{
+	return malloc(size);
+}
+
+void NumaFree(void *ptr, size_t size)
+{
+	free(ptr);
+}
+
+bool BindThreadToNumaNode(int node)
+{
+	return false;
+}
+
 void InitOnce(OnceType *once, void (*initializer)())
 {
 	std::call_once(once->flag_, initializer);
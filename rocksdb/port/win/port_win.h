@@ -135,6 +135,18 @@ class Mutex {
 #endif
 	}
 
+	// Locks the mutex if it isn't locked, without waiting
+	bool TryLock()
+	{
+		if (!mutex_.try_lock()) {
+			return false;
+		}
+#ifndef NDEBUG
+		locked_ = true;
+#endif
+		return true;
+	}
+
 	void Unlock()
 	{
 #ifndef NDEBUG
@@ -273,6 +285,20 @@ static inline void AsmVolatilePause()
 
 extern int PhysicalCoreID();
 
+// NUMA topology helpers. Without NUMA support (not built with -DNUMA,
+// or libnuma reports a single node) there is exactly one node, 0:
+// allocations fall back to malloc() and binding threads is a no-op.
+extern int NumaNodeCount();
+// Node of the core the calling thread runs on, 0 if unknown
+extern int CurrentNumaNode();
+// Allocate size bytes of memory placed on the given node. Must be released
+// with NumaFree() with the same size.
+extern void *NumaAllocOnNode(size_t size, int node);
+extern void NumaFree(void *ptr, size_t size);
+// Restrict the calling thread to the cores of node. Returns false if that
+// is not supported.
+extern bool BindThreadToNumaNode(int node);
+
 // For Thread Local Storage abstraction
 typedef DWORD pthread_key_t;
 
@@ -45,6 +45,7 @@ LIB_SOURCES =                                                   \
   db/repair.cc                                                  \
   db/snapshot_impl.cc                                           \
   db/table_cache.cc                                             \
+  db/table_meta_snapshot.cc                                     \
   db/table_properties_collector.cc                              \
   db/transaction_log_impl.cc                                    \
   db/version_builder.cc                                         \
@@ -69,12 +70,14 @@ LIB_SOURCES =                                                   \
   memtable/vectorrep.cc                                         \
   memtable/write_buffer_manager.cc                              \
   monitoring/histogram.cc                                       \
+  monitoring/histogram_hdr.cc                                   \
   monitoring/histogram_windowing.cc                             \
   monitoring/instrumented_mutex.cc                              \
   monitoring/iostats_context.cc                                 \
   monitoring/perf_context.cc                                    \
   monitoring/perf_level.cc                                      \
   monitoring/statistics.cc                                      \
+  monitoring/stats_history.cc                                   \
   monitoring/thread_status_impl.cc                              \
   monitoring/thread_status_updater.cc                           \
   monitoring/thread_status_updater_debug.cc                     \
@@ -121,6 +124,7 @@ LIB_SOURCES =                                                   \
   tools/dump/db_dump_tool.cc                                    \
   util/arena.cc                                                 \
   util/auto_roll_logger.cc                                      \
+  util/block_cache_tracer.cc                                    \
   util/bloom.cc                                                 \
   util/build_version.cc                                         \
   util/coding.cc                                                \
@@ -136,6 +140,7 @@ LIB_SOURCES =                                                   \
   util/filename.cc                                              \
   util/filter_policy.cc                                         \
   util/hash.cc                                                  \
+  util/huge_page_allocator.cc                                   \
   util/log_buffer.cc                                            \
   util/murmurhash.cc                                            \
   util/random.cc                                                \
@@ -148,6 +153,7 @@ LIB_SOURCES =                                                   \
   util/sync_point.cc                                            \
   util/thread_local.cc                                          \
   util/threadpool_imp.cc                                        \
+  util/trace_replay.cc                                          \
   util/transaction_test_util.cc                                 \
   util/xxhash.cc                                                \
   utilities/backupable/backupable_db.cc                         \
@@ -187,9 +193,11 @@ LIB_SOURCES =                                                   \
   utilities/persistent_cache/persistent_cache_tier.cc           \
   utilities/persistent_cache/volatile_tier_impl.cc              \
   utilities/redis/redis_lists.cc                                \
+  utilities/simulator_cache/cache_simulator.cc                  \
   utilities/simulator_cache/sim_cache.cc                        \
   utilities/spatialdb/spatial_db.cc                             \
   utilities/table_properties_collectors/compact_on_deletion_collector.cc \
+  utilities/trace/file_trace_reader_writer.cc                   \
   utilities/transactions/optimistic_transaction_db_impl.cc      \
   utilities/transactions/optimistic_transaction_impl.cc         \
   utilities/transactions/transaction_base.cc                    \
@@ -294,6 +302,7 @@ MAIN_SOURCES =                                                    \
   monitoring/histogram_test.cc                                          \
   monitoring/iostats_context_test.cc                                    \
   monitoring/statistics_test.cc                                         \
+  monitoring/stats_history_test.cc                                      \
   options/options_test.cc                                               \
   table/block_based_filter_block_test.cc                                \
   table/block_test.cc                                                   \
@@ -319,6 +328,7 @@ MAIN_SOURCES =                                                    \
   util/dynamic_bloom_test.cc                                            \
   util/event_logger_test.cc                                             \
   util/filelock_test.cc                                                 \
+  util/huge_page_allocator_test.cc                                      \
   util/log_write_bench.cc                                               \
   util/rate_limiter_test.cc                                             \
   util/slice_transform_test.cc                                          \
@@ -346,6 +356,7 @@ MAIN_SOURCES =                                                    \
   utilities/option_change_migration/option_change_migration_test.cc     \
   utilities/options/options_util_test.cc                                \
   utilities/redis/redis_lists_test.cc                                   \
+  utilities/simulator_cache/cache_simulator_test.cc                     \
   utilities/simulator_cache/sim_cache_test.cc                           \
   utilities/spatialdb/spatial_db_test.cc                                \
   utilities/table_properties_collectors/compact_on_deletion_collector_test.cc  \
@@ -10,6 +10,7 @@
 #pragma once
 #include <stddef.h>
 #include <stdint.h>
+#include <memory>
 #include <string>
 #include <vector>
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
@@ -37,6 +38,7 @@ struct BlockContents;
 class Comparator;
 class BlockIter;
 class BlockPrefixIndex;
+class PersistentCache;
 
 // BlockReadAmpBitmap is a bitmap that map the rocksdb::Block data bytes to
 // a bitmap with ratio bytes_per_bit. Whenever we access a range of bytes in
@@ -171,11 +173,9 @@ class Block {
 	}
 	size_t usable_size() const
 	{
-#ifdef ROCKSDB_MALLOC_USABLE_SIZE
 		if (contents_.allocation.get() != nullptr) {
-			return malloc_usable_size(contents_.allocation.get());
+			return contents_.usable_size();
 		}
-#endif // ROCKSDB_MALLOC_USABLE_SIZE
 		return size_;
 	}
 	uint32_t NumRestarts() const;
@@ -211,6 +211,18 @@ class Block {
 		return global_seqno_;
 	}
 
+	// The persistent cache this block goes to when the block cache evicts
+	// it, or nullptr
+	std::shared_ptr<PersistentCache> admit_on_eviction() const
+	{
+		return admit_on_eviction_.lock();
+	}
+	void set_admit_on_eviction(
+		const std::shared_ptr<PersistentCache> &persistent_cache)
+	{
+		admit_on_eviction_ = persistent_cache;
+	}
+
     private:
 	BlockContents contents_;
 	const char *data_; // contents_.data.data()
@@ -221,6 +233,8 @@ class Block {
 	// All keys in the block will have seqno = global_seqno_, regardless of
 	// the encoded value (kDisableGlobalSequenceNumber means disabled)
 	const SequenceNumber global_seqno_;
+	// Weak, the block cache must not keep the persistent cache alive
+	std::weak_ptr<PersistentCache> admit_on_eviction_;
 
 	// No copying allowed
 	Block(const Block &);
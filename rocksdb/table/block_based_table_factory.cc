@@ -45,6 +45,7 @@ BlockBasedTableFactory::BlockBasedTableFactory(
 	if (table_options_.index_block_restart_interval < 1) {
 		table_options_.index_block_restart_interval = 1;
 	}
+	BlockBasedTable::SetupEvictionAdmission(table_options_);
 }
 
 Status BlockBasedTableFactory::NewTableReader(
@@ -58,7 +59,8 @@ Status BlockBasedTableFactory::NewTableReader(
 		table_options_, table_reader_options.internal_comparator,
 		std::move(file), file_size, table_reader,
 		prefetch_index_and_filter_in_cache,
-		table_reader_options.skip_filters, table_reader_options.level);
+		table_reader_options.skip_filters, table_reader_options.level,
+		table_reader_options.block_cache_tracer);
 }
 
 TableBuilder *BlockBasedTableFactory::NewTableBuilder(
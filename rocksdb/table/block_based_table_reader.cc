@@ -72,6 +72,8 @@ namespace
 // On success fill *result and return OK - caller owns *result
 // @param compression_dict Data for presetting the compression library's
 //    dictionary.
+// @param memory_allocator Allocator for the block's memory, nullptr for the
+//    default heap.
 Status ReadBlockFromFile(RandomAccessFileReader *file, const Footer &footer,
 			 const ReadOptions &options, const BlockHandle &handle,
 			 std::unique_ptr<Block> *result,
@@ -79,12 +81,13 @@ Status ReadBlockFromFile(RandomAccessFileReader *file, const Footer &footer,
 			 const Slice &compression_dict,
 			 const PersistentCacheOptions &cache_options,
 			 SequenceNumber global_seqno,
-			 size_t read_amp_bytes_per_bit)
+			 size_t read_amp_bytes_per_bit,
+			 MemoryAllocator *memory_allocator)
 {
 	BlockContents contents;
 	Status s = ReadBlockContents(file, footer, options, handle, &contents,
 				     ioptions, do_uncompress, compression_dict,
-				     cache_options);
+				     cache_options, memory_allocator);
 	if (s.ok()) {
 		result->reset(new Block(std::move(contents), global_seqno,
 					read_amp_bytes_per_bit,
@@ -94,6 +97,16 @@ Status ReadBlockFromFile(RandomAccessFileReader *file, const Footer &footer,
 	return s;
 }
 
+// The allocator of the table's block cache, used for every block the table
+// reader allocates.
+MemoryAllocator *
+GetMemoryAllocator(const BlockBasedTableOptions &table_options)
+{
+	return table_options.block_cache ?
+		       table_options.block_cache->memory_allocator() :
+		       nullptr;
+}
+
 // Delete the resource that is held by the iterator.
 template <class ResourceType> void DeleteHeldResource(void *arg, void *ignored)
 {
@@ -172,7 +185,8 @@ class PartitionIndexReader : public IndexReader, public Cleanable {
 			     const InternalKeyComparator *icomparator,
 			     IndexReader **index_reader,
 			     const PersistentCacheOptions &cache_options,
-			     const int level)
+			     const int level,
+			     MemoryAllocator *memory_allocator)
 	{
 		std::unique_ptr<Block> index_block;
 		auto s = ReadBlockFromFile(file, footer, ReadOptions(),
@@ -181,7 +195,8 @@ class PartitionIndexReader : public IndexReader, public Cleanable {
 					   Slice() /*compression dict*/,
 					   cache_options,
 					   kDisableGlobalSequenceNumber,
-					   0 /* read_amp_bytes_per_bit */);
+					   0 /* read_amp_bytes_per_bit */,
+					   memory_allocator);
 
 		if (s.ok()) {
 			*index_reader = new PartitionIndexReader(
@@ -263,7 +278,8 @@ class BinarySearchIndexReader : public IndexReader {
 			     const ImmutableCFOptions &ioptions,
 			     const InternalKeyComparator *icomparator,
 			     IndexReader **index_reader,
-			     const PersistentCacheOptions &cache_options)
+			     const PersistentCacheOptions &cache_options,
+			     MemoryAllocator *memory_allocator)
 	{
 		std::unique_ptr<Block> index_block;
 		auto s = ReadBlockFromFile(file, footer, ReadOptions(),
@@ -272,7 +288,8 @@ class BinarySearchIndexReader : public IndexReader {
 					   Slice() /*compression dict*/,
 					   cache_options,
 					   kDisableGlobalSequenceNumber,
-					   0 /* read_amp_bytes_per_bit */);
+					   0 /* read_amp_bytes_per_bit */,
+					   memory_allocator);
 
 		if (s.ok()) {
 			*index_reader = new BinarySearchIndexReader(
@@ -328,7 +345,8 @@ class HashIndexReader : public IndexReader {
 			     InternalIterator *meta_index_iter,
 			     IndexReader **index_reader,
 			     bool hash_index_allow_collision,
-			     const PersistentCacheOptions &cache_options)
+			     const PersistentCacheOptions &cache_options,
+			     MemoryAllocator *memory_allocator)
 	{
 		std::unique_ptr<Block> index_block;
 		auto s = ReadBlockFromFile(file, footer, ReadOptions(),
@@ -337,7 +355,8 @@ class HashIndexReader : public IndexReader {
 					   Slice() /*compression dict*/,
 					   cache_options,
 					   kDisableGlobalSequenceNumber,
-					   0 /* read_amp_bytes_per_bit */);
+					   0 /* read_amp_bytes_per_bit */,
+					   memory_allocator);
 
 		if (!s.ok()) {
 			return s;
@@ -377,7 +396,7 @@ class HashIndexReader : public IndexReader {
 				      prefixes_handle, &prefixes_contents,
 				      ioptions, true /* decompress */,
 				      Slice() /*compression dict*/,
-				      cache_options);
+				      cache_options, memory_allocator);
 		if (!s.ok()) {
 			return s;
 		}
@@ -387,7 +406,7 @@ class HashIndexReader : public IndexReader {
 				      &prefixes_meta_contents, ioptions,
 				      true /* decompress */,
 				      Slice() /*compression dict*/,
-				      cache_options);
+				      cache_options, memory_allocator);
 		if (!s.ok()) {
 			// TODO: log error
 			return Status::OK();
@@ -463,7 +482,13 @@ void BlockBasedTable::SetupCacheKeyPrefix(Rep *rep, uint64_t file_size)
 		rep->dummy_index_reader_offset =
 			file_size + rep->table_options.block_cache->NewId();
 	}
-	if (rep->table_options.persistent_cache != nullptr) {
+	if (AdmitsEvictedBlocks(rep->table_options)) {
+		// Evicted blocks are admitted under their block cache key
+		memcpy(rep->persistent_cache_key_prefix, rep->cache_key_prefix,
+		       rep->cache_key_prefix_size);
+		rep->persistent_cache_key_prefix_size =
+			rep->cache_key_prefix_size;
+	} else if (rep->table_options.persistent_cache != nullptr) {
 		GenerateCachePrefix(/*cache=*/nullptr, rep->file->file(),
 				    &rep->persistent_cache_key_prefix[0],
 				    &rep->persistent_cache_key_prefix_size);
@@ -504,6 +529,49 @@ void BlockBasedTable::GenerateCachePrefix(Cache *cc, WritableFile *file,
 	}
 }
 
+bool BlockBasedTable::AdmitsEvictedBlocks(
+	const BlockBasedTableOptions &table_options)
+{
+	return table_options.block_cache != nullptr &&
+	       table_options.persistent_cache != nullptr &&
+	       !table_options.persistent_cache->IsCompressed();
+}
+
+namespace
+{
+// Eviction callback of the block caches that admit evicted blocks into a
+// persistent cache. Every block carries the persistent cache of its table,
+// so one block cache can serve tables of several persistent caches.
+void AdmitEvictedBlock(const Slice &key, void *value,
+		       void (*deleter)(const Slice &key, void *value))
+{
+	// Index readers and filters are cached with their own deleters and
+	// are not worth a trip to the device.
+	if (deleter != &DeleteCachedEntry<Block>) {
+		return;
+	}
+	auto block = reinterpret_cast<Block *>(value);
+	auto persistent_cache = block->admit_on_eviction();
+	if (persistent_cache == nullptr ||
+	    block->compression_type() != kNoCompression || block->size() == 0) {
+		return;
+	}
+	// Pipelined persistent caches only queue the insert
+	persistent_cache->Insert(key, block->data(), block->size());
+}
+} // namespace
+
+void BlockBasedTable::SetupEvictionAdmission(
+	const BlockBasedTableOptions &table_options)
+{
+	if (!AdmitsEvictedBlocks(table_options)) {
+		return;
+	}
+	// The callback is the same for every factory, registering it again
+	// for another persistent cache keeps the earlier ones working
+	table_options.block_cache->SetEvictionCallback(&AdmitEvictedBlock);
+}
+
 namespace
 {
 // Return True if table_properties has `user_prop_name` has a `true` value
@@ -597,9 +665,12 @@ Status BlockBasedTable::Open(const ImmutableCFOptions &ioptions,
 			     uint64_t file_size,
 			     unique_ptr<TableReader> *table_reader,
 			     const bool prefetch_index_and_filter_in_cache,
-			     const bool skip_filters, const int level)
+			     const bool skip_filters, const int level,
+			     BlockCacheTracer *block_cache_tracer)
 {
 	table_reader->reset();
+	// The only block cache lookups while opening are the prefetches
+	BlockCacheTraceCallerGuard caller_guard(kTracePrefetch);
 
 	Footer footer;
 
@@ -627,6 +698,8 @@ Status BlockBasedTable::Open(const ImmutableCFOptions &ioptions,
 					 internal_comparator, skip_filters);
 	rep->file = std::move(file);
 	rep->footer = footer;
+	rep->level = level;
+	rep->block_cache_tracer = block_cache_tracer;
 	rep->index_type = table_options.index_type;
 	rep->hash_index_allow_collision =
 		table_options.hash_index_allow_collision;
@@ -643,6 +716,8 @@ Status BlockBasedTable::Open(const ImmutableCFOptions &ioptions,
 		std::string(rep->persistent_cache_key_prefix,
 			    rep->persistent_cache_key_prefix_size),
 		rep->ioptions.statistics);
+	rep->persistent_cache_options.admit_on_eviction =
+		AdmitsEvictedBlocks(table_options);
 
 	// Read meta index
 	std::unique_ptr<Block> meta;
@@ -920,7 +995,8 @@ Status BlockBasedTable::ReadMetaBlock(Rep *rep,
 		rep->footer.metaindex_handle(), &meta, rep->ioptions,
 		true /* decompress */, Slice() /*compression dict*/,
 		rep->persistent_cache_options, kDisableGlobalSequenceNumber,
-		0 /* read_amp_bytes_per_bit */);
+		0 /* read_amp_bytes_per_bit */,
+		GetMemoryAllocator(rep->table_options));
 
 	if (!s.ok()) {
 		ROCKS_LOG_ERROR(
@@ -943,7 +1019,8 @@ Status BlockBasedTable::GetDataBlockFromCache(
 	const ImmutableCFOptions &ioptions, const ReadOptions &read_options,
 	BlockBasedTable::CachableEntry<Block> *block, uint32_t format_version,
 	const Slice &compression_dict, size_t read_amp_bytes_per_bit,
-	bool is_index)
+	bool is_index,
+	const std::shared_ptr<PersistentCache> &admit_on_eviction)
 {
 	Status s;
 	Block *compressed_block = nullptr;
@@ -990,9 +1067,10 @@ Status BlockBasedTable::GetDataBlockFromCache(
 
 	// Retrieve the uncompressed contents into a new buffer
 	BlockContents contents;
-	s = UncompressBlockContents(compressed_block->data(),
-				    compressed_block->size(), &contents,
-				    format_version, compression_dict, ioptions);
+	s = UncompressBlockContents(
+		compressed_block->data(), compressed_block->size(), &contents,
+		format_version, compression_dict, ioptions,
+		block_cache ? block_cache->memory_allocator() : nullptr);
 
 	// Insert uncompressed block into block cache
 	if (s.ok()) {
@@ -1003,6 +1081,7 @@ Status BlockBasedTable::GetDataBlockFromCache(
 		assert(block->value->compression_type() == kNoCompression);
 		if (block_cache != nullptr && block->value->cachable() &&
 		    read_options.fill_cache) {
+			block->value->set_admit_on_eviction(admit_on_eviction);
 			s = block_cache->Insert(block_cache_key, block->value,
 						block->value->usable_size(),
 						&DeleteCachedEntry<Block>,
@@ -1048,7 +1127,8 @@ Status BlockBasedTable::PutDataBlockToCache(
 	const ReadOptions &read_options, const ImmutableCFOptions &ioptions,
 	CachableEntry<Block> *block, Block *raw_block, uint32_t format_version,
 	const Slice &compression_dict, size_t read_amp_bytes_per_bit,
-	bool is_index, Cache::Priority priority)
+	bool is_index, Cache::Priority priority,
+	const std::shared_ptr<PersistentCache> &admit_on_eviction)
 {
 	assert(raw_block->compression_type() == kNoCompression ||
 	       block_cache_compressed != nullptr);
@@ -1058,10 +1138,11 @@ Status BlockBasedTable::PutDataBlockToCache(
 	BlockContents contents;
 	Statistics *statistics = ioptions.statistics;
 	if (raw_block->compression_type() != kNoCompression) {
-		s = UncompressBlockContents(raw_block->data(),
-					    raw_block->size(), &contents,
-					    format_version, compression_dict,
-					    ioptions);
+		s = UncompressBlockContents(
+			raw_block->data(), raw_block->size(), &contents,
+			format_version, compression_dict, ioptions,
+			block_cache ? block_cache->memory_allocator() :
+				      nullptr);
 	}
 	if (!s.ok()) {
 		delete raw_block;
@@ -1073,6 +1154,22 @@ Status BlockBasedTable::PutDataBlockToCache(
 					 raw_block->global_seqno(),
 					 read_amp_bytes_per_bit,
 					 statistics); // uncompressed block
+	} else if (block_cache != nullptr &&
+		   block_cache_compressed != nullptr &&
+		   block_cache->memory_allocator() !=
+			   block_cache_compressed->memory_allocator()) {
+		// The raw block was read with the compressed cache's allocator;
+		// the copy charged to block_cache must come from its own.
+		CacheAllocationPtr copy = AllocateBlock(
+			raw_block->size(), block_cache->memory_allocator());
+		memcpy(copy.get(), raw_block->data(), raw_block->size());
+		block->value = new Block(
+			BlockContents(std::move(copy), raw_block->size(),
+				      raw_block->cachable(), kNoCompression),
+			raw_block->global_seqno(), read_amp_bytes_per_bit,
+			statistics);
+		delete raw_block;
+		raw_block = nullptr;
 	} else {
 		block->value = raw_block;
 		raw_block = nullptr;
@@ -1100,6 +1197,7 @@ Status BlockBasedTable::PutDataBlockToCache(
 	// insert into uncompressed block cache
 	assert((block->value->compression_type() == kNoCompression));
 	if (block_cache != nullptr && block->value->cachable()) {
+		block->value->set_admit_on_eviction(admit_on_eviction);
 		s = block_cache->Insert(block_cache_key, block->value,
 					block->value->usable_size(),
 					&DeleteCachedEntry<Block>,
@@ -1149,7 +1247,8 @@ BlockBasedTable::ReadFilter(const BlockHandle &filter_handle,
 			       filter_handle, &block, rep->ioptions,
 			       false /* decompress */,
 			       Slice() /*compression dict*/,
-			       rep->persistent_cache_options)
+			       rep->persistent_cache_options,
+			       GetMemoryAllocator(rep->table_options))
 		     .ok()) {
 		// Error reading the block
 		return nullptr;
@@ -1247,11 +1346,20 @@ BlockBasedTable::GetFilter(const BlockHandle &filter_blk_handle,
 	if (cache_handle != nullptr) {
 		filter = reinterpret_cast<FilterBlockReader *>(
 			block_cache->Value(cache_handle));
+		TraceBlockCacheAccess(rep_, key, kTraceFilterBlock,
+				      block_cache->GetUsage(cache_handle),
+				      true /* is_hit */, false /* no_insert */);
 	} else if (no_io) {
+		TraceBlockCacheAccess(rep_, key, kTraceFilterBlock, 0,
+				      false /* is_hit */, true /* no_insert */);
 		// Do not invoke any io.
 		return CachableEntry<FilterBlockReader>();
 	} else {
 		filter = ReadFilter(filter_blk_handle, is_a_filter_partition);
+		TraceBlockCacheAccess(rep_, key, kTraceFilterBlock,
+				      filter ? filter->size() : 0,
+				      false /* is_hit */,
+				      false /* no_insert */);
 		if (filter != nullptr) {
 			assert(filter->size() > 0);
 			Status s = block_cache->Insert(
@@ -1310,8 +1418,17 @@ BlockBasedTable::NewIndexIterator(const ReadOptions &read_options,
 	auto cache_handle =
 		GetEntryFromCache(block_cache, key, BLOCK_CACHE_INDEX_MISS,
 				  BLOCK_CACHE_INDEX_HIT, statistics);
+	if (cache_handle != nullptr) {
+		PERF_COUNTER_BY_LEVEL_ADD(block_cache_hit_count, 1,
+					  rep_->level);
+	} else {
+		PERF_COUNTER_BY_LEVEL_ADD(block_cache_miss_count, 1,
+					  rep_->level);
+	}
 
 	if (cache_handle == nullptr && no_io) {
+		TraceBlockCacheAccess(rep_, key, kTraceIndexBlock, 0,
+				      false /* is_hit */, true /* no_insert */);
 		if (input_iter != nullptr) {
 			input_iter->SetStatus(
 				Status::Incomplete("no blocking io"));
@@ -1326,11 +1443,22 @@ BlockBasedTable::NewIndexIterator(const ReadOptions &read_options,
 	if (cache_handle != nullptr) {
 		index_reader = reinterpret_cast<IndexReader *>(
 			block_cache->Value(cache_handle));
+		TraceBlockCacheAccess(rep_, key, kTraceIndexBlock,
+				      block_cache->GetUsage(cache_handle),
+				      true /* is_hit */, false /* no_insert */);
 	} else {
 		// Create index reader and put it in the cache.
 		Status s;
 		TEST_SYNC_POINT("BlockBasedTable::NewIndexIterator::thread2:2");
-		s = CreateIndexReader(&index_reader);
+		{
+			PERF_TIMER_BY_LEVEL_GUARD(block_read_time, rep_->level);
+			s = CreateIndexReader(&index_reader);
+		}
+		PERF_COUNTER_BY_LEVEL_ADD(block_read_count, 1, rep_->level);
+		PERF_COUNTER_BY_LEVEL_ADD(
+			block_read_byte,
+			rep_->footer.index_handle().size() + kBlockTrailerSize,
+			rep_->level);
 		TEST_SYNC_POINT("BlockBasedTable::NewIndexIterator::thread1:1");
 		TEST_SYNC_POINT("BlockBasedTable::NewIndexIterator::thread2:3");
 		TEST_SYNC_POINT("BlockBasedTable::NewIndexIterator::thread1:4");
@@ -1345,6 +1473,10 @@ BlockBasedTable::NewIndexIterator(const ReadOptions &read_options,
 					      Cache::Priority::LOW);
 		}
 
+		TraceBlockCacheAccess(
+			rep_, key, kTraceIndexBlock,
+			index_reader ? index_reader->usable_size() : 0,
+			false /* is_hit */, false /* no_insert */);
 		if (s.ok()) {
 			size_t usable_size = index_reader->usable_size();
 			RecordTick(statistics, BLOCK_CACHE_ADD);
@@ -1433,11 +1565,21 @@ InternalIterator *BlockBasedTable::NewDataBlockIterator(
 			}
 		}
 		std::unique_ptr<Block> block_value;
-		s = ReadBlockFromFile(
-			rep->file.get(), rep->footer, ro, handle, &block_value,
-			rep->ioptions, true /* compress */, compression_dict,
-			rep->persistent_cache_options, rep->global_seqno,
-			rep->table_options.read_amp_bytes_per_bit);
+		{
+			PERF_TIMER_BY_LEVEL_GUARD(block_read_time, rep->level);
+			s = ReadBlockFromFile(
+				rep->file.get(), rep->footer, ro, handle,
+				&block_value, rep->ioptions,
+				true /* compress */, compression_dict,
+				rep->persistent_cache_options,
+				rep->global_seqno,
+				rep->table_options.read_amp_bytes_per_bit,
+				GetMemoryAllocator(rep->table_options));
+		}
+		PERF_COUNTER_BY_LEVEL_ADD(block_read_count, 1, rep->level);
+		PERF_COUNTER_BY_LEVEL_ADD(block_read_byte,
+					  handle.size() + kBlockTrailerSize,
+					  rep->level);
 		if (s.ok()) {
 			block.value = block_value.release();
 		}
@@ -1502,17 +1644,37 @@ Status BlockBasedTable::MaybeLoadDataBlockToCache(
 				compressed_cache_key);
 		}
 
+		// the persistent cache the block cache evicts the block into
+		const std::shared_ptr<PersistentCache> no_persistent_cache;
+		const std::shared_ptr<PersistentCache> &admit_on_eviction =
+			rep->persistent_cache_options.admit_on_eviction ?
+				rep->persistent_cache_options.persistent_cache :
+				no_persistent_cache;
+
 		s = GetDataBlockFromCache(
 			key, ckey, block_cache, block_cache_compressed,
 			rep->ioptions, ro, block_entry,
 			rep->table_options.format_version, compression_dict,
-			rep->table_options.read_amp_bytes_per_bit, is_index);
+			rep->table_options.read_amp_bytes_per_bit, is_index,
+			admit_on_eviction);
+		const bool is_hit = block_entry->cache_handle != nullptr;
+		if (block_cache != nullptr) {
+			if (is_hit) {
+				PERF_COUNTER_BY_LEVEL_ADD(block_cache_hit_count,
+							  1, rep->level);
+			} else {
+				PERF_COUNTER_BY_LEVEL_ADD(
+					block_cache_miss_count, 1, rep->level);
+			}
+		}
 
 		if (block_entry->value == nullptr && !no_io && ro.fill_cache) {
 			std::unique_ptr<Block> raw_block;
 			{
 				StopWatch sw(rep->ioptions.env, statistics,
 					     READ_BLOCK_GET_MICROS);
+				PERF_TIMER_BY_LEVEL_GUARD(block_read_time,
+							  rep->level);
 				s = ReadBlockFromFile(
 					rep->file.get(), rep->footer, ro,
 					handle, &raw_block, rep->ioptions,
@@ -1521,8 +1683,17 @@ Status BlockBasedTable::MaybeLoadDataBlockToCache(
 					rep->persistent_cache_options,
 					rep->global_seqno,
 					rep->table_options
-						.read_amp_bytes_per_bit);
+						.read_amp_bytes_per_bit,
+					(block_cache_compressed == nullptr ?
+						 block_cache :
+						 block_cache_compressed)
+						->memory_allocator());
 			}
+			PERF_COUNTER_BY_LEVEL_ADD(block_read_count, 1,
+						  rep->level);
+			PERF_COUNTER_BY_LEVEL_ADD(
+				block_read_byte,
+				handle.size() + kBlockTrailerSize, rep->level);
 
 			if (s.ok()) {
 				s = PutDataBlockToCache(
@@ -1538,13 +1709,48 @@ Status BlockBasedTable::MaybeLoadDataBlockToCache(
 					is_index && rep->table_options
 								.cache_index_and_filter_blocks_with_high_priority ?
 						      Cache::Priority::HIGH :
-						      Cache::Priority::LOW);
+						      Cache::Priority::LOW,
+					admit_on_eviction);
 			}
 		}
+		if (block_cache != nullptr) {
+			TraceBlockCacheAccess(
+				rep, key,
+				is_index ? kTraceIndexBlock : kTraceDataBlock,
+				block_entry->value ?
+					block_entry->value->usable_size() :
+					0,
+				is_hit, !ro.fill_cache);
+		}
 	}
 	return s;
 }
 
+void BlockBasedTable::TraceBlockCacheAccess(const Rep *rep,
+					    const Slice &block_key,
+					    BlockCacheTraceBlockType block_type,
+					    uint64_t block_size, bool is_hit,
+					    bool no_insert)
+{
+	BlockCacheTracer *tracer = rep->block_cache_tracer;
+	if (tracer == nullptr || !tracer->is_tracing_enabled()) {
+		return;
+	}
+	BlockCacheTraceRecord record;
+	record.access_timestamp = rep->ioptions.env->NowMicros();
+	record.block_key = block_key.ToString();
+	record.block_type = block_type;
+	record.block_size = block_size;
+	if (rep->table_properties) {
+		record.cf_id = rep->table_properties->column_family_id;
+	}
+	record.level = rep->level;
+	record.caller = GetBlockCacheTraceCaller();
+	record.is_cache_hit = is_hit;
+	record.no_insert = no_insert;
+	tracer->WriteBlockAccess(record);
+}
+
 BlockBasedTable::BlockEntryIteratorState::BlockEntryIteratorState(
 	BlockBasedTable *table, const ReadOptions &read_options,
 	const InternalKeyComparator *icomparator, bool skip_filters,
@@ -1788,6 +1994,7 @@ Status BlockBasedTable::Get(const ReadOptions &read_options, const Slice &key,
 			    GetContext *get_context, bool skip_filters)
 {
 	Status s;
+	BlockCacheTraceCallerGuard caller_guard(kTraceUserGet);
 	const bool no_io = read_options.read_tier == kBlockCacheTier;
 	CachableEntry<FilterBlockReader> filter_entry;
 	if (!skip_filters) {
@@ -1795,11 +2002,21 @@ Status BlockBasedTable::Get(const ReadOptions &read_options, const Slice &key,
 			GetFilter(read_options.read_tier == kBlockCacheTier);
 	}
 	FilterBlockReader *filter = filter_entry.value;
+	// Whether to tell the full filter positives that were true from the
+	// false ones for the per-level perf context
+	const bool count_full_positives =
+		filter != nullptr && !filter->IsBlockBased() &&
+		perf_level >= PerfLevel::kEnableCount &&
+		get_perf_context()->per_level_perf_context_enabled;
+	const Comparator *ucmp =
+		rep_->internal_comparator.user_comparator();
+	bool matched = false;
 
 	// First check the full filter
 	// If full filter not useful, Then go into each block
 	if (!FullFilterKeyMayMatch(read_options, filter, key, no_io)) {
 		RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
+		PERF_COUNTER_BY_LEVEL_ADD(bloom_filter_useful, 1, rep_->level);
 	} else {
 		BlockIter iiter_on_stack;
 		auto iiter = NewIndexIterator(read_options, &iiter_on_stack);
@@ -1826,6 +2043,8 @@ Status BlockBasedTable::Get(const ReadOptions &read_options, const Slice &key,
 				// cross one data block, we should be fine.
 				RecordTick(rep_->ioptions.statistics,
 					   BLOOM_FILTER_USEFUL);
+				PERF_COUNTER_BY_LEVEL_ADD(bloom_filter_useful,
+							  1, rep_->level);
 				break;
 			} else {
 				BlockIter biter;
@@ -1853,6 +2072,11 @@ Status BlockBasedTable::Get(const ReadOptions &read_options, const Slice &key,
 							      &parsed_key)) {
 						s = Status::Corruption(Slice());
 					}
+					if (count_full_positives && !matched) {
+						matched = ucmp->Equal(
+							parsed_key.user_key,
+							ExtractUserKey(key));
+					}
 
 					if (!get_context->SaveValue(
 						    parsed_key, biter.value(),
@@ -1871,6 +2095,15 @@ Status BlockBasedTable::Get(const ReadOptions &read_options, const Slice &key,
 		if (s.ok()) {
 			s = iiter->status();
 		}
+		if (count_full_positives) {
+			PERF_COUNTER_BY_LEVEL_ADD(bloom_filter_full_positive, 1,
+						  rep_->level);
+			if (matched) {
+				PERF_COUNTER_BY_LEVEL_ADD(
+					bloom_filter_full_true_positive, 1,
+					rep_->level);
+			}
+		}
 	}
 
 	// if rep_->filter_entry is not set, we should call Release(); otherwise
@@ -2010,13 +2243,15 @@ BlockBasedTable::CreateIndexReader(IndexReader **index_reader,
 		return PartitionIndexReader::Create(
 			this, file, footer, footer.index_handle(),
 			rep_->ioptions, icomparator, index_reader,
-			rep_->persistent_cache_options, level);
+			rep_->persistent_cache_options, level,
+			GetMemoryAllocator(rep_->table_options));
 	}
 	case BlockBasedTableOptions::kBinarySearch: {
 		return BinarySearchIndexReader::Create(
 			file, footer, footer.index_handle(), rep_->ioptions,
 			icomparator, index_reader,
-			rep_->persistent_cache_options);
+			rep_->persistent_cache_options,
+			GetMemoryAllocator(rep_->table_options));
 	}
 	case BlockBasedTableOptions::kHashSearch: {
 		std::unique_ptr<Block> meta_guard;
@@ -2036,7 +2271,9 @@ BlockBasedTable::CreateIndexReader(IndexReader **index_reader,
 					file, footer, footer.index_handle(),
 					rep_->ioptions, icomparator,
 					index_reader,
-					rep_->persistent_cache_options);
+					rep_->persistent_cache_options,
+					GetMemoryAllocator(
+						rep_->table_options));
 			}
 			meta_index_iter = meta_iter_guard.get();
 		}
@@ -2046,7 +2283,8 @@ BlockBasedTable::CreateIndexReader(IndexReader **index_reader,
 			rep_->ioptions, icomparator, footer.index_handle(),
 			meta_index_iter, index_reader,
 			rep_->hash_index_allow_collision,
-			rep_->persistent_cache_options);
+			rep_->persistent_cache_options,
+			GetMemoryAllocator(rep_->table_options));
 	}
 	default: {
 		std::string error_message = "Unrecognized index type: " +
@@ -2247,7 +2485,9 @@ Status BlockBasedTable::DumpTable(WritableFile *out_file)
 					    rep_->ioptions,
 					    false /*decompress*/,
 					    Slice() /*compression dict*/,
-					    rep_->persistent_cache_options)
+					    rep_->persistent_cache_options,
+					    GetMemoryAllocator(
+						    rep_->table_options))
 					    .ok()) {
 					rep_->filter.reset(
 						new BlockBasedFilterBlockReader(
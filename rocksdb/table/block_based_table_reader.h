@@ -28,6 +28,7 @@
 #include "table/table_properties_internal.h"
 #include "table/table_reader.h"
 #include "table/two_level_iterator.h"
+#include "util/block_cache_tracer.h"
 #include "util/coding.h"
 #include "util/file_reader_writer.h"
 
@@ -93,7 +94,8 @@ class BlockBasedTable : public TableReader {
 			   uint64_t file_size,
 			   unique_ptr<TableReader> *table_reader,
 			   bool prefetch_index_and_filter_in_cache = true,
-			   bool skip_filters = false, int level = -1);
+			   bool skip_filters = false, int level = -1,
+			   BlockCacheTracer *block_cache_tracer = nullptr);
 
 	bool PrefixMayMatch(const Slice &internal_key);
 
@@ -201,6 +203,19 @@ class BlockBasedTable : public TableReader {
 				 size_t cache_key_prefix_size,
 				 const BlockHandle &handle, char *cache_key);
 
+	// Whether table_options.persistent_cache is filled with the blocks
+	// evicted from table_options.block_cache rather than the blocks read,
+	// which is the case for an uncompressed persistent cache.
+	static bool
+	AdmitsEvictedBlocks(const BlockBasedTableOptions &table_options);
+
+	// If AdmitsEvictedBlocks(), make table_options.block_cache insert the
+	// blocks it evicts into the persistent cache of their table. Several
+	// factories can share a block cache, each with its own persistent
+	// cache.
+	static void
+	SetupEvictionAdmission(const BlockBasedTableOptions &table_options);
+
 	// Retrieve all key value pairs from data blocks in the table.
 	// The key retrieved are internal keys.
 	Status
@@ -242,6 +257,13 @@ class BlockBasedTable : public TableReader {
 		Slice compression_dict, CachableEntry<Block> *block_entry,
 		bool is_index = false);
 
+	// Record a block cache lookup if the DB is tracing them.
+	static void TraceBlockCacheAccess(const Rep *rep,
+					  const Slice &block_key,
+					  BlockCacheTraceBlockType block_type,
+					  uint64_t block_size, bool is_hit,
+					  bool no_insert);
+
 	// For the following two functions:
 	// if `no_io == true`, we will not try to read filter/index from sst file
 	// were they not present in cache yet.
@@ -271,6 +293,8 @@ class BlockBasedTable : public TableReader {
 	// pointer to the block as well as its block handle.
 	// @param compression_dict Data for presetting the compression library's
 	//    dictionary.
+	// @param admit_on_eviction Persistent cache the block goes to when the
+	//    block cache evicts it, if any.
 	static Status GetDataBlockFromCache(
 		const Slice &block_cache_key,
 		const Slice &compressed_block_cache_key, Cache *block_cache,
@@ -279,7 +303,9 @@ class BlockBasedTable : public TableReader {
 		const ReadOptions &read_options,
 		BlockBasedTable::CachableEntry<Block> *block,
 		uint32_t format_version, const Slice &compression_dict,
-		size_t read_amp_bytes_per_bit, bool is_index = false);
+		size_t read_amp_bytes_per_bit, bool is_index = false,
+		const std::shared_ptr<PersistentCache> &admit_on_eviction =
+			nullptr);
 
 	// Put a raw block (maybe compressed) to the corresponding block caches.
 	// This method will perform decompression against raw_block if needed and then
@@ -291,6 +317,8 @@ class BlockBasedTable : public TableReader {
 	// responsible for releasing its memory if error occurs.
 	// @param compression_dict Data for presetting the compression library's
 	//    dictionary.
+	// @param admit_on_eviction Persistent cache the block goes to when the
+	//    block cache evicts it, if any.
 	static Status PutDataBlockToCache(
 		const Slice &block_cache_key,
 		const Slice &compressed_block_cache_key, Cache *block_cache,
@@ -299,7 +327,9 @@ class BlockBasedTable : public TableReader {
 		Block *raw_block, uint32_t format_version,
 		const Slice &compression_dict, size_t read_amp_bytes_per_bit,
 		bool is_index = false,
-		Cache::Priority pri = Cache::Priority::LOW);
+		Cache::Priority pri = Cache::Priority::LOW,
+		const std::shared_ptr<PersistentCache> &admit_on_eviction =
+			nullptr);
 
 	// Calls (*handle_result)(arg, ...) repeatedly, starting with the entry found
 	// after a call to Seek(key), until handle_result returns false.
@@ -496,6 +526,12 @@ struct BlockBasedTable::Rep {
 	// A value of kDisableGlobalSequenceNumber means that this feature is disabled
 	// and every key have it's own seqno.
 	SequenceNumber global_seqno;
+
+	// Level of the table, -1 if unknown
+	int level = -1;
+	// Records the block cache lookups of this table while the DB traces
+	// them; owned by the DB.
+	BlockCacheTracer *block_cache_tracer = nullptr;
 };
 
 } // namespace rocksdb
@@ -14,6 +14,7 @@
 
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/statistics.h"
+#include "monitoring/thread_status_util.h"
 #include "rocksdb/env.h"
 #include "table/block.h"
 #include "table/block_based_table_reader.h"
@@ -284,13 +285,15 @@ namespace
 // According to the implementation of file->Read, contents may not point to buf
 Status ReadBlock(RandomAccessFileReader *file, const Footer &footer,
 		 const ReadOptions &options, const BlockHandle &handle,
-		 Slice *contents, /* result of reading */ char *buf)
+		 Slice *contents, /* result of reading */ char *buf, Env *env)
 {
 	size_t n = static_cast<size_t>(handle.size());
 	Status s;
 
 	{
 		PERF_TIMER_GUARD(block_read_time);
+		AutoThreadStateUpdater state_updater(
+			ThreadStatus::STATE_BLOCK_READ, env);
 		s = file->Read(handle.offset(), n + kBlockTrailerSize, contents,
 			       buf);
 	}
@@ -344,12 +347,13 @@ Status ReadBlockContents(RandomAccessFileReader *file, const Footer &footer,
 			 const ImmutableCFOptions &ioptions,
 			 bool decompression_requested,
 			 const Slice &compression_dict,
-			 const PersistentCacheOptions &cache_options)
+			 const PersistentCacheOptions &cache_options,
+			 MemoryAllocator *memory_allocator)
 {
 	Status status;
 	Slice slice;
 	size_t n = static_cast<size_t>(handle.size());
-	std::unique_ptr<char[]> heap_buf;
+	CacheAllocationPtr heap_buf;
 	char stack_buf[DefaultStackBufferSize];
 	char *used_buf = nullptr;
 	rocksdb::CompressionType compression_type;
@@ -376,9 +380,11 @@ Status ReadBlockContents(RandomAccessFileReader *file, const Footer &footer,
 	if (cache_options.persistent_cache &&
 	    cache_options.persistent_cache->IsCompressed()) {
 		// lookup uncompressed cache mode p-cache
+		std::unique_ptr<char[]> raw_page;
 		status = PersistentCacheHelper::LookupRawPage(
-			cache_options, handle, &heap_buf,
+			cache_options, handle, &raw_page,
 			n + kBlockTrailerSize);
+		heap_buf.reset(raw_page.release());
 	} else {
 		status = Status::NotFound();
 	}
@@ -402,13 +408,13 @@ Status ReadBlockContents(RandomAccessFileReader *file, const Footer &footer,
 			// trivially allocated stack buffer instead of needing a full malloc()
 			used_buf = &stack_buf[0];
 		} else {
-			heap_buf = std::unique_ptr<char[]>(
-				new char[n + kBlockTrailerSize]);
+			heap_buf = AllocateBlock(n + kBlockTrailerSize,
+						 memory_allocator);
 			used_buf = heap_buf.get();
 		}
 
 		status = ReadBlock(file, footer, read_options, handle, &slice,
-				   used_buf);
+				   used_buf, ioptions.env);
 		if (status.ok() && read_options.fill_cache &&
 		    cache_options.persistent_cache &&
 		    cache_options.persistent_cache->IsCompressed()) {
@@ -432,7 +438,8 @@ Status ReadBlockContents(RandomAccessFileReader *file, const Footer &footer,
 		// compressed page, uncompress, update cache
 		status = UncompressBlockContents(slice.data(), n, contents,
 						 footer.version(),
-						 compression_dict, ioptions);
+						 compression_dict, ioptions,
+						 memory_allocator);
 	} else if (slice.data() != used_buf) {
 		// the slice content is not the buffer provided
 		*contents = BlockContents(Slice(slice.data(), n), false,
@@ -440,7 +447,7 @@ Status ReadBlockContents(RandomAccessFileReader *file, const Footer &footer,
 	} else {
 		// page is uncompressed, the buffer either stack or heap provided
 		if (used_buf == &stack_buf[0]) {
-			heap_buf = std::unique_ptr<char[]>(new char[n]);
+			heap_buf = AllocateBlock(n, memory_allocator);
 			memcpy(heap_buf.get(), stack_buf, n);
 		}
 		*contents = BlockContents(std::move(heap_buf), n, true,
@@ -449,7 +456,8 @@ Status ReadBlockContents(RandomAccessFileReader *file, const Footer &footer,
 
 	if (status.ok() && read_options.fill_cache &&
 	    cache_options.persistent_cache &&
-	    !cache_options.persistent_cache->IsCompressed()) {
+	    !cache_options.persistent_cache->IsCompressed() &&
+	    !cache_options.admit_on_eviction) {
 		// insert to uncompressed cache
 		PersistentCacheHelper::InsertUncompressedPage(
 			cache_options, handle, *contents);
@@ -461,9 +469,10 @@ Status ReadBlockContents(RandomAccessFileReader *file, const Footer &footer,
 Status UncompressBlockContentsForCompressionType(
 	const char *data, size_t n, BlockContents *contents,
 	uint32_t format_version, const Slice &compression_dict,
-	CompressionType compression_type, const ImmutableCFOptions &ioptions)
+	CompressionType compression_type, const ImmutableCFOptions &ioptions,
+	MemoryAllocator *allocator)
 {
-	std::unique_ptr<char[]> ubuf;
+	CacheAllocationPtr ubuf;
 
 	assert(compression_type != kNoCompression &&
 	       "Invalid compression type");
@@ -480,7 +489,7 @@ Status UncompressBlockContentsForCompressionType(
 		if (!Snappy_GetUncompressedLength(data, n, &ulength)) {
 			return Status::Corruption(snappy_corrupt_msg);
 		}
-		ubuf.reset(new char[ulength]);
+		ubuf = AllocateBlock(ulength, allocator);
 		if (!Snappy_Uncompress(data, n, ubuf.get())) {
 			return Status::Corruption(snappy_corrupt_msg);
 		}
@@ -489,11 +498,11 @@ Status UncompressBlockContentsForCompressionType(
 		break;
 	}
 	case kZlibCompression:
-		ubuf.reset(Zlib_Uncompress(
+		ubuf = Zlib_Uncompress(
 			data, n, &decompress_size,
 			GetCompressFormatForVersion(kZlibCompression,
 						    format_version),
-			compression_dict));
+			compression_dict, -14 /* windowBits */, allocator);
 		if (!ubuf) {
 			static char zlib_corrupt_msg[] =
 				"Zlib not supported or corrupted Zlib compressed block contents";
@@ -503,10 +512,11 @@ Status UncompressBlockContentsForCompressionType(
 					  true, kNoCompression);
 		break;
 	case kBZip2Compression:
-		ubuf.reset(BZip2_Uncompress(
+		ubuf = BZip2_Uncompress(
 			data, n, &decompress_size,
 			GetCompressFormatForVersion(kBZip2Compression,
-						    format_version)));
+						    format_version),
+			allocator);
 		if (!ubuf) {
 			static char bzip2_corrupt_msg[] =
 				"Bzip2 not supported or corrupted Bzip2 compressed block contents";
@@ -516,11 +526,11 @@ Status UncompressBlockContentsForCompressionType(
 					  true, kNoCompression);
 		break;
 	case kLZ4Compression:
-		ubuf.reset(
-			LZ4_Uncompress(data, n, &decompress_size,
-				       GetCompressFormatForVersion(
-					       kLZ4Compression, format_version),
-				       compression_dict));
+		ubuf = LZ4_Uncompress(
+			data, n, &decompress_size,
+			GetCompressFormatForVersion(kLZ4Compression,
+						    format_version),
+			compression_dict, allocator);
 		if (!ubuf) {
 			static char lz4_corrupt_msg[] =
 				"LZ4 not supported or corrupted LZ4 compressed block contents";
@@ -530,11 +540,11 @@ Status UncompressBlockContentsForCompressionType(
 					  true, kNoCompression);
 		break;
 	case kLZ4HCCompression:
-		ubuf.reset(LZ4_Uncompress(
+		ubuf = LZ4_Uncompress(
 			data, n, &decompress_size,
 			GetCompressFormatForVersion(kLZ4HCCompression,
 						    format_version),
-			compression_dict));
+			compression_dict, allocator);
 		if (!ubuf) {
 			static char lz4hc_corrupt_msg[] =
 				"LZ4HC not supported or corrupted LZ4HC compressed block contents";
@@ -544,7 +554,7 @@ Status UncompressBlockContentsForCompressionType(
 					  true, kNoCompression);
 		break;
 	case kXpressCompression:
-		ubuf.reset(XPRESS_Uncompress(data, n, &decompress_size));
+		ubuf = XPRESS_Uncompress(data, n, &decompress_size);
 		if (!ubuf) {
 			static char xpress_corrupt_msg[] =
 				"XPRESS not supported or corrupted XPRESS compressed block contents";
@@ -555,8 +565,8 @@ Status UncompressBlockContentsForCompressionType(
 		break;
 	case kZSTD:
 	case kZSTDNotFinalCompression:
-		ubuf.reset(ZSTD_Uncompress(data, n, &decompress_size,
-					   compression_dict));
+		ubuf = ZSTD_Uncompress(data, n, &decompress_size,
+				       compression_dict, allocator);
 		if (!ubuf) {
 			static char zstd_corrupt_msg[] =
 				"ZSTD not supported or corrupted ZSTD compressed block contents";
@@ -590,12 +600,13 @@ Status UncompressBlockContentsForCompressionType(
 Status UncompressBlockContents(const char *data, size_t n,
 			       BlockContents *contents, uint32_t format_version,
 			       const Slice &compression_dict,
-			       const ImmutableCFOptions &ioptions)
+			       const ImmutableCFOptions &ioptions,
+			       MemoryAllocator *allocator)
 {
 	assert(data[n] != kNoCompression);
 	return UncompressBlockContentsForCompressionType(
 		data, n, contents, format_version, compression_dict,
-		(CompressionType)data[n], ioptions);
+		(CompressionType)data[n], ioptions, allocator);
 }
 
 } // namespace rocksdb
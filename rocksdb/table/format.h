@@ -10,6 +10,14 @@
 #pragma once
 #include <string>
 #include <stdint.h>
+#ifdef ROCKSDB_MALLOC_USABLE_SIZE
+#ifdef OS_FREEBSD
+#include <malloc_np.h>
+#else
+#include <malloc.h>
+#endif
+#endif
+#include "rocksdb/memory_allocator.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
 #include "rocksdb/options.h"
@@ -229,7 +237,7 @@ struct BlockContents {
 	Slice data; // Actual contents of data
 	bool cachable; // True iff data can be cached
 	CompressionType compression_type;
-	std::unique_ptr<char[]> allocation;
+	CacheAllocationPtr allocation;
 
 	BlockContents() : cachable(false), compression_type(kNoCompression)
 	{
@@ -244,12 +252,38 @@ struct BlockContents {
 
 	BlockContents(std::unique_ptr<char[]> &&_data, size_t _size,
 		      bool _cachable, CompressionType _compression_type)
+		: data(_data.get(), _size), cachable(_cachable),
+		  compression_type(_compression_type),
+		  allocation(_data.release())
+	{
+	}
+
+	BlockContents(CacheAllocationPtr &&_data, size_t _size,
+		      bool _cachable, CompressionType _compression_type)
 		: data(_data.get(), _size), cachable(_cachable),
 		  compression_type(_compression_type),
 		  allocation(std::move(_data))
 	{
 	}
 
+	// Memory held by the allocation, including the allocator's rounding
+	// and per-block overhead when it came from a MemoryAllocator.
+	size_t usable_size() const
+	{
+		if (allocation.get() != nullptr) {
+			MemoryAllocator *allocator =
+				allocation.get_deleter().allocator;
+			if (allocator) {
+				return allocator->UsableSize(allocation.get(),
+							     data.size());
+			}
+#ifdef ROCKSDB_MALLOC_USABLE_SIZE
+			return malloc_usable_size(allocation.get());
+#endif // ROCKSDB_MALLOC_USABLE_SIZE
+		}
+		return data.size();
+	}
+
 	BlockContents(BlockContents &&other) ROCKSDB_NOEXCEPT
 	{
 		*this = std::move(other);
@@ -272,20 +306,21 @@ extern Status ReadBlockContents(
 	const ReadOptions &options, const BlockHandle &handle,
 	BlockContents *contents, const ImmutableCFOptions &ioptions,
 	bool do_uncompress = true, const Slice &compression_dict = Slice(),
-	const PersistentCacheOptions &cache_options = PersistentCacheOptions());
+	const PersistentCacheOptions &cache_options = PersistentCacheOptions(),
+	MemoryAllocator *memory_allocator = nullptr);
 
 // The 'data' points to the raw block contents read in from file.
 // This method allocates a new heap buffer and the raw block
 // contents are uncompresed into this buffer. This buffer is
 // returned via 'result' and it is upto the caller to
-// free this buffer.
+// free this buffer. The buffer comes from memory_allocator if it is set.
 // For description of compress_format_version and possible values, see
 // util/compression.h
-extern Status UncompressBlockContents(const char *data, size_t n,
-				      BlockContents *contents,
-				      uint32_t compress_format_version,
-				      const Slice &compression_dict,
-				      const ImmutableCFOptions &ioptions);
+extern Status UncompressBlockContents(
+	const char *data, size_t n, BlockContents *contents,
+	uint32_t compress_format_version, const Slice &compression_dict,
+	const ImmutableCFOptions &ioptions,
+	MemoryAllocator *memory_allocator = nullptr);
 
 // This is an extension to UncompressBlockContents that accepts
 // a specific compression type. This is used by un-wrapped blocks
@@ -293,7 +328,8 @@ extern Status UncompressBlockContents(const char *data, size_t n,
 extern Status UncompressBlockContentsForCompressionType(
 	const char *data, size_t n, BlockContents *contents,
 	uint32_t compress_format_version, const Slice &compression_dict,
-	CompressionType compression_type, const ImmutableCFOptions &ioptions);
+	CompressionType compression_type, const ImmutableCFOptions &ioptions,
+	MemoryAllocator *memory_allocator = nullptr);
 
 // Implementation details follow.  Clients should ignore,
 
@@ -117,6 +117,9 @@ bool FullFilterBlockReader::MayMatch(const Slice &entry)
 
 size_t FullFilterBlockReader::ApproximateMemoryUsage() const
 {
+	if (block_contents_.allocation.get_deleter().allocator) {
+		return block_contents_.usable_size();
+	}
 	return contents_.size();
 }
 } // namespace rocksdb
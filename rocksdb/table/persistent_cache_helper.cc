@@ -118,7 +118,8 @@ Status PersistentCacheHelper::LookupUncompressedPage(
 	// update stats
 	RecordTick(cache_options.statistics, PERSISTENT_CACHE_HIT);
 	// construct result and return
-	*contents = BlockContents(std::move(data), size, false /*cacheable*/,
+	*contents = BlockContents(std::move(data), size,
+				  cache_options.admit_on_eviction,
 				  kNoCompression);
 	return Status::OK();
 }
@@ -34,6 +34,11 @@ struct PersistentCacheOptions {
 	std::shared_ptr<PersistentCache> persistent_cache;
 	std::string key_prefix;
 	Statistics *statistics = nullptr;
+	// Blocks reach the uncompressed persistent cache when they are evicted
+	// from the block cache, which shares its keys, rather than when they
+	// are read. Blocks found in the persistent cache are then cachable, so
+	// that hits go back to the block cache.
+	bool admit_on_eviction = false;
 };
 
 } // namespace rocksdb
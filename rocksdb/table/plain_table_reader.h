@@ -14,6 +14,7 @@
 #include "db/dbformat.h"
 #include "rocksdb/env.h"
 #include "rocksdb/iterator.h"
+#include "rocksdb/memory_allocator.h"
 #include "rocksdb/slice_transform.h"
 #include "rocksdb/table.h"
 #include "rocksdb/table_properties.h"
@@ -157,8 +158,8 @@ class PlainTableReader : public TableReader {
 	DynamicBloom bloom_;
 	PlainTableReaderFileInfo file_info_;
 	Arena arena_;
-	std::unique_ptr<char[]> index_block_alloc_;
-	std::unique_ptr<char[]> bloom_block_alloc_;
+	CacheAllocationPtr index_block_alloc_;
+	CacheAllocationPtr bloom_block_alloc_;
 
 	const ImmutableCFOptions &ioptions_;
 	uint64_t file_size_;
@@ -21,6 +21,7 @@
 
 namespace rocksdb
 {
+class BlockCacheTracer;
 class Slice;
 class Status;
 
@@ -29,10 +30,12 @@ struct TableReaderOptions {
 	TableReaderOptions(const ImmutableCFOptions &_ioptions,
 			   const EnvOptions &_env_options,
 			   const InternalKeyComparator &_internal_comparator,
-			   bool _skip_filters = false, int _level = -1)
+			   bool _skip_filters = false, int _level = -1,
+			   BlockCacheTracer *_block_cache_tracer = nullptr)
 		: ioptions(_ioptions), env_options(_env_options),
 		  internal_comparator(_internal_comparator),
-		  skip_filters(_skip_filters), level(_level)
+		  skip_filters(_skip_filters), level(_level),
+		  block_cache_tracer(_block_cache_tracer)
 	{
 	}
 
@@ -43,6 +46,9 @@ struct TableReaderOptions {
 	bool skip_filters;
 	// what level this table/file is on, -1 for "not set, don't know"
 	int level;
+	// Receives the block cache lookups of the table while the DB traces
+	// them; only used by BlockBasedTable.
+	BlockCacheTracer *block_cache_tracer;
 };
 
 struct TableBuilderOptions {
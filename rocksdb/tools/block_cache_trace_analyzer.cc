@@ -0,0 +1,192 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/block_cache_tracer.h"
+#include "util/string_util.h"
+#include "utilities/simulator_cache/cache_simulator.h"
+
+using namespace rocksdb;
+
+namespace
+{
+const char *const kBlockTypeNames[kTraceBlockTypeMax] = { "data", "filter",
+							  "index" };
+const char *const kCallerNames[kTraceCallerMax] = {
+	"get", "iterator", "compaction", "prefetch", "unknown"
+};
+
+// "64M,1G" -> { 64 << 20, 1 << 30 }
+bool ParseCapacities(const std::string &arg, std::vector<uint64_t> *out)
+{
+	for (const std::string &item : StringSplit(arg, ',')) {
+		char *end = nullptr;
+		uint64_t value = strtoull(item.c_str(), &end, 10);
+		if (end == item.c_str()) {
+			return false;
+		}
+		switch (*end) {
+		case 'k':
+		case 'K':
+			value <<= 10;
+			end++;
+			break;
+		case 'm':
+		case 'M':
+			value <<= 20;
+			end++;
+			break;
+		case 'g':
+		case 'G':
+			value <<= 30;
+			end++;
+			break;
+		}
+		if (*end != '\0' || value == 0) {
+			return false;
+		}
+		out->push_back(value);
+	}
+	return !out->empty();
+}
+
+void PrintUsage()
+{
+	fprintf(stdout,
+		"Usage: block_cache_trace_analyzer --file=trace_file "
+		"[--capacities=16M,64M,256M,1G] [--sampling_rate=N]\n"
+		"Replays a trace from DB::StartBlockCacheTrace() against "
+		"simulated caches\nand prints their miss ratios. With "
+		"--sampling_rate only one in N blocks\nis fed to the "
+		"policies other than LRU.\n");
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+	const struct option options[] = {
+		{ "help", no_argument, nullptr, 'h' },
+		{ "file", required_argument, nullptr, 'f' },
+		{ "capacities", required_argument, nullptr, 'c' },
+		{ "sampling_rate", required_argument, nullptr, 's' },
+		{ nullptr, 0, nullptr, 0 },
+	};
+	std::string file;
+	std::string capacities_arg = "16M,64M,256M,1G";
+	uint32_t sampling_rate = 1;
+	while (true) {
+		int c = getopt_long(argc, argv, "hf:c:s:", options, nullptr);
+		if (c < 0) {
+			break;
+		}
+		switch (c) {
+		case 'h':
+			PrintUsage();
+			return 0;
+		case 'f':
+			file = optarg;
+			break;
+		case 'c':
+			capacities_arg = optarg;
+			break;
+		case 's':
+			sampling_rate = static_cast<uint32_t>(atoi(optarg));
+			break;
+		default:
+			fprintf(stderr, "Unrecognized option.\n");
+			return -1;
+		}
+	}
+	std::vector<uint64_t> capacities;
+	if (file.empty() || !ParseCapacities(capacities_arg, &capacities)) {
+		PrintUsage();
+		return -1;
+	}
+
+	std::unique_ptr<TraceReader> trace_reader;
+	Status s = NewFileTraceReader(Env::Default(), EnvOptions(), file,
+				      &trace_reader);
+	if (!s.ok()) {
+		fprintf(stderr, "Failed to open %s: %s\n", file.c_str(),
+			s.ToString().c_str());
+		return -1;
+	}
+	BlockCacheTraceReader reader(std::move(trace_reader));
+	s = reader.ReadHeader();
+	if (!s.ok()) {
+		fprintf(stderr, "Failed to read %s: %s\n", file.c_str(),
+			s.ToString().c_str());
+		return -1;
+	}
+
+	CacheSimulator simulator(capacities, sampling_rate);
+	uint64_t accesses[kTraceBlockTypeMax][kTraceCallerMax] = { { 0 } };
+	uint64_t hits[kTraceBlockTypeMax][kTraceCallerMax] = { { 0 } };
+	uint64_t first_ts = 0;
+	uint64_t last_ts = 0;
+	BlockCacheTraceRecord record;
+	while ((s = reader.ReadAccess(&record)).ok()) {
+		if (simulator.lookups() == 0) {
+			first_ts = record.access_timestamp;
+		}
+		last_ts = record.access_timestamp;
+		accesses[record.block_type][record.caller]++;
+		hits[record.block_type][record.caller] +=
+			record.is_cache_hit ? 1 : 0;
+		simulator.Access(record);
+	}
+	if (!s.IsIncomplete()) {
+		// Keep what was read; a trace cut short is still useful
+		fprintf(stderr, "Stopped reading at: %s\n",
+			s.ToString().c_str());
+	}
+
+	fprintf(stdout, "%" PRIu64 " block cache lookups over %.1f seconds\n\n",
+		simulator.lookups(), (last_ts - first_ts) * 1e-6);
+	fprintf(stdout, "%-8s %-12s %14s %10s\n", "block", "caller",
+		"lookups", "hit ratio");
+	for (int type = 0; type < kTraceBlockTypeMax; type++) {
+		for (int caller = 0; caller < kTraceCallerMax; caller++) {
+			if (accesses[type][caller] == 0) {
+				continue;
+			}
+			fprintf(stdout, "%-8s %-12s %14" PRIu64 " %10.4f\n",
+				kBlockTypeNames[type], kCallerNames[caller],
+				accesses[type][caller],
+				static_cast<double>(hits[type][caller]) /
+					accesses[type][caller]);
+		}
+	}
+
+	fprintf(stdout, "\n%-26s %14s %14s %10s\n", "policy", "capacity",
+		"lookups", "miss ratio");
+	for (const CacheSimulatorResult &result : simulator.GetResults()) {
+		fprintf(stdout, "%-26s %14" PRIu64 " %14" PRIu64 " %10.4f\n",
+			CacheSimulatorPolicyName(result.policy),
+			result.capacity, result.lookups, result.miss_ratio());
+	}
+	return 0;
+}
+#else
+#include <stdio.h>
+int main(int argc, char **argv)
+{
+	fprintf(stderr, "Not supported in lite mode.\n");
+	return -1;
+}
+#endif // ROCKSDB_LITE
@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <atomic>
+#include <cmath>
 #include <condition_variable>
 #include <cstddef>
 #include <mutex>
@@ -50,6 +51,7 @@
 #include "rocksdb/rate_limiter.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/trace_reader_writer.h"
 #include "rocksdb/utilities/object_registry.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "rocksdb/utilities/options_util.h"
@@ -64,6 +66,7 @@
 #include "util/stderr_logger.h"
 #include "util/string_util.h"
 #include "util/testutil.h"
+#include "util/trace_replay.h"
 #include "util/transaction_test_util.h"
 #include "util/xxhash.h"
 #include "utilities/blob_db/blob_db.h"
@@ -170,10 +173,14 @@ DEFINE_string(
 	"them by seeking to each key\n"
 	"\trandomtransaction     -- execute N random transactions and "
 	"verify correctness\n"
+	"\tycsb          -- N operations of a YCSB core workload, see "
+	"--ycsb_workload\n"
 	"\trandomreplacekeys     -- randomly replaces N keys by deleting "
 	"the old version and putting the new version\n\n"
 	"\ttimeseries            -- 1 writer generates time series data "
-	"and multiple readers doing random reads on id\n\n"
+	"and multiple readers doing random reads on id\n"
+	"\treplay                -- replay the operations recorded in "
+	"--trace_file\n\n"
 	"Meta operations:\n"
 	"\tcompact     -- Compact the entire DB; If multiple, randomly choose one\n"
 	"\tcompactall  -- Compact the entire DB\n"
@@ -181,6 +188,7 @@ DEFINE_string(
 	"\tresetstats  -- Reset DB stats\n"
 	"\tlevelstats  -- Print the number of files and bytes per level\n"
 	"\tsstables    -- Print sstable info\n"
+	"\twritestallstats -- Print the write stalls by cause\n"
 	"\theapprofile -- Dump a heap profile (if supported by this"
 	" port)\n");
 
@@ -271,6 +279,102 @@ DEFINE_double(read_random_exp_range, 0.0,
 	      "The larger the number is, the more skewed the reads are. "
 	      "Only used in readrandom and multireadrandom benchmarks.");
 
+DEFINE_string(key_distribution, "",
+	      "Distribution of the keys of the ycsb and randomtransaction "
+	      "benchmarks: uniform, zipfian, latest (zipfian over the most "
+	      "recently inserted keys) or hotspot. Empty means uniform, or "
+	      "the distribution of the YCSB workload.");
+
+DEFINE_double(zipf_theta, 0.99,
+	      "Skew of the zipfian and latest key distributions, in (0, 1). "
+	      "The larger, the more skewed.");
+
+static bool ValidateZipfTheta(const char *flagname, double value)
+{
+	if (value <= 0 || value >= 1) {
+		fprintf(stderr,
+			"Invalid value for --%s: %f, must be in (0, 1)\n",
+			flagname, value);
+		return false;
+	}
+	return true;
+}
+
+static const bool FLAGS_zipf_theta_dummy __attribute__((unused)) =
+	RegisterFlagValidator(&FLAGS_zipf_theta, &ValidateZipfTheta);
+
+DEFINE_bool(zipf_scramble, true,
+	    "Spread the popular keys of the zipfian distribution over the "
+	    "key space instead of making the smallest keys the most popular");
+
+DEFINE_double(hotspot_data_fraction, 0.2,
+	      "Fraction of the keys in the hot set of the hotspot "
+	      "distribution");
+
+DEFINE_double(hotspot_op_fraction, 0.8,
+	      "Fraction of the operations going to the hot set of the "
+	      "hotspot distribution");
+
+DEFINE_string(ycsb_workload, "a",
+	      "Operation mix and key distribution of the ycsb benchmark: one "
+	      "of the YCSB core workloads a (50% reads, 50% updates), b (95% "
+	      "reads), c (reads only), d (95% reads of the latest keys, 5% "
+	      "inserts), e (95% scans, 5% inserts) and f (50% reads, 50% "
+	      "read-modify-writes), or custom to take the mix from the "
+	      "--ycsb_*_proportion flags.");
+
+DEFINE_double(ycsb_read_proportion, 0.5,
+	      "Share of reads in a custom ycsb workload");
+
+DEFINE_double(ycsb_update_proportion, 0.5,
+	      "Share of overwrites of existing keys in a custom ycsb workload");
+
+DEFINE_double(ycsb_insert_proportion, 0.0,
+	      "Share of writes of new keys in a custom ycsb workload");
+
+DEFINE_double(ycsb_scan_proportion, 0.0,
+	      "Share of scans in a custom ycsb workload");
+
+DEFINE_double(ycsb_rmw_proportion, 0.0,
+	      "Share of read-modify-writes in a custom ycsb workload");
+
+DEFINE_int32(ycsb_max_scan_length, 100,
+	     "Scans of the ycsb benchmark read a uniformly distributed number "
+	     "of keys between 1 and this");
+
+DEFINE_double(ycsb_ops_per_sec, 0.0,
+	      "Run the ycsb benchmark open-loop at this many operations per "
+	      "second over all threads: operations are issued on a fixed "
+	      "schedule whether or not the previous ones have finished, and "
+	      "their latency counts from the time they were due. 0 runs "
+	      "closed-loop.");
+
+enum KeyDistribution {
+	kUniformKeys,
+	kZipfianKeys,
+	kLatestKeys,
+	kHotspotKeys,
+};
+
+static bool StringToKeyDistribution(const std::string &name,
+				    KeyDistribution *dist)
+{
+	if (name.empty() || !strcasecmp(name.c_str(), "uniform")) {
+		*dist = kUniformKeys;
+	} else if (!strcasecmp(name.c_str(), "zipfian")) {
+		*dist = kZipfianKeys;
+	} else if (!strcasecmp(name.c_str(), "latest")) {
+		*dist = kLatestKeys;
+	} else if (!strcasecmp(name.c_str(), "hotspot")) {
+		*dist = kHotspotKeys;
+	} else {
+		fprintf(stderr, "Cannot parse key distribution %s\n",
+			name.c_str());
+		return false;
+	}
+	return true;
+}
+
 DEFINE_bool(histogram, false, "Print histogram of operation timings");
 
 DEFINE_bool(enable_numa, false,
@@ -279,7 +383,9 @@ DEFINE_bool(enable_numa, false,
 	    "in same node as CPUs are closer when compared to memory in "
 	    "other nodes. Reads can be faster when the process is bound to "
 	    "CPU and memory of same node. Use \"$numactl --hardware\" command "
-	    "to see NUMA memory architecture.");
+	    "to see NUMA memory architecture. This also turns on "
+	    "DBOptions::numa_aware, NUMA aware block cache shards and binds "
+	    "background threads to nodes.");
 
 DEFINE_int64(db_write_buffer_size, rocksdb::Options().db_write_buffer_size,
 	     "Number of bytes to buffer in all memtables before compacting");
@@ -337,6 +443,10 @@ DEFINE_int32(max_background_flushes, rocksdb::Options().max_background_flushes,
 	     "The maximum number of concurrent background flushes"
 	     " that can occur in parallel.");
 
+DEFINE_bool(thread_pool_borrowing, false,
+	    "Let idle compaction threads run flushes queued behind busy"
+	    " flush threads.");
+
 static rocksdb::CompactionStyle FLAGS_compaction_style_e;
 DEFINE_int32(compaction_style, (int32_t)rocksdb::Options().compaction_style,
 	     "style of compaction: level-based, universal and fifo");
@@ -383,6 +493,10 @@ DEFINE_double(cache_high_pri_pool_ratio, 0.0,
 DEFINE_bool(use_clock_cache, false,
 	    "Replace default LRU block cache with clock cache.");
 
+DEFINE_bool(use_hugepage_cache_allocator, false,
+	    "Allocate the blocks of the LRU block cache from huge page "
+	    "backed slabs, see NewHugePageMemoryAllocator().");
+
 DEFINE_int64(simcache_size, -1,
 	     "Number of bytes to use as a simcache of "
 	     "uncompressed data. Nagative value disables simcache.");
@@ -437,6 +551,10 @@ DEFINE_int32(random_access_max_buffer_size, 1024 * 1024,
 DEFINE_int32(writable_file_max_buffer_size, 1024 * 1024,
 	     "Maximum write buffer for Writable File");
 
+DEFINE_int32(writable_file_direct_io_buffers,
+	     rocksdb::Options().writable_file_direct_io_buffers,
+	     "Number of write buffers per file opened for direct I/O");
+
 DEFINE_int32(bloom_bits, -1,
 	     "Bloom filter bits per key. Negative means"
 	     " use default settings.");
@@ -488,6 +606,13 @@ DEFINE_bool(verify_checksum, false,
 
 DEFINE_bool(statistics, false, "Database statistics");
 DEFINE_string(statistics_string, "", "Serialized statistics string");
+DEFINE_int32(statistics_histogram_digits, 0,
+	     "With --statistics, record the histograms in HDR histograms "
+	     "resolving values to this many significant digits (1 to 3) for "
+	     "accurate tail percentiles. 0 keeps the default histograms.");
+DEFINE_uint64(statistics_histogram_max, 3600ull * 1000 * 1000,
+	      "With --statistics_histogram_digits, the highest value the HDR "
+	      "histograms resolve; larger ones count as this one.");
 static class std::shared_ptr<rocksdb::Statistics> dbstats;
 
 DEFINE_int64(writes, -1,
@@ -508,6 +633,30 @@ DEFINE_string(wal_dir, "", "If not empty, use the given dir for WAL");
 DEFINE_string(truth_db, "/dev/shm/truth_db/dbbench",
 	      "Truth key/values used when using verify");
 
+DEFINE_string(trace_file, "",
+	      "Record the operations of every benchmark to this file, or,"
+	      " for the replay benchmark, the trace to replay. Each benchmark"
+	      " overwrites the trace of the previous one.");
+
+DEFINE_uint64(trace_sampling_frequency, 1,
+	      "Record one of every N Gets and iterator seeks when tracing");
+
+DEFINE_bool(trace_replay_fast_forward, false,
+	    "Replay the trace as fast as possible instead of with the timing"
+	    " it was recorded with");
+
+DEFINE_int32(trace_replay_threads, 1,
+	     "Number of threads issuing the operations of the replayed trace");
+
+DEFINE_string(block_cache_trace_file, "",
+	      "Record the block cache lookups of every benchmark to this file,"
+	      " for tools/block_cache_trace_analyzer. Each benchmark overwrites"
+	      " the trace of the previous one.");
+
+DEFINE_uint64(block_cache_trace_sampling_frequency, 1,
+	      "Record the lookups of one of every N blocks when tracing the"
+	      " block cache");
+
 DEFINE_int32(num_levels, 7, "The total number of levels");
 
 DEFINE_int64(target_file_size_base, rocksdb::Options().target_file_size_base,
@@ -770,6 +919,10 @@ DEFINE_int32(thread_status_per_interval, 0,
 DEFINE_int32(perf_level, rocksdb::PerfLevel::kDisable,
 	     "Level of perf collection");
 
+DEFINE_bool(perf_context_by_level, false,
+	    "With --perf_level, also report the filter, block cache and block "
+	    "read counters of the perf context by LSM level");
+
 static bool ValidateRateLimit(const char *flagname, double value)
 {
 	const double EPSILON = 1e-10;
@@ -815,6 +968,15 @@ DEFINE_int32(rate_limit_delay_max_milliseconds, 1000,
 
 DEFINE_uint64(rate_limiter_bytes_per_sec, 0, "Set options.rate_limiter value.");
 
+DEFINE_bool(rate_limiter_auto_tuned, false,
+	    "Let options.rate_limiter adjust its rate between "
+	    "--rate_limiter_min_bytes_per_sec and "
+	    "--rate_limiter_bytes_per_sec");
+
+DEFINE_uint64(rate_limiter_min_bytes_per_sec, 0,
+	      "Lower bound of an auto-tuned options.rate_limiter. 0 means "
+	      "--rate_limiter_bytes_per_sec / 20.");
+
 DEFINE_uint64(
 	benchmark_write_rate_limit, 0,
 	"If non-zero, db_bench will rate-limit the writes going into RocksDB. This "
@@ -853,6 +1015,9 @@ DEFINE_bool(use_direct_io_for_flush_and_compaction,
 	    rocksdb::Options().use_direct_io_for_flush_and_compaction,
 	    "Use O_DIRECT for background flush and compaction I/O");
 
+DEFINE_bool(use_direct_io_for_wal, rocksdb::Options().use_direct_io_for_wal,
+	    "Use O_DIRECT for writing the WAL");
+
 DEFINE_bool(advise_random_on_open, rocksdb::Options().advise_random_on_open,
 	    "Advise random access on table file open");
 
@@ -877,6 +1042,10 @@ DEFINE_uint64(wal_bytes_per_sync, rocksdb::Options().wal_bytes_per_sync,
 	      " being written, in the background. Issue one request for every"
 	      " wal_bytes_per_sync written. 0 turns it off.");
 
+DEFINE_uint64(wal_pool_size, rocksdb::Options().wal_pool_size,
+	      "Number of pre-allocated files kept ready for new WALs."
+	      " 0 turns the pool off.");
+
 DEFINE_bool(use_single_deletes, true,
 	    "Use single deletes (used in RandomReplaceKeys only).");
 
@@ -1448,6 +1617,8 @@ enum OperationType : unsigned char {
 	kUncompress,
 	kCrc,
 	kHash,
+	kScan,
+	kReadModifyWrite,
 	kOthers
 };
 
@@ -1458,6 +1629,7 @@ static std::unordered_map<OperationType, std::string, std::hash<unsigned char> >
 		{ kMerge, "merge" },	   { kUpdate, "update" },
 		{ kCompress, "compress" }, { kCompress, "uncompress" },
 		{ kCrc, "crc" },	   { kHash, "hash" },
+		{ kScan, "scan" },	   { kReadModifyWrite, "rmw" },
 		{ kOthers, "op" }
 	};
 
@@ -1479,6 +1651,8 @@ class Stats {
 		hist_;
 	std::string message_;
 	bool exclude_from_merge_;
+	// Record per operation latencies, set by --histogram
+	bool histogram_;
 	ReporterAgent *reporter_agent_; // does not own
 	friend class CombinedStats;
 
@@ -1510,6 +1684,7 @@ class Stats {
 		message_.clear();
 		// When set, stats from this thread won't be merged with others.
 		exclude_from_merge_ = false;
+		histogram_ = FLAGS_histogram;
 	}
 
 	void Merge(const Stats &other)
@@ -1561,6 +1736,13 @@ class Stats {
 		exclude_from_merge_ = true;
 	}
 
+	// Record latencies even without --histogram, for benchmarks that
+	// are about them.
+	void EnableHistogram()
+	{
+		histogram_ = true;
+	}
+
 	void PrintThreadStatus()
 	{
 		std::vector<ThreadStatus> thread_list;
@@ -1598,6 +1780,21 @@ class Stats {
 				fprintf(stderr, " %s %" PRIu64 " |",
 					op_prop.first.c_str(), op_prop.second);
 			}
+			// Waits so far: state count/total time
+			for (int state = ThreadStatus::STATE_UNKNOWN + 1;
+			     state < ThreadStatus::NUM_STATE_TYPES; state++) {
+				if (ts.state_wait_counts[state] == 0) {
+					continue;
+				}
+				fprintf(stderr, " %s %" PRIu64 "/%s |",
+					ThreadStatus::GetStateName(
+						ThreadStatus::StateType(state))
+						.c_str(),
+					ts.state_wait_counts[state],
+					ThreadStatus::MicrosToString(
+						ts.state_wait_micros[state])
+						.c_str());
+			}
 			fprintf(stderr, "\n");
 		}
 	}
@@ -1608,13 +1805,21 @@ class Stats {
 		last_op_finish_ = FLAGS_env->NowMicros();
 	}
 
+	// Count the latency of the next op from start_micros. Open-loop
+	// benchmarks pass the time the op was due, so that an op queued
+	// behind slow ones is charged for the wait.
+	void SetOpStartTime(uint64_t start_micros)
+	{
+		last_op_finish_ = start_micros;
+	}
+
 	void FinishedOps(DBWithColumnFamilies *db_with_cfh, DB *db,
 			 int64_t num_ops, enum OperationType op_type = kOthers)
 	{
 		if (reporter_agent_) {
 			reporter_agent_->ReportFinishedOps(num_ops);
 		}
-		if (FLAGS_histogram) {
+		if (histogram_) {
 			uint64_t now = FLAGS_env->NowMicros();
 			uint64_t micros = now - last_op_finish_;
 
@@ -1812,7 +2017,7 @@ class Stats {
 			name.ToString().c_str(), elapsed * 1e6 / done_,
 			(long)throughput, (extra.empty() ? "" : " "),
 			extra.c_str());
-		if (FLAGS_histogram) {
+		if (!hist_.empty()) {
 			for (auto it = hist_.begin(); it != hist_.end(); ++it) {
 				fprintf(stdout, "Microseconds per %s:\n%s\n",
 					OperationTypeString[it->first].c_str(),
@@ -1957,7 +2162,13 @@ struct SharedState {
 	long num_done;
 	bool start;
 
-	SharedState() : cv(&mu), perf_level(FLAGS_perf_level)
+	// Keys the ycsb benchmark has written so far; its inserts take the
+	// next one.
+	std::atomic<uint64_t> ycsb_num_keys;
+
+	SharedState()
+		: cv(&mu), perf_level(FLAGS_perf_level),
+		  ycsb_num_keys(static_cast<uint64_t>(FLAGS_num))
 	{
 	}
 };
@@ -2020,6 +2231,155 @@ class Duration {
 	uint64_t start_at_;
 };
 
+// Uniform double in [0, 1)
+static double NextDouble(Random64 *rand)
+{
+	return (rand->Next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Zipfian ranks in [0, n), 0 the most popular, with the method of Gray et
+// al., "Quickly Generating Billion-Record Synthetic Databases", as in YCSB.
+class ZipfianGenerator {
+    public:
+	ZipfianGenerator(uint64_t n, double theta)
+		: n_(0), theta_(theta), zetan_(0)
+	{
+		assert(theta > 0 && theta < 1);
+		alpha_ = 1.0 / (1.0 - theta_);
+		zeta2_ = 1.0 + std::pow(0.5, theta_);
+		SetItemCount(n);
+	}
+
+	uint64_t Next(Random64 *rand)
+	{
+		double u = NextDouble(rand);
+		double uz = u * zetan_;
+		if (uz < 1.0) {
+			return 0;
+		}
+		if (uz < zeta2_) {
+			return 1;
+		}
+		uint64_t rank = static_cast<uint64_t>(
+			n_ * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+		return std::min(rank, n_ - 1);
+	}
+
+	// Grow or shrink the key space; growing by a little, as inserts do,
+	// only adds the new terms of zeta.
+	void SetItemCount(uint64_t n)
+	{
+		n = std::max<uint64_t>(n, 2);
+		if (n == n_) {
+			return;
+		}
+		if (n > n_ && n - n_ < kExactTerms) {
+			for (uint64_t i = n_ + 1; i <= n; i++) {
+				zetan_ += 1.0 / std::pow(static_cast<double>(i),
+							 theta_);
+			}
+		} else {
+			zetan_ = Zeta(n);
+		}
+		n_ = n;
+		eta_ = (1.0 - std::pow(2.0 / n_, 1.0 - theta_)) /
+		       (1.0 - zeta2_ / zetan_);
+	}
+
+    private:
+	// Terms of zeta summed one by one; the rest is approximated with the
+	// Euler-Maclaurin formula, which is off by far less than a rank for
+	// the key counts of a benchmark, so that a billion keys do not take
+	// a billion pow() calls per thread.
+	static const uint64_t kExactTerms = 1000000;
+
+	double Zeta(uint64_t n) const
+	{
+		uint64_t exact = std::min(n, kExactTerms);
+		double sum = 0;
+		for (uint64_t i = 1; i <= exact; i++) {
+			sum += 1.0 / std::pow(static_cast<double>(i), theta_);
+		}
+		if (n > exact) {
+			double a = static_cast<double>(exact);
+			double b = static_cast<double>(n);
+			sum += (std::pow(b, 1.0 - theta_) -
+				std::pow(a, 1.0 - theta_)) /
+				       (1.0 - theta_) +
+			       (std::pow(b, -theta_) - std::pow(a, -theta_)) /
+				       2.0;
+		}
+		return sum;
+	}
+
+	uint64_t n_;
+	double theta_;
+	double alpha_;
+	double zeta2_;
+	double zetan_;
+	double eta_;
+};
+
+// Picks keys in [0, num_keys) from a KeyDistribution. num_keys may grow
+// between calls as a benchmark inserts keys.
+class KeyChooser {
+    public:
+	KeyChooser(Random64 *rand, KeyDistribution dist, uint64_t num_keys)
+		: rand_(rand), dist_(dist)
+	{
+		if (dist_ == kZipfianKeys || dist_ == kLatestKeys) {
+			zipf_.reset(new ZipfianGenerator(num_keys,
+							 FLAGS_zipf_theta));
+		}
+	}
+
+	uint64_t Next(uint64_t num_keys)
+	{
+		assert(num_keys > 0);
+		switch (dist_) {
+		case kZipfianKeys: {
+			zipf_->SetItemCount(num_keys);
+			uint64_t rank = zipf_->Next(rand_);
+			return FLAGS_zipf_scramble ? Scramble(rank) % num_keys :
+						     rank;
+		}
+		case kLatestKeys:
+			zipf_->SetItemCount(num_keys);
+			return num_keys - 1 - zipf_->Next(rand_) % num_keys;
+		case kHotspotKeys: {
+			uint64_t hot_keys = static_cast<uint64_t>(
+				num_keys * FLAGS_hotspot_data_fraction);
+			hot_keys = std::min(std::max<uint64_t>(hot_keys, 1),
+					    num_keys);
+			if (hot_keys == num_keys ||
+			    NextDouble(rand_) < FLAGS_hotspot_op_fraction) {
+				return rand_->Next() % hot_keys;
+			}
+			return hot_keys + rand_->Next() % (num_keys - hot_keys);
+		}
+		case kUniformKeys:
+		default:
+			return rand_->Next() % num_keys;
+		}
+	}
+
+    private:
+	// FNV-1a over the bytes of the rank, as YCSB scrambles its zipfian
+	static uint64_t Scramble(uint64_t rank)
+	{
+		uint64_t hash = 0xcbf29ce484222325ULL;
+		for (int i = 0; i < 8; i++) {
+			hash ^= (rank >> (8 * i)) & 0xff;
+			hash *= 0x100000001b3ULL;
+		}
+		return hash;
+	}
+
+	Random64 *rand_;
+	KeyDistribution dist_;
+	std::unique_ptr<ZipfianGenerator> zipf_;
+};
+
 class Benchmark {
     private:
 	std::shared_ptr<Cache> cache_;
@@ -2028,6 +2388,8 @@ class Benchmark {
 	const SliceTransform *prefix_extractor_;
 	DBWithColumnFamilies db_;
 	std::vector<DBWithColumnFamilies> multi_dbs_;
+	// Write stall times of the DBs at the end of the last benchmark
+	std::map<std::string, double> last_write_stall_stats_;
 	int64_t num_;
 	int value_size_;
 	int key_size_;
@@ -2321,7 +2683,11 @@ class Benchmark {
 			return NewLRUCache((size_t)capacity,
 					   FLAGS_cache_numshardbits,
 					   false /*strict_capacity_limit*/,
-					   FLAGS_cache_high_pri_pool_ratio);
+					   FLAGS_cache_high_pri_pool_ratio,
+					   FLAGS_enable_numa,
+					   FLAGS_use_hugepage_cache_allocator ?
+						   NewHugePageMemoryAllocator() :
+						   nullptr);
 		}
 	}
 
@@ -2500,6 +2866,105 @@ class Benchmark {
 		return base_name + ToString(id);
 	}
 
+	void StartTrace()
+	{
+		if (db_.db == nullptr) {
+			fprintf(stderr, "Tracing needs --num_multi_db=0\n");
+			exit(1);
+		}
+		std::unique_ptr<TraceWriter> trace_writer;
+		Status s = NewFileTraceWriter(FLAGS_env, EnvOptions(),
+					      FLAGS_trace_file, &trace_writer);
+		if (s.ok()) {
+			TraceOptions trace_options;
+			trace_options.sampling_frequency =
+				FLAGS_trace_sampling_frequency;
+			s = db_.db->StartTrace(trace_options,
+					       std::move(trace_writer));
+		}
+		if (!s.ok()) {
+			fprintf(stderr,
+				"Encountered an error starting a trace, %s\n",
+				s.ToString().c_str());
+			exit(1);
+		}
+		fprintf(stdout, "Tracing the workload to: [%s]\n",
+			FLAGS_trace_file.c_str());
+	}
+
+	void StartBlockCacheTrace()
+	{
+		if (db_.db == nullptr) {
+			fprintf(stderr,
+				"Block cache tracing needs --num_multi_db=0\n");
+			exit(1);
+		}
+		std::unique_ptr<TraceWriter> trace_writer;
+		Status s = NewFileTraceWriter(FLAGS_env, EnvOptions(),
+					      FLAGS_block_cache_trace_file,
+					      &trace_writer);
+		if (s.ok()) {
+			TraceOptions trace_options;
+			trace_options.sampling_frequency =
+				FLAGS_block_cache_trace_sampling_frequency;
+			s = db_.db->StartBlockCacheTrace(
+				trace_options, std::move(trace_writer));
+		}
+		if (!s.ok()) {
+			fprintf(stderr,
+				"Encountered an error starting a block cache "
+				"trace, %s\n",
+				s.ToString().c_str());
+			exit(1);
+		}
+		fprintf(stdout, "Tracing the block cache to: [%s]\n",
+			FLAGS_block_cache_trace_file.c_str());
+	}
+
+	void Replay()
+	{
+		if (FLAGS_trace_file.empty()) {
+			fprintf(stderr, "replay needs --trace_file\n");
+			exit(1);
+		}
+		if (db_.db == nullptr) {
+			fprintf(stderr, "replay needs --num_multi_db=0\n");
+			exit(1);
+		}
+		std::unique_ptr<TraceReader> trace_reader;
+		Status s = NewFileTraceReader(FLAGS_env, EnvOptions(),
+					      FLAGS_trace_file, &trace_reader);
+		if (!s.ok()) {
+			fprintf(stderr,
+				"Unable to open the trace file %s: %s\n",
+				FLAGS_trace_file.c_str(),
+				s.ToString().c_str());
+			exit(1);
+		}
+		std::vector<ColumnFamilyHandle *> handles = db_.cfh;
+		if (handles.empty()) {
+			handles.push_back(db_.db->DefaultColumnFamily());
+		}
+		Replayer replayer(db_.db, handles, std::move(trace_reader));
+		ReplayOptions replay_options;
+		replay_options.num_threads = FLAGS_trace_replay_threads;
+		replay_options.fast_forward = FLAGS_trace_replay_fast_forward;
+
+		uint64_t start = FLAGS_env->NowMicros();
+		s = replayer.Replay(replay_options);
+		double elapsed = (FLAGS_env->NowMicros() - start) * 1e-6;
+		uint64_t ops = replayer.GetOpsReplayed();
+		if (!s.ok()) {
+			fprintf(stderr, "Replay failed: %s\n",
+				s.ToString().c_str());
+		}
+		fprintf(stdout,
+			"%-12s : %" PRIu64 " operations in %.3f seconds "
+			"(%.1f ops/sec)\n",
+			"replay", ops, elapsed,
+			elapsed > 0 ? ops / elapsed : 0.0);
+	}
+
 	void VerifyDBFromDB(std::string &truth_db_name)
 	{
 		DBWithColumnFamilies truth_db;
@@ -2760,6 +3225,8 @@ class Benchmark {
 				post_process_method =
 					&Benchmark::RandomTransactionVerify;
 #endif // ROCKSDB_LITE
+			} else if (name == "ycsb") {
+				method = &Benchmark::YCSB;
 			} else if (name == "randomreplacekeys") {
 				fresh_db = true;
 				method = &Benchmark::RandomReplaceKeys;
@@ -2786,6 +3253,10 @@ class Benchmark {
 				PrintStats("rocksdb.levelstats");
 			} else if (name == "sstables") {
 				PrintStats("rocksdb.sstables");
+			} else if (name == "writestallstats") {
+				PrintStats("rocksdb.write-stall-stats");
+			} else if (name == "replay") {
+				Replay();
 			} else if (!name.empty()) { // No error message for empty name
 				fprintf(stderr, "unknown benchmark '%s'\n",
 					name.c_str());
@@ -2841,15 +3312,39 @@ class Benchmark {
 					       num_repeat);
 				}
 
+				if (!FLAGS_trace_file.empty()) {
+					StartTrace();
+				}
+				if (!FLAGS_block_cache_trace_file.empty()) {
+					StartBlockCacheTrace();
+				}
 				CombinedStats combined_stats;
 				for (int i = 0; i < num_repeat; i++) {
 					Stats stats = RunBenchmark(
 						num_threads, name, method);
 					combined_stats.AddStats(stats);
 				}
+				if (!FLAGS_trace_file.empty()) {
+					Status s = db_.db->EndTrace();
+					if (!s.ok()) {
+						fprintf(stderr,
+						"Error ending the trace, %s\n",
+						s.ToString().c_str());
+					}
+				}
+				if (!FLAGS_block_cache_trace_file.empty()) {
+					Status s = db_.db->EndBlockCacheTrace();
+					if (!s.ok()) {
+						fprintf(stderr,
+						"Error ending the block cache "
+						"trace, %s\n",
+						s.ToString().c_str());
+					}
+				}
 				if (num_repeat > 1) {
 					combined_stats.Report(name);
 				}
+				PrintWriteStallStats();
 			}
 			if (post_process_method != nullptr) {
 				(this->*post_process_method)();
@@ -2894,6 +3389,9 @@ class Benchmark {
 		}
 
 		SetPerfLevel(static_cast<PerfLevel>(shared->perf_level));
+		if (FLAGS_perf_context_by_level) {
+			get_perf_context()->EnablePerLevelPerfContext();
+		}
 		thread->stats.Start(thread->tid);
 		(arg->bm->*(arg->method))(thread);
 		thread->stats.Stop();
@@ -3089,7 +3587,7 @@ class Benchmark {
 		int64_t bytes = 0;
 		int decompress_size;
 		while (ok && bytes < 1024 * 1048576) {
-			char *uncompressed = nullptr;
+			CacheAllocationPtr uncompressed;
 			switch (FLAGS_compression_type_e) {
 			case rocksdb::kSnappyCompression: {
 				// get size and allocate here to make comparison fair
@@ -3100,10 +3598,10 @@ class Benchmark {
 					ok = false;
 					break;
 				}
-				uncompressed = new char[ulength];
+				uncompressed.reset(new char[ulength]);
 				ok = Snappy_Uncompress(compressed.data(),
 						       compressed.size(),
-						       uncompressed);
+						       uncompressed.get());
 				break;
 			}
 			case rocksdb::kZlibCompression:
@@ -3151,7 +3649,6 @@ class Benchmark {
 			default:
 				ok = false;
 			}
-			delete[] uncompressed;
 			bytes += input.size();
 			thread->stats.FinishedOps(nullptr, nullptr, 1,
 						  kUncompress);
@@ -3224,6 +3721,7 @@ class Benchmark {
 		options.use_direct_reads = FLAGS_use_direct_reads;
 		options.use_direct_io_for_flush_and_compaction =
 			FLAGS_use_direct_io_for_flush_and_compaction;
+		options.use_direct_io_for_wal = FLAGS_use_direct_io_for_wal;
 #ifndef ROCKSDB_LITE
 		options.compaction_options_fifo = CompactionOptionsFIFO(
 			FLAGS_fifo_compaction_max_table_files_size_mb * 1024 *
@@ -3264,6 +3762,8 @@ class Benchmark {
 			FLAGS_random_access_max_buffer_size;
 		options.writable_file_max_buffer_size =
 			FLAGS_writable_file_max_buffer_size;
+		options.writable_file_direct_io_buffers =
+			FLAGS_writable_file_direct_io_buffers;
 		options.use_fsync = FLAGS_use_fsync;
 		options.num_levels = FLAGS_num_levels;
 		options.target_file_size_base = FLAGS_target_file_size_base;
@@ -3524,6 +4024,7 @@ class Benchmark {
 		options.use_adaptive_mutex = FLAGS_use_adaptive_mutex;
 		options.bytes_per_sync = FLAGS_bytes_per_sync;
 		options.wal_bytes_per_sync = FLAGS_wal_bytes_per_sync;
+		options.wal_pool_size = FLAGS_wal_pool_size;
 
 		// merge operator options
 		options.merge_operator = MergeOperators::CreateFromStringId(
@@ -3567,7 +4068,11 @@ class Benchmark {
 		}
 		if (FLAGS_rate_limiter_bytes_per_sec > 0) {
 			options.rate_limiter.reset(NewGenericRateLimiter(
-				FLAGS_rate_limiter_bytes_per_sec));
+				FLAGS_rate_limiter_bytes_per_sec,
+				100 * 1000 /* refill_period_us */,
+				10 /* fairness */,
+				FLAGS_rate_limiter_auto_tuned,
+				FLAGS_rate_limiter_min_bytes_per_sec));
 		}
 
 #ifndef ROCKSDB_LITE
@@ -3602,6 +4107,11 @@ class Benchmark {
 			FLAGS_env->LowerThreadPoolIOPriority(Env::LOW);
 			FLAGS_env->LowerThreadPoolIOPriority(Env::HIGH);
 		}
+		if (FLAGS_enable_numa) {
+			options.numa_aware = true;
+			FLAGS_env->BindThreadPoolToNumaNodes(Env::LOW);
+			FLAGS_env->BindThreadPoolToNumaNodes(Env::HIGH);
+		}
 		options.env = FLAGS_env;
 
 		if (FLAGS_num_multi_db <= 1) {
@@ -5531,10 +6041,23 @@ class Benchmark {
 		txn_options.lock_timeout = FLAGS_transaction_lock_timeout;
 		txn_options.set_snapshot = FLAGS_transaction_set_snapshot;
 
-		RandomTransactionInserter inserter(&thread->rand,
-						   write_options_, read_options,
-						   FLAGS_num,
-						   num_prefix_ranges);
+		KeyDistribution key_dist;
+		if (!StringToKeyDistribution(FLAGS_key_distribution,
+					     &key_dist)) {
+			exit(1);
+		}
+		const uint64_t num_keys = static_cast<uint64_t>(FLAGS_num);
+		KeyChooser chooser(&thread->rand, key_dist, num_keys);
+		std::function<uint64_t()> key_chooser;
+		if (key_dist != kUniformKeys) {
+			key_chooser = [&chooser, num_keys]() {
+				return chooser.Next(num_keys);
+			};
+		}
+
+		RandomTransactionInserter inserter(
+			&thread->rand, write_options_, read_options, FLAGS_num,
+			num_prefix_ranges, key_chooser);
 
 		if (FLAGS_num_multi_db > 1) {
 			fprintf(stderr,
@@ -5613,6 +6136,205 @@ class Benchmark {
 	}
 #endif // ROCKSDB_LITE
 
+	struct YCSBMix {
+		double read;
+		double update;
+		double insert;
+		double scan;
+		double rmw;
+		KeyDistribution key_dist;
+	};
+
+	// The operation mix and key distribution of --ycsb_workload, with
+	// --key_distribution taking precedence.
+	static bool GetYCSBMix(YCSBMix *mix)
+	{
+		const std::string &workload = FLAGS_ycsb_workload;
+		*mix = YCSBMix{ 0, 0, 0, 0, 0, kZipfianKeys };
+		if (workload == "a") {
+			mix->read = 0.5;
+			mix->update = 0.5;
+		} else if (workload == "b") {
+			mix->read = 0.95;
+			mix->update = 0.05;
+		} else if (workload == "c") {
+			mix->read = 1.0;
+		} else if (workload == "d") {
+			mix->read = 0.95;
+			mix->insert = 0.05;
+			mix->key_dist = kLatestKeys;
+		} else if (workload == "e") {
+			mix->scan = 0.95;
+			mix->insert = 0.05;
+		} else if (workload == "f") {
+			mix->read = 0.5;
+			mix->rmw = 0.5;
+		} else if (workload == "custom") {
+			mix->read = FLAGS_ycsb_read_proportion;
+			mix->update = FLAGS_ycsb_update_proportion;
+			mix->insert = FLAGS_ycsb_insert_proportion;
+			mix->scan = FLAGS_ycsb_scan_proportion;
+			mix->rmw = FLAGS_ycsb_rmw_proportion;
+			mix->key_dist = kUniformKeys;
+		} else {
+			fprintf(stderr, "Unknown ycsb workload %s\n",
+				workload.c_str());
+			return false;
+		}
+		if (mix->read < 0 || mix->update < 0 || mix->insert < 0 ||
+		    mix->scan < 0 || mix->rmw < 0 ||
+		    mix->read + mix->update + mix->insert + mix->scan +
+				    mix->rmw <=
+			    0) {
+			fprintf(stderr, "Invalid ycsb operation mix\n");
+			return false;
+		}
+		if (!FLAGS_key_distribution.empty()) {
+			return StringToKeyDistribution(FLAGS_key_distribution,
+						       &mix->key_dist);
+		}
+		return true;
+	}
+
+	// A YCSB core workload. Inserts write keys past --num, which the
+	// latest distribution then favours.
+	void YCSB(ThreadState *thread)
+	{
+		YCSBMix mix;
+		if (!GetYCSBMix(&mix) || FLAGS_ycsb_max_scan_length <= 0) {
+			exit(1);
+		}
+		const double total =
+			mix.read + mix.update + mix.insert + mix.scan + mix.rmw;
+		// Per operation latencies are what this benchmark is about
+		thread->stats.EnableHistogram();
+
+		ReadOptions options(FLAGS_verify_checksum, true);
+		RandomGenerator gen;
+		std::string value;
+		std::unique_ptr<const char[]> key_guard;
+		Slice key = AllocateKey(&key_guard);
+		std::atomic<uint64_t> &num_keys = thread->shared->ycsb_num_keys;
+		KeyChooser chooser(&thread->rand, mix.key_dist,
+				   num_keys.load(std::memory_order_relaxed));
+
+		// Open-loop, each thread issues its share of the target rate
+		double interval_micros = 0;
+		if (FLAGS_ycsb_ops_per_sec > 0) {
+			interval_micros = 1e6 * thread->shared->total /
+					  FLAGS_ycsb_ops_per_sec;
+		}
+		const uint64_t start = FLAGS_env->NowMicros();
+		uint64_t ops = 0;
+		int64_t reads = 0;
+		int64_t updates = 0;
+		int64_t inserts = 0;
+		int64_t scans = 0;
+		int64_t rmws = 0;
+		int64_t found = 0;
+		int64_t bytes = 0;
+
+		Duration duration(FLAGS_duration, readwrites_);
+		while (!duration.Done(1)) {
+			if (interval_micros > 0) {
+				uint64_t due =
+					start + static_cast<uint64_t>(
+							ops * interval_micros);
+				uint64_t now = FLAGS_env->NowMicros();
+				if (due > now) {
+					FLAGS_env->SleepForMicroseconds(
+						static_cast<int>(due - now));
+				}
+				thread->stats.SetOpStartTime(due);
+			}
+			ops++;
+
+			double r = NextDouble(&thread->rand) * total;
+			OperationType op_type = kReadModifyWrite;
+			if (r < mix.read) {
+				op_type = kRead;
+			} else if ((r -= mix.read) < mix.update) {
+				op_type = kUpdate;
+			} else if ((r -= mix.update) < mix.insert) {
+				op_type = kWrite;
+			} else if ((r -= mix.insert) < mix.scan) {
+				op_type = kScan;
+			}
+			uint64_t key_num =
+				op_type == kWrite ?
+					num_keys.fetch_add(1) :
+					chooser.Next(num_keys.load(
+						std::memory_order_relaxed));
+			DBWithColumnFamilies *db_with_cfh =
+				SelectDBWithCfh(key_num);
+			DB *db = db_with_cfh->db;
+			ColumnFamilyHandle *cfh =
+				FLAGS_num_column_families > 1 ?
+					db_with_cfh->GetCfh(key_num) :
+					db->DefaultColumnFamily();
+			GenerateKeyFromInt(key_num, FLAGS_num, &key);
+
+			Status s;
+			if (op_type == kRead || op_type == kReadModifyWrite) {
+				s = db->Get(options, cfh, key, &value);
+				if (s.ok()) {
+					found++;
+					bytes += key.size() + value.size();
+				} else if (!s.IsNotFound()) {
+					fprintf(stderr,
+						"Get returned an error: %s\n",
+						s.ToString().c_str());
+					abort();
+				}
+				s = Status::OK();
+			}
+			if (op_type == kScan) {
+				int64_t length =
+					1 + thread->rand.Next() %
+						    FLAGS_ycsb_max_scan_length;
+				std::unique_ptr<Iterator> iter(
+					db->NewIterator(options, cfh));
+				iter->Seek(key);
+				for (; iter->Valid() && length > 0; length--) {
+					bytes += iter->key().size() +
+						 iter->value().size();
+					iter->Next();
+				}
+				s = iter->status();
+				scans++;
+			} else if (op_type != kRead) {
+				s = db->Put(write_options_, cfh, key,
+					    gen.Generate(value_size_));
+				bytes += key.size() + value_size_;
+				if (op_type == kUpdate) {
+					updates++;
+				} else if (op_type == kWrite) {
+					inserts++;
+				} else {
+					rmws++;
+				}
+			} else {
+				reads++;
+			}
+			if (!s.ok()) {
+				fprintf(stderr, "ycsb %s error: %s\n",
+					OperationTypeString[op_type].c_str(),
+					s.ToString().c_str());
+				exit(1);
+			}
+			thread->stats.FinishedOps(db_with_cfh, db, 1, op_type);
+		}
+
+		char msg[200];
+		snprintf(msg, sizeof(msg),
+			 "( reads:%" PRIi64 " updates:%" PRIi64
+			 " inserts:%" PRIi64 " scans:%" PRIi64 " rmws:%" PRIi64
+			 " found:%" PRIi64 ")",
+			 reads, updates, inserts, scans, rmws, found);
+		thread->stats.AddBytes(bytes);
+		thread->stats.AddMessage(msg);
+	}
+
 	// Writes and deletes random keys without overwriting keys.
 	//
 	// This benchmark is intended to partially replicate the behavior of MyRocks
@@ -5898,6 +6620,58 @@ class Benchmark {
 		}
 	}
 
+	// Prints the time the writes waited for each stall cause during the
+	// last benchmark, if they did
+	void PrintWriteStallStats()
+	{
+		std::vector<DB *> dbs;
+		if (db_.db != nullptr) {
+			dbs.push_back(db_.db);
+		}
+		for (const auto &db_with_cfh : multi_dbs_) {
+			dbs.push_back(db_with_cfh.db);
+		}
+		std::map<std::string, double> stall_stats;
+		for (DB *db : dbs) {
+			std::map<std::string, double> db_stall_stats;
+			if (!db->GetMapProperty(
+				    DB::Properties::kWriteStallStats,
+				    &db_stall_stats)) {
+				return;
+			}
+			for (const auto &stat : db_stall_stats) {
+				stall_stats[stat.first] += stat.second;
+			}
+		}
+		// A reopened DB starts again from zero
+		auto since_last = [&](const std::string &name) {
+			double cur = stall_stats[name];
+			double last = last_write_stall_stats_[name];
+			return cur >= last ? cur - last : cur;
+		};
+		std::string report;
+		bool stalled = false;
+		for (const char *cause : { "memtable-limit",
+					   "l0-file-count-limit",
+					   "pending-compaction-bytes" }) {
+			const std::string prefix = std::string("db.") + cause;
+			double delayed = since_last(prefix + ".delayed-micros");
+			double stopped = since_last(prefix + ".stopped-micros");
+			stalled = stalled || delayed > 0 || stopped > 0;
+			char buf[200];
+			snprintf(buf, sizeof(buf),
+				 "%s%s %.3f delayed, %.3f stopped",
+				 report.empty() ? "" : "; ", cause,
+				 delayed * 1e-6, stopped * 1e-6);
+			report += buf;
+		}
+		last_write_stall_stats_ = std::move(stall_stats);
+		if (stalled) {
+			fprintf(stdout, "Write stall (secs) : %s\n",
+				report.c_str());
+		}
+	}
+
 	void PrintStats(DB *db, const char *key, bool print_header = false)
 	{
 		if (print_header) {
@@ -5944,7 +6718,11 @@ int db_bench_tool(int argc, char **argv)
 	}
 #endif // ROCKSDB_LITE
 	if (FLAGS_statistics) {
-		dbstats = rocksdb::CreateDBStatistics();
+		dbstats = FLAGS_statistics_histogram_digits > 0 ?
+				  rocksdb::CreateDBStatistics(
+					  FLAGS_statistics_histogram_digits,
+					  FLAGS_statistics_histogram_max) :
+				  rocksdb::CreateDBStatistics();
 	}
 	FLAGS_compaction_pri_e = (rocksdb::CompactionPri)FLAGS_compaction_pri;
 
@@ -6001,6 +6779,7 @@ int db_bench_tool(int argc, char **argv)
 	FLAGS_env->SetBackgroundThreads(FLAGS_max_background_compactions);
 	FLAGS_env->SetBackgroundThreads(FLAGS_max_background_flushes,
 					rocksdb::Env::Priority::HIGH);
+	FLAGS_env->SetThreadPoolBorrowing(FLAGS_thread_pool_borrowing);
 
 	// Choose a location for the test database if none given with --db=<path>
 	if (FLAGS_db.empty()) {
@@ -0,0 +1,718 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Microbenchmarks of the hot paths of single components, with the same
+// methodology and output for all of them so that runs can be compared
+// across commits: each benchmark is calibrated to run for --min_time_ms,
+// repeated --repetitions times, and reported as the median time per
+// operation with its coefficient of variation. --json writes the results
+// in a form tools/microbench_compare.py reads.
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+#ifndef GFLAGS
+#include <cstdio>
+int main()
+{
+	fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+	return 1;
+}
+#else
+
+#include <gflags/gflags.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "memtable/inlineskiplist.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/env.h"
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/utilities/transaction_db.h"
+#include "rocksdb/version.h"
+#include "rocksdb/write_batch.h"
+#include "table/block.h"
+#include "table/block_builder.h"
+#include "table/format.h"
+#include "table/merging_iterator.h"
+#include "util/coding.h"
+#include "util/concurrent_arena.h"
+#include "util/crc32c.h"
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/testutil.h"
+#include "utilities/transactions/transaction_db_impl.h"
+#include "utilities/transactions/transaction_impl.h"
+
+using GFLAGS::ParseCommandLineFlags;
+using GFLAGS::SetUsageMessage;
+
+DEFINE_string(benchmarks, "",
+	      "Comma-separated substrings; run only the benchmarks whose name "
+	      "contains one of them. Empty runs all.");
+DEFINE_int32(repetitions, 5, "Number of timed runs of each benchmark.");
+DEFINE_int32(min_time_ms, 200, "Minimum duration of each timed run.");
+DEFINE_string(json, "", "If not empty, also write the results to this file "
+			"as JSON.");
+DEFINE_bool(list, false, "List the benchmarks and exit.");
+
+namespace rocksdb
+{
+namespace
+{
+// Written with results so that the compiler keeps the work producing them
+volatile uint64_t benchmark_sink;
+
+// A microbenchmark: Setup() once, then for each run Prepare(n) untimed and
+// Run(n) timed, which does n operations.
+class Microbench {
+    public:
+	virtual ~Microbench()
+	{
+	}
+	virtual const char *Name() const = 0;
+	virtual void Setup()
+	{
+	}
+	virtual void Prepare(uint64_t /*iterations*/)
+	{
+	}
+	virtual void Run(uint64_t iterations) = 0;
+	// Bytes processed per operation, to report a throughput
+	virtual uint64_t BytesPerOp() const
+	{
+		return 0;
+	}
+};
+
+struct MicrobenchResult {
+	std::string name;
+	uint64_t iterations = 0;
+	uint64_t bytes_per_op = 0;
+	// Of each repetition
+	std::vector<double> ns_per_op;
+	double median = 0;
+	double min = 0;
+	// Coefficient of variation, stddev / mean
+	double cv = 0;
+};
+
+typedef InlineSkipList<const MemTableRep::KeyComparator &> SkipList;
+
+// Compares fixed64 keys as numbers
+class Fixed64KeyComparator : public MemTableRep::KeyComparator {
+    public:
+	virtual int operator()(const char *a, const char *b) const override
+	{
+		uint64_t x = DecodeFixed64(a);
+		uint64_t y = DecodeFixed64(b);
+		return x < y ? -1 : (x > y ? 1 : 0);
+	}
+	virtual int operator()(const char *a,
+			       const Slice &b) const override
+	{
+		return (*this)(a, b.data());
+	}
+};
+
+class SkipListInsertBench : public Microbench {
+    public:
+	virtual const char *Name() const override
+	{
+		return "InlineSkipList/Insert";
+	}
+	virtual void Prepare(uint64_t iterations) override
+	{
+		// A fresh list for each run, so that runs are alike
+		list_.reset();
+		arena_.reset(new ConcurrentArena());
+		list_.reset(new SkipList(cmp_, arena_.get()));
+		Random64 rnd(301);
+		keys_.resize(iterations);
+		for (auto &key : keys_) {
+			key = rnd.Next();
+		}
+	}
+	virtual void Run(uint64_t iterations) override
+	{
+		for (uint64_t i = 0; i < iterations; i++) {
+			char *buf = list_->AllocateKey(sizeof(uint64_t));
+			EncodeFixed64(buf, keys_[i]);
+			list_->Insert(buf);
+		}
+	}
+
+    private:
+	Fixed64KeyComparator cmp_;
+	std::unique_ptr<ConcurrentArena> arena_;
+	std::unique_ptr<SkipList> list_;
+	std::vector<uint64_t> keys_;
+};
+
+class SkipListSeekBench : public Microbench {
+    public:
+	virtual const char *Name() const override
+	{
+		return "InlineSkipList/Seek";
+	}
+	virtual void Setup() override
+	{
+		list_.reset(new SkipList(cmp_, &arena_));
+		for (uint64_t i = 0; i < kNumKeys; i++) {
+			char *buf = list_->AllocateKey(sizeof(uint64_t));
+			EncodeFixed64(buf, i * 2);
+			list_->Insert(buf);
+		}
+		Random64 rnd(301);
+		for (auto &target : targets_) {
+			target = rnd.Uniform(kNumKeys * 2);
+		}
+	}
+	virtual void Run(uint64_t iterations) override
+	{
+		SkipList::Iterator iter(list_.get());
+		char target[sizeof(uint64_t)];
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < iterations; i++) {
+			EncodeFixed64(target, targets_[i % kNumTargets]);
+			iter.Seek(target);
+			sum += iter.Valid() ? 1 : 0;
+		}
+		benchmark_sink = sum;
+	}
+
+    private:
+	static const uint64_t kNumKeys = 1 << 20;
+	static const size_t kNumTargets = 1 << 16;
+	Fixed64KeyComparator cmp_;
+	ConcurrentArena arena_;
+	std::unique_ptr<SkipList> list_;
+	uint64_t targets_[kNumTargets];
+};
+
+// Seeks in a 4KB block of 16-byte keys and 100-byte values
+class BlockIterSeekBench : public Microbench {
+    public:
+	BlockIterSeekBench() : builder_(16)
+	{
+	}
+	virtual const char *Name() const override
+	{
+		return "BlockIter/Seek";
+	}
+	virtual void Setup() override
+	{
+		const std::string value(100, 'v');
+		for (int i = 0; builder_.CurrentSizeEstimate() < 4096; i++) {
+			keys_.push_back(Key(i));
+			builder_.Add(keys_.back(), value);
+		}
+		BlockContents contents;
+		contents.data = builder_.Finish();
+		contents.cachable = false;
+		block_.reset(new Block(std::move(contents),
+				       kDisableGlobalSequenceNumber));
+		iter_.reset(block_->NewIterator(BytewiseComparator()));
+		Random rnd(301);
+		for (auto &target : targets_) {
+			target = rnd.Uniform(static_cast<int>(keys_.size()));
+		}
+	}
+	virtual void Run(uint64_t iterations) override
+	{
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < iterations; i++) {
+			iter_->Seek(keys_[targets_[i % kNumTargets]]);
+			sum += iter_->value().size();
+		}
+		benchmark_sink = sum;
+	}
+
+    private:
+	static const size_t kNumTargets = 1 << 12;
+
+	static std::string Key(int i)
+	{
+		char buf[17];
+		snprintf(buf, sizeof(buf), "key%013d", i);
+		return buf;
+	}
+
+	BlockBuilder builder_;
+	std::vector<std::string> keys_;
+	std::unique_ptr<Block> block_;
+	std::unique_ptr<InternalIterator> iter_;
+	int targets_[kNumTargets];
+};
+
+// Probes a full filter of 1M keys at 10 bits per key, half of them for
+// keys that were added
+class BloomProbeBench : public Microbench {
+    public:
+	virtual const char *Name() const override
+	{
+		return "Bloom/Probe";
+	}
+	virtual void Setup() override
+	{
+		policy_.reset(NewBloomFilterPolicy(10, false));
+		std::unique_ptr<FilterBitsBuilder> builder(
+			policy_->GetFilterBitsBuilder());
+		char key[sizeof(uint64_t)];
+		for (uint64_t i = 0; i < kNumKeys; i++) {
+			EncodeFixed64(key, i * 2);
+			builder->AddKey(Slice(key, sizeof(key)));
+		}
+		filter_ = builder->Finish(&filter_data_);
+		reader_.reset(policy_->GetFilterBitsReader(filter_));
+	}
+	virtual void Run(uint64_t iterations) override
+	{
+		char key[sizeof(uint64_t)];
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < iterations; i++) {
+			// Spread over the keys, alternately present and absent
+			EncodeFixed64(key, (i * 7919) % (kNumKeys * 2));
+			sum += reader_->MayMatch(Slice(key, sizeof(key))) ? 1 :
+									    0;
+		}
+		benchmark_sink = sum;
+	}
+
+    private:
+	static const uint64_t kNumKeys = 1 << 20;
+	std::unique_ptr<const FilterPolicy> policy_;
+	std::unique_ptr<const char[]> filter_data_;
+	Slice filter_;
+	std::unique_ptr<FilterBitsReader> reader_;
+};
+
+class LRUCacheLookupBench : public Microbench {
+    public:
+	virtual const char *Name() const override
+	{
+		return "LRUCache/Lookup";
+	}
+	virtual void Setup() override
+	{
+		cache_ = NewLRUCache(64 << 20);
+		char key[sizeof(uint64_t)];
+		for (uint64_t i = 0; i < kNumKeys; i++) {
+			EncodeFixed64(key, i);
+			cache_->Insert(Slice(key, sizeof(key)), nullptr, 1,
+				       nullptr);
+		}
+	}
+	virtual void Run(uint64_t iterations) override
+	{
+		char key[sizeof(uint64_t)];
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < iterations; i++) {
+			EncodeFixed64(key, (i * 7919) % kNumKeys);
+			Cache::Handle *handle =
+				cache_->Lookup(Slice(key, sizeof(key)));
+			if (handle != nullptr) {
+				sum++;
+				cache_->Release(handle);
+			}
+		}
+		benchmark_sink = sum;
+	}
+
+    private:
+	static const uint64_t kNumKeys = 100000;
+	std::shared_ptr<Cache> cache_;
+};
+
+// Puts 16-byte keys and 100-byte values into a batch
+class WriteBatchPutBench : public Microbench {
+    public:
+	virtual const char *Name() const override
+	{
+		return "WriteBatch/Put";
+	}
+	virtual void Run(uint64_t iterations) override
+	{
+		WriteBatch batch;
+		const std::string value(100, 'v');
+		char key[16] = { 0 };
+		for (uint64_t i = 0; i < iterations; i++) {
+			if (i % 1000 == 0) {
+				batch.Clear();
+			}
+			EncodeFixed64(key, i);
+			batch.Put(Slice(key, sizeof(key)), value);
+		}
+		benchmark_sink = batch.Count();
+	}
+	virtual uint64_t BytesPerOp() const override
+	{
+		return 116;
+	}
+};
+
+// Iterates a batch of 100 puts
+class WriteBatchIterateBench : public Microbench {
+    public:
+	virtual const char *Name() const override
+	{
+		return "WriteBatch/Iterate";
+	}
+	virtual void Setup() override
+	{
+		const std::string value(100, 'v');
+		char key[16] = { 0 };
+		for (int i = 0; i < 100; i++) {
+			EncodeFixed64(key, i);
+			batch_.Put(Slice(key, sizeof(key)), value);
+		}
+	}
+	virtual void Run(uint64_t iterations) override
+	{
+		Counter counter;
+		for (uint64_t i = 0; i < iterations; i++) {
+			batch_.Iterate(&counter);
+		}
+		benchmark_sink = counter.bytes;
+	}
+	virtual uint64_t BytesPerOp() const override
+	{
+		return batch_.GetDataSize();
+	}
+
+    private:
+	struct Counter : public WriteBatch::Handler {
+		uint64_t bytes = 0;
+		virtual void Put(const Slice &key, const Slice &value) override
+		{
+			bytes += key.size() + value.size();
+		}
+	};
+	WriteBatch batch_;
+};
+
+class Crc32cBench : public Microbench {
+    public:
+	virtual const char *Name() const override
+	{
+		return "Crc32c/4096";
+	}
+	virtual void Setup() override
+	{
+		Random rnd(301);
+		for (auto &c : buf_) {
+			c = static_cast<char>(rnd.Uniform(256));
+		}
+	}
+	virtual void Run(uint64_t iterations) override
+	{
+		uint32_t crc = 0;
+		for (uint64_t i = 0; i < iterations; i++) {
+			crc = crc32c::Extend(crc, buf_, sizeof(buf_));
+		}
+		benchmark_sink = crc;
+	}
+	virtual uint64_t BytesPerOp() const override
+	{
+		return sizeof(buf_);
+	}
+
+    private:
+	char buf_[4096];
+};
+
+// Next() over 8 sorted children of 16K keys each
+class MergingIteratorNextBench : public Microbench {
+    public:
+	virtual const char *Name() const override
+	{
+		return "MergingIterator/Next";
+	}
+	virtual void Setup() override
+	{
+		std::vector<InternalIterator *> children;
+		for (int c = 0; c < kNumChildren; c++) {
+			std::vector<std::string> keys;
+			for (int i = 0; i < kKeysPerChild; i++) {
+				char buf[17];
+				snprintf(buf, sizeof(buf), "key%013d",
+					 i * kNumChildren + c);
+				keys.push_back(buf);
+			}
+			children.push_back(new test::VectorIterator(keys));
+		}
+		iter_.reset(NewMergingIterator(BytewiseComparator(),
+					       &children[0], kNumChildren));
+		iter_->SeekToFirst();
+	}
+	virtual void Run(uint64_t iterations) override
+	{
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < iterations; i++) {
+			iter_->Next();
+			if (!iter_->Valid()) {
+				iter_->SeekToFirst();
+			}
+			sum += iter_->key().size();
+		}
+		benchmark_sink = sum;
+	}
+
+    private:
+	static const int kNumChildren = 8;
+	static const int kKeysPerChild = 16384;
+	std::unique_ptr<InternalIterator> iter_;
+};
+
+#ifndef ROCKSDB_LITE
+// Uncontended lock and unlock of a key by a pessimistic transaction
+class TransactionLockBench : public Microbench {
+    public:
+	virtual ~TransactionLockBench()
+	{
+		txn_.reset();
+		txn_db_.reset();
+	}
+	virtual const char *Name() const override
+	{
+		return "TransactionLockMgr/TryLock";
+	}
+	virtual void Setup() override
+	{
+		env_.reset(NewMemEnv(Env::Default()));
+		Options options;
+		options.create_if_missing = true;
+		options.env = env_.get();
+		TransactionDB *txn_db = nullptr;
+		Status s = TransactionDB::Open(options, TransactionDBOptions(),
+					       "/microbench", &txn_db);
+		if (!s.ok()) {
+			fprintf(stderr, "Open: %s\n", s.ToString().c_str());
+			exit(1);
+		}
+		txn_db_.reset(txn_db);
+		txn_.reset(txn_db_->BeginTransaction(WriteOptions()));
+		for (int i = 0; i < kNumKeys; i++) {
+			keys_.push_back(ToString(i));
+		}
+	}
+	virtual void Run(uint64_t iterations) override
+	{
+		auto *txn_db_impl = static_cast<TransactionDBImpl *>(
+			txn_db_.get());
+		auto *txn_impl = static_cast<TransactionImpl *>(txn_.get());
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < iterations; i++) {
+			const std::string &key = keys_[i % kNumKeys];
+			Status s = txn_db_impl->TryLock(txn_impl, 0, key, true);
+			sum += s.ok() ? 1 : 0;
+			txn_db_impl->UnLock(txn_impl, 0, key);
+		}
+		benchmark_sink = sum;
+	}
+
+    private:
+	static const int kNumKeys = 1024;
+	std::unique_ptr<Env> env_;
+	std::unique_ptr<TransactionDB> txn_db_;
+	std::unique_ptr<Transaction> txn_;
+	std::vector<std::string> keys_;
+};
+#endif // ROCKSDB_LITE
+
+std::vector<std::unique_ptr<Microbench> > AllMicrobenchmarks()
+{
+	std::vector<std::unique_ptr<Microbench> > benchmarks;
+	benchmarks.emplace_back(new SkipListInsertBench());
+	benchmarks.emplace_back(new SkipListSeekBench());
+	benchmarks.emplace_back(new BlockIterSeekBench());
+	benchmarks.emplace_back(new BloomProbeBench());
+	benchmarks.emplace_back(new LRUCacheLookupBench());
+	benchmarks.emplace_back(new WriteBatchPutBench());
+	benchmarks.emplace_back(new WriteBatchIterateBench());
+	benchmarks.emplace_back(new Crc32cBench());
+	benchmarks.emplace_back(new MergingIteratorNextBench());
+#ifndef ROCKSDB_LITE
+	benchmarks.emplace_back(new TransactionLockBench());
+#endif // ROCKSDB_LITE
+	return benchmarks;
+}
+
+bool Selected(const char *name)
+{
+	if (FLAGS_benchmarks.empty()) {
+		return true;
+	}
+	for (const std::string &filter : StringSplit(FLAGS_benchmarks, ',')) {
+		if (!filter.empty() &&
+		    std::string(name).find(filter) != std::string::npos) {
+			return true;
+		}
+	}
+	return false;
+}
+
+uint64_t TimedRun(Microbench *bench, uint64_t iterations)
+{
+	bench->Prepare(iterations);
+	uint64_t start = Env::Default()->NowNanos();
+	bench->Run(iterations);
+	return Env::Default()->NowNanos() - start;
+}
+
+MicrobenchResult RunMicrobench(Microbench *bench)
+{
+	MicrobenchResult result;
+	result.name = bench->Name();
+	bench->Setup();
+	result.bytes_per_op = bench->BytesPerOp();
+
+	// Grow the iterations until a run takes min_time_ms, which also
+	// warms up caches and the branch predictor
+	const uint64_t min_time_ns =
+		static_cast<uint64_t>(std::max(FLAGS_min_time_ms, 1)) * 1000000;
+	uint64_t iterations = 1;
+	while (true) {
+		uint64_t elapsed = TimedRun(bench, iterations);
+		if (elapsed >= min_time_ns) {
+			break;
+		}
+		uint64_t next = elapsed == 0 ?
+					      iterations * 100 :
+					      static_cast<uint64_t>(
+						iterations * 1.2 * min_time_ns /
+						elapsed);
+		iterations = std::min(std::max(next, iterations + 1),
+				      iterations * 100);
+	}
+	result.iterations = iterations;
+
+	double sum = 0;
+	for (int i = 0; i < std::max(FLAGS_repetitions, 1); i++) {
+		double ns = static_cast<double>(TimedRun(bench, iterations)) /
+			    iterations;
+		result.ns_per_op.push_back(ns);
+		sum += ns;
+	}
+	std::vector<double> sorted = result.ns_per_op;
+	std::sort(sorted.begin(), sorted.end());
+	size_t n = sorted.size();
+	result.median = n % 2 == 1 ? sorted[n / 2] :
+				     (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+	result.min = sorted[0];
+	double mean = sum / n;
+	double squares = 0;
+	for (double ns : sorted) {
+		squares += (ns - mean) * (ns - mean);
+	}
+	result.cv = mean > 0 ? sqrt(squares / n) / mean : 0;
+	return result;
+}
+
+void PrintResult(const MicrobenchResult &result)
+{
+	char throughput[32] = "";
+	if (result.bytes_per_op > 0 && result.median > 0) {
+		snprintf(throughput, sizeof(throughput), "%.1f MB/s",
+			 result.bytes_per_op * 1e3 / result.median);
+	}
+	fprintf(stdout, "%-28s %12.2f %12.2f %8.2f%% %14" PRIu64 " %s\n",
+		result.name.c_str(), result.median, result.min,
+		result.cv * 100, result.iterations, throughput);
+	fflush(stdout);
+}
+
+bool WriteJson(const std::string &path,
+	       const std::vector<MicrobenchResult> &results)
+{
+	FILE *f = fopen(path.c_str(), "w");
+	if (f == nullptr) {
+		fprintf(stderr, "Cannot open %s\n", path.c_str());
+		return false;
+	}
+	char date[32];
+	time_t now = time(nullptr);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+	fprintf(f, "{\n  \"context\": {\n");
+	fprintf(f, "    \"date\": \"%s\",\n", date);
+	fprintf(f, "    \"rocksdb_version\": \"%d.%d.%d\",\n", ROCKSDB_MAJOR,
+		ROCKSDB_MINOR, ROCKSDB_PATCH);
+#ifdef NDEBUG
+	fprintf(f, "    \"build_type\": \"release\",\n");
+#else
+	fprintf(f, "    \"build_type\": \"debug\",\n");
+#endif
+	fprintf(f, "    \"num_cpus\": %u,\n",
+		std::thread::hardware_concurrency());
+	fprintf(f, "    \"repetitions\": %d,\n", FLAGS_repetitions);
+	fprintf(f, "    \"min_time_ms\": %d\n  },\n", FLAGS_min_time_ms);
+	fprintf(f, "  \"benchmarks\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const MicrobenchResult &result = results[i];
+		fprintf(f, "    {\n      \"name\": \"%s\",\n",
+			result.name.c_str());
+		fprintf(f, "      \"iterations\": %" PRIu64 ",\n",
+			result.iterations);
+		fprintf(f, "      \"time_unit\": \"ns\",\n");
+		fprintf(f, "      \"median\": %.3f,\n", result.median);
+		fprintf(f, "      \"min\": %.3f,\n", result.min);
+		fprintf(f, "      \"cv\": %.5f,\n", result.cv);
+		fprintf(f, "      \"bytes_per_op\": %" PRIu64 ",\n",
+			result.bytes_per_op);
+		fprintf(f, "      \"repetitions\": [");
+		for (size_t r = 0; r < result.ns_per_op.size(); r++) {
+			fprintf(f, "%s%.3f", r == 0 ? "" : ", ",
+				result.ns_per_op[r]);
+		}
+		fprintf(f, "]\n    }%s\n", i + 1 < results.size() ? "," : "");
+	}
+	fprintf(f, "  ]\n}\n");
+	return fclose(f) == 0;
+}
+} // namespace
+} // namespace rocksdb
+
+int main(int argc, char **argv)
+{
+	SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+			" [OPTIONS]...");
+	ParseCommandLineFlags(&argc, &argv, true);
+
+	auto benchmarks = rocksdb::AllMicrobenchmarks();
+	if (FLAGS_list) {
+		for (const auto &bench : benchmarks) {
+			fprintf(stdout, "%s\n", bench->Name());
+		}
+		return 0;
+	}
+#ifndef NDEBUG
+	fprintf(stderr, "WARNING: Assertions are enabled; benchmarks "
+			"unnecessarily slow\n");
+#endif
+
+	fprintf(stdout, "%-28s %12s %12s %9s %14s\n", "benchmark",
+		"median ns/op", "min ns/op", "cv", "iterations");
+	std::vector<rocksdb::MicrobenchResult> results;
+	for (const auto &bench : benchmarks) {
+		if (!rocksdb::Selected(bench->Name())) {
+			continue;
+		}
+		results.push_back(rocksdb::RunMicrobench(bench.get()));
+		rocksdb::PrintResult(results.back());
+	}
+	if (!FLAGS_json.empty() && !rocksdb::WriteJson(FLAGS_json, results)) {
+		return 1;
+	}
+	return 0;
+}
+
+#endif // GFLAGS
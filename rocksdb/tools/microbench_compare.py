@@ -0,0 +1,69 @@
+#! /usr/bin/env python
+# Compares two JSON result files of the microbench tool, e.g.
+#
+#   ./microbench --json=base.json    # on the base commit
+#   ./microbench --json=new.json     # on the change
+#   python tools/microbench_compare.py base.json new.json
+#
+# A benchmark regresses when its median time per operation grows by more
+# than --threshold percent and by more than twice the noise of the two
+# runs, as measured by their coefficients of variation. Exits with 1 if
+# any benchmark regressed.
+from __future__ import print_function
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        results = json.load(f)
+    return results['context'], {b['name']: b for b in results['benchmarks']}
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Compare two microbench JSON result files.')
+    parser.add_argument('base')
+    parser.add_argument('new')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='Minimum slowdown, in percent, to report as '
+                        'a regression')
+    args = parser.parse_args()
+
+    base_context, base = load(args.base)
+    new_context, new = load(args.new)
+    for key in ('build_type', 'num_cpus'):
+        if base_context.get(key) != new_context.get(key):
+            print('WARNING: %s differs: %s vs %s' %
+                  (key, base_context.get(key), new_context.get(key)))
+
+    print('%-28s %12s %12s %9s %8s' %
+          ('benchmark', 'base ns/op', 'new ns/op', 'change', 'noise'))
+    regressions = []
+    for name in sorted(set(base) & set(new)):
+        b = base[name]
+        n = new[name]
+        change = (n['median'] - b['median']) * 100.0 / b['median']
+        noise = 200.0 * max(b['cv'], n['cv'])
+        verdict = ''
+        if change > max(args.threshold, noise):
+            verdict = 'REGRESSION'
+            regressions.append(name)
+        elif -change > max(args.threshold, noise):
+            verdict = 'improvement'
+        print('%-28s %12.2f %12.2f %+8.2f%% %7.2f%% %s' %
+              (name, b['median'], n['median'], change, noise, verdict))
+    for name in sorted(set(base) ^ set(new)):
+        print('%-28s only in %s' %
+              (name, args.base if name in base else args.new))
+
+    if regressions:
+        print('%d regression(s): %s' %
+              (len(regressions), ', '.join(regressions)))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
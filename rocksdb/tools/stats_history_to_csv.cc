@@ -0,0 +1,106 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "monitoring/stats_history.h"
+#include "rocksdb/env.h"
+
+using namespace rocksdb;
+
+namespace
+{
+void PrintUsage()
+{
+	fprintf(stdout,
+		"Usage: stats_history_to_csv --file=stats_history_file\n"
+		"Prints the snapshots of a DBOptions::stats_history_file as "
+		"CSV, one row per\nsnapshot. A header row comes first and "
+		"again whenever the set of statistics\nchanges.\n");
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+	const struct option options[] = {
+		{ "help", no_argument, nullptr, 'h' },
+		{ "file", required_argument, nullptr, 'f' },
+		{ nullptr, 0, nullptr, 0 },
+	};
+	std::string file;
+	while (true) {
+		int c = getopt_long(argc, argv, "hf:", options, nullptr);
+		if (c < 0) {
+			break;
+		}
+		switch (c) {
+		case 'h':
+			PrintUsage();
+			return 0;
+		case 'f':
+			file = optarg;
+			break;
+		default:
+			fprintf(stderr, "Unrecognized option.\n");
+			return -1;
+		}
+	}
+	if (file.empty()) {
+		PrintUsage();
+		return -1;
+	}
+
+	std::unique_ptr<StatsHistoryFileReader> reader;
+	Status s = NewStatsHistoryFileReader(Env::Default(), EnvOptions(), file,
+					     &reader);
+	if (!s.ok()) {
+		fprintf(stderr, "Failed to open %s: %s\n", file.c_str(),
+			s.ToString().c_str());
+		return -1;
+	}
+
+	std::vector<std::string> names;
+	StatsSnapshot snapshot;
+	while ((s = reader->Next(&snapshot)).ok()) {
+		bool same_names = names.size() == snapshot.stats.size();
+		if (same_names) {
+			size_t i = 0;
+			for (const auto &entry : snapshot.stats) {
+				if (entry.first != names[i++]) {
+					same_names = false;
+					break;
+				}
+			}
+		}
+		if (!same_names) {
+			names.clear();
+			fprintf(stdout, "time_micros");
+			for (const auto &entry : snapshot.stats) {
+				fprintf(stdout, ",%s", entry.first.c_str());
+				names.push_back(entry.first);
+			}
+			fprintf(stdout, "\n");
+		}
+		fprintf(stdout, "%" PRIu64, snapshot.time_micros);
+		for (const auto &entry : snapshot.stats) {
+			fprintf(stdout, ",%" PRIu64, entry.second);
+		}
+		fprintf(stdout, "\n");
+	}
+	if (!s.IsIncomplete()) {
+		fprintf(stderr, "Stopped reading at: %s\n",
+			s.ToString().c_str());
+		return -1;
+	}
+	return 0;
+}
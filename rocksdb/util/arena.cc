@@ -82,6 +82,9 @@ Arena::~Arena()
 	for (const auto &block : blocks_) {
 		delete[] block;
 	}
+	for (const auto &numa_block : numa_blocks_) {
+		port::NumaFree(numa_block.addr_, numa_block.length_);
+	}
 
 #ifdef MAP_HUGETLB
 	for (const auto &mmap_info : huge_blocks_) {
@@ -202,6 +205,24 @@ char *Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
 	return result;
 }
 
+char *Arena::AllocateOnNumaNode(size_t bytes, int numa_node)
+{
+	// same reserve-first trick as in AllocateNewBlock()
+	numa_blocks_.reserve(numa_blocks_.size() + 1);
+
+	char *block =
+		static_cast<char *>(port::NumaAllocOnNode(bytes, numa_node));
+	if (block == nullptr) {
+		return AllocateNewBlock(bytes);
+	}
+	blocks_memory_ += bytes;
+	if (tracker_ != nullptr) {
+		tracker_->Allocate(bytes);
+	}
+	numa_blocks_.emplace_back(block, bytes);
+	return block;
+}
+
 char *Arena::AllocateNewBlock(size_t block_bytes)
 {
 	// already reserve space in blocks_ before allocating memory via new.
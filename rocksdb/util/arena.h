@@ -60,6 +60,10 @@ class Arena : public Allocator {
 	char *AllocateAligned(size_t bytes, size_t huge_page_size = 0,
 			      Logger *logger = nullptr) override;
 
+	// Allocate a dedicated, aligned block of bytes placed on the given
+	// NUMA node (see port::NumaAllocOnNode()). It is freed with the arena.
+	char *AllocateOnNumaNode(size_t bytes, int numa_node);
+
 	// Returns an estimate of the total memory usage of data allocated
 	// by the arena (exclude the space allocated but not yet used for future
 	// allocations).
@@ -110,6 +114,8 @@ class Arena : public Allocator {
 		}
 	};
 	std::vector<MmapInfo> huge_blocks_;
+	// Blocks from AllocateOnNumaNode()
+	std::vector<MmapInfo> numa_blocks_;
 	size_t irregular_block_num = 0;
 
 	// Stats for current active block.
@@ -207,6 +207,20 @@ TEST_F(ArenaTest, Simple)
 	SimpleTest(0);
 	SimpleTest(kHugePageSize);
 }
+
+TEST_F(ArenaTest, AllocateOnNumaNode)
+{
+	Arena arena;
+	size_t before = arena.MemoryAllocatedBytes();
+	const size_t kBytes = 64 * 1024;
+	char *p = arena.AllocateOnNumaNode(kBytes, port::CurrentNumaNode());
+	ASSERT_TRUE(p != nullptr);
+	ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(p) % sizeof(void *));
+	memset(p, 'x', kBytes);
+	ASSERT_EQ(before + kBytes, arena.MemoryAllocatedBytes());
+	// The block is dedicated, the current block is left untouched
+	ASSERT_EQ(Arena::kInlineSize, arena.AllocatedAndUnused());
+}
 } // namespace rocksdb
 
 int main(int argc, char **argv)
@@ -0,0 +1,241 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/block_cache_tracer.h"
+
+#include <algorithm>
+
+#include "rocksdb/version.h"
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace rocksdb
+{
+namespace
+{
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+__thread BlockCacheTraceCaller thread_caller = kTraceUserIterator;
+#endif
+
+const char kHitFlag = 1;
+const char kNoInsertFlag = 2;
+} // namespace
+
+BlockCacheTraceCaller GetBlockCacheTraceCaller()
+{
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+	return thread_caller;
+#else
+	return kTraceUnknownCaller;
+#endif
+}
+
+BlockCacheTraceCallerGuard::BlockCacheTraceCallerGuard(
+	BlockCacheTraceCaller caller)
+{
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+	prev_caller_ = thread_caller;
+	thread_caller = caller;
+#else
+	(void)caller;
+	prev_caller_ = kTraceUnknownCaller;
+#endif
+}
+
+BlockCacheTraceCallerGuard::~BlockCacheTraceCallerGuard()
+{
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+	thread_caller = prev_caller_;
+#endif
+}
+
+void EncodeBlockCacheTraceRecord(const BlockCacheTraceRecord &record,
+				 std::string *payload)
+{
+	PutLengthPrefixedSlice(payload, record.block_key);
+	payload->push_back(record.block_type);
+	PutVarint64(payload, record.block_size);
+	PutVarint32(payload, record.cf_id);
+	PutVarint32(payload, static_cast<uint32_t>(record.level + 1));
+	payload->push_back(record.caller);
+	char flags = 0;
+	if (record.is_cache_hit) {
+		flags |= kHitFlag;
+	}
+	if (record.no_insert) {
+		flags |= kNoInsertFlag;
+	}
+	payload->push_back(flags);
+}
+
+Status DecodeBlockCacheTraceRecord(const Slice &payload,
+				   BlockCacheTraceRecord *record)
+{
+	Slice input = payload;
+	Slice block_key;
+	uint32_t level_plus_one = 0;
+	if (!GetLengthPrefixedSlice(&input, &block_key) || input.empty()) {
+		return Status::Corruption("Bad block cache trace record");
+	}
+	record->block_key = block_key.ToString();
+	record->block_type = static_cast<BlockCacheTraceBlockType>(input[0]);
+	input.remove_prefix(1);
+	if (!GetVarint64(&input, &record->block_size) ||
+	    !GetVarint32(&input, &record->cf_id) ||
+	    !GetVarint32(&input, &level_plus_one) || input.size() < 2) {
+		return Status::Corruption("Bad block cache trace record");
+	}
+	record->level = static_cast<int>(level_plus_one) - 1;
+	record->caller = static_cast<BlockCacheTraceCaller>(input[0]);
+	record->is_cache_hit = (input[1] & kHitFlag) != 0;
+	record->no_insert = (input[1] & kNoInsertFlag) != 0;
+	if (record->block_type >= kTraceBlockTypeMax ||
+	    record->caller >= kTraceCallerMax) {
+		return Status::Corruption("Bad block cache trace record");
+	}
+	return Status::OK();
+}
+
+BlockCacheTracer::BlockCacheTracer()
+	: tracing_(false), sampling_frequency_(1), env_(nullptr)
+{
+}
+
+BlockCacheTracer::~BlockCacheTracer()
+{
+	EndTrace();
+}
+
+Status BlockCacheTracer::StartTrace(Env *env,
+				    const TraceOptions &trace_options,
+				    std::unique_ptr<TraceWriter> &&trace_writer)
+{
+	std::lock_guard<std::mutex> lock(trace_mutex_);
+	if (writer_) {
+		return Status::Busy("A block cache trace is already running");
+	}
+	env_ = env;
+	const uint64_t sampling_frequency =
+		std::max<uint64_t>(trace_options.sampling_frequency, 1);
+	sampling_frequency_.store(sampling_frequency,
+				  std::memory_order_relaxed);
+
+	Trace header;
+	header.ts = env_->NowMicros();
+	header.type = kTraceBegin;
+	header.payload = kTraceMagic;
+	PutFixed32(&header.payload, kTraceFormatVersion);
+	PutFixed32(&header.payload, ROCKSDB_MAJOR);
+	PutFixed32(&header.payload, ROCKSDB_MINOR);
+	std::string encoded;
+	EncodeTrace(header, &encoded);
+	Status s = trace_writer->Write(encoded);
+	if (!s.ok()) {
+		return s;
+	}
+	std::atomic_store(&writer_,
+			  std::make_shared<BackgroundTraceWriter>(
+				  std::move(trace_writer),
+				  trace_options.max_trace_file_size));
+	tracing_.store(true, std::memory_order_relaxed);
+	return s;
+}
+
+Status BlockCacheTracer::EndTrace()
+{
+	std::lock_guard<std::mutex> lock(trace_mutex_);
+	if (!writer_) {
+		return Status::IOError("No block cache trace running");
+	}
+	tracing_.store(false, std::memory_order_relaxed);
+	std::shared_ptr<BackgroundTraceWriter> writer = std::atomic_exchange(
+		&writer_, std::shared_ptr<BackgroundTraceWriter>());
+	Trace footer;
+	footer.ts = env_->NowMicros();
+	footer.type = kTraceEnd;
+	std::string encoded;
+	EncodeTrace(footer, &encoded);
+	return writer->Close(encoded);
+}
+
+Status BlockCacheTracer::WriteBlockAccess(const BlockCacheTraceRecord &record)
+{
+	if (!tracing_.load(std::memory_order_relaxed)) {
+		return Status::OK();
+	}
+	// Sampling by block keeps all the accesses of a sampled block, so the
+	// trace still shows how soon each block is reused.
+	const uint32_t block_hash =
+		Hash(record.block_key.data(), record.block_key.size(), 0);
+	if (block_hash % sampling_frequency_.load(std::memory_order_relaxed) !=
+	    0) {
+		return Status::OK();
+	}
+	std::shared_ptr<BackgroundTraceWriter> writer =
+		std::atomic_load(&writer_);
+	if (!writer || writer->IsFull()) {
+		return Status::OK();
+	}
+	Trace trace;
+	trace.ts = record.access_timestamp;
+	trace.type = kTraceBlockCacheAccess;
+	EncodeBlockCacheTraceRecord(record, &trace.payload);
+	std::string encoded;
+	EncodeTrace(trace, &encoded);
+	writer->Add(std::move(encoded));
+	return Status::OK();
+}
+
+BlockCacheTraceReader::BlockCacheTraceReader(
+	std::unique_ptr<TraceReader> &&reader)
+	: trace_reader_(std::move(reader))
+{
+}
+
+Status BlockCacheTraceReader::ReadHeader()
+{
+	std::string encoded;
+	Status s = trace_reader_->Read(&encoded);
+	if (!s.ok()) {
+		return s;
+	}
+	Trace header;
+	s = DecodeTrace(encoded, &header);
+	if (!s.ok()) {
+		return s;
+	}
+	if (header.type != kTraceBegin ||
+	    !Slice(header.payload).starts_with(kTraceMagic)) {
+		return Status::Corruption("Not a block cache trace");
+	}
+	return Status::OK();
+}
+
+Status BlockCacheTraceReader::ReadAccess(BlockCacheTraceRecord *record)
+{
+	while (true) {
+		std::string encoded;
+		Status s = trace_reader_->Read(&encoded);
+		if (!s.ok()) {
+			return s;
+		}
+		Trace trace;
+		s = DecodeTrace(encoded, &trace);
+		if (!s.ok()) {
+			return s;
+		}
+		if (trace.type == kTraceEnd) {
+			return Status::Incomplete("End of trace");
+		}
+		if (trace.type != kTraceBlockCacheAccess) {
+			continue;
+		}
+		s = DecodeBlockCacheTraceRecord(trace.payload, record);
+		record->access_timestamp = trace.ts;
+		return s;
+	}
+}
+
+} // namespace rocksdb
@@ -0,0 +1,126 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "rocksdb/env.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/trace_replay.h"
+
+namespace rocksdb
+{
+enum BlockCacheTraceBlockType : char {
+	kTraceDataBlock = 0,
+	kTraceFilterBlock = 1,
+	kTraceIndexBlock = 2,
+	kTraceBlockTypeMax,
+};
+
+// What made a table reader look up the block cache.
+enum BlockCacheTraceCaller : char {
+	kTraceUserGet = 0,
+	kTraceUserIterator = 1,
+	kTraceCompaction = 2,
+	// Index and filter blocks loaded when a table is opened
+	kTracePrefetch = 3,
+	kTraceUnknownCaller = 4,
+	kTraceCallerMax,
+};
+
+// One block cache lookup. The timestamp is in the Trace record carrying
+// it, the other fields are its payload:
+//
+//   block key (length prefixed) | block type (1 byte) |
+//   block size (varint64) | cf id (varint32) | level + 1 (varint32) |
+//   caller (1 byte) | flags (1 byte: 1 = hit, 2 = no insert)
+struct BlockCacheTraceRecord {
+	uint64_t access_timestamp = 0;
+	// The block cache key: the table's cache key prefix and the block
+	// offset.
+	std::string block_key;
+	BlockCacheTraceBlockType block_type = kTraceBlockTypeMax;
+	// Bytes the block is charged in the cache
+	uint64_t block_size = 0;
+	uint32_t cf_id = 0;
+	// -1 when unknown
+	int level = -1;
+	BlockCacheTraceCaller caller = kTraceUnknownCaller;
+	bool is_cache_hit = false;
+	// The block is not inserted on a miss (ReadOptions::fill_cache off)
+	bool no_insert = false;
+};
+
+// Caller recorded for the block cache lookups of the current thread;
+// kTraceUserIterator unless a BlockCacheTraceCallerGuard says otherwise.
+BlockCacheTraceCaller GetBlockCacheTraceCaller();
+
+// Sets the caller of the current thread for its lifetime.
+class BlockCacheTraceCallerGuard {
+    public:
+	explicit BlockCacheTraceCallerGuard(BlockCacheTraceCaller caller);
+	~BlockCacheTraceCallerGuard();
+
+    private:
+	BlockCacheTraceCaller prev_caller_;
+};
+
+// BlockCacheTracer records the block cache lookups of the table readers of
+// one DB. It lives as long as the DB; DB::StartBlockCacheTrace() and
+// DB::EndBlockCacheTrace() attach and detach the writer.
+class BlockCacheTracer {
+    public:
+	BlockCacheTracer();
+	~BlockCacheTracer();
+
+	// Returns Busy if a trace is already running.
+	Status StartTrace(Env *env, const TraceOptions &trace_options,
+			  std::unique_ptr<TraceWriter> &&trace_writer);
+	Status EndTrace();
+
+	bool is_tracing_enabled() const
+	{
+		return tracing_.load(std::memory_order_relaxed);
+	}
+
+	// Accesses are sampled by block: TraceOptions::sampling_frequency
+	// keeps every access to one in that many blocks, so that reuse
+	// distances stay intact for the simulator. The sampled records are
+	// queued to a BackgroundTraceWriter; no lock is taken otherwise.
+	Status WriteBlockAccess(const BlockCacheTraceRecord &record);
+
+    private:
+	std::atomic<bool> tracing_;
+	std::atomic<uint64_t> sampling_frequency_;
+	// Serializes StartTrace() and EndTrace(); WriteBlockAccess() loads
+	// writer_ with std::atomic_load() instead.
+	std::mutex trace_mutex_;
+	Env *env_;
+	std::shared_ptr<BackgroundTraceWriter> writer_;
+};
+
+// Reads back a block cache trace.
+class BlockCacheTraceReader {
+    public:
+	explicit BlockCacheTraceReader(std::unique_ptr<TraceReader> &&reader);
+
+	Status ReadHeader();
+	// Returns Incomplete at the end of the trace.
+	Status ReadAccess(BlockCacheTraceRecord *record);
+
+    private:
+	std::unique_ptr<TraceReader> trace_reader_;
+};
+
+void EncodeBlockCacheTraceRecord(const BlockCacheTraceRecord &record,
+				 std::string *payload);
+Status DecodeBlockCacheTraceRecord(const Slice &payload,
+				   BlockCacheTraceRecord *record);
+
+} // namespace rocksdb
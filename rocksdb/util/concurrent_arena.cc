@@ -19,8 +19,9 @@ __thread size_t ConcurrentArena::tls_cpuid = 0;
 #endif
 
 ConcurrentArena::ConcurrentArena(size_t block_size, AllocTracker *tracker,
-				 size_t huge_page_size)
-	: shard_block_size_(block_size / 8), shards_(),
+				 size_t huge_page_size, bool numa_aware)
+	: shard_block_size_(block_size / 8),
+	  numa_aware_(numa_aware && port::NumaNodeCount() > 1), shards_(),
 	  arena_(block_size, tracker, huge_page_size)
 {
 	Fixup();
@@ -43,9 +43,13 @@ class ConcurrentArena : public Allocator {
 	// in fact just passed to the constructor of arena_.  The core-local
 	// shards compute their shard_block_size as a fraction of block_size
 	// that varies according to the hardware concurrency level.
+	// If numa_aware is set and the machine has several NUMA nodes, the
+	// core-local shards refill from blocks placed on the node of the core
+	// doing the refill rather than from the shared main arena block.
 	explicit ConcurrentArena(size_t block_size = Arena::kMinBlockSize,
 				 AllocTracker *tracker = nullptr,
-				 size_t huge_page_size = 0);
+				 size_t huge_page_size = 0,
+				 bool numa_aware = false);
 
 	char *Allocate(size_t bytes) override
 	{
@@ -120,6 +124,8 @@ class ConcurrentArena : public Allocator {
 
 	size_t shard_block_size_;
 
+	bool numa_aware_;
+
 	CoreLocalArray<Shard> shards_;
 
 	Arena arena_;
@@ -181,16 +187,23 @@ class ConcurrentArena : public Allocator {
 			// reload
 			std::lock_guard<SpinMutex> reload_lock(arena_mutex_);
 
-			// If the arena's current block is within a factor of 2 of the right
-			// size, we adjust our request to avoid arena waste.
-			auto exact = arena_allocated_and_unused_.load(
-				std::memory_order_relaxed);
-			assert(exact == arena_.AllocatedAndUnused());
-			avail = exact >= shard_block_size_ / 2 &&
-						exact < shard_block_size_ * 2 ?
-					      exact :
-					      shard_block_size_;
-			s->free_begin_ = arena_.AllocateAligned(avail);
+			if (numa_aware_) {
+				avail = shard_block_size_;
+				s->free_begin_ = arena_.AllocateOnNumaNode(
+					avail, port::CurrentNumaNode());
+			} else {
+				// If the arena's current block is within a factor
+				// of 2 of the right size, we adjust our request to
+				// avoid arena waste.
+				auto exact = arena_allocated_and_unused_.load(
+					std::memory_order_relaxed);
+				assert(exact == arena_.AllocatedAndUnused());
+				bool use_exact =
+					exact >= shard_block_size_ / 2 &&
+					exact < shard_block_size_ * 2;
+				avail = use_exact ? exact : shard_block_size_;
+				s->free_begin_ = arena_.AllocateAligned(avail);
+			}
 			Fixup();
 		}
 		s->allocated_and_unused_.store(avail - bytes,
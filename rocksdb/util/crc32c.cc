@@ -326,5 +326,64 @@ uint32_t Extend(uint32_t crc, const char *buf, size_t size)
 	return ChosenExtend(crc, buf, size);
 }
 
+// Combine() appends len2 zero bytes to crc1 by multiplying it with the
+// matrix of the zero byte operator over GF(2), squared for each bit of
+// len2, as zlib's crc32_combine() does.
+static uint32_t GF2MatrixTimes(const uint32_t *mat, uint32_t vec)
+{
+	uint32_t sum = 0;
+	while (vec) {
+		if (vec & 1) {
+			sum ^= *mat;
+		}
+		vec >>= 1;
+		mat++;
+	}
+	return sum;
+}
+
+static void GF2MatrixSquare(uint32_t *square, const uint32_t *mat)
+{
+	for (int n = 0; n < 32; n++) {
+		square[n] = GF2MatrixTimes(mat, mat[n]);
+	}
+}
+
+uint32_t Combine(uint32_t crc1, uint32_t crc2, uint64_t len2)
+{
+	if (len2 == 0) {
+		return crc1;
+	}
+	uint32_t even[32];
+	uint32_t odd[32];
+	// The operator for one zero bit, with the reversed polynomial
+	odd[0] = 0x82f63b78ul;
+	uint32_t row = 1;
+	for (int n = 1; n < 32; n++) {
+		odd[n] = row;
+		row <<= 1;
+	}
+	// Two, then four zero bits
+	GF2MatrixSquare(even, odd);
+	GF2MatrixSquare(odd, even);
+	// Apply len2 zero bytes, starting with the operator for one byte
+	do {
+		GF2MatrixSquare(even, odd);
+		if (len2 & 1) {
+			crc1 = GF2MatrixTimes(even, crc1);
+		}
+		len2 >>= 1;
+		if (len2 == 0) {
+			break;
+		}
+		GF2MatrixSquare(odd, even);
+		if (len2 & 1) {
+			crc1 = GF2MatrixTimes(odd, crc1);
+		}
+		len2 >>= 1;
+	} while (len2 != 0);
+	return crc1 ^ crc2;
+}
+
 } // namespace crc32c
 } // namespace rocksdb
@@ -22,6 +22,11 @@ extern bool IsFastCrc32Supported();
 // crc32c of a stream of data.
 extern uint32_t Extend(uint32_t init_crc, const char *data, size_t n);
 
+// Return the crc32c of concat(A, B) where crc1 is the crc32c of A and crc2
+// the crc32c of B, which is len2 bytes long.  This lets the crc32c of a
+// stream be computed in pieces, in parallel.
+extern uint32_t Combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+
 // Return the crc32c of data[0,n-1]
 inline uint32_t Value(const char *data, size_t n)
 {
@@ -60,6 +60,26 @@ TEST(CRC, Extend)
 		  Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, Combine)
+{
+	std::string data;
+	for (int i = 0; i < 10000; i++) {
+		data.push_back(static_cast<char>(i * 7 + (i >> 5)));
+	}
+	const uint32_t whole = Value(data.data(), data.size());
+	for (size_t split : { size_t(0), size_t(1), size_t(4095), size_t(5000),
+			      data.size() }) {
+		uint32_t crc1 = Value(data.data(), split);
+		uint32_t crc2 = Value(data.data() + split, data.size() - split);
+		ASSERT_EQ(whole, Combine(crc1, crc2, data.size() - split));
+	}
+	// Three pieces, combined left to right
+	uint32_t crc = Combine(Value(data.data(), 100),
+			       Value(data.data() + 100, 900), 900);
+	crc = Combine(crc, Value(data.data() + 1000, 9000), 9000);
+	ASSERT_EQ(whole, crc);
+}
+
 TEST(CRC, Mask)
 {
 	uint32_t crc = Value("foo", 3);
@@ -7,7 +7,9 @@
 
 #include "util/delete_scheduler.h"
 
+#include <algorithm>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "port/port.h"
@@ -21,10 +23,12 @@ namespace rocksdb
 {
 DeleteScheduler::DeleteScheduler(Env *env, const std::string &trash_dir,
 				 int64_t rate_bytes_per_sec, Logger *info_log,
-				 SstFileManagerImpl *sst_file_manager)
+				 SstFileManagerImpl *sst_file_manager,
+				 uint64_t bytes_max_delete_chunk)
 	: env_(env), trash_dir_(trash_dir),
-	  rate_bytes_per_sec_(rate_bytes_per_sec), pending_files_(0),
-	  closing_(false), cv_(&mu_), info_log_(info_log),
+	  rate_bytes_per_sec_(rate_bytes_per_sec),
+	  bytes_max_delete_chunk_(bytes_max_delete_chunk), pending_files_(0),
+	  pending_bytes_(0), closing_(false), cv_(&mu_), info_log_(info_log),
 	  sst_file_manager_(sst_file_manager)
 {
 	bg_thread_.reset(
@@ -70,11 +74,18 @@ Status DeleteScheduler::DeleteFile(const std::string &file_path)
 		return s;
 	}
 
+	uint64_t file_size = 0;
+	if (!env_->GetFileSize(path_in_trash, &file_size).ok()) {
+		// DeleteTrashFile will report the error
+		file_size = 0;
+	}
+
 	// Add file to delete queue
 	{
 		InstrumentedMutexLock l(&mu_);
-		queue_.push(path_in_trash);
+		queue_.push_back({ path_in_trash, file_size });
 		pending_files_++;
+		pending_bytes_ += file_size;
 		if (pending_files_ == 1) {
 			cv_.SignalAll();
 		}
@@ -156,21 +167,57 @@ void DeleteScheduler::BackgroundEmptyTrash()
 				total_deleted_bytes = 0;
 			}
 
-			// Get new file to delete
-			std::string path_in_trash = queue_.front();
-			queue_.pop();
+			// Get the next files to delete: either a batch of small
+			// files or one chunk of a big one
+			std::vector<FileAndSize> batch;
+			uint64_t batch_bytes = 0;
+			do {
+				batch.push_back(queue_.front());
+				batch_bytes += queue_.front().size;
+				queue_.pop_front();
+			} while (bytes_max_delete_chunk_ > 0 &&
+				 !queue_.empty() &&
+				 batch.size() < kMaxDeleteBatchSize &&
+				 batch_bytes + queue_.front().size <=
+					 bytes_max_delete_chunk_);
 
-			// We dont need to hold the lock while deleting the file
+			// We dont need to hold the lock while deleting files
 			mu_.Unlock();
-			uint64_t deleted_bytes = 0;
-			// Delete file from trash and update total_penlty value
-			Status s =
-				DeleteTrashFile(path_in_trash, &deleted_bytes);
-			total_deleted_bytes += deleted_bytes;
+			size_t num_deleted = 0;
+			bool requeue_front = false;
+			std::vector<std::pair<std::string, Status> > errors;
+			for (FileAndSize &f : batch) {
+				uint64_t deleted_bytes = 0;
+				bool is_complete = true;
+				// Delete file from trash
+				Status s = DeleteTrashFile(
+					f.path, &deleted_bytes, &is_complete);
+				total_deleted_bytes += deleted_bytes;
+				pending_bytes_ -= std::min(
+					deleted_bytes, f.size);
+				f.size -= std::min(deleted_bytes, f.size);
+				if (!s.ok()) {
+					errors.emplace_back(f.path, s);
+					pending_bytes_ -= f.size;
+				}
+				if (is_complete) {
+					num_deleted++;
+				} else {
+					// Only a big file is ever truncated and
+					// it is always alone in its batch
+					assert(batch.size() == 1);
+					requeue_front = true;
+				}
+			}
 			mu_.Lock();
 
-			if (!s.ok()) {
-				bg_errors_[path_in_trash] = s;
+			for (auto &e : errors) {
+				bg_errors_[e.first] = e.second;
+			}
+			if (requeue_front) {
+				// Keep deleting the rest of this file before
+				// moving on to the next one
+				queue_.push_front(batch.front());
 			}
 
 			// Apply penlty if necessary
@@ -192,7 +239,7 @@ void DeleteScheduler::BackgroundEmptyTrash()
 				"DeleteScheduler::BackgroundEmptyTrash:Wait",
 				&total_penlty);
 
-			pending_files_--;
+			pending_files_ -= static_cast<int32_t>(num_deleted);
 			if (pending_files_ == 0) {
 				// Unblock WaitForEmptyTrash since there are no more files waiting
 				// to be deleted
@@ -203,10 +250,41 @@ void DeleteScheduler::BackgroundEmptyTrash()
 }
 
 Status DeleteScheduler::DeleteTrashFile(const std::string &path_in_trash,
-					uint64_t *deleted_bytes)
+					uint64_t *deleted_bytes,
+					bool *is_complete)
 {
 	uint64_t file_size;
+	*is_complete = true;
 	Status s = env_->GetFileSize(path_in_trash, &file_size);
+	if (s.ok() && bytes_max_delete_chunk_ > 0 &&
+	    file_size > bytes_max_delete_chunk_) {
+		// Give back the last chunk of the file to the filesystem, the
+		// rest will be deleted in later rounds
+		unique_ptr<WritableFile> wf;
+		Status my_status = env_->ReopenWritableFile(path_in_trash, &wf,
+							    EnvOptions());
+		if (my_status.ok()) {
+			my_status = wf->Truncate(file_size -
+						 bytes_max_delete_chunk_);
+			if (my_status.ok()) {
+				TEST_SYNC_POINT("DeleteScheduler::"
+						"DeleteTrashFile:Fsync");
+				my_status = wf->Fsync();
+			}
+		}
+		if (my_status.ok()) {
+			*deleted_bytes = bytes_max_delete_chunk_;
+			*is_complete = false;
+			return my_status;
+		}
+		// Truncation is not supported or failed, fall back to
+		// deleting the whole file
+		ROCKS_LOG_WARN(info_log_,
+			       "Failed to truncate %s in trash, deleting it "
+			       "instead -- %s",
+			       path_in_trash.c_str(),
+			       my_status.ToString().c_str());
+	}
 	if (s.ok()) {
 		TEST_SYNC_POINT("DeleteScheduler::DeleteTrashFile:DeleteFile");
 		s = env_->DeleteFile(path_in_trash);
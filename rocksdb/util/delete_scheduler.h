@@ -7,8 +7,9 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <atomic>
+#include <deque>
 #include <map>
-#include <queue>
 #include <string>
 #include <thread>
 
@@ -30,11 +31,18 @@ class SstFileManagerImpl;
 //
 // Rate limiting can be turned off by setting rate_bytes_per_sec = 0, In this
 // case DeleteScheduler will delete files immediately.
+//
+// If bytes_max_delete_chunk > 0, files larger than that are not unlinked in
+// one go but truncated from the end, bytes_max_delete_chunk at a time, so
+// that a single unlink never has to free a huge extent list in the
+// filesystem journal. Files smaller than that are unlinked in batches, the
+// rate limit penalty being applied once per batch.
 class DeleteScheduler {
     public:
 	DeleteScheduler(Env *env, const std::string &trash_dir,
 			int64_t rate_bytes_per_sec, Logger *info_log,
-			SstFileManagerImpl *sst_file_manager);
+			SstFileManagerImpl *sst_file_manager,
+			uint64_t bytes_max_delete_chunk = 0);
 
 	~DeleteScheduler();
 
@@ -61,12 +69,31 @@ class DeleteScheduler {
 	// file_path => error status
 	std::map<std::string, Status> GetBackgroundErrors();
 
+	// Return the number of bytes in trash that are waiting to be deleted
+	uint64_t GetBacklogBytes()
+	{
+		return pending_bytes_.load();
+	}
+
+	uint64_t GetMaxDeleteChunkBytes() const
+	{
+		return bytes_max_delete_chunk_;
+	}
+
     private:
+	// A file in trash and the number of bytes of it still to be deleted
+	struct FileAndSize {
+		std::string path;
+		uint64_t size;
+	};
+
 	Status MoveToTrash(const std::string &file_path,
 			   std::string *path_in_trash);
 
+	// Delete path_in_trash, or only its last bytes_max_delete_chunk_ bytes
+	// if it is bigger than that. *is_complete tells which one happened.
 	Status DeleteTrashFile(const std::string &path_in_trash,
-			       uint64_t *deleted_bytes);
+			       uint64_t *deleted_bytes, bool *is_complete);
 
 	void BackgroundEmptyTrash();
 
@@ -75,12 +102,17 @@ class DeleteScheduler {
 	std::string trash_dir_;
 	// Maximum number of bytes that should be deleted per second
 	std::atomic<int64_t> rate_bytes_per_sec_;
+	// Files bigger than this are truncated in steps of this size before
+	// being unlinked, 0 means unlink them in one go
+	const uint64_t bytes_max_delete_chunk_;
 	// Mutex to protect queue_, pending_files_, bg_errors_, closing_
 	InstrumentedMutex mu_;
 	// Queue of files in trash that need to be deleted
-	std::queue<std::string> queue_;
+	std::deque<FileAndSize> queue_;
 	// Number of files in trash that are waiting to be deleted
 	int32_t pending_files_;
+	// Number of bytes in trash that are waiting to be deleted
+	std::atomic<uint64_t> pending_bytes_;
 	// Errors that happened in BackgroundEmptyTrash (file_path => error)
 	std::map<std::string, Status> bg_errors_;
 	// Set to true in ~DeleteScheduler() to force BackgroundEmptyTrash to stop
@@ -97,6 +129,8 @@ class DeleteScheduler {
 	Logger *info_log_;
 	SstFileManagerImpl *sst_file_manager_;
 	static const uint64_t kMicrosInSecond = 1000 * 1000LL;
+	// Maximum number of small files unlinked between two rate limit waits
+	static const size_t kMaxDeleteBatchSize = 64;
 };
 
 } // namespace rocksdb
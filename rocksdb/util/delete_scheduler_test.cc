@@ -455,6 +455,64 @@ TEST_F(DeleteSchedulerTest, MoveToTrashError)
 	rocksdb::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+// 1- Create a DeleteScheduler with a 128 Kb delete chunk
+// 2- Delete a 1 Mb file and 10 files of 1 Kb
+// --- Hold DeleteScheduler::BackgroundEmptyTrash ---
+// 3- Make sure the backlog accounts for all of them
+// 4- Make sure the big file was truncated 7 times before being unlinked and
+//    that the small files were unlinked in a single batch
+TEST_F(DeleteSchedulerTest, ChunkedDeleteAndBatching)
+{
+	rocksdb::SyncPoint::GetInstance()->LoadDependency({
+		{ "DeleteSchedulerTest::ChunkedDeleteAndBatching:1",
+		  "DeleteScheduler::BackgroundEmptyTrash" },
+	});
+	int bg_fsync = 0;
+	int bg_delete_file = 0;
+	int bg_waits = 0;
+	rocksdb::SyncPoint::GetInstance()->SetCallBack(
+		"DeleteScheduler::DeleteTrashFile:Fsync",
+		[&](void *arg) { bg_fsync++; });
+	rocksdb::SyncPoint::GetInstance()->SetCallBack(
+		"DeleteScheduler::DeleteTrashFile:DeleteFile",
+		[&](void *arg) { bg_delete_file++; });
+	rocksdb::SyncPoint::GetInstance()->SetCallBack(
+		"DeleteScheduler::BackgroundEmptyTrash:Wait",
+		[&](void *arg) { bg_waits++; });
+	rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+	rate_bytes_per_sec_ = 64 * 1024 * 1024; // 64 Mb / sec
+	delete_scheduler_.reset(new DeleteScheduler(env_, trash_dir_,
+						    rate_bytes_per_sec_,
+						    nullptr, nullptr,
+						    128 * 1024));
+
+	ASSERT_OK(delete_scheduler_->DeleteFile(
+		NewDummyFile("big.data", 1024 * 1024)));
+	for (int i = 0; i < 10; i++) {
+		std::string file_name = "data_" + ToString(i) + ".data";
+		ASSERT_OK(
+			delete_scheduler_->DeleteFile(NewDummyFile(file_name)));
+	}
+	ASSERT_EQ(delete_scheduler_->GetBacklogBytes(),
+		  1024 * 1024 + 10 * 1024);
+	ASSERT_EQ(CountFilesInDir(trash_dir_), 11);
+
+	TEST_SYNC_POINT("DeleteSchedulerTest::ChunkedDeleteAndBatching:1");
+	delete_scheduler_->WaitForEmptyTrash();
+
+	ASSERT_EQ(delete_scheduler_->GetBacklogBytes(), 0);
+	ASSERT_EQ(CountFilesInDir(trash_dir_), 0);
+	ASSERT_EQ(bg_fsync, 7);
+	ASSERT_EQ(bg_delete_file, 11);
+	// 7 chunks and the rest of the big file, then one batch of small files
+	ASSERT_EQ(bg_waits, 9);
+	auto bg_errors = delete_scheduler_->GetBackgroundErrors();
+	ASSERT_EQ(bg_errors.size(), 0);
+
+	rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+}
+
 TEST_F(DeleteSchedulerTest, DISABLED_DynamicRateLimiting1)
 {
 	std::vector<uint64_t> penalties;
@@ -10,11 +10,15 @@
 #include "util/file_reader_writer.h"
 
 #include <algorithm>
+#include <deque>
 #include <mutex>
+#include <vector>
 
 #include "monitoring/histogram.h"
 #include "monitoring/iostats_context_imp.h"
 #include "port/port.h"
+#include "rocksdb/perf_level.h"
+#include "rocksdb/threadpool.h"
 #include "util/random.h"
 #include "util/rate_limiter.h"
 #include "util/sync_point.h"
@@ -118,6 +122,248 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice *result,
 	return s;
 }
 
+#ifndef ROCKSDB_LITE
+namespace
+{
+// Threads writing the queued buffers of all the direct write pipelines of
+// the process. A pipeline has at most one job in the pool at a time.
+const int kDirectWriteThreads = 4;
+
+ThreadPool *DirectWriteThreadPool()
+{
+	// Never destroyed, like the Env threads
+	static ThreadPool *pool = NewThreadPool(kDirectWriteThreads);
+	return pool;
+}
+} // namespace
+
+// Double (or multi) buffering for direct I/O. Append() hands every buffer it
+// fills to a thread of a small process-wide pool and continues with a spare
+// one, so that copying the next chunk overlaps with the device write of the
+// previous one. At most max_pending buffers are queued; Append() blocks
+// beyond that. Flush() waits for the queue to drain before it writes the
+// partial tail itself, so the file is always written in offset order and
+// the tail logic is unchanged.
+//
+// The file is never called from two threads at once: while anything is
+// queued, only the pool job of the pipeline calls it, and PrepareWrite() is
+// queued behind the writes. The other calls of the writer come after Wait().
+// The I/O stats of the pool thread are added to those of the writing thread
+// by Submit() and Wait().
+class WritableFileWriter::DirectWritePipeline {
+    public:
+	DirectWritePipeline(WritableFileWriter *writer, size_t max_pending)
+		: writer_(writer), max_pending_(max_pending),
+		  alignment_(writer->buf_.Alignment()), cv_(&mu_),
+		  num_buffers_(0), perf_level_(GetPerfLevel()),
+		  bytes_written_(0), write_nanos_(0), scheduled_(false)
+	{
+	}
+
+	~DirectWritePipeline()
+	{
+		MutexLock l(&mu_);
+		while (scheduled_) {
+			cv_.Wait();
+		}
+		AddIOStats();
+	}
+
+	// Queue the full buffer *buf for writing at offset and replace it with
+	// an empty one of the same capacity. On failure, *buf is unchanged and
+	// the first error of an earlier background write is returned.
+	Status Submit(AlignedBuffer *buf, uint64_t offset,
+		      Env::IOPriority io_priority)
+	{
+		MutexLock l(&mu_);
+		while (status_.ok() && num_buffers_ >= max_pending_) {
+			cv_.Wait();
+		}
+		AddIOStats();
+		if (!status_.ok()) {
+			return status_;
+		}
+		AlignedBuffer next;
+		if (!spare_.empty()) {
+			next = std::move(spare_.back());
+			spare_.pop_back();
+		} else {
+			next.Alignment(alignment_);
+			next.AllocateNewBuffer(buf->Capacity());
+		}
+		next.Size(0);
+		pending_.emplace_back();
+		pending_.back().buf = std::move(*buf);
+		pending_.back().offset = offset;
+		pending_.back().io_priority = io_priority;
+		num_buffers_++;
+		*buf = std::move(next);
+		perf_level_ = GetPerfLevel();
+		if (!scheduled_) {
+			scheduled_ = true;
+			DirectWriteThreadPool()->SubmitJob(
+				[this]() { BackgroundWrite(); });
+		}
+		return Status::OK();
+	}
+
+	// WritableFile::PrepareWrite(), right away if nothing is queued or
+	// else after the queued writes. Only the end of the last one of
+	// consecutive calls matters, so those are merged.
+	void PrepareWrite(size_t offset, size_t len)
+	{
+		MutexLock l(&mu_);
+		if (pending_.empty()) {
+			// The pool job can't pick up anything before mu_ is
+			// released
+			writer_->writable_file_->PrepareWrite(offset, len);
+			return;
+		}
+		// The front may be running already
+		if (pending_.size() == 1 ||
+		    pending_.back().buf.Capacity() > 0) {
+			pending_.emplace_back();
+		}
+		pending_.back().offset = offset;
+		pending_.back().prepare_len = len;
+	}
+
+	// Wait until all queued requests are done
+	Status Wait()
+	{
+		MutexLock l(&mu_);
+		while (!pending_.empty()) {
+			cv_.Wait();
+		}
+		AddIOStats();
+		return status_;
+	}
+
+    private:
+	// A buffer to write at offset, or a PrepareWrite() if buf has no
+	// capacity
+	struct Request {
+		AlignedBuffer buf;
+		uint64_t offset = 0;
+		size_t prepare_len = 0;
+		Env::IOPriority io_priority = Env::IO_TOTAL;
+	};
+
+	// Adds the I/O stats of the pool thread to the calling thread's.
+	// REQUIRES: mu_ held
+	void AddIOStats()
+	{
+		IOSTATS_ADD(bytes_written, bytes_written_);
+		IOSTATS_ADD(write_nanos, write_nanos_);
+		bytes_written_ = 0;
+		write_nanos_ = 0;
+	}
+
+	// Pool job writing the front of the queue. It submits itself again
+	// while anything is left, so that the pipelines take turns in the
+	// pool.
+	void BackgroundWrite()
+	{
+		mu_.Lock();
+		assert(scheduled_ && !pending_.empty());
+		// Only the front is consumed here, and the others only append
+		// to the queue or change a back that isn't the front, so the
+		// front stays valid and unchanged while unlocked.
+		Request &front = pending_.front();
+		const bool is_write = front.buf.Capacity() > 0;
+		if (status_.ok()) {
+			SetPerfLevel(perf_level_);
+			uint64_t bytes_written = IOSTATS(bytes_written);
+			uint64_t write_nanos = IOSTATS(write_nanos);
+			Status s;
+			mu_.Unlock();
+			if (is_write) {
+				s = writer_->WriteDirectAt(
+					front.buf.BufferStart(),
+					front.buf.CurrentSize(), front.offset,
+					alignment_, front.io_priority);
+			} else {
+				writer_->writable_file_->PrepareWrite(
+					front.offset, front.prepare_len);
+			}
+			mu_.Lock();
+			bytes_written_ +=
+				IOSTATS(bytes_written) - bytes_written;
+			write_nanos_ += IOSTATS(write_nanos) - write_nanos;
+			if (!s.ok() && status_.ok()) {
+				status_ = s;
+			}
+		}
+		if (is_write) {
+			spare_.push_back(std::move(front.buf));
+			num_buffers_--;
+		}
+		pending_.pop_front();
+		if (!pending_.empty()) {
+			DirectWriteThreadPool()->SubmitJob(
+				[this]() { BackgroundWrite(); });
+		} else {
+			scheduled_ = false;
+		}
+
+		cv_.SignalAll();
+		// IMPORTANT: there should be no code after calling SignalAll.
+		// This call may signal the destructor that it's OK to proceed
+		// with destruction.
+		mu_.Unlock();
+	}
+
+	WritableFileWriter *const writer_;
+	const size_t max_pending_;
+	const size_t alignment_;
+	port::Mutex mu_;
+	port::CondVar cv_;
+	std::deque<Request> pending_;
+	// Buffers in pending_
+	size_t num_buffers_;
+	std::vector<AlignedBuffer> spare_;
+	// First background write error
+	Status status_;
+	// Of the writing thread, for the I/O stats of the pool thread
+	PerfLevel perf_level_;
+	// I/O stats of the pool thread not yet added by AddIOStats()
+	uint64_t bytes_written_;
+	uint64_t write_nanos_;
+	// BackgroundWrite() is in the pool; set while pending_ isn't empty
+	bool scheduled_;
+};
+#endif // !ROCKSDB_LITE
+
+WritableFileWriter::WritableFileWriter(std::unique_ptr<WritableFile> &&file,
+				       const EnvOptions &options,
+				       Statistics *stats)
+	: writable_file_(std::move(file)), buf_(),
+	  max_buffer_size_(options.writable_file_max_buffer_size),
+	  filesize_(0),
+#ifndef ROCKSDB_LITE
+	  next_write_offset_(0),
+#endif // ROCKSDB_LITE
+	  pending_sync_(false), last_sync_size_(0),
+	  bytes_per_sync_(options.bytes_per_sync),
+	  rate_limiter_(options.rate_limiter), stats_(stats)
+{
+	buf_.Alignment(writable_file_->GetRequiredBufferAlignment());
+	buf_.AllocateNewBuffer(
+		use_direct_io() ? max_buffer_size_ :
+				  std::min((size_t)65536, max_buffer_size_));
+#ifndef ROCKSDB_LITE
+	if (use_direct_io() && options.writable_file_direct_io_buffers > 1) {
+		pipeline_.reset(new DirectWritePipeline(
+			this, options.writable_file_direct_io_buffers - 1));
+	}
+#endif // ROCKSDB_LITE
+}
+
+WritableFileWriter::~WritableFileWriter()
+{
+	Close();
+}
+
 Status WritableFileWriter::Append(const Slice &data)
 {
 	const char *src = data.data();
@@ -132,8 +378,19 @@ Status WritableFileWriter::Append(const Slice &data)
 		IOSTATS_TIMER_GUARD(prepare_write_nanos);
 		TEST_SYNC_POINT(
 			"WritableFileWriter::Append:BeforePrepareWrite");
+#ifndef ROCKSDB_LITE
+		// The pipeline thread may be writing to the file
+		if (pipeline_) {
+			pipeline_->PrepareWrite(
+				static_cast<size_t>(GetFileSize()), left);
+		} else {
+			writable_file_->PrepareWrite(
+				static_cast<size_t>(GetFileSize()), left);
+		}
+#else
 		writable_file_->PrepareWrite(static_cast<size_t>(GetFileSize()),
 					     left);
+#endif // ROCKSDB_LITE
 	}
 
 	// Flush only when buffered I/O
@@ -164,7 +421,7 @@ Status WritableFileWriter::Append(const Slice &data)
 			src += appended;
 
 			if (left > 0) {
-				s = Flush();
+				s = WriteFullBuffer();
 				if (!s.ok()) {
 					break;
 				}
@@ -209,6 +466,11 @@ Status WritableFileWriter::Close()
 	}
 
 	s = Flush(); // flush cache to OS
+#ifndef ROCKSDB_LITE
+	// Flush() may have failed before the pipeline drained; the file must
+	// not be closed under the helper thread.
+	pipeline_.reset();
+#endif // ROCKSDB_LITE
 
 	Status interim;
 	// In direct I/O mode we write whole pages so
@@ -240,6 +502,15 @@ Status WritableFileWriter::Flush()
 	TEST_KILL_RANDOM("WritableFileWriter::Flush:0",
 			 rocksdb_kill_odds * REDUCE_ODDS2);
 
+#ifndef ROCKSDB_LITE
+	if (pipeline_) {
+		s = pipeline_->Wait();
+		if (!s.ok()) {
+			return s;
+		}
+	}
+#endif // ROCKSDB_LITE
+
 	if (buf_.CurrentSize() > 0) {
 		if (use_direct_io()) {
 #ifndef ROCKSDB_LITE
@@ -300,7 +571,9 @@ Status WritableFileWriter::Sync(bool use_fsync)
 		return s;
 	}
 	TEST_KILL_RANDOM("WritableFileWriter::Sync:0", rocksdb_kill_odds);
-	if (!use_direct_io() && pending_sync_) {
+	// Direct I/O still needs the sync for the device cache and the
+	// file metadata
+	if (pending_sync_) {
 		s = SyncInternal(use_fsync);
 		if (!s.ok()) {
 			return s;
@@ -344,20 +617,39 @@ Status WritableFileWriter::RangeSync(uint64_t offset, uint64_t nbytes)
 	return writable_file_->RangeSync(offset, nbytes);
 }
 
-size_t WritableFileWriter::RequestToken(size_t bytes, bool align)
+Status WritableFileWriter::WriteFullBuffer()
+{
+#ifndef ROCKSDB_LITE
+	if (pipeline_) {
+		// A full buffer is a whole number of pages, see
+		// AlignedBuffer::AllocateNewBuffer()
+		assert(buf_.CurrentSize() == buf_.Capacity());
+		assert(buf_.CurrentSize() % buf_.Alignment() == 0);
+		uint64_t offset = next_write_offset_;
+		size_t size = buf_.CurrentSize();
+		Status s = pipeline_->Submit(&buf_, offset,
+					     writable_file_->GetIOPriority());
+		if (s.ok()) {
+			next_write_offset_ += size;
+		}
+		return s;
+	}
+#endif // ROCKSDB_LITE
+	return Flush();
+}
+
+size_t WritableFileWriter::RequestToken(size_t bytes, size_t alignment,
+					 Env::IOPriority io_priority)
 {
-	Env::IOPriority io_priority;
-	if (rate_limiter_ &&
-	    (io_priority = writable_file_->GetIOPriority()) < Env::IO_TOTAL) {
+	if (rate_limiter_ && io_priority < Env::IO_TOTAL) {
 		bytes = std::min(bytes,
 				 static_cast<size_t>(
 					 rate_limiter_->GetSingleBurstBytes()));
 
-		if (align) {
+		if (alignment > 0) {
 			// Here we may actually require more than burst and block
 			// but we can not write less than one page at a time on direct I/O
 			// thus we may want not to use ratelimiter
-			size_t alignment = buf_.Alignment();
 			bytes = std::max(alignment, TruncateToPageBoundary(
 							    alignment, bytes));
 		}
@@ -376,7 +668,8 @@ Status WritableFileWriter::WriteBuffered(const char *data, size_t size)
 	size_t left = size;
 
 	while (left > 0) {
-		size_t allowed = RequestToken(left, false);
+		size_t allowed = RequestToken(left, 0 /* alignment */,
+					      writable_file_->GetIOPriority());
 
 		{
 			IOSTATS_TIMER_GUARD(write_nanos);
@@ -428,44 +721,52 @@ Status WritableFileWriter::WriteDirect()
 	// Round up and pad
 	buf_.PadToAlignmentWith(0);
 
-	const char *src = buf_.BufferStart();
-	uint64_t write_offset = next_write_offset_;
-	size_t left = buf_.CurrentSize();
+	s = WriteDirectAt(buf_.BufferStart(), buf_.CurrentSize(),
+			  next_write_offset_, alignment,
+			  writable_file_->GetIOPriority());
+	if (!s.ok()) {
+		buf_.Size(file_advance + leftover_tail);
+		return s;
+	}
+
+	// Move the tail to the beginning of the buffer
+	// This never happens during normal Append but rather during
+	// explicit call to Flush()/Sync() or Close()
+	buf_.RefitTail(file_advance, leftover_tail);
+	// This is where we start writing next time which may or not be
+	// the actual file size on disk. They match if the buffer size
+	// is a multiple of whole pages otherwise filesize_ is leftover_tail
+	// behind
+	next_write_offset_ += file_advance;
+	return s;
+}
 
+Status WritableFileWriter::WriteDirectAt(const char *src, size_t size,
+					 uint64_t offset, size_t alignment,
+					 Env::IOPriority io_priority)
+{
+	Status s;
+	size_t left = size;
 	while (left > 0) {
 		// Check how much is allowed
-		size_t size = RequestToken(left, true);
+		size_t allowed = RequestToken(left, alignment, io_priority);
 
 		{
 			IOSTATS_TIMER_GUARD(write_nanos);
 			TEST_SYNC_POINT(
 				"WritableFileWriter::Flush:BeforeAppend");
 			// direct writes must be positional
-			s = writable_file_->PositionedAppend(Slice(src, size),
-							     write_offset);
+			s = writable_file_->PositionedAppend(
+				Slice(src, allowed), offset);
 			if (!s.ok()) {
-				buf_.Size(file_advance + leftover_tail);
 				return s;
 			}
 		}
 
-		IOSTATS_ADD(bytes_written, size);
-		left -= size;
-		src += size;
-		write_offset += size;
-		assert((next_write_offset_ % alignment) == 0);
-	}
-
-	if (s.ok()) {
-		// Move the tail to the beginning of the buffer
-		// This never happens during normal Append but rather during
-		// explicit call to Flush()/Sync() or Close()
-		buf_.RefitTail(file_advance, leftover_tail);
-		// This is where we start writing next time which may or not be
-		// the actual file size on disk. They match if the buffer size
-		// is a multiple of whole pages otherwise filesize_ is leftover_tail
-		// behind
-		next_write_offset_ += file_advance;
+		IOSTATS_ADD(bytes_written, allowed);
+		left -= allowed;
+		src += allowed;
+		offset += allowed;
 	}
 	return s;
 }
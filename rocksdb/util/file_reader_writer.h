@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 #include <atomic>
+#include <memory>
 #include <string>
 #include "port/port.h"
 #include "rocksdb/env.h"
@@ -150,36 +151,23 @@ class WritableFileWriter {
 	uint64_t bytes_per_sync_;
 	RateLimiter *rate_limiter_;
 	Statistics *stats_;
+#ifndef ROCKSDB_LITE
+	// Writes full direct I/O buffers in the background when
+	// EnvOptions::writable_file_direct_io_buffers > 1
+	class DirectWritePipeline;
+	std::unique_ptr<DirectWritePipeline> pipeline_;
+#endif // ROCKSDB_LITE
 
     public:
 	WritableFileWriter(std::unique_ptr<WritableFile> &&file,
 			   const EnvOptions &options,
-			   Statistics *stats = nullptr)
-		: writable_file_(std::move(file)), buf_(),
-		  max_buffer_size_(options.writable_file_max_buffer_size),
-		  filesize_(0),
-#ifndef ROCKSDB_LITE
-		  next_write_offset_(0),
-#endif // ROCKSDB_LITE
-		  pending_sync_(false), last_sync_size_(0),
-		  bytes_per_sync_(options.bytes_per_sync),
-		  rate_limiter_(options.rate_limiter), stats_(stats)
-	{
-		buf_.Alignment(writable_file_->GetRequiredBufferAlignment());
-		buf_.AllocateNewBuffer(
-			use_direct_io() ?
-				      max_buffer_size_ :
-				      std::min((size_t)65536, max_buffer_size_));
-	}
+			   Statistics *stats = nullptr);
 
 	WritableFileWriter(const WritableFileWriter &) = delete;
 
 	WritableFileWriter &operator=(const WritableFileWriter &) = delete;
 
-	~WritableFileWriter()
-	{
-		Close();
-	}
+	~WritableFileWriter();
 
 	Status Append(const Slice &data);
 
@@ -219,11 +207,20 @@ class WritableFileWriter {
 	// DMA such as in Direct I/O mode
 #ifndef ROCKSDB_LITE
 	Status WriteDirect();
+	// Write size bytes, a multiple of alignment, at offset. May be called
+	// from a thread of the pipeline pool, so it calls nothing but
+	// PositionedAppend() of the file.
+	Status WriteDirectAt(const char *src, size_t size, uint64_t offset,
+			     size_t alignment, Env::IOPriority io_priority);
 #endif // !ROCKSDB_LITE
+	// Called by Append() when the buffer has filled up
+	Status WriteFullBuffer();
 	// Normal write
 	Status WriteBuffered(const char *data, size_t size);
 	Status RangeSync(uint64_t offset, uint64_t nbytes);
-	size_t RequestToken(size_t bytes, bool align);
+	// alignment is 0 for buffered writes
+	size_t RequestToken(size_t bytes, size_t alignment,
+			    Env::IOPriority io_priority);
 	Status SyncInternal(bool use_fsync);
 };
 
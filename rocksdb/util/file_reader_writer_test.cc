@@ -6,6 +6,8 @@
 #include "util/file_reader_writer.h"
 #include <algorithm>
 #include <vector>
+#include "rocksdb/iostats_context.h"
+#include "rocksdb/perf_level.h"
 #include "util/random.h"
 #include "util/testharness.h"
 #include "util/testutil.h"
@@ -184,6 +186,157 @@ TEST_F(WritableFileWriterTest, AppendStatusReturn)
 	dynamic_cast<FakeWF *>(writer->writable_file())->SetIOError(true);
 	ASSERT_NOK(writer->Append(std::string(2 * kMb, 'b')));
 }
+
+TEST_F(WritableFileWriterTest, DirectIOMultipleBuffers)
+{
+	// Direct I/O file that keeps what was written in memory and checks
+	// that it's never called from two threads at once
+	class FakeWF : public WritableFile {
+	    public:
+		explicit FakeWF(std::string *contents)
+			: contents_(contents), io_error_(false), calls_(0),
+			  syncs_(0)
+		{
+		}
+
+		struct CallGuard {
+			explicit CallGuard(FakeWF *wf) : wf_(wf)
+			{
+				EXPECT_EQ(1, ++wf_->calls_);
+			}
+			~CallGuard()
+			{
+				--wf_->calls_;
+			}
+			FakeWF *wf_;
+		};
+
+		virtual bool use_direct_io() const override
+		{
+			return true;
+		}
+		Status Append(const Slice &data) override
+		{
+			return Status::NotSupported();
+		}
+		Status PositionedAppend(const Slice &data,
+					uint64_t offset) override
+		{
+			CallGuard guard(this);
+			if (io_error_) {
+				return Status::IOError("Fake IO error");
+			}
+			size_t alignment = GetRequiredBufferAlignment();
+			EXPECT_EQ(0U, offset % alignment);
+			EXPECT_EQ(0U, data.size() % alignment);
+			if (contents_->size() < offset + data.size()) {
+				contents_->resize(offset + data.size());
+			}
+			contents_->replace(offset, data.size(), data.data(),
+					   data.size());
+			return Status::OK();
+		}
+		void PrepareWrite(size_t offset, size_t len) override
+		{
+			CallGuard guard(this);
+		}
+		Status Truncate(uint64_t size) override
+		{
+			CallGuard guard(this);
+			contents_->resize(size);
+			return Status::OK();
+		}
+		Status Close() override
+		{
+			CallGuard guard(this);
+			return Status::OK();
+		}
+		Status Flush() override
+		{
+			CallGuard guard(this);
+			return Status::OK();
+		}
+		Status Sync() override
+		{
+			CallGuard guard(this);
+			syncs_++;
+			return Status::OK();
+		}
+
+		std::string *contents_;
+		std::atomic<bool> io_error_;
+		std::atomic<int> calls_;
+		int syncs_;
+	};
+
+	EnvOptions env_options;
+	env_options.writable_file_max_buffer_size = 64 << 10;
+	env_options.writable_file_direct_io_buffers = 3;
+
+	std::string contents;
+	FakeWF *wf = new FakeWF(&contents);
+	unique_ptr<WritableFileWriter> writer(new WritableFileWriter(
+		unique_ptr<WritableFile>(wf), env_options));
+	SetPerfLevel(PerfLevel::kEnableTime);
+	get_iostats_context()->Reset();
+	Random rnd(301);
+	std::string expected;
+	for (int i = 0; i < 200; i++) {
+		std::string chunk;
+		test::RandomString(&rnd, rnd.Uniform(20000), &chunk);
+		ASSERT_OK(writer->Append(chunk));
+		expected += chunk;
+		// Mix in partial-sector flushes like the WAL does
+		if (rnd.OneIn(10)) {
+			ASSERT_OK(writer->Flush());
+			ASSERT_EQ(expected,
+				  contents.substr(0, expected.size()));
+		}
+	}
+	ASSERT_OK(writer->Sync(false));
+	ASSERT_EQ(1, wf->syncs_);
+	ASSERT_OK(writer->Close());
+	ASSERT_EQ(expected, contents);
+	// Including the writes of the pool threads
+	ASSERT_GE(get_iostats_context()->bytes_written, expected.size());
+	ASSERT_GT(get_iostats_context()->write_nanos, 0U);
+	SetPerfLevel(PerfLevel::kEnableCount);
+
+	// Background write errors surface on a later call
+	wf = new FakeWF(&contents);
+	wf->io_error_ = true;
+	writer.reset(new WritableFileWriter(unique_ptr<WritableFile>(wf),
+					    env_options));
+	Status s = writer->Append(std::string(kMb, 'a'));
+	if (s.ok()) {
+		s = writer->Flush();
+	}
+	ASSERT_TRUE(s.IsIOError());
+	ASSERT_TRUE(writer->Close().IsIOError());
+
+	// More files than pool threads take turns in the pool
+	const int kNumFiles = 10;
+	std::string file_contents[kNumFiles];
+	std::string file_expected[kNumFiles];
+	std::vector<unique_ptr<WritableFileWriter> > writers;
+	for (int f = 0; f < kNumFiles; f++) {
+		writers.emplace_back(new WritableFileWriter(
+			unique_ptr<WritableFile>(new FakeWF(&file_contents[f])),
+			env_options));
+	}
+	for (int i = 0; i < 50; i++) {
+		for (int f = 0; f < kNumFiles; f++) {
+			std::string chunk;
+			test::RandomString(&rnd, rnd.Uniform(40000), &chunk);
+			ASSERT_OK(writers[f]->Append(chunk));
+			file_expected[f] += chunk;
+		}
+	}
+	for (int f = 0; f < kNumFiles; f++) {
+		ASSERT_OK(writers[f]->Close());
+		ASSERT_EQ(file_expected[f], file_contents[f]);
+	}
+}
 #endif
 
 class ReadaheadRandomAccessFileTest
@@ -70,6 +70,48 @@ Status CopyFile(Env *env, const std::string &source,
 	return Status::OK();
 }
 
+Status AppendFileTail(Env *env, const std::string &source,
+		      const std::string &destination, uint64_t offset,
+		      uint64_t size, bool use_fsync)
+{
+	assert(offset <= size);
+	const EnvOptions soptions;
+	unique_ptr<SequentialFile> srcfile;
+	Status s = env->NewSequentialFile(source, &srcfile, soptions);
+	if (s.ok()) {
+		s = srcfile->Skip(offset);
+	}
+	unique_ptr<WritableFile> destfile;
+	if (s.ok()) {
+		s = env->ReopenWritableFile(destination, &destfile, soptions);
+	}
+	if (!s.ok()) {
+		return s;
+	}
+	SequentialFileReader src_reader(std::move(srcfile));
+	WritableFileWriter dest_writer(std::move(destfile), soptions);
+
+	char buffer[4096];
+	Slice slice;
+	size -= offset;
+	while (size > 0) {
+		size_t bytes_to_read =
+			std::min(sizeof(buffer), static_cast<size_t>(size));
+		s = src_reader.Read(bytes_to_read, &slice, buffer);
+		if (s.ok() && slice.size() == 0) {
+			s = Status::Corruption("file too small");
+		}
+		if (s.ok()) {
+			s = dest_writer.Append(slice);
+		}
+		if (!s.ok()) {
+			return s;
+		}
+		size -= slice.size();
+	}
+	return dest_writer.Sync(use_fsync);
+}
+
 // Utility function to create a file with the provided contents
 Status CreateFile(Env *env, const std::string &destination,
 		  const std::string &contents)
@@ -92,10 +134,34 @@ Status DeleteSSTFile(const ImmutableDBOptions *db_options,
 		     const std::string &fname, uint32_t path_id)
 {
 	// TODO(tec): support sst_file_manager for multiple path_ids
+	return DeleteDBFile(db_options, fname, path_id == 0);
+}
+
+bool IsFirstDBPath(const ImmutableDBOptions *db_options,
+		   const std::string &dir)
+{
+	if (db_options->db_paths.empty()) {
+		return false;
+	}
+	// Either may have a trailing slash
+	Slice a(dir);
+	Slice b(db_options->db_paths[0].path);
+	while (a.size() > 1 && a[a.size() - 1] == '/') {
+		a.remove_suffix(1);
+	}
+	while (b.size() > 1 && b[b.size() - 1] == '/') {
+		b.remove_suffix(1);
+	}
+	return a == b;
+}
+
+Status DeleteDBFile(const ImmutableDBOptions *db_options,
+		    const std::string &fname, bool in_db_path)
+{
 #ifndef ROCKSDB_LITE
 	auto sfm = static_cast<SstFileManagerImpl *>(
 		db_options->sst_file_manager.get());
-	if (sfm && path_id == 0) {
+	if (sfm && in_db_path) {
 		return sfm->ScheduleFileDeletion(fname);
 	} else {
 		return db_options->env->DeleteFile(fname);
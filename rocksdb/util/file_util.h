@@ -19,10 +19,32 @@ extern Status CopyFile(Env *env, const std::string &source,
 		       const std::string &destination, uint64_t size,
 		       bool use_fsync);
 
+// Appends bytes [offset, size) of source to destination, which holds the
+// first offset bytes of source, to bring a copy of a file that has grown
+// since up to date.
+extern Status AppendFileTail(Env *env, const std::string &source,
+			     const std::string &destination, uint64_t offset,
+			     uint64_t size, bool use_fsync);
+
 extern Status CreateFile(Env *env, const std::string &destination,
 			 const std::string &contents);
 
 extern Status DeleteSSTFile(const ImmutableDBOptions *db_options,
 			    const std::string &fname, uint32_t path_id);
 
+// Delete any DB file (WAL, blob, options file, ...). The deletion goes
+// through db_options->sst_file_manager, and is therefore rate limited and
+// accounted for in its trash backlog, when there is one and in_db_path says
+// that fname lives next to the trash directory. Otherwise fname is deleted
+// right away.
+extern Status DeleteDBFile(const ImmutableDBOptions *db_options,
+			   const std::string &fname, bool in_db_path);
+
+// Whether dir is db_options->db_paths[0], the directory of the table files
+// that DeleteSSTFile() deletes through the SstFileManager, and so the
+// in_db_path of DeleteDBFile() for the files in dir, e.g. the WAL files in
+// db_options->wal_dir.
+extern bool IsFirstDBPath(const ImmutableDBOptions *db_options,
+			  const std::string &dir);
+
 } // namespace rocksdb
@@ -81,6 +81,12 @@ std::string BlobFileName(const std::string &blobdirname, uint64_t number)
 	return MakeFileName(blobdirname, number, kRocksDBBlobFileExt.c_str());
 }
 
+std::string WalPoolFileName(const std::string &wal_dir, uint64_t number)
+{
+	assert(number > 0);
+	return MakeFileName(wal_dir, number, "logpool");
+}
+
 std::string ArchivalDirectory(const std::string &dir)
 {
 	return dir + "/" + ARCHIVAL_DIR;
@@ -241,14 +247,20 @@ std::string IdentityFileName(const std::string &dbname)
 	return dbname + "/IDENTITY";
 }
 
+std::string TableMetaFileName(const std::string &dbname)
+{
+	return dbname + "/TABLEMETA";
+}
+
 // Owned filenames have the form:
 //    dbname/IDENTITY
+//    dbname/TABLEMETA
 //    dbname/CURRENT
 //    dbname/LOCK
 //    dbname/<info_log_name_prefix>
 //    dbname/<info_log_name_prefix>.old.[0-9]+
 //    dbname/MANIFEST-[0-9]+
-//    dbname/[0-9]+.(log|sst|blob)
+//    dbname/[0-9]+.(log|sst|blob|logpool)
 //    dbname/METADB-[0-9]+
 //    dbname/OPTIONS-[0-9]+
 //    dbname/OPTIONS-[0-9]+.dbtmp
@@ -270,6 +282,9 @@ bool ParseFileName(const std::string &fname, uint64_t *number,
 	if (rest == "IDENTITY") {
 		*number = 0;
 		*type = kIdentityFile;
+	} else if (rest == "TABLEMETA") {
+		*number = 0;
+		*type = kTableMetaFile;
 	} else if (rest == "CURRENT") {
 		*number = 0;
 		*type = kCurrentFile;
@@ -366,6 +381,8 @@ bool ParseFileName(const std::string &fname, uint64_t *number,
 			*type = kTableFile;
 		} else if (suffix == Slice(kRocksDBBlobFileExt)) {
 			*type = kBlobFile;
+		} else if (suffix == Slice("logpool")) {
+			*type = kWalPoolFile;
 		} else if (suffix == Slice(kTempFileNameSuffix)) {
 			*type = kTempFile;
 		} else {
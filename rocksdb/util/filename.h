@@ -39,7 +39,9 @@ enum FileType {
 	kMetaDatabase,
 	kIdentityFile,
 	kOptionsFile,
-	kBlobFile
+	kBlobFile,
+	kTableMetaFile,
+	kWalPoolFile
 };
 
 // Return the name of the log file with the specified number
@@ -49,6 +51,12 @@ extern std::string LogFileName(const std::string &dbname, uint64_t number);
 
 extern std::string BlobFileName(const std::string &bdirname, uint64_t number);
 
+// Return the name of a pre-allocated log file waiting in the WAL pool of the
+// db whose WAL directory is "wal_dir". The file is renamed to a log file
+// name when a memtable switch takes it.
+extern std::string WalPoolFileName(const std::string &wal_dir,
+				   uint64_t number);
+
 static const std::string ARCHIVAL_DIR = "archive";
 
 extern std::string ArchivalDirectory(const std::string &dbname);
@@ -141,6 +149,10 @@ extern std::string MetaDatabaseName(const std::string &dbname, uint64_t number);
 // either from a backup-image or empty
 extern std::string IdentityFileName(const std::string &dbname);
 
+// Return the name of the table metadata snapshot file for the db named by
+// "dbname". The result will be prefixed with "dbname".
+extern std::string TableMetaFileName(const std::string &dbname);
+
 // If filename is a rocksdb file, store the type of the file in *type.
 // The number encoded in the filename is stored in *number.  If the
 // filename was successfully parsed, returns true.  Else return false.
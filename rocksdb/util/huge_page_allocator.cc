@@ -0,0 +1,292 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#include "util/huge_page_allocator.h"
+
+#ifndef OS_WIN
+#include <sys/mman.h>
+#endif
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <new>
+
+#include "port/port.h"
+#include "util/coding.h"
+
+namespace rocksdb
+{
+#ifndef OS_WIN
+namespace
+{
+// Header layout: class index (fixed 32) at offset 0 and the address of
+// the slab at offset 8; for blocks with a mapping of their own the index
+// is kDedicated, followed by the hugetlb flag at offset 4 and the mapping
+// length (fixed 64) at offset 8.
+const uint32_t kDedicated = UINT32_MAX;
+
+size_t RoundUp(size_t n, size_t unit)
+{
+	return ((n + unit - 1) / unit) * unit;
+}
+
+// Size of class cls: 2^kMinClassShift, then kClassesPerDoubling evenly
+// spaced sizes up to each next power of two.
+size_t ClassSize(size_t cls)
+{
+	const size_t per_doubling =
+		HugePageMemoryAllocator::kClassesPerDoubling;
+	size_t base = size_t{ 1 }
+		      << (HugePageMemoryAllocator::kMinClassShift +
+			  cls / per_doubling);
+	return base + base / per_doubling * (cls % per_doubling);
+}
+
+// Number of classes from 2^kMinClassShift up to half a slab.
+size_t NumClasses(size_t slab_size)
+{
+	size_t n = 0;
+	while (ClassSize(n) <= slab_size / 2) {
+		n++;
+	}
+	return n;
+}
+
+char *HeaderOf(void *p)
+{
+	return reinterpret_cast<char *>(p) -
+	       HugePageMemoryAllocator::kHeaderSize;
+}
+} // namespace
+
+HugePageMemoryAllocator::Slab *HugePageMemoryAllocator::SlabOf(char *chunk)
+{
+	Slab *slab;
+	memcpy(&slab, chunk + 8, sizeof(slab));
+	return slab;
+}
+
+HugePageMemoryAllocator::HugePageMemoryAllocator(size_t huge_page_size,
+						 size_t slab_size)
+	: huge_page_size_(huge_page_size ? huge_page_size : 4096),
+	  slab_size_(RoundUp(slab_size ? slab_size : huge_page_size_,
+			     huge_page_size_)),
+	  classes_(NumClasses(slab_size_)), mapped_bytes_(0),
+	  hugetlb_bytes_(0)
+{
+	for (size_t i = 0; i < classes_.size(); i++) {
+		classes_[i].size = ClassSize(i);
+	}
+}
+
+HugePageMemoryAllocator::~HugePageMemoryAllocator()
+{
+	for (auto &sc : classes_) {
+		for (Slab *slab : sc.slabs) {
+			Unmap(slab->addr, slab->length, slab->hugetlb);
+			delete slab;
+		}
+	}
+}
+
+char *HugePageMemoryAllocator::Map(size_t size, bool *hugetlb)
+{
+	void *addr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+	addr = mmap(nullptr, size, (PROT_READ | PROT_WRITE),
+		    (MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB), -1, 0);
+#endif
+	*hugetlb = addr != MAP_FAILED;
+	if (addr == MAP_FAILED) {
+		// No reserved huge pages; let transparent huge pages back
+		// the mapping if the kernel allows it.
+		addr = mmap(nullptr, size, (PROT_READ | PROT_WRITE),
+			    (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+		if (addr == MAP_FAILED) {
+			throw std::bad_alloc();
+		}
+#ifdef MADV_HUGEPAGE
+		madvise(addr, size, MADV_HUGEPAGE);
+#endif
+	}
+	mapped_bytes_.fetch_add(size, std::memory_order_relaxed);
+	if (*hugetlb) {
+		hugetlb_bytes_.fetch_add(size, std::memory_order_relaxed);
+	}
+	return reinterpret_cast<char *>(addr);
+}
+
+void HugePageMemoryAllocator::Unmap(char *addr, size_t size, bool hugetlb)
+{
+	munmap(addr, size);
+	mapped_bytes_.fetch_sub(size, std::memory_order_relaxed);
+	if (hugetlb) {
+		hugetlb_bytes_.fetch_sub(size, std::memory_order_relaxed);
+	}
+}
+
+HugePageMemoryAllocator::Slab *
+HugePageMemoryAllocator::NewSlab(SizeClass *sc)
+{
+	bool hugetlb = false;
+	char *addr = Map(slab_size_, &hugetlb);
+	Slab *slab = new Slab();
+	slab->addr = addr;
+	slab->length = slab_size_;
+	slab->hugetlb = hugetlb;
+	slab->cursor = addr;
+	slab->remaining = slab_size_;
+	slab->index = sc->slabs.size();
+	sc->slabs.push_back(slab);
+	MakeAvailable(sc, slab);
+	return slab;
+}
+
+void HugePageMemoryAllocator::MakeAvailable(SizeClass *sc, Slab *slab)
+{
+	if (slab->available) {
+		return;
+	}
+	slab->available = true;
+	slab->prev = nullptr;
+	slab->next = sc->available;
+	if (sc->available != nullptr) {
+		sc->available->prev = slab;
+	}
+	sc->available = slab;
+}
+
+void HugePageMemoryAllocator::MakeUnavailable(SizeClass *sc, Slab *slab)
+{
+	if (!slab->available) {
+		return;
+	}
+	slab->available = false;
+	if (slab->prev != nullptr) {
+		slab->prev->next = slab->next;
+	} else {
+		sc->available = slab->next;
+	}
+	if (slab->next != nullptr) {
+		slab->next->prev = slab->prev;
+	}
+	slab->prev = slab->next = nullptr;
+}
+
+void HugePageMemoryAllocator::MaybeReleaseSlab(SizeClass *sc, Slab *slab)
+{
+	assert(slab->live_blocks == 0 && slab->available);
+	if (sc->available == slab && slab->next == nullptr) {
+		// Kept for the next block of the class
+		return;
+	}
+	MakeUnavailable(sc, slab);
+	Slab *last = sc->slabs.back();
+	last->index = slab->index;
+	sc->slabs[slab->index] = last;
+	sc->slabs.pop_back();
+	Unmap(slab->addr, slab->length, slab->hugetlb);
+	delete slab;
+}
+
+void *HugePageMemoryAllocator::Allocate(size_t size)
+{
+	size_t total = size + kHeaderSize;
+	uint32_t cls = 0;
+	while (cls < classes_.size() && classes_[cls].size < total) {
+		cls++;
+	}
+
+	char *chunk = nullptr;
+	if (cls == classes_.size()) {
+		bool hugetlb = false;
+		size_t length = RoundUp(total, huge_page_size_);
+		chunk = Map(length, &hugetlb);
+		EncodeFixed32(chunk, kDedicated);
+		chunk[4] = hugetlb ? 1 : 0;
+		EncodeFixed64(chunk + 8, length);
+		return chunk + kHeaderSize;
+	}
+
+	SizeClass &sc = classes_[cls];
+	std::lock_guard<std::mutex> lock(sc.mu);
+	Slab *slab = sc.available;
+	if (slab == nullptr) {
+		slab = NewSlab(&sc);
+	}
+	if (slab->free_list != nullptr) {
+		// The header of a free chunk is intact
+		chunk = reinterpret_cast<char *>(slab->free_list) - kHeaderSize;
+		slab->free_list = slab->free_list->next;
+	} else {
+		assert(slab->remaining >= sc.size);
+		chunk = slab->cursor;
+		slab->cursor += sc.size;
+		slab->remaining -= sc.size;
+		EncodeFixed32(chunk, cls);
+		memcpy(chunk + 8, &slab, sizeof(slab));
+	}
+	slab->live_blocks++;
+	if (slab->free_list == nullptr && slab->remaining < sc.size) {
+		// The tail too small for a block is left unused
+		MakeUnavailable(&sc, slab);
+	}
+	return chunk + kHeaderSize;
+}
+
+void HugePageMemoryAllocator::Deallocate(void *p)
+{
+	if (p == nullptr) {
+		return;
+	}
+	char *chunk = HeaderOf(p);
+	uint32_t cls = DecodeFixed32(chunk);
+	if (cls == kDedicated) {
+		Unmap(chunk, DecodeFixed64(chunk + 8), chunk[4] != 0);
+		return;
+	}
+	assert(cls < classes_.size());
+	SizeClass &sc = classes_[cls];
+	Slab *slab = SlabOf(chunk);
+	// The free list link goes after the header, which keeps the class
+	// and slab of the chunk
+	FreeChunk *free_chunk =
+		reinterpret_cast<FreeChunk *>(chunk + kHeaderSize);
+	std::lock_guard<std::mutex> lock(sc.mu);
+	free_chunk->next = slab->free_list;
+	slab->free_list = free_chunk;
+	MakeAvailable(&sc, slab);
+	if (--slab->live_blocks == 0) {
+		MaybeReleaseSlab(&sc, slab);
+	}
+}
+
+size_t HugePageMemoryAllocator::UsableSize(void *p,
+					   size_t /*allocation_size*/) const
+{
+	char *chunk = HeaderOf(p);
+	uint32_t cls = DecodeFixed32(chunk);
+	if (cls == kDedicated) {
+		return DecodeFixed64(chunk + 8);
+	}
+	return classes_[cls].size;
+}
+
+std::shared_ptr<MemoryAllocator>
+NewHugePageMemoryAllocator(size_t huge_page_size, size_t slab_size)
+{
+	return std::make_shared<HugePageMemoryAllocator>(huge_page_size,
+							 slab_size);
+}
+
+#else // OS_WIN
+
+std::shared_ptr<MemoryAllocator> NewHugePageMemoryAllocator(size_t, size_t)
+{
+	return nullptr;
+}
+
+#endif // OS_WIN
+} // namespace rocksdb
@@ -0,0 +1,115 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#pragma once
+#ifndef OS_WIN
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "rocksdb/memory_allocator.h"
+
+namespace rocksdb
+{
+// Slab allocator backed by huge pages, see NewHugePageMemoryAllocator().
+//
+// Every block is preceded by a kHeaderSize header recording its size class
+// and slab (or, for blocks with a mapping of their own, the mapping
+// length), so Deallocate() and UsableSize() need nothing but the pointer.
+// Each slab holds blocks of one size class and keeps its own free list and
+// count of blocks in use, under the mutex of its class, so readers of
+// different block sizes do not contend. A small block comes from the
+// first slab of its class with a free block or uncarved room. A slab none
+// of whose blocks are in use is unmapped right away, in O(1), unless it is
+// the only one of its class with room left.
+class HugePageMemoryAllocator : public MemoryAllocator {
+    public:
+	static const size_t kHeaderSize = 16;
+	static const size_t kMinClassShift = 6;
+	// Size classes between two powers of two, so that a block is rounded
+	// up by at most a quarter of its size
+	static const size_t kClassesPerDoubling = 4;
+
+	HugePageMemoryAllocator(size_t huge_page_size, size_t slab_size);
+	~HugePageMemoryAllocator();
+
+	virtual const char *Name() const override
+	{
+		return "HugePageMemoryAllocator";
+	}
+	virtual void *Allocate(size_t size) override;
+	virtual void Deallocate(void *p) override;
+	virtual size_t UsableSize(void *p,
+				  size_t allocation_size) const override;
+
+	// Bytes currently mapped, slabs and dedicated mappings together.
+	size_t GetMappedBytes() const
+	{
+		return mapped_bytes_.load(std::memory_order_relaxed);
+	}
+	// The part of GetMappedBytes() that got explicit huge pages.
+	size_t GetHugeTlbBytes() const
+	{
+		return hugetlb_bytes_.load(std::memory_order_relaxed);
+	}
+
+    private:
+	struct FreeChunk {
+		FreeChunk *next;
+	};
+	// The members but addr, length and hugetlb are protected by the
+	// mutex of the slab's class.
+	struct Slab {
+		char *addr;
+		size_t length;
+		bool hugetlb;
+		FreeChunk *free_list = nullptr;
+		// The part not carved into blocks yet
+		char *cursor;
+		size_t remaining;
+		size_t live_blocks = 0;
+		// Position in SizeClass::slabs
+		size_t index;
+		// Links in SizeClass::available while on it
+		bool available = false;
+		Slab *prev = nullptr;
+		Slab *next = nullptr;
+	};
+	struct SizeClass {
+		size_t size = 0;
+		std::mutex mu;
+		// Slabs with a free block or room for one
+		Slab *available = nullptr;
+		// Every slab of the class, unmapped in the dtor
+		std::vector<Slab *> slabs;
+	};
+
+	// Map `size` bytes, trying MAP_HUGETLB first. Sets *hugetlb to
+	// whether explicit huge pages were used.
+	char *Map(size_t size, bool *hugetlb);
+	void Unmap(char *addr, size_t size, bool hugetlb);
+	static Slab *SlabOf(char *chunk);
+	// Map a new slab for sc and make it available. REQUIRES: sc.mu held.
+	Slab *NewSlab(SizeClass *sc);
+	// REQUIRES: sc.mu held for these two.
+	static void MakeAvailable(SizeClass *sc, Slab *slab);
+	static void MakeUnavailable(SizeClass *sc, Slab *slab);
+	// Unmaps slab, none of whose blocks is in use, unless it is the last
+	// one of sc with room. REQUIRES: sc.mu held.
+	void MaybeReleaseSlab(SizeClass *sc, Slab *slab);
+
+	const size_t huge_page_size_;
+	const size_t slab_size_;
+	// Classes 2^kMinClassShift .. slab_size_ / 2, kClassesPerDoubling
+	// per power of two.
+	std::vector<SizeClass> classes_;
+
+	std::atomic<size_t> mapped_bytes_;
+	std::atomic<size_t> hugetlb_bytes_;
+};
+
+} // namespace rocksdb
+#endif // !OS_WIN
@@ -0,0 +1,181 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef OS_WIN
+
+#include "util/huge_page_allocator.h"
+
+#include <string.h>
+#include <vector>
+
+#include "rocksdb/memory_allocator.h"
+#include "util/random.h"
+#include "util/testharness.h"
+
+namespace rocksdb
+{
+namespace
+{
+// Small pages keep the slabs small; the allocator does not care whether
+// the size is a real huge page size, the MAP_HUGETLB attempt simply fails
+// and the slab falls back to a regular mapping.
+const size_t kPageSize = 64 * 1024;
+} // namespace
+
+class HugePageMemoryAllocatorTest : public testing::Test {
+};
+
+TEST_F(HugePageMemoryAllocatorTest, SizeClasses)
+{
+	HugePageMemoryAllocator allocator(kPageSize, 0);
+	ASSERT_EQ(0U, allocator.GetMappedBytes());
+
+	void *p = allocator.Allocate(1);
+	ASSERT_EQ(64U, allocator.UsableSize(p, 1));
+	void *q = allocator.Allocate(4096);
+	// The header pushes a 4KB block into the 5KB class, not the 8KB one
+	ASSERT_EQ(5120U, allocator.UsableSize(q, 4096));
+	// A slab per class
+	ASSERT_EQ(2 * kPageSize, allocator.GetMappedBytes());
+	ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(p) % 16);
+	ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(q) % 16);
+	memset(p, 'a', 1);
+	memset(q, 'b', 4096);
+
+	// A freed block is recycled by the next allocation of its class
+	allocator.Deallocate(q);
+	void *r = allocator.Allocate(5000);
+	ASSERT_EQ(q, r);
+	void *s = allocator.Allocate(5200);
+	ASSERT_EQ(6144U, allocator.UsableSize(s, 5200));
+	allocator.Deallocate(s);
+	allocator.Deallocate(r);
+	allocator.Deallocate(p);
+	// Each class keeps its last slab for its next block
+	ASSERT_EQ(3 * kPageSize, allocator.GetMappedBytes());
+}
+
+TEST_F(HugePageMemoryAllocatorTest, ReleaseUnusedSlabs)
+{
+	HugePageMemoryAllocator allocator(kPageSize, 0);
+	// Fill three slabs and a bit
+	std::vector<void *> blocks;
+	const size_t kBlockSize = 1000;
+	while (allocator.GetMappedBytes() < 4 * kPageSize) {
+		blocks.push_back(allocator.Allocate(kBlockSize));
+	}
+	ASSERT_EQ(4 * kPageSize, allocator.GetMappedBytes());
+	// A slab with a block in use stays mapped
+	void *kept = blocks.front();
+	for (size_t i = 1; i < blocks.size(); i++) {
+		allocator.Deallocate(blocks[i]);
+	}
+	// Only the first slab is left, the one still carved from included
+	ASSERT_EQ(kPageSize, allocator.GetMappedBytes());
+	// Its free blocks are recycled, not those of released slabs
+	void *p = allocator.Allocate(kBlockSize);
+	memset(p, 'p', kBlockSize);
+	allocator.Deallocate(p);
+	// The last slab of the class stays mapped even when unused
+	allocator.Deallocate(kept);
+	ASSERT_EQ(kPageSize, allocator.GetMappedBytes());
+}
+
+TEST_F(HugePageMemoryAllocatorTest, SlabsOfOneClass)
+{
+	HugePageMemoryAllocator allocator(kPageSize, 0);
+	std::vector<char *> small;
+	std::vector<char *> large;
+	while (allocator.GetMappedBytes() < 6 * kPageSize) {
+		small.push_back(
+			reinterpret_cast<char *>(allocator.Allocate(40)));
+		memset(small.back(), 's', 40);
+		large.push_back(
+			reinterpret_cast<char *>(allocator.Allocate(900)));
+		memset(large.back(), 'l', 900);
+	}
+	// Releasing the slabs of one class leaves the other's blocks alone
+	for (char *p : small) {
+		allocator.Deallocate(p);
+	}
+	const size_t large_slabs =
+		(large.size() * 1024 + kPageSize - 1) / kPageSize;
+	ASSERT_EQ((large_slabs + 1) * kPageSize, allocator.GetMappedBytes());
+	for (char *p : large) {
+		ASSERT_EQ('l', p[0]);
+		ASSERT_EQ('l', p[899]);
+		allocator.Deallocate(p);
+	}
+	ASSERT_EQ(2 * kPageSize, allocator.GetMappedBytes());
+}
+
+TEST_F(HugePageMemoryAllocatorTest, DedicatedMapping)
+{
+	HugePageMemoryAllocator allocator(kPageSize, 0);
+	// More than half a slab gets a mapping of its own
+	const size_t kBytes = kPageSize / 2 + 1;
+	void *p = allocator.Allocate(kBytes);
+	ASSERT_EQ(kPageSize, allocator.UsableSize(p, kBytes));
+	ASSERT_EQ(kPageSize, allocator.GetMappedBytes());
+	memset(p, 'x', kBytes);
+	allocator.Deallocate(p);
+	ASSERT_EQ(0U, allocator.GetMappedBytes());
+}
+
+TEST_F(HugePageMemoryAllocatorTest, ManyBlocks)
+{
+	HugePageMemoryAllocator allocator(kPageSize, 4 * kPageSize);
+	Random rnd(301);
+	std::vector<std::pair<char *, size_t> > blocks;
+	for (int i = 0; i < 2000; i++) {
+		size_t size = 1 + rnd.Uniform(20000);
+		char *p = reinterpret_cast<char *>(allocator.Allocate(size));
+		memset(p, static_cast<char>(i), size);
+		blocks.emplace_back(p, size);
+		if (rnd.OneIn(3)) {
+			size_t victim = rnd.Uniform(static_cast<int>(
+				blocks.size()));
+			allocator.Deallocate(blocks[victim].first);
+			blocks.erase(blocks.begin() + victim);
+		}
+	}
+	for (auto &block : blocks) {
+		ASSERT_GE(allocator.UsableSize(block.first, block.second),
+			  block.second + HugePageMemoryAllocator::kHeaderSize);
+		allocator.Deallocate(block.first);
+	}
+	ASSERT_EQ(0U, allocator.GetMappedBytes() % (4 * kPageSize));
+}
+
+TEST_F(HugePageMemoryAllocatorTest, CacheAllocationPtr)
+{
+	auto allocator = NewHugePageMemoryAllocator(kPageSize);
+	ASSERT_TRUE(allocator != nullptr);
+	{
+		CacheAllocationPtr block = AllocateBlock(100, allocator.get());
+		ASSERT_EQ(allocator.get(), block.get_deleter().allocator);
+		ASSERT_EQ(128U, allocator->UsableSize(block.get(), 100));
+	}
+	CacheAllocationPtr heap_block = AllocateBlock(100, nullptr);
+	ASSERT_TRUE(heap_block.get_deleter().allocator == nullptr);
+}
+} // namespace rocksdb
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int argc, char **argv)
+{
+	fprintf(stderr,
+		"SKIPPED as HugePageMemoryAllocator is not supported on Windows\n");
+	return 0;
+}
+#endif // !OS_WIN
@@ -27,9 +27,26 @@ struct GenericRateLimiter::Req {
 	bool granted;
 };
 
+namespace
+{
+// Tune once every kRefillsPerTune refill periods
+const int64_t kRefillsPerTune = 10;
+// Default span of the auto-tuned range when no lower bound is given
+const int64_t kAllowedRangeFactor = 20;
+// Drain ratios below / above which the budget is considered too large / small
+const int64_t kLowWatermarkPct = 50;
+const int64_t kHighWatermarkPct = 90;
+// Compaction pressure below which background work is considered idle
+const int64_t kIdlePressurePct = 25;
+// Step sizes of a single tune
+const int64_t kAdjustFactorPct = 5;
+const int64_t kCatchUpFactorPct = 20;
+} // namespace
+
 GenericRateLimiter::GenericRateLimiter(int64_t rate_bytes_per_sec,
 				       int64_t refill_period_us,
-				       int32_t fairness)
+				       int32_t fairness, bool auto_tuned,
+				       int64_t min_rate_bytes_per_sec)
 	: refill_period_us_(refill_period_us),
 	  rate_bytes_per_sec_(rate_bytes_per_sec),
 	  refill_bytes_per_period_(
@@ -38,7 +55,18 @@ GenericRateLimiter::GenericRateLimiter(int64_t rate_bytes_per_sec,
 	  requests_to_wait_(0), available_bytes_(0),
 	  next_refill_us_(NowMicrosMonotonic(env_)),
 	  fairness_(fairness > 100 ? 100 : fairness),
-	  rnd_((uint32_t)time(nullptr)), leader_(nullptr)
+	  rnd_((uint32_t)time(nullptr)), leader_(nullptr),
+	  auto_tuned_(auto_tuned),
+	  min_rate_bytes_per_sec_(
+		  min_rate_bytes_per_sec > 0 ?
+			  std::min(min_rate_bytes_per_sec,
+				   rate_bytes_per_sec) :
+			  std::max<int64_t>(rate_bytes_per_sec /
+						    kAllowedRangeFactor,
+					    1)),
+	  max_rate_bytes_per_sec_(rate_bytes_per_sec), num_drains_(0),
+	  tuned_time_us_(NowMicrosMonotonic(env_)),
+	  compaction_pressure_pct_(-1)
 {
 	total_requests_[0] = 0;
 	total_requests_[1] = 0;
@@ -86,6 +114,12 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
 		return;
 	}
 
+	if (auto_tuned_ &&
+	    NowMicrosMonotonic(env_) >=
+		    tuned_time_us_ + kRefillsPerTune * refill_period_us_) {
+		Tune(stats);
+	}
+
 	++total_requests_[pri];
 
 	if (available_bytes_ >= bytes) {
@@ -123,6 +157,7 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
 			} else {
 				int64_t wait_until = env_->NowMicros() + delta;
 				RecordTick(stats, NUMBER_RATE_LIMITER_DRAINS);
+				++num_drains_;
 				timedout = r.cv.TimedWait(wait_until);
 			}
 		} else {
@@ -237,6 +272,48 @@ void GenericRateLimiter::Refill()
 	}
 }
 
+// Control loop of the auto-tuned mode. Raise the rate when compactions are
+// about to stall writes, or when they keep exhausting the budget while there
+// is a backlog. Lower it when the budget goes unused or there is no backlog,
+// so that background I/O gets out of the way of foreground requests.
+void GenericRateLimiter::Tune(Statistics *stats)
+{
+	request_mutex_.AssertHeld();
+	uint64_t now = NowMicrosMonotonic(env_);
+	int64_t elapsed_refills = std::max<int64_t>(
+		1, static_cast<int64_t>(now - tuned_time_us_) /
+			   refill_period_us_);
+	int64_t drained_pct = num_drains_ * 100 / elapsed_refills;
+	int64_t pressure_pct =
+		compaction_pressure_pct_.load(std::memory_order_relaxed);
+	bool falling_behind = pressure_pct >= 100;
+	bool idle = pressure_pct >= 0 && pressure_pct < kIdlePressurePct;
+
+	int64_t prev_rate = rate_bytes_per_sec_;
+	double factor = 1.0;
+	if (falling_behind) {
+		factor = (100 + kCatchUpFactorPct) / 100.0;
+	} else if (drained_pct > kHighWatermarkPct && !idle) {
+		factor = (100 + kAdjustFactorPct) / 100.0;
+	} else if (drained_pct < kLowWatermarkPct || idle) {
+		factor = 100.0 / (100 + kAdjustFactorPct);
+	}
+	// Compare in floating point so that the result cannot overflow
+	double target = static_cast<double>(prev_rate) * factor;
+	int64_t new_rate = target >= max_rate_bytes_per_sec_ ?
+				   max_rate_bytes_per_sec_ :
+				   std::max(min_rate_bytes_per_sec_,
+					    static_cast<int64_t>(target));
+	if (new_rate != prev_rate) {
+		SetBytesPerSecond(new_rate);
+	}
+	MeasureTime(stats, RATE_LIMITER_BYTES_PER_SEC,
+		    static_cast<uint64_t>(new_rate));
+
+	num_drains_ = 0;
+	tuned_time_us_ = now;
+}
+
 int64_t
 GenericRateLimiter::CalculateRefillBytesPerPeriod(int64_t rate_bytes_per_sec)
 {
@@ -252,13 +329,17 @@ GenericRateLimiter::CalculateRefillBytesPerPeriod(int64_t rate_bytes_per_sec)
 }
 
 RateLimiter *NewGenericRateLimiter(int64_t rate_bytes_per_sec,
-				   int64_t refill_period_us, int32_t fairness)
+				   int64_t refill_period_us, int32_t fairness,
+				   bool auto_tuned,
+				   int64_t min_rate_bytes_per_sec)
 {
 	assert(rate_bytes_per_sec > 0);
 	assert(refill_period_us > 0);
 	assert(fairness > 0);
+	assert(min_rate_bytes_per_sec >= 0);
 	return new GenericRateLimiter(rate_bytes_per_sec, refill_period_us,
-				      fairness);
+				      fairness, auto_tuned,
+				      min_rate_bytes_per_sec);
 }
 
 } // namespace rocksdb
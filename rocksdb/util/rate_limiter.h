@@ -23,7 +23,8 @@ namespace rocksdb
 class GenericRateLimiter : public RateLimiter {
     public:
 	GenericRateLimiter(int64_t refill_bytes, int64_t refill_period_us,
-			   int32_t fairness);
+			   int32_t fairness, bool auto_tuned = false,
+			   int64_t min_rate_bytes_per_sec = 0);
 
 	virtual ~GenericRateLimiter();
 
@@ -69,8 +70,18 @@ class GenericRateLimiter : public RateLimiter {
 		return rate_bytes_per_sec_;
 	}
 
+	virtual void SetCompactionPressure(double pressure) override
+	{
+		// Anything past "stalled" is treated the same
+		pressure = std::max(0.0, std::min(pressure, 10.0));
+		compaction_pressure_pct_.store(
+			static_cast<int64_t>(pressure * 100),
+			std::memory_order_relaxed);
+	}
+
     private:
 	void Refill();
+	void Tune(Statistics *stats);
 	int64_t CalculateRefillBytesPerPeriod(int64_t rate_bytes_per_sec);
 	uint64_t NowMicrosMonotonic(Env *env)
 	{
@@ -104,6 +115,16 @@ class GenericRateLimiter : public RateLimiter {
 	struct Req;
 	Req *leader_;
 	std::deque<Req *> queue_[Env::IO_TOTAL];
+
+	// Auto-tuning state
+	const bool auto_tuned_;
+	const int64_t min_rate_bytes_per_sec_;
+	const int64_t max_rate_bytes_per_sec_;
+	// Number of refill periods that ran out of quota since the last tune
+	int64_t num_drains_;
+	uint64_t tuned_time_us_;
+	// Latest SetCompactionPressure() * 100, -1 if never reported
+	std::atomic<int64_t> compaction_pressure_pct_;
 };
 
 } // namespace rocksdb
@@ -15,6 +15,7 @@
 #include <inttypes.h>
 #include <limits>
 #include "rocksdb/env.h"
+#include "rocksdb/statistics.h"
 #include "util/random.h"
 #include "util/sync_point.h"
 #include "util/testharness.h"
@@ -107,6 +108,43 @@ TEST_F(RateLimiterTest, Rate)
 	}
 }
 
+TEST_F(RateLimiterTest, AutoTuned)
+{
+	const int64_t kMaxRate = 10 << 20; // 10MB/s
+	const int64_t kMinRate = 1 << 20; // 1MB/s
+	const int64_t kRefillPeriodUs = 1000;
+	GenericRateLimiter limiter(kMaxRate, kRefillPeriodUs, 10,
+				   true /* auto_tuned */, kMinRate);
+	auto stats = CreateDBStatistics();
+	auto *env = Env::Default();
+	auto request_until = [&](std::function<bool()> done) {
+		uint64_t deadline = env->NowMicros() + 10 * 1000 * 1000;
+		while (!done() && env->NowMicros() < deadline) {
+			limiter.Request(limiter.GetSingleBurstBytes(),
+					Env::IO_LOW, stats.get());
+		}
+	};
+
+	// Without a backlog the rate backs off to the lower bound even though
+	// requests keep draining it.
+	limiter.SetCompactionPressure(0.0);
+	request_until(
+		[&]() { return limiter.GetBytesPerSecond() <= kMinRate; });
+	ASSERT_EQ(kMinRate, limiter.GetBytesPerSecond());
+	HistogramData rates;
+	stats->histogramData(RATE_LIMITER_BYTES_PER_SEC, &rates);
+	ASSERT_GT(rates.count, 0U);
+	ASSERT_LT(rates.max, kMaxRate);
+
+	// Writes about to stall: climb back to the upper bound
+	limiter.SetCompactionPressure(1.5);
+	request_until(
+		[&]() { return limiter.GetBytesPerSecond() >= kMaxRate; });
+	ASSERT_EQ(kMaxRate, limiter.GetBytesPerSecond());
+	stats->histogramData(RATE_LIMITER_BYTES_PER_SEC, &rates);
+	ASSERT_EQ(kMaxRate, rates.max);
+}
+
 TEST_F(RateLimiterTest, LimitChangeTest)
 {
 	// starvation test when limit changes to a smaller value
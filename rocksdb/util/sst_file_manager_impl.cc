@@ -18,11 +18,12 @@ namespace rocksdb
 #ifndef ROCKSDB_LITE
 SstFileManagerImpl::SstFileManagerImpl(Env *env, std::shared_ptr<Logger> logger,
 				       const std::string &trash_dir,
-				       int64_t rate_bytes_per_sec)
+				       int64_t rate_bytes_per_sec,
+				       uint64_t bytes_max_delete_chunk)
 	: env_(env), logger_(logger), total_files_size_(0),
 	  max_allowed_space_(0),
 	  delete_scheduler_(env, trash_dir, rate_bytes_per_sec, logger.get(),
-			    this)
+			    this, bytes_max_delete_chunk)
 {
 }
 
@@ -57,8 +58,11 @@ Status SstFileManagerImpl::OnMoveFile(const std::string &old_path,
 {
 	{
 		MutexLock l(&mu_);
-		OnAddFileImpl(new_path, tracked_files_[old_path]);
-		OnDeleteFileImpl(old_path);
+		auto tracked_file = tracked_files_.find(old_path);
+		if (tracked_file != tracked_files_.end()) {
+			OnAddFileImpl(new_path, tracked_file->second);
+			OnDeleteFileImpl(old_path);
+		}
 	}
 	TEST_SYNC_POINT("SstFileManagerImpl::OnMoveFile");
 	return Status::OK();
@@ -101,6 +105,11 @@ void SstFileManagerImpl::SetDeleteRateBytesPerSecond(int64_t delete_rate)
 	return delete_scheduler_.SetRateBytesPerSecond(delete_rate);
 }
 
+uint64_t SstFileManagerImpl::GetDeleteBacklogBytes()
+{
+	return delete_scheduler_.GetBacklogBytes();
+}
+
 Status SstFileManagerImpl::ScheduleFileDeletion(const std::string &file_path)
 {
 	return delete_scheduler_.DeleteFile(file_path);
@@ -140,10 +149,12 @@ void SstFileManagerImpl::OnDeleteFileImpl(const std::string &file_path)
 SstFileManager *NewSstFileManager(Env *env, std::shared_ptr<Logger> info_log,
 				  std::string trash_dir,
 				  int64_t rate_bytes_per_sec,
-				  bool delete_existing_trash, Status *status)
+				  bool delete_existing_trash, Status *status,
+				  uint64_t bytes_max_delete_chunk)
 {
 	SstFileManagerImpl *res = new SstFileManagerImpl(
-		env, info_log, trash_dir, rate_bytes_per_sec);
+		env, info_log, trash_dir, rate_bytes_per_sec,
+		bytes_max_delete_chunk);
 
 	Status s;
 	if (trash_dir != "") {
@@ -185,7 +196,8 @@ SstFileManager *NewSstFileManager(Env *env, std::shared_ptr<Logger> info_log,
 SstFileManager *NewSstFileManager(Env *env, std::shared_ptr<Logger> info_log,
 				  std::string trash_dir,
 				  int64_t rate_bytes_per_sec,
-				  bool delete_existing_trash, Status *status)
+				  bool delete_existing_trash, Status *status,
+				  uint64_t bytes_max_delete_chunk)
 {
 	if (status) {
 		*status = Status::NotSupported(
@@ -26,7 +26,8 @@ class SstFileManagerImpl : public SstFileManager {
     public:
 	explicit SstFileManagerImpl(Env *env, std::shared_ptr<Logger> logger,
 				    const std::string &trash_dir,
-				    int64_t rate_bytes_per_sec);
+				    int64_t rate_bytes_per_sec,
+				    uint64_t bytes_max_delete_chunk = 0);
 
 	~SstFileManagerImpl();
 
@@ -37,6 +38,7 @@ class SstFileManagerImpl : public SstFileManager {
 	Status OnDeleteFile(const std::string &file_path);
 
 	// DB will call OnMoveFile whenever an sst file is move to a new path.
+	// Moving a file that is not tracked is a no-op.
 	Status OnMoveFile(const std::string &old_path,
 			  const std::string &new_path);
 
@@ -68,6 +70,9 @@ class SstFileManagerImpl : public SstFileManager {
 	// Update the delete rate limit in bytes per second.
 	virtual void SetDeleteRateBytesPerSecond(int64_t delete_rate) override;
 
+	// Return the number of bytes in trash waiting to be deleted.
+	virtual uint64_t GetDeleteBacklogBytes() override;
+
 	// Move file to trash directory and schedule it's deletion.
 	virtual Status ScheduleFileDeletion(const std::string &file_path);
 
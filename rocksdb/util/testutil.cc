@@ -293,6 +293,11 @@ void RandomInitDBOptions(DBOptions *db_opt, Random *rnd)
 	db_opt->recycle_log_file_num = rnd->Uniform(2);
 	db_opt->avoid_flush_during_recovery = rnd->Uniform(2);
 	db_opt->avoid_flush_during_shutdown = rnd->Uniform(2);
+	db_opt->stats_persist_period_sec = rnd->Uniform(2) * 3600;
+	db_opt->wal_pool_size = rnd->Uniform(4);
+	db_opt->numa_aware = rnd->Uniform(2);
+	db_opt->use_direct_io_for_wal = rnd->Uniform(2);
+	db_opt->persist_table_meta_snapshot = rnd->Uniform(2);
 
 	// int options
 	db_opt->max_background_compactions = rnd->Uniform(100);
@@ -307,6 +312,7 @@ void RandomInitDBOptions(DBOptions *db_opt, Random *rnd)
 	db_opt->log_file_time_to_roll = rnd->Uniform(10000);
 	db_opt->manifest_preallocation_size = rnd->Uniform(10000);
 	db_opt->max_log_file_size = rnd->Uniform(10000);
+	db_opt->writable_file_direct_io_buffers = rnd->Uniform(10000);
 
 	// std::string options
 	db_opt->db_log_dir = "path/to/db_log_dir";
@@ -324,6 +330,9 @@ void RandomInitDBOptions(DBOptions *db_opt, Random *rnd)
 	db_opt->delete_obsolete_files_period_micros =
 		uint_max + rnd->Uniform(100000);
 	db_opt->max_manifest_file_size = uint_max + rnd->Uniform(100000);
+	db_opt->max_manifest_space_amp_pct = rnd->Uniform(1000);
+	db_opt->min_manifest_file_size_for_space_amp =
+		uint_max + rnd->Uniform(100000);
 	db_opt->max_total_wal_size = uint_max + rnd->Uniform(100000);
 	db_opt->wal_bytes_per_sync = uint_max + rnd->Uniform(100000);
 
@@ -377,6 +386,7 @@ void RandomInitCFOptions(ColumnFamilyOptions *cf_opt, Random *rnd)
 	cf_opt->max_successive_merges = rnd->Uniform(10000);
 	cf_opt->memtable_huge_page_size = rnd->Uniform(10000);
 	cf_opt->write_buffer_size = rnd->Uniform(10000);
+	cf_opt->compaction_stats_key_prefix_length = rnd->Uniform(16);
 
 	// uint32_t options
 	cf_opt->bloom_locality = rnd->Uniform(10000);
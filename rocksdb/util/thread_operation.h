@@ -38,7 +38,10 @@ struct OperationInfo {
 static OperationInfo global_operation_table[] = {
 	{ ThreadStatus::OP_UNKNOWN, "" },
 	{ ThreadStatus::OP_COMPACTION, "Compaction" },
-	{ ThreadStatus::OP_FLUSH, "Flush" }
+	{ ThreadStatus::OP_FLUSH, "Flush" },
+	{ ThreadStatus::OP_GET, "Get" },
+	{ ThreadStatus::OP_WRITE, "Write" },
+	{ ThreadStatus::OP_LOCK, "TransactionLock" },
 };
 
 struct OperationStageInfo {
@@ -82,6 +85,11 @@ struct StateInfo {
 static StateInfo global_state_table[] = {
 	{ ThreadStatus::STATE_UNKNOWN, "" },
 	{ ThreadStatus::STATE_MUTEX_WAIT, "Mutex Wait" },
+	{ ThreadStatus::STATE_WRITE_GROUP_WAIT, "Write Group Wait" },
+	{ ThreadStatus::STATE_WAL_SYNC, "WAL Sync" },
+	{ ThreadStatus::STATE_WRITE_STALL, "Write Stall" },
+	{ ThreadStatus::STATE_LOCK_WAIT, "Lock Wait" },
+	{ ThreadStatus::STATE_BLOCK_READ, "Block Read" },
 };
 
 struct OperationProperty {
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <stdlib.h>
@@ -54,6 +55,8 @@ struct ThreadPoolImpl::Impl {
 
 	void LowerIOPriority();
 
+	void BindToNumaNodes();
+
 	void WakeUpAllThreads()
 	{
 		bgsignal_.notify_all();
@@ -64,10 +67,36 @@ struct ThreadPoolImpl::Impl {
 	void StartBGThreads();
 
 	void Submit(std::function<void()> &&schedule,
-		    std::function<void()> &&unschedule, void *tag);
+		    std::function<void()> &&unschedule, void *tag,
+		    Env::JobPriority job_pri);
 
 	int UnSchedule(void *arg);
 
+	void SetBorrowSource(Impl *donor)
+	{
+		assert(donor != this);
+		donor_ = donor;
+		donor->borrower_ = this;
+	}
+
+	void SetAllowBorrowing(bool allow)
+	{
+		allow_borrowing_.store(allow, std::memory_order_relaxed);
+		if (allow) {
+			WakeUpForBorrowing();
+		}
+	}
+
+	void GetQueueWaitStats(Env::JobPriority job_pri, uint64_t *num_jobs,
+			       uint64_t *wait_micros) const
+	{
+		assert(job_pri >= 0 && job_pri < Env::JOB_TOTAL);
+		*num_jobs = wait_stats_[job_pri].num_jobs.load(
+			std::memory_order_relaxed);
+		*wait_micros = wait_stats_[job_pri].wait_micros.load(
+			std::memory_order_relaxed);
+	}
+
 	void SetHostEnv(Env *env)
 	{
 		env_ = env;
@@ -112,26 +141,107 @@ struct ThreadPoolImpl::Impl {
 	}
 
     private:
+	// Entry per Schedule()/Submit() call
+	struct BGItem {
+		void *tag = nullptr;
+		std::function<void()> function;
+		std::function<void()> unschedFunction;
+		uint64_t enqueue_micros = 0;
+	};
+
+	struct WaitStats {
+		std::atomic<uint64_t> num_jobs{ 0 };
+		std::atomic<uint64_t> wait_micros{ 0 };
+	};
+
 	static void *BGThreadWrapper(void *arg);
 
+	static uint64_t NowMicros()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+			       std::chrono::steady_clock::now()
+				       .time_since_epoch())
+			.count();
+	}
+
+	bool QueueEmpty() const
+	{
+		return queue_len_.load(std::memory_order_relaxed) == 0;
+	}
+
+	// True if all threads of this pool are busy while JOB_FLUSH items
+	// wait in its queue
+	bool Saturated() const
+	{
+		return borrowable_len_.load(std::memory_order_relaxed) > 0 &&
+		       idle_threads_.load(std::memory_order_relaxed) == 0;
+	}
+
+	// True if this pool may take a job from donor_ right now. Reads only
+	// atomics so it can be evaluated without holding donor_->mu_.
+	bool CanBorrow() const
+	{
+		return donor_ != nullptr &&
+		       allow_borrowing_.load(std::memory_order_relaxed) &&
+		       donor_->Saturated();
+	}
+
+	// Wakes borrower_ if it may take one of our items now. Call without
+	// mu_ held.
+	void MaybeWakeUpBorrower()
+	{
+		if (borrower_ != nullptr &&
+		    borrower_->allow_borrowing_.load(std::memory_order_relaxed) &&
+		    Saturated()) {
+			borrower_->WakeUpForBorrowing();
+		}
+	}
+
+	// Pop the most urgent queued item and account its wait time.
+	// REQUIRES: mu_ held and the queue is not empty.
+	std::function<void()> PopNextItem();
+
+	// Called by a borrowing pool: pop a queued JOB_FLUSH item into *func
+	// if all our threads are busy. Takes mu_.
+	bool TakeBorrowable(std::function<void()> *func);
+
+	// Wake one idle thread so that it re-evaluates CanBorrow(). Takes mu_.
+	void WakeUpForBorrowing();
+
+	void UpdateQueueLen()
+	{
+		size_t len = 0;
+		for (const auto &q : queues_) {
+			len += q.size();
+		}
+		queue_len_.store(static_cast<unsigned int>(len),
+				 std::memory_order_relaxed);
+		borrowable_len_.store(
+			static_cast<unsigned int>(queues_[Env::JOB_FLUSH].size()),
+			std::memory_order_relaxed);
+	}
+
 	bool low_io_priority_;
+	bool bind_to_numa_nodes_;
 	Env::Priority priority_;
 	Env *env_;
 
 	int total_threads_limit_;
 	std::atomic_uint queue_len_; // Queue length. Used for stats reporting
+	std::atomic_uint borrowable_len_; // Queued JOB_FLUSH items
+	std::atomic_uint idle_threads_; // Threads waiting for an item
 	bool exit_all_threads_;
 	bool wait_for_jobs_to_complete_;
 
-	// Entry per Schedule()/Submit() call
-	struct BGItem {
-		void *tag = nullptr;
-		std::function<void()> function;
-		std::function<void()> unschedFunction;
-	};
-
 	using BGQueue = std::deque<BGItem>;
-	BGQueue queue_;
+	BGQueue queues_[Env::JOB_TOTAL];
+	WaitStats wait_stats_[Env::JOB_TOTAL];
+
+	// Pool whose JOB_FLUSH items our idle threads may run, and the pool
+	// that may run ours. Wired once before any job is scheduled.
+	Impl *donor_;
+	Impl *borrower_;
+	std::atomic<bool> allow_borrowing_;
 
 	std::mutex mu_;
 	std::condition_variable bgsignal_;
@@ -139,10 +249,12 @@ struct ThreadPoolImpl::Impl {
 };
 
 inline ThreadPoolImpl::Impl::Impl()
-	: low_io_priority_(false), priority_(Env::LOW), env_(nullptr),
-	  total_threads_limit_(1), queue_len_(), exit_all_threads_(false),
-	  wait_for_jobs_to_complete_(false), queue_(), mu_(), bgsignal_(),
-	  bgthreads_()
+	: low_io_priority_(false), bind_to_numa_nodes_(false),
+	  priority_(Env::LOW), env_(nullptr),
+	  total_threads_limit_(1), queue_len_(), borrowable_len_(),
+	  idle_threads_(), exit_all_threads_(false), wait_for_jobs_to_complete_(false),
+	  queues_(), wait_stats_(), donor_(nullptr), borrower_(nullptr),
+	  allow_borrowing_(false), mu_(), bgsignal_(), bgthreads_()
 {
 }
 
@@ -179,22 +291,32 @@ inline void ThreadPoolImpl::Impl::LowerIOPriority()
 	low_io_priority_ = true;
 }
 
+inline void ThreadPoolImpl::Impl::BindToNumaNodes()
+{
+	std::lock_guard<std::mutex> lock(mu_);
+	bind_to_numa_nodes_ = true;
+}
+
 void ThreadPoolImpl::Impl::BGThread(size_t thread_id)
 {
 	bool low_io_priority = false;
+	bool bound_to_numa_node = false;
 	while (true) {
 		// Wait until there is an item that is ready to run
 		std::unique_lock<std::mutex> lock(mu_);
 		// Stop waiting if the thread needs to do work or needs to terminate.
 		while (!exit_all_threads_ &&
 		       !IsLastExcessiveThread(thread_id) &&
-		       (queue_.empty() || IsExcessiveThread(thread_id))) {
+		       ((QueueEmpty() && !CanBorrow()) ||
+			IsExcessiveThread(thread_id))) {
+			idle_threads_.fetch_add(1, std::memory_order_relaxed);
 			bgsignal_.wait(lock);
+			idle_threads_.fetch_sub(1, std::memory_order_relaxed);
 		}
 
 		if (exit_all_threads_) { // mechanism to let BG threads exit safely
 
-			if (!wait_for_jobs_to_complete_ || queue_.empty()) {
+			if (!wait_for_jobs_to_complete_ || QueueEmpty()) {
 				break;
 			}
 		}
@@ -214,16 +336,38 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id)
 			break;
 		}
 
-		auto func = std::move(queue_.front().function);
-		queue_.pop_front();
-
-		queue_len_.store(static_cast<unsigned int>(queue_.size()),
-				 std::memory_order_relaxed);
+		// Our own queue always goes first; only an otherwise idle
+		// thread runs a job borrowed from donor_.
+		std::function<void()> func;
+		bool borrow = QueueEmpty();
+		if (!borrow) {
+			func = PopNextItem();
+		}
+		// With this thread busy too, flushes may be left waiting
+		bool wake_borrower = !borrow;
 
 		bool decrease_io_priority =
 			(low_io_priority != low_io_priority_);
+		bool bind_to_numa_node =
+			(bound_to_numa_node != bind_to_numa_nodes_);
 		lock.unlock();
 
+		if (wake_borrower) {
+			MaybeWakeUpBorrower();
+		}
+
+		if (bind_to_numa_node) {
+			port::BindThreadToNumaNode(
+				static_cast<int>(thread_id) %
+				port::NumaNodeCount());
+			bound_to_numa_node = true;
+		}
+
+		if (borrow && !donor_->TakeBorrowable(&func)) {
+			// Someone else picked it up first
+			continue;
+		}
+
 #ifdef OS_LINUX
 		if (decrease_io_priority) {
 #define IOPRIO_CLASS_SHIFT (13)
@@ -243,10 +387,20 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id)
 				IOPRIO_PRIO_VALUE(3, 0));
 			low_io_priority = true;
 		}
+		// A borrowed flush keeps the I/O priority of its own pool
+		// rather than idling behind the I/O of the compactions
+		const bool restore_io_priority = borrow && low_io_priority;
+		if (restore_io_priority) {
+			syscall(SYS_ioprio_set, 1, 0, IOPRIO_PRIO_VALUE(0, 0));
+		}
+		func();
+		if (restore_io_priority) {
+			syscall(SYS_ioprio_set, 1, 0, IOPRIO_PRIO_VALUE(3, 0));
+		}
 #else
 		(void)decrease_io_priority; // avoid 'unused variable' error
-#endif
 		func();
+#endif
 	}
 }
 
@@ -325,35 +479,87 @@ void ThreadPoolImpl::Impl::StartBGThreads()
 	}
 }
 
-void ThreadPoolImpl::Impl::Submit(std::function<void()> &&schedule,
-				  std::function<void()> &&unschedule, void *tag)
+std::function<void()> ThreadPoolImpl::Impl::PopNextItem()
+{
+	for (int i = 0; i < Env::JOB_TOTAL; ++i) {
+		auto &queue = queues_[i];
+		if (queue.empty()) {
+			continue;
+		}
+		auto func = std::move(queue.front().function);
+		uint64_t waited = NowMicros() - queue.front().enqueue_micros;
+		queue.pop_front();
+		UpdateQueueLen();
+
+		wait_stats_[i].num_jobs.fetch_add(1, std::memory_order_relaxed);
+		wait_stats_[i].wait_micros.fetch_add(waited,
+						     std::memory_order_relaxed);
+		return func;
+	}
+	assert(false);
+	return std::function<void()>();
+}
+
+bool ThreadPoolImpl::Impl::TakeBorrowable(std::function<void()> *func)
 {
 	std::lock_guard<std::mutex> lock(mu_);
+	if (queues_[Env::JOB_FLUSH].empty() ||
+	    idle_threads_.load(std::memory_order_relaxed) > 0) {
+		return false;
+	}
+	*func = PopNextItem();
+	return true;
+}
 
-	if (exit_all_threads_) {
-		return;
+void ThreadPoolImpl::Impl::WakeUpForBorrowing()
+{
+	std::lock_guard<std::mutex> lock(mu_);
+	if (!HasExcessiveThread()) {
+		bgsignal_.notify_one();
+	} else {
+		WakeUpAllThreads();
 	}
+}
 
-	StartBGThreads();
+void ThreadPoolImpl::Impl::Submit(std::function<void()> &&schedule,
+				  std::function<void()> &&unschedule, void *tag,
+				  Env::JobPriority job_pri)
+{
+	assert(job_pri >= 0 && job_pri < Env::JOB_TOTAL);
+	{
+		std::lock_guard<std::mutex> lock(mu_);
 
-	// Add to priority queue
-	queue_.push_back(BGItem());
+		if (exit_all_threads_) {
+			return;
+		}
 
-	auto &item = queue_.back();
-	item.tag = tag;
-	item.function = std::move(schedule);
-	item.unschedFunction = std::move(unschedule);
+		StartBGThreads();
 
-	queue_len_.store(static_cast<unsigned int>(queue_.size()),
-			 std::memory_order_relaxed);
+		// Add to priority queue
+		queues_[job_pri].push_back(BGItem());
 
-	if (!HasExcessiveThread()) {
-		// Wake up at least one waiting thread.
-		bgsignal_.notify_one();
-	} else {
-		// Need to wake up all threads to make sure the one woken
-		// up is not the one to terminate.
-		WakeUpAllThreads();
+		auto &item = queues_[job_pri].back();
+		item.tag = tag;
+		item.function = std::move(schedule);
+		item.unschedFunction = std::move(unschedule);
+		item.enqueue_micros = NowMicros();
+
+		UpdateQueueLen();
+
+		if (!HasExcessiveThread()) {
+			// Wake up at least one waiting thread.
+			bgsignal_.notify_one();
+		} else {
+			// Need to wake up all threads to make sure the one woken
+			// up is not the one to terminate.
+			WakeUpAllThreads();
+		}
+	}
+
+	// Notify the borrowing pool outside of mu_ so that the two pool
+	// locks are never held together in this order.
+	if (job_pri == Env::JOB_FLUSH) {
+		MaybeWakeUpBorrower();
 	}
 }
 
@@ -365,22 +571,23 @@ int ThreadPoolImpl::Impl::UnSchedule(void *arg)
 	{
 		std::lock_guard<std::mutex> lock(mu_);
 
-		// Remove from priority queue
-		BGQueue::iterator it = queue_.begin();
-		while (it != queue_.end()) {
-			if (arg == (*it).tag) {
-				if (it->unschedFunction) {
-					candidates.push_back(
-						std::move(it->unschedFunction));
+		// Remove from priority queues
+		for (auto &queue : queues_) {
+			BGQueue::iterator it = queue.begin();
+			while (it != queue.end()) {
+				if (arg == (*it).tag) {
+					if (it->unschedFunction) {
+						candidates.push_back(std::move(
+							it->unschedFunction));
+					}
+					it = queue.erase(it);
+					count++;
+				} else {
+					++it;
 				}
-				it = queue_.erase(it);
-				count++;
-			} else {
-				++it;
 			}
 		}
-		queue_len_.store(static_cast<unsigned int>(queue_.size()),
-				 std::memory_order_relaxed);
+		UpdateQueueLen();
 	}
 
 	// Run unschedule functions outside the mutex
@@ -429,6 +636,11 @@ void ThreadPoolImpl::LowerIOPriority()
 	impl_->LowerIOPriority();
 }
 
+void ThreadPoolImpl::BindToNumaNodes()
+{
+	impl_->BindToNumaNodes();
+}
+
 void ThreadPoolImpl::IncBackgroundThreadsIfNeeded(int num)
 {
 	impl_->SetBackgroundThreadsInternal(num, false);
@@ -437,16 +649,19 @@ void ThreadPoolImpl::IncBackgroundThreadsIfNeeded(int num)
 void ThreadPoolImpl::SubmitJob(const std::function<void()> &job)
 {
 	auto copy(job);
-	impl_->Submit(std::move(copy), std::function<void()>(), nullptr);
+	impl_->Submit(std::move(copy), std::function<void()>(), nullptr,
+		      Env::JOB_COMPACTION);
 }
 
 void ThreadPoolImpl::SubmitJob(std::function<void()> &&job)
 {
-	impl_->Submit(std::move(job), std::function<void()>(), nullptr);
+	impl_->Submit(std::move(job), std::function<void()>(), nullptr,
+		      Env::JOB_COMPACTION);
 }
 
 void ThreadPoolImpl::Schedule(void (*function)(void *arg1), void *arg,
-			      void *tag, void (*unschedFunction)(void *arg))
+			      void *tag, void (*unschedFunction)(void *arg),
+			      Env::JobPriority job_pri)
 {
 	std::function<void()> fn = [arg, function] { function(arg); };
 
@@ -456,7 +671,7 @@ void ThreadPoolImpl::Schedule(void (*function)(void *arg1), void *arg,
 		unfn = std::move(uf);
 	}
 
-	impl_->Submit(std::move(fn), std::move(unfn), tag);
+	impl_->Submit(std::move(fn), std::move(unfn), tag, job_pri);
 }
 
 int ThreadPoolImpl::UnSchedule(void *arg)
@@ -464,6 +679,23 @@ int ThreadPoolImpl::UnSchedule(void *arg)
 	return impl_->UnSchedule(arg);
 }
 
+void ThreadPoolImpl::SetBorrowSource(ThreadPoolImpl *donor)
+{
+	impl_->SetBorrowSource(donor->impl_.get());
+}
+
+void ThreadPoolImpl::SetAllowBorrowing(bool allow)
+{
+	impl_->SetAllowBorrowing(allow);
+}
+
+void ThreadPoolImpl::GetQueueWaitStats(Env::JobPriority job_pri,
+				       uint64_t *num_jobs,
+				       uint64_t *wait_micros) const
+{
+	impl_->GetQueueWaitStats(job_pri, num_jobs, wait_micros);
+}
+
 void ThreadPoolImpl::SetHostEnv(Env *env)
 {
 	impl_->SetHostEnv(env);
@@ -49,6 +49,10 @@ class ThreadPoolImpl : public ThreadPool {
 	// Currently only has effect on Linux
 	void LowerIOPriority();
 
+	// Bind thread i of the pool to the cores of NUMA node
+	// i % port::NumaNodeCount(). No-op on single node machines.
+	void BindToNumaNodes();
+
 	// Ensure there is at aleast num threads in the pool
 	// but do not kill threads if there are more
 	void IncBackgroundThreadsIfNeeded(int num);
@@ -63,9 +67,11 @@ class ThreadPoolImpl : public ThreadPool {
 
 	// Schedule a job with an unschedule tag and unschedule function
 	// Can be used to filter and unschedule jobs by a tag
-	// that are still in the queue and did not start running
+	// that are still in the queue and did not start running.
+	// Queued jobs are picked up in order of job_pri, FIFO within a class.
 	void Schedule(void (*function)(void *arg1), void *arg, void *tag,
-		      void (*unschedFunction)(void *arg));
+		      void (*unschedFunction)(void *arg),
+		      Env::JobPriority job_pri = Env::JOB_COMPACTION);
 
 	// Filter jobs that are still in a queue and match
 	// the given tag. Remove them from a queue if any
@@ -73,6 +79,20 @@ class ThreadPoolImpl : public ThreadPool {
 	// if such was given at scheduling time.
 	int UnSchedule(void *tag);
 
+	// Let idle threads of this pool run JOB_FLUSH jobs queued in donor
+	// while borrowing is allowed. Must be called before any job is
+	// scheduled on either pool and donor must outlive this pool.
+	void SetBorrowSource(ThreadPoolImpl *donor);
+
+	// Turn borrowing from the source set by SetBorrowSource() on or off.
+	void SetAllowBorrowing(bool allow);
+
+	// Number of jobs of class job_pri taken off this pool's queue, either
+	// by its own threads or by a borrowing pool, and the total time in
+	// microseconds they spent queued.
+	void GetQueueWaitStats(Env::JobPriority job_pri, uint64_t *num_jobs,
+			       uint64_t *wait_micros) const;
+
 	void SetHostEnv(Env *env);
 
 	Env *GetHostEnv() const;
@@ -0,0 +1,406 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/trace_replay.h"
+
+#include <mutex>
+
+#include "db/write_batch_internal.h"
+#include "rocksdb/db.h"
+#include "rocksdb/iterator.h"
+#include "rocksdb/threadpool.h"
+#include "rocksdb/version.h"
+#include "rocksdb/write_batch.h"
+#include "util/coding.h"
+
+namespace rocksdb
+{
+const std::string kTraceMagic = "feedcafedeadbeef";
+
+void EncodeTrace(const Trace &trace, std::string *encoded_trace)
+{
+	assert(encoded_trace);
+	PutFixed64(encoded_trace, trace.ts);
+	encoded_trace->push_back(trace.type);
+	PutFixed32(encoded_trace, static_cast<uint32_t>(trace.payload.size()));
+	encoded_trace->append(trace.payload);
+}
+
+Status DecodeTrace(const std::string &encoded_trace, Trace *trace)
+{
+	assert(trace != nullptr);
+	Slice enc_slice = Slice(encoded_trace);
+	if (!GetFixed64(&enc_slice, &trace->ts)) {
+		return Status::Incomplete("Decode trace string failed");
+	}
+	if (enc_slice.size() < kTraceTypeSize + kTracePayloadLengthSize) {
+		return Status::Incomplete("Decode trace string failed");
+	}
+	trace->type = static_cast<TraceType>(enc_slice[0]);
+	enc_slice.remove_prefix(kTraceTypeSize + kTracePayloadLengthSize);
+	trace->payload = enc_slice.ToString();
+	return Status::OK();
+}
+
+BackgroundTraceWriter::BackgroundTraceWriter(
+	std::unique_ptr<TraceWriter> &&trace_writer,
+	uint64_t max_trace_file_size)
+	: trace_writer_(std::move(trace_writer)),
+	  max_trace_file_size_(max_trace_file_size), full_(false),
+	  queued_bytes_(0), closing_(false)
+{
+	bg_thread_ = port::Thread(&BackgroundTraceWriter::BGWork, this);
+}
+
+BackgroundTraceWriter::~BackgroundTraceWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		closing_ = true;
+	}
+	work_cv_.notify_one();
+	space_cv_.notify_all();
+	if (bg_thread_.joinable()) {
+		bg_thread_.join();
+	}
+}
+
+void BackgroundTraceWriter::Add(std::string &&encoded_trace)
+{
+	if (IsFull()) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock(mutex_);
+	space_cv_.wait(lock, [this] {
+		return closing_ || queued_bytes_ < kMaxBufferedBytes;
+	});
+	if (closing_) {
+		return;
+	}
+	const bool was_empty = queue_.empty();
+	queued_bytes_ += encoded_trace.size();
+	queue_.push_back(std::move(encoded_trace));
+	if (was_empty) {
+		work_cv_.notify_one();
+	}
+}
+
+void BackgroundTraceWriter::BGWork()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true) {
+		work_cv_.wait(lock,
+			      [this] { return closing_ || !queue_.empty(); });
+		if (queue_.empty()) {
+			break;
+		}
+		std::deque<std::string> batch;
+		batch.swap(queue_);
+		queued_bytes_ = 0;
+		lock.unlock();
+		space_cv_.notify_all();
+
+		Status s;
+		for (const std::string &encoded_trace : batch) {
+			if (IsFull()) {
+				break;
+			}
+			if (trace_writer_->GetFileSize() >=
+			    max_trace_file_size_) {
+				full_.store(true, std::memory_order_relaxed);
+				break;
+			}
+			s = trace_writer_->Write(Slice(encoded_trace));
+			if (!s.ok()) {
+				full_.store(true, std::memory_order_relaxed);
+				break;
+			}
+		}
+
+		lock.lock();
+		if (!s.ok() && bg_status_.ok()) {
+			bg_status_ = s;
+		}
+	}
+}
+
+Status BackgroundTraceWriter::Close(const std::string &encoded_footer)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (closing_) {
+			return Status::OK();
+		}
+		closing_ = true;
+	}
+	work_cv_.notify_one();
+	space_cv_.notify_all();
+	bg_thread_.join();
+
+	// The footer goes in even if the trace is full, so a reader can tell
+	// a complete trace from a truncated one.
+	Status s = trace_writer_->Write(Slice(encoded_footer));
+	Status close_s = trace_writer_->Close();
+	if (!bg_status_.ok()) {
+		return bg_status_;
+	}
+	return s.ok() ? close_s : s;
+}
+
+Tracer::Tracer(Env *env, const TraceOptions &trace_options,
+	       std::unique_ptr<TraceWriter> &&trace_writer)
+	: env_(env), trace_options_(trace_options), trace_request_count_(0),
+	  writer_(std::move(trace_writer), trace_options.max_trace_file_size)
+{
+	if (trace_options_.sampling_frequency == 0) {
+		trace_options_.sampling_frequency = 1;
+	}
+	WriteHeader();
+}
+
+Tracer::~Tracer()
+{
+}
+
+Status Tracer::Write(WriteBatch *write_batch)
+{
+	if (writer_.IsFull()) {
+		return Status::OK();
+	}
+	Trace trace;
+	trace.ts = env_->NowMicros();
+	trace.type = kTraceWrite;
+	trace.payload = WriteBatchInternal::Contents(write_batch).ToString();
+	WriteTrace(trace);
+	return Status::OK();
+}
+
+Status Tracer::Get(uint32_t cf_id, const Slice &key)
+{
+	return WriteKeyTrace(kTraceGet, cf_id, key);
+}
+
+Status Tracer::IteratorSeek(uint32_t cf_id, const Slice &key)
+{
+	return WriteKeyTrace(kTraceIteratorSeek, cf_id, key);
+}
+
+Status Tracer::IteratorSeekForPrev(uint32_t cf_id, const Slice &key)
+{
+	return WriteKeyTrace(kTraceIteratorSeekForPrev, cf_id, key);
+}
+
+Status Tracer::WriteKeyTrace(TraceType type, uint32_t cf_id,
+			     const Slice &key)
+{
+	if (ShouldSkipTrace()) {
+		return Status::OK();
+	}
+	Trace trace;
+	trace.ts = env_->NowMicros();
+	trace.type = type;
+	PutFixed32(&trace.payload, cf_id);
+	trace.payload.append(key.data(), key.size());
+	WriteTrace(trace);
+	return Status::OK();
+}
+
+bool Tracer::ShouldSkipTrace()
+{
+	if (writer_.IsFull()) {
+		return true;
+	}
+	const uint64_t count =
+		trace_request_count_.fetch_add(1, std::memory_order_relaxed);
+	return count % trace_options_.sampling_frequency != 0;
+}
+
+void Tracer::WriteHeader()
+{
+	Trace trace;
+	trace.ts = env_->NowMicros();
+	trace.type = kTraceBegin;
+	trace.payload = kTraceMagic;
+	PutFixed32(&trace.payload, kTraceFormatVersion);
+	PutFixed32(&trace.payload, ROCKSDB_MAJOR);
+	PutFixed32(&trace.payload, ROCKSDB_MINOR);
+	WriteTrace(trace);
+}
+
+void Tracer::WriteTrace(const Trace &trace)
+{
+	std::string encoded_trace;
+	EncodeTrace(trace, &encoded_trace);
+	writer_.Add(std::move(encoded_trace));
+}
+
+Status Tracer::Close()
+{
+	Trace trace;
+	trace.ts = env_->NowMicros();
+	trace.type = kTraceEnd;
+	std::string encoded_trace;
+	EncodeTrace(trace, &encoded_trace);
+	return writer_.Close(encoded_trace);
+}
+
+Replayer::Replayer(DB *db, const std::vector<ColumnFamilyHandle *> &handles,
+		   std::unique_ptr<TraceReader> &&reader)
+	: db_(db), trace_reader_(std::move(reader)), ops_replayed_(0)
+{
+	for (ColumnFamilyHandle *cfh : handles) {
+		cf_map_[cfh->GetID()] = cfh;
+	}
+}
+
+Replayer::~Replayer()
+{
+	trace_reader_.reset();
+}
+
+Status Replayer::ReadHeader(Trace *header)
+{
+	Status s = ReadTrace(header);
+	if (!s.ok()) {
+		return s;
+	}
+	if (header->type != kTraceBegin) {
+		return Status::Corruption("Trace does not start with a header");
+	}
+	Slice payload(header->payload);
+	if (!payload.starts_with(kTraceMagic)) {
+		return Status::Corruption("Bad magic number in trace header");
+	}
+	payload.remove_prefix(kTraceMagic.size());
+	uint32_t version = 0;
+	if (!GetFixed32(&payload, &version)) {
+		return Status::Corruption("Truncated trace header");
+	}
+	if (version > kTraceFormatVersion) {
+		return Status::NotSupported("Unknown trace format version");
+	}
+	return Status::OK();
+}
+
+Status Replayer::ReadTrace(Trace *trace)
+{
+	assert(trace != nullptr);
+	std::string encoded_trace;
+	Status s = trace_reader_->Read(&encoded_trace);
+	if (!s.ok()) {
+		return s;
+	}
+	return DecodeTrace(encoded_trace, trace);
+}
+
+Status Replayer::Execute(const Trace &trace)
+{
+	if (trace.type == kTraceWrite) {
+		WriteBatch batch(trace.payload);
+		ops_replayed_.fetch_add(1, std::memory_order_relaxed);
+		return db_->Write(WriteOptions(), &batch);
+	}
+
+	Slice payload(trace.payload);
+	uint32_t cf_id = 0;
+	if (!GetFixed32(&payload, &cf_id)) {
+		return Status::Corruption("Truncated trace record");
+	}
+	auto it = cf_map_.find(cf_id);
+	if (it == cf_map_.end()) {
+		return Status::OK();
+	}
+	ColumnFamilyHandle *cfh = it->second;
+	ops_replayed_.fetch_add(1, std::memory_order_relaxed);
+	if (trace.type == kTraceGet) {
+		std::string value;
+		db_->Get(ReadOptions(), cfh, payload, &value);
+	} else {
+		std::unique_ptr<Iterator> iter(
+			db_->NewIterator(ReadOptions(), cfh));
+		if (trace.type == kTraceIteratorSeek) {
+			iter->Seek(payload);
+		} else {
+			iter->SeekForPrev(payload);
+		}
+	}
+	return Status::OK();
+}
+
+Status Replayer::Replay(const ReplayOptions &options)
+{
+	ops_replayed_.store(0, std::memory_order_relaxed);
+	Trace header;
+	Status s = ReadHeader(&header);
+	if (!s.ok()) {
+		return s;
+	}
+
+	Env *env = db_->GetEnv();
+	const uint64_t replay_epoch = env->NowMicros();
+	std::unique_ptr<ThreadPool> pool;
+	if (options.num_threads > 1) {
+		pool.reset(NewThreadPool(options.num_threads));
+	}
+	// First failed write of the worker threads
+	std::mutex error_mu;
+	Status bg_error;
+
+	Trace trace;
+	while (s.ok()) {
+		trace.reset();
+		s = ReadTrace(&trace);
+		if (!s.ok() || trace.type == kTraceEnd) {
+			break;
+		}
+		if (trace.type < kTraceWrite ||
+		    trace.type > kTraceIteratorSeekForPrev) {
+			continue;
+		}
+
+		if (!options.fast_forward && trace.ts > header.ts) {
+			uint64_t due = replay_epoch + (trace.ts - header.ts);
+			uint64_t now = env->NowMicros();
+			if (due > now) {
+				env->SleepForMicroseconds(
+					static_cast<int>(due - now));
+			}
+		}
+
+		if (!pool) {
+			s = Execute(trace);
+			continue;
+		}
+		// Keep the backlog short so a fast-forward replay does not
+		// read the whole trace into memory.
+		while (pool->GetQueueLen() >
+		       static_cast<unsigned int>(options.num_threads) * 64) {
+			env->SleepForMicroseconds(100);
+		}
+		auto job = std::make_shared<Trace>(std::move(trace));
+		pool->SubmitJob([this, job, &error_mu, &bg_error]() {
+			Status job_s = Execute(*job);
+			if (!job_s.ok()) {
+				std::lock_guard<std::mutex> lock(error_mu);
+				if (bg_error.ok()) {
+					bg_error = job_s;
+				}
+			}
+		});
+		std::lock_guard<std::mutex> lock(error_mu);
+		s = bg_error;
+	}
+	if (pool) {
+		pool->WaitForJobsAndJoinAllThreads();
+		if (s.ok() || s.IsIncomplete()) {
+			s = bg_error;
+		}
+	}
+	// Running out of records without a footer is fine: the traced
+	// process may have died.
+	return s.IsIncomplete() ? Status::OK() : s;
+}
+
+} // namespace rocksdb
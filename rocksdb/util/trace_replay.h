@@ -0,0 +1,191 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/trace_reader_writer.h"
+
+namespace rocksdb
+{
+class ColumnFamilyHandle;
+class DB;
+class WriteBatch;
+
+// A trace is a sequence of records, each
+//
+//   timestamp (fixed64, microseconds) | type (1 byte) |
+//   payload size (fixed32) | payload
+//
+// The first record is a kTraceBegin header carrying kTraceMagic and the
+// format version, the last one a kTraceEnd footer written by EndTrace().
+extern const std::string kTraceMagic;
+const unsigned int kTraceTimestampSize = 8;
+const unsigned int kTraceTypeSize = 1;
+const unsigned int kTracePayloadLengthSize = 4;
+const unsigned int kTraceMetadataSize =
+	kTraceTimestampSize + kTraceTypeSize + kTracePayloadLengthSize;
+const uint32_t kTraceFormatVersion = 1;
+
+enum TraceType : char {
+	kTraceBegin = 1,
+	kTraceEnd = 2,
+	// Payload: the WriteBatch rep
+	kTraceWrite = 3,
+	// Payload for these three: column family id (fixed32) | user key
+	kTraceGet = 4,
+	kTraceIteratorSeek = 5,
+	kTraceIteratorSeekForPrev = 6,
+	// Payload: a BlockCacheTraceRecord, see util/block_cache_tracer.h
+	kTraceBlockCacheAccess = 7,
+	kTraceMax,
+};
+
+struct Trace {
+	uint64_t ts = 0;
+	TraceType type = kTraceMax;
+	std::string payload;
+
+	void reset()
+	{
+		ts = 0;
+		type = kTraceMax;
+		payload.clear();
+	}
+};
+
+void EncodeTrace(const Trace &trace, std::string *encoded_trace);
+Status DecodeTrace(const std::string &encoded_trace, Trace *trace);
+
+// BackgroundTraceWriter queues encoded trace records and writes them to a
+// TraceWriter from its own thread, so the traced operations never wait on
+// the trace file. Add() is thread-safe.
+class BackgroundTraceWriter {
+    public:
+	// Records are dropped once the file reaches max_trace_file_size.
+	BackgroundTraceWriter(std::unique_ptr<TraceWriter> &&trace_writer,
+			      uint64_t max_trace_file_size);
+	~BackgroundTraceWriter();
+
+	// Queue one record. Waits while kMaxBufferedBytes are queued; drops
+	// the record once the trace is full or closed.
+	void Add(std::string &&encoded_trace);
+
+	// True once the file reached its maximum size or a write failed.
+	bool IsFull() const
+	{
+		return full_.load(std::memory_order_relaxed);
+	}
+
+	// Write the queued records, then the footer even if the trace is full,
+	// and close the writer. Returns the first error of any write.
+	Status Close(const std::string &encoded_footer);
+
+	static const size_t kMaxBufferedBytes = 4 << 20;
+
+    private:
+	void BGWork();
+
+	std::unique_ptr<TraceWriter> trace_writer_;
+	const uint64_t max_trace_file_size_;
+	std::atomic<bool> full_;
+
+	std::mutex mutex_;
+	// Signaled when the queue gets a record or the writer is closed
+	std::condition_variable work_cv_;
+	// Signaled when the background thread takes the queued records
+	std::condition_variable space_cv_;
+	std::deque<std::string> queue_;
+	size_t queued_bytes_;
+	bool closing_;
+	// First write error of the background thread
+	Status bg_status_;
+
+	port::Thread bg_thread_;
+};
+
+// Tracer records the operations of one DB to a TraceWriter, see
+// DB::StartTrace(). The calls are thread-safe and take no lock but the
+// one of the queue the records go to; see BackgroundTraceWriter.
+class Tracer {
+    public:
+	Tracer(Env *env, const TraceOptions &trace_options,
+	       std::unique_ptr<TraceWriter> &&trace_writer);
+	~Tracer();
+
+	Status Write(WriteBatch *write_batch);
+	Status Get(uint32_t cf_id, const Slice &key);
+	Status IteratorSeek(uint32_t cf_id, const Slice &key);
+	Status IteratorSeekForPrev(uint32_t cf_id, const Slice &key);
+
+	// Write the footer and close the writer.
+	Status Close();
+
+    private:
+	void WriteHeader();
+	void WriteTrace(const Trace &trace);
+	Status WriteKeyTrace(TraceType type, uint32_t cf_id,
+			     const Slice &key);
+	// True when the query is not sampled or the trace is full.
+	bool ShouldSkipTrace();
+
+	Env *env_;
+	TraceOptions trace_options_;
+	std::atomic<uint64_t> trace_request_count_;
+	BackgroundTraceWriter writer_;
+};
+
+struct ReplayOptions {
+	// Threads issuing the operations. With more than one thread the
+	// relative order of operations that are close in time is lost.
+	int num_threads = 1;
+
+	// Issue every operation as soon as a thread is free instead of at the
+	// offset from the start of the trace it was recorded at.
+	bool fast_forward = false;
+};
+
+// Replayer issues the operations of a trace against a DB. The DB needs the
+// column families of the traced one; handles maps them by ID, and an
+// operation on a column family missing from it is skipped.
+class Replayer {
+    public:
+	Replayer(DB *db, const std::vector<ColumnFamilyHandle *> &handles,
+		 std::unique_ptr<TraceReader> &&reader);
+	~Replayer();
+
+	// Replay the whole trace. Returns the first error of a write; reads
+	// that fail, e.g. with NotFound, are expected and not reported.
+	Status Replay(const ReplayOptions &options = ReplayOptions());
+
+	// Number of operations issued by the last Replay().
+	uint64_t GetOpsReplayed() const
+	{
+		return ops_replayed_.load(std::memory_order_relaxed);
+	}
+
+    private:
+	Status ReadHeader(Trace *header);
+	Status ReadTrace(Trace *trace);
+	// Run one record; thread-safe.
+	Status Execute(const Trace &trace);
+
+	DB *db_;
+	std::unique_ptr<TraceReader> trace_reader_;
+	std::unordered_map<uint32_t, ColumnFamilyHandle *> cf_map_;
+	std::atomic<uint64_t> ops_replayed_;
+};
+
+} // namespace rocksdb
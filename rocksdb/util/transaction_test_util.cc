@@ -24,9 +24,11 @@ namespace rocksdb
 {
 RandomTransactionInserter::RandomTransactionInserter(
 	Random64 *rand, const WriteOptions &write_options,
-	const ReadOptions &read_options, uint64_t num_keys, uint16_t num_sets)
+	const ReadOptions &read_options, uint64_t num_keys, uint16_t num_sets,
+	std::function<uint64_t()> key_chooser)
 	: rand_(rand), write_options_(write_options),
-	  read_options_(read_options), num_keys_(num_keys), num_sets_(num_sets)
+	  read_options_(read_options), num_keys_(num_keys), num_sets_(num_sets),
+	  key_chooser_(std::move(key_chooser))
 {
 }
 
@@ -82,7 +84,9 @@ bool RandomTransactionInserter::DoInsert(DB *db, Transaction *txn,
 		// prefix_buf needs to be large enough to hold a uint16 in string form
 
 		// key format:  [SET#][random#]
-		std::string rand_key = ToString(rand_->Next() % num_keys_);
+		uint64_t key_num =
+			key_chooser_ ? key_chooser_() : rand_->Next();
+		std::string rand_key = ToString(key_num % num_keys_);
 		Slice base_key(rand_key);
 
 		// Pad prefix appropriately so we can iterate over each set
@@ -7,6 +7,8 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <functional>
+
 #include "rocksdb/options.h"
 #include "port/port.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
@@ -35,11 +37,14 @@ class RandomTransactionInserter {
     public:
 	// num_keys is the number of keys in each set.
 	// num_sets is the number of sets of keys.
+	// key_chooser, when set, picks the key of each set instead of a
+	// uniformly random one; it is taken modulo num_keys.
 	explicit RandomTransactionInserter(
 		Random64 *rand,
 		const WriteOptions &write_options = WriteOptions(),
 		const ReadOptions &read_options = ReadOptions(),
-		uint64_t num_keys = 1000, uint16_t num_sets = 3);
+		uint64_t num_keys = 1000, uint16_t num_sets = 3,
+		std::function<uint64_t()> key_chooser = nullptr);
 
 	~RandomTransactionInserter();
 
@@ -100,6 +105,7 @@ class RandomTransactionInserter {
 	const ReadOptions read_options_;
 	const uint64_t num_keys_;
 	const uint16_t num_sets_;
+	const std::function<uint64_t()> key_chooser_;
 
 	// Number of successful insert batches performed
 	uint64_t success_count_ = 0;
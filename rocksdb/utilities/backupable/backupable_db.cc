@@ -18,6 +18,7 @@
 #include "util/crc32c.h"
 #include "util/file_reader_writer.h"
 #include "util/filename.h"
+#include "util/hash.h"
 #include "util/logging.h"
 #include "util/string_util.h"
 #include "util/sync_point.h"
@@ -94,6 +95,8 @@ void BackupableDBOptions::Dump(Logger *logger) const
 		       restore_rate_limit);
 	ROCKS_LOG_INFO(logger, "Options.max_background_operations: %d",
 		       max_background_operations);
+	ROCKS_LOG_INFO(logger, "          Options.copy_chunk_size: %" PRIu64,
+		       copy_chunk_size);
 }
 
 // -------- BackupEngineImpl class ---------
@@ -320,17 +323,85 @@ class BackupEngineImpl : public BackupEngine {
 		return GetSharedChecksumDirRel() + "/" + file +
 		       (tmp ? ".tmp" : "");
 	}
+	// A table_id of 0 is left out of the name, as in backups made before
+	// table ids were added
 	inline std::string
 	GetSharedFileWithChecksum(const std::string &file,
 				  const uint32_t checksum_value,
-				  const uint64_t file_size) const
+				  const uint64_t file_size,
+				  const uint64_t table_id = 0) const
 	{
 		assert(file.size() == 0 || file[0] != '/');
 		std::string file_copy = file;
 		return file_copy.insert(
 			file_copy.find_last_of('.'),
-			"_" + rocksdb::ToString(checksum_value) + "_" +
-				rocksdb::ToString(file_size));
+			"_" + rocksdb::ToString(checksum_value) +
+				GetSharedFileIdentitySuffix(file_size,
+							    table_id));
+	}
+	inline std::string
+	GetSharedFileIdentitySuffix(const uint64_t file_size,
+				    const uint64_t table_id) const
+	{
+		return "_" + rocksdb::ToString(file_size) +
+		       (table_id != 0 ? "_" + rocksdb::ToString(table_id) :
+					"");
+	}
+	// The name of a table file in shared_checksum without its checksum,
+	// which identifies it without reading it if table_id isn't 0
+	inline std::string
+	GetSharedFileIdentity(const std::string &file, const uint64_t file_size,
+			      const uint64_t table_id) const
+	{
+		assert(file.size() == 0 || file[0] != '/');
+		std::string file_copy = file;
+		return file_copy.insert(
+			file_copy.find_last_of('.'),
+			GetSharedFileIdentitySuffix(file_size, table_id));
+	}
+	// The identity of a file named by GetSharedFileWithChecksum(), or an
+	// empty string if the name isn't one of those
+	inline std::string
+	GetSharedFileIdentityFromChecksumFile(const std::string &file) const
+	{
+		assert(file.size() == 0 || file[0] != '/');
+		std::string file_copy = file;
+		size_t first_underscore = file_copy.find_first_of('_');
+		if (first_underscore == std::string::npos) {
+			return "";
+		}
+		size_t second_underscore =
+			file_copy.find_first_of('_', first_underscore + 1);
+		if (second_underscore == std::string::npos) {
+			return "";
+		}
+		return file_copy.erase(first_underscore,
+				       second_underscore - first_underscore);
+	}
+	// Identifies a live table file by the DB it belongs to and by its
+	// number, size and the properties fixed when it was built, none of
+	// which change while the file exists, across reopens and MANIFEST
+	// roll-overs too. Without the DB identity equally sized files of
+	// other DBs with the same keys would match. 0 is kept for files
+	// without an id.
+	static uint64_t GetTableId(const std::string &db_identity,
+				   const LiveFileMetaData &file)
+	{
+		std::string buf;
+		PutLengthPrefixedSlice(&buf, db_identity);
+		PutLengthPrefixedSlice(&buf, file.name);
+		PutFixed64(&buf, file.size);
+		PutLengthPrefixedSlice(&buf, file.column_family_name);
+		PutLengthPrefixedSlice(&buf, file.smallestkey);
+		PutLengthPrefixedSlice(&buf, file.largestkey);
+		PutFixed64(&buf, file.smallest_seqno);
+		PutFixed64(&buf, file.largest_seqno);
+		uint64_t table_id =
+			(static_cast<uint64_t>(
+				 Hash(buf.data(), buf.size(), 0x1f0a2b3c))
+			 << 32) |
+			Hash(buf.data(), buf.size(), 0x5d6e7f80);
+		return table_id != 0 ? table_id : 1;
 	}
 	inline std::string
 	GetFileFromChecksumFile(const std::string &file) const
@@ -364,6 +435,15 @@ class BackupEngineImpl : public BackupEngine {
 		uint32_t *checksum_value = nullptr, uint64_t size_limit = 0,
 		std::function<void()> progress_callback = []() {});
 
+	// Copies length bytes at offset of src to the same offset of dst,
+	// which must exist, to copy a file in chunks in parallel.
+	Status CopyFileChunk(const std::string &src, const std::string &dst,
+			     Env *src_env, Env *dst_env, bool sync,
+			     RateLimiter *rate_limiter, uint64_t offset,
+			     uint64_t length, uint64_t *size,
+			     uint32_t *checksum_value,
+			     std::function<void()> progress_callback);
+
 	Status CalculateChecksum(const std::string &src, Env *src_env,
 				 uint64_t size_limit, uint32_t *checksum_value);
 
@@ -376,6 +456,8 @@ class BackupEngineImpl : public BackupEngine {
 	// Exactly one of src_path and contents must be non-empty. If src_path is
 	// non-empty, the file is copied from this pathname. Otherwise, if contents is
 	// non-empty, the file will be created at dst_path with these contents.
+	// If chunk_length isn't 0, only that many bytes at chunk_offset are
+	// copied, into the existing dst_path.
 	struct CopyOrCreateWorkItem {
 		std::string src_path;
 		std::string dst_path;
@@ -385,10 +467,12 @@ class BackupEngineImpl : public BackupEngine {
 		bool sync;
 		RateLimiter *rate_limiter;
 		uint64_t size_limit;
+		uint64_t chunk_offset;
+		uint64_t chunk_length;
 		std::promise<CopyOrCreateResult> result;
 		std::function<void()> progress_callback;
 
-		CopyOrCreateWorkItem()
+		CopyOrCreateWorkItem() : chunk_offset(0), chunk_length(0)
 		{
 		}
 		CopyOrCreateWorkItem(const CopyOrCreateWorkItem &) = delete;
@@ -411,6 +495,8 @@ class BackupEngineImpl : public BackupEngine {
 			sync = o.sync;
 			rate_limiter = o.rate_limiter;
 			size_limit = o.size_limit;
+			chunk_offset = o.chunk_offset;
+			chunk_length = o.chunk_length;
 			result = std::move(o.result);
 			progress_callback = std::move(o.progress_callback);
 			return *this;
@@ -427,20 +513,29 @@ class BackupEngineImpl : public BackupEngine {
 			  contents(std::move(_contents)), src_env(_src_env),
 			  dst_env(_dst_env), sync(_sync),
 			  rate_limiter(_rate_limiter), size_limit(_size_limit),
+			  chunk_offset(0), chunk_length(0),
 			  progress_callback(_progress_callback)
 		{
 		}
 	};
 
+	// If the file is copied in chunks, result is for the first chunk and
+	// chunk_results for the rest, in order. If name_after_copy is set,
+	// dst_relative is the file name that GetSharedFileWithChecksum() is
+	// applied to once the checksum is known, and dst_path isn't known yet.
 	struct BackupAfterCopyOrCreateWorkItem {
 		std::future<CopyOrCreateResult> result;
+		std::vector<std::future<CopyOrCreateResult> > chunk_results;
 		bool shared;
 		bool needed_to_copy;
+		bool name_after_copy;
+		uint64_t table_id;
 		Env *backup_env;
 		std::string dst_path_tmp;
 		std::string dst_path;
 		std::string dst_relative;
 		BackupAfterCopyOrCreateWorkItem()
+			: name_after_copy(false), table_id(0)
 		{
 		}
 
@@ -454,8 +549,11 @@ class BackupEngineImpl : public BackupEngine {
 		operator=(BackupAfterCopyOrCreateWorkItem &&o) ROCKSDB_NOEXCEPT
 		{
 			result = std::move(o.result);
+			chunk_results = std::move(o.chunk_results);
 			shared = o.shared;
 			needed_to_copy = o.needed_to_copy;
+			name_after_copy = o.name_after_copy;
+			table_id = o.table_id;
 			backup_env = o.backup_env;
 			dst_path_tmp = std::move(o.dst_path_tmp);
 			dst_path = std::move(o.dst_path);
@@ -470,6 +568,7 @@ class BackupEngineImpl : public BackupEngine {
 			std::string _dst_relative)
 			: result(std::move(_result)), shared(_shared),
 			  needed_to_copy(_needed_to_copy),
+			  name_after_copy(false), table_id(0),
 			  backup_env(_backup_env),
 			  dst_path_tmp(std::move(_dst_path_tmp)),
 			  dst_path(std::move(_dst_path)),
@@ -520,14 +619,25 @@ class BackupEngineImpl : public BackupEngine {
 	//    copied.
 	// @param fname Name of destination file and, in case of copy, source file.
 	// @param contents If non-empty, the file will be created with these contents.
+	// @param table_id If not 0, the GetTableId() of the file, which is
+	//    neither read nor copied if shared_checksum_files has its identity.
+	//    If only its name and size match one there, it is read for its
+	//    checksum first and copied only if shared_checksum_names has no
+	//    file with that checksum.
 	Status AddBackupFileWorkItem(
 		std::unordered_set<std::string> &live_dst_paths,
 		std::vector<BackupAfterCopyOrCreateWorkItem>
 			&backup_items_to_finish,
+		const std::unordered_map<std::string,
+					 std::shared_ptr<FileInfo> >
+			&shared_checksum_files,
+		const std::unordered_map<std::string, std::string>
+			&shared_checksum_names,
 		BackupID backup_id, bool shared, const std::string &src_dir,
 		const std::string &fname, // starts with "/"
 		RateLimiter *rate_limiter, uint64_t size_bytes,
 		uint64_t size_limit = 0, bool shared_checksum = false,
+		uint64_t table_id = 0,
 		std::function<void()> progress_callback = []() {},
 		const std::string &contents = std::string());
 
@@ -790,14 +900,33 @@ Status BackupEngineImpl::Initialize()
 			CopyOrCreateWorkItem work_item;
 			while (files_to_copy_or_create_.read(work_item)) {
 				CopyOrCreateResult result;
-				result.status = CopyOrCreateFile(
-					work_item.src_path, work_item.dst_path,
-					work_item.contents, work_item.src_env,
-					work_item.dst_env, work_item.sync,
-					work_item.rate_limiter, &result.size,
-					&result.checksum_value,
-					work_item.size_limit,
-					work_item.progress_callback);
+				if (work_item.chunk_length > 0) {
+					result.status = CopyFileChunk(
+						work_item.src_path,
+						work_item.dst_path,
+						work_item.src_env,
+						work_item.dst_env,
+						work_item.sync,
+						work_item.rate_limiter,
+						work_item.chunk_offset,
+						work_item.chunk_length,
+						&result.size,
+						&result.checksum_value,
+						work_item.progress_callback);
+				} else {
+					result.status = CopyOrCreateFile(
+						work_item.src_path,
+						work_item.dst_path,
+						work_item.contents,
+						work_item.src_env,
+						work_item.dst_env,
+						work_item.sync,
+						work_item.rate_limiter,
+						&result.size,
+						&result.checksum_value,
+						work_item.size_limit,
+						work_item.progress_callback);
+				}
 				work_item.result.set_value(std::move(result));
 			}
 		});
@@ -863,6 +992,78 @@ Status BackupEngineImpl::CreateNewBackupWithMetadata(
 	std::vector<BackupAfterCopyOrCreateWorkItem> backup_items_to_finish;
 	// Add a CopyOrCreateWorkItem to the channel for each live file
 	db->DisableFileDeletions();
+
+	// Table files that were backed up before, by their identity, and the
+	// ids of the live ones, to back those up again without reading them.
+	// The ids are looked up once the checkpoint has flushed.
+	std::unordered_map<std::string, std::shared_ptr<FileInfo> >
+		shared_checksum_files;
+	// The same files by their name without the table id, which is
+	// different for the same file backed up by another release
+	std::unordered_map<std::string, std::string> shared_checksum_names;
+	std::unordered_map<std::string, uint64_t> table_ids;
+	bool use_table_ids = options_.share_table_files &&
+			     options_.share_files_with_checksum;
+	if (use_table_ids) {
+		const std::string shared_checksum_prefix =
+			GetSharedFileWithChecksumRel();
+		for (const auto &file_info : backuped_file_infos_) {
+			if (file_info.first.compare(
+				    0, shared_checksum_prefix.size(),
+				    shared_checksum_prefix) != 0) {
+				continue;
+			}
+			const std::string file = file_info.first.substr(
+				shared_checksum_prefix.size());
+			std::string identity =
+				GetSharedFileIdentityFromChecksumFile(file);
+			if (!identity.empty()) {
+				const std::string name =
+					GetFileFromChecksumFile(file);
+				shared_checksum_files.emplace(identity,
+							      file_info.second);
+				// Also by name and size alone, which tell a
+				// file worth reading for its checksum first
+				shared_checksum_files.emplace(
+					GetSharedFileIdentity(
+						name, file_info.second->size,
+						0),
+					file_info.second);
+				shared_checksum_names.emplace(
+					GetSharedFileWithChecksum(
+						name,
+						file_info.second
+							->checksum_value,
+						file_info.second->size),
+					file_info.first);
+			}
+		}
+	}
+	auto get_table_id = [&](const std::string &fname) -> uint64_t {
+		if (!use_table_ids) {
+			return 0;
+		}
+		if (table_ids.empty()) {
+			// Without the DB identity, files only go by their
+			// checksum
+			std::string db_identity;
+			if (!db->GetDbIdentity(db_identity).ok() ||
+			    db_identity.empty()) {
+				use_table_ids = false;
+				return 0;
+			}
+			std::vector<LiveFileMetaData> live_files_metadata;
+			db->GetLiveFilesMetaData(&live_files_metadata);
+			for (const auto &file : live_files_metadata) {
+				table_ids.emplace(
+					file.name,
+					GetTableId(db_identity, file));
+			}
+		}
+		auto it = table_ids.find(fname);
+		return it != table_ids.end() ? it->second : 0;
+	};
+
 	if (s.ok()) {
 		CheckpointImpl checkpoint(db);
 		uint64_t sequence_number = 0;
@@ -894,6 +1095,8 @@ Status BackupEngineImpl::CreateNewBackupWithMetadata(
 					st = AddBackupFileWorkItem(
 						live_dst_paths,
 						backup_items_to_finish,
+						shared_checksum_files,
+						shared_checksum_names,
 						new_backup_id,
 						options_.share_table_files &&
 							type == kTableFile,
@@ -902,6 +1105,9 @@ Status BackupEngineImpl::CreateNewBackupWithMetadata(
 						size_limit_bytes,
 						options_.share_files_with_checksum &&
 							type == kTableFile,
+						type == kTableFile ?
+							get_table_id(fname) :
+							0,
 						progress_callback);
 				}
 				return st;
@@ -912,11 +1118,14 @@ Status BackupEngineImpl::CreateNewBackupWithMetadata(
 				    fname.c_str());
 				return AddBackupFileWorkItem(
 					live_dst_paths, backup_items_to_finish,
-					new_backup_id, false /* shared */,
-					"" /* src_dir */, fname, rate_limiter,
-					contents.size(), 0 /* size_limit */,
+					shared_checksum_files,
+					shared_checksum_names, new_backup_id,
+					false /* shared */, "" /* src_dir */,
+					fname, rate_limiter, contents.size(),
+					0 /* size_limit */,
 					false /* shared_checksum */,
-					progress_callback, contents);
+					0 /* table_id */, progress_callback,
+					contents);
 			} /* create_file_cb */,
 			&sequence_number,
 			flush_before_backup ? 0 : port::kMaxUint64);
@@ -931,6 +1140,42 @@ Status BackupEngineImpl::CreateNewBackupWithMetadata(
 		item.result.wait();
 		auto result = item.result.get();
 		item_status = result.status;
+		for (auto &chunk_result : item.chunk_results) {
+			auto chunk = chunk_result.get();
+			if (item_status.ok()) {
+				item_status = chunk.status;
+			}
+			result.checksum_value = crc32c::Combine(
+				result.checksum_value, chunk.checksum_value,
+				chunk.size);
+			result.size += chunk.size;
+		}
+		if (item_status.ok() && item.name_after_copy) {
+			auto same_file = shared_checksum_names.find(
+				GetSharedFileWithChecksum(item.dst_relative,
+							  result.checksum_value,
+							  result.size));
+			item.dst_relative =
+				same_file != shared_checksum_names.end() ?
+					same_file->second :
+					GetSharedFileWithChecksumRel(
+						GetSharedFileWithChecksum(
+							item.dst_relative,
+							result.checksum_value,
+							result.size,
+							item.table_id));
+			item.dst_path = GetAbsolutePath(item.dst_relative);
+			Status exist = item.backup_env->FileExists(
+				item.dst_path);
+			if (exist.ok()) {
+				// The same file, from another DB for example
+				item.needed_to_copy = false;
+				item_status = item.backup_env->DeleteFile(
+					item.dst_path_tmp);
+			} else if (!exist.IsNotFound()) {
+				item_status = exist;
+			}
+		}
 		if (item_status.ok() && item.shared && item.needed_to_copy) {
 			item_status = item.backup_env->RenameFile(
 				item.dst_path_tmp, item.dst_path);
@@ -1394,10 +1639,15 @@ Status BackupEngineImpl::CopyOrCreateFile(
 Status BackupEngineImpl::AddBackupFileWorkItem(
 	std::unordered_set<std::string> &live_dst_paths,
 	std::vector<BackupAfterCopyOrCreateWorkItem> &backup_items_to_finish,
+	const std::unordered_map<std::string, std::shared_ptr<FileInfo> >
+		&shared_checksum_files,
+	const std::unordered_map<std::string, std::string>
+		&shared_checksum_names,
 	BackupID backup_id, bool shared, const std::string &src_dir,
 	const std::string &fname, RateLimiter *rate_limiter,
 	uint64_t size_bytes, uint64_t size_limit, bool shared_checksum,
-	std::function<void()> progress_callback, const std::string &contents)
+	uint64_t table_id, std::function<void()> progress_callback,
+	const std::string &contents)
 {
 	assert(!fname.empty() && fname[0] == '/');
 	assert(contents.empty() != src_dir.empty());
@@ -1406,24 +1656,58 @@ Status BackupEngineImpl::AddBackupFileWorkItem(
 	std::string dst_relative_tmp;
 	Status s;
 	uint32_t checksum_value = 0;
+	bool name_after_copy = false;
 
 	if (shared && shared_checksum) {
-		// add checksum and file length to the file name
-		s = CalculateChecksum(src_dir + fname, db_env_, size_limit,
-				      &checksum_value);
-		if (!s.ok()) {
-			return s;
-		}
 		if (size_bytes == port::kMaxUint64) {
 			return Status::NotFound("File missing: " + src_dir +
 						fname);
 		}
-		dst_relative = GetSharedFileWithChecksum(
-			dst_relative, checksum_value, size_bytes);
-		dst_relative_tmp =
-			GetSharedFileWithChecksumRel(dst_relative, true);
-		dst_relative =
-			GetSharedFileWithChecksumRel(dst_relative, false);
+		auto unchanged = shared_checksum_files.end();
+		if (table_id != 0) {
+			unchanged = shared_checksum_files.find(
+				GetSharedFileIdentity(dst_relative, size_bytes,
+						      table_id));
+		}
+		if (unchanged != shared_checksum_files.end()) {
+			// backed up before, with the checksum in the name
+			checksum_value = unchanged->second->checksum_value;
+			dst_relative_tmp = unchanged->second->filename + ".tmp";
+			dst_relative = unchanged->second->filename;
+		} else if (table_id == 0 ||
+			   shared_checksum_files.count(GetSharedFileIdentity(
+				   dst_relative, size_bytes, 0)) > 0) {
+			// The file might be one backed up without its table id
+			// or under another one, which only its checksum tells
+			s = CalculateChecksum(src_dir + fname, db_env_,
+					      size_limit, &checksum_value);
+			if (!s.ok()) {
+				return s;
+			}
+			auto same_file = shared_checksum_names.find(
+				GetSharedFileWithChecksum(dst_relative,
+							  checksum_value,
+							  size_bytes));
+			if (same_file != shared_checksum_names.end()) {
+				dst_relative = same_file->second;
+				dst_relative_tmp = dst_relative + ".tmp";
+			} else {
+				std::string dst_name =
+					GetSharedFileWithChecksum(
+						dst_relative, checksum_value,
+						size_bytes, table_id);
+				dst_relative_tmp = GetSharedFileWithChecksumRel(
+					dst_name, true);
+				dst_relative = GetSharedFileWithChecksumRel(
+					dst_name, false);
+			}
+		} else {
+			// add checksum, file length and table id to the file
+			// name once the copy computed the checksum
+			name_after_copy = true;
+			dst_relative_tmp = GetSharedFileWithChecksumRel(
+				dst_relative, true);
+		}
 	} else if (shared) {
 		dst_relative_tmp = GetSharedFileRel(dst_relative, true);
 		dst_relative = GetSharedFileRel(dst_relative, false);
@@ -1433,7 +1717,8 @@ Status BackupEngineImpl::AddBackupFileWorkItem(
 		dst_relative =
 			GetPrivateFileRel(backup_id, false, dst_relative);
 	}
-	std::string dst_path = GetAbsolutePath(dst_relative);
+	std::string dst_path =
+		name_after_copy ? "" : GetAbsolutePath(dst_relative);
 	std::string dst_path_tmp = GetAbsolutePath(dst_relative_tmp);
 
 	// if it's shared, we also need to check if it exists -- if it does, no need
@@ -1444,7 +1729,7 @@ Status BackupEngineImpl::AddBackupFileWorkItem(
 		live_dst_paths.find(dst_path) != live_dst_paths.end();
 
 	bool file_exists = false;
-	if (shared && !same_path) {
+	if (shared && !same_path && !name_after_copy) {
 		Status exist = backup_env_->FileExists(dst_path);
 		if (exist.ok()) {
 			file_exists = true;
@@ -1486,9 +1771,76 @@ Status BackupEngineImpl::AddBackupFileWorkItem(
 					      size_limit, &checksum_value);
 		}
 	}
-	live_dst_paths.insert(dst_path);
+	if (!name_after_copy) {
+		live_dst_paths.insert(dst_path);
+	}
 
-	if (!contents.empty() || need_to_copy) {
+	// Large table files are copied in chunks by the background threads in
+	// parallel, if the backup Env can write the chunks in place
+	const uint64_t chunk_size = options_.copy_chunk_size;
+	bool copy_in_chunks = false;
+	if (need_to_copy && contents.empty() && shared && chunk_size > 0 &&
+	    size_limit == 0 && size_bytes / 2 >= chunk_size) {
+		EnvOptions env_options;
+		env_options.use_mmap_writes = false;
+		unique_ptr<WritableFile> dst_file;
+		s = backup_env_->NewWritableFile(dst_path_tmp, &dst_file,
+						 env_options);
+		if (s.ok()) {
+			s = dst_file->Close();
+		}
+		if (!s.ok()) {
+			return s;
+		}
+		unique_ptr<RandomRWFile> dst_rw_file;
+		if (backup_env_->NewRandomRWFile(dst_path_tmp, &dst_rw_file,
+						 env_options)
+			    .ok()) {
+			copy_in_chunks = dst_rw_file->Close().ok();
+		}
+	}
+
+	if (copy_in_chunks) {
+		ROCKS_LOG_INFO(options_.info_log,
+			       "Copying %s to %s in chunks of %" PRIu64,
+			       fname.c_str(), dst_path_tmp.c_str(), chunk_size);
+		BackupAfterCopyOrCreateWorkItem after_copy_or_create_work_item;
+		uint64_t offset = 0;
+		while (offset < size_bytes) {
+			// the last chunk takes the remainder
+			const uint64_t length =
+				size_bytes - offset < 2 * chunk_size ?
+					size_bytes - offset :
+					chunk_size;
+			CopyOrCreateWorkItem copy_or_create_work_item(
+				src_dir + fname, dst_path_tmp, "", db_env_,
+				backup_env_, options_.sync, rate_limiter,
+				0 /* size_limit */, progress_callback);
+			copy_or_create_work_item.chunk_offset = offset;
+			copy_or_create_work_item.chunk_length = length;
+			if (offset == 0) {
+				after_copy_or_create_work_item =
+					BackupAfterCopyOrCreateWorkItem(
+						copy_or_create_work_item.result
+							.get_future(),
+						shared, need_to_copy,
+						backup_env_, dst_path_tmp,
+						dst_path, dst_relative);
+			} else {
+				auto &item = copy_or_create_work_item;
+				after_copy_or_create_work_item.chunk_results
+					.push_back(item.result.get_future());
+			}
+			offset += length;
+			files_to_copy_or_create_.write(
+				std::move(copy_or_create_work_item));
+		}
+		after_copy_or_create_work_item.name_after_copy =
+			name_after_copy;
+		after_copy_or_create_work_item.table_id = table_id;
+		backup_items_to_finish.push_back(
+			std::move(after_copy_or_create_work_item));
+	} else if (!contents.empty() || need_to_copy) {
 		ROCKS_LOG_INFO(options_.info_log, "Copying %s to %s",
 			       fname.c_str(), dst_path_tmp.c_str());
 		CopyOrCreateWorkItem copy_or_create_work_item(
@@ -1499,6 +1851,9 @@ Status BackupEngineImpl::AddBackupFileWorkItem(
 			copy_or_create_work_item.result.get_future(), shared,
 			need_to_copy, backup_env_, dst_path_tmp, dst_path,
 			dst_relative);
+		after_copy_or_create_work_item.name_after_copy =
+			name_after_copy;
+		after_copy_or_create_work_item.table_id = table_id;
 		files_to_copy_or_create_.write(
 			std::move(copy_or_create_work_item));
 		backup_items_to_finish.push_back(
@@ -1519,6 +1874,79 @@ Status BackupEngineImpl::AddBackupFileWorkItem(
 	return s;
 }
 
+Status BackupEngineImpl::CopyFileChunk(const std::string &src,
+				       const std::string &dst, Env *src_env,
+				       Env *dst_env, bool sync,
+				       RateLimiter *rate_limiter,
+				       uint64_t offset, uint64_t length,
+				       uint64_t *size, uint32_t *checksum_value,
+				       std::function<void()> progress_callback)
+{
+	*size = 0;
+	*checksum_value = 0;
+	TEST_SYNC_POINT("BackupEngineImpl::CopyFileChunk");
+	EnvOptions env_options;
+	env_options.use_mmap_writes = false;
+
+	unique_ptr<RandomAccessFile> src_file;
+	unique_ptr<RandomRWFile> dst_file;
+	Status s = src_env->NewRandomAccessFile(src, &src_file, env_options);
+	if (s.ok()) {
+		s = dst_env->NewRandomRWFile(dst, &dst_file, env_options);
+	}
+	if (!s.ok()) {
+		return s;
+	}
+
+	unique_ptr<char[]> buf(new char[copy_file_buffer_size_]);
+	Slice data;
+	uint64_t processed_buffer_size = 0;
+	while (*size < length) {
+		if (stop_backup_.load(std::memory_order_acquire)) {
+			return Status::Incomplete("Backup stopped");
+		}
+		size_t buffer_to_read =
+			static_cast<size_t>(std::min<uint64_t>(
+				copy_file_buffer_size_, length - *size));
+		s = src_file->Read(offset + *size, buffer_to_read, &data,
+				   buf.get());
+		processed_buffer_size += buffer_to_read;
+		if (!s.ok()) {
+			return s;
+		}
+		if (data.size() == 0) {
+			return Status::Corruption(
+				"File shorter than expected: " + src);
+		}
+		*checksum_value = crc32c::Extend(*checksum_value, data.data(),
+						 data.size());
+		s = dst_file->Write(offset + *size, data);
+		if (!s.ok()) {
+			return s;
+		}
+		*size += data.size();
+		if (rate_limiter != nullptr) {
+			rate_limiter->Request(data.size(), Env::IO_LOW,
+					      nullptr /* stats */);
+		}
+		if (processed_buffer_size >
+		    options_.callback_trigger_interval_size) {
+			processed_buffer_size -=
+				options_.callback_trigger_interval_size;
+			std::lock_guard<std::mutex> lock(byte_report_mutex_);
+			progress_callback();
+		}
+	}
+
+	if (sync) {
+		s = dst_file->Sync();
+	}
+	if (s.ok()) {
+		s = dst_file->Close();
+	}
+	return s;
+}
+
 Status BackupEngineImpl::CalculateChecksum(const std::string &src, Env *src_env,
 					   uint64_t size_limit,
 					   uint32_t *checksum_value)
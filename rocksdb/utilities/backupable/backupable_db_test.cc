@@ -210,6 +210,7 @@ class TestEnv : public EnvWrapper {
 				 const EnvOptions &options) override
 	{
 		MutexLock l(&mutex_);
+		read_files_.push_back(f);
 		if (dummy_sequential_file_) {
 			r->reset(new TestEnv::DummySequentialFile(
 				dummy_sequential_file_fail_reads_));
@@ -268,6 +269,25 @@ class TestEnv : public EnvWrapper {
 		written_files_.clear();
 	}
 
+	std::vector<std::string> GetWrittenFiles()
+	{
+		MutexLock l(&mutex_);
+		return written_files_;
+	}
+
+	// Files opened by NewSequentialFile()
+	std::vector<std::string> GetReadFiles()
+	{
+		MutexLock l(&mutex_);
+		return read_files_;
+	}
+
+	void ClearReadFiles()
+	{
+		MutexLock l(&mutex_);
+		read_files_.clear();
+	}
+
 	void SetLimitWrittenFiles(uint64_t limit)
 	{
 		MutexLock l(&mutex_);
@@ -383,6 +403,7 @@ class TestEnv : public EnvWrapper {
 	bool dummy_sequential_file_ = false;
 	bool dummy_sequential_file_fail_reads_ = false;
 	std::vector<std::string> written_files_;
+	std::vector<std::string> read_files_;
 	std::vector<std::string> filenames_for_mocked_attrs_;
 	uint64_t limit_written_files_ = 1000000;
 	uint64_t limit_delete_files_ = 1000000;
@@ -1260,6 +1281,175 @@ TEST_F(BackupableDBTest, ShareTableFilesWithChecksums)
 	}
 }
 
+// Verify that table files backed up before with share_files_with_checksum are
+// neither read nor copied again
+TEST_F(BackupableDBTest, ShareTableFilesWithChecksumsUnchanged)
+{
+	const int keys_iteration = 5000;
+	OpenDBAndBackupEngineShareWithChecksum(true, false, true, true);
+	FillDB(db_.get(), 0, keys_iteration);
+	ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+	std::vector<LiveFileMetaData> backed_up;
+	db_->GetLiveFilesMetaData(&backed_up);
+	ASSERT_GT(backed_up.size(), 0);
+
+	// The table files are named with their table ids
+	std::vector<std::string> children;
+	ASSERT_OK(file_manager_->GetChildren(backupdir_ + "/shared_checksum",
+					     &children));
+	for (const auto &child : children) {
+		if (child == "." || child == "..") {
+			continue;
+		}
+		ASSERT_EQ(3, std::count(child.begin(), child.end(), '_'))
+			<< child;
+	}
+
+	FillDB(db_.get(), keys_iteration, 2 * keys_iteration);
+	test_db_env_->ClearReadFiles();
+	ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+	const std::vector<std::string> read_files =
+		test_db_env_->GetReadFiles();
+	for (const auto &file : backed_up) {
+		ASSERT_EQ(read_files.end(),
+			  std::find(read_files.begin(), read_files.end(),
+				    dbname_ + file.name));
+	}
+	CloseDBAndBackupEngine();
+
+	AssertBackupConsistency(1, 0, keys_iteration, 2 * keys_iteration);
+	AssertBackupConsistency(2, 0, 2 * keys_iteration);
+}
+
+// Verify that table files keep their table ids across reopens, and that a
+// file whose id changed is read for its checksum but not copied again
+TEST_F(BackupableDBTest, ShareTableFilesWithChecksumsReopen)
+{
+	const int keys_iteration = 5000;
+	OpenDBAndBackupEngineShareWithChecksum(true, false, true, true);
+	FillDB(db_.get(), 0, keys_iteration);
+	ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+	std::vector<LiveFileMetaData> backed_up;
+	db_->GetLiveFilesMetaData(&backed_up);
+	ASSERT_GT(backed_up.size(), 0);
+	auto was_read = [&](const std::vector<std::string> &read_files) {
+		for (const auto &file : backed_up) {
+			if (std::find(read_files.begin(), read_files.end(),
+				      dbname_ + file.name) !=
+			    read_files.end()) {
+				return true;
+			}
+		}
+		return false;
+	};
+
+	// Each reopen rolls the MANIFEST over
+	CloseDBAndBackupEngine();
+	OpenDBAndBackupEngineShareWithChecksum(false, false, true, true);
+	CloseDBAndBackupEngine();
+	OpenDBAndBackupEngineShareWithChecksum(false, false, true, true);
+	test_db_env_->ClearReadFiles();
+	ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+	ASSERT_FALSE(was_read(test_db_env_->GetReadFiles()));
+
+	// A new DB identity changes the ids; the files match by name and
+	// size, and by their checksums once read
+	CloseDBAndBackupEngine();
+	ASSERT_OK(test_db_env_->DeleteFile(dbname_ + "/IDENTITY"));
+	OpenDBAndBackupEngineShareWithChecksum(false, false, true, true);
+	test_db_env_->ClearReadFiles();
+	test_backup_env_->ClearWrittenFiles();
+	ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+	ASSERT_TRUE(was_read(test_db_env_->GetReadFiles()));
+	for (const auto &file : test_backup_env_->GetWrittenFiles()) {
+		ASSERT_EQ(std::string::npos, file.find("/shared_checksum/"))
+			<< file;
+	}
+	CloseDBAndBackupEngine();
+
+	for (BackupID backup_id = 1; backup_id <= 3; ++backup_id) {
+		AssertBackupConsistency(backup_id, 0, keys_iteration,
+					2 * keys_iteration);
+	}
+}
+
+// Verify that table files of two DBs with the same keys and equally sized
+// values aren't taken for each other when backed up to the same directory
+TEST_F(BackupableDBTest, ShareTableFilesWithChecksumsTwoDBs)
+{
+	const int keys_iteration = 100;
+	OpenDBAndBackupEngineShareWithChecksum(true, false, true, true);
+	Options other_options = options_;
+	other_options.wal_dir = dbname_ + "_other";
+	DestroyDB(other_options.wal_dir, other_options);
+	DB *other_db;
+	ASSERT_OK(DB::Open(other_options, other_options.wal_dir, &other_db));
+	for (int i = 0; i < keys_iteration; ++i) {
+		std::string key = "testkey" + ToString(i);
+		ASSERT_OK(db_->Put(WriteOptions(), key, std::string(100, 'a')));
+		ASSERT_OK(other_db->Put(WriteOptions(), key,
+					std::string(100, 'b')));
+	}
+	ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+	ASSERT_OK(backup_engine_->CreateNewBackup(other_db, true));
+	delete other_db;
+	CloseDBAndBackupEngine();
+	DestroyDB(other_options.wal_dir, other_options);
+
+	OpenBackupEngine();
+	for (BackupID backup_id = 1; backup_id <= 2; ++backup_id) {
+		ASSERT_OK(backup_engine_->RestoreDBFromBackup(
+			backup_id, dbname_, dbname_));
+		DB *db = OpenDB();
+		for (int i = 0; i < keys_iteration; ++i) {
+			std::string key = "testkey" + ToString(i);
+			std::string value;
+			ASSERT_OK(db->Get(ReadOptions(), key, &value));
+			ASSERT_EQ(std::string(100, backup_id == 1 ? 'a' : 'b'),
+				  value);
+		}
+		delete db;
+	}
+	CloseBackupEngine();
+}
+
+// Verify that large table files copied in chunks are restored intact, with
+// the checksum combined from those of the chunks
+TEST_F(BackupableDBTest, CopyInChunks)
+{
+	const int keys_iteration = 5000;
+	std::atomic<int> num_chunks(0);
+	rocksdb::SyncPoint::GetInstance()->SetCallBack(
+		"BackupEngineImpl::CopyFileChunk",
+		[&](void *arg) { num_chunks++; });
+	rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+	for (bool share_with_checksums : { false, true }) {
+		DestroyDB(dbname_, options_);
+		backupable_options_->copy_chunk_size = 4096;
+		backupable_options_->share_files_with_checksum =
+			share_with_checksums;
+		OpenDBAndBackupEngine(true);
+		for (int i = 0; i < 3; ++i) {
+			FillDB(db_.get(), keys_iteration * i,
+			       keys_iteration * (i + 1));
+			ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(),
+								  true));
+			ASSERT_OK(backup_engine_->VerifyBackup(i + 1));
+		}
+		CloseDBAndBackupEngine();
+		ASSERT_GT(num_chunks.load(), 0);
+		num_chunks = 0;
+
+		for (int i = 0; i < 3; ++i) {
+			AssertBackupConsistency(i + 1, 0,
+						keys_iteration * (i + 1),
+						keys_iteration * 4);
+		}
+	}
+	rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+	rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 // Verify that you can backup and restore using share_files_with_checksum set to
 // false and then transition this option to true
 TEST_F(BackupableDBTest, ShareTableFilesWithChecksumsTransition)
@@ -29,6 +29,7 @@
 #include "util/file_reader_writer.h"
 #include "util/filename.h"
 #include "util/random.h"
+#include "util/sst_file_manager_impl.h"
 #include "util/timer_queue.h"
 #include "utilities/transactions/optimistic_transaction_db_impl.h"
 #include "utilities/transactions/optimistic_transaction_impl.h"
@@ -2238,7 +2239,14 @@ std::pair<bool, int64_t> BlobDBImpl::DeleteObsFiles(bool aborted)
 			}
 		}
 
-		Status s = myenv_->DeleteFile(bfile->PathName());
+		// Go through the SstFileManager, if any, so that blob files
+		// are throttled and accounted for like table files
+		auto sfm = static_cast<SstFileManagerImpl *>(
+			db_options_.sst_file_manager.get());
+		const std::string &path = bfile->PathName();
+		Status s = (sfm && bdb_options_.path_relative) ?
+				   sfm->ScheduleFileDeletion(path) :
+				   myenv_->DeleteFile(path);
 		if (!s.ok()) {
 			Log(InfoLogLevel::ERROR_LEVEL, db_options_.info_log,
 			    "File failed to be deleted as obsolete %s",
@@ -2543,6 +2551,30 @@ Status BlobDBImpl::TEST_GetSequenceNumber(const Slice &key,
 		DefaultColumnFamily());
 	return CommonGet(cfh->cfd(), key, index_entry, nullptr, sequence);
 }
+
+std::vector<std::shared_ptr<BlobFile> > BlobDBImpl::TEST_GetBlobFiles()
+{
+	ReadLock rl(&mutex_);
+	std::vector<std::shared_ptr<BlobFile> > blob_files;
+	for (auto &p : blob_files_) {
+		blob_files.push_back(p.second);
+	}
+	return blob_files;
+}
+
+void BlobDBImpl::TEST_ObsoleteFile(std::shared_ptr<BlobFile> bfile)
+{
+	CloseSeqWrite(bfile, false);
+	WriteLock wl(&mutex_);
+	blob_files_.erase(bfile->BlobFileNumber());
+	bfile->SetCanBeDeleted();
+	obsolete_files_.push_front(bfile);
+}
+
+void BlobDBImpl::TEST_DeleteObsoleteFiles()
+{
+	DeleteObsFiles(false);
+}
 #endif //  !NDEBUG
 
 } // namespace blob_db
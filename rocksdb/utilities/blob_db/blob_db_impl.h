@@ -228,6 +228,14 @@ class BlobDBImpl : public BlobDB {
 #ifndef NDEBUG
 	Status TEST_GetSequenceNumber(const Slice &key,
 				      SequenceNumber *sequence);
+
+	std::vector<std::shared_ptr<BlobFile> > TEST_GetBlobFiles();
+
+	// Close bfile and hand it to the obsolete file deletion, as garbage
+	// collection does once a file has no live blobs left
+	void TEST_ObsoleteFile(std::shared_ptr<BlobFile> bfile);
+
+	void TEST_DeleteObsoleteFiles();
 #endif //  !NDEBUG
 
     private:
@@ -18,6 +18,7 @@
 #include <inttypes.h>
 #include <algorithm>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "db/wal_manager.h"
@@ -44,6 +45,13 @@ Status Checkpoint::CreateCheckpoint(const std::string &checkpoint_dir,
 	return Status::NotSupported("");
 }
 
+Status
+Checkpoint::CreateIncrementalCheckpoint(const std::string &checkpoint_dir,
+					uint64_t log_size_for_flush)
+{
+	return Status::NotSupported("");
+}
+
 // Builds an openable snapshot of RocksDB
 Status CheckpointImpl::CreateCheckpoint(const std::string &checkpoint_dir,
 					uint64_t log_size_for_flush)
@@ -149,6 +157,175 @@ Status CheckpointImpl::CreateCheckpoint(const std::string &checkpoint_dir,
 	return s;
 }
 
+// Updates the checkpoint in place. New files are added next to the old ones,
+// the MANIFEST, OPTIONS and CURRENT files are written to temporary files,
+// which are renamed with CURRENT last, and only then are the files no longer
+// needed deleted, so the checkpoint stays consistent throughout.
+Status
+CheckpointImpl::CreateIncrementalCheckpoint(const std::string &checkpoint_dir,
+					    uint64_t log_size_for_flush)
+{
+	DBOptions db_options = db_->GetDBOptions();
+	Env *env = db_->GetEnv();
+
+	Status s = env->FileExists(checkpoint_dir);
+	if (s.IsNotFound()) {
+		return CreateCheckpoint(checkpoint_dir, log_size_for_flush);
+	} else if (!s.ok()) {
+		return s;
+	}
+
+	ROCKS_LOG_INFO(db_options.info_log,
+		       "Started the incremental snapshot process -- updating "
+		       "snapshot in directory %s",
+		       checkpoint_dir.c_str());
+	// the files of the previous checkpoint, named as the callbacks get them
+	std::unordered_set<std::string> old_files;
+	std::vector<std::string> children;
+	s = env->GetChildren(checkpoint_dir, &children);
+	if (!s.ok()) {
+		return s;
+	}
+	for (const auto &child : children) {
+		uint64_t number;
+		FileType type;
+		if (ParseFileName(child, &number, &type) &&
+		    (type == kTableFile || type == kLogFile ||
+		     type == kDescriptorFile || type == kOptionsFile)) {
+			old_files.insert("/" + child);
+		}
+	}
+
+	std::unordered_set<std::string> new_files;
+	// written as fname + ".tmp", to be renamed at the end
+	std::vector<std::string> staged_files;
+	std::string current_fname;
+	// Brings a copy of a WAL file that has grown since up to date. The
+	// copy is the same file if it was hard-linked.
+	auto update_wal_file = [&](const std::string &src,
+				   const std::string &fname,
+				   uint64_t size_limit_bytes) {
+		uint64_t src_size = size_limit_bytes;
+		uint64_t dst_size = 0;
+		Status st = env->GetFileSize(checkpoint_dir + fname, &dst_size);
+		if (st.ok() && src_size == 0) {
+			st = env->GetFileSize(src, &src_size);
+		}
+		if (!st.ok() || dst_size == src_size) {
+			return st;
+		}
+		ROCKS_LOG_INFO(db_options.info_log,
+			       "Copying %s from %" PRIu64, fname.c_str(),
+			       dst_size);
+		if (dst_size < src_size) {
+			return AppendFileTail(env, src, checkpoint_dir + fname,
+					      dst_size, src_size,
+					      db_options.use_fsync);
+		}
+		return CopyFile(env, src, checkpoint_dir + fname, src_size,
+				db_options.use_fsync);
+	};
+
+	uint64_t sequence_number = 0;
+	db_->DisableFileDeletions();
+	s = CreateCustomCheckpoint(
+		db_options,
+		[&](const std::string &src_dirname, const std::string &fname,
+		    FileType type) {
+			new_files.insert(fname);
+			if (old_files.count(fname) > 0) {
+				if (type == kLogFile) {
+					return update_wal_file(
+						src_dirname + fname, fname, 0);
+				}
+				return Status::OK();
+			}
+			ROCKS_LOG_INFO(db_options.info_log, "Hard Linking %s",
+				       fname.c_str());
+			return env->LinkFile(src_dirname + fname,
+					     checkpoint_dir + fname);
+		} /* link_file_cb */,
+		[&](const std::string &src_dirname, const std::string &fname,
+		    uint64_t size_limit_bytes, FileType type) {
+			new_files.insert(fname);
+			std::string dst = checkpoint_dir + fname;
+			if (old_files.count(fname) > 0) {
+				if (type == kLogFile) {
+					return update_wal_file(
+						src_dirname + fname, fname,
+						size_limit_bytes);
+				} else if (type == kTableFile) {
+					return Status::OK();
+				}
+			}
+			if (type != kLogFile && type != kTableFile) {
+				staged_files.push_back(fname);
+				dst += ".tmp";
+			}
+			ROCKS_LOG_INFO(db_options.info_log, "Copying %s",
+				       fname.c_str());
+			return CopyFile(env, src_dirname + fname, dst,
+					size_limit_bytes, db_options.use_fsync);
+		} /* copy_file_cb */,
+		[&](const std::string &fname, const std::string &contents,
+		    FileType) {
+			ROCKS_LOG_INFO(db_options.info_log, "Creating %s",
+				       fname.c_str());
+			new_files.insert(fname);
+			current_fname = fname;
+			return WriteStringToFile(
+				env, contents, checkpoint_dir + fname + ".tmp",
+				true /* should_sync */);
+		} /* create_file_cb */,
+		&sequence_number, log_size_for_flush);
+	// we copied all the files, enable file deletions
+	db_->EnableFileDeletions(false);
+
+	if (s.ok() && current_fname.empty()) {
+		s = Status::Corruption("No CURRENT file to checkpoint");
+	}
+	if (s.ok()) {
+		// CURRENT last, as it switches the checkpoint to the new files
+		staged_files.push_back(current_fname);
+	}
+	for (size_t i = 0; s.ok() && i < staged_files.size(); ++i) {
+		s = env->RenameFile(checkpoint_dir + staged_files[i] + ".tmp",
+				    checkpoint_dir + staged_files[i]);
+	}
+	if (s.ok()) {
+		unique_ptr<Directory> checkpoint_directory;
+		env->NewDirectory(checkpoint_dir, &checkpoint_directory);
+		if (checkpoint_directory != nullptr) {
+			s = checkpoint_directory->Fsync();
+		}
+	}
+
+	if (s.ok()) {
+		for (const auto &fname : old_files) {
+			if (new_files.count(fname) == 0) {
+				Status s1 = env->DeleteFile(checkpoint_dir +
+							    fname);
+				ROCKS_LOG_INFO(db_options.info_log,
+					       "Delete file %s -- %s",
+					       fname.c_str(),
+					       s1.ToString().c_str());
+			}
+		}
+		ROCKS_LOG_INFO(db_options.info_log,
+			       "Incremental snapshot DONE. All is good");
+		ROCKS_LOG_INFO(db_options.info_log,
+			       "Snapshot sequence number: %" PRIu64,
+			       sequence_number);
+	} else {
+		// the previous checkpoint is left as it was, but for added
+		// files it doesn't refer to
+		ROCKS_LOG_INFO(db_options.info_log,
+			       "Incremental snapshot failed -- %s",
+			       s.ToString().c_str());
+	}
+	return s;
+}
+
 Status CheckpointImpl::CreateCustomCheckpoint(
 	const DBOptions &db_options,
 	std::function<Status(const std::string &src_dirname,
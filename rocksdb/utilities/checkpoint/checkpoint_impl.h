@@ -32,6 +32,11 @@ class CheckpointImpl : public Checkpoint {
 	virtual Status CreateCheckpoint(const std::string &checkpoint_dir,
 					uint64_t log_size_for_flush) override;
 
+	using Checkpoint::CreateIncrementalCheckpoint;
+	virtual Status
+	CreateIncrementalCheckpoint(const std::string &checkpoint_dir,
+				    uint64_t log_size_for_flush) override;
+
 	// Checkpoint logic can be customized by providing callbacks for link, copy,
 	// or create.
 	Status CreateCustomCheckpoint(
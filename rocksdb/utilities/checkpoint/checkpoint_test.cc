@@ -23,6 +23,8 @@
 #include "rocksdb/env.h"
 #include "rocksdb/utilities/checkpoint.h"
 #include "rocksdb/utilities/transaction_db.h"
+#include "util/filename.h"
+#include "util/string_util.h"
 #include "util/sync_point.h"
 #include "util/testharness.h"
 
@@ -385,6 +387,96 @@ TEST_F(CheckpointTest, CheckpointCF)
 	ASSERT_OK(DestroyDB(snapshot_name, options));
 }
 
+TEST_F(CheckpointTest, IncrementalCheckpoint)
+{
+	Options options = CurrentOptions();
+	const std::string snapshot_name = test::TmpDir(env_) + "/snapshot";
+	ASSERT_OK(DestroyDB(snapshot_name, options));
+	env_->DeleteDir(snapshot_name);
+
+	// Opens the snapshot read-only, which leaves it as it is
+	auto verify_snapshot = [&](int num_keys) {
+		DB *snapshotDB;
+		std::string result;
+		ASSERT_OK(DB::OpenForReadOnly(options, snapshot_name,
+					      &snapshotDB));
+		for (int i = 0; i < num_keys; i++) {
+			ASSERT_OK(snapshotDB->Get(ReadOptions(),
+						  "key" + ToString(i),
+						  &result));
+			ASSERT_EQ("value" + ToString(i), result);
+		}
+		delete snapshotDB;
+	};
+	auto put_keys = [&](int from, int to) {
+		for (int i = from; i < to; i++) {
+			ASSERT_OK(Put("key" + ToString(i),
+				      "value" + ToString(i)));
+		}
+	};
+
+	Checkpoint *checkpoint;
+	ASSERT_OK(Checkpoint::Create(db_, &checkpoint));
+	// Without a previous checkpoint, a full one
+	put_keys(0, 10);
+	ASSERT_OK(checkpoint->CreateIncrementalCheckpoint(snapshot_name,
+							  1000000));
+	verify_snapshot(10);
+
+	// The keys added since are only in the WAL, whose tail is copied
+	uint64_t wal_size = 0;
+	std::vector<std::string> children;
+	ASSERT_OK(env_->GetChildren(snapshot_name, &children));
+	std::string wal_fname;
+	for (const auto &child : children) {
+		uint64_t number;
+		FileType type;
+		if (ParseFileName(child, &number, &type) && type == kLogFile) {
+			wal_fname = snapshot_name + "/" + child;
+		}
+	}
+	ASSERT_FALSE(wal_fname.empty());
+	ASSERT_OK(env_->GetFileSize(wal_fname, &wal_size));
+	put_keys(10, 20);
+	ASSERT_OK(checkpoint->CreateIncrementalCheckpoint(snapshot_name,
+							  1000000));
+	uint64_t new_wal_size = 0;
+	ASSERT_OK(env_->GetFileSize(wal_fname, &new_wal_size));
+	ASSERT_GT(new_wal_size, wal_size);
+	verify_snapshot(20);
+
+	// New SST files are added, and those compacted away deleted
+	put_keys(20, 30);
+	ASSERT_OK(Flush());
+	put_keys(30, 40);
+	ASSERT_OK(Flush());
+	ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+	ASSERT_OK(checkpoint->CreateIncrementalCheckpoint(snapshot_name));
+	verify_snapshot(40);
+
+	std::vector<LiveFileMetaData> live_files;
+	db_->GetLiveFilesMetaData(&live_files);
+	std::set<std::string> live_tables;
+	for (const auto &file : live_files) {
+		live_tables.insert(file.name.substr(1));
+	}
+	std::set<std::string> snapshot_tables;
+	children.clear();
+	ASSERT_OK(env_->GetChildren(snapshot_name, &children));
+	for (const auto &child : children) {
+		uint64_t number;
+		FileType type;
+		if (ParseFileName(child, &number, &type) &&
+		    type == kTableFile) {
+			snapshot_tables.insert(child);
+		}
+	}
+	ASSERT_EQ(live_tables, snapshot_tables);
+
+	delete checkpoint;
+	ASSERT_OK(DestroyDB(snapshot_name, options));
+}
+
 TEST_F(CheckpointTest, CheckpointCFNoFlush)
 {
 	Options options = CurrentOptions();
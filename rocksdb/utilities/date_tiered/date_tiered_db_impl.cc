@@ -5,6 +5,7 @@
 
 #include "utilities/date_tiered/date_tiered_db_impl.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "db/db_impl.h"
@@ -28,12 +29,13 @@ DateTieredDBImpl::DateTieredDBImpl(
 	DB *db, Options options,
 	const std::vector<ColumnFamilyDescriptor> &descriptors,
 	const std::vector<ColumnFamilyHandle *> &handles, int64_t ttl,
-	int64_t column_family_interval)
+	int64_t column_family_interval, bool read_only)
 	: db_(db), cf_options_(ColumnFamilyOptions(options)),
 	  ioptions_(ImmutableCFOptions(options)), ttl_(ttl),
 	  column_family_interval_(column_family_interval),
 	  mutex_(options.statistics.get(), db->GetEnv(), DB_MUTEX_WAIT_MICROS,
-		 options.use_adaptive_mutex)
+		 options.use_adaptive_mutex),
+	  bg_cv_(&mutex_), closing_(false)
 {
 	latest_timebound_ = std::numeric_limits<int64_t>::min();
 	for (size_t i = 0; i < handles.size(); ++i) {
@@ -49,15 +51,45 @@ DateTieredDBImpl::DateTieredDBImpl(
 		if (timestamp > latest_timebound_) {
 			latest_timebound_ = timestamp;
 		}
-		handle_map_.insert(std::make_pair(timestamp, handles[i]));
+		TimeWindow window;
+		window.handle.reset(handles[i],
+				    [db](ColumnFamilyHandle *handle) {
+					    db->DestroyColumnFamilyHandle(
+						    handle);
+				    });
+		// The key bounds are not stored, but those of the keys left
+		// are as good
+		std::unique_ptr<Iterator> iter(
+			db_->NewIterator(ReadOptions(), handles[i]));
+		iter->SeekToFirst();
+		if (iter->Valid()) {
+			window.smallest_key = iter->key().ToString();
+			iter->SeekToLast();
+			window.largest_key = iter->key().ToString();
+		}
+		handle_map_.insert(std::make_pair(timestamp, window));
+	}
+	{
+		InstrumentedMutexLock l(&mutex_);
+		UpdateEarliestDropTime();
+	}
+	if (!read_only) {
+		bg_thread_.reset(new port::Thread(
+			&DateTieredDBImpl::BackgroundThread, this));
 	}
 }
 
 DateTieredDBImpl::~DateTieredDBImpl()
 {
-	for (auto handle : handle_map_) {
-		db_->DestroyColumnFamilyHandle(handle.second);
+	if (bg_thread_) {
+		{
+			InstrumentedMutexLock l(&mutex_);
+			closing_ = true;
+			bg_cv_.SignalAll();
+		}
+		bg_thread_->join();
 	}
+	handle_map_.clear();
 	delete db_;
 	db_ = nullptr;
 }
@@ -100,7 +132,8 @@ Status DateTieredDB::Open(const Options &options, const std::string &dbname,
 
 	if (s.ok()) {
 		*dbptr = new DateTieredDBImpl(db, options, descriptors, handles,
-					      ttl, column_family_interval);
+					      ttl, column_family_interval,
+					      read_only);
 	}
 	return s;
 }
@@ -120,8 +153,16 @@ bool DateTieredDBImpl::IsStale(int64_t keytime, int64_t ttl, Env *env)
 	return curtime >= keytime + ttl;
 }
 
+void DateTieredDBImpl::UpdateEarliestDropTime()
+{
+	mutex_.AssertHeld();
+	earliest_drop_time_.store(handle_map_.empty() ?
+					  std::numeric_limits<int64_t>::max() :
+					  handle_map_.begin()->first + ttl_,
+				  std::memory_order_relaxed);
+}
+
 // Drop column family when all data in that column family is expired
-// TODO(jhli): Can be made a background job
 Status DateTieredDBImpl::DropObsoleteColumnFamilies()
 {
 	int64_t curtime;
@@ -130,25 +171,58 @@ Status DateTieredDBImpl::DropObsoleteColumnFamilies()
 	if (!s.ok()) {
 		return s;
 	}
+	// Dropped out of the mutex, as it writes the MANIFEST
+	std::vector<std::pair<int64_t, TimeWindow> > windows;
 	{
 		InstrumentedMutexLock l(&mutex_);
 		auto iter = handle_map_.begin();
-		while (iter != handle_map_.end()) {
-			if (iter->first <= curtime - ttl_) {
-				s = db_->DropColumnFamily(iter->second);
-				if (!s.ok()) {
-					return s;
-				}
-				delete iter->second;
-				iter = handle_map_.erase(iter);
-			} else {
-				break;
-			}
+		while (iter != handle_map_.end() &&
+		       iter->first <= curtime - ttl_) {
+			windows.push_back(*iter);
+			iter = handle_map_.erase(iter);
+		}
+		UpdateEarliestDropTime();
+	}
+	for (size_t i = 0; i < windows.size(); ++i) {
+		s = db_->DropColumnFamily(windows[i].second.handle.get());
+		if (!s.ok()) {
+			// Put back those not dropped, to retry
+			InstrumentedMutexLock l(&mutex_);
+			handle_map_.insert(windows.begin() + i, windows.end());
+			UpdateEarliestDropTime();
+			return s;
 		}
 	}
 	return Status::OK();
 }
 
+void DateTieredDBImpl::MaybeDropObsoleteColumnFamilies()
+{
+	int64_t curtime;
+	if (db_->GetEnv()->GetCurrentTime(&curtime).ok() &&
+	    curtime >= earliest_drop_time_.load(std::memory_order_relaxed)) {
+		InstrumentedMutexLock l(&mutex_);
+		bg_cv_.Signal();
+	}
+}
+
+void DateTieredDBImpl::BackgroundThread()
+{
+	// Also checks once per time window, for a db no longer written to
+	const uint64_t period_micros =
+		std::max<int64_t>(column_family_interval_, 1) * 1000000;
+	InstrumentedMutexLock l(&mutex_);
+	while (!closing_) {
+		bg_cv_.TimedWait(db_->GetEnv()->NowMicros() + period_micros);
+		if (closing_) {
+			break;
+		}
+		mutex_.Unlock();
+		DropObsoleteColumnFamilies();
+		mutex_.Lock();
+	}
+}
+
 // Get timestamp from user key
 Status DateTieredDBImpl::GetTimestamp(const Slice &key, int64_t *result)
 {
@@ -172,7 +246,7 @@ Status DateTieredDBImpl::GetTimestamp(const Slice &key, int64_t *result)
 	return Status::OK();
 }
 
-Status DateTieredDBImpl::CreateColumnFamily(ColumnFamilyHandle **column_family)
+Status DateTieredDBImpl::CreateColumnFamily(WindowMap::iterator *window)
 {
 	int64_t curtime;
 	Status s;
@@ -192,32 +266,58 @@ Status DateTieredDBImpl::CreateColumnFamily(ColumnFamilyHandle **column_family)
 	}
 	std::string cf_name = ToString(new_timebound);
 	latest_timebound_ = new_timebound;
-	s = db_->CreateColumnFamily(cf_options_, cf_name, column_family);
+	ColumnFamilyHandle *column_family;
+	s = db_->CreateColumnFamily(cf_options_, cf_name, &column_family);
 	if (s.ok()) {
-		handle_map_.insert(
-			std::make_pair(new_timebound, *column_family));
+		DB *db = db_;
+		TimeWindow new_window;
+		new_window.handle.reset(column_family,
+					[db](ColumnFamilyHandle *handle) {
+						db->DestroyColumnFamilyHandle(
+							handle);
+					});
+		*window = handle_map_.insert(std::make_pair(new_timebound,
+							    new_window))
+				  .first;
+		UpdateEarliestDropTime();
 	}
 	return s;
 }
 
-Status DateTieredDBImpl::FindColumnFamily(int64_t keytime,
-					  ColumnFamilyHandle **column_family,
-					  bool create_if_missing)
+Status DateTieredDBImpl::FindColumnFamily(
+	int64_t keytime, const Slice &key, bool for_write,
+	std::shared_ptr<ColumnFamilyHandle> *column_family)
 {
-	*column_family = nullptr;
-	{
-		InstrumentedMutexLock l(&mutex_);
-		auto iter = handle_map_.upper_bound(keytime);
-		if (iter == handle_map_.end()) {
-			if (!create_if_missing) {
-				return Status::NotFound();
-			} else {
-				return CreateColumnFamily(column_family);
-			}
+	column_family->reset();
+	InstrumentedMutexLock l(&mutex_);
+	auto iter = handle_map_.upper_bound(keytime);
+	if (iter == handle_map_.end()) {
+		if (!for_write) {
+			return Status::NotFound();
+		}
+		Status s = CreateColumnFamily(&iter);
+		if (!s.ok()) {
+			return s;
+		}
+	}
+	TimeWindow &window = iter->second;
+	const Comparator *ucmp = cf_options_.comparator;
+	if (for_write) {
+		if (window.smallest_key.empty() ||
+		    ucmp->Compare(key, window.smallest_key) < 0) {
+			window.smallest_key.assign(key.data(), key.size());
+		}
+		if (window.largest_key.empty() ||
+		    ucmp->Compare(key, window.largest_key) > 0) {
+			window.largest_key.assign(key.data(), key.size());
 		}
-		// Move to previous element to get the appropriate time window
-		*column_family = iter->second;
+	} else if (window.smallest_key.empty() ||
+		   ucmp->Compare(key, window.smallest_key) < 0 ||
+		   ucmp->Compare(key, window.largest_key) > 0) {
+		// The key was never written to the window
+		return Status::OK();
 	}
+	*column_family = window.handle;
 	return Status::OK();
 }
 
@@ -230,7 +330,7 @@ Status DateTieredDBImpl::Put(const WriteOptions &options, const Slice &key,
 	if (!s.ok()) {
 		return s;
 	}
-	DropObsoleteColumnFamilies();
+	MaybeDropObsoleteColumnFamilies();
 
 	// Prune request to obsolete data
 	if (IsStale(timestamp, ttl_, db_->GetEnv())) {
@@ -238,16 +338,16 @@ Status DateTieredDBImpl::Put(const WriteOptions &options, const Slice &key,
 	}
 
 	// Decide column family (i.e. the time window) to put into
-	ColumnFamilyHandle *column_family;
-	s = FindColumnFamily(timestamp, &column_family,
-			     true /*create_if_missing*/);
+	std::shared_ptr<ColumnFamilyHandle> column_family;
+	s = FindColumnFamily(timestamp, key, true /*for_write*/,
+			     &column_family);
 	if (!s.ok()) {
 		return s;
 	}
 
 	// Efficiently put with WriteBatch
 	WriteBatch batch;
-	batch.Put(column_family, key, val);
+	batch.Put(column_family.get(), key, val);
 	return Write(options, &batch);
 }
 
@@ -266,9 +366,9 @@ Status DateTieredDBImpl::Get(const ReadOptions &options, const Slice &key,
 	}
 
 	// Decide column family to get from
-	ColumnFamilyHandle *column_family;
-	s = FindColumnFamily(timestamp, &column_family,
-			     false /*create_if_missing*/);
+	std::shared_ptr<ColumnFamilyHandle> column_family;
+	s = FindColumnFamily(timestamp, key, false /*for_write*/,
+			     &column_family);
 	if (!s.ok()) {
 		return s;
 	}
@@ -278,7 +378,7 @@ Status DateTieredDBImpl::Get(const ReadOptions &options, const Slice &key,
 	}
 
 	// Get value with key
-	return db_->Get(options, column_family, key, value);
+	return db_->Get(options, column_family.get(), key, value);
 }
 
 bool DateTieredDBImpl::KeyMayExist(const ReadOptions &options, const Slice &key,
@@ -292,9 +392,9 @@ bool DateTieredDBImpl::KeyMayExist(const ReadOptions &options, const Slice &key,
 		return false;
 	}
 	// Decide column family to get from
-	ColumnFamilyHandle *column_family;
-	s = FindColumnFamily(timestamp, &column_family,
-			     false /*create_if_missing*/);
+	std::shared_ptr<ColumnFamilyHandle> column_family;
+	s = FindColumnFamily(timestamp, key, false /*for_write*/,
+			     &column_family);
 	if (!s.ok() || column_family == nullptr) {
 		// Cannot find column family
 		return false;
@@ -302,7 +402,7 @@ bool DateTieredDBImpl::KeyMayExist(const ReadOptions &options, const Slice &key,
 	if (IsStale(timestamp, ttl_, db_->GetEnv())) {
 		return false;
 	}
-	return db_->KeyMayExist(options, column_family, key, value,
+	return db_->KeyMayExist(options, column_family.get(), key, value,
 				value_found);
 }
 
@@ -314,26 +414,26 @@ Status DateTieredDBImpl::Delete(const WriteOptions &options, const Slice &key)
 	if (!s.ok()) {
 		return s;
 	}
-	DropObsoleteColumnFamilies();
+	MaybeDropObsoleteColumnFamilies();
 	// Prune request to obsolete data
 	if (IsStale(timestamp, ttl_, db_->GetEnv())) {
 		return Status::NotFound();
 	}
 
 	// Decide column family to get from
-	ColumnFamilyHandle *column_family;
-	s = FindColumnFamily(timestamp, &column_family,
-			     false /*create_if_missing*/);
+	std::shared_ptr<ColumnFamilyHandle> column_family;
+	s = FindColumnFamily(timestamp, key, false /*for_write*/,
+			     &column_family);
 	if (!s.ok()) {
 		return s;
 	}
 	if (column_family == nullptr) {
-		// Cannot find column family
-		return Status::NotFound();
+		// The key was never written, so there is nothing to delete
+		return Status::OK();
 	}
 
 	// Get value with key
-	return db_->Delete(options, column_family, key);
+	return db_->Delete(options, column_family.get(), key);
 }
 
 Status DateTieredDBImpl::Merge(const WriteOptions &options, const Slice &key,
@@ -347,14 +447,14 @@ Status DateTieredDBImpl::Merge(const WriteOptions &options, const Slice &key,
 		// Cannot get current time
 		return s;
 	}
-	ColumnFamilyHandle *column_family;
-	s = FindColumnFamily(timestamp, &column_family,
-			     true /*create_if_missing*/);
+	std::shared_ptr<ColumnFamilyHandle> column_family;
+	s = FindColumnFamily(timestamp, key, true /*for_write*/,
+			     &column_family);
 	if (!s.ok()) {
 		return s;
 	}
 	WriteBatch batch;
-	batch.Merge(column_family, key, value);
+	batch.Merge(column_family.get(), key, value);
 	return Write(options, &batch);
 }
 
@@ -406,7 +506,42 @@ Status DateTieredDBImpl::Write(const WriteOptions &opts, WriteBatch *updates)
 
 Iterator *DateTieredDBImpl::NewIterator(const ReadOptions &opts)
 {
-	if (handle_map_.empty()) {
+	return NewIteratorOverWindows(opts,
+				      std::numeric_limits<int64_t>::min(),
+				      std::numeric_limits<int64_t>::max());
+}
+
+Iterator *DateTieredDBImpl::NewIterator(const ReadOptions &opts,
+					int64_t start_time, int64_t end_time)
+{
+	return NewIteratorOverWindows(opts, start_time, end_time);
+}
+
+Iterator *DateTieredDBImpl::NewIteratorOverWindows(const ReadOptions &opts,
+						   int64_t start_time,
+						   int64_t end_time)
+{
+	const Comparator *ucmp = cf_options_.comparator;
+	std::vector<std::shared_ptr<ColumnFamilyHandle> > handles;
+	{
+		InstrumentedMutexLock l(&mutex_);
+		// The windows before have keys older than start_time, and
+		// those after the first ending from end_time newer than it
+		for (auto iter = handle_map_.upper_bound(start_time);
+		     iter != handle_map_.end(); ++iter) {
+			const TimeWindow &window = iter->second;
+			if (!window.smallest_key.empty() &&
+			    (opts.iterate_upper_bound == nullptr ||
+			     ucmp->Compare(window.smallest_key,
+					   *opts.iterate_upper_bound) < 0)) {
+				handles.push_back(window.handle);
+			}
+			if (iter->first >= end_time) {
+				break;
+			}
+		}
+	}
+	if (handles.empty()) {
 		return NewEmptyIterator();
 	}
 
@@ -419,10 +554,9 @@ Iterator *DateTieredDBImpl::NewIterator(const ReadOptions &opts)
 
 	auto arena = db_iter->GetArena();
 	MergeIteratorBuilder builder(cf_options_.comparator, arena);
-	for (auto &item : handle_map_) {
-		auto handle = item.second;
+	for (auto &handle : handles) {
 		builder.AddIterator(db_impl->NewInternalIterator(
-			arena, db_iter->GetRangeDelAggregator(), handle));
+			arena, db_iter->GetRangeDelAggregator(), handle.get()));
 	}
 	auto internal_iter = builder.Finish();
 	db_iter->SetIterUnderDBIter(internal_iter);
@@ -6,12 +6,15 @@
 #pragma once
 #ifndef ROCKSDB_LITE
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "monitoring/instrumented_mutex.h"
 #include "options/cf_options.h"
+#include "port/port.h"
 #include "rocksdb/db.h"
 #include "rocksdb/utilities/date_tiered_db.h"
 
@@ -23,7 +26,8 @@ class DateTieredDBImpl : public DateTieredDB {
 	DateTieredDBImpl(DB *db, Options options,
 			 const std::vector<ColumnFamilyDescriptor> &descriptors,
 			 const std::vector<ColumnFamilyHandle *> &handles,
-			 int64_t ttl, int64_t column_family_interval);
+			 int64_t ttl, int64_t column_family_interval,
+			 bool read_only);
 
 	virtual ~DateTieredDBImpl();
 
@@ -44,12 +48,26 @@ class DateTieredDBImpl : public DateTieredDB {
 
 	Iterator *NewIterator(const ReadOptions &opts) override;
 
+	Iterator *NewIterator(const ReadOptions &opts, int64_t start_time,
+			      int64_t end_time) override;
+
 	Status DropObsoleteColumnFamilies() override;
 
 	// Extract timestamp from key.
 	static Status GetTimestamp(const Slice &key, int64_t *result);
 
     private:
+	// A column family holding the keys of a time range
+	struct TimeWindow {
+		std::shared_ptr<ColumnFamilyHandle> handle;
+		// Bounds of the keys ever written to the column family, empty
+		// if none was
+		std::string smallest_key;
+		std::string largest_key;
+	};
+
+	typedef std::map<int64_t, TimeWindow> WindowMap;
+
 	// Base database object
 	DB *db_;
 
@@ -60,8 +78,13 @@ class DateTieredDBImpl : public DateTieredDB {
 	// Storing all column family handles for time series data.
 	std::vector<ColumnFamilyHandle *> handles_;
 
-	// Manages a mapping from a column family's maximum timestamp to its handle.
-	std::map<int64_t, ColumnFamilyHandle *> handle_map_;
+	// Manages a mapping from a column family's maximum timestamp to its
+	// window. The keys of a window have timestamps from the maximum of the
+	// previous one.
+	WindowMap handle_map_;
+
+	// When the first column family expires, so is to be dropped.
+	std::atomic<int64_t> earliest_drop_time_;
 
 	// A time-to-live value to indicate when the data should be removed.
 	int64_t ttl_;
@@ -75,14 +98,38 @@ class DateTieredDBImpl : public DateTieredDB {
 	// Mutex to protect handle_map_ operations.
 	InstrumentedMutex mutex_;
 
+	// Signaled to have the background thread drop the expired column
+	// families, or stop.
+	InstrumentedCondVar bg_cv_;
+
+	bool closing_;
+
+	// Drops the expired column families, none for a read-only db.
+	std::unique_ptr<port::Thread> bg_thread_;
+
 	// Internal method to execute Put and Merge in batch.
 	Status Write(const WriteOptions &opts, WriteBatch *updates);
 
-	Status CreateColumnFamily(ColumnFamilyHandle **column_family);
+	Status CreateColumnFamily(WindowMap::iterator *window);
+
+	// Finds the column family of the time window of keytime. Writes
+	// create it if missing and extend its key bounds with key. Reads find
+	// none if key is out of its key bounds.
+	Status FindColumnFamily(
+		int64_t keytime, const Slice &key, bool for_write,
+		std::shared_ptr<ColumnFamilyHandle> *column_family);
+
+	void UpdateEarliestDropTime();
+
+	// Wakes up the background thread if a column family has expired.
+	void MaybeDropObsoleteColumnFamilies();
+
+	void BackgroundThread();
 
-	Status FindColumnFamily(int64_t keytime,
-				ColumnFamilyHandle **column_family,
-				bool create_if_missing);
+	// Merges the column families of the windows overlapping
+	// [start_time, end_time) and the key range of opts.
+	Iterator *NewIteratorOverWindows(const ReadOptions &opts,
+					 int64_t start_time, int64_t end_time);
 
 	static bool IsStale(int64_t keytime, int64_t ttl, Env *env);
 };
@@ -479,6 +479,88 @@ TEST_F(DateTieredTest, IteratorMerge)
 	CloseDateTieredDB();
 }
 
+// Reads should only find the keys of the column families they can be in, and
+// obsolete column families be dropped in the background
+TEST_F(DateTieredTest, PrunedReads)
+{
+	WriteOptions wopts;
+	ReadOptions ropts;
+
+	// T=0, open the database and insert data
+	int64_t start_time;
+	ASSERT_OK(env_->GetCurrentTime(&start_time));
+	OpenDateTieredDB(10, 2);
+	ASSERT_TRUE(date_tiered_db_.get() != nullptr);
+
+	KVMap map_insert1;
+	MakeKVMap(kSampleSize_, &map_insert1);
+	for (auto &kv : map_insert1) {
+		ASSERT_OK(date_tiered_db_->Put(wopts, kv.first, kv.second));
+	}
+	Sleep(2);
+	// T=2, in another column family
+	KVMap map_insert2;
+	MakeKVMap(kSampleSize_, &map_insert2);
+	for (auto &kv : map_insert2) {
+		ASSERT_OK(date_tiered_db_->Put(wopts, kv.first, kv.second));
+	}
+	ASSERT_EQ(3, GetColumnFamilyCount());
+
+	// Iterators over a time range only see its column families
+	auto count_keys = [&](int64_t start, int64_t end,
+			      const KVMap &expected) {
+		std::unique_ptr<Iterator> dbiter(
+			date_tiered_db_->NewIterator(ropts, start, end));
+		size_t count = 0;
+		for (dbiter->SeekToFirst(); dbiter->Valid(); dbiter->Next()) {
+			EXPECT_EQ(1, expected.count(dbiter->key().ToString()));
+			count++;
+		}
+		return count;
+	};
+	ASSERT_EQ(map_insert1.size(),
+		  count_keys(start_time, start_time + 1, map_insert1));
+	ASSERT_EQ(map_insert2.size(),
+		  count_keys(start_time + 2, start_time + 3, map_insert2));
+	KVMap map_all = map_insert1;
+	map_all.insert(map_insert2.begin(), map_insert2.end());
+	ASSERT_EQ(map_all.size(),
+		  count_keys(start_time, start_time + 3, map_all));
+
+	// Keys out of the key range of their column family are not found
+	std::string key = "zzz";
+	ASSERT_OK(AppendTimestamp(&key));
+	std::string value;
+	ASSERT_TRUE(date_tiered_db_->Get(ropts, key, &value).IsNotFound());
+	ASSERT_FALSE(date_tiered_db_->KeyMayExist(ropts, key, &value));
+	ASSERT_OK(date_tiered_db_->Delete(wopts, key));
+
+	// Key ranges are kept across reopens
+	CloseDateTieredDB();
+	OpenDateTieredDB(10, 2);
+	for (auto &kv : map_insert1) {
+		ASSERT_OK(date_tiered_db_->Get(ropts, kv.first, &value));
+		ASSERT_EQ(kv.second, value);
+	}
+
+	Sleep(10);
+	// T=12, the first column family has expired, and is dropped in the
+	// background after the next write
+	KVMap map_insert3;
+	MakeKVMap(kSampleSize_, &map_insert3);
+	ASSERT_OK(date_tiered_db_->Put(wopts, map_insert3.begin()->first,
+				       map_insert3.begin()->second));
+	for (int i = 0; i < 1000 && GetColumnFamilyCount() != 3; i++) {
+		Env::Default()->SleepForMicroseconds(10000);
+	}
+	ASSERT_EQ(3, GetColumnFamilyCount());
+	ASSERT_OK(date_tiered_db_->Get(ropts, map_insert3.begin()->first,
+				       &value));
+	ASSERT_EQ(map_insert3.begin()->second, value);
+
+	CloseDateTieredDB();
+}
+
 } //  namespace rocksdb
 
 // A black-box test for the DateTieredDB around rocksdb
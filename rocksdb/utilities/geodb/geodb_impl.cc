@@ -15,6 +15,7 @@
 #include <map>
 #include <string>
 #include <vector>
+#include "rocksdb/sst_file_writer.h"
 #include "util/coding.h"
 #include "util/filename.h"
 #include "util/string_util.h"
@@ -43,7 +44,7 @@ const double GeoDBImpl::MinLongitude = -180;
 const double GeoDBImpl::MaxLongitude = 180;
 
 GeoDBImpl::GeoDBImpl(DB *db, const GeoDBOptions &options)
-	: GeoDB(db, options), db_(db), options_(options)
+	: GeoDB(db, options), db_(db), options_(options), bulk_insert_files_(0)
 {
 }
 
@@ -84,6 +85,59 @@ Status GeoDBImpl::Insert(const GeoObject &obj)
 	return db_->Write(woptions_, &batch);
 }
 
+Status GeoDBImpl::BulkInsert(const std::vector<GeoObject> &objects)
+{
+	if (objects.empty()) {
+		return Status::OK();
+	}
+
+	// Both tables go into the same file, so the keys of all objects are
+	// sorted together
+	std::vector<std::pair<std::string, std::string> > entries;
+	entries.reserve(2 * objects.size());
+	for (const auto &obj : objects) {
+		std::string quadkey = PositionToQuad(obj.position, Detail);
+		entries.emplace_back(MakeKey1(obj.position, obj.id, quadkey),
+				     obj.value);
+		entries.emplace_back(MakeKey2(obj.id), quadkey);
+	}
+	const Comparator *comparator =
+		db_->DefaultColumnFamily()->GetComparator();
+	std::sort(entries.begin(), entries.end(),
+		  [comparator](const std::pair<std::string, std::string> &a,
+			       const std::pair<std::string, std::string> &b) {
+			  return comparator->Compare(a.first, b.first) < 0;
+		  });
+
+	std::string file_name = db_->GetName() + "/geodb_bulk_" +
+				ToString(bulk_insert_files_.fetch_add(1)) +
+				".sst";
+	SstFileWriter writer(EnvOptions(), db_->GetOptions(),
+			     db_->DefaultColumnFamily());
+	Status status = writer.Open(file_name);
+	for (size_t i = 0; i < entries.size() && status.ok(); ++i) {
+		if (i > 0 &&
+		    comparator->Compare(entries[i - 1].first,
+					entries[i].first) == 0) {
+			status = Status::InvalidArgument(
+				"Object inserted twice", entries[i].first);
+			break;
+		}
+		status = writer.Put(entries[i].first, entries[i].second);
+	}
+	if (status.ok()) {
+		status = writer.Finish();
+	}
+	if (status.ok()) {
+		IngestExternalFileOptions ingest_options;
+		ingest_options.move_files = true;
+		status = db_->IngestExternalFile({ file_name }, ingest_options);
+	}
+	// An ingested file was moved, this cleans up after a failure
+	db_->GetEnv()->DeleteFile(file_name);
+	return status;
+}
+
 Status GeoDBImpl::GetByPosition(const GeoPosition &pos, const Slice &id,
 				std::string *value)
 {
@@ -8,6 +8,7 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <string>
 #include <sstream>
@@ -32,6 +33,10 @@ class GeoDBImpl : public GeoDB {
 	// is a blob that is associated with this object.
 	virtual Status Insert(const GeoObject &object) override;
 
+	// Insert all the objects through a table file ingested into the db
+	virtual Status
+	BulkInsert(const std::vector<GeoObject> &objects) override;
+
 	// Retrieve the value of the object located at the specified GPS
 	// location and is identified by the 'id'.
 	virtual Status GetByPosition(const GeoPosition &pos, const Slice &id,
@@ -54,6 +59,8 @@ class GeoDBImpl : public GeoDB {
 	const GeoDBOptions options_;
 	const WriteOptions woptions_;
 	const ReadOptions roptions_;
+	// Numbers the files written by BulkInsert()
+	std::atomic<uint64_t> bulk_insert_files_;
 
 	// MSVC requires the definition for this static const to be in .CC file
 	// The value of PI
@@ -7,6 +7,7 @@
 #include "utilities/geodb/geodb_impl.h"
 
 #include <cctype>
+#include "util/string_util.h"
 #include "util/testharness.h"
 
 namespace rocksdb
@@ -127,6 +128,59 @@ TEST_F(GeoDBTest, Search)
 	delete iter2;
 }
 
+// BulkInsert, then Get, Search and Remove
+TEST_F(GeoDBTest, BulkInsert)
+{
+	// one object inserted the regular way first
+	Status status = getdb()->Insert(
+		GeoObject(GeoPosition(10, 10), "id0", "value0"));
+	ASSERT_TRUE(status.ok());
+
+	std::vector<GeoObject> objects;
+	for (int i = 1; i <= 100; ++i) {
+		objects.emplace_back(GeoPosition(i % 10, i / 10),
+				     "id" + ToString(i), "value" + ToString(i));
+	}
+	status = getdb()->BulkInsert(objects);
+	ASSERT_TRUE(status.ok());
+
+	for (int i = 0; i <= 100; ++i) {
+		std::string id = "id" + ToString(i);
+		GeoObject obj;
+		status = getdb()->GetById(id, &obj);
+		ASSERT_TRUE(status.ok());
+		ASSERT_EQ(obj.value, "value" + ToString(i));
+		std::string value;
+		status = getdb()->GetByPosition(obj.position, id, &value);
+		ASSERT_TRUE(status.ok());
+		ASSERT_EQ(value, obj.value);
+	}
+
+	// object 43 is the only one within 2 kilometers of (3, 4)
+	GeoIterator *iter = getdb()->SearchRadial(GeoPosition(3, 4), 2000);
+	ASSERT_TRUE(iter->status().ok());
+	ASSERT_TRUE(iter->Valid());
+	ASSERT_EQ(iter->geo_object().value, "value43");
+	iter->Next();
+	ASSERT_FALSE(iter->Valid());
+	delete iter;
+
+	status = getdb()->Remove("id5");
+	ASSERT_TRUE(status.ok());
+	GeoObject obj;
+	status = getdb()->GetById("id5", &obj);
+	ASSERT_TRUE(status.IsNotFound());
+
+	// ids have to be distinct
+	objects.clear();
+	objects.emplace_back(GeoPosition(50, 50), "id200", "a");
+	objects.emplace_back(GeoPosition(60, 60), "id200", "b");
+	status = getdb()->BulkInsert(objects);
+	ASSERT_TRUE(status.IsInvalidArgument());
+	status = getdb()->GetById("id200", &obj);
+	ASSERT_TRUE(status.IsNotFound());
+}
+
 } // namespace rocksdb
 
 int main(int argc, char *argv[])
@@ -6,12 +6,14 @@
 
 #include "utilities/persistent_cache/block_cache_tier.h"
 
+#include <map>
 #include <regex>
 #include <utility>
 #include <vector>
 
 #include "port/port.h"
 #include "util/logging.h"
+#include "util/string_util.h"
 #include "util/stop_watch.h"
 #include "util/sync_point.h"
 #include "utilities/persistent_cache/block_cache_tier_file.h"
@@ -47,7 +49,15 @@ Status BlockCacheTier::Open()
 
 	// Create base/<cache dir> directory
 	status = opt_.env->CreateDir(GetCachePath());
-	if (!status.ok()) {
+	if (!status.ok() && opt_.warm_restart) {
+		// directory already exists, reuse its files
+		status = RecoverCacheFiles();
+		if (!status.ok()) {
+			Error(opt_.log, "Error recovering cache files %s. %s",
+			      opt_.path.c_str(), status.ToString().c_str());
+			return status;
+		}
+	} else if (!status.ok()) {
 		// directory already exists, clean it up
 		status = CleanupCacheFolder(GetCachePath());
 		assert(status.ok());
@@ -120,6 +130,82 @@ Status BlockCacheTier::CleanupCacheFolder(const std::string &folder)
 	return Status::OK();
 }
 
+Status BlockCacheTier::RecoverCacheFiles()
+{
+	lock_.AssertHeld();
+
+	std::vector<std::string> files;
+	Status status = opt_.env->GetChildren(GetCachePath(), &files);
+	if (!status.ok()) {
+		return status;
+	}
+
+	// cache id => file size
+	std::map<uint32_t, uint64_t> cache_files;
+	for (const auto &file : files) {
+		Slice name(file);
+		uint64_t cache_id;
+		if (!ConsumeDecimalNumber(&name, &cache_id) || name != ".rc" ||
+		    cache_id > std::numeric_limits<uint32_t>::max()) {
+			continue;
+		}
+		uint64_t file_size;
+		status = opt_.env->GetFileSize(GetCachePath() + "/" + file,
+					       &file_size);
+		if (!status.ok()) {
+			return status;
+		}
+		cache_files[static_cast<uint32_t>(cache_id)] = file_size;
+		writer_cache_id_ = std::max(
+			writer_cache_id_, static_cast<uint32_t>(cache_id + 1));
+	}
+
+	// keep the newest files that fit in the cache after an eviction, and
+	// insert them oldest first so that they're evicted in that order
+	const double retain_fac = (100 - kEvictPct) / static_cast<double>(100);
+	uint64_t kept_size = 0;
+	std::vector<uint32_t> kept;
+	for (auto it = cache_files.rbegin(); it != cache_files.rend(); ++it) {
+		if (kept_size + it->second <= opt_.cache_size * retain_fac) {
+			kept_size += it->second;
+			kept.push_back(it->first);
+		} else {
+			uint64_t file_size;
+			BlockCacheFile(opt_.env, GetCachePath(), it->first)
+				.Delete(&file_size);
+		}
+	}
+
+	for (auto it = kept.rbegin(); it != kept.rend(); ++it) {
+		RandomAccessCacheFile *const file = new RandomAccessCacheFile(
+			opt_.env, GetCachePath(), *it, opt_.log);
+		auto add = [this, file](const Slice &key, const LBA &lba) {
+			if (metadata_.Lookup(key, nullptr)) {
+				// an older file has the same block
+				return;
+			}
+			BlockInfo *info = metadata_.Insert(key, lba);
+			if (info) {
+				file->Add(info);
+			}
+		};
+		bool ok = file->Open(opt_.enable_direct_reads) &&
+			  file->Recover(add);
+		uint64_t file_size = cache_files[*it];
+		if (!ok || file->block_infos().empty()) {
+			file->Delete(&file_size);
+			delete file;
+			continue;
+		}
+		ok = metadata_.Insert(file);
+		assert(ok);
+		size_ += file_size;
+		Info(opt_.log, "Recovered cache file %d with %d blocks", *it,
+		     static_cast<int>(file->block_infos().size()));
+	}
+	return Status::OK();
+}
+
 Status BlockCacheTier::Close()
 {
 	// stop the insert thread
@@ -186,8 +272,8 @@ Status BlockCacheTier::Insert(const Slice &key, const char *data,
 
 	if (opt_.pipeline_writes) {
 		// off load the write to the write thread
-		insert_ops_.Push(InsertOp(key.ToString(),
-					  std::move(std::string(data, size))));
+		insert_ops_.Push(
+			InsertOp(key.ToString(), std::string(data, size)));
 		return Status::OK();
 	}
 
@@ -410,7 +496,8 @@ Status NewPersistentCache(Env *const env, const std::string &path,
 			  const uint64_t size,
 			  const std::shared_ptr<Logger> &log,
 			  const bool optimized_for_nvm,
-			  std::shared_ptr<PersistentCache> *cache)
+			  std::shared_ptr<PersistentCache> *cache,
+			  const bool warm_restart)
 {
 	if (!cache) {
 		return Status::IOError("invalid argument cache");
@@ -425,6 +512,7 @@ Status NewPersistentCache(Env *const env, const std::string &path,
 		opt.writer_qdepth = 4;
 		opt.writer_dispatch_size = 4 * 1024;
 	}
+	opt.warm_restart = warm_restart;
 
 	auto pcache = std::make_shared<BlockCacheTier>(opt);
 	Status s = pcache->Open();
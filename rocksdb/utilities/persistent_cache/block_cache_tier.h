@@ -99,8 +99,8 @@ class BlockCacheTier : public PersistentCacheTier {
 		explicit InsertOp(const bool signal) : signal_(signal)
 		{
 		}
-		explicit InsertOp(std::string &&key, const std::string &data)
-			: key_(std::move(key)), data_(data)
+		explicit InsertOp(std::string &&key, std::string &&data)
+			: key_(std::move(key)), data_(std::move(data))
 		{
 		}
 		~InsertOp()
@@ -136,6 +136,8 @@ class BlockCacheTier : public PersistentCacheTier {
 	}
 	// Cleanup folder
 	Status CleanupCacheFolder(const std::string &folder);
+	// Rebuild the index from the files left in the cache folder
+	Status RecoverCacheFiles();
 
 	// Statistics
 	struct Statistics {
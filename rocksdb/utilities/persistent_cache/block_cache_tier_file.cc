@@ -259,6 +259,71 @@ bool RandomAccessCacheFile::Read(const LBA &lba, Slice *key, Slice *val,
 	return ParseRec(lba, key, val, scratch);
 }
 
+bool RandomAccessCacheFile::Recover(
+	const std::function<void(const Slice &, const LBA &)> &add)
+{
+	// the records are read in order, so go through the page cache
+	std::unique_ptr<RandomAccessFile> file;
+	Status s = NewRandomAccessCacheFile(env_, Path(), &file,
+					    /*use_direct_reads=*/false);
+	uint64_t file_size = 0;
+	if (s.ok()) {
+		s = env_->GetFileSize(Path(), &file_size);
+	}
+	if (!s.ok()) {
+		Error(log_, "Error opening file %s for recovery. %s",
+		      Path().c_str(), s.ToString().c_str());
+		return false;
+	}
+
+	std::unique_ptr<char[]> scratch;
+	uint64_t scratch_size = 0;
+	uint64_t off = 0;
+	while (off + sizeof(CacheRecordHeader) <= file_size) {
+		CacheRecordHeader hdr;
+		Slice result;
+		s = file->Read(off, sizeof(hdr), &result,
+			       reinterpret_cast<char *>(&hdr));
+		if (!s.ok() || result.size() != sizeof(hdr)) {
+			break;
+		}
+		memcpy(&hdr, result.data(), sizeof(hdr));
+		if (hdr.magic_ != CacheRecord::MAGIC) {
+			// zero padding at the end of the file
+			break;
+		}
+		const uint64_t rec_size = sizeof(hdr) +
+					  static_cast<uint64_t>(hdr.key_size_) +
+					  hdr.val_size_;
+		if (off + rec_size > file_size) {
+			// the file was not written up to the end of this record
+			break;
+		}
+		if (rec_size > scratch_size) {
+			scratch.reset(new char[rec_size]);
+			scratch_size = rec_size;
+		}
+		s = file->Read(off, rec_size, &result, scratch.get());
+		if (!s.ok() || result.size() != rec_size) {
+			break;
+		}
+		CacheRecord rec;
+		rec.hdr_ = hdr;
+		rec.key_ = Slice(result.data() + sizeof(hdr), hdr.key_size_);
+		rec.val_ = Slice(rec.key_.data() + hdr.key_size_,
+				 hdr.val_size_);
+		if (rec.ComputeCRC() != hdr.crc_) {
+			Info(log_, "Corrupt record in file %s off %d",
+			     Path().c_str(), static_cast<uint32_t>(off));
+			break;
+		}
+		add(rec.key_, LBA(cache_id_, static_cast<uint32_t>(off),
+				  static_cast<uint32_t>(rec_size)));
+		off += rec_size;
+	}
+	return true;
+}
+
 bool RandomAccessCacheFile::ParseRec(const LBA &lba, Slice *key, Slice *val,
 				     char *scratch)
 {
@@ -564,6 +629,13 @@ ThreadedWriter::ThreadedWriter(PersistentCacheTier *const cache,
 
 void ThreadedWriter::Stop()
 {
+	// finish the writes already dispatched, and the ones they dispatch on
+	// completion, so that a warm restart finds every full buffer on disk
+	while (!threads_.empty() && pending_ios_) {
+		/* sleep override */
+		Env::Default()->SleepForMicroseconds(1000);
+	}
+
 	// notify all threads to exit
 	for (size_t i = 0; i < threads_.size(); ++i) {
 		q_.Push(IO(/*signal=*/true));
@@ -581,6 +653,7 @@ void ThreadedWriter::Write(WritableFile *const file, CacheWriteBuffer *buf,
 			   const uint64_t file_off,
 			   const std::function<void()> callback)
 {
+	pending_ios_++;
 	q_.Push(IO(file, buf, file_off, callback));
 }
 
@@ -605,6 +678,7 @@ void ThreadedWriter::ThreadMain()
 		DispatchIO(io);
 
 		io.callback_();
+		pending_ios_--;
 	}
 }
 
@@ -6,6 +6,7 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <string>
@@ -58,7 +59,7 @@ struct LogicalBlockAddress {
 	{
 	}
 	explicit LogicalBlockAddress(const uint32_t cache_id,
-				     const uint32_t off, const uint16_t size)
+				     const uint32_t off, const uint32_t size)
 		: cache_id_(cache_id), off_(off), size_(size)
 	{
 	}
@@ -185,6 +186,11 @@ class RandomAccessCacheFile : public BlockCacheFile {
 	// read data from the disk
 	bool Read(const LBA &lba, Slice *key, Slice *block,
 		  char *scratch) override;
+	// scan a file left by a previous instance of the cache and pass the key
+	// and locator of each record to `add`, stopping at the first record
+	// that is incomplete or corrupt
+	bool
+	Recover(const std::function<void(const Slice &, const LBA &)> &add);
 
     private:
 	std::unique_ptr<RandomAccessFileReader> freader_;
@@ -338,6 +344,7 @@ class ThreadedWriter : public Writer {
 	const size_t io_size_ = 0;
 	BoundedQueue<IO> q_;
 	std::vector<port::Thread> threads_;
+	std::atomic<size_t> pending_ios_{ 0 }; // IOs queued or in progress
 };
 
 } // namespace rocksdb
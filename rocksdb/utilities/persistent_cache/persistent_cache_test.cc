@@ -11,6 +11,7 @@
 #include "utilities/persistent_cache/persistent_cache_test.h"
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <thread>
 
@@ -114,7 +115,8 @@ NewTieredCache(const size_t mem_size, const PersistentCacheConfig &opt)
 std::unique_ptr<PersistentCacheTier>
 NewBlockCache(Env *env, const std::string &path,
 	      const uint64_t max_size = std::numeric_limits<uint64_t>::max(),
-	      const bool enable_direct_writes = false)
+	      const bool enable_direct_writes = false,
+	      const bool warm_restart = false, const bool is_compressed = true)
 {
 	const uint32_t max_file_size =
 		static_cast<uint32_t>(12 * 1024 * 1024 * kStressFactor);
@@ -124,6 +126,8 @@ NewBlockCache(Env *env, const std::string &path,
 	opt.max_write_pipeline_backlog_size =
 		std::numeric_limits<uint64_t>::max();
 	opt.enable_direct_writes = enable_direct_writes;
+	opt.warm_restart = warm_restart;
+	opt.is_compressed = is_compressed;
 	std::unique_ptr<PersistentCacheTier> scache(new BlockCacheTier(opt));
 	Status s = scache->Open();
 	assert(s.ok());
@@ -259,6 +263,50 @@ TEST_F(PersistentCacheTierTest, BlockCacheInsertWithEviction)
 }
 
 // Tiered cache tests
+TEST_F(PersistentCacheTierTest, BlockCacheWarmRestart)
+{
+	const size_t max_keys = static_cast<size_t>(10 * 1024 * kStressFactor);
+	cache_ = NewBlockCache(Env::Default(), path_,
+			       /*size=*/std::numeric_limits<uint64_t>::max(),
+			       /*direct_writes=*/false);
+	Insert(/*nthreads=*/1, max_keys);
+	cache_->Close();
+	cache_.reset();
+
+	// everything but the last, partially filled write buffer is found again
+	cache_ = NewBlockCache(Env::Default(), path_,
+			       /*size=*/std::numeric_limits<uint64_t>::max(),
+			       /*direct_writes=*/false, /*warm_restart=*/true);
+	Verify(/*nthreads=*/1, /*eviction_enabled=*/true);
+	ASSERT_EQ(stats_verify_hits_ + stats_verify_missed_, max_keys);
+	ASSERT_GT(stats_verify_hits_, max_keys / 2);
+	const size_t hits = stats_verify_hits_;
+
+	// blocks inserted now go to new files next to the recovered ones
+	Insert(/*nthreads=*/1, max_keys);
+	Verify(/*nthreads=*/1);
+	ASSERT_EQ(stats_verify_hits_, max_keys);
+	cache_->Close();
+	cache_.reset();
+
+	cache_ = NewBlockCache(Env::Default(), path_,
+			       /*size=*/std::numeric_limits<uint64_t>::max(),
+			       /*direct_writes=*/false, /*warm_restart=*/true);
+	Verify(/*nthreads=*/1, /*eviction_enabled=*/true);
+	ASSERT_GE(stats_verify_hits_, hits);
+	cache_->Close();
+	cache_.reset();
+
+	// without warm restart the cache starts empty
+	cache_ = NewBlockCache(Env::Default(), path_,
+			       /*size=*/std::numeric_limits<uint64_t>::max(),
+			       /*direct_writes=*/false);
+	Verify(/*nthreads=*/1, /*eviction_enabled=*/true);
+	ASSERT_EQ(stats_verify_hits_, 0);
+	cache_->Close();
+	cache_.reset();
+}
+
 TEST_F(PersistentCacheTierTest, TieredCacheInsert)
 {
 	for (auto nthreads : { 1, 5 }) {
@@ -499,6 +547,173 @@ void PersistentCacheDBTest::RunTest(
 	}
 }
 
+// An uncompressed persistent cache behind a block cache is filled with the
+// blocks the block cache evicts, and serves them back
+TEST_F(PersistentCacheDBTest, AdmitEvictedBlocks)
+{
+	Options options;
+	options.statistics = rocksdb::CreateDBStatistics();
+	options = CurrentOptions(options);
+	options.write_buffer_size = 4 * 1024 * 1024; // a single table
+	options.compression = kNoCompression;
+
+	auto pcache = std::shared_ptr<PersistentCacheTier>(NewBlockCache(
+		Env::Default(), dbname_,
+		/*size=*/std::numeric_limits<uint64_t>::max(),
+		/*direct_writes=*/false, /*warm_restart=*/false,
+		/*is_compressed=*/false));
+	BlockBasedTableOptions table_options;
+	table_options.persistent_cache = pcache;
+	table_options.block_cache = NewLRUCache(64 * 1024, /*shard_bits=*/0);
+	options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+	const int num_iter = static_cast<int>(8 * 1024 * kStressFactor);
+	std::vector<std::string> values;
+	Insert(options, table_options, num_iter, &values);
+
+	// the first pass misses the persistent cache and, as the block cache
+	// is much smaller than the table, evicts most blocks into it
+	for (int i = 0; i < num_iter; i++) {
+		ASSERT_EQ(Get(1, Key(i)), values[i]);
+	}
+	ASSERT_GT(TestGetTickerCount(options, PERSISTENT_CACHE_MISS), 0);
+	pcache->TEST_Flush();
+
+	// the second pass finds them there
+	const auto page_hit = TestGetTickerCount(options, PERSISTENT_CACHE_HIT);
+	for (int i = 0; i < num_iter; i++) {
+		ASSERT_EQ(Get(1, Key(i)), values[i]);
+	}
+	ASSERT_GT(TestGetTickerCount(options, PERSISTENT_CACHE_HIT), page_hit);
+
+	options.create_if_missing = true;
+	DestroyAndReopen(options);
+
+	pcache->Close();
+}
+
+// Uncompressed persistent cache keeping its pages in memory, counting the
+// pages inserted and found
+class CountingPersistentCache : public PersistentCache {
+    public:
+	Status Insert(const Slice &key, const char *data,
+		      const size_t size) override
+	{
+		MutexLock _(&lock_);
+		pages_[key.ToString()].assign(data, size);
+		inserts_++;
+		return Status::OK();
+	}
+
+	Status Lookup(const Slice &key, std::unique_ptr<char[]> *data,
+		      size_t *size) override
+	{
+		MutexLock _(&lock_);
+		auto it = pages_.find(key.ToString());
+		if (it == pages_.end()) {
+			return Status::NotFound();
+		}
+		data->reset(new char[it->second.size()]);
+		memcpy(data->get(), it->second.data(), it->second.size());
+		*size = it->second.size();
+		hits_++;
+		return Status::OK();
+	}
+
+	bool IsCompressed() override
+	{
+		return false;
+	}
+
+	StatsType Stats() override
+	{
+		return StatsType();
+	}
+
+	std::string GetPrintableOptions() const override
+	{
+		return "";
+	}
+
+	size_t inserts()
+	{
+		MutexLock _(&lock_);
+		return inserts_;
+	}
+
+	size_t hits()
+	{
+		MutexLock _(&lock_);
+		return hits_;
+	}
+
+    private:
+	port::Mutex lock_;
+	std::map<std::string, std::string> pages_;
+	size_t inserts_ = 0;
+	size_t hits_ = 0;
+};
+
+// Two table factories sharing a block cache, each with its own persistent
+// cache, get the evicted blocks of their own tables only
+TEST_F(PersistentCacheDBTest, AdmitEvictedBlocksOfTwoFactories)
+{
+	Options options;
+	options = CurrentOptions(options);
+	options.write_buffer_size = 4 * 1024 * 1024; // a single table
+	options.compression = kNoCompression;
+
+	auto block_cache = NewLRUCache(64 * 1024, /*shard_bits=*/0);
+	std::shared_ptr<CountingPersistentCache> pcaches[2];
+	std::vector<Options> cf_options = { options };
+	for (auto &pcache : pcaches) {
+		pcache = std::make_shared<CountingPersistentCache>();
+		BlockBasedTableOptions table_options;
+		table_options.persistent_cache = pcache;
+		table_options.block_cache = block_cache;
+		Options cf_opts = options;
+		cf_opts.table_factory.reset(
+			NewBlockBasedTableFactory(table_options));
+		cf_options.push_back(cf_opts);
+	}
+	CreateAndReopenWithCF({ "pikachu", "eevee" }, options);
+	ReopenWithColumnFamilies({ "default", "pikachu", "eevee" },
+				 cf_options);
+
+	const int num_iter = 1024;
+	Random rnd(301);
+	std::vector<std::string> values[2];
+	for (int cf = 1; cf <= 2; cf++) {
+		for (int i = 0; i < num_iter; i++) {
+			values[cf - 1].push_back(RandomString(&rnd, 1000));
+			ASSERT_OK(Put(cf, Key(i), values[cf - 1][i]));
+		}
+		ASSERT_OK(Flush(cf));
+	}
+
+	// reading the first column family only evicts its blocks
+	for (int i = 0; i < num_iter; i++) {
+		ASSERT_EQ(Get(1, Key(i)), values[0][i]);
+	}
+	ASSERT_GT(pcaches[0]->inserts(), 0U);
+	ASSERT_EQ(pcaches[1]->inserts(), 0U);
+
+	for (int i = 0; i < num_iter; i++) {
+		ASSERT_EQ(Get(2, Key(i)), values[1][i]);
+	}
+	ASSERT_GT(pcaches[1]->inserts(), 0U);
+
+	// and each persistent cache serves the blocks of its own tables
+	for (int cf = 1; cf <= 2; cf++) {
+		for (int i = 0; i < num_iter; i++) {
+			ASSERT_EQ(Get(cf, Key(i)), values[cf - 1][i]);
+		}
+		ASSERT_GT(pcaches[cf - 1]->hits(), 0U);
+	}
+
+	Close();
+}
+
 #ifdef TRAVIS
 // Travis is unable to handle the normal version of the tests running out of
 // fds, out of space and timeouts. This is an easier version of the test
@@ -57,6 +57,8 @@ std::string PersistentCacheConfig::ToString() const
 	ret.append(buffer);
 	snprintf(buffer, kBufferSize, "    is_compressed: %d\n", is_compressed);
 	ret.append(buffer);
+	snprintf(buffer, kBufferSize, "    warm_restart: %d\n", warm_restart);
+	ret.append(buffer);
 
 	return ret;
 }
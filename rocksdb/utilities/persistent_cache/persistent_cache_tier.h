@@ -224,6 +224,16 @@ struct PersistentCacheConfig {
 	// uncompressed mode
 	bool is_compressed = true;
 
+	// warm-restart
+	//
+	// On open, keep the cache files left in the cache directory and rebuild
+	// the index from their records, instead of deleting them. This only
+	// makes sense if page keys stay the same across restarts, which is the
+	// case for block based tables on file systems with unique file ids.
+	//
+	// default: false
+	bool warm_restart = false;
+
 	PersistentCacheConfig
 	MakePersistentCacheConfig(const std::string &path, const uint64_t size,
 				  const std::shared_ptr<Logger> &log);
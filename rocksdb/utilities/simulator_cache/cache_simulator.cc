@@ -0,0 +1,370 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "utilities/simulator_cache/cache_simulator.h"
+
+#include <algorithm>
+#include <list>
+
+#include "port/port.h"
+#include "util/hash.h"
+
+namespace rocksdb
+{
+namespace
+{
+// Differs from the seed the tracer samples with, so that sampling a
+// sampled trace still thins it out.
+const uint32_t kSimulatorSamplingSeed = 0x9e3779b9;
+
+class LRUSimulatedCache : public SimulatedCache {
+    public:
+	explicit LRUSimulatedCache(uint64_t capacity)
+		: capacity_(capacity), usage_(0)
+	{
+	}
+
+	virtual bool Access(const std::string &key, uint64_t size,
+			    bool no_insert) override
+	{
+		if (Lookup(key)) {
+			return true;
+		}
+		if (!no_insert) {
+			Insert(key, size);
+		}
+		return false;
+	}
+
+	virtual uint64_t usage() const override
+	{
+		return usage_;
+	}
+
+	bool Lookup(const std::string &key)
+	{
+		auto it = index_.find(key);
+		if (it == index_.end()) {
+			return false;
+		}
+		lru_.splice(lru_.begin(), lru_, it->second);
+		return true;
+	}
+
+	void Insert(const std::string &key, uint64_t size)
+	{
+		if (size > capacity_) {
+			return;
+		}
+		while (usage_ + size > capacity_) {
+			usage_ -= lru_.back().second;
+			index_.erase(lru_.back().first);
+			lru_.pop_back();
+		}
+		lru_.emplace_front(key, size);
+		index_[key] = lru_.begin();
+		usage_ += size;
+	}
+
+	bool Erase(const std::string &key)
+	{
+		auto it = index_.find(key);
+		if (it == index_.end()) {
+			return false;
+		}
+		usage_ -= it->second->second;
+		lru_.erase(it->second);
+		index_.erase(it);
+		return true;
+	}
+
+    private:
+	typedef std::list<std::pair<std::string, uint64_t> > LRUList;
+
+	const uint64_t capacity_;
+	uint64_t usage_;
+	// Most recently used first
+	LRUList lru_;
+	std::unordered_map<std::string, LRUList::iterator> index_;
+};
+
+// CLOCK: a hit sets the reference bit of the block, and the hand sweeping
+// for a victim clears set bits and evicts the first block found clear.
+class ClockSimulatedCache : public SimulatedCache {
+    public:
+	explicit ClockSimulatedCache(uint64_t capacity)
+		: capacity_(capacity), usage_(0), hand_(ring_.end())
+	{
+	}
+
+	virtual bool Access(const std::string &key, uint64_t size,
+			    bool no_insert) override
+	{
+		auto it = index_.find(key);
+		if (it != index_.end()) {
+			it->second->referenced = true;
+			return true;
+		}
+		if (!no_insert && size <= capacity_) {
+			while (usage_ + size > capacity_) {
+				Evict();
+			}
+			// Behind the hand, so the block gets a full sweep
+			// before it is looked at
+			index_[key] =
+				ring_.insert(hand_, Entry{ key, size, false });
+			usage_ += size;
+		}
+		return false;
+	}
+
+	virtual uint64_t usage() const override
+	{
+		return usage_;
+	}
+
+    private:
+	struct Entry {
+		std::string key;
+		uint64_t size;
+		bool referenced;
+	};
+
+	void Evict()
+	{
+		while (true) {
+			if (hand_ == ring_.end()) {
+				hand_ = ring_.begin();
+			}
+			if (hand_->referenced) {
+				hand_->referenced = false;
+				++hand_;
+				continue;
+			}
+			usage_ -= hand_->size;
+			index_.erase(hand_->key);
+			hand_ = ring_.erase(hand_);
+			return;
+		}
+	}
+
+	const uint64_t capacity_;
+	uint64_t usage_;
+	std::list<Entry> ring_;
+	std::list<Entry>::iterator hand_;
+	std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+// Keeps one-hit wonders out of the cache: the first miss only records the
+// key in a ghost LRU of keys, charged like the blocks and as large as the
+// cache, and a block is inserted when it misses again while still there.
+class AdmitOnSecondMissSimulatedCache : public SimulatedCache {
+    public:
+	explicit AdmitOnSecondMissSimulatedCache(uint64_t capacity)
+		: cache_(capacity), ghost_(capacity)
+	{
+	}
+
+	virtual bool Access(const std::string &key, uint64_t size,
+			    bool no_insert) override
+	{
+		if (cache_.Lookup(key)) {
+			return true;
+		}
+		if (no_insert) {
+			return false;
+		}
+		if (ghost_.Erase(key)) {
+			cache_.Insert(key, size);
+		} else {
+			ghost_.Insert(key, size);
+		}
+		return false;
+	}
+
+	virtual uint64_t usage() const override
+	{
+		return cache_.usage();
+	}
+
+    private:
+	LRUSimulatedCache cache_;
+	LRUSimulatedCache ghost_;
+};
+} // namespace
+
+const char *CacheSimulatorPolicyName(CacheSimulatorPolicy policy)
+{
+	switch (policy) {
+	case kSimLRU:
+		return "lru";
+	case kSimClock:
+		return "clock";
+	case kSimLRUAdmitOnSecondMiss:
+		return "lru_admit_on_second_miss";
+	default:
+		return "unknown";
+	}
+}
+
+std::unique_ptr<SimulatedCache> NewSimulatedCache(CacheSimulatorPolicy policy,
+						  uint64_t capacity)
+{
+	switch (policy) {
+	case kSimLRU:
+		return std::unique_ptr<SimulatedCache>(
+			new LRUSimulatedCache(capacity));
+	case kSimClock:
+		return std::unique_ptr<SimulatedCache>(
+			new ClockSimulatedCache(capacity));
+	case kSimLRUAdmitOnSecondMiss:
+		return std::unique_ptr<SimulatedCache>(
+			new AdmitOnSecondMissSimulatedCache(capacity));
+	default:
+		return nullptr;
+	}
+}
+
+LRUStackDistance::LRUStackDistance()
+	: tree_(1025, 0), next_position_(0), total_size_(0)
+{
+}
+
+void LRUStackDistance::Add(uint64_t position, int64_t delta)
+{
+	for (uint64_t i = position + 1; i < tree_.size(); i += i & (~i + 1)) {
+		tree_[i] += delta;
+	}
+}
+
+uint64_t LRUStackDistance::PrefixSum(uint64_t position) const
+{
+	int64_t sum = 0;
+	for (uint64_t i = position; i > 0; i -= i & (~i + 1)) {
+		sum += tree_[i];
+	}
+	return static_cast<uint64_t>(sum);
+}
+
+uint64_t LRUStackDistance::SuffixSum(uint64_t position) const
+{
+	return total_size_ - PrefixSum(position);
+}
+
+void LRUStackDistance::Compact()
+{
+	std::vector<BlockState *> live;
+	live.reserve(last_access_.size());
+	for (auto &entry : last_access_) {
+		live.push_back(&entry.second);
+	}
+	std::sort(live.begin(), live.end(),
+		  [](const BlockState *a, const BlockState *b) {
+			  return a->position < b->position;
+		  });
+	// Twice the live blocks leaves as many accesses before the next
+	// compaction as there are blocks, so the cost stays O(log n) each.
+	tree_.assign(std::max<size_t>(2 * live.size(), 1024) + 1, 0);
+	next_position_ = 0;
+	for (BlockState *state : live) {
+		state->position = next_position_++;
+		Add(state->position, static_cast<int64_t>(state->size));
+	}
+}
+
+uint64_t LRUStackDistance::Access(const std::string &key, uint64_t size,
+				  bool no_insert)
+{
+	if (next_position_ + 1 >= tree_.size()) {
+		Compact();
+	}
+	auto it = last_access_.find(key);
+	uint64_t distance = port::kMaxUint64;
+	if (it != last_access_.end()) {
+		distance = SuffixSum(it->second.position);
+		Add(it->second.position,
+		    -static_cast<int64_t>(it->second.size));
+		total_size_ -= it->second.size;
+	} else if (no_insert) {
+		return distance;
+	}
+	BlockState &state = last_access_[key];
+	state.position = next_position_++;
+	state.size = size;
+	Add(state.position, static_cast<int64_t>(size));
+	total_size_ += size;
+	return distance;
+}
+
+CacheSimulator::CacheSimulator(const std::vector<uint64_t> &capacities,
+			       uint32_t sampling_rate)
+	: capacities_(capacities),
+	  sampling_rate_(std::max<uint32_t>(sampling_rate, 1)), lookups_(0)
+{
+	std::sort(capacities_.begin(), capacities_.end());
+	capacities_.erase(std::unique(capacities_.begin(), capacities_.end()),
+			  capacities_.end());
+	lru_misses_by_distance_.assign(capacities_.size() + 1, 0);
+	for (int policy = kSimLRU + 1; policy < kSimPolicyMax; policy++) {
+		for (uint64_t capacity : capacities_) {
+			MiniSimulation sim;
+			sim.policy = static_cast<CacheSimulatorPolicy>(policy);
+			sim.capacity = capacity;
+			sim.cache = NewSimulatedCache(
+				sim.policy,
+				std::max<uint64_t>(capacity / sampling_rate_,
+						   1));
+			sim.lookups = 0;
+			sim.misses = 0;
+			mini_simulations_.push_back(std::move(sim));
+		}
+	}
+}
+
+void CacheSimulator::Access(const BlockCacheTraceRecord &record)
+{
+	lookups_++;
+	uint64_t distance = lru_.Access(record.block_key, record.block_size,
+					record.no_insert);
+	size_t missed = std::lower_bound(capacities_.begin(), capacities_.end(),
+					 distance) -
+			capacities_.begin();
+	lru_misses_by_distance_[missed]++;
+
+	if (sampling_rate_ > 1 &&
+	    Hash(record.block_key.data(), record.block_key.size(),
+		 kSimulatorSamplingSeed) %
+			    sampling_rate_ !=
+		    0) {
+		return;
+	}
+	for (auto &sim : mini_simulations_) {
+		sim.lookups++;
+		if (!sim.cache->Access(record.block_key, record.block_size,
+				       record.no_insert)) {
+			sim.misses++;
+		}
+	}
+}
+
+std::vector<CacheSimulatorResult> CacheSimulator::GetResults() const
+{
+	std::vector<CacheSimulatorResult> results;
+	// An access misses at capacities_[i] when it misses at more than i
+	// of the capacities.
+	uint64_t misses = lookups_;
+	for (size_t i = 0; i < capacities_.size(); i++) {
+		misses -= lru_misses_by_distance_[i];
+		results.push_back(CacheSimulatorResult{
+			kSimLRU, capacities_[i], lookups_, misses });
+	}
+	for (const auto &sim : mini_simulations_) {
+		results.push_back(CacheSimulatorResult{
+			sim.policy, sim.capacity, sim.lookups, sim.misses });
+	}
+	return results;
+}
+
+} // namespace rocksdb
@@ -0,0 +1,144 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "util/block_cache_tracer.h"
+
+namespace rocksdb
+{
+// Offline simulation of block caches over a block cache trace, see
+// DB::StartBlockCacheTrace(). Unlike SimCache it runs on a recorded trace
+// and answers for many capacities and policies in one pass.
+
+enum CacheSimulatorPolicy {
+	// Exact, computed from the reuse distance of every access
+	kSimLRU = 0,
+	kSimClock = 1,
+	// LRU that only admits a block on its second miss within a window of
+	// recently missed keys as large as the cache
+	kSimLRUAdmitOnSecondMiss = 2,
+	kSimPolicyMax,
+};
+
+const char *CacheSimulatorPolicyName(CacheSimulatorPolicy policy);
+
+struct CacheSimulatorResult {
+	CacheSimulatorPolicy policy;
+	uint64_t capacity;
+	uint64_t lookups;
+	uint64_t misses;
+
+	double miss_ratio() const
+	{
+		return lookups == 0 ? 0.0
+				    : static_cast<double>(misses) / lookups;
+	}
+};
+
+// Miss ratio curve of an LRU cache charged by block size. The reuse
+// distance of an access, the bytes of the distinct blocks looked up since
+// the previous access to the same block, is the smallest capacity it hits
+// at; a Fenwick tree over access times holds the size of each block at its
+// latest access, so each distance costs O(log n).
+class LRUStackDistance {
+    public:
+	LRUStackDistance();
+
+	// Returns the reuse distance in bytes, including the block itself, or
+	// UINT64_MAX for the first access. Like in LRUCache, every hit moves
+	// the block to the top, but a no_insert miss doesn't add it.
+	uint64_t Access(const std::string &key, uint64_t size, bool no_insert);
+
+	size_t num_blocks() const
+	{
+		return last_access_.size();
+	}
+
+    private:
+	struct BlockState {
+		uint64_t position;
+		uint64_t size;
+	};
+
+	void Add(uint64_t position, int64_t delta);
+	// Sum of the sizes at positions [position, next_position_)
+	uint64_t SuffixSum(uint64_t position) const;
+	uint64_t PrefixSum(uint64_t position) const;
+	// Renumber the live positions densely into a larger tree
+	void Compact();
+
+	std::vector<int64_t> tree_;
+	uint64_t next_position_;
+	uint64_t total_size_;
+	std::unordered_map<std::string, BlockState> last_access_;
+};
+
+// A simulated cache holding keys and charges only.
+class SimulatedCache {
+    public:
+	virtual ~SimulatedCache()
+	{
+	}
+
+	// Returns true on a hit. A miss inserts the block unless no_insert
+	// is set or the policy declines it.
+	virtual bool Access(const std::string &key, uint64_t size,
+			    bool no_insert) = 0;
+	virtual uint64_t usage() const = 0;
+};
+
+std::unique_ptr<SimulatedCache> NewSimulatedCache(CacheSimulatorPolicy policy,
+						  uint64_t capacity);
+
+// Runs every policy at every capacity over the accesses it is fed.
+//
+// LRU is exact. The other policies have no stack property and get one
+// simulated cache per capacity; with sampling_rate N > 1 those caches only
+// see the blocks whose key hashes to 0 modulo N and are 1/N of the
+// capacity, which keeps the cost of a long trace down at a small loss of
+// accuracy.
+class CacheSimulator {
+    public:
+	CacheSimulator(const std::vector<uint64_t> &capacities,
+		       uint32_t sampling_rate = 1);
+
+	void Access(const BlockCacheTraceRecord &record);
+
+	// One result per policy and capacity, capacities ascending
+	std::vector<CacheSimulatorResult> GetResults() const;
+
+	uint64_t lookups() const
+	{
+		return lookups_;
+	}
+
+    private:
+	std::vector<uint64_t> capacities_;
+	uint32_t sampling_rate_;
+	uint64_t lookups_;
+
+	LRUStackDistance lru_;
+	// lru_misses_by_distance_[k] counts the accesses that miss at the k
+	// smallest capacities and hit at the others.
+	std::vector<uint64_t> lru_misses_by_distance_;
+
+	struct MiniSimulation {
+		CacheSimulatorPolicy policy;
+		uint64_t capacity;
+		std::unique_ptr<SimulatedCache> cache;
+		uint64_t lookups;
+		uint64_t misses;
+	};
+	std::vector<MiniSimulation> mini_simulations_;
+};
+
+} // namespace rocksdb
@@ -0,0 +1,150 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "utilities/simulator_cache/cache_simulator.h"
+
+#include "port/port.h"
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace rocksdb
+{
+namespace
+{
+BlockCacheTraceRecord MakeAccess(const std::string &key, uint64_t size)
+{
+	BlockCacheTraceRecord record;
+	record.block_key = key;
+	record.block_type = kTraceDataBlock;
+	record.block_size = size;
+	record.caller = kTraceUserGet;
+	return record;
+}
+} // namespace
+
+class CacheSimulatorTest : public testing::Test {
+};
+
+TEST_F(CacheSimulatorTest, StackDistance)
+{
+	LRUStackDistance lru;
+	ASSERT_EQ(port::kMaxUint64, lru.Access("a", 1, false));
+	ASSERT_EQ(port::kMaxUint64, lru.Access("b", 2, false));
+	ASSERT_EQ(port::kMaxUint64, lru.Access("c", 3, false));
+	ASSERT_EQ(6U, lru.Access("a", 1, false));
+	ASSERT_EQ(1U, lru.Access("a", 1, false));
+	// A hit of a lookup that does not insert moves b to the top too
+	ASSERT_EQ(6U, lru.Access("b", 2, true));
+	ASSERT_EQ(2U, lru.Access("b", 2, false));
+	ASSERT_EQ(port::kMaxUint64, lru.Access("d", 4, true));
+	ASSERT_EQ(3U, lru.num_blocks());
+
+	// Enough accesses to renumber the tree a few times
+	for (int i = 0; i < 10000; i++) {
+		ASSERT_EQ(i == 0 ? 6U : 3U, lru.Access("c", 3, false));
+	}
+	ASSERT_EQ(5U, lru.Access("b", 2, false));
+	ASSERT_EQ(6U, lru.Access("a", 1, false));
+}
+
+TEST_F(CacheSimulatorTest, LRUCurveMatchesSimulation)
+{
+	const std::vector<uint64_t> capacities = { 4, 16, 64, 256 };
+	CacheSimulator simulator(capacities);
+	std::vector<std::unique_ptr<SimulatedCache> > caches;
+	std::vector<uint64_t> misses(capacities.size(), 0);
+	for (uint64_t capacity : capacities) {
+		caches.push_back(NewSimulatedCache(kSimLRU, capacity));
+	}
+
+	Random rnd(301);
+	for (int i = 0; i < 20000; i++) {
+		// Skewed keys, so that every capacity sees hits and misses
+		int block = rnd.Skewed(8);
+		BlockCacheTraceRecord record =
+			MakeAccess(ToString(block), 1 + block % 4);
+		simulator.Access(record);
+		for (size_t j = 0; j < caches.size(); j++) {
+			if (!caches[j]->Access(record.block_key,
+					       record.block_size, false)) {
+				misses[j]++;
+			}
+		}
+	}
+
+	ASSERT_EQ(20000U, simulator.lookups());
+	size_t lru_results = 0;
+	uint64_t prev_misses = port::kMaxUint64;
+	for (const auto &result : simulator.GetResults()) {
+		if (result.policy != kSimLRU) {
+			continue;
+		}
+		ASSERT_EQ(capacities[lru_results], result.capacity);
+		ASSERT_EQ(20000U, result.lookups);
+		ASSERT_EQ(misses[lru_results], result.misses);
+		// LRU never does worse with more memory
+		ASSERT_LE(result.misses, prev_misses);
+		prev_misses = result.misses;
+		lru_results++;
+	}
+	ASSERT_EQ(capacities.size(), lru_results);
+}
+
+TEST_F(CacheSimulatorTest, AdmissionKeepsScansOut)
+{
+	// A hot set of 10 blocks, warmed up and then interleaved with a scan
+	// of blocks read once. The scan pushes the hot blocks out of an LRU
+	// cache of 12, but never gets past the admission policy.
+	CacheSimulator simulator({ 12 });
+	for (int i = 0; i < 30; i++) {
+		simulator.Access(MakeAccess("hot" + ToString(i % 10), 1));
+	}
+	for (int i = 0; i < 1000; i++) {
+		simulator.Access(MakeAccess("hot" + ToString(i % 10), 1));
+		simulator.Access(MakeAccess("scan" + ToString(i), 1));
+	}
+
+	uint64_t misses[kSimPolicyMax] = { 0 };
+	auto results = simulator.GetResults();
+	ASSERT_EQ(static_cast<size_t>(kSimPolicyMax), results.size());
+	for (const auto &result : results) {
+		ASSERT_EQ(12U, result.capacity);
+		ASSERT_EQ(2030U, result.lookups);
+		misses[result.policy] = result.misses;
+	}
+	ASSERT_GT(misses[kSimLRU], 1900U);
+	// The two misses of each hot block admitting it, and the scan
+	ASSERT_EQ(20U + 1000U, misses[kSimLRUAdmitOnSecondMiss]);
+	ASSERT_LE(misses[kSimClock], 2030U);
+}
+
+TEST_F(CacheSimulatorTest, Sampling)
+{
+	CacheSimulator simulator({ 100, 1000 }, 4);
+	for (int i = 0; i < 8000; i++) {
+		simulator.Access(MakeAccess(ToString(i % 500), 1));
+	}
+	for (const auto &result : simulator.GetResults()) {
+		if (result.policy == kSimLRU) {
+			// Exact regardless of sampling
+			ASSERT_EQ(8000U, result.lookups);
+		} else {
+			ASSERT_GT(result.lookups, 800U);
+			ASSERT_LT(result.lookups, 4000U);
+		}
+		if (result.capacity == 1000) {
+			// Every block fits: only the first accesses miss
+			ASSERT_LE(result.misses * 8, result.lookups);
+		}
+	}
+}
+} // namespace rocksdb
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
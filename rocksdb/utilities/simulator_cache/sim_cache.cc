@@ -144,6 +144,13 @@ class SimCacheImpl : public SimCache {
 		key_only_cache_->EraseUnRefEntries();
 	}
 
+	virtual void
+	SetEvictionCallback(const EvictionCallback &callback) override
+	{
+		// only cache_ holds values worth reporting
+		cache_->SetEvictionCallback(callback);
+	}
+
 	virtual size_t GetSimCapacity() const override
 	{
 		return key_only_cache_->GetCapacity();
@@ -12,12 +12,15 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <functional>
 #include <inttypes.h>
 #include <string>
 #include <vector>
 #include <mutex>
 #include <thread>
+#include <queue>
 #include <set>
 #include <unordered_set>
 
@@ -25,11 +28,13 @@
 #include "rocksdb/options.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/sst_file_writer.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/table.h"
 #include "rocksdb/db.h"
 #include "rocksdb/utilities/stackable_db.h"
 #include "util/coding.h"
+#include "util/string_util.h"
 #include "utilities/spatialdb/utils.h"
 #include "port/port.h"
 
@@ -687,6 +692,129 @@ class SpatialDBImpl : public SpatialDB {
 		return Write(write_options, &batch);
 	}
 
+	virtual Status BulkInsert(const std::vector<SpatialElement> &elements,
+				  int num_threads) override
+	{
+		if (read_only_) {
+			return Status::NotSupported(
+				"Can't bulk insert into a read only DB");
+		}
+		if (elements.empty()) {
+			return Status::OK();
+		}
+		std::unordered_map<std::string, size_t> index_numbers;
+		std::vector<const IndexColumnFamily *> indexes;
+		for (const auto &iter : name_to_index_) {
+			index_numbers.insert({ iter.first, indexes.size() });
+			indexes.push_back(&iter.second);
+		}
+		for (const auto &element : elements) {
+			if (element.spatial_indexes.size() == 0) {
+				return Status::InvalidArgument(
+					"Spatial indexes can't be empty");
+			}
+			for (const auto &si : element.spatial_indexes) {
+				if (index_numbers.count(si) == 0) {
+					return Status::InvalidArgument(
+						"Can't find index " + si);
+				}
+			}
+		}
+		size_t threads_count = static_cast<size_t>(
+			std::max(num_threads, 1));
+		threads_count = std::min(threads_count, elements.size());
+		uint64_t first_id = next_id_.fetch_add(elements.size());
+
+		// Each thread sorts the tiles of a slice of the elements, which
+		// gives one sorted run per thread and per index
+		std::vector<std::vector<TileRun> > runs(
+			threads_count, std::vector<TileRun>(indexes.size()));
+		std::vector<port::Thread> threads;
+		for (size_t t = 0; t < threads_count; ++t) {
+			threads.emplace_back([&, t] {
+				size_t begin =
+					elements.size() * t / threads_count;
+				size_t end = elements.size() * (t + 1) /
+					     threads_count;
+				ComputeTiles(elements, begin, end, first_id,
+					     index_numbers, indexes, &runs[t]);
+			});
+		}
+		for (auto &t : threads) {
+			t.join();
+		}
+		threads.clear();
+
+		// The data file comes first so that it's ingested before the
+		// index entries pointing into it. Indexes without entries
+		// get no file.
+		std::vector<ColumnFamilyHandle *> column_families;
+		std::vector<size_t> index_of_file;
+		column_families.push_back(data_column_family_);
+		index_of_file.push_back(indexes.size());
+		for (size_t i = 0; i < indexes.size(); ++i) {
+			for (size_t t = 0; t < threads_count; ++t) {
+				if (!runs[t][i].empty()) {
+					column_families.push_back(
+						indexes[i]->column_family);
+					index_of_file.push_back(i);
+					break;
+				}
+			}
+		}
+		std::vector<std::string> file_names;
+		for (size_t f = 0; f < column_families.size(); ++f) {
+			file_names.push_back(GetName() + "/spatial_bulk_" +
+					     ToString(first_id) + "_" +
+					     ToString(f) + ".sst");
+		}
+
+		// Merge the runs into the files, one file per thread at a time
+		auto write_file = [&](size_t f) {
+			size_t i = index_of_file[f];
+			if (i == indexes.size()) {
+				return WriteDataFile(elements, first_id,
+						     file_names[f]);
+			}
+			return WriteIndexFile(runs, i, column_families[f],
+					      file_names[f]);
+		};
+		std::vector<Status> file_status(column_families.size());
+		std::atomic<size_t> next_file(0);
+		threads_count = std::min(
+			static_cast<size_t>(std::max(num_threads, 1)),
+			column_families.size());
+		for (size_t t = 0; t < threads_count; ++t) {
+			threads.emplace_back([&] {
+				size_t f;
+				while ((f = next_file.fetch_add(1)) <
+				       column_families.size()) {
+					file_status[f] = write_file(f);
+				}
+			});
+		}
+		for (auto &t : threads) {
+			t.join();
+		}
+
+		Status s;
+		for (size_t f = 0; f < column_families.size() && s.ok(); ++f) {
+			s = file_status[f];
+		}
+		IngestExternalFileOptions ingest_options;
+		ingest_options.move_files = true;
+		for (size_t f = 0; f < column_families.size() && s.ok(); ++f) {
+			s = IngestExternalFile(column_families[f],
+					       { file_names[f] },
+					       ingest_options);
+		}
+		// Ingested files were moved, this cleans up after a failure
+		for (const auto &file_name : file_names) {
+			GetEnv()->DeleteFile(file_name);
+		}
+		return s;
+	}
+
 	virtual Status Compact(int num_threads) override
 	{
 		std::vector<ColumnFamilyHandle *> column_families;
@@ -792,6 +920,123 @@ class SpatialDBImpl : public SpatialDB {
 	// constant after construction!
 	std::unordered_map<std::string, IndexColumnFamily> name_to_index_;
 
+	// (quad key, id) of the entries of a spatial index
+	typedef std::vector<std::pair<uint64_t, uint64_t> > TileRun;
+
+	// Adds the tiles of elements [begin, end) to the runs of the indexes
+	// they're inserted in, then sorts the runs
+	static void ComputeTiles(
+		const std::vector<SpatialElement> &elements, size_t begin,
+		size_t end, uint64_t first_id,
+		const std::unordered_map<std::string, size_t> &index_numbers,
+		const std::vector<const IndexColumnFamily *> &indexes,
+		std::vector<TileRun> *runs)
+	{
+		for (size_t e = begin; e < end; ++e) {
+			const SpatialElement &element = elements[e];
+			for (const auto &si : element.spatial_indexes) {
+				size_t i = index_numbers.find(si)->second;
+				const auto &spatial_index = indexes[i]->index;
+				if (!spatial_index.bbox.Intersects(
+					    element.bbox)) {
+					continue;
+				}
+				BoundingBox<uint64_t> tile_bbox =
+					GetTileBoundingBox(spatial_index,
+							   element.bbox);
+				uint32_t tile_bits = spatial_index.tile_bits;
+				TileRun &run = (*runs)[i];
+				for (uint64_t x = tile_bbox.min_x;
+				     x <= tile_bbox.max_x; ++x) {
+					for (uint64_t y = tile_bbox.min_y;
+					     y <= tile_bbox.max_y; ++y) {
+						uint64_t quad_key =
+							GetQuadKeyFromTile(
+								x, y,
+								tile_bits);
+						run.emplace_back(quad_key,
+								 first_id + e);
+					}
+				}
+			}
+		}
+		for (auto &run : *runs) {
+			std::sort(run.begin(), run.end());
+		}
+	}
+
+	// Writes the entries of index number `index` to a table file, merging
+	// the sorted runs of all threads
+	Status WriteIndexFile(const std::vector<std::vector<TileRun> > &runs,
+			      size_t index, ColumnFamilyHandle *column_family,
+			      const std::string &file_name)
+	{
+		SstFileWriter writer(EnvOptions(), GetOptions(column_family),
+				     column_family);
+		Status s = writer.Open(file_name);
+
+		// (entry, thread), smallest entry first
+		typedef std::pair<std::pair<uint64_t, uint64_t>, size_t>
+			HeapEntry;
+		std::priority_queue<HeapEntry, std::vector<HeapEntry>,
+				    std::greater<HeapEntry> >
+			heap;
+		std::vector<size_t> positions(runs.size(), 0);
+		for (size_t t = 0; t < runs.size(); ++t) {
+			if (!runs[t][index].empty()) {
+				heap.push({ runs[t][index][0], t });
+			}
+		}
+		bool has_last = false;
+		std::pair<uint64_t, uint64_t> last;
+		while (s.ok() && !heap.empty()) {
+			HeapEntry top = heap.top();
+			heap.pop();
+			const TileRun &run = runs[top.second][index];
+			size_t &position = positions[top.second];
+			if (++position < run.size()) {
+				heap.push({ run[position], top.second });
+			}
+			// An element may list the same index twice
+			if (has_last && top.first == last) {
+				continue;
+			}
+			// see above for format
+			std::string key;
+			PutFixed64BigEndian(&key, top.first.first);
+			PutFixed64BigEndian(&key, top.first.second);
+			s = writer.Put(key, Slice());
+			has_last = true;
+			last = top.first;
+		}
+		if (s.ok()) {
+			s = writer.Finish();
+		}
+		return s;
+	}
+
+	Status WriteDataFile(const std::vector<SpatialElement> &elements,
+			     uint64_t first_id, const std::string &file_name)
+	{
+		SstFileWriter writer(EnvOptions(),
+				     GetOptions(data_column_family_),
+				     data_column_family_);
+		Status s = writer.Open(file_name);
+		for (size_t e = 0; e < elements.size() && s.ok(); ++e) {
+			// see above for format
+			std::string data_key;
+			PutFixed64BigEndian(&data_key, first_id + e);
+			std::string data_value;
+			PutLengthPrefixedSlice(&data_value, elements[e].blob);
+			elements[e].feature_set.Serialize(&data_value);
+			s = writer.Put(data_key, data_value);
+		}
+		if (s.ok()) {
+			s = writer.Finish();
+		}
+		return s;
+	}
+
 	std::atomic<uint64_t> next_id_;
 	bool read_only_;
 };
@@ -323,6 +323,98 @@ TEST_F(SpatialDBTest, RandomizedTest)
 	delete db_;
 }
 
+TEST_F(SpatialDBTest, BulkInsert)
+{
+	if (!LZ4_Supported()) {
+		return;
+	}
+	Random rnd(301);
+	std::vector<std::pair<std::string, BoundingBox<int> > > elements;
+
+	BoundingBox<double> spatial_index_bounds(0, 0, (1LL << 32),
+						 (1LL << 32));
+	ASSERT_OK(SpatialDB::Create(
+		SpatialDBOptions(), dbname_,
+		{ SpatialIndexOptions("index", spatial_index_bounds, 7),
+		  SpatialIndexOptions("other", spatial_index_bounds, 7) }));
+	ASSERT_OK(SpatialDB::Open(SpatialDBOptions(), dbname_, &db_));
+	double step = (1LL << 32) / (1 << 7);
+
+	// mixed with regular inserts, which have to get other ids
+	std::vector<SpatialElement> batch;
+	for (int i = 0; i < 1000; ++i) {
+		std::string blob = RandomStr(&rnd);
+		BoundingBox<int> bbox = RandomBoundingBox(128, &rnd, 10);
+		if (i % 100 == 0) {
+			ASSERT_OK(db_->Insert(WriteOptions(),
+					      ScaleBB(bbox, step), blob,
+					      FeatureSet(), { "index" }));
+		} else {
+			SpatialElement element;
+			element.bbox = ScaleBB(bbox, step);
+			element.blob = blob;
+			element.feature_set.Set("i", static_cast<uint64_t>(i));
+			// the same index twice is the same as once
+			element.spatial_indexes = { "index", "index" };
+			batch.push_back(element);
+		}
+		elements.push_back(make_pair(blob, bbox));
+		if (batch.size() == 300) {
+			ASSERT_OK(db_->BulkInsert(batch, 3));
+			batch.clear();
+		}
+	}
+	ASSERT_OK(db_->BulkInsert(batch, 2));
+
+	batch.resize(1);
+	batch[0].spatial_indexes = { "index", "missing" };
+	ASSERT_TRUE(db_->BulkInsert(batch).IsInvalidArgument());
+	batch[0].spatial_indexes.clear();
+	ASSERT_TRUE(db_->BulkInsert(batch).IsInvalidArgument());
+
+	// iter 0 -- not read only
+	// iter 1 -- read only
+	for (int iter = 0; iter < 2; ++iter) {
+		if (iter == 1) {
+			delete db_;
+			db_ = nullptr;
+			ASSERT_OK(SpatialDB::Open(SpatialDBOptions(), dbname_,
+						  &db_, true));
+			batch[0].spatial_indexes = { "index" };
+			ASSERT_TRUE(db_->BulkInsert(batch).IsNotSupported());
+		}
+		for (int i = 0; i < 100; ++i) {
+			BoundingBox<int> int_bbox =
+				RandomBoundingBox(128, &rnd, 10);
+			BoundingBox<double> double_bbox =
+				ScaleBB(int_bbox, step);
+			std::vector<std::string> blobs;
+			for (auto e : elements) {
+				if (e.second.Intersects(int_bbox)) {
+					blobs.push_back(e.first);
+				}
+			}
+			AssertCursorResults(double_bbox, "index", blobs);
+			AssertCursorResults(double_bbox, "other", {});
+		}
+	}
+
+	Cursor *c = db_->Query(ReadOptions(), spatial_index_bounds, "index");
+	size_t count = 0;
+	for (; c->Valid(); c->Next()) {
+		if (c->feature_set().Contains("i")) {
+			uint64_t i = c->feature_set().Get("i").get_int();
+			ASSERT_EQ(elements[i].first, c->blob().ToString());
+		}
+		++count;
+	}
+	ASSERT_OK(c->status());
+	ASSERT_EQ(elements.size(), count);
+	delete c;
+
+	delete db_;
+}
+
 } // namespace spatial
 } // namespace rocksdb
 
@@ -0,0 +1,140 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/trace_reader_writer.h"
+
+#include "util/coding.h"
+#include "util/file_reader_writer.h"
+#include "util/trace_replay.h"
+
+namespace rocksdb
+{
+namespace
+{
+class FileTraceReader : public TraceReader {
+    public:
+	explicit FileTraceReader(std::unique_ptr<SequentialFileReader> &&reader)
+		: file_reader_(std::move(reader))
+	{
+	}
+
+	~FileTraceReader()
+	{
+		Close();
+	}
+
+	virtual Status Read(std::string *data) override
+	{
+		assert(file_reader_ != nullptr);
+		Slice result;
+		char meta[kTraceMetadataSize];
+		Status s =
+			file_reader_->Read(kTraceMetadataSize, &result, meta);
+		if (!s.ok()) {
+			return s;
+		}
+		if (result.size() < kTraceMetadataSize) {
+			// End of the trace, or a record cut short by a crash
+			return Status::Incomplete("End of trace file");
+		}
+		*data = result.ToString();
+		const uint32_t payload_len = DecodeFixed32(
+			data->data() + kTraceTimestampSize + kTraceTypeSize);
+
+		std::string payload(payload_len, '\0');
+		if (payload_len > 0) {
+			s = file_reader_->Read(payload_len, &result,
+					       &payload[0]);
+			if (!s.ok()) {
+				return s;
+			}
+			if (result.size() < payload_len) {
+				return Status::Incomplete("End of trace file");
+			}
+		}
+		data->append(result.data(), payload_len);
+		return Status::OK();
+	}
+
+	virtual Status Close() override
+	{
+		file_reader_.reset();
+		return Status::OK();
+	}
+
+    private:
+	std::unique_ptr<SequentialFileReader> file_reader_;
+};
+
+class FileTraceWriter : public TraceWriter {
+    public:
+	explicit FileTraceWriter(std::unique_ptr<WritableFileWriter> &&writer)
+		: file_writer_(std::move(writer))
+	{
+	}
+
+	~FileTraceWriter()
+	{
+		Close();
+	}
+
+	virtual Status Write(const Slice &data) override
+	{
+		return file_writer_->Append(data);
+	}
+
+	virtual Status Close() override
+	{
+		if (file_writer_ == nullptr) {
+			return Status::OK();
+		}
+		Status s = file_writer_->Close();
+		file_writer_.reset();
+		return s;
+	}
+
+	virtual uint64_t GetFileSize() override
+	{
+		return file_writer_ ? file_writer_->GetFileSize() : 0;
+	}
+
+    private:
+	std::unique_ptr<WritableFileWriter> file_writer_;
+};
+} // namespace
+
+Status NewFileTraceReader(Env *env, const EnvOptions &env_options,
+			  const std::string &trace_filename,
+			  std::unique_ptr<TraceReader> *trace_reader)
+{
+	unique_ptr<SequentialFile> trace_file;
+	Status s = env->NewSequentialFile(trace_filename, &trace_file,
+					  env_options);
+	if (!s.ok()) {
+		return s;
+	}
+	std::unique_ptr<SequentialFileReader> file_reader(
+		new SequentialFileReader(std::move(trace_file)));
+	trace_reader->reset(new FileTraceReader(std::move(file_reader)));
+	return s;
+}
+
+Status NewFileTraceWriter(Env *env, const EnvOptions &env_options,
+			  const std::string &trace_filename,
+			  std::unique_ptr<TraceWriter> *trace_writer)
+{
+	unique_ptr<WritableFile> trace_file;
+	Status s = env->NewWritableFile(trace_filename, &trace_file,
+					env_options);
+	if (!s.ok()) {
+		return s;
+	}
+	std::unique_ptr<WritableFileWriter> file_writer(
+		new WritableFileWriter(std::move(trace_file), env_options));
+	trace_writer->reset(new FileTraceWriter(std::move(file_writer)));
+	return s;
+}
+
+} // namespace rocksdb
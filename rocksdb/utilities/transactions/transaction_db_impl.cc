@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "db/db_impl.h"
+#include "monitoring/thread_status_util.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/utilities/transaction_db.h"
@@ -290,6 +291,12 @@ Status TransactionDBImpl::DropColumnFamily(ColumnFamilyHandle *column_family)
 Status TransactionDBImpl::TryLock(TransactionImpl *txn, uint32_t cfh_id,
 				  const std::string &key, bool exclusive)
 {
+	auto cfh = reinterpret_cast<ColumnFamilyHandleImpl *>(
+		db_impl_->DefaultColumnFamily());
+	AutoThreadOperationUpdater op_updater(
+		GetEnv(), cfh->cfd(),
+		db_impl_->immutable_db_options().enable_thread_tracking,
+		ThreadStatus::OP_LOCK);
 	return lock_mgr_.TryLock(txn, cfh_id, key, GetEnv(), exclusive);
 }
 
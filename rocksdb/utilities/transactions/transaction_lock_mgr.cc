@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 
+#include "monitoring/thread_status_util.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/utilities/transaction_db_mutex.h"
 #include "util/murmurhash.h"
@@ -291,11 +292,16 @@ Status TransactionLockMgr::AcquireWithTimeout(
 		end_time = start_time + timeout;
 	}
 
-	if (timeout < 0) {
-		// If timeout is negative, we wait indefinitely to acquire the lock
-		result = stripe->stripe_mutex->Lock();
-	} else {
-		result = stripe->stripe_mutex->TryLockFor(timeout);
+	{
+		AutoThreadStateUpdater state_updater(
+			ThreadStatus::STATE_LOCK_WAIT, env);
+		if (timeout < 0) {
+			// If timeout is negative, we wait indefinitely to
+			// acquire the lock
+			result = stripe->stripe_mutex->Lock();
+		} else {
+			result = stripe->stripe_mutex->TryLockFor(timeout);
+		}
 	}
 
 	if (!result.ok()) {
@@ -347,6 +353,8 @@ Status TransactionLockMgr::AcquireWithTimeout(
 
 			TEST_SYNC_POINT(
 				"TransactionLockMgr::AcquireWithTimeout:WaitingTxn");
+			AutoThreadStateUpdater state_updater(
+				ThreadStatus::STATE_LOCK_WAIT, env);
 			if (cv_end_time < 0) {
 				// Wait indefinitely
 				result = stripe->stripe_cv->Wait(
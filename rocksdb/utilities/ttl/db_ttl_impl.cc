@@ -12,6 +12,8 @@
 #include "rocksdb/utilities/db_ttl.h"
 #include "util/coding.h"
 #include "util/filename.h"
+#include "util/logging.h"
+#include "util/string_util.h"
 
 namespace rocksdb
 {
@@ -33,15 +35,23 @@ void DBWithTTLImpl::SanitizeOptions(int32_t ttl, ColumnFamilyOptions *options,
 		options->merge_operator.reset(
 			new TtlMergeOperator(options->merge_operator, env));
 	}
+
+	options->table_properties_collector_factories.push_back(
+		std::make_shared<TtlTablePropertiesCollectorFactory>());
 }
 
 // Open the db inside DBWithTTLImpl because options needs pointer to its ttl
-DBWithTTLImpl::DBWithTTLImpl(DB *db) : DBWithTTL(db)
+DBWithTTLImpl::DBWithTTLImpl(
+	DB *db, const std::shared_ptr<TtlExpiryListener> &expiry_listener)
+	: DBWithTTL(db), expiry_listener_(expiry_listener)
 {
 }
 
 DBWithTTLImpl::~DBWithTTLImpl()
 {
+	if (expiry_listener_) {
+		expiry_listener_->Stop();
+	}
 	// Need to stop background compaction before getting rid of the filter
 	CancelAllBackgroundWork(db_, /* wait = */ true);
 	delete GetOptions().compaction_filter;
@@ -91,27 +101,41 @@ DBWithTTL::Open(const DBOptions &db_options, const std::string &dbname,
 			"ttls size has to be the same as number of column families");
 	}
 
+	Env *env = db_options.env == nullptr ? Env::Default() : db_options.env;
 	std::vector<ColumnFamilyDescriptor> column_families_sanitized =
 		column_families;
 	for (size_t i = 0; i < column_families_sanitized.size(); ++i) {
 		DBWithTTLImpl::SanitizeOptions(
-			ttls[i], &column_families_sanitized[i].options,
-			db_options.env == nullptr ? Env::Default() :
-							  db_options.env);
+			ttls[i], &column_families_sanitized[i].options, env);
 	}
 	DB *db;
 
 	Status st;
+	std::shared_ptr<TtlExpiryListener> expiry_listener;
 	if (read_only) {
 		st = DB::OpenForReadOnly(db_options, dbname,
 					 column_families_sanitized, handles,
 					 &db);
 	} else {
-		st = DB::Open(db_options, dbname, column_families_sanitized,
-			      handles, &db);
+		expiry_listener = std::make_shared<TtlExpiryListener>(env);
+		DBOptions db_options_with_listener = db_options;
+		db_options_with_listener.listeners.push_back(expiry_listener);
+		st = DB::Open(db_options_with_listener, dbname,
+			      column_families_sanitized, handles, &db);
 	}
 	if (st.ok()) {
-		*dbptr = new DBWithTTLImpl(db);
+		*dbptr = new DBWithTTLImpl(db, expiry_listener);
+		for (size_t i = 0; expiry_listener && i < handles->size();
+		     ++i) {
+			ColumnFamilyHandle *handle = (*handles)[i];
+			expiry_listener->AddColumnFamily(handle->GetName(),
+							 handle->GetID(),
+							 ttls[i]);
+			// Files may have expired while the db was closed. A
+			// failure here is left for the next flush to retry.
+			DBWithTTLImpl::ExpireTableFiles(db, handle, ttls[i],
+							env);
+		}
 	} else {
 		*dbptr = nullptr;
 	}
@@ -126,8 +150,13 @@ DBWithTTLImpl::CreateColumnFamilyWithTtl(const ColumnFamilyOptions &options,
 	ColumnFamilyOptions sanitized_options = options;
 	DBWithTTLImpl::SanitizeOptions(ttl, &sanitized_options, GetEnv());
 
-	return DBWithTTL::CreateColumnFamily(sanitized_options,
-					     column_family_name, handle);
+	Status s = DBWithTTL::CreateColumnFamily(sanitized_options,
+						 column_family_name, handle);
+	if (s.ok() && expiry_listener_) {
+		expiry_listener_->AddColumnFamily(column_family_name,
+						  (*handle)->GetID(), ttl);
+	}
+	return s;
 }
 
 Status DBWithTTLImpl::CreateColumnFamily(const ColumnFamilyOptions &options,
@@ -138,6 +167,94 @@ Status DBWithTTLImpl::CreateColumnFamily(const ColumnFamilyOptions &options,
 					 0);
 }
 
+Status DBWithTTLImpl::DropExpiredFiles(ColumnFamilyHandle *column_family)
+{
+	if (!expiry_listener_) {
+		return Status::NotSupported("Not supported in read-only mode");
+	}
+	int32_t ttl = 0;
+	if (!expiry_listener_->GetTtl(column_family->GetName(), &ttl)) {
+		return Status::InvalidArgument("Unknown column family");
+	}
+	return ExpireTableFiles(db_, column_family, ttl, GetEnv());
+}
+
+void DBWithTTLImpl::TEST_WaitForBackgroundExpiry()
+{
+	if (expiry_listener_) {
+		expiry_listener_->TEST_WaitForBackgroundExpiry();
+	}
+}
+
+namespace
+{
+const double kExpiredFractionToCompact = 0.5;
+} // namespace
+
+// A file is dropped only if it has no entry without a timestamp, such as a
+// deletion, whose dropping could bring back an older value. Its values are
+// taken to be written evenly between its oldest and newest timestamps, so a
+// file is compacted once about kExpiredFractionToCompact of them expired.
+Status DBWithTTLImpl::ExpireTableFiles(DB *db,
+				       ColumnFamilyHandle *column_family,
+				       int32_t ttl, Env *env)
+{
+	if (ttl <= 0) {
+		return Status::OK();
+	}
+	int64_t curtime;
+	Status s = env->GetCurrentTime(&curtime);
+	if (!s.ok()) {
+		return s;
+	}
+	TablePropertiesCollection props;
+	s = db->GetPropertiesOfAllTables(column_family, &props);
+	if (!s.ok()) {
+		return s;
+	}
+	std::set<uint64_t> files_to_drop;
+	std::set<uint64_t> files_to_compact;
+	for (const auto &entry : props) {
+		int32_t min_timestamp, max_timestamp;
+		uint64_t num_entries_without_ts;
+		uint64_t number;
+		FileType type;
+		if (!TtlTablePropertiesCollector::GetTimestamps(
+			    *entry.second, &min_timestamp, &max_timestamp,
+			    &num_entries_without_ts) ||
+		    !ParseFileName(entry.first.substr(
+					   entry.first.rfind('/') + 1),
+				   &number, &type) ||
+		    type != kTableFile) {
+			continue;
+		}
+		// values written before the horizon have expired
+		const int64_t horizon = curtime - ttl;
+		if (num_entries_without_ts == 0 && max_timestamp < horizon) {
+			files_to_drop.insert(number);
+		} else if (min_timestamp < horizon) {
+			const int32_t span = max_timestamp - min_timestamp;
+			const double expired =
+				span > 0 ? static_cast<double>(horizon -
+							       min_timestamp) /
+						   span :
+					   1.0;
+			if (expired >= kExpiredFractionToCompact) {
+				files_to_compact.insert(number);
+			}
+		}
+	}
+	DBImpl *db_impl = reinterpret_cast<DBImpl *>(db->GetRootDB());
+	if (!files_to_drop.empty()) {
+		s = db_impl->DeleteTableFiles(column_family, files_to_drop);
+	}
+	if (s.ok() && !files_to_compact.empty()) {
+		s = db_impl->MarkTableFilesForCompaction(column_family,
+							 files_to_compact);
+	}
+	return s;
+}
+
 // Appends the current timestamp to the string.
 // Returns false if could not get the current_time, true if append succeeds
 Status DBWithTTLImpl::AppendTS(const Slice &val, std::string *val_with_ts,
@@ -352,5 +469,193 @@ Iterator *DBWithTTLImpl::NewIterator(const ReadOptions &opts,
 	return new TtlIterator(db_->NewIterator(opts, column_family));
 }
 
+const std::string TtlTablePropertiesCollector::kPropMinTimestamp =
+	"rocksdb.ttl.min-timestamp";
+const std::string TtlTablePropertiesCollector::kPropMaxTimestamp =
+	"rocksdb.ttl.max-timestamp";
+const std::string TtlTablePropertiesCollector::kPropNumEntriesWithoutTimestamp =
+	"rocksdb.ttl.num-entries-without-timestamp";
+
+Status TtlTablePropertiesCollector::AddUserKey(const Slice &key,
+					       const Slice &value,
+					       EntryType type,
+					       SequenceNumber seq,
+					       uint64_t file_size)
+{
+	if ((type == kEntryPut || type == kEntryMerge) &&
+	    value.size() >= DBWithTTLImpl::kTSLength) {
+		int32_t timestamp = DecodeFixed32(value.data() + value.size() -
+						  DBWithTTLImpl::kTSLength);
+		min_timestamp_ = std::min(min_timestamp_, timestamp);
+		max_timestamp_ = std::max(max_timestamp_, timestamp);
+	} else {
+		num_entries_without_ts_++;
+	}
+	return Status::OK();
+}
+
+Status TtlTablePropertiesCollector::Finish(UserCollectedProperties *properties)
+{
+	if (max_timestamp_ > 0) {
+		std::string timestamp;
+		PutFixed32(&timestamp, min_timestamp_);
+		properties->insert({ kPropMinTimestamp, timestamp });
+		timestamp.clear();
+		PutFixed32(&timestamp, max_timestamp_);
+		properties->insert({ kPropMaxTimestamp, timestamp });
+	}
+	std::string num_entries;
+	PutVarint64(&num_entries, num_entries_without_ts_);
+	properties->insert({ kPropNumEntriesWithoutTimestamp, num_entries });
+	return Status::OK();
+}
+
+UserCollectedProperties
+TtlTablePropertiesCollector::GetReadableProperties() const
+{
+	UserCollectedProperties readable;
+	if (max_timestamp_ > 0) {
+		readable.insert(
+			{ kPropMinTimestamp, ToString(min_timestamp_) });
+		readable.insert(
+			{ kPropMaxTimestamp, ToString(max_timestamp_) });
+	}
+	readable.insert({ kPropNumEntriesWithoutTimestamp,
+			  ToString(num_entries_without_ts_) });
+	return readable;
+}
+
+bool TtlTablePropertiesCollector::GetTimestamps(
+	const TableProperties &props, int32_t *min_timestamp,
+	int32_t *max_timestamp, uint64_t *num_entries_without_ts)
+{
+	const auto &user_props = props.user_collected_properties;
+	auto min_iter = user_props.find(kPropMinTimestamp);
+	auto max_iter = user_props.find(kPropMaxTimestamp);
+	auto num_iter = user_props.find(kPropNumEntriesWithoutTimestamp);
+	if (min_iter == user_props.end() || max_iter == user_props.end() ||
+	    num_iter == user_props.end() ||
+	    min_iter->second.size() != sizeof(int32_t) ||
+	    max_iter->second.size() != sizeof(int32_t)) {
+		return false;
+	}
+	*min_timestamp = DecodeFixed32(min_iter->second.data());
+	*max_timestamp = DecodeFixed32(max_iter->second.data());
+	Slice num_entries(num_iter->second);
+	return GetVarint64(&num_entries, num_entries_without_ts);
+}
+
+void TtlExpiryListener::AddColumnFamily(const std::string &name, uint32_t id,
+					int32_t ttl)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	column_families_[name] = { id, ttl, 0 };
+}
+
+bool TtlExpiryListener::GetTtl(const std::string &name, int32_t *ttl)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto iter = column_families_.find(name);
+	if (iter == column_families_.end()) {
+		return false;
+	}
+	*ttl = iter->second.ttl;
+	return true;
+}
+
+void TtlExpiryListener::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopped_ = true;
+		column_families_.clear();
+		pending_.clear();
+	}
+	env_->UnSchedule(this, Env::Priority::LOW);
+	std::unique_lock<std::mutex> lock(mutex_);
+	WaitForBackgroundExpiry(&lock);
+}
+
+void TtlExpiryListener::OnFlushCompleted(DB *db,
+					 const FlushJobInfo &flush_job_info)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto iter = column_families_.find(flush_job_info.cf_name);
+	if (iter == column_families_.end() || iter->second.ttl <= 0) {
+		return;
+	}
+	// Timestamps are in seconds, so once a second is enough
+	int64_t curtime;
+	if (!env_->GetCurrentTime(&curtime).ok() ||
+	    curtime == iter->second.last_check_time) {
+		return;
+	}
+	iter->second.last_check_time = curtime;
+	pending_[iter->first] = iter->second;
+	db_ = db;
+	if (!bg_scheduled_) {
+		bg_scheduled_ = true;
+		env_->Schedule(&TtlExpiryListener::BGWorkExpire, this,
+			       Env::Priority::LOW, this,
+			       &TtlExpiryListener::UnscheduleExpire);
+	}
+}
+
+void TtlExpiryListener::TEST_WaitForBackgroundExpiry()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	WaitForBackgroundExpiry(&lock);
+}
+
+void TtlExpiryListener::BGWorkExpire(void *arg)
+{
+	reinterpret_cast<TtlExpiryListener *>(arg)->BackgroundExpire();
+}
+
+void TtlExpiryListener::UnscheduleExpire(void *arg)
+{
+	TtlExpiryListener *listener =
+		reinterpret_cast<TtlExpiryListener *>(arg);
+	std::lock_guard<std::mutex> lock(listener->mutex_);
+	listener->bg_scheduled_ = false;
+	listener->bg_cv_.notify_all();
+}
+
+void TtlExpiryListener::BackgroundExpire()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (!stopped_ && !pending_.empty()) {
+		const std::string cf_name = pending_.begin()->first;
+		const ColumnFamilyTtl cf_ttl = pending_.begin()->second;
+		pending_.erase(pending_.begin());
+		DB *db = db_;
+		lock.unlock();
+
+		// The user's handles may be deleted while this runs
+		DBImpl *db_impl = reinterpret_cast<DBImpl *>(db->GetRootDB());
+		std::unique_ptr<ColumnFamilyHandle> handle =
+			db_impl->NewColumnFamilyHandleUnlocked(cf_ttl.id);
+		if (handle != nullptr) {
+			Status s = DBWithTTLImpl::ExpireTableFiles(
+				db, handle.get(), cf_ttl.ttl, env_);
+			if (!s.ok()) {
+				ROCKS_LOG_WARN(
+					db->GetDBOptions().info_log,
+					"Failed to expire the files of %s: %s",
+					cf_name.c_str(), s.ToString().c_str());
+			}
+		}
+		lock.lock();
+	}
+	bg_scheduled_ = false;
+	bg_cv_.notify_all();
+}
+
+void TtlExpiryListener::WaitForBackgroundExpiry(
+	std::unique_lock<std::mutex> *lock)
+{
+	bg_cv_.wait(*lock, [this] { return !bg_scheduled_; });
+}
+
 } // namespace rocksdb
 #endif // ROCKSDB_LITE
@@ -5,14 +5,19 @@
 #pragma once
 
 #ifndef ROCKSDB_LITE
+#include <condition_variable>
 #include <deque>
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/compaction_filter.h"
+#include "rocksdb/listener.h"
 #include "rocksdb/merge_operator.h"
+#include "rocksdb/table_properties.h"
 #include "rocksdb/utilities/utility_db.h"
 #include "rocksdb/utilities/db_ttl.h"
 #include "db/db_impl.h"
@@ -24,12 +29,17 @@
 
 namespace rocksdb
 {
+class TtlExpiryListener;
+
 class DBWithTTLImpl : public DBWithTTL {
     public:
 	static void SanitizeOptions(int32_t ttl, ColumnFamilyOptions *options,
 				    Env *env);
 
-	explicit DBWithTTLImpl(DB *db);
+	// expiry_listener is null if the db is read-only
+	DBWithTTLImpl(
+		DB *db,
+		const std::shared_ptr<TtlExpiryListener> &expiry_listener);
 
 	virtual ~DBWithTTLImpl();
 
@@ -83,6 +93,18 @@ class DBWithTTLImpl : public DBWithTTL {
 		return db_;
 	}
 
+	virtual Status
+	DropExpiredFiles(ColumnFamilyHandle *column_family) override;
+
+	// Waits for the expiry scheduled by the flushes so far
+	void TEST_WaitForBackgroundExpiry();
+
+	// Drops the table files of the column family whose values have all
+	// expired, and marks for compaction those with enough expired values.
+	static Status ExpireTableFiles(DB *db,
+				       ColumnFamilyHandle *column_family,
+				       int32_t ttl, Env *env);
+
 	static bool IsStale(const Slice &value, int32_t ttl, Env *env);
 
 	static Status AppendTS(const Slice &val, std::string *val_with_ts,
@@ -101,6 +123,9 @@ class DBWithTTLImpl : public DBWithTTL {
 
 	static const int32_t kMaxTimestamp =
 		2147483647; // 01/18/2038:7:14PM GMT-8
+
+    private:
+	std::shared_ptr<TtlExpiryListener> expiry_listener_;
 };
 
 class TtlIterator : public Iterator {
@@ -274,6 +299,115 @@ class TtlCompactionFilterFactory : public CompactionFilterFactory {
 	std::shared_ptr<CompactionFilterFactory> user_comp_filter_factory_;
 };
 
+// Records the oldest and newest timestamp of the values of a table file, and
+// the number of its entries without one, such as deletions, in its table
+// properties.
+class TtlTablePropertiesCollector : public TablePropertiesCollector {
+    public:
+	TtlTablePropertiesCollector()
+		: min_timestamp_(DBWithTTLImpl::kMaxTimestamp),
+		  max_timestamp_(0), num_entries_without_ts_(0)
+	{
+	}
+
+	virtual Status AddUserKey(const Slice &key, const Slice &value,
+				  EntryType type, SequenceNumber seq,
+				  uint64_t file_size) override;
+
+	virtual Status Finish(UserCollectedProperties *properties) override;
+
+	virtual UserCollectedProperties GetReadableProperties() const override;
+
+	virtual const char *Name() const override
+	{
+		return "TtlTablePropertiesCollector";
+	}
+
+	// Reads the properties of a table file written by this collector.
+	// Returns false if it has none, or no value with a timestamp.
+	static bool GetTimestamps(const TableProperties &props,
+				  int32_t *min_timestamp,
+				  int32_t *max_timestamp,
+				  uint64_t *num_entries_without_ts);
+
+	static const std::string kPropMinTimestamp;
+	static const std::string kPropMaxTimestamp;
+	static const std::string kPropNumEntriesWithoutTimestamp;
+
+    private:
+	int32_t min_timestamp_;
+	int32_t max_timestamp_;
+	uint64_t num_entries_without_ts_;
+};
+
+class TtlTablePropertiesCollectorFactory
+	: public TablePropertiesCollectorFactory {
+    public:
+	virtual TablePropertiesCollector *CreateTablePropertiesCollector(
+		TablePropertiesCollectorFactory::Context context) override
+	{
+		return new TtlTablePropertiesCollector();
+	}
+
+	virtual const char *Name() const override
+	{
+		return "TtlTablePropertiesCollectorFactory";
+	}
+};
+
+// Expires the table files of the column families with a TTL after each flush,
+// as time passing is what expires them, and flushes happen regularly in a db
+// that is written to. Reading the table properties may take a while, so the
+// expiry runs in the LOW priority thread pool rather than on the flush
+// thread.
+class TtlExpiryListener : public EventListener {
+    public:
+	explicit TtlExpiryListener(Env *env)
+		: env_(env), db_(nullptr), bg_scheduled_(false),
+		  stopped_(false)
+	{
+	}
+
+	void AddColumnFamily(const std::string &name, uint32_t id, int32_t ttl);
+
+	// Returns false if the column family is unknown
+	bool GetTtl(const std::string &name, int32_t *ttl);
+
+	// No more expiry from now on, as the db is closing. Waits for the
+	// expiry that is running, if any.
+	void Stop();
+
+	virtual void
+	OnFlushCompleted(DB *db, const FlushJobInfo &flush_job_info) override;
+
+	// Waits for the expiry scheduled by the flushes so far
+	void TEST_WaitForBackgroundExpiry();
+
+    private:
+	struct ColumnFamilyTtl {
+		uint32_t id;
+		int32_t ttl;
+		// when the column family was last checked, in seconds
+		int64_t last_check_time;
+	};
+
+	static void BGWorkExpire(void *arg);
+	static void UnscheduleExpire(void *arg);
+	void BackgroundExpire();
+	void WaitForBackgroundExpiry(std::unique_lock<std::mutex> *lock);
+
+	Env *env_;
+	std::mutex mutex_;
+	std::condition_variable bg_cv_;
+	std::map<std::string, ColumnFamilyTtl> column_families_;
+	// The column families to expire in the background, of db_
+	std::map<std::string, ColumnFamilyTtl> pending_;
+	DB *db_;
+	// Whether BGWorkExpire() is scheduled or running
+	bool bg_scheduled_;
+	bool stopped_;
+};
+
 class TtlMergeOperator : public MergeOperator {
     public:
 	explicit TtlMergeOperator(
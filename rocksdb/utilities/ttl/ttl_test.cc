@@ -6,10 +6,12 @@
 
 #include <map>
 #include <memory>
+#include "db/db_impl.h"
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/utilities/db_ttl.h"
 #include "util/string_util.h"
 #include "util/testharness.h"
+#include "utilities/ttl/db_ttl_impl.h"
 #ifndef OS_WIN
 #include <unistd.h>
 #endif
@@ -429,10 +431,10 @@ class TtlTest : public testing::Test {
 	std::string dbname_;
 	DBWithTTL *db_ttl_;
 	unique_ptr<SpecialTimeEnv> env_;
-
-    private:
 	Options options_;
 	KVMap kvmap_;
+
+    private:
 	KVMap::iterator kv_it_;
 	const std::string kNewValue_ = "new_value";
 	unique_ptr<CompactionFilter> test_comp_filter_;
@@ -655,6 +657,131 @@ TEST_F(TtlTest, MultiGetTest)
 	CloseTtl();
 }
 
+// Checks that whole files are dropped once expired, and files with expired
+// values compacted first
+TEST_F(TtlTest, DropExpiredFiles)
+{
+	MakeKVMap(kSampleSize_);
+	// Only the files marked for compaction are compacted
+	options_.level0_file_num_compaction_trigger = 100;
+	options_.level0_slowdown_writes_trigger = 100;
+	options_.level0_stop_writes_trigger = 100;
+	OpenTtl(5);
+	DBImpl *db_impl = reinterpret_cast<DBImpl *>(db_ttl_->GetRootDB());
+	auto num_files = [&](int level) {
+		std::vector<LiveFileMetaData> files;
+		db_ttl_->GetLiveFilesMetaData(&files);
+		int count = 0;
+		for (const auto &file : files) {
+			count += file.level == level ? 1 : 0;
+		}
+		return count;
+	};
+	const int64_t half = kSampleSize_ / 2;
+	const std::string first_key = kvmap_.begin()->first;
+	const std::string last_key = kvmap_.rbegin()->first;
+	std::string value;
+
+	PutValues(0, half); // T=0: file 1
+	env_->Sleep(3);
+	PutValues(half, kSampleSize_ - half); // T=3: file 2
+	ASSERT_EQ(2, num_files(0));
+
+	// T=6: file 1 has expired
+	env_->Sleep(3);
+	ASSERT_OK(db_ttl_->DropExpiredFiles(db_ttl_->DefaultColumnFamily()));
+	ASSERT_EQ(1, num_files(0));
+	ASSERT_TRUE(
+		db_ttl_->Get(ReadOptions(), first_key, &value).IsNotFound());
+	ASSERT_OK(db_ttl_->Get(ReadOptions(), last_key, &value));
+
+	// T=6: file 3 has a deletion, so is never dropped
+	ASSERT_OK(db_ttl_->Delete(WriteOptions(), last_key));
+	ASSERT_OK(db_ttl_->Flush(FlushOptions()));
+	ASSERT_EQ(2, num_files(0));
+
+	// T=9: file 2 has expired, and is dropped after the flush of file 4
+	env_->Sleep(3);
+	ASSERT_OK(db_ttl_->Put(WriteOptions(), "keymock", "valuemock"));
+	ASSERT_OK(db_ttl_->Flush(FlushOptions()));
+	static_cast<DBWithTTLImpl *>(db_ttl_)->TEST_WaitForBackgroundExpiry();
+	ASSERT_OK(db_impl->TEST_WaitForCompact());
+	ASSERT_EQ(2, num_files(0));
+	ASSERT_TRUE(db_ttl_->Get(ReadOptions(), last_key, &value).IsNotFound());
+
+	// T=12: file 5 has values written at T=9 and T=12
+	PutValues(0, half, false);
+	env_->Sleep(3);
+	PutValues(half, kSampleSize_ - half);
+	ASSERT_EQ(3, num_files(0));
+
+	// T=16: file 4 has expired and, with two thirds of its values
+	// expired, file 5 is compacted, with file 3
+	env_->Sleep(4);
+	ASSERT_OK(db_ttl_->DropExpiredFiles(db_ttl_->DefaultColumnFamily()));
+	ASSERT_OK(db_impl->TEST_WaitForCompact());
+	ASSERT_EQ(0, num_files(0));
+	ASSERT_GT(num_files(1), 0);
+	ASSERT_TRUE(
+		db_ttl_->Get(ReadOptions(), first_key, &value).IsNotFound());
+	ASSERT_OK(db_ttl_->Get(ReadOptions(), last_key, &value));
+
+	CloseTtl();
+}
+
+// Checks that files of the last level with data are compacted within that
+// level once enough of their values expired
+TEST_F(TtlTest, CompactExpiredBottommostFiles)
+{
+	MakeKVMap(kSampleSize_);
+	options_.level0_file_num_compaction_trigger = 100;
+	options_.level0_slowdown_writes_trigger = 100;
+	options_.level0_stop_writes_trigger = 100;
+	OpenTtl(5);
+	DBImpl *db_impl = reinterpret_cast<DBImpl *>(db_ttl_->GetRootDB());
+	auto num_files = [&](int level) {
+		std::vector<LiveFileMetaData> files;
+		db_ttl_->GetLiveFilesMetaData(&files);
+		int count = 0;
+		for (const auto &file : files) {
+			count += file.level == level ? 1 : 0;
+		}
+		return count;
+	};
+	const int64_t half = kSampleSize_ / 2;
+	const std::string first_key = kvmap_.begin()->first;
+	const std::string last_key = kvmap_.rbegin()->first;
+	std::string value;
+
+	// T=3: level 1 holds values written at T=0 and T=3
+	PutValues(0, half);
+	env_->Sleep(3);
+	PutValues(half, kSampleSize_ - half);
+	ASSERT_OK(db_ttl_->CompactRange(CompactRangeOptions(), nullptr,
+					nullptr));
+	ASSERT_EQ(0, num_files(0));
+	ASSERT_GT(num_files(1), 0);
+	ASSERT_EQ(0, num_files(2));
+
+	// T=5: none has expired
+	env_->Sleep(2);
+	ASSERT_OK(db_ttl_->DropExpiredFiles(db_ttl_->DefaultColumnFamily()));
+	ASSERT_OK(db_impl->TEST_WaitForCompact());
+	ASSERT_OK(db_ttl_->Get(ReadOptions(), first_key, &value));
+
+	// T=7: two thirds have, the files are compacted within level 1
+	env_->Sleep(2);
+	ASSERT_OK(db_ttl_->DropExpiredFiles(db_ttl_->DefaultColumnFamily()));
+	ASSERT_OK(db_impl->TEST_WaitForCompact());
+	ASSERT_GT(num_files(1), 0);
+	ASSERT_EQ(0, num_files(2));
+	ASSERT_TRUE(
+		db_ttl_->Get(ReadOptions(), first_key, &value).IsNotFound());
+	ASSERT_OK(db_ttl_->Get(ReadOptions(), last_key, &value));
+
+	CloseTtl();
+}
+
 TEST_F(TtlTest, ColumnFamiliesTest)
 {
 	DB *db;